@@ -0,0 +1,84 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "codec/cbor/cbor.hpp"
+#include "storage/amt/amt.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+
+namespace fc::storage::amt {
+  using ipfs::InMemoryDatastore;
+
+  namespace {
+    const Buffer &value() {
+      static const auto value{codec::cbor::encode(uint64_t{1} << 40).value()};
+      return value;
+    }
+  }  // namespace
+
+  /// Appends n values and flushes, like receipts of tipset
+  void amtAppend(benchmark::State &state) {
+    auto n{state.range(0)};
+    for (auto _ : state) {
+      Amt amt{std::make_shared<InMemoryDatastore>()};
+      for (int64_t i{0}; i < n; ++i) {
+        amt.set(i, value()).value();
+      }
+      benchmark::DoNotOptimize(amt.flush().value());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  /// Builds amt of n values bottom-up
+  void amtFromValues(benchmark::State &state) {
+    auto n{state.range(0)};
+    for (auto _ : state) {
+      std::vector<Value> values(n, value());
+      benchmark::DoNotOptimize(
+          Amt::fromValues(std::make_shared<InMemoryDatastore>(),
+                          std::move(values))
+              .value()
+              .cid());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  /// Visits all values of amt loaded from store
+  void amtVisit(benchmark::State &state) {
+    auto n{state.range(0)};
+    auto store{std::make_shared<InMemoryDatastore>()};
+    Amt amt{store};
+    for (int64_t i{0}; i < n; ++i) {
+      amt.set(i, value()).value();
+    }
+    auto root{amt.flush().value()};
+    for (auto _ : state) {
+      Amt loaded{store, root};
+      uint64_t count{0};
+      loaded
+          .visit([&](auto, auto &) {
+            ++count;
+            return outcome::success();
+          })
+          .value();
+      benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  BENCHMARK(amtAppend)
+      ->RangeMultiplier(10)
+      ->Range(1000, 1000000)
+      ->Unit(benchmark::kMillisecond);
+  BENCHMARK(amtFromValues)
+      ->RangeMultiplier(10)
+      ->Range(1000, 1000000)
+      ->Unit(benchmark::kMillisecond);
+  BENCHMARK(amtVisit)
+      ->RangeMultiplier(10)
+      ->Range(1000, 1000000)
+      ->Unit(benchmark::kMillisecond);
+}  // namespace fc::storage::amt
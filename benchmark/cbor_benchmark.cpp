@@ -0,0 +1,96 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "codec/cbor/cbor.hpp"
+#include "primitives/block/block.hpp"
+
+namespace fc::primitives::block {
+  using crypto::signature::BlsSignature;
+  using primitives::sector::RegisteredProof;
+  using vm::message::MethodParams;
+
+  namespace {
+    CID cidOf(uint64_t i) {
+      return common::getCidOf(codec::cbor::encode(i).value()).value();
+    }
+
+    /// Header of mainnet size, with ticket, proofs and signatures
+    BlockHeader sampleHeader() {
+      BlockHeader block;
+      block.miner = Address::makeFromId(1000);
+      block.ticket = Ticket{Buffer(96, 1)};
+      block.election_proof = ElectionProof{1, Buffer(96, 2)};
+      block.beacon_entries = {BeaconEntry{100, Buffer(96, 3)}};
+      block.win_post_proof = {
+          PoStProof{RegisteredProof::StackedDRG32GiBWinningPoSt,
+                    Buffer(192, 4)}};
+      block.parents = {cidOf(1), cidOf(2), cidOf(3), cidOf(4), cidOf(5)};
+      block.parent_weight = BigInt{"12345678901234567890"};
+      block.height = 100000;
+      block.parent_state_root = cidOf(6);
+      block.parent_message_receipts = cidOf(7);
+      block.messages = cidOf(8);
+      block.bls_aggregate = Signature{BlsSignature{}};
+      block.timestamp = 1600000000;
+      block.block_sig = Signature{BlsSignature{}};
+      block.parent_base_fee = 100;
+      return block;
+    }
+
+    UnsignedMessage sampleMessage() {
+      return {Address::makeFromId(1000),
+              Address::makeFromId(1001),
+              42,
+              BigInt{"1000000000000000000"},
+              BigInt{100000},
+              10000000,
+              2,
+              MethodParams{Buffer(64, 5)}};
+    }
+
+    template <typename T>
+    void encode(benchmark::State &state, const T &value) {
+      size_t bytes{0};
+      for (auto _ : state) {
+        auto encoded{codec::cbor::encode(value).value()};
+        bytes += encoded.size();
+        benchmark::DoNotOptimize(encoded);
+      }
+      state.SetBytesProcessed(bytes);
+    }
+
+    template <typename T>
+    void decode(benchmark::State &state, const T &value) {
+      auto encoded{codec::cbor::encode(value).value()};
+      for (auto _ : state) {
+        benchmark::DoNotOptimize(codec::cbor::decode<T>(encoded).value());
+      }
+      state.SetBytesProcessed(state.iterations() * encoded.size());
+    }
+  }  // namespace
+
+  void blockHeaderEncode(benchmark::State &state) {
+    encode(state, sampleHeader());
+  }
+
+  void blockHeaderDecode(benchmark::State &state) {
+    decode(state, sampleHeader());
+  }
+
+  void unsignedMessageEncode(benchmark::State &state) {
+    encode(state, sampleMessage());
+  }
+
+  void unsignedMessageDecode(benchmark::State &state) {
+    decode(state, sampleMessage());
+  }
+
+  BENCHMARK(blockHeaderEncode);
+  BENCHMARK(blockHeaderDecode);
+  BENCHMARK(unsignedMessageEncode);
+  BENCHMARK(unsignedMessageDecode);
+}  // namespace fc::primitives::block
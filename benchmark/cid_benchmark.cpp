@@ -0,0 +1,68 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "codec/cbor/cbor.hpp"
+#include "primitives/cid/compact_cid.hpp"
+
+namespace fc {
+  namespace {
+    /// Dag-cbor blake2b-256 cid, as of blocks and state
+    const CID &sampleCid() {
+      static const auto cid{
+          common::getCidOf(codec::cbor::encode(uint64_t{1}).value()).value()};
+      return cid;
+    }
+  }  // namespace
+
+  void cidFromBytes(benchmark::State &state) {
+    auto bytes{sampleCid().toBytes().value()};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(CID::fromBytes(bytes).value());
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+  }
+
+  void cidFromString(benchmark::State &state) {
+    auto str{sampleCid().toString().value()};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(CID::fromString(str).value());
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+  }
+
+  void cidToBytes(benchmark::State &state) {
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(sampleCid().toBytes().value());
+    }
+  }
+
+  void cidHash(benchmark::State &state) {
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(std::hash<CID>{}(sampleCid()));
+    }
+  }
+
+  void compactCidMake(benchmark::State &state) {
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(CompactCid{sampleCid()});
+    }
+  }
+
+  void compactCidHash(benchmark::State &state) {
+    CompactCid cid{sampleCid()};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(std::hash<CompactCid>{}(cid));
+    }
+  }
+
+  BENCHMARK(cidFromBytes);
+  BENCHMARK(cidFromString);
+  BENCHMARK(cidToBytes);
+  BENCHMARK(cidHash);
+  BENCHMARK(compactCidMake);
+  BENCHMARK(compactCidHash);
+}  // namespace fc
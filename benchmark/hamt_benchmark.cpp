@@ -0,0 +1,86 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "codec/cbor/cbor.hpp"
+#include "storage/hamt/hamt.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+
+namespace fc::storage::hamt {
+  using ipfs::InMemoryDatastore;
+
+  namespace {
+    /// Keys look like encoded id addresses
+    std::string key(uint64_t i) {
+      return std::string{"\0", 1} + std::to_string(i);
+    }
+
+    const Buffer &value() {
+      static const auto value{codec::cbor::encode(uint64_t{1} << 40).value()};
+      return value;
+    }
+
+    /// Flushed hamt with n keys
+    CID makeHamt(const std::shared_ptr<InMemoryDatastore> &store, int64_t n) {
+      Hamt hamt{store};
+      for (int64_t i{0}; i < n; ++i) {
+        hamt.set(key(i), value()).value();
+      }
+      return hamt.flush().value();
+    }
+  }  // namespace
+
+  void hamtSet(benchmark::State &state) {
+    auto n{state.range(0)};
+    for (auto _ : state) {
+      Hamt hamt{std::make_shared<InMemoryDatastore>()};
+      for (int64_t i{0}; i < n; ++i) {
+        hamt.set(key(i), value()).value();
+      }
+      benchmark::DoNotOptimize(hamt);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  /// Gets random keys of hamt loaded from store, nodes are cached by hamt
+  void hamtGet(benchmark::State &state) {
+    auto n{state.range(0)};
+    auto store{std::make_shared<InMemoryDatastore>()};
+    Hamt hamt{store, makeHamt(store, n)};
+    uint64_t i{0};
+    for (auto _ : state) {
+      i = (i * 6364136223846793005 + 1442695040888963407);
+      benchmark::DoNotOptimize(hamt.get(key((i >> 33) % n)).value());
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  /// Flushes n new keys
+  void hamtFlush(benchmark::State &state) {
+    auto n{state.range(0)};
+    for (auto _ : state) {
+      state.PauseTiming();
+      auto store{std::make_shared<InMemoryDatastore>()};
+      Hamt hamt{store};
+      for (int64_t i{0}; i < n; ++i) {
+        hamt.set(key(i), value()).value();
+      }
+      state.ResumeTiming();
+      benchmark::DoNotOptimize(hamt.flush().value());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  BENCHMARK(hamtSet)
+      ->RangeMultiplier(10)
+      ->Range(1000, 10000000)
+      ->Unit(benchmark::kMillisecond);
+  BENCHMARK(hamtGet)->RangeMultiplier(10)->Range(1000, 10000000);
+  BENCHMARK(hamtFlush)
+      ->RangeMultiplier(10)
+      ->Range(1000, 10000000)
+      ->Unit(benchmark::kMillisecond);
+}  // namespace fc::storage::hamt
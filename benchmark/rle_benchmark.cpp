@@ -0,0 +1,61 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "primitives/rle_bitset/rle_bitset.hpp"
+
+namespace fc::primitives {
+  namespace {
+    /**
+     * Sectors of miner with argument sectors, mostly contiguous with few
+     * terminated and faulty ones, seeded for reproducible runs.
+     */
+    RleBitset sectors(int64_t count, double holes) {
+      std::mt19937_64 random{static_cast<uint64_t>(count)};
+      std::bernoulli_distribution hole{holes};
+      RleBitset set;
+      for (int64_t i{0}; i < count; ++i) {
+        if (!hole(random)) {
+          set.insert(i);
+        }
+      }
+      return set;
+    }
+  }  // namespace
+
+  void rleEncode(benchmark::State &state) {
+    auto set{sectors(state.range(0), 0.01)};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(set.toRle());
+    }
+    state.SetItemsProcessed(state.iterations() * set.runs().size());
+  }
+
+  void rleDecode(benchmark::State &state) {
+    auto set{sectors(state.range(0), 0.01)};
+    auto rle{set.toRle()};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(RleBitset::fromRle(rle).value());
+    }
+    state.SetBytesProcessed(state.iterations() * rle.size());
+  }
+
+  /// Partition sectors minus faults, as in winning post
+  void rleSubtract(benchmark::State &state) {
+    auto all{sectors(state.range(0), 0.01)};
+    auto faults{sectors(state.range(0), 0.9)};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(all - faults);
+    }
+  }
+
+  // partition, deadline and large miner sizes
+  BENCHMARK(rleEncode)->Arg(2349)->Arg(100000)->Arg(10000000);
+  BENCHMARK(rleDecode)->Arg(2349)->Arg(100000)->Arg(10000000);
+  BENCHMARK(rleSubtract)->Arg(2349)->Arg(100000)->Arg(10000000);
+}  // namespace fc::primitives
@@ -0,0 +1,263 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Replays api requests recorded by node with FC_RPC_RECORD_FILE and reports
+ * per method latency percentiles, throughput and errors as json lines.
+ *
+ * Usage: rpc_replay <record> <multiaddr> <token> [--concurrency N]
+ *                   [--speed X] [--skip M1,M2]
+ *
+ * Recorded sessions are spread over N connections (default 4).
+ * With speed X > 0 requests are sent at recorded time divided by X,
+ * regardless of responses. With speed 0 (default) requests are sent as fast
+ * as possible, at most N at a time.
+ * Channel methods (ChainNotify, MpoolSub) are skipped by default, --skip
+ * replaces that list.
+ */
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <set>
+
+#include "api/rpc/wsc.hpp"
+#include "codec/json/json.hpp"
+
+namespace fc::benchmark {
+  using api::rpc::Client;
+  using api::rpc::Request;
+  using boost::asio::io_context;
+  using codec::json::Document;
+  using libp2p::multi::Multiaddress;
+  using Clock = std::chrono::steady_clock;
+
+  constexpr std::chrono::seconds kCallTimeout{60};
+
+  struct Call {
+    std::chrono::microseconds time;
+    uint64_t session;
+    std::string method;
+    Document params;
+  };
+
+  struct Stat {
+    std::vector<double> latencies_ms;
+    size_t errors{};
+  };
+
+  outcome::result<std::vector<Call>> loadCalls(
+      const std::string &path, const std::set<std::string> &skip) {
+    std::ifstream file{path};
+    if (!file) {
+      return std::errc::no_such_file_or_directory;
+    }
+    std::vector<Call> calls;
+    std::string line;
+    while (std::getline(file, line)) {
+      if (line.empty()) {
+        continue;
+      }
+      OUTCOME_TRY(j, codec::json::parse(line));
+      OUTCOME_TRY(j_time, codec::json::jGet(&j, "t"));
+      OUTCOME_TRY(time, codec::json::jUint(j_time));
+      OUTCOME_TRY(j_session, codec::json::jGet(&j, "s"));
+      OUTCOME_TRY(session, codec::json::jUint(j_session));
+      OUTCOME_TRY(j_method, codec::json::jGet(&j, "m"));
+      OUTCOME_TRY(method, codec::json::jStr(j_method));
+      if (skip.count(std::string{method}) != 0) {
+        continue;
+      }
+      OUTCOME_TRY(j_params, codec::json::jGet(&j, "p"));
+      Document params;
+      params.CopyFrom(*j_params, params.GetAllocator());
+      calls.push_back({std::chrono::microseconds{time},
+                       session,
+                       std::string{method},
+                       std::move(params)});
+    }
+    // recorder appends, file may contain several node runs
+    std::stable_sort(calls.begin(), calls.end(), [](auto &l, auto &r) {
+      return l.time < r.time;
+    });
+    return calls;
+  }
+
+  /// Sends calls and collects results, all state is used on io thread
+  struct Replay {
+    io_context io;
+    boost::asio::executor_work_guard<io_context::executor_type> work_guard{
+        io.get_executor()};
+    boost::asio::steady_timer timer{io};
+    std::vector<std::unique_ptr<Client>> clients;
+    std::vector<Call> calls;
+    double speed{};
+    size_t concurrency{};
+    size_t next{}, inflight{}, done{};
+    Clock::time_point start;
+    std::map<std::string, Stat> stats;
+
+    void run() {
+      start = Clock::now();
+      if (calls.empty()) {
+        return;
+      }
+      boost::asio::post(io, [this] { speed > 0 ? schedule() : pump(); });
+      io.run();
+    }
+
+    void send(size_t i) {
+      auto &call{calls[i]};
+      auto &client{*clients[call.session % clients.size()]};
+      ++inflight;
+      // called on client thread under its lock, must not call client again
+      client.call(Request{{}, call.method, std::move(call.params), {}},
+                  [this, i, begin{Clock::now()}](auto res) {
+                    auto end{Clock::now()};
+                    auto failed{res.has_error()};
+                    boost::asio::post(io, [this, i, begin, end, failed] {
+                      onResult(i, end - begin, failed);
+                    });
+                  });
+    }
+
+    void onResult(size_t i, Clock::duration latency, bool failed) {
+      auto &stat{stats[calls[i].method]};
+      stat.latencies_ms.push_back(
+          std::chrono::duration<double, std::milli>(latency).count());
+      if (failed) {
+        ++stat.errors;
+      }
+      --inflight;
+      if (++done == calls.size()) {
+        work_guard.reset();
+        return;
+      }
+      if (speed <= 0) {
+        pump();
+      }
+    }
+
+    /// Closed loop, keeps up to concurrency calls in flight
+    void pump() {
+      while (next < calls.size() && inflight < concurrency) {
+        send(next++);
+      }
+    }
+
+    /// Open loop, sends all calls which are due and waits for next one
+    void schedule() {
+      auto first{calls.front().time};
+      auto due{[&](size_t i) {
+        return start
+               + std::chrono::duration_cast<Clock::duration>(
+                   (calls[i].time - first) / speed);
+      }};
+      while (next < calls.size() && due(next) <= Clock::now()) {
+        send(next++);
+      }
+      if (next < calls.size()) {
+        timer.expires_at(due(next));
+        timer.async_wait([this](auto ec) {
+          if (!ec) {
+            schedule();
+          }
+        });
+      }
+    }
+  };
+
+  double percentile(const std::vector<double> &sorted, double p) {
+    auto index{static_cast<size_t>(std::ceil(p * sorted.size()))};
+    return sorted[std::max<size_t>(index, 1) - 1];
+  }
+
+  int main(int argc, char **argv) {
+    auto usage{[&] {
+      std::cerr << "usage: " << argv[0]
+                << " <record> <multiaddr> <token> [--concurrency N]"
+                   " [--speed X] [--skip M1,M2]"
+                << std::endl;
+      return 1;
+    }};
+    if (argc < 4 || argc % 2 != 0) {
+      return usage();
+    }
+    size_t concurrency{4};
+    double speed{0};
+    std::set<std::string> skip{"ChainNotify", "MpoolSub"};
+    for (auto i{4}; i < argc; i += 2) {
+      std::string flag{argv[i]}, value{argv[i + 1]};
+      if (flag == "--concurrency") {
+        concurrency = std::max<size_t>(1, std::stoul(value));
+      } else if (flag == "--speed") {
+        speed = std::stod(value);
+      } else if (flag == "--skip") {
+        skip.clear();
+        boost::split(skip, value, boost::is_any_of(","));
+      } else {
+        return usage();
+      }
+    }
+
+    auto calls{loadCalls(argv[1], skip)};
+    if (!calls) {
+      std::cerr << argv[1] << ": " << calls.error().message() << std::endl;
+      return 1;
+    }
+    auto address{Multiaddress::create(argv[2])};
+    if (!address) {
+      std::cerr << argv[2] << ": " << address.error().message() << std::endl;
+      return 1;
+    }
+
+    Replay replay;
+    replay.calls = std::move(calls.value());
+    replay.speed = speed;
+    replay.concurrency = concurrency;
+    for (size_t i{0}; i < concurrency; ++i) {
+      auto &client{replay.clients.emplace_back(
+          std::make_unique<Client>(replay.io))};
+      client->default_timeout = kCallTimeout;
+      auto connected{client->connect(address.value(), argv[3])};
+      if (!connected) {
+        std::cerr << "connect: " << connected.error().message() << std::endl;
+        return 1;
+      }
+    }
+    replay.run();
+    auto seconds{
+        std::chrono::duration<double>(Clock::now() - replay.start).count()};
+
+    size_t errors{};
+    for (auto &[method, stat] : replay.stats) {
+      auto &latencies{stat.latencies_ms};
+      std::sort(latencies.begin(), latencies.end());
+      errors += stat.errors;
+      std::cout << "{\"method\":\"" << method
+                << "\",\"calls\":" << latencies.size()
+                << ",\"errors\":" << stat.errors
+                << ",\"p50_ms\":" << percentile(latencies, 0.5)
+                << ",\"p90_ms\":" << percentile(latencies, 0.9)
+                << ",\"p99_ms\":" << percentile(latencies, 0.99)
+                << ",\"max_ms\":" << latencies.back() << "}" << std::endl;
+    }
+    auto total{replay.calls.size()};
+    std::cout << "{\"total\":true"
+              << ",\"calls\":" << total << ",\"errors\":" << errors
+              << ",\"error_rate\":"
+              << (total != 0 ? static_cast<double>(errors) / total : 0.0)
+              << ",\"seconds\":" << seconds << ",\"calls_per_second\":"
+              << (seconds > 0 ? total / seconds : 0.0) << "}" << std::endl;
+    return 0;
+  }
+}  // namespace fc::benchmark
+
+int main(int argc, char **argv) {
+  return fc::benchmark::main(argc, argv);
+}
@@ -0,0 +1,742 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Drives real sealing scheduler and selectors with simulated workers in
+ * simulated time, and reports per task throughput and queue latency, and
+ * per worker group utilization as json lines.
+ *
+ * Usage: scheduler_sim <workload.json>
+ *
+ * Workload:
+ *   {"seal_proof": "32GiB", "sectors": 100, "arrival_s": 600,
+ *    "fetch_s": 900, "batch": {"seal/v0/precommit/1": 2},
+ *    "workers": [{"name": "pc1", "count": 10, "memory_gib": 512,
+ *                 "swap_gib": 0, "cpus": 64, "gpus": 0,
+ *                 "tasks": {"seal/v0/addpiece": 600,
+ *                           "seal/v0/precommit/1": 14400}}]}
+ * New sector arrives every arrival_s and goes through AddPiece, PreCommit1,
+ * PreCommit2, Commit1, Commit2 and Finalize with selectors used by manager.
+ * Worker group does tasks listed in "tasks", each taking given seconds.
+ * Tasks which need sector files missing on worker fetch them for fetch_s.
+ *
+ * Prepare and work actions sleep on simulated clock, which jumps to next
+ * wakeup when all actions sleep and scheduler was quiet for short real time
+ * (FC_SIM_GRACE_MS, default 2), so scheduler bookkeeping is not counted.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+#include "codec/json/json.hpp"
+#include "primitives/resources/resources.hpp"
+#include "sector_storage/impl/allocate_selector.hpp"
+#include "sector_storage/impl/existing_selector.hpp"
+#include "sector_storage/impl/scheduler_impl.hpp"
+#include "sector_storage/impl/task_selector.hpp"
+#include "sector_storage/stores/impl/index_impl.hpp"
+
+namespace fc::benchmark {
+  using codec::json::JIn;
+  using primitives::FsStat;
+  using primitives::StorageID;
+  using primitives::StoragePath;
+  using primitives::WorkerInfo;
+  using primitives::WorkerResources;
+  using primitives::sector::RegisteredProof;
+  using primitives::sector::SectorId;
+  using primitives::sector_file::SectorFileType;
+  using sector_storage::AllocateSelector;
+  using sector_storage::ExistingSelector;
+  using sector_storage::SchedulerImpl;
+  using sector_storage::TaskSelector;
+  using sector_storage::Worker;
+  using sector_storage::WorkerErrors;
+  using sector_storage::WorkerHandle;
+  using sector_storage::WorkerSelector;
+  using sector_storage::stores::PathType;
+  using sector_storage::stores::SectorIndex;
+  using sector_storage::stores::SectorIndexImpl;
+  using sector_storage::stores::StorageInfo;
+
+  constexpr uint64_t kGiB{uint64_t{1} << 30};
+  constexpr uint64_t kStorageSpace{uint64_t{1} << 50};
+  constexpr uint64_t kMinerId{1000};
+
+  /**
+   * Simulated time in seconds. Threads taking part in simulation are counted
+   * with begin/end, time moves only when all of them sleep.
+   */
+  class SimClock {
+   public:
+    explicit SimClock(std::chrono::milliseconds grace) : grace_{grace} {}
+
+    double now() {
+      std::lock_guard lock{mutex_};
+      return now_;
+    }
+
+    void begin() {
+      std::lock_guard lock{mutex_};
+      ++active_;
+      ++generation_;
+    }
+
+    void end() {
+      std::lock_guard lock{mutex_};
+      --active_;
+      ++generation_;
+    }
+
+    /// Marks activity, so time doesn't move during scheduler bookkeeping
+    void touch() {
+      std::lock_guard lock{mutex_};
+      ++generation_;
+    }
+
+    /// Blocks counted thread for simulated seconds
+    void sleep(double seconds) {
+      std::unique_lock lock{mutex_};
+      auto wake{now_ + seconds};
+      auto it{wakes_.insert(wake)};
+      ++sleeping_;
+      ++generation_;
+      cv_.wait(lock, [&] { return now_ >= wake; });
+      wakes_.erase(it);
+      --sleeping_;
+      ++generation_;
+    }
+
+    /// Calls f on driver thread at simulated time
+    void at(double time, std::function<void()> f) {
+      std::lock_guard lock{mutex_};
+      events_.emplace(time, std::move(f));
+      ++generation_;
+    }
+
+    /**
+     * Advances time until done returns true.
+     * @return false if nothing is left to wait for, but not done
+     */
+    bool run(const std::function<bool()> &done,
+             const std::function<void()> &tick) {
+      std::unique_lock lock{mutex_};
+      while (true) {
+        auto generation{generation_};
+        lock.unlock();
+        std::this_thread::sleep_for(grace_);
+        tick();
+        lock.lock();
+        // woken sleepers may not have run yet
+        if (generation != generation_ || sleeping_ < active_
+            || (!wakes_.empty() && *wakes_.begin() <= now_)) {
+          continue;
+        }
+        lock.unlock();
+        if (done()) {
+          return true;
+        }
+        lock.lock();
+        auto next{std::numeric_limits<double>::infinity()};
+        if (!wakes_.empty()) {
+          next = *wakes_.begin();
+        }
+        if (!events_.empty()) {
+          next = std::min(next, events_.begin()->first);
+        }
+        if (std::isinf(next)) {
+          return false;
+        }
+        now_ = std::max(now_, next);
+        ++generation_;
+        cv_.notify_all();
+        std::vector<std::function<void()>> due;
+        while (!events_.empty() && events_.begin()->first <= now_) {
+          due.push_back(std::move(events_.begin()->second));
+          events_.erase(events_.begin());
+        }
+        lock.unlock();
+        for (auto &f : due) {
+          f();
+        }
+        lock.lock();
+      }
+    }
+
+   private:
+    std::chrono::milliseconds grace_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    double now_{};
+    size_t active_{}, sleeping_{};
+    uint64_t generation_{};
+    std::multiset<double> wakes_;
+    std::multimap<double, std::function<void()>> events_;
+  };
+
+  /// Counts thread as taking part in simulation while in scope
+  struct SimActive {
+    explicit SimActive(SimClock &clock) : clock{clock} {
+      clock.begin();
+    }
+    ~SimActive() {
+      clock.end();
+    }
+    SimClock &clock;
+  };
+
+  struct WorkerGroup {
+    std::string name;
+    size_t count{};
+    WorkerResources resources{};
+    /// Seconds by supported task type
+    std::map<std::string, double> durations;
+  };
+
+  struct Workload {
+    RegisteredProof seal_proof{RegisteredProof::StackedDRG32GiBSeal};
+    size_t sectors{};
+    double arrival_s{};
+    double fetch_s{};
+    std::map<std::string, size_t> batch;
+    std::vector<WorkerGroup> groups;
+  };
+
+  /// Worker which only tells its tasks and storage, work is done by actions
+  class SimWorker : public Worker {
+   public:
+    SimWorker(size_t group,
+              StorageID storage,
+              WorkerInfo info,
+              std::map<std::string, double> durations)
+        : group{group},
+          storage{std::move(storage)},
+          info{std::move(info)},
+          durations{std::move(durations)} {}
+
+    outcome::result<void> moveStorage(const SectorId &) override {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+
+    outcome::result<void> fetch(const SectorId &,
+                                const SectorFileType &,
+                                PathType,
+                                sector_storage::AcquireMode) override {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+
+    outcome::result<void> unsealPiece(
+        const SectorId &,
+        sector_storage::UnpaddedByteIndex,
+        const sector_storage::UnpaddedPieceSize &,
+        const sector_storage::SealRandomness &,
+        const CID &) override {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+
+    outcome::result<void> readPiece(
+        sector_storage::PieceData,
+        const SectorId &,
+        sector_storage::UnpaddedByteIndex,
+        const sector_storage::UnpaddedPieceSize &) override {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+
+    outcome::result<WorkerInfo> getInfo() override {
+      return info;
+    }
+
+    outcome::result<std::set<primitives::TaskType>> getSupportedTask()
+        override {
+      std::set<primitives::TaskType> tasks;
+      for (auto &[task, _] : durations) {
+        tasks.insert(primitives::TaskType{task});
+      }
+      return tasks;
+    }
+
+    outcome::result<std::vector<StoragePath>> getAccessiblePaths() override {
+      return std::vector<StoragePath>{{storage, 10, {}, true, false}};
+    }
+
+    outcome::result<sector_storage::PreCommit1Output> sealPreCommit1(
+        const SectorId &,
+        const sector_storage::SealRandomness &,
+        gsl::span<const sector_storage::PieceInfo>) override {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+
+    outcome::result<sector_storage::SectorCids> sealPreCommit2(
+        const SectorId &,
+        const sector_storage::PreCommit1Output &) override {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+
+    outcome::result<sector_storage::Commit1Output> sealCommit1(
+        const SectorId &,
+        const sector_storage::SealRandomness &,
+        const sector_storage::InteractiveRandomness &,
+        gsl::span<const sector_storage::PieceInfo>,
+        const sector_storage::SectorCids &) override {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+
+    outcome::result<sector_storage::Proof> sealCommit2(
+        const SectorId &, const sector_storage::Commit1Output &) override {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+
+    outcome::result<void> finalizeSector(
+        const SectorId &,
+        const gsl::span<const sector_storage::Range> &) override {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+
+    outcome::result<void> remove(const SectorId &) override {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+
+    outcome::result<sector_storage::PieceInfo> addPiece(
+        const SectorId &,
+        gsl::span<const sector_storage::UnpaddedPieceSize>,
+        const sector_storage::UnpaddedPieceSize &,
+        const proofs::PieceData &) override {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+
+    size_t group;
+    StorageID storage;
+    WorkerInfo info;
+    std::map<std::string, double> durations;
+    /// Tasks working now and time with any, guarded by Sim mutex
+    size_t working{};
+    double busy{}, busy_since{};
+  };
+
+  /// Pipeline step, with sector files it reads and creates
+  struct Stage {
+    primitives::TaskType task;
+    SectorFileType input;
+    SectorFileType output;
+  };
+
+  const auto kSealedCache{static_cast<SectorFileType>(
+      SectorFileType::FTSealed | SectorFileType::FTCache)};
+  const auto kNoFiles{static_cast<SectorFileType>(0)};
+
+  const std::vector<Stage> kStages{
+      {primitives::kTTAddPiece, kNoFiles, SectorFileType::FTUnsealed},
+      {primitives::kTTPreCommit1, SectorFileType::FTUnsealed, kSealedCache},
+      {primitives::kTTPreCommit2, kSealedCache, kNoFiles},
+      {primitives::kTTCommit1, kSealedCache, kNoFiles},
+      {primitives::kTTCommit2, kNoFiles, kNoFiles},
+      {primitives::kTTFinalize, kSealedCache, kNoFiles},
+  };
+
+  /// Same selectors as manager uses for the task
+  std::shared_ptr<WorkerSelector> stageSelector(
+      size_t stage,
+      const std::shared_ptr<SectorIndex> &index,
+      const SectorId &sector) {
+    switch (stage) {
+      case 0:
+        return std::make_shared<AllocateSelector>(
+            index, SectorFileType::FTUnsealed, PathType::kSealing);
+      case 1:
+        return std::make_shared<AllocateSelector>(index,
+                                                  kSealedCache,
+                                                  PathType::kSealing,
+                                                  sector,
+                                                  SectorFileType::FTUnsealed);
+      case 2:
+        return std::make_shared<ExistingSelector>(
+            index, sector, kSealedCache, true);
+      case 4:
+        return std::make_shared<TaskSelector>();
+      default:
+        return std::make_shared<ExistingSelector>(
+            index, sector, kSealedCache, false);
+    }
+  }
+
+  /// Upper bound of tasks worker may prepare and work at once
+  size_t workerSlots(const WorkerGroup &group, RegisteredProof seal_proof) {
+    size_t slots{1};
+    auto memory{group.resources.physical_memory + group.resources.swap_memory};
+    for (auto &[task, _] : group.durations) {
+      auto it{primitives::kResourceTable.find(
+          {primitives::TaskType{task}, seal_proof})};
+      if (it == primitives::kResourceTable.end()) {
+        continue;
+      }
+      auto &need{it->second};
+      uint64_t by_memory{memory / std::max<uint64_t>(1, need.min_memory)};
+      uint64_t by_cpus{need.threads ? group.resources.cpus
+                                          / std::max<uint64_t>(1, *need.threads)
+                                    : 1};
+      slots = std::max<size_t>(slots, std::min(by_memory, by_cpus));
+    }
+    // preparing and working stage
+    return 2 * slots;
+  }
+
+  struct TaskStat {
+    std::vector<double> queue_s;
+    double work_s{};
+  };
+
+  struct Sim {
+    Sim(Workload workload, std::chrono::milliseconds grace)
+        : workload{std::move(workload)}, clock{grace} {}
+
+    outcome::result<void> setup() {
+      size_t slots{};
+      for (size_t group{0}; group < workload.groups.size(); ++group) {
+        auto &config{workload.groups[group]};
+        for (size_t i{0}; i < config.count; ++i) {
+          auto name{config.name + "-" + std::to_string(i)};
+          OUTCOME_TRY(index->storageAttach(
+              StorageInfo{name, {}, 10, true, false, false},
+              FsStat{kStorageSpace, kStorageSpace, 0}));
+          workers.push_back(std::make_shared<SimWorker>(
+              group,
+              name,
+              WorkerInfo{name, config.resources},
+              config.durations));
+        }
+        slots += config.count * workerSlots(config, workload.seal_proof);
+      }
+      // action sleeps hold pool threads, so pool must not limit workers
+      scheduler = std::make_unique<SchedulerImpl>(
+          workload.seal_proof, nullptr, slots + 1);
+      for (auto &[task, max_batch] : workload.batch) {
+        scheduler->setTaskBatch(primitives::TaskType{task}, max_batch);
+      }
+      for (auto &worker : workers) {
+        auto handle{std::make_unique<WorkerHandle>()};
+        handle->worker = worker;
+        handle->info = worker->info;
+        scheduler->newWorker(std::move(handle));
+      }
+      return outcome::success();
+    }
+
+    bool run() {
+      for (size_t i{0}; i < workload.sectors; ++i) {
+        clock.at(static_cast<double>(i) * workload.arrival_s,
+                 [this, i] { submit(i, 0); });
+      }
+      auto heartbeat{std::chrono::steady_clock::now()};
+      return clock.run(
+          [this] {
+            std::lock_guard lock{mutex};
+            return sealed + failed == workload.sectors;
+          },
+          [&] {
+            // index skips storages without recent heartbeat
+            auto now{std::chrono::steady_clock::now()};
+            if (now - heartbeat < sector_storage::stores::kHeartbeatInterval) {
+              return;
+            }
+            heartbeat = now;
+            for (auto &worker : workers) {
+              [[maybe_unused]] auto res{index->storageReportHealth(
+                  worker->storage, {FsStat{kStorageSpace, kStorageSpace, 0}})};
+            }
+          });
+    }
+
+    void submit(size_t i, size_t stage) {
+      SectorId sector{kMinerId, i};
+      auto submitted{clock.now()};
+      scheduler->scheduleAsync(
+          sector,
+          kStages[stage].task,
+          stageSelector(stage, index, sector),
+          [this, sector, stage](const std::shared_ptr<Worker> &worker) {
+            SimActive active{clock};
+            return prepare(dynamic_cast<SimWorker &>(*worker), sector, stage);
+          },
+          [this, sector, stage, submitted](
+              const std::shared_ptr<Worker> &worker) {
+            SimActive active{clock};
+            return work(dynamic_cast<SimWorker &>(*worker),
+                        sector,
+                        stage,
+                        submitted);
+          },
+          [this, i, stage](outcome::result<void> res) {
+            if (!res) {
+              std::lock_guard lock{mutex};
+              ++failed;
+              ++errors[res.error().message()];
+            } else if (stage + 1 < kStages.size()) {
+              submit(i, stage + 1);
+            } else {
+              std::lock_guard lock{mutex};
+              ++sealed;
+            }
+            clock.touch();
+          },
+          sector_storage::kDefaultTaskPriority);
+    }
+
+    /// Moves input files missing on worker to its storage
+    outcome::result<void> prepare(SimWorker &worker,
+                                  const SectorId &sector,
+                                  size_t stage) {
+      auto input{kStages[stage].input};
+      if (input == kNoFiles) {
+        return outcome::success();
+      }
+      OUTCOME_TRY(found, index->storageFindSector(sector, input, boost::none));
+      for (auto &info : found) {
+        if (info.id == worker.storage) {
+          return outcome::success();
+        }
+      }
+      clock.sleep(workload.fetch_s);
+      for (auto type : primitives::sector_file::kSectorFileTypes) {
+        if ((input & type) == 0) {
+          continue;
+        }
+        OUTCOME_TRY(other, index->storageFindSector(sector, type, boost::none));
+        for (auto &info : other) {
+          OUTCOME_TRY(index->storageDropSector(info.id, sector, type));
+        }
+        OUTCOME_TRY(
+            index->storageDeclareSector(worker.storage, sector, type, true));
+      }
+      std::lock_guard lock{mutex};
+      ++fetches;
+      return outcome::success();
+    }
+
+    outcome::result<void> work(SimWorker &worker,
+                               const SectorId &sector,
+                               size_t stage,
+                               double submitted) {
+      auto &task{kStages[stage].task};
+      auto start{clock.now()};
+      {
+        std::lock_guard lock{mutex};
+        if (worker.working++ == 0) {
+          worker.busy_since = start;
+        }
+        auto &stat{stats[task]};
+        stat.queue_s.push_back(start - submitted);
+      }
+      auto duration{worker.durations.at(task)};
+      clock.sleep(duration);
+      auto output{kStages[stage].output};
+      for (auto type : primitives::sector_file::kSectorFileTypes) {
+        if ((output & type) != 0) {
+          OUTCOME_TRY(
+              index->storageDeclareSector(worker.storage, sector, type, true));
+        }
+      }
+      std::lock_guard lock{mutex};
+      auto end{clock.now()};
+      if (--worker.working == 0) {
+        worker.busy += end - worker.busy_since;
+      }
+      stats[task].work_s += duration;
+      return outcome::success();
+    }
+
+    Workload workload;
+    SimClock clock;
+    std::shared_ptr<SectorIndex> index{std::make_shared<SectorIndexImpl>()};
+    std::vector<std::shared_ptr<SimWorker>> workers;
+    std::unique_ptr<SchedulerImpl> scheduler;
+
+    /// Guards stats and worker busy time
+    std::mutex mutex;
+    size_t sealed{}, failed{}, fetches{};
+    std::map<std::string, size_t> errors;
+    std::map<std::string, TaskStat> stats;
+  };
+
+  outcome::result<double> jNumber(JIn j) {
+    if (!j->IsNumber()) {
+      return std::errc::invalid_argument;
+    }
+    return j->GetDouble();
+  }
+
+  outcome::result<RegisteredProof> sealProof(std::string_view size) {
+    static const std::map<std::string_view, RegisteredProof> proofs{
+        {"2KiB", RegisteredProof::StackedDRG2KiBSeal},
+        {"8MiB", RegisteredProof::StackedDRG8MiBSeal},
+        {"512MiB", RegisteredProof::StackedDRG512MiBSeal},
+        {"32GiB", RegisteredProof::StackedDRG32GiBSeal},
+        {"64GiB", RegisteredProof::StackedDRG64GiBSeal},
+    };
+    auto it{proofs.find(size)};
+    if (it == proofs.end()) {
+      return std::errc::invalid_argument;
+    }
+    return it->second;
+  }
+
+  outcome::result<Workload> loadWorkload(const std::string &path) {
+    std::ifstream file{path};
+    if (!file) {
+      return std::errc::no_such_file_or_directory;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    OUTCOME_TRY(j, codec::json::parse(text.str()));
+    Workload workload;
+    OUTCOME_TRY(j_proof, codec::json::jGet(&j, "seal_proof"));
+    OUTCOME_TRY(proof, codec::json::jStr(j_proof));
+    OUTCOME_TRYA(workload.seal_proof, sealProof(proof));
+    OUTCOME_TRY(j_sectors, codec::json::jGet(&j, "sectors"));
+    OUTCOME_TRYA(workload.sectors, codec::json::jUint(j_sectors));
+    OUTCOME_TRY(j_arrival, codec::json::jGet(&j, "arrival_s"));
+    OUTCOME_TRYA(workload.arrival_s, jNumber(j_arrival));
+    OUTCOME_TRY(j_fetch, codec::json::jGet(&j, "fetch_s"));
+    OUTCOME_TRYA(workload.fetch_s, jNumber(j_fetch));
+    if (auto j_batch{codec::json::jGet(&j, "batch")}; j_batch.has_value()) {
+      for (auto it{j_batch.value()->MemberBegin()};
+           it != j_batch.value()->MemberEnd();
+           ++it) {
+        OUTCOME_TRY(max_batch, codec::json::jUint(&it->value));
+        workload.batch[it->name.GetString()] = max_batch;
+      }
+    }
+    OUTCOME_TRY(j_workers, codec::json::jGet(&j, "workers"));
+    if (!j_workers->IsArray()) {
+      return std::errc::invalid_argument;
+    }
+    for (auto it{j_workers->Begin()}; it != j_workers->End(); ++it) {
+      auto &group{workload.groups.emplace_back()};
+      OUTCOME_TRY(j_name, codec::json::jGet(&*it, "name"));
+      OUTCOME_TRY(name, codec::json::jStr(j_name));
+      group.name = name;
+      OUTCOME_TRY(j_count, codec::json::jGet(&*it, "count"));
+      OUTCOME_TRYA(group.count, codec::json::jUint(j_count));
+      OUTCOME_TRY(j_memory, codec::json::jGet(&*it, "memory_gib"));
+      OUTCOME_TRY(memory, codec::json::jUint(j_memory));
+      group.resources.physical_memory = memory * kGiB;
+      auto j_swap{codec::json::jGet(&*it, "swap_gib")};
+      if (j_swap.has_value()) {
+        OUTCOME_TRY(swap, codec::json::jUint(j_swap.value()));
+        group.resources.swap_memory = swap * kGiB;
+      }
+      OUTCOME_TRY(j_cpus, codec::json::jGet(&*it, "cpus"));
+      OUTCOME_TRYA(group.resources.cpus, codec::json::jUint(j_cpus));
+      auto j_gpus{codec::json::jGet(&*it, "gpus")};
+      if (j_gpus.has_value()) {
+        OUTCOME_TRY(gpus, codec::json::jUint(j_gpus.value()));
+        for (size_t i{0}; i < gpus; ++i) {
+          group.resources.gpus.push_back("gpu" + std::to_string(i));
+        }
+      }
+      OUTCOME_TRY(j_tasks, codec::json::jGet(&*it, "tasks"));
+      for (auto task{j_tasks->MemberBegin()}; task != j_tasks->MemberEnd();
+           ++task) {
+        OUTCOME_TRY(seconds, jNumber(&task->value));
+        group.durations[task->name.GetString()] = seconds;
+      }
+    }
+    return workload;
+  }
+
+  double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+      return 0;
+    }
+    std::sort(values.begin(), values.end());
+    auto index{static_cast<size_t>(std::ceil(p * values.size()))};
+    return values[std::max<size_t>(index, 1) - 1];
+  }
+
+  int main(int argc, char **argv) {
+    if (argc != 2) {
+      std::cerr << "usage: " << argv[0] << " <workload.json>" << std::endl;
+      return 1;
+    }
+    auto workload{loadWorkload(argv[1])};
+    if (!workload) {
+      std::cerr << argv[1] << ": " << workload.error().message() << std::endl;
+      return 1;
+    }
+    std::chrono::milliseconds grace{2};
+    if (auto env{getenv("FC_SIM_GRACE_MS")}) {
+      grace = std::chrono::milliseconds{std::stoul(env)};
+    }
+    spdlog::set_level(spdlog::level::warn);
+
+    Sim sim{std::move(workload.value()), grace};
+    if (auto res{sim.setup()}; !res) {
+      std::cerr << "setup: " << res.error().message() << std::endl;
+      return 1;
+    }
+    auto wall_start{std::chrono::steady_clock::now()};
+    auto completed{sim.run()};
+    auto wall_seconds{std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - wall_start)
+                          .count()};
+    auto makespan{sim.clock.now()};
+    auto hours{makespan / 3600};
+
+    std::lock_guard lock{sim.mutex};
+    for (auto &stage : kStages) {
+      auto it{sim.stats.find(stage.task)};
+      if (it == sim.stats.end()) {
+        continue;
+      }
+      auto &stat{it->second};
+      auto count{stat.queue_s.size()};
+      std::cout << "{\"task\":\"" << stage.task << "\",\"count\":" << count
+                << ",\"per_hour\":" << (hours > 0 ? count / hours : 0.0)
+                << ",\"queue_p50_s\":" << percentile(stat.queue_s, 0.5)
+                << ",\"queue_p90_s\":" << percentile(stat.queue_s, 0.9)
+                << ",\"queue_max_s\":" << percentile(stat.queue_s, 1)
+                << ",\"work_mean_s\":"
+                << (count != 0 ? stat.work_s / count : 0.0) << "}"
+                << std::endl;
+    }
+    for (size_t group{0}; group < sim.workload.groups.size(); ++group) {
+      auto &config{sim.workload.groups[group]};
+      double busy{};
+      for (auto &worker : sim.workers) {
+        if (worker->group == group) {
+          busy += worker->busy;
+          if (worker->working != 0) {
+            busy += makespan - worker->busy_since;
+          }
+        }
+      }
+      auto capacity{static_cast<double>(config.count) * makespan};
+      std::cout << "{\"workers\":\"" << config.name
+                << "\",\"count\":" << config.count << ",\"utilization\":"
+                << (capacity > 0 ? busy / capacity : 0.0) << "}" << std::endl;
+    }
+    for (auto &[error, count] : sim.errors) {
+      std::cerr << "failed " << count << ": " << error << std::endl;
+    }
+    std::cout << "{\"total\":true"
+              << ",\"sectors\":" << sim.workload.sectors
+              << ",\"sealed\":" << sim.sealed << ",\"failed\":" << sim.failed
+              << ",\"stalled\":" << (completed ? "false" : "true")
+              << ",\"fetches\":" << sim.fetches << ",\"sim_hours\":" << hours
+              << ",\"sectors_per_day\":"
+              << (hours > 0 ? sim.sealed * 24 / hours : 0.0)
+              << ",\"wall_seconds\":" << wall_seconds << "}" << std::endl;
+    return completed && sim.failed == 0 ? 0 : 2;
+  }
+}  // namespace fc::benchmark
+
+int main(int argc, char **argv) {
+  return fc::benchmark::main(argc, argv);
+}
@@ -0,0 +1,246 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Replays chain segments through interpreter and reports per tipset apply
+ * time, gas, ipld usage and peak rss as json lines.
+ *
+ * Usage: tipset_replay <dir> [--profile <prefix>]
+ *
+ * Each segment in <dir> is "<name>.car" with blocks, messages and parent
+ * states, and "<name>.txt" with tipsets to apply in order, one tipset per
+ * line as space separated block cids. When next listed tipset is child of
+ * applied one, its parent state root is compared with computed.
+ * With --profile dvm profiler is enabled, flamegraph and prometheus stats are
+ * written to "<prefix>.folded" and "<prefix>.prom".
+ */
+
+#include <sys/resource.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#include "storage/car/car.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "vm/actor/cgo/actors.hpp"
+#include "vm/dvm/profiler.hpp"
+#include "vm/interpreter/impl/interpreter_impl.hpp"
+#include "vm/runtime/impl/tipset_randomness.hpp"
+
+namespace fc::benchmark {
+  namespace fs = boost::filesystem;
+  using primitives::GasAmount;
+  using primitives::tipset::Tipset;
+  using primitives::tipset::TipsetCPtr;
+  using storage::hamt::NodeCache;
+  using storage::ipfs::InMemoryDatastore;
+  using storage::ipfs::IpfsDatastore;
+  using vm::interpreter::InterpreterImpl;
+  using vm::runtime::MessageReceipt;
+  using vm::runtime::TipsetRandomness;
+
+  /// Counts reads and writes of wrapped datastore
+  class CountingDatastore
+      : public IpfsDatastore,
+        public std::enable_shared_from_this<CountingDatastore> {
+   public:
+    explicit CountingDatastore(IpldPtr ipld) : ipld_{std::move(ipld)} {}
+
+    outcome::result<bool> contains(const CID &key) const override {
+      return ipld_->contains(key);
+    }
+
+    outcome::result<void> set(const CID &key, Value value) override {
+      ++puts;
+      bytes_written += value.size();
+      return ipld_->set(key, std::move(value));
+    }
+
+    outcome::result<Value> get(const CID &key) const override {
+      OUTCOME_TRY(value, ipld_->get(key));
+      ++gets;
+      bytes_read += value.size();
+      return std::move(value);
+    }
+
+    outcome::result<void> remove(const CID &key) override {
+      return ipld_->remove(key);
+    }
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+    mutable size_t gets{};
+    mutable size_t bytes_read{};
+    size_t puts{};
+    size_t bytes_written{};
+
+   private:
+    IpldPtr ipld_;
+  };
+
+  /// Peak resident set size in bytes
+  uint64_t peakRss() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+  }
+
+  outcome::result<std::vector<std::vector<CID>>> readTipsets(
+      const std::string &path) {
+    std::vector<std::vector<CID>> tipsets;
+    std::ifstream file{path};
+    std::string line;
+    while (std::getline(file, line)) {
+      boost::trim(line);
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+      std::vector<std::string> strs;
+      boost::split(strs, line, boost::is_space(), boost::token_compress_on);
+      auto &cids{tipsets.emplace_back()};
+      for (auto &str : strs) {
+        OUTCOME_TRY(cid, CID::fromString(str));
+        cids.push_back(std::move(cid));
+      }
+    }
+    return tipsets;
+  }
+
+  struct Totals {
+    size_t tipsets{};
+    size_t messages{};
+    std::chrono::nanoseconds time{};
+    GasAmount gas{};
+    size_t mismatches{};
+  };
+
+  double gasPerSecond(GasAmount gas, std::chrono::nanoseconds time) {
+    return time.count() == 0 ? 0 : gas * 1e9 / time.count();
+  }
+
+  outcome::result<void> replaySegment(const std::string &name,
+                                      const fs::path &car_path,
+                                      const fs::path &tipsets_path,
+                                      const std::shared_ptr<NodeCache> &cache,
+                                      Totals &totals) {
+    auto memory{std::make_shared<InMemoryDatastore>()};
+    OUTCOME_TRY(storage::car::loadCar(*memory, car_path.string()));
+    auto ipld{std::make_shared<CountingDatastore>(memory)};
+    OUTCOME_TRY(tipsets, readTipsets(tipsets_path.string()));
+    for (size_t i{0}; i < tipsets.size(); ++i) {
+      OUTCOME_TRY(tipset, Tipset::load(*ipld, tipsets[i]));
+      InterpreterImpl interpreter{
+          std::make_shared<TipsetRandomness>(ipld, tipset), cache};
+      std::vector<MessageReceipt> receipts;
+      auto gets{ipld->gets}, bytes_read{ipld->bytes_read};
+      auto puts{ipld->puts}, bytes_written{ipld->bytes_written};
+      auto start{std::chrono::steady_clock::now()};
+      OUTCOME_TRY(result, interpreter.applyBlocks(ipld, tipset, &receipts));
+      auto time{std::chrono::steady_clock::now() - start};
+
+      GasAmount gas{};
+      for (auto &receipt : receipts) {
+        gas += receipt.gas_used;
+      }
+      std::string match{"null"};
+      if (i + 1 < tipsets.size()) {
+        OUTCOME_TRY(child, Tipset::load(*ipld, tipsets[i + 1]));
+        if (child->getParents() == tipset->key) {
+          auto ok{child->getParentStateRoot() == result.state_root};
+          match = ok ? "true" : "false";
+          if (!ok) {
+            ++totals.mismatches;
+          }
+        }
+      }
+      ++totals.tipsets;
+      totals.messages += receipts.size();
+      totals.time += time;
+      totals.gas += gas;
+
+      std::cout << "{\"segment\":\"" << name << "\""
+                << ",\"height\":" << tipset->height()
+                << ",\"blocks\":" << tipset->blks.size()
+                << ",\"messages\":" << receipts.size() << ",\"seconds\":"
+                << std::chrono::duration<double>(time).count()
+                << ",\"gas\":" << gas
+                << ",\"gas_per_second\":" << gasPerSecond(gas, time)
+                << ",\"ipld_gets\":" << ipld->gets - gets
+                << ",\"ipld_bytes_read\":" << ipld->bytes_read - bytes_read
+                << ",\"ipld_puts\":" << ipld->puts - puts
+                << ",\"ipld_bytes_written\":"
+                << ipld->bytes_written - bytes_written
+                << ",\"state_root\":\"" << result.state_root.toString().value()
+                << "\",\"state_match\":" << match
+                << ",\"peak_rss\":" << peakRss() << "}" << std::endl;
+    }
+    return outcome::success();
+  }
+
+  int main(int argc, char **argv) {
+    if (argc != 2 && !(argc == 4 && std::string{argv[2]} == "--profile")) {
+      std::cerr << "usage: " << argv[0] << " <dir> [--profile <prefix>]"
+                << std::endl;
+      return 1;
+    }
+    std::vector<fs::path> cars;
+    for (auto &entry : fs::directory_iterator{argv[1]}) {
+      if (entry.path().extension() == ".car") {
+        cars.push_back(entry.path());
+      }
+    }
+    std::sort(cars.begin(), cars.end());
+
+    vm::actor::cgo::config(
+        1 << 20,
+        UINT64_C(10) << 40,
+        {primitives::sector::RegisteredProof::StackedDRG32GiBSeal,
+         primitives::sector::RegisteredProof::StackedDRG64GiBSeal});
+    if (argc == 4) {
+      dvm::profileReset();
+      dvm::profiling = true;
+    }
+
+    auto cache{std::make_shared<NodeCache>()};
+    Totals totals;
+    for (auto &car : cars) {
+      auto tipsets{fs::path{car}.replace_extension(".txt")};
+      auto name{car.stem().string()};
+      auto replayed{replaySegment(name, car, tipsets, cache, totals)};
+      if (!replayed) {
+        std::cerr << name << ": " << replayed.error().message() << std::endl;
+        return 1;
+      }
+    }
+
+    if (argc == 4) {
+      dvm::profiling = false;
+      std::string prefix{argv[3]};
+      std::ofstream folded{prefix + ".folded"};
+      dvm::dumpFlamegraph(folded);
+      std::ofstream prom{prefix + ".prom"};
+      dvm::dumpPrometheus(prom);
+    }
+
+    std::cout << "{\"total\":true"
+              << ",\"segments\":" << cars.size()
+              << ",\"tipsets\":" << totals.tipsets
+              << ",\"messages\":" << totals.messages << ",\"seconds\":"
+              << std::chrono::duration<double>(totals.time).count()
+              << ",\"gas\":" << totals.gas << ",\"gas_per_second\":"
+              << gasPerSecond(totals.gas, totals.time)
+              << ",\"state_mismatches\":" << totals.mismatches
+              << ",\"peak_rss\":" << peakRss() << "}" << std::endl;
+    return totals.mismatches == 0 ? 0 : 2;
+  }
+}  // namespace fc::benchmark
+
+int main(int argc, char **argv) {
+  return fc::benchmark::main(argc, argv);
+}
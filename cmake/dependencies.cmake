@@ -60,6 +60,12 @@ find_package(cppcodec CONFIG REQUIRED)
 # http://rapidjson.org
 hunter_add_package(RapidJSON)
 find_package(RapidJSON CONFIG REQUIRED)
+# simd whitespace skipping in parser, same for all targets including rapidjson
+if (CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64")
+  add_compile_definitions(RAPIDJSON_SSE2)
+elseif (CMAKE_SYSTEM_PROCESSOR MATCHES "aarch64|arm64")
+  add_compile_definitions(RAPIDJSON_NEON)
+endif ()
 
 # https://github.com/soramitsu/libp2p-sqlite-modern-cpp/tree/hunter
 hunter_add_package(SQLiteModernCpp)
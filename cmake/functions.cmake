@@ -38,6 +38,26 @@ function(addtest_part test_name)
       )
 endfunction()
 
+# benchmark executable, its json results are written by benchmark_json target
+function(addbenchmark benchmark_name)
+  add_executable(${benchmark_name} ${ARGN})
+  target_link_libraries(${benchmark_name}
+      benchmark::benchmark_main
+      )
+  set_target_properties(${benchmark_name} PROPERTIES
+      RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}/benchmark_bin
+      )
+  file(MAKE_DIRECTORY ${CMAKE_BINARY_DIR}/benchmark_results)
+  add_custom_target(${benchmark_name}_json
+      COMMAND $<TARGET_FILE:${benchmark_name}>
+          --benchmark_format=console
+          --benchmark_out_format=json
+          --benchmark_out=${CMAKE_BINARY_DIR}/benchmark_results/${benchmark_name}.json
+      DEPENDS ${benchmark_name}
+      )
+  add_dependencies(benchmark_json ${benchmark_name}_json)
+endfunction()
+
 # conditionally applies flag. If flag is supported by current compiler, it will be added to compile options.
 function(add_flag flag)
   check_cxx_compiler_flag(${flag} FLAG_${flag})
@@ -10,7 +10,7 @@
 
 namespace fc::adt {
   std::string AddressKeyer::encode(const Key &key) {
-    auto bytes = primitives::address::encode(key);
+    auto bytes = primitives::address::encodeBytes(key);
     return {bytes.begin(), bytes.end()};
   }
 
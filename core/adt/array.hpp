@@ -21,6 +21,20 @@ namespace fc::adt {
 
     Array(const CID &root, IpldPtr ipld = nullptr) : amt{ipld, root} {}
 
+    /// Build flushed array of values bottom-up, writing each node once
+    template <typename Range>
+    static outcome::result<Array> fromValues(IpldPtr ipld,
+                                             const Range &values) {
+      std::vector<storage::amt::Value> encoded;
+      for (auto &value : values) {
+        OUTCOME_TRY(bytes, Ipld::encode(value));
+        encoded.push_back(std::move(bytes));
+      }
+      Array array;
+      OUTCOME_TRYA(array.amt, Amt::fromValues(ipld, std::move(encoded)));
+      return array;
+    }
+
     outcome::result<boost::optional<Value>> tryGet(Key key) const {
       auto maybe = get(key);
       if (!maybe) {
@@ -44,6 +58,35 @@ namespace fc::adt {
       return amt.setCbor(key, value);
     }
 
+    /// Get values by keys in one walk, missing keys are none
+    outcome::result<std::vector<boost::optional<Value>>> getMany(
+        const std::vector<Key> &keys) const {
+      OUTCOME_TRY(raws, amt.getMany(keys));
+      std::vector<boost::optional<Value>> values;
+      values.reserve(raws.size());
+      for (auto &raw : raws) {
+        if (raw) {
+          OUTCOME_TRY(value, amt.ipld->decode<Value>(*raw));
+          values.emplace_back(std::move(value));
+        } else {
+          values.emplace_back(boost::none);
+        }
+      }
+      return std::move(values);
+    }
+
+    /// Set values by keys in one walk
+    outcome::result<void> setMany(
+        const std::vector<std::pair<Key, Value>> &pairs) {
+      std::vector<std::pair<Key, storage::amt::Value>> encoded;
+      encoded.reserve(pairs.size());
+      for (auto &pair : pairs) {
+        OUTCOME_TRY(value, Ipld::encode(pair.second));
+        encoded.emplace_back(pair.first, std::move(value));
+      }
+      return amt.setMany(encoded);
+    }
+
     outcome::result<void> remove(Key key) {
       return amt.remove(key);
     }
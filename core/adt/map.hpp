@@ -38,6 +38,29 @@ namespace fc::adt {
     Map(const CID &root, IpldPtr ipld = nullptr)
         : hamt{ipld, root, bit_width} {}
 
+    /**
+     * Build flushed map bottom-up, writing each node once.
+     * Equal keys must be adjacent, e.g. pairs sorted by key, later wins.
+     */
+    template <typename Range>
+    static outcome::result<Map> fromSortedPairs(IpldPtr ipld,
+                                                const Range &pairs) {
+      std::vector<std::pair<std::string, storage::hamt::Value>> encoded;
+      for (auto &pair : pairs) {
+        OUTCOME_TRY(value, Ipld::encode(pair.second));
+        auto key{Keyer::encode(pair.first)};
+        if (!encoded.empty() && encoded.back().first == key) {
+          encoded.back().second = std::move(value);
+        } else {
+          encoded.emplace_back(std::move(key), std::move(value));
+        }
+      }
+      Map map;
+      OUTCOME_TRYA(map.hamt,
+                   Hamt::fromPairs(ipld, std::move(encoded), bit_width));
+      return map;
+    }
+
     outcome::result<boost::optional<Value>> tryGet(const Key &key) const {
       return hamt.tryGetCbor<Value>(Keyer::encode(key));
     }
@@ -54,6 +77,40 @@ namespace fc::adt {
       return hamt.setCbor(Keyer::encode(key), value);
     }
 
+    /// Get values by keys in one walk, missing keys are none
+    outcome::result<std::vector<boost::optional<Value>>> getMany(
+        const std::vector<Key> &keys) const {
+      std::vector<std::string> encoded;
+      encoded.reserve(keys.size());
+      for (auto &key : keys) {
+        encoded.push_back(Keyer::encode(key));
+      }
+      OUTCOME_TRY(raws, hamt.getMany(encoded));
+      std::vector<boost::optional<Value>> values;
+      values.reserve(raws.size());
+      for (auto &raw : raws) {
+        if (raw) {
+          OUTCOME_TRY(value, hamt.ipld->decode<Value>(*raw));
+          values.emplace_back(std::move(value));
+        } else {
+          values.emplace_back(boost::none);
+        }
+      }
+      return std::move(values);
+    }
+
+    /// Set values by keys in one walk
+    outcome::result<void> setMany(
+        const std::vector<std::pair<Key, Value>> &pairs) {
+      std::vector<std::pair<std::string, storage::hamt::Value>> encoded;
+      encoded.reserve(pairs.size());
+      for (auto &pair : pairs) {
+        OUTCOME_TRY(value, Ipld::encode(pair.second));
+        encoded.emplace_back(Keyer::encode(pair.first), std::move(value));
+      }
+      return hamt.setMany(encoded);
+    }
+
     outcome::result<void> remove(const Key &key) {
       return hamt.remove(Keyer::encode(key));
     }
@@ -166,6 +166,8 @@ namespace fc::api {
   };
 
   using MarketDealMap = std::map<std::string, StorageDeal>;
+  /// New actors by address
+  using ChangedActors = std::map<std::string, Actor>;
 
   struct MinerPower {
     Claim miner, total;
@@ -329,9 +331,18 @@ namespace fc::api {
                TipsetCPtr,
                ChainEpoch,
                const TipsetKey &)
+    /// Tipsets with heights in range on chain of tipset, ascending
+    API_METHOD(ChainGetTipSetRange,
+               std::vector<TipsetCPtr>,
+               ChainEpoch,
+               ChainEpoch,
+               const TipsetKey &)
+    API_METHOD(ChainHasObj, bool, const CID &)
     API_METHOD(ChainHead, TipsetCPtr)
     API_METHOD(ChainNotify, Chan<std::vector<HeadChange>>)
     API_METHOD(ChainReadObj, Buffer, CID)
+    /// Read objects in one call, fails if any is missing
+    API_METHOD(ChainReadObjs, std::vector<Buffer>, const std::vector<CID> &)
     API_METHOD(ChainSetHead, void, const TipsetKey &)
     API_METHOD(ChainTipSetWeight, TipsetWeight, const TipsetKey &)
 
@@ -398,6 +409,8 @@ namespace fc::api {
                InvocResult,
                const UnsignedMessage &,
                const TipsetKey &)
+    /// Actors added or modified from old state root to new one, by address
+    API_METHOD(StateChangedActors, ChangedActors, const CID &, const CID &)
     API_METHOD(StateListMessages,
                std::vector<CID>,
                const UnsignedMessage &,
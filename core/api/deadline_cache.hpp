@@ -0,0 +1,75 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "api/api.hpp"
+#include "common/lru_cache.hpp"
+#include "common/todo_error.hpp"
+#include "vm/actor/builtin/v0/miner/types.hpp"
+
+namespace fc::api {
+  using vm::actor::builtin::v0::miner::Deadline;
+  using vm::actor::builtin::v0::miner::MinerActorState;
+
+  /**
+   * Partition bitsets of miner deadlines by deadline cid.
+   * Deadlines are content addressed, so entries are valid for any state root
+   * and shared by tipsets where deadline didn't change.
+   * Only requested deadline and its partitions are decoded, expiration and
+   * termination arrays are not read.
+   */
+  class DeadlineCache {
+   public:
+    using Partitions = std::shared_ptr<const std::vector<Partition>>;
+
+    /// Weight of entry is number of partitions
+    static constexpr size_t kDefaultMaxPartitions{1 << 14};
+
+    explicit DeadlineCache(size_t max_partitions = kDefaultMaxPartitions)
+        : cache_{max_partitions} {}
+
+    /// Partitions of deadline, decoded on first request
+    outcome::result<Partitions> partitions(const CIDT<Deadline> &deadline) {
+      {
+        std::lock_guard lock{mutex_};
+        if (auto parts{cache_.get(deadline)}) {
+          return *parts;
+        }
+      }
+      OUTCOME_TRY(_deadline, deadline.get());
+      auto parts{std::make_shared<std::vector<Partition>>()};
+      OUTCOME_TRY(_deadline.partitions.visit([&](auto, auto &part) {
+        parts->push_back({
+            part.sectors,
+            part.faults,
+            part.recoveries,
+            part.sectors - part.terminated,
+            part.sectors - part.terminated - part.faults,
+        });
+        return outcome::success();
+      }));
+      std::lock_guard lock{mutex_};
+      cache_.put(deadline, parts, std::max<size_t>(parts->size(), 1));
+      return parts;
+    }
+
+    /// Partitions of deadline with index in miner state
+    outcome::result<Partitions> partitions(const MinerActorState &state,
+                                           uint64_t index) {
+      OUTCOME_TRY(deadlines, state.deadlines.get());
+      if (index >= deadlines.due.size()) {
+        return TodoError::kError;
+      }
+      return partitions(deadlines.due[index]);
+    }
+
+   private:
+    std::mutex mutex_;
+    common::LruCache<CID, Partitions> cache_;
+  };
+}  // namespace fc::api
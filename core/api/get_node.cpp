@@ -6,6 +6,7 @@
 #include "api/make.hpp"
 
 #include <boost/algorithm/string.hpp>
+#include <boost/container_hash/hash.hpp>
 
 #include "codec/cbor/cbor_resolve.hpp"
 
@@ -16,54 +17,98 @@ namespace fc::api {
   using storage::amt::Amt;
   using storage::hamt::Hamt;
 
+  outcome::result<Buffer> collectionGet(const std::shared_ptr<Ipld> &ipld,
+                                        const CID &cid,
+                                        const std::string &part) {
+    if (starts_with(part, "@A:")) {
+      OUTCOME_TRY(index, parseIndex(part.substr(3)));
+      return Amt{ipld, cid}.get(index);
+    }
+    std::string key;
+    if (starts_with(part, "@Hi:")) {
+      auto neg = part.size() >= 5 && part[4] == '-';
+      OUTCOME_TRY(value, parseIndex(part.substr(neg ? 5 : 4)));
+      key = adt::VarintKeyer::encode(neg ? -value : value);
+    } else if (starts_with(part, "@Hu:")) {
+      OUTCOME_TRY(value, parseIndex(part.substr(4)));
+      key = adt::UvarintKeyer::encode(value);
+    } else if (starts_with(part, "@Ha:")) {
+      OUTCOME_TRY(address,
+                  primitives::address::decodeFromString(part.substr(4)));
+      key = adt::AddressKeyer::encode(address);
+    } else {
+      key = part.substr(3);
+    }
+    return Hamt{ipld, cid}.get(key);
+  }
+
+  bool isCollectionKey(const std::string &part) {
+    return starts_with(part, "@A:") || starts_with(part, "@H:")
+           || starts_with(part, "@Hi:") || starts_with(part, "@Hu:")
+           || starts_with(part, "@Ha:");
+  }
+
+  size_t PathCache::KeyHash::operator()(const Key &key) const {
+    size_t seed{std::hash<CID>{}(key.first)};
+    boost::hash_combine(seed, key.second);
+    return seed;
+  }
+
+  PathCache::Key PathCache::key(const CID &root,
+                                gsl::span<const std::string> prefix) {
+    return {root, boost::join(prefix, "/")};
+  }
+
+  boost::optional<CID> PathCache::get(const CID &root,
+                                      gsl::span<const std::string> prefix) {
+    auto _key{key(root, prefix)};
+    std::lock_guard lock{mutex_};
+    return cache_.get(_key);
+  }
+
+  void PathCache::put(const CID &root,
+                      gsl::span<const std::string> prefix,
+                      const CID &cid) {
+    auto _key{key(root, prefix)};
+    std::lock_guard lock{mutex_};
+    cache_.put(_key, cid, 1);
+  }
+
   outcome::result<IpldObject> getNode(std::shared_ptr<Ipld> ipld,
                                       const CID &root,
-                                      gsl::span<const std::string> parts) {
+                                      gsl::span<const std::string> parts,
+                                      PathCache *cache) {
     if (root.content_type != libp2p::multi::MulticodecType::DAG_CBOR) {
       return TodoError::kError;
     }
-    OUTCOME_TRY(raw, ipld->get(root));
+    auto start{root};
+    size_t i{0};
+    if (cache) {
+      for (auto n{parts.size()}; n != 0; --n) {
+        if (auto cid{cache->get(root, parts.first(n))}) {
+          start = *cid;
+          i = n;
+          break;
+        }
+      }
+    }
+    OUTCOME_TRY(raw, ipld->get(start));
     try {
       CborDecodeStream s{raw};
-      for (auto i = 0u; i < parts.size(); ++i) {
+      // cid of block when stream is at its root, so it isn't hashed again
+      boost::optional<CID> block{start};
+      for (; i < parts.size(); ++i) {
         auto &part = parts[i];
-        auto a = starts_with(part, "@A:");
-        auto hi = starts_with(part, "@Hi:");
-        auto hu = starts_with(part, "@Hu:");
-        auto ha = starts_with(part, "@Ha:");
-        auto h = starts_with(part, "@H:");
-        if (a || hi || hu || ha || h) {
-          raw = Buffer{s.raw()};
-          OUTCOME_TRY(cid, common::getCidOf(raw));
-          if (a) {
-            OUTCOME_TRY(index, parseIndex(part.substr(3)));
-            OUTCOME_TRY(raw2, Amt{ipld, cid}.get(index));
-            s = CborDecodeStream{raw2};
-          } else {
-            std::string key;
-            if (hi) {
-              auto neg = part.size() >= 4 && part[4] == '-';
-              OUTCOME_TRY(value, parseIndex(part.substr(neg ? 5 : 4)));
-              key = adt::VarintKeyer::encode(neg ? -value : value);
-            } else if (hu) {
-              OUTCOME_TRY(value, parseIndex(part.substr(4)));
-              key = adt::UvarintKeyer::encode(value);
-            } else if (ha) {
-              OUTCOME_TRY(
-                  address,
-                  primitives::address::decodeFromString(part.substr(4)));
-              key = adt::AddressKeyer::encode(address);
-            } else {
-              key = part.substr(3);
-            }
-            OUTCOME_TRY(raw2, Hamt{ipld, cid}.get(key));
-            s = CborDecodeStream{raw2};
+        if (isCollectionKey(part)) {
+          if (!block) {
+            OUTCOME_TRYA(block, common::getCidOf(s.raw()));
           }
-          parts = parts.subspan(1);
-          break;
+          OUTCOME_TRY(value, collectionGet(ipld, *block, part));
+          s = CborDecodeStream{value};
         } else {
           OUTCOME_TRY(codec::cbor::resolve(s, part));
         }
+        block = boost::none;
         if (s.isCid()) {
           auto s2 = s;
           CID cid;
@@ -71,6 +116,10 @@ namespace fc::api {
           if (cid.content_type == libp2p::multi::MulticodecType::DAG_CBOR) {
             OUTCOME_TRY(raw2, ipld->get(cid));
             s = CborDecodeStream{raw2};
+            if (cache) {
+              cache->put(root, parts.first(i + 1), cid);
+            }
+            block = std::move(cid);
           } else {
             if (i != parts.size() - 1) {
               return TodoError::kError;
@@ -79,6 +128,9 @@ namespace fc::api {
         }
       }
       raw = Buffer{s.raw()};
+      if (block) {
+        return IpldObject{std::move(*block), std::move(raw)};
+      }
       OUTCOME_TRY(cid, common::getCidOf(raw));
       return IpldObject{std::move(cid), std::move(raw)};
     } catch (std::system_error &e) {
@@ -6,14 +6,21 @@
 #include "api/make.hpp"
 
 #include <boost/algorithm/string.hpp>
+#include <mutex>
 #include <libp2p/peer/peer_id.hpp>
 
+#include "api/deadline_cache.hpp"
 #include "blockchain/production/block_producer.hpp"
 #include "const.hpp"
 #include "drand/beaconizer.hpp"
 #include "node/pubsub.hpp"
+#include "power/power_snapshot.hpp"
+#include "primitives/block/block_view.hpp"
 #include "proofs/proofs.hpp"
+#include "storage/car/car.hpp"
 #include "storage/hamt/hamt.hpp"
+#include "storage/hamt/node_cache.hpp"
+#include "storage/unixfs/unixfs.hpp"
 #include "vm/actor/builtin/v0/account/account_actor.hpp"
 #include "vm/actor/builtin/v0/init/init_actor.hpp"
 #include "vm/actor/builtin/v0/market/actor.hpp"
@@ -21,9 +28,10 @@
 #include "vm/actor/builtin/v0/storage_power/storage_power_actor_state.hpp"
 #include "vm/actor/impl/invoker_impl.hpp"
 #include "vm/message/impl/message_signer_impl.hpp"
+#include "vm/message/message_view.hpp"
 #include "vm/runtime/env.hpp"
 #include "vm/runtime/impl/tipset_randomness.hpp"
-#include "vm/state/impl/state_tree_impl.hpp"
+#include "vm/state/impl/overlay_state_tree.hpp"
 
 #define MOVE(x)  \
   x {            \
@@ -35,7 +43,6 @@ namespace fc::api {
   using vm::actor::kInitAddress;
   using vm::actor::kStorageMarketAddress;
   using vm::actor::kStoragePowerAddress;
-  using vm::actor::builtin::v0::account::AccountActorState;
   using vm::actor::builtin::v0::init::InitActorState;
   using vm::actor::builtin::v0::market::DealState;
   using vm::actor::builtin::v0::miner::MinerActorState;
@@ -44,14 +51,20 @@ namespace fc::api {
   using crypto::randomness::DomainSeparationTag;
   using crypto::signature::BlsSignature;
   using libp2p::peer::PeerId;
+  using power::PowerSnapshotCache;
+  using primitives::block::BlockHeaderView;
   using primitives::block::MsgMeta;
   using vm::isVMExitCode;
   using vm::normalizeVMExitCode;
   using vm::VMExitCode;
   using vm::actor::InvokerImpl;
+  using vm::message::MessageView;
   using vm::runtime::Env;
+  using vm::runtime::RandomnessCache;
   using vm::runtime::TipsetRandomness;
+  using vm::state::OverlayStateTree;
   using vm::state::StateTreeImpl;
+  using storage::hamt::NodeCache;
   using connection_t = boost::signals2::connection;
   using MarketActorState = vm::actor::builtin::v0::market::State;
 
@@ -63,7 +76,9 @@ namespace fc::api {
                : claim_qa > kConsensusMinerMinPower;
   }
 
-  constexpr EpochDuration kWinningPoStSectorSetLookback{10};
+
+  /// Resolved path prefixes of ChainGetNode
+  constexpr size_t kPathCacheSize{1 << 16};
 
   void beaconEntriesForBlock(const DrandSchedule &schedule,
                              Beaconizer &beaconizer,
@@ -93,13 +108,34 @@ namespace fc::api {
     };
   }
 
+  /// Decoded states of singleton actors, shared by copies of cached context
+  struct HotStates {
+    std::mutex mutex;
+    boost::optional<MarketActorState> market;
+    boost::optional<StoragePowerActorState> power;
+    boost::optional<InitActorState> init;
+  };
+
   struct TipsetContext {
     TipsetCPtr tipset;
     StateTreeImpl state_tree;
     boost::optional<InterpreterResult> interpreted;
+    std::shared_ptr<HotStates> hot{std::make_shared<HotStates>()};
+
+    template <typename T>
+    outcome::result<T> hotState(boost::optional<T> HotStates::*field,
+                                const Address &address) {
+      std::lock_guard lock{hot->mutex};
+      auto &state{(*hot).*field};
+      if (!state) {
+        OUTCOME_TRY(_state, state_tree.state<T>(address));
+        state = std::move(_state);
+      }
+      return *state;
+    }
 
     auto marketState() {
-      return state_tree.state<MarketActorState>(kStorageMarketAddress);
+      return hotState(&HotStates::market, kStorageMarketAddress);
     }
 
     auto minerState(const Address &address) {
@@ -107,38 +143,56 @@ namespace fc::api {
     }
 
     auto powerState() {
-      return state_tree.state<StoragePowerActorState>(kStoragePowerAddress);
+      return hotState(&HotStates::power, kStoragePowerAddress);
+    }
+
+    const CID &stateRoot() const {
+      return interpreted ? interpreted->state_root
+                         : tipset->getParentStateRoot();
     }
 
     auto initState() {
-      return state_tree.state<InitActorState>(kInitAddress);
+      return hotState(&HotStates::init, kInitAddress);
     }
 
     outcome::result<Address> accountKey(const Address &id) {
-      // TODO(turuslan): error if not account
-      OUTCOME_TRY(state, state_tree.state<AccountActorState>(id));
-      return state.address;
+      return vm::runtime::resolveKey(state_tree, id);
     }
   };
 
+  /**
+   * Recent contexts by resolved tipset key, with and without interpretation.
+   * Cached context is never used directly, callers get copies sharing hamt
+   * node cache and hot actor states.
+   */
+  struct TipsetContextCache {
+    static constexpr size_t kSize{16};
+
+    std::mutex mutex;
+    common::LruCache<TipsetKey, TipsetContext> parent{kSize};
+    common::LruCache<TipsetKey, TipsetContext> interpreted{kSize};
+  };
+
+  /// Proving sectors without faults, doesn't depend on randomness
+  outcome::result<RleBitset> getWinningPoStSectorSet(
+      MinerActorState &state, DeadlineCache &deadline_cache) {
+    RleBitset sectors_bitset;
+    OUTCOME_TRY(deadlines, state.deadlines.get());
+    for (auto &deadline : deadlines.due) {
+      OUTCOME_TRY(parts, deadline_cache.partitions(deadline));
+      for (auto &part : *parts) {
+        sectors_bitset += part.all - part.faulty;
+      }
+    }
+    return sectors_bitset;
+  }
+
   outcome::result<std::vector<SectorInfo>> getSectorsForWinningPoSt(
       const Address &miner,
       MinerActorState &state,
+      const RleBitset &sectors_bitset,
       const Randomness &post_rand) {
     std::vector<SectorInfo> sectors;
-    RleBitset sectors_bitset;
-    OUTCOME_TRY(deadlines, state.deadlines.get());
-    for (auto &_deadline : deadlines.due) {
-      OUTCOME_TRY(deadline, _deadline.get());
-      OUTCOME_TRY(deadline.partitions.visit([&](auto, auto &part) {
-        for (auto sector : part.sectors) {
-          if (!part.faults.has(sector)) {
-            sectors_bitset.insert(sector);
-          }
-        }
-        return outcome::success();
-      }));
-    }
     if (!sectors_bitset.empty()) {
       OUTCOME_TRY(minfo, state.info.get());
       OUTCOME_TRY(win_type,
@@ -167,7 +221,32 @@ namespace fc::api {
                std::shared_ptr<Beaconizer> beaconizer,
                std::shared_ptr<DrandSchedule> drand_schedule,
                std::shared_ptr<PubSub> pubsub,
-               std::shared_ptr<KeyStore> key_store) {
+               std::shared_ptr<KeyStore> key_store,
+               std::shared_ptr<HeightIndex> height_index,
+               std::shared_ptr<TipsetCache> tipset_cache,
+               std::shared_ptr<AddressIndex> address_index,
+               std::shared_ptr<ResultCache> result_cache) {
+    // shared by state trees of tipset contexts and overlays of StateCall
+    auto hamt_cache{std::make_shared<NodeCache>()};
+    if (!tipset_cache) {
+      tipset_cache = std::make_shared<TipsetCache>();
+    }
+    auto loadTipset{
+        [=](const TipsetKey &tipset_key) -> outcome::result<TipsetCPtr> {
+          if (auto tipset{tipset_cache->get(tipset_key)}) {
+            return std::move(tipset);
+          }
+          OUTCOME_TRY(tipset, chain_store->loadTipset(tipset_key));
+          tipset_cache->put(tipset);
+          return std::move(tipset);
+        }};
+    auto context_cache{std::make_shared<TipsetContextCache>()};
+    auto power_snapshots{std::make_shared<PowerSnapshotCache>(ipld)};
+    auto block_bodies{
+        std::make_shared<blockchain::production::BlockBodyCache>()};
+    auto randomness_cache{std::make_shared<RandomnessCache>()};
+    auto deadline_cache{std::make_shared<DeadlineCache>()};
+    auto path_cache{std::make_shared<PathCache>(kPathCacheSize)};
     auto tipsetContext = [=](const TipsetKey &tipset_key,
                              bool interpret =
                                  false) -> outcome::result<TipsetContext> {
@@ -175,26 +254,69 @@ namespace fc::api {
       if (tipset_key.cids().empty()) {
         tipset = chain_store->heaviestTipset();
       } else {
-        OUTCOME_TRYA(tipset, chain_store->loadTipset(tipset_key));
+        OUTCOME_TRYA(tipset, loadTipset(tipset_key));
       }
-      TipsetContext context{tipset, {ipld, tipset->getParentStateRoot()}, {}};
+      auto &cache{interpret ? context_cache->interpreted
+                            : context_cache->parent};
+      {
+        std::lock_guard lock{context_cache->mutex};
+        if (auto context{cache.get(tipset->key)}) {
+          return std::move(*context);
+        }
+      }
+      TipsetContext context{
+          tipset, {ipld, tipset->getParentStateRoot(), hamt_cache}, {}};
       if (interpret) {
         OUTCOME_TRY(result, interpreter->interpret(ipld, tipset));
-        context.state_tree = {ipld, result.state_root};
+        context.state_tree = {ipld, result.state_root, hamt_cache};
         context.interpreted = result;
       }
+      std::lock_guard lock{context_cache->mutex};
+      cache.put(tipset->key, context, 1);
       return context;
     };
+    auto resultKey{[](const std::string &method,
+                      const auto &... params) -> outcome::result<Buffer> {
+      try {
+        auto s{codec::cbor::CborEncodeStream::list()};
+        s << method;
+        (s << ... << params);
+        return Buffer{s.data()};
+      } catch (std::system_error &e) {
+        return outcome::failure(e.code());
+      }
+    }};
+    // result of f(tipset_key) for method enabled in result cache, empty tipset
+    // key is resolved to head first
+    auto cached{[=](const std::string &method,
+                    const TipsetKey &tipset_key,
+                    auto &&f,
+                    const auto &... params) {
+      using R = std::decay_t<decltype(f(tipset_key).value())>;
+      if (!result_cache || !result_cache->enabled(method)) {
+        return f(tipset_key);
+      }
+      auto resolved{tipset_key.cids().empty()
+                        ? chain_store->heaviestTipset()->key
+                        : tipset_key};
+      auto key{resultKey(method, resolved.cids(), params...)};
+      if (!key) {
+        return f(resolved);
+      }
+      return result_cache->get<R>(key.value(), [&] { return f(resolved); });
+    }};
     auto getLookbackTipSetForRound =
         [=](auto tipset, auto epoch) -> outcome::result<TipsetContext> {
       auto lookback{
           std::max(ChainEpoch{0}, epoch - kWinningPoStSectorSetLookback)};
+      if (height_index) {
+        // lowest tipset from lookback, loop below steps over null round
+        OUTCOME_TRYA(tipset, height_index->get(tipset, lookback));
+      }
       while (tipset->height() > static_cast<uint64_t>(lookback)) {
-        OUTCOME_TRYA(tipset, tipset->loadParent(*ipld));
+        OUTCOME_TRYA(tipset, tipset_cache->loadParent(*ipld, *tipset));
       }
-      OUTCOME_TRY(result, interpreter->interpret(ipld, tipset));
-      return TipsetContext{
-          std::move(tipset), {ipld, std::move(result.state_root)}, {}};
+      return tipsetContext(tipset->key, true);
     };
     return {
         .AuthNew = {[](auto) {
@@ -209,8 +331,10 @@ namespace fc::api {
         .ChainGetBlockMessages = {[=](auto &block_cid)
                                       -> outcome::result<BlockMessages> {
           BlockMessages messages;
-          OUTCOME_TRY(block, ipld->getCbor<BlockHeader>(block_cid));
-          OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(block.messages));
+          OUTCOME_TRY(block_bytes, ipld->get(block_cid));
+          OUTCOME_TRY(block, BlockHeaderView::make(block_bytes));
+          OUTCOME_TRY(meta_cid, block.messages());
+          OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(meta_cid));
           OUTCOME_TRY(meta.bls_messages.visit(
               [&](auto, auto &cid) -> outcome::result<void> {
                 OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
@@ -237,7 +361,8 @@ namespace fc::api {
             return TodoError::kError;
           }
           OUTCOME_TRY(root, CID::fromString(parts[2]));
-          return getNode(ipld, root, gsl::make_span(parts).subspan(3));
+          return getNode(
+              ipld, root, gsl::make_span(parts).subspan(3), path_cache.get());
         }},
         .ChainGetMessage = {[=](auto &cid) -> outcome::result<UnsignedMessage> {
           auto res = ipld->getCbor<SignedMessage>(cid);
@@ -250,10 +375,14 @@ namespace fc::api {
         .ChainGetParentMessages =
             {[=](auto &block_cid) -> outcome::result<std::vector<CidMessage>> {
               std::vector<CidMessage> messages;
-              OUTCOME_TRY(block, ipld->getCbor<BlockHeader>(block_cid));
-              for (auto &parent_cid : block.parents) {
-                OUTCOME_TRY(parent, ipld->getCbor<BlockHeader>(parent_cid));
-                OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(parent.messages));
+              OUTCOME_TRY(block_bytes, ipld->get(block_cid));
+              OUTCOME_TRY(block, BlockHeaderView::make(block_bytes));
+              OUTCOME_TRY(parents, block.parents());
+              for (auto &parent_cid : parents) {
+                OUTCOME_TRY(parent_bytes, ipld->get(parent_cid));
+                OUTCOME_TRY(parent, BlockHeaderView::make(parent_bytes));
+                OUTCOME_TRY(meta_cid, parent.messages());
+                OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(meta_cid));
                 OUTCOME_TRY(meta.bls_messages.visit(
                     [&](auto, auto &cid) -> outcome::result<void> {
                       OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
@@ -272,10 +401,19 @@ namespace fc::api {
         .ChainGetParentReceipts =
             {[=](auto &block_cid)
                  -> outcome::result<std::vector<MessageReceipt>> {
-              OUTCOME_TRY(block, ipld->getCbor<BlockHeader>(block_cid));
-              return adt::Array<MessageReceipt>{block.parent_message_receipts,
-                                                ipld}
-                  .values();
+              auto get{[&]() -> outcome::result<std::vector<MessageReceipt>> {
+                OUTCOME_TRY(block_bytes, ipld->get(block_cid));
+                OUTCOME_TRY(block, BlockHeaderView::make(block_bytes));
+                OUTCOME_TRY(receipts, block.parentMessageReceipts());
+                return adt::Array<MessageReceipt>{receipts, ipld}.values();
+              }};
+              std::string method{"ChainGetParentReceipts"};
+              if (result_cache && result_cache->enabled(method)) {
+                OUTCOME_TRY(key, resultKey(method, block_cid));
+                return result_cache->get<std::vector<MessageReceipt>>(key,
+                                                                      get);
+              }
+              return get();
             }},
         .ChainGetRandomnessFromBeacon = {[=](auto &tipset_key,
                                              auto tag,
@@ -283,7 +421,8 @@ namespace fc::api {
                                              auto &entropy)
                                              -> outcome::result<Randomness> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
-          return context.tipset->beaconRandomness(*ipld, tag, epoch, entropy);
+          return context.tipset->beaconRandomness(
+              *ipld, tag, epoch, entropy, randomness_cache.get());
         }},
         .ChainGetRandomnessFromTickets = {[=](auto &tipset_key,
                                               auto tag,
@@ -291,23 +430,26 @@ namespace fc::api {
                                               auto &entropy)
                                               -> outcome::result<Randomness> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
-          return context.tipset->ticketRandomness(*ipld, tag, epoch, entropy);
+          return context.tipset->ticketRandomness(
+              *ipld, tag, epoch, entropy, randomness_cache.get());
         }},
         .ChainGetTipSet = {[=](auto &tipset_key) {
-          return chain_store->loadTipset(tipset_key);
+          return loadTipset(tipset_key);
         }},
         .ChainGetTipSetByHeight = {[=](auto height2, auto &tipset_key)
                                        -> outcome::result<TipsetCPtr> {
-          // TODO(turuslan): use height index from chain store
           // TODO(turuslan): return genesis if height is zero
           auto height = static_cast<uint64_t>(height2);
           OUTCOME_TRY(context, tipsetContext(tipset_key));
           auto &tipset{context.tipset};
+          if (height_index) {
+            return height_index->get(tipset, height);
+          }
           if (tipset->height() < height) {
             return TodoError::kError;
           }
           while (tipset->height() > height) {
-            OUTCOME_TRY(parent, tipset->loadParent(*ipld));
+            OUTCOME_TRY(parent, tipset_cache->loadParent(*ipld, *tipset));
             if (parent->height() < height) {
               break;
             }
@@ -315,6 +457,35 @@ namespace fc::api {
           }
           return std::move(tipset);
         }},
+        .ChainGetTipSetRange = {[=](auto min, auto max, auto &tipset_key)
+                                    -> outcome::result<
+                                        std::vector<TipsetCPtr>> {
+          std::vector<TipsetCPtr> tipsets;
+          OUTCOME_TRY(context, tipsetContext(tipset_key));
+          auto tipset{context.tipset};
+          if (min > max || tipset->epoch() < min) {
+            return tipsets;
+          }
+          if (height_index && tipset->epoch() > max) {
+            OUTCOME_TRYA(tipset, height_index->get(tipset, max));
+          }
+          while (true) {
+            if (tipset->epoch() <= max) {
+              tipsets.push_back(tipset);
+            }
+            if (tipset->height() == 0) {
+              break;
+            }
+            OUTCOME_TRY(parent, tipset_cache->loadParent(*ipld, *tipset));
+            if (parent->epoch() < min) {
+              break;
+            }
+            tipset = std::move(parent);
+          }
+          std::reverse(tipsets.begin(), tipsets.end());
+          return tipsets;
+        }},
+        .ChainHasObj = {[=](auto &cid) { return ipld->contains(cid); }},
         .ChainHead = {[=]() { return chain_store->heaviestTipset(); }},
         .ChainNotify = {[=]() {
           auto channel = std::make_shared<Channel<std::vector<HeadChange>>>();
@@ -328,19 +499,37 @@ namespace fc::api {
           return Chan{std::move(channel)};
         }},
         .ChainReadObj = {[=](const auto &cid) { return ipld->get(cid); }},
+        .ChainReadObjs = {[=](auto &cids)
+                              -> outcome::result<std::vector<Buffer>> {
+          std::vector<Buffer> objects;
+          objects.reserve(cids.size());
+          for (auto &cid : cids) {
+            OUTCOME_TRY(object, ipld->get(cid));
+            objects.push_back(std::move(object));
+          }
+          return objects;
+        }},
         // TODO(turuslan): FIL-165 implement method
         .ChainSetHead = {},
         .ChainTipSetWeight = {[=](auto &tipset_key)
                                   -> outcome::result<TipsetWeight> {
-          OUTCOME_TRY(tipset, chain_store->loadTipset(tipset_key));
+          OUTCOME_TRY(tipset, loadTipset(tipset_key));
           return weight_calculator->calculateWeight(*tipset);
         }},
         // TODO(turuslan): FIL-165 implement method
         .ClientFindData = {},
         // TODO(turuslan): FIL-165 implement method
         .ClientHasLocal = {},
-        // TODO(turuslan): FIL-165 implement method
-        .ClientImport = {},
+        .ClientImport = {[=](auto &file) -> outcome::result<CID> {
+          if (file.is_car) {
+            OUTCOME_TRY(roots, storage::car::loadCar(*ipld, file.path));
+            if (roots.empty()) {
+              return storage::car::CarError::kDecodeError;
+            }
+            return roots[0];
+          }
+          return storage::unixfs::importFile(*ipld, file.path);
+        }},
         // TODO(turuslan): FIL-165 implement method
         .ClientListImports = {},
         // TODO(turuslan): FIL-165 implement method
@@ -349,33 +538,41 @@ namespace fc::api {
         .ClientRetrieve = {},
         // TODO(turuslan): FIL-165 implement method
         .ClientStartDeal = {},
-        // TODO(turuslan): FIL-165 implement method
-        .GasEstimateMessageGas = {},
+        .GasEstimateMessageGas = {[=](auto message, auto &spec, auto &)
+                                      -> outcome::result<UnsignedMessage> {
+          auto estimated{message};
+          if (estimated.from.isId()) {
+            OUTCOME_TRY(context, tipsetContext({}));
+            OUTCOME_TRYA(estimated.from,
+                         vm::runtime::resolveKey(
+                             context.state_tree, estimated.from, true));
+          }
+          OUTCOME_TRY(
+              mpool->estimate(estimated, MessageSendSpec::maxFee(spec)));
+          message.gas_limit = estimated.gas_limit;
+          message.gas_fee_cap = estimated.gas_fee_cap;
+          message.gas_premium = estimated.gas_premium;
+          return message;
+        }},
         // TODO(turuslan): FIL-165 implement method
         .MarketEnsureAvailable = {},
         .MinerCreateBlock = {[=](auto &t) -> outcome::result<BlockWithCids> {
           OUTCOME_TRY(context, tipsetContext(t.parents, true));
           OUTCOME_TRY(miner_state, context.minerState(t.miner));
-          OUTCOME_TRY(block,
-                      blockchain::production::generate(
-                          *interpreter, ipld, std::move(t)));
+          // assembled when messages were selected
+          OUTCOME_TRY(body, block_bodies->get(ipld, t.messages));
+          BlockWithCids block2;
+          OUTCOME_TRYA(block2.header,
+                       blockchain::production::generateHeader(
+                           *interpreter, *weight_calculator, ipld, t, *body));
 
-          OUTCOME_TRY(block_signable, codec::cbor::encode(block.header));
+          OUTCOME_TRY(block_signable, codec::cbor::encode(block2.header));
           OUTCOME_TRY(minfo, miner_state.info.get());
           OUTCOME_TRY(worker_key, context.accountKey(minfo.worker));
           OUTCOME_TRY(block_sig, key_store->sign(worker_key, block_signable));
-          block.header.block_sig = block_sig;
-
-          BlockWithCids block2;
-          block2.header = block.header;
-          for (auto &msg : block.bls_messages) {
-            OUTCOME_TRY(cid, ipld->setCbor(msg));
-            block2.bls_messages.emplace_back(std::move(cid));
-          }
-          for (auto &msg : block.secp_messages) {
-            OUTCOME_TRY(cid, ipld->setCbor(msg));
-            block2.secp_messages.emplace_back(std::move(cid));
-          }
+          block2.header.block_sig = block_sig;
+          block2.bls_messages = body->bls_cids;
+          block2.secp_messages = body->secp_cids;
           return block2;
         }},
         .MinerGetBaseInfo = waitCb<boost::optional<MiningBaseInfo>>(
@@ -383,41 +580,49 @@ namespace fc::api {
               OUTCOME_CB(auto context, tipsetContext(tipset_key, true));
               MiningBaseInfo info;
               OUTCOME_CB(info.prev_beacon, context.tipset->latestBeacon(*ipld));
+              // state and sector set are loaded before waiting for beacon
+              OUTCOME_CB(auto lookback,
+                         getLookbackTipSetForRound(context.tipset, epoch));
+              OUTCOME_CB(auto state, lookback.minerState(miner));
+              OUTCOME_CB(auto sectors_bitset,
+                         getWinningPoStSectorSet(state, *deadline_cache));
+              if (sectors_bitset.empty()) {
+                return cb(boost::none);
+              }
+              OUTCOME_CB(auto power,
+                         power_snapshots->get(lookback.stateRoot()));
+              OUTCOME_CB(auto claim, power->claim(miner));
+              info.miner_power = claim.qa_power;
+              info.network_power = power->total().qa_power;
+              OUTCOME_CB(auto minfo, state.info.get());
+              OUTCOME_CB(info.worker, context.accountKey(minfo.worker));
+              info.sector_size = minfo.sector_size;
+              info.has_min_power = minerHasMinPower(
+                  claim.qa_power, power->minersMeetingMinPower());
               auto prev{info.prev_beacon.round};
               beaconEntriesForBlock(
                   *drand_schedule,
                   *beaconizer,
                   epoch,
                   prev,
-                  [=, MOVE(cb), MOVE(context), MOVE(info)](
-                      auto _beacons) mutable {
+                  [=,
+                   MOVE(cb),
+                   MOVE(state),
+                   MOVE(sectors_bitset),
+                   MOVE(info)](auto _beacons) mutable {
                     OUTCOME_CB(info.beacons, _beacons);
-                    OUTCOME_CB(
-                        auto lookback,
-                        getLookbackTipSetForRound(context.tipset, epoch));
-                    OUTCOME_CB(auto state, lookback.minerState(miner));
                     OUTCOME_CB(auto seed, codec::cbor::encode(miner));
                     auto post_rand{crypto::randomness::drawRandomness(
                         info.beacon().data,
                         DomainSeparationTag::WinningPoStChallengeSeed,
                         epoch,
                         seed)};
-                    OUTCOME_CB(
-                        info.sectors,
-                        getSectorsForWinningPoSt(miner, state, post_rand));
+                    OUTCOME_CB(info.sectors,
+                               getSectorsForWinningPoSt(
+                                   miner, state, sectors_bitset, post_rand));
                     if (info.sectors.empty()) {
                       return cb(boost::none);
                     }
-                    OUTCOME_CB(auto power_state, lookback.powerState());
-                    OUTCOME_CB(auto claim, power_state.claims.get(miner));
-                    info.miner_power = claim.qa_power;
-                    info.network_power = power_state.total_qa_power;
-                    OUTCOME_CB(auto minfo, state.info.get());
-                    OUTCOME_CB(info.worker, context.accountKey(minfo.worker));
-                    info.sector_size = minfo.sector_size;
-                    info.has_min_power = minerHasMinPower(
-                        claim.qa_power,
-                        power_state.num_miners_meeting_min_power);
                     cb(std::move(info));
                   });
             }),
@@ -431,33 +636,42 @@ namespace fc::api {
           }
           return mpool->pending();
         }},
-        .MpoolPushMessage = {[=](auto message,
-                                 auto) -> outcome::result<SignedMessage> {
+        .MpoolPushMessage = {[=](auto message, auto &spec)
+                                 -> outcome::result<SignedMessage> {
           OUTCOME_TRY(context, tipsetContext({}));
           if (message.from.isId()) {
             OUTCOME_TRYA(message.from,
                          vm::runtime::resolveKey(
                              context.state_tree, message.from, true));
           }
-          OUTCOME_TRY(mpool->estimate(message));
+          OUTCOME_TRY(
+              mpool->estimate(message, MessageSendSpec::maxFee(spec)));
           OUTCOME_TRYA(message.nonce, mpool->nonce(message.from));
           OUTCOME_TRY(signed_message,
                       vm::message::MessageSignerImpl{key_store}.sign(
                           message.from, message));
-          OUTCOME_TRY(mpool->add(signed_message));
+          OUTCOME_TRY(mpool->addLocal(signed_message));
           return std::move(signed_message);
         }},
-        .MpoolSelect = {[=](auto &, auto) {
-          // TODO: implement
-          return mpool->pending();
+        // selection is greedy by gas premium, ticket quality is not used
+        .MpoolSelect = {[=](auto &tipset_key, auto)
+                            -> outcome::result<std::vector<SignedMessage>> {
+          OUTCOME_TRY(context, tipsetContext(tipset_key));
+          OUTCOME_TRY(messages, mpool->select(context.tipset));
+          // block is created later, body is assembled ahead
+          OUTCOME_TRY(block_bodies->get(ipld, messages));
+          return messages;
         }},
         .MpoolSub = {[=]() {
           auto channel{std::make_shared<Channel<MpoolUpdate>>()};
           auto cnn{std::make_shared<connection_t>()};
-          *cnn = mpool->subscribe([=](auto &change) {
-            if (!channel->write(change)) {
-              assert(cnn->connected());
-              cnn->disconnect();
+          *cnn = mpool->subscribe([=](auto &changes) {
+            for (auto &change : changes) {
+              if (!channel->write(change)) {
+                assert(cnn->connected());
+                cnn->disconnect();
+                return;
+              }
             }
           });
           return Chan{std::move(channel)};
@@ -476,17 +690,40 @@ namespace fc::api {
         .StateCall = {[=](auto &message,
                           auto &tipset_key) -> outcome::result<InvocResult> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
-          auto randomness =
-              std::make_shared<TipsetRandomness>(ipld, context.tipset);
+          auto randomness = std::make_shared<TipsetRandomness>(
+              ipld, context.tipset, randomness_cache);
+          auto state_tree{std::make_shared<OverlayStateTree>(
+              ipld, context.tipset->getParentStateRoot(), hamt_cache)};
           auto env = std::make_shared<Env>(std::make_shared<InvokerImpl>(),
                                            randomness,
-                                           ipld,
-                                           context.tipset);
+                                           state_tree->getStore(),
+                                           context.tipset,
+                                           hamt_cache);
+          env->state_tree = state_tree;
           InvocResult result;
           result.message = message;
           OUTCOME_TRYA(result.receipt, env->applyImplicitMessage(message));
           return result;
         }},
+        .StateChangedActors = {[=](auto &old_root, auto &new_root)
+                                   -> outcome::result<ChangedActors> {
+          adt::Map<Actor, adt::AddressKeyer> from{old_root, ipld};
+          adt::Map<Actor, adt::AddressKeyer> to{new_root, ipld};
+          from.hamt.cache = to.hamt.cache = hamt_cache;
+          ChangedActors changed;
+          OUTCOME_TRY(from.hamt.diff(
+              to.hamt,
+              [&](auto &key, auto, auto value) -> outcome::result<void> {
+                if (value) {
+                  OUTCOME_TRY(address, adt::AddressKeyer::decode(key));
+                  OUTCOME_TRY(actor, codec::cbor::decode<Actor>(*value));
+                  changed.emplace(primitives::address::encodeToString(address),
+                                  std::move(actor));
+                }
+                return outcome::success();
+              }));
+          return changed;
+        }},
         .StateListMessages = {[=](auto &match, auto &tipset_key, auto to_height)
                                   -> outcome::result<std::vector<CID>> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
@@ -494,16 +731,37 @@ namespace fc::api {
           // TODO(artyom-yurin): Make sure at least one of 'to' or 'from' is
           // defined
 
-          auto matchFunc = [&](const UnsignedMessage &message) -> bool {
-            if (match.to != message.to) {
-              return false;
+          if (address_index && address_index->indexed(context.tipset->key)) {
+            OUTCOME_TRY(indexed,
+                        address_index->list(match.from,
+                                            to_height,
+                                            context.tipset->height()));
+            // newest tipsets first, same as walking down from head
+            std::stable_sort(
+                indexed.begin(), indexed.end(), [](auto &l, auto &r) {
+                  return l.epoch > r.epoch;
+                });
+            std::vector<CID> result;
+            for (auto &message : indexed) {
+              if (message.from && message.other == match.to) {
+                result.push_back(std::move(message.cid));
+              }
             }
+            return result;
+          }
 
-            if (match.from != message.from) {
+          // compare encoded addresses without decoding whole messages
+          auto match_to{primitives::address::encode(match.to)};
+          auto match_from{primitives::address::encode(match.from)};
+          auto matchFunc = [&](const CID &cid) -> outcome::result<bool> {
+            OUTCOME_TRY(bytes, ipld->get(cid));
+            OUTCOME_TRY(message, MessageView::make(bytes));
+            OUTCOME_TRY(to, message.to());
+            if (gsl::make_span(match_to) != to) {
               return false;
             }
-
-            return true;
+            OUTCOME_TRY(from, message.from());
+            return gsl::make_span(match_from) == from;
           };
 
           std::vector<CID> result;
@@ -519,20 +777,22 @@ namespace fc::api {
               OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(block.messages));
               OUTCOME_TRY(meta.bls_messages.visit(
                   [&](auto, auto &cid) -> outcome::result<void> {
-                    OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
-
-                    if (!isDuplicateMessage(cid) && matchFunc(message)) {
+                    if (isDuplicateMessage(cid)) {
+                      return outcome::success();
+                    }
+                    OUTCOME_TRY(matched, matchFunc(cid));
+                    if (matched) {
                       result.push_back(cid);
                     }
-
                     return outcome::success();
                   }));
               OUTCOME_TRY(meta.secp_messages.visit(
                   [&](auto, auto &cid) -> outcome::result<void> {
-                    OUTCOME_TRY(message, ipld->getCbor<SignedMessage>(cid));
-
-                    if (!isDuplicateMessage(cid)
-                        && matchFunc(message.message)) {
+                    if (isDuplicateMessage(cid)) {
+                      return outcome::success();
+                    }
+                    OUTCOME_TRY(matched, matchFunc(cid));
+                    if (matched) {
                       result.push_back(cid);
                     }
                     return outcome::success();
@@ -551,8 +811,14 @@ namespace fc::api {
         }},
         .StateGetActor = {[=](auto &address,
                               auto &tipset_key) -> outcome::result<Actor> {
-          OUTCOME_TRY(context, tipsetContext(tipset_key, true));
-          return context.state_tree.get(address);
+          return cached(
+              "StateGetActor",
+              tipset_key,
+              [&](auto &tipset_key) -> outcome::result<Actor> {
+                OUTCOME_TRY(context, tipsetContext(tipset_key, true));
+                return context.state_tree.get(address);
+              },
+              address);
         }},
         .StateReadState = {[=](auto &actor, auto &tipset_key)
                                -> outcome::result<ActorState> {
@@ -567,11 +833,11 @@ namespace fc::api {
         .StateGetReceipt = {[=](auto &cid, auto &tipset_key)
                                 -> outcome::result<MessageReceipt> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
-          auto result{msg_waiter->results.find(cid)};
-          if (result != msg_waiter->results.end()) {
-            OUTCOME_TRY(ts, Tipset::load(*ipld, result->second.second.cids()));
+          OUTCOME_TRY(result, msg_waiter->search(cid));
+          if (result) {
+            OUTCOME_TRY(ts, tipset_cache->load(*ipld, result->second));
             if (context.tipset->height() <= ts->height()) {
-              return result->second.first;
+              return result->first;
             }
           }
           return TodoError::kError;
@@ -609,13 +875,23 @@ namespace fc::api {
                                  -> outcome::result<MarketDealMap> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
           OUTCOME_TRY(state, context.marketState());
-          MarketDealMap map;
+          std::vector<DealId> deal_ids;
+          std::vector<DealProposal> deals;
           OUTCOME_TRY(state.proposals.visit([&](auto deal_id, auto &deal)
                                                 -> outcome::result<void> {
-            OUTCOME_TRY(deal_state, state.states.get(deal_id));
-            map.emplace(std::to_string(deal_id), StorageDeal{deal, deal_state});
+            deal_ids.push_back(deal_id);
+            deals.push_back(deal);
             return outcome::success();
           }));
+          OUTCOME_TRY(deal_states, state.states.getMany(deal_ids));
+          MarketDealMap map;
+          for (size_t i{0}; i < deal_ids.size(); ++i) {
+            if (!deal_states[i]) {
+              return storage::amt::AmtError::kNotFound;
+            }
+            map.emplace(std::to_string(deal_ids[i]),
+                        StorageDeal{deals[i], *deal_states[i]});
+          }
           return map;
         }},
         .StateLookupID = {[=](auto &address,
@@ -648,20 +924,25 @@ namespace fc::api {
           OUTCOME_TRY(state, context.minerState(address));
           OUTCOME_TRY(deadlines, state.deadlines.get());
           RleBitset faults;
-          for (auto &_deadline : deadlines.due) {
-            OUTCOME_TRY(deadline, _deadline.get());
-            OUTCOME_TRY(deadline.partitions.visit([&](auto, auto &part) {
-              faults += part.faults;
-              return outcome::success();
-            }));
+          for (auto &deadline : deadlines.due) {
+            OUTCOME_TRY(parts, deadline_cache->partitions(deadline));
+            for (auto &part : *parts) {
+              faults += part.faulty;
+            }
           }
           return faults;
         }},
         .StateMinerInfo = {[=](auto &address,
                                auto &tipset_key) -> outcome::result<MinerInfo> {
-          OUTCOME_TRY(context, tipsetContext(tipset_key));
-          OUTCOME_TRY(miner_state, context.minerState(address));
-          return miner_state.info.get();
+          return cached(
+              "StateMinerInfo",
+              tipset_key,
+              [&](auto &tipset_key) -> outcome::result<MinerInfo> {
+                OUTCOME_TRY(context, tipsetContext(tipset_key));
+                OUTCOME_TRY(miner_state, context.minerState(address));
+                return miner_state.info.get();
+              },
+              address);
         }},
         .StateMinerPartitions =
             {[=](auto &miner,
@@ -669,30 +950,22 @@ namespace fc::api {
                  auto &tsk) -> outcome::result<std::vector<Partition>> {
               OUTCOME_TRY(context, tipsetContext(tsk));
               OUTCOME_TRY(state, context.minerState(miner));
-              OUTCOME_TRY(deadlines, state.deadlines.get());
-              OUTCOME_TRY(deadline, deadlines.due[_deadline].get());
-              std::vector<Partition> parts;
-              OUTCOME_TRY(deadline.partitions.visit([&](auto, auto &v) {
-                parts.push_back({
-                    v.sectors,
-                    v.faults,
-                    v.recoveries,
-                    v.sectors - v.terminated,
-                    v.sectors - v.terminated - v.faults,
-                });
-                return outcome::success();
-              }));
-              return parts;
+              OUTCOME_TRY(parts, deadline_cache->partitions(state, _deadline));
+              return *parts;
             }},
         .StateMinerPower = {[=](auto &address, auto &tipset_key)
                                 -> outcome::result<MinerPower> {
-          OUTCOME_TRY(context, tipsetContext(tipset_key));
-          OUTCOME_TRY(power_state, context.powerState());
-          OUTCOME_TRY(miner_power, power_state.claims.get(address));
-          return MinerPower{
-              miner_power,
-              {power_state.total_raw_power, power_state.total_qa_power},
-          };
+          return cached(
+              "StateMinerPower",
+              tipset_key,
+              [&](auto &tipset_key) -> outcome::result<MinerPower> {
+                OUTCOME_TRY(context, tipsetContext(tipset_key));
+                OUTCOME_TRY(power,
+                            power_snapshots->get(context.stateRoot()));
+                OUTCOME_TRY(miner_power, power->claim(address));
+                return MinerPower{miner_power, power->total()};
+              },
+              address);
         }},
         .StateMinerProvingDeadline = {[=](auto &address, auto &tipset_key)
                                           -> outcome::result<DeadlineInfo> {
@@ -737,26 +1010,31 @@ namespace fc::api {
             }},
         // TODO(artyom-yurin): FIL-165 implement method
         .StateSectorPartition = {},
-        // TODO(artyom-yurin): FIL-165 implement method
-        .StateSearchMsg = {},
+        .StateSearchMsg = {[=](auto &cid)
+                               -> outcome::result<boost::optional<MsgWait>> {
+          OUTCOME_TRY(result, msg_waiter->search(cid));
+          if (!result) {
+            return boost::none;
+          }
+          OUTCOME_TRY(ts, loadTipset(result->second));
+          return MsgWait{cid, result->first, ts->key, (ChainEpoch)ts->height()};
+        }},
         .StateWaitMsg = waitCb<MsgWait>([=](auto &&cid,
                                             auto &&confidence,
                                             auto &&cb) {
           msg_waiter->wait(cid, [=, MOVE(cb)](auto &result) {
-            OUTCOME_CB(auto ts, chain_store->loadTipset(result.second));
+            OUTCOME_CB(auto ts, loadTipset(result.second));
             cb(MsgWait{cid, result.first, ts->key, (ChainEpoch)ts->height()});
           });
         }),
         .SyncSubmitBlock = {[=](auto block) -> outcome::result<void> {
           // TODO(turuslan): chain store must validate blocks before adding
           MsgMeta meta;
-          ipld->load(meta);
-          for (auto &cid : block.bls_messages) {
-            OUTCOME_TRY(meta.bls_messages.append(cid));
-          }
-          for (auto &cid : block.secp_messages) {
-            OUTCOME_TRY(meta.secp_messages.append(cid));
-          }
+          OUTCOME_TRYA(meta.bls_messages,
+                       adt::Array<CID>::fromValues(ipld, block.bls_messages));
+          OUTCOME_TRYA(
+              meta.secp_messages,
+              adt::Array<CID>::fromValues(ipld, block.secp_messages));
           OUTCOME_TRY(messages, ipld->setCbor(meta));
           if (block.header.messages != messages) {
             return TodoError::kError;
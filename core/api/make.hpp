@@ -7,11 +7,16 @@
 #define CPP_FILECOIN_CORE_API_MAKE_HPP
 
 #include "api/api.hpp"
+#include "api/result_cache.hpp"
 #include "blockchain/weight_calculator.hpp"
 #include "common/logger.hpp"
+#include "common/lru_cache.hpp"
 #include "common/todo_error.hpp"
 #include "node/fwd.hpp"
+#include "primitives/tipset/tipset_cache.hpp"
+#include "storage/chain/address_index.hpp"
 #include "storage/chain/chain_store.hpp"
+#include "storage/chain/height_index.hpp"
 #include "storage/chain/msg_waiter.hpp"
 #include "storage/keystore/keystore.hpp"
 #include "storage/mpool/mpool.hpp"
@@ -22,17 +27,53 @@ namespace fc::api {
   using crypto::bls::BlsProvider;
   using drand::Beaconizer;
   using drand::DrandSchedule;
+  using primitives::tipset::TipsetCache;
   using pubsub::PubSub;
+  using storage::blockchain::AddressIndex;
   using storage::blockchain::ChainStore;
+  using storage::blockchain::HeightIndex;
   using storage::blockchain::MsgWaiter;
   using storage::keystore::KeyStore;
   using storage::mpool::Mpool;
   using vm::interpreter::Interpreter;
   using Logger = common::Logger;
 
+  /**
+   * Cids of blocks reached by path prefixes from root. Root is immutable, so
+   * entries are only evicted by size. Thread-safe.
+   */
+  class PathCache {
+   public:
+    explicit PathCache(size_t max_entries) : cache_{max_entries} {}
+
+    boost::optional<CID> get(const CID &root,
+                             gsl::span<const std::string> prefix);
+    void put(const CID &root,
+             gsl::span<const std::string> prefix,
+             const CID &cid);
+
+   private:
+    using Key = std::pair<CID, std::string>;
+    struct KeyHash {
+      size_t operator()(const Key &key) const;
+    };
+
+    static Key key(const CID &root, gsl::span<const std::string> prefix);
+
+    std::mutex mutex_;
+    common::LruCache<Key, CID, KeyHash> cache_;
+  };
+
+  /**
+   * Resolves path from root, segments "@A:", "@H:", "@Hi:", "@Hu:", "@Ha:"
+   * are amt or hamt keys
+   * @param cache - cids of resolved prefixes, resolution starts from longest
+   * cached prefix
+   */
   outcome::result<IpldObject> getNode(std::shared_ptr<Ipld> ipld,
                                       const CID &root,
-                                      gsl::span<const std::string> parts);
+                                      gsl::span<const std::string> parts,
+                                      PathCache *cache = nullptr);
 
   Api makeImpl(std::shared_ptr<ChainStore> chain_store,
                std::shared_ptr<WeightCalculator> weight_calculator,
@@ -43,7 +84,11 @@ namespace fc::api {
                std::shared_ptr<Beaconizer> beaconizer,
                std::shared_ptr<DrandSchedule> drand_schedule,
                std::shared_ptr<PubSub> pubsub,
-               std::shared_ptr<KeyStore> key_store);
+               std::shared_ptr<KeyStore> key_store,
+               std::shared_ptr<HeightIndex> height_index = nullptr,
+               std::shared_ptr<TipsetCache> tipset_cache = nullptr,
+               std::shared_ptr<AddressIndex> address_index = nullptr,
+               std::shared_ptr<ResultCache> result_cache = nullptr);
 }  // namespace fc::api
 
 #endif  // CPP_FILECOIN_CORE_API_MAKE_HPP
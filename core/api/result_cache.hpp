@@ -0,0 +1,106 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <future>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+#include "common/buffer.hpp"
+#include "common/lru_cache.hpp"
+#include "common/outcome.hpp"
+
+namespace fc::api {
+  using common::Buffer;
+
+  struct ResultCacheConfig {
+    size_t max_entries{4096};
+    /// Methods allowed to use cache
+    std::set<std::string> methods{
+        "ChainGetParentReceipts",
+        "StateGetActor",
+        "StateMinerInfo",
+        "StateMinerPower",
+    };
+  };
+
+  /**
+   * Results of api methods which are pure functions of params and resolved
+   * tipset key. Errors are not cached. Concurrent calls with same key wait
+   * for one computation.
+   */
+  class ResultCache {
+   public:
+    struct Stats {
+      size_t hits{};
+      size_t misses{};
+      /// Calls which waited for same in-flight call
+      size_t shared{};
+    };
+
+    explicit ResultCache(ResultCacheConfig config = {})
+        : config_{std::move(config)}, cache_{config_.max_entries} {}
+
+    bool enabled(const std::string &method) const {
+      return config_.methods.count(method) != 0;
+    }
+
+    /// Get cached result or compute it with f
+    template <typename T, typename F>
+    outcome::result<T> get(const Buffer &key, F &&f) {
+      std::unique_lock lock{mutex_};
+      if (auto value{cache_.get(key)}) {
+        ++stats_.hits;
+        return *std::static_pointer_cast<const T>(*value);
+      }
+      auto it{inflight_.find(key)};
+      if (it != inflight_.end()) {
+        ++stats_.shared;
+        auto future{it->second};
+        lock.unlock();
+        OUTCOME_TRY(value, future.get());
+        return *std::static_pointer_cast<const T>(value);
+      }
+      ++stats_.misses;
+      std::promise<outcome::result<Value>> promise;
+      inflight_.emplace(key, promise.get_future().share());
+      lock.unlock();
+
+      outcome::result<T> result{f()};
+      lock.lock();
+      inflight_.erase(key);
+      if (result) {
+        auto value{std::make_shared<const T>(result.value())};
+        cache_.put(key, value, 1);
+        promise.set_value(Value{value});
+      } else {
+        promise.set_value(result.error());
+      }
+      return result;
+    }
+
+    Stats stats() const {
+      std::lock_guard lock{mutex_};
+      return stats_;
+    }
+
+    void clear() {
+      std::lock_guard lock{mutex_};
+      cache_.clear();
+    }
+
+   private:
+    using Value = std::shared_ptr<const void>;
+
+    ResultCacheConfig config_;
+    mutable std::mutex mutex_;
+    common::LruCache<Buffer, Value> cache_;
+    std::unordered_map<Buffer, std::shared_future<outcome::result<Value>>>
+        inflight_;
+    Stats stats_;
+  };
+}  // namespace fc::api
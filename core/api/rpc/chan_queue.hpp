@@ -0,0 +1,99 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <deque>
+
+#include "storage/mpool/mpool.hpp"
+
+namespace fc::api::rpc {
+  using storage::mpool::MpoolUpdate;
+
+  /// Max values queued for one slow subscriber
+  constexpr size_t kChanQueueMax{256};
+
+  /**
+   * Merges value into values waiting for slow subscriber.
+   * Returns false if value must be queued as is.
+   */
+  template <typename T>
+  struct Coalesce {
+    static bool merge(std::deque<T> &queue, T &value) {
+      return false;
+    }
+  };
+
+  /// Consecutive vectors (e.g. head changes) are sent as one
+  template <typename T>
+  struct Coalesce<std::vector<T>> {
+    static bool merge(std::deque<std::vector<T>> &queue,
+                      std::vector<T> &value) {
+      if (queue.empty()) {
+        return false;
+      }
+      auto &last{queue.back()};
+      last.insert(last.end(),
+                  std::make_move_iterator(value.begin()),
+                  std::make_move_iterator(value.end()));
+      return true;
+    }
+  };
+
+  /// Removal of message cancels its queued addition
+  template <>
+  struct Coalesce<MpoolUpdate> {
+    static bool merge(std::deque<MpoolUpdate> &queue, MpoolUpdate &value) {
+      if (value.type != MpoolUpdate::Type::REMOVE) {
+        return false;
+      }
+      auto cid{value.message.getCid()};
+      auto it{std::find_if(queue.begin(), queue.end(), [&](auto &update) {
+        return update.type == MpoolUpdate::Type::ADD
+               && update.message.getCid() == cid;
+      })};
+      if (it == queue.end()) {
+        return false;
+      }
+      queue.erase(it);
+      return true;
+    }
+  };
+
+  /**
+   * Bounded queue of channel values not yet sent to subscriber.
+   * Values are coalesced while previous value is being sent, oldest values
+   * are dropped when queue is full.
+   */
+  template <typename T>
+  struct ChanQueue {
+    /// Returns number of dropped values
+    size_t push(T &&value) {
+      if (Coalesce<T>::merge(queue, value)) {
+        return 0;
+      }
+      size_t dropped{0};
+      while (queue.size() >= max) {
+        queue.pop_front();
+        ++dropped;
+      }
+      queue.push_back(std::move(value));
+      return dropped;
+    }
+
+    boost::optional<T> pop() {
+      if (queue.empty()) {
+        return boost::none;
+      }
+      auto value{std::move(queue.front())};
+      queue.pop_front();
+      return value;
+    }
+
+    size_t max{kChanQueueMax};
+    std::deque<T> queue;
+  };
+}  // namespace fc::api::rpc
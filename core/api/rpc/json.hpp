@@ -104,12 +104,16 @@ namespace fc::api {
       if (j.IsNull()) {
         return {};
       }
-      return base64::decode(AsString(j));
+      if (!j.IsString()) {
+        outcome::raise(JsonError::kWrongType);
+      }
+      return base64::decode(j.GetString(), j.GetStringLength());
     }
 
+    /// Deep copy, strings of document parsed in place are copied too
     static auto AsDocument(const Value &j) {
       Document document;
-      static_cast<Value &>(document) = Value{j, document.GetAllocator()};
+      static_cast<Value &>(document) = Value{j, document.GetAllocator(), true};
       return document;
     }
 
@@ -123,6 +127,9 @@ namespace fc::api {
       Set(j, "id", v.id);
       Set(j, "method", v.method);
       Set(j, "params", Value{v.params, allocator});
+      if (!v.traceparent.empty()) {
+        Set(j, "traceparent", v.traceparent);
+      }
       return j;
     }
 
@@ -134,6 +141,11 @@ namespace fc::api {
       }
       v.method = AsString(Get(j, "method"));
       v.params = AsDocument(Get(j, "params"));
+      if (j.HasMember("traceparent")) {
+        v.traceparent = AsString(Get(j, "traceparent"));
+      } else {
+        v.traceparent.clear();
+      }
     }
 
     ENCODE(Response) {
@@ -706,11 +718,11 @@ namespace fc::api {
     }
 
     ENCODE(RleBitset) {
-      return encode(codec::rle::toRuns(v));
+      return encode(v.toRuns());
     }
 
     DECODE(RleBitset) {
-      v = codec::rle::fromRuns(decode<codec::rle::Runs64>(j));
+      v = RleBitset::fromRuns(decode<codec::rle::Runs64>(j));
     }
 
     ENCODE(UnsignedMessage) {
@@ -4,10 +4,132 @@
  */
 
 #include "api/rpc/make.hpp"
+
+#include <list>
+#include <mutex>
+
+#include "api/rpc/chan_queue.hpp"
 #include "api/rpc/json.hpp"
 #include "api/visit.hpp"
 
 namespace fc::api {
+  /// Recent encoded head changes, shared by all ChainNotify subscribers
+  constexpr size_t kEncodedHeadChanges{4};
+
+  Document encodeShared(const std::vector<HeadChange> &changes) {
+    using Entry = std::pair<std::vector<HeadChange>, std::shared_ptr<Document>>;
+    static std::mutex mutex;
+    static std::list<Entry> cache;
+    auto same{[&](const Entry &entry) {
+      return std::equal(entry.first.begin(),
+                        entry.first.end(),
+                        changes.begin(),
+                        changes.end(),
+                        [](auto &l, auto &r) {
+                          return l.type == r.type && l.value == r.value;
+                        });
+    }};
+    std::shared_ptr<Document> encoded;
+    {
+      std::lock_guard lock{mutex};
+      auto it{std::find_if(cache.begin(), cache.end(), same)};
+      if (it != cache.end()) {
+        encoded = it->second;
+      }
+    }
+    if (!encoded) {
+      encoded = std::make_shared<Document>(encode(changes));
+      std::lock_guard lock{mutex};
+      cache.emplace_front(changes, encoded);
+      if (cache.size() > kEncodedHeadChanges) {
+        cache.pop_back();
+      }
+    }
+    Document document;
+    document.CopyFrom(*encoded, document.GetAllocator());
+    return document;
+  }
+
+  template <typename T>
+  Document encodeShared(const T &value) {
+    return encode(value);
+  }
+
+  /**
+   * Sends channel values to subscriber one at a time, values written while
+   * previous is being sent are coalesced in bounded queue.
+   */
+  template <typename T>
+  struct ChanSender : std::enable_shared_from_this<ChanSender<T>> {
+    ChanSender(Chan<T> chan, rpc::Send send)
+        : chan{std::move(chan)}, send{std::move(send)} {}
+
+    void write(T &&value) {
+      std::unique_lock lock{mutex};
+      if (failed) {
+        return;
+      }
+      queue.push(std::move(value));
+      next(lock);
+    }
+
+    void close() {
+      std::unique_lock lock{mutex};
+      closed = true;
+      next(lock);
+    }
+
+    void next(std::unique_lock<std::mutex> &lock) {
+      if (sending || failed) {
+        return;
+      }
+      auto value{queue.pop()};
+      if (!value) {
+        if (closed) {
+          lock.unlock();
+          send(kRpcChClose, encode(std::make_tuple(chan.id)), {});
+        }
+        return;
+      }
+      sending = true;
+      lock.unlock();
+      Document params{rapidjson::kArrayType};
+      auto &allocator{params.GetAllocator()};
+      rapidjson::Value j_value;
+      j_value.CopyFrom(encodeShared(*value), allocator);
+      params.PushBack(rapidjson::Value{chan.id}, allocator);
+      params.PushBack(j_value, allocator);
+      send(kRpcChVal,
+           std::move(params),
+           [weak{this->weak_from_this()}](auto ok) {
+             if (auto self{weak.lock()}) {
+               self->onSent(ok);
+             }
+           });
+    }
+
+    void onSent(bool ok) {
+      std::unique_lock lock{mutex};
+      sending = false;
+      if (!ok) {
+        failed = true;
+        queue.queue.clear();
+        lock.unlock();
+        chan.channel->closeRead();
+        return;
+      }
+      next(lock);
+    }
+
+    Chan<T> chan;
+    rpc::Send send;
+    std::mutex mutex;
+    rpc::ChanQueue<T> queue;
+    bool sending{false};
+    bool closed{false};
+    bool failed{false};
+  };
+
   template <typename M>
   void setup(Rpc &rpc, const M &method) {
     using Result = typename M::Result;
@@ -46,21 +168,16 @@ namespace fc::api {
               respond(api::encode(result));
             }
             if constexpr (is_chan<Result>{}) {
-              result.channel->read(
-                  [send{std::move(send)}, chan{result}](auto opt) {
-                    if (opt) {
-                      send(kRpcChVal,
-                           encode(std::make_tuple(chan.id, std::move(*opt))),
-                           [chan](auto ok) {
-                             if (!ok) {
-                               chan.channel->closeRead();
-                             }
-                           });
-                    } else {
-                      send(kRpcChClose, encode(std::make_tuple(chan.id)), {});
-                    }
-                    return true;
-                  });
+              auto sender{std::make_shared<ChanSender<typename Result::Type>>(
+                  result, std::move(send))};
+              result.channel->read([sender](auto opt) {
+                if (opt) {
+                  sender->write(std::move(*opt));
+                } else {
+                  sender->close();
+                }
+                return true;
+              });
             }
             return;
           }
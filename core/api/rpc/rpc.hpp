@@ -20,6 +20,8 @@ namespace fc::api {
     boost::optional<uint64_t> id;
     std::string method;
     Document params;
+    /// W3C trace context of caller, not sent when empty
+    std::string traceparent;
   };
 
   struct Response {
@@ -5,16 +5,28 @@
 
 #include "api/rpc/ws.hpp"
 
+#include <atomic>
+#include <fstream>
 #include <queue>
+#include <thread>
 
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
 #include <boost/beast/websocket.hpp>
+#include <rapidjson/writer.h>
 
 #include "api/rpc/json.hpp"
 #include "api/rpc/make.hpp"
 #include "codec/json/json.hpp"
+#include "common/metrics.hpp"
+#include "common/profiler.hpp"
+#include "common/tracing.hpp"
+#include "common/visitor.hpp"
+#include "common/which.hpp"
 
 namespace fc::api {
   namespace beast = boost::beast;
@@ -23,6 +35,7 @@ namespace fc::api {
   namespace net = boost::asio;
   using tcp = boost::asio::ip::tcp;
   using rpc::OkCb;
+  using Writer = rapidjson::Writer<codec::json::BufferStream>;
 
   constexpr auto kParseError = INT64_C(-32700);
   constexpr auto kInvalidRequest = INT64_C(-32600);
@@ -30,14 +43,105 @@ namespace fc::api {
 
   const auto kChanCloseDelay{boost::posix_time::milliseconds(100)};
 
+  constexpr std::string_view kCpuProfile{"/debug/profile/cpu"};
+  constexpr size_t kMaxProfileSeconds{300};
+
+  /// Written buffers up to that capacity are kept for reuse
+  constexpr size_t kReuseBufferMax{1 << 20};
+  constexpr size_t kReuseBuffers{8};
+
+  /**
+   * Slow methods reading only thread-safe stores. Message search, receipts
+   * and height index use stores which may be not thread-safe
+   * (InMemoryStorage by default), so methods using them stay on io thread.
+   */
+  const std::set<std::string> kPooledMethods{
+      "ChainGetBlockMessages",
+      "ChainGetParentMessages",
+      "ChainGetParentReceipts",
+      "ChainReadObj",
+      "ChainReadObjs",
+      "StateCall",
+      "StateListActors",
+      "StateListMiners",
+      "StateMarketDeals",
+      "StateMinerDeadlines",
+      "StateMinerFaults",
+      "StateMinerPartitions",
+      "StateMinerSectors",
+  };
+
+  /**
+   * Appends dispatched requests to FC_RPC_RECORD_FILE as json lines
+   * {"t":<microseconds since start>,"s":<session>,"m":<method>,"p":<params>},
+   * replayed by benchmark/rpc_replay.
+   */
+  struct Recorder {
+    std::mutex mutex;
+    std::ofstream file;
+    std::chrono::steady_clock::time_point start{
+        std::chrono::steady_clock::now()};
+    std::atomic<uint64_t> next_session{};
+
+    static Recorder *get() {
+      static auto recorder{[]() -> std::unique_ptr<Recorder> {
+        auto path{getenv("FC_RPC_RECORD_FILE")};
+        if (!path) {
+          return nullptr;
+        }
+        auto recorder{std::make_unique<Recorder>()};
+        recorder->file.open(path, std::ios::app);
+        if (!recorder->file) {
+          return nullptr;
+        }
+        return recorder;
+      }()};
+      return recorder.get();
+    }
+
+    void write(uint64_t session,
+               const std::string &method,
+               const Value &params) {
+      auto t{std::chrono::duration_cast<std::chrono::microseconds>(
+                 std::chrono::steady_clock::now() - start)
+                 .count()};
+      Buffer line;
+      if (!params.IsNull() && !codec::json::formatTo(&params, line)) {
+        return;
+      }
+      std::lock_guard lock{mutex};
+      // method names are identifiers, no escaping needed
+      file << "{\"t\":" << t << ",\"s\":" << session << ",\"m\":\""
+           << method << "\",\"p\":";
+      if (line.empty()) {
+        file << "[]";
+      } else {
+        file.write(reinterpret_cast<const char *>(line.data()),
+                   static_cast<std::streamsize>(line.size()));
+      }
+      file << "}\n";
+      file.flush();
+    }
+  };
+
   struct ServerSession : std::enable_shared_from_this<ServerSession> {
-    ServerSession(tcp::socket &&socket, const Api &api)
-        : socket{std::move(socket)}, timer{this->socket.get_executor()} {
+    ServerSession(tcp::socket &&socket,
+                  const Api &api,
+                  std::shared_ptr<net::thread_pool> pool,
+                  std::set<std::string> pooled)
+        : pool{std::move(pool)},
+          pooled{std::move(pooled)},
+          socket{std::move(socket)},
+          timer{this->socket.get_executor()} {
       setupRpc(rpc, api);
+      if (recorder) {
+        session = recorder->next_session++;
+      }
     }
 
-    void run() {
-      socket.async_accept([self{shared_from_this()}](auto ec) {
+    /// Accepts websocket upgrade request read by HttpSession
+    void run(const http::request<http::string_body> &req) {
+      socket.async_accept(req, [self{shared_from_this()}](auto ec) {
         if (ec) {
           return;
         }
@@ -56,51 +160,244 @@ namespace fc::api {
     }
 
     void onRead() {
-      std::string_view s_req{static_cast<const char *>(buffer.cdata().data()),
-                             buffer.cdata().size()};
-      auto j_req{codec::json::parse(s_req)};
-      buffer.clear();
+      if (socket.got_binary() && !binary) {
+        // client chose cbor frames, responses are sent the same way
+        binary = true;
+        socket.binary(true);
+      }
+      Outcome<Document> j_req;
+      if (binary) {
+        BytesIn input{static_cast<const uint8_t *>(buffer.cdata().data()),
+                      static_cast<ptrdiff_t>(buffer.cdata().size())};
+        j_req = codec::json::fromCbor(input);
+      } else {
+        // text frame is parsed in place, request decoding copies what it
+        // needs before buffer is cleared
+        *static_cast<char *>(buffer.prepare(1).data()) = 0;
+        buffer.commit(1);
+        j_req = codec::json::parseInsitu(
+            static_cast<char *>(buffer.data().data()));
+      }
       if (!j_req) {
+        buffer.clear();
         return _write(Response{{}, Response::Error{kParseError, "Parse error"}},
                       {});
       }
-      auto maybe_req = decode<Request>(j_req);
-      if (!maybe_req) {
+      if (j_req->IsArray()) {
+        onBatch(*j_req);
+      } else {
+        dispatch(*j_req, [self{shared_from_this()}](auto &&res) {
+          self->_write(res, {});
+        });
+      }
+      buffer.clear();
+    }
+
+    /**
+     * Batch entries are dispatched like single requests, so pooled ones run
+     * concurrently, and responses are written as one array when all are
+     * ready.
+     */
+    void onBatch(const Value &j_batch) {
+      if (j_batch.Empty()) {
         return _write(
             Response{{}, Response::Error{kInvalidRequest, "Invalid request"}},
             {});
       }
+      struct Batch {
+        std::vector<Response> responses;
+        // one extra until all entries are dispatched
+        size_t waiting{1};
+      };
+      auto batch{std::make_shared<Batch>()};
+      auto done{[self{shared_from_this()}, batch] {
+        if (--batch->waiting == 0 && !batch->responses.empty()) {
+          self->_write(batch->responses, {});
+        }
+      }};
+      for (auto it{j_batch.Begin()}; it != j_batch.End(); ++it) {
+        auto responds{dispatch(*it, [batch, done](auto &&res) {
+          batch->responses.push_back(std::move(res));
+          done();
+        })};
+        if (responds) {
+          ++batch->waiting;
+        }
+      }
+      done();
+    }
+
+    /**
+     * Decode and call request.
+     * Returns whether on_response will be called, requests without id don't
+     * have response.
+     */
+    bool dispatch(const Value &j_req,
+                  std::function<void(Response &&)> on_response) {
+      auto maybe_req = decode<Request>(j_req);
+      if (!maybe_req) {
+        on_response(
+            Response{{}, Response::Error{kInvalidRequest, "Invalid request"}});
+        return true;
+      }
       auto &req = maybe_req.value();
-      auto respond = [id{req.id}, self{shared_from_this()}](auto res) {
+      auto responds{req.id.has_value()};
+      auto it = rpc.ms.find(req.method);
+      auto found{it != rpc.ms.end() && it->second};
+      // only known methods, so clients can't add labels
+      auto latency{found ? &common::metrics::histogram(
+                       "fc_rpc_request_seconds",
+                       "Api method call time",
+                       "method=\"" + req.method + "\"")
+                         : nullptr};
+      // span ends when response is ready, handler runs in its scope
+      auto parent{common::tracing::SpanContext::fromTraceparent(
+          req.traceparent)};
+      auto span{found ? common::tracing::child(parent)
+                      : common::tracing::SpanContext{}};
+      auto respond = [id{req.id},
+                      on_response{std::move(on_response)},
+                      latency,
+                      span,
+                      parent,
+                      method{span.valid() ? req.method : std::string{}},
+                      start{std::chrono::steady_clock::now()}](auto _res) {
+        if (latency) {
+          latency->observeSince(start);
+        }
+        decltype(Response::result) res{std::move(_res)};
+        if (span.valid()) {
+          common::tracing::record("rpc " + method,
+                                  span,
+                                  parent,
+                                  start,
+                                  std::chrono::steady_clock::now(),
+                                  {{"rpc.method", method}},
+                                  common::which<Response::Error>(res));
+        }
         if (id) {
-          self->_write(Response{*id, std::move(res)}, {});
+          on_response(Response{*id, std::move(res)});
         }
       };
-      auto it = rpc.ms.find(req.method);
-      if (it == rpc.ms.end() || !it->second) {
-        return respond(Response::Error{kMethodNotFound, "Method not found"});
-      }
-      it->second(
-          req.params,
-          std::move(respond),
-          [&]() { return next_channel++; },
-          [self{shared_from_this()}](auto method, auto params, auto cb) {
-            Request req{self->next_request++, method, std::move(params)};
-            if (method == "xrpc.ch.close") {
-              self->timer.expires_from_now(kChanCloseDelay);
-              self->timer.async_wait(
-                  [self, req{std::move(req)}, cb{std::move(cb)}](auto) {
-                    self->_write(req, std::move(cb));
+      if (!found) {
+        respond(Response::Error{kMethodNotFound, "Method not found"});
+        return responds;
+      }
+      if (recorder) {
+        recorder->write(session, req.method, req.params);
+      }
+      if (pool && pooled.count(req.method) != 0) {
+        auto params{std::make_shared<Document>(std::move(req.params))};
+        net::post(*pool,
+                  [self{shared_from_this()},
+                   method{&it->second},
+                   params,
+                   span,
+                   respond{std::move(respond)}] {
+                    common::tracing::Scope scope{span};
+                    (*method)(
+                        *params,
+                        [self, respond](auto res) {
+                          auto _res{std::make_shared<decltype(res)>(
+                              std::move(res))};
+                          net::post(self->socket.get_executor(),
+                                    [respond, _res] {
+                                      respond(std::move(*_res));
+                                    });
+                        },
+                        [self] { return self->next_channel++; },
+                        [self](auto method, auto params, auto cb) {
+                          auto _params{
+                              std::make_shared<Document>(std::move(params))};
+                          net::post(self->socket.get_executor(),
+                                    [self, method, _params, cb] {
+                                      self->send(
+                                          method, std::move(*_params), cb);
+                                    });
+                        });
                   });
-              return;
-            }
-            self->_write(req, std::move(cb));
+        return responds;
+      }
+      common::tracing::Scope scope{span};
+      it->second(req.params,
+                 std::move(respond),
+                 [&]() { return next_channel++; },
+                 [self{shared_from_this()}](auto method, auto params, auto cb) {
+                   self->send(
+                       std::move(method), std::move(params), std::move(cb));
+                 });
+      return responds;
+    }
+
+    void send(std::string method, Document params, OkCb cb) {
+      Request req{next_request++, std::move(method), std::move(params)};
+      if (req.method == "xrpc.ch.close") {
+        timer.expires_from_now(kChanCloseDelay);
+        timer.async_wait([self{shared_from_this()},
+                          req{std::make_shared<Request>(std::move(req))},
+                          cb{std::move(cb)}](auto) {
+          self->_write(*req, std::move(cb));
+        });
+        return;
+      }
+      _write(req, std::move(cb));
+    }
+
+    /// Response envelope is written around result, without copying its dom
+    static void writeResponse(Writer &writer, const Response &res) {
+      writer.StartObject();
+      writer.Key("jsonrpc");
+      writer.String("2.0");
+      writer.Key("id");
+      if (res.id) {
+        writer.Uint64(*res.id);
+      } else {
+        writer.Null();
+      }
+      visit_in_place(
+          res.result,
+          [&](const Response::Error &error) {
+            writer.Key("error");
+            encode(error).Accept(writer);
+          },
+          [&](const Document &result) {
+            writer.Key("result");
+            result.Accept(writer);
           });
+      writer.EndObject();
+    }
+
+    Buffer takeBuffer() {
+      if (free_buffers.empty()) {
+        return {};
+      }
+      auto buffer{std::move(free_buffers.back())};
+      free_buffers.pop_back();
+      return buffer;
     }
 
     template <typename T>
     void _write(const T &v, OkCb cb) {
-      pending_writes.emplace(*codec::json::format(encode(v)), std::move(cb));
+      if (binary) {
+        auto j{encode(v)};
+        pending_writes.emplace(*codec::json::toCbor(&j), std::move(cb));
+        return _flush();
+      }
+      auto buffer{takeBuffer()};
+      codec::json::BufferStream stream{buffer};
+      Writer writer{stream};
+      if constexpr (std::is_same_v<T, Response>) {
+        writeResponse(writer, v);
+      } else if constexpr (std::is_same_v<T, std::vector<Response>>) {
+        writer.StartArray();
+        for (auto &res : v) {
+          writeResponse(writer, res);
+        }
+        writer.EndArray();
+      } else {
+        encode(v).Accept(writer);
+      }
+      pending_writes.emplace(std::move(buffer), std::move(cb));
       _flush();
     }
 
@@ -116,6 +413,12 @@ namespace fc::api {
               if (!ok) {
                 self->pending_writes = {};
               } else {
+                auto &buffer{self->pending_writes.front().first};
+                if (buffer.size() <= kReuseBufferMax
+                    && self->free_buffers.size() < kReuseBuffers) {
+                  buffer.clear();
+                  self->free_buffers.push_back(std::move(buffer));
+                }
                 self->pending_writes.pop();
                 self->_flush();
               }
@@ -126,18 +429,153 @@ namespace fc::api {
       }
     }
 
+    std::shared_ptr<net::thread_pool> pool;
+    std::set<std::string> pooled;
     std::queue<std::pair<Buffer, OkCb>> pending_writes;
+    std::vector<Buffer> free_buffers;
     bool writing{false};
-    uint64_t next_channel{}, next_request{};
+    /// Frames are cbor encoded json, see codec::json::toCbor
+    bool binary{false};
+    /// Channels may be made by pooled methods
+    std::atomic<uint64_t> next_channel{};
+    uint64_t next_request{};
     websocket::stream<tcp::socket> socket;
     net::deadline_timer timer;
     beast::flat_buffer buffer;
     Rpc rpc;
+    /// Set when requests are recorded
+    Recorder *recorder{Recorder::get()};
+    uint64_t session{};
+  };
+
+  /**
+   * Reads first request of connection, upgrades it to websocket session,
+   * passes it to matching route or responds with metrics.
+   */
+  struct HttpSession : std::enable_shared_from_this<HttpSession> {
+    HttpSession(tcp::socket &&socket,
+                const Api &api,
+                std::shared_ptr<net::thread_pool> pool,
+                std::set<std::string> pooled,
+                const HttpRoutes &routes)
+        : socket{std::move(socket)},
+          api{api},
+          pool{std::move(pool)},
+          pooled{std::move(pooled)},
+          routes{routes} {}
+
+    void run() {
+      http::async_read(
+          socket, buffer, req, [self{shared_from_this()}](auto ec, auto) {
+            if (ec) {
+              return;
+            }
+            self->onRead();
+          });
+    }
+
+    void onRead() {
+      if (websocket::is_upgrade(req)) {
+        return std::make_shared<ServerSession>(
+                   std::move(socket), api, pool, std::move(pooled))
+            ->run(req);
+      }
+      std::string_view target{req.target().data(), req.target().size()};
+      for (const auto &[prefix, route] : routes) {
+        if (target.substr(0, prefix.size()) == prefix
+            && (target.size() == prefix.size()
+                || target[prefix.size()] == '/')) {
+          return route(std::move(req), std::move(socket));
+        }
+      }
+      res.version(req.version());
+      res.keep_alive(false);
+      auto get{req.method() == http::verb::get};
+      if (get && target == "/metrics") {
+        res.result(http::status::ok);
+        res.set(http::field::content_type, "text/plain; version=0.0.4");
+        res.body() = common::metrics::Registry::instance().prometheus();
+      } else if (get && target == "/debug/profile/heap") {
+        res.result(http::status::ok);
+        res.set(http::field::content_type, "text/xml");
+        res.body() = common::profiler::heapInfo();
+      } else if (get && target.substr(0, kCpuProfile.size()) == kCpuProfile) {
+        return profileCpu(target.substr(kCpuProfile.size()));
+      } else {
+        res.result(http::status::not_found);
+      }
+      write();
+    }
+
+    /**
+     * Profiles for "?seconds=N" (default 30) on own thread, so io threads
+     * keep serving while profile runs
+     */
+    void profileCpu(std::string_view query) {
+      size_t seconds{30};
+      constexpr std::string_view kSeconds{"?seconds="};
+      if (!query.empty()) {
+        seconds = 0;
+      }
+      if (query.substr(0, kSeconds.size()) == kSeconds) {
+        for (auto c : query.substr(kSeconds.size())) {
+          if (c < '0' || c > '9' || seconds > kMaxProfileSeconds) {
+            break;
+          }
+          seconds = seconds * 10 + (c - '0');
+        }
+      }
+      if (seconds == 0 || seconds > kMaxProfileSeconds) {
+        res.result(http::status::bad_request);
+        return write();
+      }
+      std::thread{[self{shared_from_this()}, seconds] {
+        auto profile{
+            common::profiler::profileCpu(std::chrono::seconds{seconds})};
+        net::post(self->socket.get_executor(),
+                  [self, profile{std::move(profile)}] {
+                    if (profile) {
+                      self->res.result(http::status::ok);
+                      self->res.set(http::field::content_type, "text/plain");
+                      self->res.body() = profile.value();
+                    } else {
+                      self->res.result(http::status::service_unavailable);
+                      self->res.body() = profile.error().message();
+                    }
+                    self->write();
+                  });
+      }}.detach();
+    }
+
+    void write() {
+      res.prepare_payload();
+      http::async_write(
+          socket, res, [self{shared_from_this()}](auto ec, auto) {
+            self->socket.shutdown(tcp::socket::shutdown_send, ec);
+          });
+    }
+
+    tcp::socket socket;
+    const Api &api;
+    std::shared_ptr<net::thread_pool> pool;
+    std::set<std::string> pooled;
+    const HttpRoutes &routes;
+    beast::flat_buffer buffer;
+    http::request<http::string_body> req;
+    http::response<http::string_body> res;
   };
 
   struct Server : std::enable_shared_from_this<Server> {
-    Server(tcp::acceptor &&acceptor, std::shared_ptr<Api> api)
-        : acceptor{std::move(acceptor)}, api{api} {}
+    Server(tcp::acceptor &&acceptor,
+           std::shared_ptr<Api> api,
+           std::shared_ptr<net::thread_pool> pool,
+           std::set<std::string> pooled,
+           HttpRoutes routes)
+        : acceptor{std::move(acceptor)},
+          api{api},
+          pool{std::move(pool)},
+          pooled{std::move(pooled)},
+          routes{std::move(routes)} {}
 
     void run() {
       doAccept();
@@ -148,21 +586,36 @@ namespace fc::api {
         if (ec) {
           return;
         }
-        std::make_shared<ServerSession>(std::move(socket), *self->api)->run();
+        std::make_shared<HttpSession>(std::move(socket),
+                                      *self->api,
+                                      self->pool,
+                                      self->pooled,
+                                      self->routes)
+            ->run();
         self->doAccept();
       });
     }
 
     tcp::acceptor acceptor;
     std::shared_ptr<Api> api;
+    std::shared_ptr<net::thread_pool> pool;
+    std::set<std::string> pooled;
+    HttpRoutes routes;
   };
 
   void serve(std::shared_ptr<Api> api,
              boost::asio::io_context &ioc,
              std::string_view ip,
-             unsigned short port) {
+             unsigned short port,
+             std::shared_ptr<boost::asio::thread_pool> pool,
+             std::set<std::string> pooled,
+             HttpRoutes routes) {
     std::make_shared<Server>(
-        tcp::acceptor{ioc, {net::ip::make_address(ip), port}}, std::move(api))
+        tcp::acceptor{ioc, {net::ip::make_address(ip), port}},
+        std::move(api),
+        std::move(pool),
+        std::move(pooled),
+        std::move(routes))
         ->run();
   }
 }  // namespace fc::api
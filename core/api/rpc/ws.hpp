@@ -6,17 +6,49 @@
 #ifndef CPP_FILECOIN_CORE_API_RPC_WS_HPP
 #define CPP_FILECOIN_CORE_API_RPC_WS_HPP
 
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <set>
+
 #include "api/api.hpp"
 
 namespace boost::asio {
   class io_context;
+  class thread_pool;
 }  // namespace boost::asio
 
 namespace fc::api {
+  using HttpRequest =
+      boost::beast::http::request<boost::beast::http::string_body>;
+  /// Handles http request, takes connection and must respond on it
+  using HttpRoute =
+      std::function<void(HttpRequest &&, boost::asio::ip::tcp::socket &&)>;
+  /// Routes by target prefix, e.g. "/remote"
+  using HttpRoutes = std::map<std::string, HttpRoute>;
+
+  /// Read-only methods which may be slow, default for serve pooled methods
+  extern const std::set<std::string> kPooledMethods;
+
+  /**
+   * Serve api over websocket, and prometheus metrics over http at /metrics
+   * of same port.
+   * Profiles are served at /debug/profile/cpu?seconds=N (collapsed stacks)
+   * and /debug/profile/heap (allocator statistics).
+   * If pool is set, pooled methods are executed on it and their responses are
+   * written when ready, so they don't delay other requests of connection.
+   * Pooled methods must be safe to call concurrently.
+   * Other http requests with target matching routes are passed to them.
+   * When FC_RPC_RECORD_FILE is set, requests are appended to it for
+   * benchmark/rpc_replay.
+   */
   void serve(std::shared_ptr<Api> api,
              boost::asio::io_context &ioc,
              std::string_view ip,
-             unsigned short port);
+             unsigned short port,
+             std::shared_ptr<boost::asio::thread_pool> pool = nullptr,
+             std::set<std::string> pooled = kPooledMethods,
+             HttpRoutes routes = {});
 }  // namespace fc::api
 
 #endif  // CPP_FILECOIN_CORE_API_RPC_WS_HPP
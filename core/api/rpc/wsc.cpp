@@ -5,10 +5,13 @@
 
 #include "api/rpc/wsc.hpp"
 
+#include <algorithm>
+
 #include "api/rpc/json.hpp"
 #include "api/visit.hpp"
 #include "codec/json/json.hpp"
 #include "common/ptr.hpp"
+#include "common/tracing.hpp"
 #include "common/which.hpp"
 
 namespace fc::api::rpc {
@@ -45,16 +48,61 @@ namespace fc::api::rpc {
     if (ec) {
       return ec;
     }
+    socket.binary(binary);
     _read();
     return outcome::success();
   }
 
-  void Client::call(Request &&req, ResultCb &&cb) {
+  uint64_t Client::call(Request &&req, ResultCb &&cb) {
     std::lock_guard lock{mutex};
-    req.id = next_req++;
-    write_queue.emplace(*req.id, *codec::json::format(encode(req)));
-    result_queue.emplace(*req.id, std::move(cb));
+    auto id{next_req++};
+    req.id = id;
+    auto timeout{default_timeout};
+    auto it{timeouts.find(req.method)};
+    if (it != timeouts.end()) {
+      timeout = it->second;
+    }
+    auto j{encode(req)};
+    write_queue.emplace(id,
+                        binary ? *codec::json::toCbor(&j)
+                               : *codec::json::format(std::move(j)));
+    result_queue.emplace(id, std::move(cb));
+    if (timeout.count() != 0) {
+      auto &timer{timers[id]};
+      timer = std::make_unique<boost::asio::steady_timer>(io, timeout);
+      timer->async_wait([this, id](auto &&ec) {
+        if (!ec) {
+          std::lock_guard lock{mutex};
+          _end(id, std::errc::timed_out);
+        }
+      });
+    }
     _flush();
+    return id;
+  }
+
+  void Client::cancel(uint64_t id) {
+    std::lock_guard lock{mutex};
+    _end(id, std::errc::operation_canceled);
+  }
+
+  size_t Client::pending() {
+    std::lock_guard lock{mutex};
+    return result_queue.size();
+  }
+
+  void Client::_end(uint64_t id, outcome::result<Document> &&result) {
+    auto timer{timers.find(id)};
+    if (timer != timers.end()) {
+      timer->second->cancel();
+      timers.erase(timer);
+    }
+    auto it{result_queue.find(id)};
+    if (it != result_queue.end()) {
+      auto cb{std::move(it->second)};
+      result_queue.erase(it);
+      cb(std::move(result));
+    }
   }
 
   void Client::_chan(uint64_t id, ChanCb &&cb) {
@@ -63,6 +111,10 @@ namespace fc::api::rpc {
 
   void Client::_error(const std::error_code &error) {
     write_queue = {};
+    for (auto &[id, timer] : timers) {
+      timer->cancel();
+    }
+    timers.clear();
     for (auto &[id, cb] : result_queue) {
       cb(error);
     }
@@ -98,9 +150,10 @@ namespace fc::api::rpc {
         std::lock_guard lock{mutex};
         return _error(ec);
       }
-      std::string_view s{static_cast<const char *>(buffer.cdata().data()),
-                         buffer.cdata().size()};
-      if (auto _req{codec::json::parse(s)}) {
+      BytesIn input{static_cast<const uint8_t *>(buffer.cdata().data()),
+                    static_cast<ptrdiff_t>(buffer.cdata().size())};
+      if (auto _req{socket.got_binary() ? codec::json::fromCbor(input)
+                                        : codec::json::parse(input)}) {
         _onread(_req.value());
       }
       buffer.clear();
@@ -154,26 +207,28 @@ namespace fc::api::rpc {
         auto &res{_res.value()};
         if (res.id) {
           std::lock_guard lock{mutex};
-          auto it{result_queue.find(*res.id)};
-          if (it != result_queue.end()) {
-            if (common::which<Document>(res.result)) {
-              it->second(std::move(boost::get<Document>(res.result)));
-            } else {
-              it->second(std::errc::owner_dead);
-            }
-            result_queue.erase(it);
+          if (common::which<Document>(res.result)) {
+            _end(*res.id, std::move(boost::get<Document>(res.result)));
+          } else {
+            _end(*res.id, std::errc::owner_dead);
           }
         }
       }
     }
   }
 
-  template <typename M>
-  void _setup(Client &c, M &m) {
+  /// pick(chan) returns client for call
+  template <typename M, typename Pick>
+  void _setup(Pick pick, M &m) {
     using Result = typename M::Result;
-    m = [&c](auto &&... params) -> outcome::result<Result> {
+    m = [pick](auto &&... params) -> outcome::result<Result> {
+      Client &c{pick(is_chan<Result>{})};
+      // covers call until result for plain methods, until return for
+      // channels
+      common::tracing::Span span{std::string{"rpc.client "} + M::name};
       Request req{};
       req.method = M::name;
+      req.traceparent = span.context().traceparent();
       req.params =
           encode(std::make_tuple(std::forward<decltype(params)>(params)...));
       if constexpr (is_wait<Result>{}) {
@@ -236,6 +291,47 @@ namespace fc::api::rpc {
   }
 
   void Client::setup(Api &api) {
-    visit(api, [&](auto &m) { _setup(*this, m); });
+    visit(api, [&](auto &m) {
+      _setup([this](bool) -> Client & { return *this; }, m);
+    });
+  }
+
+  ClientPool::ClientPool(io_context &io2, size_t size) {
+    for (size_t i{0}; i < std::max<size_t>(1, size); ++i) {
+      clients.push_back(std::make_unique<Client>(io2));
+    }
+  }
+
+  outcome::result<void> ClientPool::connect(const Multiaddress &address,
+                                            const std::string &token) {
+    for (auto &client : clients) {
+      client->binary = binary;
+      client->default_timeout = default_timeout;
+      client->timeouts = timeouts;
+      OUTCOME_TRY(client->connect(address, token));
+    }
+    return outcome::success();
+  }
+
+  Client &ClientPool::pick(bool chan) {
+    if (chan || clients.size() == 1) {
+      return *clients[0];
+    }
+    auto best{clients.begin() + 1};
+    auto best_pending{(*best)->pending()};
+    for (auto it{best + 1}; it != clients.end() && best_pending != 0; ++it) {
+      auto pending{(*it)->pending()};
+      if (pending < best_pending) {
+        best = it;
+        best_pending = pending;
+      }
+    }
+    return **best;
+  }
+
+  void ClientPool::setup(Api &api) {
+    visit(api, [&](auto &m) {
+      _setup([this](bool chan) -> Client & { return pick(chan); }, m);
+    });
   }
 }  // namespace fc::api::rpc
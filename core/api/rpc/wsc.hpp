@@ -7,6 +7,7 @@
 
 #include <boost/asio/executor_work_guard.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <future>
@@ -30,8 +31,14 @@ namespace fc::api::rpc {
     ~Client();
     outcome::result<void> connect(const Multiaddress &address,
                                   const std::string &token);
-    void call(Request &&req, ResultCb &&cb);
+    /// Returns request id which can be passed to cancel
+    uint64_t call(Request &&req, ResultCb &&cb);
+    /// Fail pending call with operation_canceled, late response is ignored
+    void cancel(uint64_t id);
+    /// Calls waiting for response
+    size_t pending();
     void _chan(uint64_t id, ChanCb &&cb);
+    void _end(uint64_t id, outcome::result<Document> &&result);
     void _error(const std::error_code &error);
     void _flush();
     void _read();
@@ -47,8 +54,36 @@ namespace fc::api::rpc {
     std::mutex mutex;
     uint64_t next_req{};
     std::map<uint64_t, ResultCb> result_queue;
+    std::map<uint64_t, std::unique_ptr<boost::asio::steady_timer>> timers;
     std::map<uint64_t, ChanCb> chans;
     std::queue<std::pair<uint64_t, Buffer>> write_queue;
     bool writing{false};
+    /// Send cbor frames, set before connect, server answers the same way
+    bool binary{false};
+    /// Response timeout of methods, zero means no timeout
+    std::chrono::milliseconds default_timeout{};
+    std::map<std::string, std::chrono::milliseconds> timeouts;
+  };
+
+  /**
+   * Several connections to same node.
+   * Subscriptions use first connection, other calls go to connection with
+   * fewest pending calls, so call doesn't wait behind large response or
+   * channel traffic.
+   */
+  struct ClientPool {
+    static constexpr size_t kDefaultSize{3};
+
+    ClientPool(io_context &io2, size_t size = kDefaultSize);
+    /// Connect all clients, configured with binary and timeouts of pool
+    outcome::result<void> connect(const Multiaddress &address,
+                                  const std::string &token);
+    Client &pick(bool chan);
+    void setup(Api &api);
+
+    std::vector<std::unique_ptr<Client>> clients;
+    bool binary{false};
+    std::chrono::milliseconds default_timeout{};
+    std::map<std::string, std::chrono::milliseconds> timeouts;
   };
 }  // namespace fc::api::rpc
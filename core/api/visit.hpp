@@ -21,9 +21,12 @@ namespace fc::api {
     f(a.ChainGetRandomnessFromTickets);
     f(a.ChainGetTipSet);
     f(a.ChainGetTipSetByHeight);
+    f(a.ChainGetTipSetRange);
+    f(a.ChainHasObj);
     f(a.ChainHead);
     f(a.ChainNotify);
     f(a.ChainReadObj);
+    f(a.ChainReadObjs);
     f(a.ChainSetHead);
     f(a.ChainTipSetWeight);
     f(a.ClientFindData);
@@ -50,6 +53,7 @@ namespace fc::api {
     f(a.PledgeSector);
     f(a.StateAccountKey);
     f(a.StateCall);
+    f(a.StateChangedActors);
     f(a.StateGetActor);
     f(a.StateGetReceipt);
     f(a.StateListActors);
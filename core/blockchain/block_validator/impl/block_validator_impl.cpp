@@ -5,11 +5,20 @@
 
 #include "blockchain/block_validator/impl/block_validator_impl.hpp"
 
+#include <boost/asio/thread_pool.hpp>
+
 #include "blockchain/block_validator/impl/consensus_rules.hpp"
 #include "blockchain/block_validator/impl/syntax_rules.hpp"
 #include "codec/cbor/cbor.hpp"
+#include "common/thread_pool.hpp"
+#include "const.hpp"
+#include "crypto/blake2/blake2b160.hpp"
+#include "crypto/vrf/impl/vrf_provider_impl.hpp"
 #include "storage/amt/amt.hpp"
 #include "storage/ipld/ipld_block.hpp"
+#include "vm/actor/builtin/v0/miner/types.hpp"
+#include "vm/runtime/env.hpp"
+#include "vm/state/impl/state_tree_impl.hpp"
 
 namespace fc::blockchain::block_validator {
   using primitives::address::Protocol;
@@ -18,9 +27,18 @@ namespace fc::blockchain::block_validator {
   using UnsignedMessage = vm::message::UnsignedMessage;
   using BlsCryptoSignature = crypto::bls::Signature;
   using BlsCryptoPubKey = crypto::bls::PublicKey;
+  using crypto::randomness::DomainSeparationTag;
+  using crypto::randomness::drawRandomness;
   using SecpCryptoSignature = crypto::secp256k1::Signature;
   using SecpCryptoPubKey = crypto::secp256k1::PublicKey;
   using IPLDBlock = storage::ipld::IPLDBlock;
+  using vm::actor::builtin::v0::miner::MinerActorState;
+  using vm::runtime::resolveKey;
+  using vm::state::StateTree;
+  using vm::state::StateTreeImpl;
+
+  /// Secp messages verified by one pool task
+  constexpr size_t kSecpBatch{64};
 
   const std::map<scenarios::Stage, BlockValidatorImpl::StageExecutor>
       BlockValidatorImpl::stage_executors_{
@@ -31,17 +49,147 @@ namespace fc::blockchain::block_validator {
           {Stage::MESSAGE_SIGNATURE_BV4, &BlockValidatorImpl::messageSign},
           {Stage::STATE_TREE_BV5, &BlockValidatorImpl::stateTree}};
 
+  const std::map<scenarios::Stage, std::vector<scenarios::Stage>>
+      BlockValidatorImpl::stage_dependencies_{
+          {Stage::SYNTAX_BV0, {}},
+          {Stage::CONSENSUS_BV1, {Stage::SYNTAX_BV0}},
+          {Stage::BLOCK_SIGNATURE_BV2, {Stage::SYNTAX_BV0}},
+          {Stage::ELECTION_POST_BV3, {Stage::SYNTAX_BV0}},
+          {Stage::MESSAGE_SIGNATURE_BV4, {Stage::SYNTAX_BV0}},
+          {Stage::STATE_TREE_BV5, {Stage::SYNTAX_BV0}}};
+
+  BlockValidatorImpl::BlockValidatorImpl(
+      std::shared_ptr<IpfsDatastore> ipfs_store,
+      std::shared_ptr<UTCClock> utc_clock,
+      std::shared_ptr<EpochClock> epoch_clock,
+      std::shared_ptr<WeightCalculator> weight_calculator,
+      std::shared_ptr<PowerTable> power_table,
+      std::shared_ptr<BlsProvider> bls_crypto_provider,
+      std::shared_ptr<SecpProvider> secp_crypto_provider,
+      std::shared_ptr<Interpreter> vm_interpreter,
+      std::shared_ptr<boost::asio::thread_pool> pool)
+      : datastore_{std::move(ipfs_store)},
+        clock_{std::move(utc_clock)},
+        epoch_clock_{std::move(epoch_clock)},
+        weight_calculator_{std::move(weight_calculator)},
+        power_table_{std::move(power_table)},
+        bls_provider_{std::move(bls_crypto_provider)},
+        secp_provider_{std::move(secp_crypto_provider)},
+        vm_interpreter_{std::move(vm_interpreter)},
+        vrf_provider_{
+            std::make_shared<crypto::vrf::VRFProviderImpl>(bls_provider_)},
+        pool_{std::move(pool)} {}
+
   outcome::result<void> BlockValidatorImpl::validateBlock(
       const BlockHeader &block, scenarios::Scenario scenario) const {
     for (const auto &stage : scenario) {
-      auto executor = stage_executors_.find(stage);
-      if (executor != stage_executors_.end()) {
-        auto result = std::invoke(executor->second, this, block);
-        if (result.has_error()) {
-          return result;
+      if (stage_executors_.find(stage) == stage_executors_.end()) {
+        return ValidatorError::kUnknownStage;
+      }
+    }
+    std::atomic_bool cancelled{false};
+    // waiting for pool tasks on pool thread may deadlock
+    auto parallel{pool_ && !pool_->get_executor().running_in_this_thread()};
+    return runStages(
+        block, {scenario.begin(), scenario.end()}, parallel, cancelled);
+  }
+
+  outcome::result<void> BlockValidatorImpl::validateTipset(
+      const Tipset &tipset, scenarios::Scenario scenario) const {
+    for (const auto &stage : scenario) {
+      if (stage_executors_.find(stage) == stage_executors_.end()) {
+        return ValidatorError::kUnknownStage;
+      }
+    }
+    std::vector<Stage> stages{scenario.begin(), scenario.end()};
+    std::atomic_bool cancelled{false};
+    auto validate{[&](size_t i) {
+      return runStages(tipset.blks[i], stages, false, cancelled);
+    }};
+    // waiting for pool tasks on pool thread may deadlock
+    if (!pool_ || tipset.blks.size() == 1
+        || pool_->get_executor().running_in_this_thread()) {
+      for (size_t i{0}; i < tipset.blks.size(); ++i) {
+        OUTCOME_TRY(validate(i));
+      }
+      return outcome::success();
+    }
+    std::vector<std::future<outcome::result<void>>> futures;
+    for (size_t i{1}; i < tipset.blks.size(); ++i) {
+      futures.push_back(postFuture(*pool_, [&, i] { return validate(i); }));
+    }
+    auto first{validate(0)};
+    // wait all tasks, they reference local state
+    outcome::result<void> result{outcome::success()};
+    for (auto &future : futures) {
+      auto block_result{future.get()};
+      if (result && !block_result) {
+        result = std::move(block_result);
+      }
+    }
+    OUTCOME_TRY(first);
+    return result;
+  }
+
+  outcome::result<void> BlockValidatorImpl::runStages(
+      const BlockHeader &block,
+      const std::vector<Stage> &stages,
+      bool parallel,
+      std::atomic_bool &cancelled) const {
+    std::vector<boost::optional<outcome::result<void>>> results(stages.size());
+    auto passed{[&](Stage stage) {
+      for (size_t i{0}; i < stages.size(); ++i) {
+        if (stages[i] == stage) {
+          return results[i].has_value();
+        }
+      }
+      // not required by scenario
+      return true;
+    }};
+    auto run{[&](size_t i) -> outcome::result<void> {
+      if (cancelled) {
+        return outcome::success();
+      }
+      auto result{std::invoke(stage_executors_.at(stages[i]), this, block)};
+      if (!result) {
+        cancelled = true;
+      }
+      return result;
+    }};
+    while (true) {
+      std::vector<size_t> ready;
+      for (size_t i{0}; i < stages.size(); ++i) {
+        auto &dependencies{stage_dependencies_.at(stages[i])};
+        if (!results[i]
+            && std::all_of(dependencies.begin(), dependencies.end(), passed)) {
+          ready.push_back(i);
+        }
+      }
+      if (ready.empty()) {
+        break;
+      }
+      if (!parallel || ready.size() == 1) {
+        for (auto i : ready) {
+          results[i] = run(i);
         }
       } else {
-        return ValidatorError::kUnknownStage;
+        std::vector<std::future<outcome::result<void>>> futures;
+        for (size_t j{1}; j < ready.size(); ++j) {
+          futures.push_back(
+              postFuture(*pool_, [&, i{ready[j]}] { return run(i); }));
+        }
+        results[ready[0]] = run(ready[0]);
+        // wait all tasks, they reference local state
+        for (size_t j{1}; j < ready.size(); ++j) {
+          results[ready[j]] = futures[j - 1].get();
+        }
+      }
+      for (auto i : ready) {
+        OUTCOME_TRY(*results[i]);
+      }
+      if (cancelled) {
+        // other block of tipset failed
+        break;
       }
     }
     return outcome::success();
@@ -64,7 +212,7 @@ namespace fc::blockchain::block_validator {
     OUTCOME_TRY(ConsensusRules::activeMiner(block, power_table_));
     OUTCOME_TRY(parent_tipset, getParentTipset(block));
     OUTCOME_TRY(ConsensusRules::parentWeight(
-        block, *parent_tipset.get(), weight_calculator_));
+        block, *parent_tipset, weight_calculator_));
     OUTCOME_TRY(chain_epoch, epoch_clock_->epochAtTime(clock_->nowUTC()));
     OUTCOME_TRY(ConsensusRules::epoch(block, chain_epoch));
     return outcome::success();
@@ -85,7 +233,7 @@ namespace fc::blockchain::block_validator {
         [](const ActorExecHash &) -> outcome::result<void> {
           return ValidatorError::kInvalidMinerPublicKey;
         },
-        [&block_signature, &block_bytes, *this](
+        [&block_signature, &block_bytes, this](
             const SecpPubKey &public_key) -> outcome::result<void> {
           crypto::secp256k1::PublicKey secp_public_key;
           auto secp_signature =
@@ -102,7 +250,7 @@ namespace fc::blockchain::block_validator {
           }
           return ValidatorError::kInvalidBlockSignature;
         },
-        [&block_signature, &block_bytes, *this](
+        [&block_signature, &block_bytes, this](
             const BlsPubKey &public_key) -> outcome::result<void> {
           auto bls_signature =
               boost::get<crypto::bls::Signature>(block_signature);
@@ -124,7 +272,96 @@ namespace fc::blockchain::block_validator {
 
   outcome::result<void> BlockValidatorImpl::electionPost(
       const BlockHeader &block) const {
-    return outcome::success();
+    OUTCOME_TRY(requests, vrfRequests(block));
+    return verifyVRFs(requests);
+  }
+
+  outcome::result<void> BlockValidatorImpl::validateTipsetVRFs(
+      const Tipset &tipset) const {
+    std::vector<VRFVerifyRequest> requests;
+    for (auto &block : tipset.blks) {
+      OUTCOME_TRY(block_requests, vrfRequests(block));
+      requests.insert(requests.end(),
+                      std::make_move_iterator(block_requests.begin()),
+                      std::make_move_iterator(block_requests.end()));
+    }
+    return verifyVRFs(requests);
+  }
+
+  outcome::result<std::vector<BlockValidatorImpl::VRFVerifyRequest>>
+  BlockValidatorImpl::vrfRequests(const BlockHeader &block) const {
+    crypto::vrf::VRFProof ticket, election;
+    if (!block.ticket || block.ticket->bytes.size() != ticket.size()) {
+      return ValidatorError::kInvalidTicket;
+    }
+    if (block.election_proof.vrf_proof.size() != election.size()) {
+      return ValidatorError::kInvalidElectionProof;
+    }
+    std::copy_n(block.ticket->bytes.begin(), ticket.size(), ticket.begin());
+    std::copy_n(block.election_proof.vrf_proof.begin(),
+                election.size(),
+                election.begin());
+    OUTCOME_TRY(parent, getParentTipset(block));
+    auto beacon{block.beacon_entries.empty()
+                    ? parent->latestBeacon(*datastore_)
+                    : block.beacon_entries.back()};
+    OUTCOME_TRY(beacon);
+
+    // worker of miner at lookback, as used by miner for election
+    auto lookback_height{block.height > kWinningPoStSectorSetLookback
+                             ? block.height - kWinningPoStSectorSetLookback
+                             : 0};
+    auto lookback{parent};
+    while (lookback->height() > lookback_height) {
+      OUTCOME_TRYA(lookback, lookback->loadParent(*datastore_));
+    }
+    OUTCOME_TRY(interpreted, vm_interpreter_->interpret(datastore_, lookback));
+    StateTreeImpl lookback_tree{datastore_, interpreted.state_root};
+    OUTCOME_TRY(miner_state, lookback_tree.state<MinerActorState>(block.miner));
+    OUTCOME_TRY(miner_info, miner_state.info.get());
+    StateTreeImpl parent_tree{datastore_, block.parent_state_root};
+    OUTCOME_TRY(worker, resolveKey(parent_tree, miner_info.worker));
+    if (worker.getProtocol() != Protocol::BLS) {
+      return ValidatorError::kInvalidMinerPublicKey;
+    }
+    auto &hash{boost::get<primitives::address::BLSPublicKeyHash>(worker.data)};
+    crypto::vrf::VRFPublicKey key;
+    std::copy_n(hash.begin(), key.size(), key.begin());
+
+    OUTCOME_TRY(miner_seed, codec::cbor::encode(block.miner));
+    auto ticket_seed{miner_seed};
+    if (block.height > kUpgradeSmokeHeight) {
+      ticket_seed.put(parent->getMinTicketBlock().ticket->bytes);
+    }
+    return std::vector<VRFVerifyRequest>{
+        {key,
+         Buffer{drawRandomness(beacon.value().data,
+                               DomainSeparationTag::TicketProduction,
+                               static_cast<primitives::ChainEpoch>(
+                                   block.height)
+                                   - kTicketRandomnessLookback,
+                               ticket_seed)},
+         ticket},
+        {key,
+         Buffer{drawRandomness(beacon.value().data,
+                               DomainSeparationTag::ElectionProofProduction,
+                               block.height,
+                               miner_seed)},
+         election},
+    };
+  }
+
+  outcome::result<void> BlockValidatorImpl::verifyVRFs(
+      gsl::span<const VRFVerifyRequest> requests) const {
+    OUTCOME_TRY(valid, vrf_provider_->verifyVRFs(requests));
+    auto invalid{std::find(valid.begin(), valid.end(), false)};
+    if (invalid == valid.end()) {
+      return outcome::success();
+    }
+    // requests of block are ticket then election proof
+    return (invalid - valid.begin()) % 2 == 0
+               ? ValidatorError::kInvalidTicket
+               : ValidatorError::kInvalidElectionProof;
   }
 
   outcome::result<void> BlockValidatorImpl::chainAncestry(
@@ -134,6 +371,112 @@ namespace fc::blockchain::block_validator {
 
   outcome::result<void> BlockValidatorImpl::messageSign(
       const BlockHeader &block) const {
+    StateTreeImpl state_tree{datastore_, block.parent_state_root};
+    std::vector<std::pair<SignedMessage, Address>> secp;
+    OUTCOME_TRY(blsMessagesSign(block, state_tree, secp));
+    return secpMessagesSign(secp);
+  }
+
+  outcome::result<void> BlockValidatorImpl::validateMessageSignatures(
+      const Tipset &tipset) const {
+    StateTreeImpl state_tree{datastore_, tipset.getParentStateRoot()};
+    std::vector<std::pair<SignedMessage, Address>> secp;
+    for (auto &block : tipset.blks) {
+      OUTCOME_TRY(blsMessagesSign(block, state_tree, secp));
+    }
+    return secpMessagesSign(secp);
+  }
+
+  outcome::result<void> BlockValidatorImpl::blsMessagesSign(
+      const BlockHeader &block,
+      StateTree &state_tree,
+      std::vector<std::pair<SignedMessage, Address>> &secp) const {
+    OUTCOME_TRY(meta, datastore_->getCbor<MsgMeta>(block.messages));
+    std::vector<std::vector<uint8_t>> bls_cids;
+    std::vector<BlsCryptoPubKey> bls_keys;
+    OUTCOME_TRY(meta.bls_messages.visit(
+        [&](auto, auto &cid) -> outcome::result<void> {
+          OUTCOME_TRY(message, datastore_->getCbor<UnsignedMessage>(cid));
+          OUTCOME_TRY(key, resolveKey(state_tree, message.from));
+          if (key.getProtocol() != Protocol::BLS) {
+            return ValidatorError::kInvalidMessageSignature;
+          }
+          auto &hash{boost::get<primitives::address::BLSPublicKeyHash>(
+              key.data)};
+          auto &bls_key{bls_keys.emplace_back()};
+          std::copy_n(hash.begin(), bls_key.size(), bls_key.begin());
+          OUTCOME_TRY(cid_bytes, cid.toBytes());
+          bls_cids.push_back(std::move(cid_bytes));
+          return outcome::success();
+        }));
+    if (!block.bls_aggregate || !block.bls_aggregate->isBls()) {
+      return ValidatorError::kInvalidMessageSignature;
+    }
+    OUTCOME_TRY(valid,
+                bls_provider_->verifyAggregateSignature(
+                    bls_cids,
+                    bls_keys,
+                    boost::get<BlsCryptoSignature>(*block.bls_aggregate)));
+    if (!valid) {
+      return ValidatorError::kInvalidMessageSignature;
+    }
+    return meta.secp_messages.visit(
+        [&](auto, auto &cid) -> outcome::result<void> {
+          OUTCOME_TRY(message, datastore_->getCbor<SignedMessage>(cid));
+          OUTCOME_TRY(key, resolveKey(state_tree, message.message.from));
+          secp.emplace_back(std::move(message), std::move(key));
+          return outcome::success();
+        });
+  }
+
+  outcome::result<void> BlockValidatorImpl::secpMessagesSign(
+      const std::vector<std::pair<SignedMessage, Address>> &secp) const {
+    auto verify{[&](size_t begin, size_t end) -> outcome::result<bool> {
+      for (auto i{begin}; i < end; ++i) {
+        auto &[message, key]{secp[i]};
+        if (key.getProtocol() != Protocol::SECP256K1
+            || message.signature.isBls()) {
+          return false;
+        }
+        OUTCOME_TRY(cid_bytes, message.message.getCid().toBytes());
+        OUTCOME_TRY(public_key,
+                    secp_provider_->recoverPublicKey(
+                        crypto::blake2b::blake2b_256(cid_bytes),
+                        boost::get<SecpCryptoSignature>(message.signature)));
+        if (!key.verifySyntax(public_key)) {
+          return false;
+        }
+      }
+      return true;
+    }};
+    // waiting for pool tasks on pool thread may deadlock
+    if (!pool_ || secp.size() <= kSecpBatch
+        || pool_->get_executor().running_in_this_thread()) {
+      OUTCOME_TRY(valid, verify(0, secp.size()));
+      if (!valid) {
+        return ValidatorError::kInvalidMessageSignature;
+      }
+      return outcome::success();
+    }
+    std::vector<std::future<outcome::result<bool>>> futures;
+    for (size_t begin{0}; begin < secp.size(); begin += kSecpBatch) {
+      auto end{std::min(begin + kSecpBatch, secp.size())};
+      futures.push_back(postFuture(*pool_, [&, begin, end] {
+        return verify(begin, end);
+      }));
+    }
+    // wait all tasks, they reference local state
+    outcome::result<bool> valid{true};
+    for (auto &future : futures) {
+      auto result{future.get()};
+      if (valid && valid.value() && (!result || !result.value())) {
+        valid = std::move(result);
+      }
+    }
+    OUTCOME_TRY(valid);
+    if (!valid.value()) {
+      return ValidatorError::kInvalidMessageSignature;
+    }
     return outcome::success();
   }
 
@@ -141,7 +484,7 @@ namespace fc::blockchain::block_validator {
       const BlockHeader &block) const {
     OUTCOME_TRY(parent_tipset, getParentTipset(block));
     OUTCOME_TRY(result,
-                vm_interpreter_->interpret(datastore_, parent_tipset.get()));
+                vm_interpreter_->interpret(datastore_, parent_tipset));
     if (result.state_root == block.parent_state_root
         && result.message_receipts == block.parent_message_receipts) {
       return outcome::success();
@@ -149,9 +492,10 @@ namespace fc::blockchain::block_validator {
     return ValidatorError::kInvalidParentState;
   }
 
-  outcome::result<std::reference_wrapper<BlockValidatorImpl::TipsetCPtr>>
+  outcome::result<BlockValidatorImpl::TipsetCPtr>
   BlockValidatorImpl::getParentTipset(const BlockHeader &block) const {
     IPLDBlock ipld_block = IPLDBlock::create(block);
+    std::lock_guard lock{parent_tipset_mutex_};
     if (parent_tipset_cache_
         && parent_tipset_cache_.value().first == ipld_block.cid) {
       return parent_tipset_cache_.value().second;
@@ -194,6 +538,12 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::blockchain::block_validator,
       return "Block validation: invalid miner public key";
     case ValidatorError::kInvalidParentState:
       return "Block validation: invalid parent state";
+    case ValidatorError::kInvalidMessageSignature:
+      return "Block validation: invalid message signature";
+    case ValidatorError::kInvalidTicket:
+      return "Block validation: invalid ticket";
+    case ValidatorError::kInvalidElectionProof:
+      return "Block validation: invalid election proof";
   }
   return "Block validation: unknown error";
 }
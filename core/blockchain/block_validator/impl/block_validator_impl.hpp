@@ -6,9 +6,11 @@
 #ifndef CPP_FILECOIN_CORE_CHAIN_IMPL_BLOCK_VALIDATOR_IMPL_HPP
 #define CPP_FILECOIN_CORE_CHAIN_IMPL_BLOCK_VALIDATOR_IMPL_HPP
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include <boost/optional.hpp>
 #include <libp2p/crypto/secp256k1_provider.hpp>
@@ -17,9 +19,15 @@
 #include "clock/chain_epoch_clock.hpp"
 #include "clock/utc_clock.hpp"
 #include "crypto/bls/bls_provider.hpp"
+#include "crypto/vrf/vrf_provider.hpp"
 #include "power/power_table.hpp"
 #include "storage/ipfs/datastore.hpp"
 #include "vm/interpreter/interpreter.hpp"
+#include "vm/state/state_tree.hpp"
+
+namespace boost::asio {
+  class thread_pool;
+}  // namespace boost::asio
 
 namespace fc::blockchain::block_validator {
 
@@ -36,33 +44,67 @@ namespace fc::blockchain::block_validator {
     using Interpreter = vm::interpreter::Interpreter;
     using Tipset = primitives::tipset::Tipset;
     using TipsetCPtr = primitives::tipset::TipsetCPtr;
+    using MsgMeta = primitives::block::MsgMeta;
+    using SignedMessage = vm::message::SignedMessage;
+    using Address = primitives::address::Address;
+    using VRFProvider = crypto::vrf::VRFProvider;
+    using VRFVerifyRequest = crypto::vrf::VRFVerifyRequest;
 
    public:
     using StageExecutor = outcome::result<void> (BlockValidatorImpl::*)(
         const BlockHeader &) const;
 
-    BlockValidatorImpl(std::shared_ptr<IpfsDatastore> ipfs_store,
-                       std::shared_ptr<UTCClock> utc_clock,
-                       std::shared_ptr<EpochClock> epoch_clock,
-                       std::shared_ptr<WeightCalculator> weight_calculator,
-                       std::shared_ptr<PowerTable> power_table,
-                       std::shared_ptr<BlsProvider> bls_crypto_provider,
-                       std::shared_ptr<SecpProvider> secp_crypto_provider,
-                       std::shared_ptr<Interpreter> vm_interpreter)
-        : datastore_{std::move(ipfs_store)},
-          clock_{std::move(utc_clock)},
-          epoch_clock_{std::move(epoch_clock)},
-          weight_calculator_{std::move(weight_calculator)},
-          power_table_{std::move(power_table)},
-          bls_provider_{std::move(bls_crypto_provider)},
-          secp_provider_{std::move(secp_crypto_provider)},
-          vm_interpreter_{std::move(vm_interpreter)} {}
+    BlockValidatorImpl(
+        std::shared_ptr<IpfsDatastore> ipfs_store,
+        std::shared_ptr<UTCClock> utc_clock,
+        std::shared_ptr<EpochClock> epoch_clock,
+        std::shared_ptr<WeightCalculator> weight_calculator,
+        std::shared_ptr<PowerTable> power_table,
+        std::shared_ptr<BlsProvider> bls_crypto_provider,
+        std::shared_ptr<SecpProvider> secp_crypto_provider,
+        std::shared_ptr<Interpreter> vm_interpreter,
+        std::shared_ptr<boost::asio::thread_pool> pool = nullptr);
 
+    /**
+     * Stages of scenario run in waves, stages whose dependencies passed run
+     * concurrently on pool. Stages not started yet are skipped when any
+     * stage fails.
+     */
     outcome::result<void> validateBlock(
         const BlockHeader &header, scenarios::Scenario scenario) const override;
 
+    /**
+     * @brief Validate all tipset blocks concurrently on pool
+     * @param tipset - tipset to check
+     * @param scenario - required validation stages
+     * @return first error in blocks order
+     */
+    outcome::result<void> validateTipset(const Tipset &tipset,
+                                         scenarios::Scenario scenario) const;
+
+    /**
+     * @brief Check messages signatures of all tipset blocks: bls messages with
+     * one aggregate verification per block, secp messages of all blocks in
+     * parallel on pool
+     * @param tipset - tipset to check
+     * @return Check result
+     */
+    outcome::result<void> validateMessageSignatures(const Tipset &tipset) const;
+
+    /**
+     * @brief Check tickets and election proofs of all tipset blocks with one
+     * batch verification. Worker keys are taken from lookback state, so
+     * tipsets down to lookback must be interpreted already.
+     * @param tipset - tipset to check
+     * @return Check result
+     */
+    outcome::result<void> validateTipsetVRFs(const Tipset &tipset) const;
+
    private:
     const static std::map<scenarios::Stage, StageExecutor> stage_executors_;
+    /// Stages which must pass before stage, if they are in scenario
+    const static std::map<scenarios::Stage, std::vector<scenarios::Stage>>
+        stage_dependencies_;
 
     std::shared_ptr<IpfsDatastore> datastore_;
     std::shared_ptr<UTCClock> clock_;
@@ -72,13 +114,29 @@ namespace fc::blockchain::block_validator {
     std::shared_ptr<BlsProvider> bls_provider_;
     std::shared_ptr<SecpProvider> secp_provider_;
     std::shared_ptr<Interpreter> vm_interpreter_;
+    std::shared_ptr<VRFProvider> vrf_provider_;
+    /// Runs stages and verifies secp signatures, sequential if null
+    std::shared_ptr<boost::asio::thread_pool> pool_;
 
     /**
      * BlockHeader CID -> Parent tipset
-     * Assuming that block validation executes sequentially,
-     * so for several blocks parent tipset will be the same
+     * Stages of one block share parent tipset
      */
     mutable boost::optional<std::pair<CID, TipsetCPtr>> parent_tipset_cache_;
+    mutable std::mutex parent_tipset_mutex_;
+
+    /**
+     * @brief Run stages in dependency order
+     * @param header - block to check
+     * @param stages - stages of scenario
+     * @param parallel - run independent stages on pool
+     * @param cancelled - set on failure, stages are not started when set
+     * @return first error in stages order
+     */
+    outcome::result<void> runStages(const BlockHeader &header,
+                                    const std::vector<Stage> &stages,
+                                    bool parallel,
+                                    std::atomic_bool &cancelled) const;
 
     /**
      * @brief Check block syntax
@@ -102,12 +160,21 @@ namespace fc::blockchain::block_validator {
     outcome::result<void> blockSign(const BlockHeader &header) const;
 
     /**
-     * @brief Check miner election params
+     * @brief Check ticket and election proof vrfs of block
      * @param header - block to check
      * @return Check result
      */
     outcome::result<void> electionPost(const BlockHeader &header) const;
 
+    /// Ticket and election proof of block with worker key and drawn
+    /// randomness they sign
+    outcome::result<std::vector<VRFVerifyRequest>> vrfRequests(
+        const BlockHeader &header) const;
+
+    /// Fails with first invalid vrf, ticket or election proof
+    outcome::result<void> verifyVRFs(
+        gsl::span<const VRFVerifyRequest> requests) const;
+
     /**
      * @brief Check chain ancestry params
      * @param header - block to check
@@ -122,6 +189,19 @@ namespace fc::blockchain::block_validator {
      */
     outcome::result<void> messageSign(const BlockHeader &header) const;
 
+    /**
+     * @brief Check aggregated signature of block bls messages, collect secp
+     * messages with their signer keys
+     */
+    outcome::result<void> blsMessagesSign(
+        const BlockHeader &header,
+        vm::state::StateTree &state_tree,
+        std::vector<std::pair<SignedMessage, Address>> &secp) const;
+
+    /// Check signatures of secp messages against their signer keys
+    outcome::result<void> secpMessagesSign(
+        const std::vector<std::pair<SignedMessage, Address>> &secp) const;
+
     /**
      * @brief Check parent state tree
      * @param header - block to check
@@ -134,7 +214,7 @@ namespace fc::blockchain::block_validator {
      * @param header - selected block
      * @return operation result
      */
-    outcome::result<std::reference_wrapper<TipsetCPtr>> getParentTipset(
+    outcome::result<TipsetCPtr> getParentTipset(
         const BlockHeader &header) const;
   };
 
@@ -144,6 +224,9 @@ namespace fc::blockchain::block_validator {
     kInvalidBlockSignature,
     kInvalidMinerPublicKey,
     kInvalidParentState,
+    kInvalidMessageSignature,
+    kInvalidTicket,
+    kInvalidElectionProof,
   };
 
 }  // namespace fc::blockchain::block_validator
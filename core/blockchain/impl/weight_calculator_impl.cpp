@@ -26,15 +26,19 @@ namespace fc::blockchain::weight {
   constexpr uint64_t kWRatioDen{2};
   constexpr uint64_t kBlocksPerEpoch{5};
 
-  WeightCalculatorImpl::WeightCalculatorImpl(std::shared_ptr<Ipld> ipld)
-      : ipld_{std::move(ipld)} {}
+  WeightCalculatorImpl::WeightCalculatorImpl(std::shared_ptr<Ipld> ipld,
+                                             size_t cache_size)
+      : ipld_{std::move(ipld)}, power_{cache_size}, weights_{cache_size} {}
 
   outcome::result<BigInt> WeightCalculatorImpl::calculateWeight(
       const Tipset &tipset) {
-    OUTCOME_TRY(state,
-                StateTreeImpl{ipld_, tipset.getParentStateRoot()}
-                    .state<StoragePowerActorState>(kStoragePowerAddress));
-    auto network_power = state.total_qa_power;
+    {
+      std::lock_guard lock{mutex_};
+      if (auto weight{weights_.get(tipset.key)}) {
+        return std::move(*weight);
+      }
+    }
+    OUTCOME_TRY(network_power, networkPower(tipset.getParentStateRoot()));
     if (network_power <= 0) {
       return outcome::failure(WeightCalculatorError::kNoNetworkPower);
     }
@@ -43,8 +47,27 @@ namespace fc::blockchain::weight {
     for (auto &block : tipset.blks) {
       j += block.election_proof.win_count;
     }
-    return tipset.getParentWeight() + log
-           + bigdiv(log * j * kWRatioNum, kBlocksPerEpoch * kWRatioDen);
+    auto weight{tipset.getParentWeight() + log
+                + bigdiv(log * j * kWRatioNum, kBlocksPerEpoch * kWRatioDen)};
+    std::lock_guard lock{mutex_};
+    weights_.put(tipset.key, weight, 1);
+    return weight;
+  }
+
+  outcome::result<BigInt> WeightCalculatorImpl::networkPower(
+      const CID &state_root) {
+    {
+      std::lock_guard lock{mutex_};
+      if (auto power{power_.get(state_root)}) {
+        return std::move(*power);
+      }
+    }
+    OUTCOME_TRY(state,
+                StateTreeImpl{ipld_, state_root}.state<StoragePowerActorState>(
+                    kStoragePowerAddress));
+    std::lock_guard lock{mutex_};
+    power_.put(state_root, state.total_qa_power, 1);
+    return state.total_qa_power;
   }
 
 }  // namespace fc::blockchain::weight
@@ -8,21 +8,38 @@
 
 #include "blockchain/weight_calculator.hpp"
 
+#include <mutex>
+
+#include "common/lru_cache.hpp"
 #include "storage/ipfs/datastore.hpp"
 
 namespace fc::blockchain::weight {
   enum class WeightCalculatorError { kNoNetworkPower = 1 };
 
+  /**
+   * Weight is parent weight plus value derived from network power in parent
+   * state. Network power is cached by parent state root (shared by sibling
+   * tipsets) and weights by tipset key, so repeated fork choice comparisons
+   * don't decode power actor state again.
+   */
   class WeightCalculatorImpl : public WeightCalculator {
    public:
-    explicit WeightCalculatorImpl(std::shared_ptr<Ipld> ipld);
+    static constexpr size_t kDefaultCacheSize{1024};
+
+    explicit WeightCalculatorImpl(std::shared_ptr<Ipld> ipld,
+                                  size_t cache_size = kDefaultCacheSize);
 
     ~WeightCalculatorImpl() override = default;
 
     outcome::result<BigInt> calculateWeight(const Tipset &tipset) override;
 
    private:
+    outcome::result<BigInt> networkPower(const CID &state_root);
+
     std::shared_ptr<Ipld> ipld_;
+    std::mutex mutex_;
+    common::LruCache<CID, BigInt> power_;
+    common::LruCache<TipsetKey, BigInt> weights_;
   };
 
 }  // namespace fc::blockchain::weight
@@ -7,62 +7,107 @@
 
 #include "blockchain/impl/weight_calculator_impl.hpp"
 #include "crypto/bls/impl/bls_provider_impl.hpp"
+#include "primitives/cid/cid_of_cbor.hpp"
 
 namespace fc::blockchain::production {
   using crypto::signature::BlsSignature;
   using crypto::signature::Secp256k1Signature;
   using primitives::block::MsgMeta;
-  using vm::message::SignedMessage;
-  using vm::message::UnsignedMessage;
 
-  outcome::result<BlockWithMessages> generate(Interpreter &interpreter,
-                                              std::shared_ptr<Ipld> ipld,
-                                              BlockTemplate t) {
-    OUTCOME_TRY(parent_tipset,
-                primitives::tipset::Tipset::load(*ipld, t.parents));
-    OUTCOME_TRY(vm_result, interpreter.interpret(ipld, parent_tipset));
-    BlockWithMessages b;
-    MsgMeta msg_meta;
-    ipld->load(msg_meta);
+  outcome::result<BlockBody> assembleBody(
+      const std::shared_ptr<Ipld> &ipld,
+      const std::vector<SignedMessage> &messages) {
+    BlockBody b;
     std::vector<crypto::bls::Signature> bls_signatures;
-    for (auto &message : t.messages) {
+    for (auto &message : messages) {
       OUTCOME_TRY(visit_in_place(
           message.signature,
           [&](const BlsSignature &signature) -> outcome::result<void> {
             b.bls_messages.emplace_back(message.message);
             bls_signatures.push_back(signature);
             OUTCOME_TRY(message_cid, ipld->setCbor(message.message));
-            OUTCOME_TRY(msg_meta.bls_messages.append(message_cid));
+            b.bls_cids.push_back(std::move(message_cid));
             return outcome::success();
           },
           [&](const Secp256k1Signature &signature) -> outcome::result<void> {
             b.secp_messages.emplace_back(message);
             OUTCOME_TRY(message_cid, ipld->setCbor(message));
-            OUTCOME_TRY(msg_meta.secp_messages.append(message_cid));
+            b.secp_cids.push_back(std::move(message_cid));
             return outcome::success();
           }));
     }
-    b.header.miner = std::move(t.miner);
-    b.header.ticket = std::move(t.ticket);
-    b.header.election_proof = std::move(t.election_proof);
-    b.header.beacon_entries = std::move(t.beacon_entries);
-    b.header.win_post_proof = std::move(t.win_post_proof);
-    b.header.parents = std::move(t.parents);
-    OUTCOME_TRYA(
-        b.header.parent_weight,
-        weight::WeightCalculatorImpl{ipld}.calculateWeight(*parent_tipset));
-    b.header.height = t.height;
-    b.header.parent_state_root = std::move(vm_result.state_root);
-    b.header.parent_message_receipts = std::move(vm_result.message_receipts);
-    OUTCOME_TRYA(b.header.messages, ipld->setCbor(msg_meta));
+    MsgMeta msg_meta;
+    OUTCOME_TRYA(msg_meta.bls_messages,
+                 adt::Array<CID>::fromValues(ipld, b.bls_cids));
+    OUTCOME_TRYA(msg_meta.secp_messages,
+                 adt::Array<CID>::fromValues(ipld, b.secp_cids));
+    OUTCOME_TRYA(b.messages, ipld->setCbor(msg_meta));
     OUTCOME_TRYA(
-        b.header.bls_aggregate,
+        b.bls_aggregate,
         crypto::bls::BlsProviderImpl{}.aggregateSignatures(bls_signatures));
-    b.header.timestamp = t.timestamp;
+    return std::move(b);
+  }
+
+  BlockBodyCache::BlockBodyCache(size_t cache_size) : bodies_{cache_size} {}
+
+  outcome::result<std::shared_ptr<const BlockBody>> BlockBodyCache::get(
+      const std::shared_ptr<Ipld> &ipld,
+      const std::vector<SignedMessage> &messages) {
+    OUTCOME_TRY(key, primitives::cid::getCidOfCbor(messages));
+    {
+      std::lock_guard lock{mutex_};
+      if (auto body{bodies_.get(key)}) {
+        return std::move(*body);
+      }
+    }
+    OUTCOME_TRY(_body, assembleBody(ipld, messages));
+    auto body{std::make_shared<const BlockBody>(std::move(_body))};
+    std::lock_guard lock{mutex_};
+    bodies_.put(key, body, 1);
+    return body;
+  }
+
+  outcome::result<BlockHeader> generateHeader(
+      Interpreter &interpreter,
+      WeightCalculator &weight_calculator,
+      std::shared_ptr<Ipld> ipld,
+      const BlockTemplate &t,
+      const BlockBody &body) {
+    OUTCOME_TRY(parent_tipset,
+                primitives::tipset::Tipset::load(*ipld, t.parents));
+    OUTCOME_TRY(vm_result, interpreter.interpret(ipld, parent_tipset));
+    BlockHeader header;
+    header.miner = t.miner;
+    header.ticket = t.ticket;
+    header.election_proof = t.election_proof;
+    header.beacon_entries = t.beacon_entries;
+    header.win_post_proof = t.win_post_proof;
+    header.parents = t.parents;
+    OUTCOME_TRYA(header.parent_weight,
+                 weight_calculator.calculateWeight(*parent_tipset));
+    header.height = t.height;
+    header.parent_state_root = std::move(vm_result.state_root);
+    header.parent_message_receipts = std::move(vm_result.message_receipts);
+    header.messages = body.messages;
+    header.bls_aggregate = body.bls_aggregate;
+    header.timestamp = t.timestamp;
     // TODO: the only caller of "generate" is MinerCreateBlock, it signs block
-    b.header.block_sig = {};
-    b.header.fork_signaling = 0;
-    OUTCOME_TRYA(b.header.parent_base_fee, parent_tipset->nextBaseFee(ipld));
+    header.block_sig = {};
+    header.fork_signaling = 0;
+    OUTCOME_TRYA(header.parent_base_fee, parent_tipset->nextBaseFee(ipld));
+    return std::move(header);
+  }
+
+  outcome::result<BlockWithMessages> generate(Interpreter &interpreter,
+                                              std::shared_ptr<Ipld> ipld,
+                                              BlockTemplate t) {
+    OUTCOME_TRY(body, assembleBody(ipld, t.messages));
+    weight::WeightCalculatorImpl weight_calculator{ipld};
+    BlockWithMessages b;
+    OUTCOME_TRYA(b.header,
+                 generateHeader(interpreter, weight_calculator, ipld, t, body));
+    b.bls_messages = std::move(body.bls_messages);
+    b.secp_messages = std::move(body.secp_messages);
     return std::move(b);
   }
 }  // namespace fc::blockchain::production
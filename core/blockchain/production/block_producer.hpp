@@ -3,15 +3,68 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#pragma once
+
+#include <mutex>
+
+#include "blockchain/weight_calculator.hpp"
+#include "common/lru_cache.hpp"
 #include "vm/interpreter/interpreter.hpp"
 
 namespace fc::blockchain::production {
+  using crypto::signature::Signature;
+  using primitives::block::BlockHeader;
   using primitives::block::BlockTemplate;
   using primitives::block::BlockWithMessages;
   using vm::interpreter::Interpreter;
+  using vm::message::SignedMessage;
+  using vm::message::UnsignedMessage;
+  using weight::WeightCalculator;
 
   constexpr size_t kBlockMaxMessagesCount = 1000;
 
+  /// Stored block messages with msg meta and bls aggregate
+  struct BlockBody {
+    std::vector<UnsignedMessage> bls_messages;
+    std::vector<SignedMessage> secp_messages;
+    std::vector<CID> bls_cids, secp_cids;
+    CID messages;
+    Signature bls_aggregate;
+  };
+
+  /// Store messages, msg meta and aggregate bls signatures
+  outcome::result<BlockBody> assembleBody(
+      const std::shared_ptr<Ipld> &ipld,
+      const std::vector<SignedMessage> &messages);
+
+  /**
+   * Recently assembled bodies by messages. Body is assembled when messages
+   * are selected, so block creation only builds and signs header.
+   */
+  class BlockBodyCache {
+   public:
+    static constexpr size_t kDefaultCacheSize{16};
+
+    explicit BlockBodyCache(size_t cache_size = kDefaultCacheSize);
+
+    /// Body of messages, assembled on first request
+    outcome::result<std::shared_ptr<const BlockBody>> get(
+        const std::shared_ptr<Ipld> &ipld,
+        const std::vector<SignedMessage> &messages);
+
+   private:
+    std::mutex mutex_;
+    common::LruCache<CID, std::shared_ptr<const BlockBody>> bodies_;
+  };
+
+  /// Unsigned header of block with assembled body on top of template parents
+  outcome::result<BlockHeader> generateHeader(
+      Interpreter &interpreter,
+      WeightCalculator &weight_calculator,
+      std::shared_ptr<Ipld> ipld,
+      const BlockTemplate &t,
+      const BlockBody &body);
+
   outcome::result<BlockWithMessages> generate(Interpreter &interpreter,
                                               std::shared_ptr<Ipld> ipld,
                                               BlockTemplate t);
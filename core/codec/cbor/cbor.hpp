@@ -14,6 +14,9 @@
 namespace fc::codec::cbor {
   using common::Buffer;
 
+  /// Larger encode buffers are freed instead of being kept for reuse
+  constexpr size_t kMaxReusedBuffer{1 << 20};
+
   /**
    * @brief CBOR encoding to byte-vector
    * @tparam Type to be encoded
@@ -22,10 +25,17 @@ namespace fc::codec::cbor {
    */
   template <typename T>
   outcome::result<Buffer> encode(const T &arg) {
+    // buffer keeps capacity between calls, result is copied once
+    thread_local std::vector<uint8_t> buffer;
     try {
-      CborEncodeStream encoder;
+      auto encoder{CborEncodeStream::reuse(std::move(buffer))};
       encoder << arg;
-      return Buffer{encoder.data()};
+      buffer = std::move(encoder).data();
+      Buffer result{buffer};
+      if (buffer.capacity() > kMaxReusedBuffer) {
+        buffer = {};
+      }
+      return result;
     } catch (std::system_error &e) {
       return outcome::failure(e.code());
     }
@@ -97,6 +97,37 @@ namespace fc::codec::cbor {
     return stream;
   }
 
+  CborDecodeStream CborDecodeStream::tuple(size_t size) {
+    if (listLength() != size) {
+      outcome::raise(CborDecodeError::kWrongSize);
+    }
+    return container();
+  }
+
+  void CborDecodeStream::endTuple(const CborDecodeStream &tuple) {
+    if (tuple.value_.remaining != 0) {
+      // not all items were read
+      return next();
+    }
+    // same state as after next() over list
+    auto remaining = value_.remaining - 1;
+    value_.ptr = tuple.value_.ptr;
+    if (value_.ptr == parser_->end) {
+      value_.remaining = 0;
+      value_.type = CborInvalidType;
+      return;
+    }
+    if (CborNoError
+        != cbor_parser_init(value_.ptr,
+                            parser_->end - value_.ptr,
+                            0,
+                            parser_.get(),
+                            &value_)) {
+      outcome::raise(CborDecodeError::kInvalidCbor);
+    }
+    value_.remaining = remaining;
+  }
+
   void CborDecodeStream::next() {
     if (isCid()) {
       if (CborNoError != cbor_value_skip_tag(&value_)) {
@@ -213,6 +244,41 @@ namespace fc::codec::cbor {
     return map;
   }
 
+  boost::optional<CborDecodeStream> CborDecodeStream::mapValue(
+      const std::string &key) {
+    if (!cbor_value_is_map(&value_)) {
+      outcome::raise(CborDecodeError::kWrongType);
+    }
+    auto stream = container();
+    next();
+    std::string key2;
+    while (!cbor_value_at_end(&stream.value_)) {
+      stream >> key2;
+      auto begin = stream.value_.ptr;
+      auto stream2 = stream;
+      if (CborNoError != cbor_value_skip_tag(&stream.value_)) {
+        outcome::raise(CborDecodeError::kInvalidCbor);
+      }
+      if (CborNoError != cbor_value_advance(&stream.value_)) {
+        outcome::raise(CborDecodeError::kInvalidCbor);
+      }
+      if (key2 != key) {
+        continue;
+      }
+      stream2.parser_ = std::make_shared<CborParser>();
+      if (CborNoError
+          != cbor_parser_init(begin,
+                              stream.value_.ptr - begin,
+                              0,
+                              stream2.parser_.get(),
+                              &stream2.value_)) {
+        outcome::raise(CborDecodeError::kInvalidCbor);
+      }
+      return stream2;
+    }
+    return boost::none;
+  }
+
   size_t CborDecodeStream::bytesLength() const {
     if (!cbor_value_is_byte_string(&value_)) {
       outcome::raise(CborDecodeError::kWrongType);
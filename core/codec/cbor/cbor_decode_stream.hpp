@@ -10,6 +10,7 @@
 
 #include <vector>
 
+#include <boost/optional.hpp>
 #include <cbor.h>
 #include <gsl/span>
 
@@ -117,6 +118,16 @@ namespace fc::codec::cbor {
     CborDecodeStream &operator>>(CID &cid);
     /** Creates list container decode substream */
     CborDecodeStream list();
+    /**
+     * Creates substream for list of expected size, e.g. tuple fields.
+     * Continue with `endTuple` after reading items.
+     */
+    CborDecodeStream tuple(size_t size);
+    /**
+     * Moves to element after tuple list position reached by substream,
+     * without walking list again
+     */
+    void endTuple(const CborDecodeStream &tuple);
     /** Skips current element */
     void next();
     /** Checks if current element is CID */
@@ -141,6 +152,11 @@ namespace fc::codec::cbor {
     std::vector<uint8_t> raw();
     /** Creates map container decode substream map */
     std::map<std::string, CborDecodeStream> map();
+    /**
+     * Creates substream of map value by key (and advances to the next
+     * element), other values are skipped without substreams
+     */
+    boost::optional<CborDecodeStream> mapValue(const std::string &key);
     static CborDecodeStream &named(std::map<std::string, CborDecodeStream> &map,
                                    const std::string &name);
     /// Returns bytestring length
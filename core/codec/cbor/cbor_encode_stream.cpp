@@ -14,29 +14,15 @@ namespace fc::codec::cbor {
   CborEncodeStream &CborEncodeStream::operator<<(
       gsl::span<const uint8_t> bytes) {
     addCount(1);
-
-    std::vector<uint8_t> encoded(9 + bytes.size());
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, encoded.data(), encoded.size(), 0);
-    cbor_encode_byte_string(&encoder, bytes.data(), bytes.size());
-    data_.insert(data_.end(),
-                 encoded.begin(),
-                 encoded.begin()
-                     + cbor_encoder_get_buffer_size(&encoder, encoded.data()));
+    writeHead(kBytes, bytes.size());
+    append(bytes);
     return *this;
   }
 
   CborEncodeStream &CborEncodeStream::operator<<(const std::string &str) {
     addCount(1);
-
-    std::vector<uint8_t> encoded(9 + str.size());
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, encoded.data(), encoded.size(), 0);
-    cbor_encode_text_string(&encoder, str.data(), str.size());
-    data_.insert(data_.end(),
-                 encoded.begin(),
-                 encoded.begin()
-                     + cbor_encoder_get_buffer_size(&encoder, encoded.data()));
+    writeHead(kText, str.size());
+    append(str);
     return *this;
   }
 
@@ -45,99 +31,69 @@ namespace fc::codec::cbor {
     if (maybe_cid_bytes.has_error()) {
       outcome::raise(CborEncodeError::kInvalidCID);
     }
-    auto cid_bytes = maybe_cid_bytes.value();
-    cid_bytes.insert(cid_bytes.begin(), 0);
-
-    std::array<uint8_t, 9> encoded{0};
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, encoded.data(), encoded.size(), 0);
-    cbor_encode_tag(&encoder, kCidTag);
-    data_.insert(data_.end(),
-                 encoded.begin(),
-                 encoded.begin()
-                     + cbor_encoder_get_buffer_size(&encoder, encoded.data()));
-    *this << cid_bytes;
+    const auto &cid_bytes = maybe_cid_bytes.value();
+
+    addCount(1);
+    writeHead(kTag, kCidTag);
+    // multibase identity prefix
+    writeHead(kBytes, cid_bytes.size() + 1);
+    data_.push_back(0);
+    append(cid_bytes);
     return *this;
   }
 
   CborEncodeStream &CborEncodeStream::operator<<(
       const CborEncodeStream &other) {
     addCount(other.is_list_ ? 1 : other.count_);
-    auto other_data = other.data();
-    data_.insert(data_.end(), other_data.begin(), other_data.end());
+    appendStream(other);
     return *this;
   }
 
-  struct LessCborKey {
-    bool operator()(const std::vector<uint8_t> &lhs,
-                    const std::vector<uint8_t> &rhs) const {
-      ssize_t diff = lhs.size() - rhs.size();
-      if (diff != 0) {
-        return diff < 0;
-      }
-      return std::memcmp(lhs.data(), rhs.data(), lhs.size()) < 0;
-    }
-  };
-
   CborEncodeStream &CborEncodeStream::operator<<(
       const std::map<std::string, CborEncodeStream> &map) {
-    addCount(1);
-
-    std::array<uint8_t, 9> prefix{0};
-    CborEncoder encoder;
-    CborEncoder container;
-    cbor_encoder_init(&encoder, prefix.data(), prefix.size(), 0);
-    cbor_encoder_create_map(&encoder, &container, map.size());
-    data_.insert(data_.end(),
-                 prefix.begin(),
-                 prefix.begin()
-                     + cbor_encoder_get_buffer_size(&container, prefix.data()));
-
-    std::map<std::vector<uint8_t>, std::vector<uint8_t>, LessCborKey> sorted;
     for (const auto &pair : map) {
       if (pair.second.count_ != 1) {
         outcome::raise(CborEncodeError::kExpectedMapValueSingle);
       }
-      sorted.insert(std::make_pair((CborEncodeStream() << pair.first).data(),
-                                   pair.second.data()));
     }
-    for (const auto &pair : sorted) {
-      data_.insert(data_.end(), pair.first.begin(), pair.first.end());
-      data_.insert(data_.end(), pair.second.begin(), pair.second.end());
+    addCount(1);
+    writeHead(kMap, map.size());
+    for (const auto &item : sortedKeys(map)) {
+      writeHead(kText, item->first.size());
+      append(item->first);
+      appendStream(item->second);
     }
-
     return *this;
   }
 
   CborEncodeStream &CborEncodeStream::operator<<(std::nullptr_t) {
     addCount(1);
-
-    std::array<uint8_t, 1> prefix{0};
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, prefix.data(), prefix.size(), 0);
-    cbor_encode_null(&encoder);
-    data_.insert(
-        data_.end(),
-        prefix.begin(),
-        prefix.begin() + cbor_encoder_get_buffer_size(&encoder, prefix.data()));
+    data_.push_back(kNull);
     return *this;
   }
 
-  std::vector<uint8_t> CborEncodeStream::data() const {
+  std::vector<uint8_t> CborEncodeStream::data() const & {
     if (!is_list_) {
       return data_;
     }
-    std::array<uint8_t, 9> prefix{0};
-    CborEncoder encoder;
-    CborEncoder container;
-    cbor_encoder_init(&encoder, prefix.data(), prefix.size(), 0);
-    cbor_encoder_create_array(&encoder, &container, count_);
-    std::vector<uint8_t> result(
-        prefix.begin(),
-        prefix.begin()
-            + cbor_encoder_get_buffer_size(&container, prefix.data()));
-    result.insert(result.end(), data_.begin(), data_.end());
-    return result;
+    CborEncodeStream result;
+    result.data_.reserve(data_.size() + 9);
+    result.appendStream(*this);
+    return std::move(result.data_);
+  }
+
+  std::vector<uint8_t> CborEncodeStream::data() && {
+    if (!is_list_) {
+      return std::move(data_);
+    }
+    return data();
+  }
+
+  CborEncodeStream &CborEncodeStream::beginList(size_t size) {
+    addCount(1);
+    writeHead(kArray, size);
+    skip_ += size;
+    return *this;
   }
 
   CborEncodeStream CborEncodeStream::list() {
@@ -153,12 +109,31 @@ namespace fc::codec::cbor {
   CborEncodeStream CborEncodeStream::wrap(gsl::span<const uint8_t> data,
                                           size_t count) {
     CborEncodeStream s;
-    s.data_.assign(data.begin(), data.end());
+    s.append(data);
     s.count_ = count;
     return s;
   }
 
+  CborEncodeStream CborEncodeStream::reuse(std::vector<uint8_t> buffer) {
+    CborEncodeStream s;
+    s.data_ = std::move(buffer);
+    s.data_.clear();
+    return s;
+  }
+
+  void CborEncodeStream::appendStream(const CborEncodeStream &other) {
+    if (other.is_list_) {
+      writeHead(kArray, other.count_);
+    }
+    append(other.data_);
+  }
+
   void CborEncodeStream::addCount(size_t count) {
+    if (skip_ != 0) {
+      auto skip{std::min(skip_, count)};
+      skip_ -= skip;
+      count -= skip;
+    }
     count_ += count;
   }
 }  // namespace fc::codec::cbor
@@ -8,11 +8,10 @@
 
 #include "codec/cbor/cbor_common.hpp"
 
+#include <algorithm>
 #include <array>
 #include <vector>
 
-#include <cbor.h>
-
 #include "common/enum.hpp"
 
 namespace fc::codec::cbor {
@@ -28,23 +27,19 @@ namespace fc::codec::cbor {
     CborEncodeStream &operator<<(T num) {
       if constexpr (std::is_enum_v<T>) {
         return *this << common::to_int(num);
-      }
-      addCount(1);
-      std::array<uint8_t, 9> buffer{0};
-      CborEncoder encoder;
-      cbor_encoder_init(&encoder, buffer.data(), buffer.size(), 0);
-      if constexpr (std::is_same_v<T, bool>) {
-        cbor_encode_boolean(&encoder, num);
-      } else if constexpr (std::is_unsigned_v<T>) {
-        cbor_encode_uint(&encoder, static_cast<uint64_t>(num));
       } else {
-        cbor_encode_int(&encoder, static_cast<int64_t>(num));
+        addCount(1);
+        if constexpr (std::is_same_v<T, bool>) {
+          data_.push_back(num ? kTrue : kFalse);
+        } else if constexpr (std::is_unsigned_v<T>) {
+          writeHead(kUnsigned, static_cast<uint64_t>(num));
+        } else if (num < 0) {
+          writeHead(kNegative, ~static_cast<uint64_t>(num));
+        } else {
+          writeHead(kUnsigned, static_cast<uint64_t>(num));
+        }
+        return *this;
       }
-      data_.insert(data_.end(),
-                   buffer.begin(),
-                   buffer.begin()
-                       + cbor_encoder_get_buffer_size(&encoder, buffer.data()));
-      return *this;
     }
 
     /// Encodes nullable optional value
@@ -61,21 +56,25 @@ namespace fc::codec::cbor {
     /// Encodes elements into list
     template <typename T>
     CborEncodeStream &operator<<(const gsl::span<T> &values) {
-      auto l = list();
+      beginList(values.size());
       for (auto &value : values) {
-        l << value;
+        *this << value;
       }
-      return *this << l;
+      return *this;
     }
 
     /// Encodes elements into map
     template <typename T>
     CborEncodeStream &operator<<(const std::map<std::string, T> &items) {
-      auto m = map();
-      for (auto &item : items) {
-        m[item.first] << item.second;
+      addCount(1);
+      writeHead(kMap, items.size());
+      skip_ += items.size();
+      for (auto &item : sortedKeys(items)) {
+        writeHead(kText, item->first.size());
+        append(item->first);
+        *this << item->second;
       }
-      return *this << m;
+      return *this;
     }
 
     /// Encodes vector into list
@@ -106,7 +105,15 @@ namespace fc::codec::cbor {
     /** Encodes null */
     CborEncodeStream &operator<<(std::nullptr_t);
     /** Returns CBOR bytes of encoded elements */
-    std::vector<uint8_t> data() const;
+    std::vector<uint8_t> data() const &;
+    /** Returns CBOR bytes of encoded elements without copying */
+    std::vector<uint8_t> data() &&;
+    /**
+     * Writes list header in place, next `size` encoded elements are items of
+     * list instead of elements of this stream. Used when size is known
+     * beforehand, e.g. for tuples, to avoid substream.
+     */
+    CborEncodeStream &beginList(size_t size);
     /** Creates list container encode substream */
     static CborEncodeStream list();
     /** Creates map container encode substream map */
@@ -114,12 +121,80 @@ namespace fc::codec::cbor {
     /** Wraps CBOR bytes */
     static CborEncodeStream wrap(gsl::span<const uint8_t> data, size_t count);
 
+    /**
+     * Creates stream writing to buffer, which is cleared, but keeps capacity.
+     * Buffer may be reused with `std::move(stream).data()`.
+     */
+    static CborEncodeStream reuse(std::vector<uint8_t> buffer);
+
    private:
+    static constexpr uint8_t kUnsigned{0};
+    static constexpr uint8_t kNegative{1};
+    static constexpr uint8_t kBytes{2};
+    static constexpr uint8_t kText{3};
+    static constexpr uint8_t kArray{4};
+    static constexpr uint8_t kMap{5};
+    static constexpr uint8_t kTag{6};
+    static constexpr uint8_t kFalse{0xF4};
+    static constexpr uint8_t kTrue{0xF5};
+    static constexpr uint8_t kNull{0xF6};
+
+    /// Writes major type with shortest argument encoding
+    void writeHead(uint8_t type, uint64_t value) {
+      type <<= 5;
+      if (value < 24) {
+        data_.push_back(type | value);
+      } else if (value <= 0xFF) {
+        data_.push_back(type | 24);
+        data_.push_back(value);
+      } else if (value <= 0xFFFF) {
+        writeBig(type | 25, value, 2);
+      } else if (value <= 0xFFFFFFFF) {
+        writeBig(type | 26, value, 4);
+      } else {
+        writeBig(type | 27, value, 8);
+      }
+    }
+
+    void writeBig(uint8_t head, uint64_t value, size_t size) {
+      data_.push_back(head);
+      for (auto i{size}; i != 0; --i) {
+        data_.push_back(value >> ((i - 1) * 8));
+      }
+    }
+
+    template <typename Bytes>
+    void append(const Bytes &bytes) {
+      auto begin{reinterpret_cast<const uint8_t *>(bytes.data())};
+      data_.insert(data_.end(), begin, begin + bytes.size());
+    }
+
+    /// Appends other stream, writing its list header if needed
+    void appendStream(const CborEncodeStream &other);
+
+    /// Map keys in canonical order, shorter first
+    template <typename T>
+    static auto sortedKeys(const std::map<std::string, T> &items) {
+      using It = typename std::map<std::string, T>::const_iterator;
+      std::vector<It> sorted;
+      sorted.reserve(items.size());
+      for (auto it{items.begin()}; it != items.end(); ++it) {
+        sorted.push_back(it);
+      }
+      // std::map is ordered by bytes, stable sort by size is canonical order
+      std::stable_sort(sorted.begin(), sorted.end(), [](auto &l, auto &r) {
+        return l->first.size() < r->first.size();
+      });
+      return sorted;
+    }
+
     void addCount(size_t count);
 
     bool is_list_{false};
     std::vector<uint8_t> data_{};
     size_t count_{0};
+    /// Elements already counted by list or map header written in place
+    size_t skip_{0};
   };
 }  // namespace fc::codec::cbor
 
@@ -54,12 +54,11 @@ namespace fc::codec::cbor {
           stream.next();
         }
       } else if (stream.isMap()) {
-        auto map = stream.map();
-        auto it = map.find(part);
-        if (it == map.end()) {
+        auto value = stream.mapValue(part);
+        if (!value) {
           return CborResolveError::kKeyNotFound;
         }
-        stream = std::move(it->second);
+        stream = std::move(*value);
       } else {
         return CborResolveError::kContainerExpected;
       }
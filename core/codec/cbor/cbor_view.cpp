@@ -0,0 +1,193 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "codec/cbor/cbor_view.hpp"
+
+namespace fc::codec::cbor {
+  namespace {
+    constexpr uint8_t kUnsigned{0};
+    constexpr uint8_t kNegative{1};
+    constexpr uint8_t kBytes{2};
+    constexpr uint8_t kText{3};
+    constexpr uint8_t kArray{4};
+    constexpr uint8_t kMap{5};
+    constexpr uint8_t kTag{6};
+    constexpr uint8_t kSimple{7};
+    constexpr uint8_t kFalse{20};
+    constexpr uint8_t kTrue{21};
+    constexpr uint8_t kNull{22};
+
+    struct Head {
+      uint8_t type;
+      uint64_t value;
+      size_t size;
+    };
+
+    /// Reads major type and argument, indefinite lengths are not supported
+    outcome::result<Head> readHead(CborView::BytesIn input) {
+      if (input.empty()) {
+        return CborDecodeError::kInvalidCbor;
+      }
+      Head head{static_cast<uint8_t>(input[0] >> 5), input[0] & 0x1Fu, 1};
+      if (head.value < 24) {
+        return head;
+      }
+      if (head.value > 27) {
+        return CborDecodeError::kInvalidCbor;
+      }
+      size_t bytes{size_t{1} << (head.value - 24)};
+      if (static_cast<size_t>(input.size()) < 1 + bytes) {
+        return CborDecodeError::kInvalidCbor;
+      }
+      head.value = 0;
+      for (size_t i{1}; i <= bytes; ++i) {
+        head.value = (head.value << 8) | input[i];
+      }
+      head.size += bytes;
+      return head;
+    }
+
+    /// Returns size of first item, nested items are walked without recursion
+    outcome::result<size_t> itemSize(CborView::BytesIn input) {
+      size_t offset{0};
+      uint64_t pending{1};
+      while (pending != 0) {
+        --pending;
+        OUTCOME_TRY(head, readHead(input.subspan(offset)));
+        offset += head.size;
+        auto left{static_cast<uint64_t>(input.size() - offset)};
+        switch (head.type) {
+          case kBytes:
+          case kText:
+            if (head.value > left) {
+              return CborDecodeError::kInvalidCbor;
+            }
+            offset += head.value;
+            break;
+          case kArray:
+          case kMap:
+            // every item takes at least one byte
+            if (head.value > left) {
+              return CborDecodeError::kInvalidCbor;
+            }
+            pending += head.type == kMap ? 2 * head.value : head.value;
+            if (pending > left) {
+              return CborDecodeError::kInvalidCbor;
+            }
+            break;
+          case kTag:
+            ++pending;
+            break;
+          default:
+            break;
+        }
+      }
+      return offset;
+    }
+  }  // namespace
+
+  outcome::result<CborView> CborView::make(BytesIn input) {
+    OUTCOME_TRY(size, itemSize(input));
+    if (size != static_cast<size_t>(input.size())) {
+      return CborDecodeError::kInvalidCbor;
+    }
+    OUTCOME_TRY(head, readHead(input));
+    CborView view;
+    view.raw_ = input;
+    view.type_ = head.type;
+    view.value_ = head.value;
+    view.head_size_ = head.size;
+    if (view.type_ == kArray) {
+      view.items_.reserve(view.value_);
+      auto rest{input.subspan(head.size)};
+      for (uint64_t i{0}; i < view.value_; ++i) {
+        OUTCOME_TRY(item_size, itemSize(rest));
+        view.items_.push_back(rest.first(item_size));
+        rest = rest.subspan(item_size);
+      }
+    }
+    return std::move(view);
+  }
+
+  bool CborView::isList() const {
+    return type_ == kArray;
+  }
+
+  bool CborView::isNull() const {
+    return type_ == kSimple && value_ == kNull;
+  }
+
+  outcome::result<CborView> CborView::at(size_t index) const {
+    if (index >= items_.size()) {
+      return CborDecodeError::kWrongSize;
+    }
+    return make(items_[index]);
+  }
+
+  outcome::result<bool> CborView::asBool() const {
+    if (type_ != kSimple || (value_ != kFalse && value_ != kTrue)) {
+      return CborDecodeError::kWrongType;
+    }
+    return value_ == kTrue;
+  }
+
+  outcome::result<uint64_t> CborView::asUint() const {
+    if (type_ == kNegative) {
+      return CborDecodeError::kIntOverflow;
+    }
+    if (type_ != kUnsigned) {
+      return CborDecodeError::kWrongType;
+    }
+    return value_;
+  }
+
+  outcome::result<int64_t> CborView::asInt() const {
+    if (type_ != kUnsigned && type_ != kNegative) {
+      return CborDecodeError::kWrongType;
+    }
+    if (value_ > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+      return CborDecodeError::kIntOverflow;
+    }
+    auto value{static_cast<int64_t>(value_)};
+    return type_ == kNegative ? -1 - value : value;
+  }
+
+  outcome::result<CborView::BytesIn> CborView::asBytes() const {
+    if (type_ != kBytes) {
+      return CborDecodeError::kWrongType;
+    }
+    return raw_.subspan(head_size_);
+  }
+
+  outcome::result<std::string_view> CborView::asStr() const {
+    if (type_ != kText) {
+      return CborDecodeError::kWrongType;
+    }
+    auto str{raw_.subspan(head_size_)};
+    return std::string_view{reinterpret_cast<const char *>(str.data()),
+                            static_cast<size_t>(str.size())};
+  }
+
+  outcome::result<CborView::BytesIn> CborView::asCidBytes() const {
+    if (type_ != kTag || value_ != kCidTag) {
+      return CborDecodeError::kInvalidCborCID;
+    }
+    auto bytes{raw_.subspan(head_size_)};
+    OUTCOME_TRY(head, readHead(bytes));
+    if (head.type != kBytes || head.value < 1 || bytes[head.size] != 0) {
+      return CborDecodeError::kInvalidCborCID;
+    }
+    return bytes.subspan(head.size + 1);
+  }
+
+  outcome::result<CID> CborView::asCid() const {
+    OUTCOME_TRY(bytes, asCidBytes());
+    auto cid{CID::fromBytes(bytes)};
+    if (!cid) {
+      return CborDecodeError::kInvalidCID;
+    }
+    return std::move(cid.value());
+  }
+}  // namespace fc::codec::cbor
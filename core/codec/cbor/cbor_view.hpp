@@ -0,0 +1,70 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include <gsl/span>
+
+#include "codec/cbor/cbor.hpp"
+
+namespace fc::codec::cbor {
+  /**
+   * Borrowed view of one encoded CBOR item. List items are indexed once by
+   * `make`, fields are decoded on demand. Bytes, strings and CIDs point into
+   * source buffer, which must outlive view.
+   */
+  class CborView {
+   public:
+    using BytesIn = gsl::span<const uint8_t>;
+
+    /// Checks that input is exactly one well-formed item, indexes list items
+    static outcome::result<CborView> make(BytesIn input);
+
+    /// Encoded bytes of item
+    BytesIn raw() const {
+      return raw_;
+    }
+
+    bool isList() const;
+    bool isNull() const;
+
+    /// Count of list items, zero if not list
+    size_t size() const {
+      return items_.size();
+    }
+
+    /// View of list item
+    outcome::result<CborView> at(size_t index) const;
+
+    outcome::result<bool> asBool() const;
+    outcome::result<uint64_t> asUint() const;
+    outcome::result<int64_t> asInt() const;
+    /// Borrowed bytestring content
+    outcome::result<BytesIn> asBytes() const;
+    /// Borrowed text string content
+    outcome::result<std::string_view> asStr() const;
+    /// Borrowed CID bytes, without multibase prefix
+    outcome::result<BytesIn> asCidBytes() const;
+    outcome::result<CID> asCid() const;
+
+    /// Decodes item to object
+    template <typename T>
+    outcome::result<T> decode() const {
+      return cbor::decode<T>(raw_);
+    }
+
+   private:
+    CborView() = default;
+
+    BytesIn raw_;
+    uint8_t type_{};
+    uint64_t value_{};
+    size_t head_size_{};
+    std::vector<BytesIn> items_;
+  };
+}  // namespace fc::codec::cbor
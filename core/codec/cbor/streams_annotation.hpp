@@ -114,26 +114,56 @@
                 _CBOR_TUPLE_1)  \
   (op, __VA_ARGS__)
 
-#define CBOR_ENCODE_TUPLE(T, ...)                        \
-  CBOR_ENCODE(T, t) {                                    \
-    return s << (s.list() _CBOR_TUPLE(<<, __VA_ARGS__)); \
+/// Number of tuple members, known at compile time
+#define _CBOR_TUPLE_SIZE(...) \
+  _CBOR_TUPLE_V(__VA_ARGS__,  \
+                20,           \
+                19,           \
+                18,           \
+                17,           \
+                16,           \
+                15,           \
+                14,           \
+                13,           \
+                12,           \
+                11,           \
+                10,           \
+                9,            \
+                8,            \
+                7,            \
+                6,            \
+                5,            \
+                4,            \
+                3,            \
+                2,            \
+                1)
+
+/// Writes list header in place and members after it, without substream
+#define CBOR_ENCODE_TUPLE(T, ...)              \
+  CBOR_ENCODE(T, t) {                          \
+    s.beginList(_CBOR_TUPLE_SIZE(__VA_ARGS__)) \
+        _CBOR_TUPLE(<<, __VA_ARGS__);          \
+    return s;                                  \
   }
 
-#define CBOR_TUPLE(T, ...)                 \
-  CBOR_ENCODE_TUPLE(T, __VA_ARGS__)        \
-  CBOR_DECODE(T, t) {                      \
-    s.list() _CBOR_TUPLE(>>, __VA_ARGS__); \
-    return s;                              \
+/// Checks list size and reads members in single pass
+#define CBOR_TUPLE(T, ...)                          \
+  CBOR_ENCODE_TUPLE(T, __VA_ARGS__)                 \
+  CBOR_DECODE(T, t) {                               \
+    auto l{s.tuple(_CBOR_TUPLE_SIZE(__VA_ARGS__))}; \
+    l _CBOR_TUPLE(>>, __VA_ARGS__);                 \
+    s.endTuple(l);                                  \
+    return s;                                       \
   }
 
-#define CBOR_TUPLE_0(T) \
-  CBOR_ENCODE(T, t) {   \
-    s << s.list();      \
-    return s;           \
-  }                     \
-  CBOR_DECODE(T, t) {   \
-    s.list();           \
-    return s;           \
+#define CBOR_TUPLE_0(T)     \
+  CBOR_ENCODE(T, t) {       \
+    s.beginList(0);         \
+    return s;               \
+  }                         \
+  CBOR_DECODE(T, t) {       \
+    s.endTuple(s.tuple(0)); \
+    return s;               \
   }
 
 namespace fc::codec::cbor {
@@ -9,11 +9,15 @@
 #include <rapidjson/writer.h>
 #include <cppcodec/base64_rfc4648.hpp>
 
+#include "codec/cbor/cbor_decode_stream.hpp"
+#include "codec/cbor/cbor_encode_stream.hpp"
 #include "common/span.hpp"
 
 namespace fc::codec::json {
+  using cbor::CborDecodeError;
+  using cbor::CborDecodeStream;
+  using cbor::CborEncodeStream;
   using rapidjson::ParseFlag;
-  using rapidjson::StringBuffer;
   using base64 = cppcodec::base64_rfc4648;
 
   Outcome<Document> parse(std::string_view input) {
@@ -30,20 +34,133 @@ namespace fc::codec::json {
     return parse(common::span::bytestr(input));
   }
 
+  Outcome<Document> parseInsitu(char *input) {
+    Document doc;
+    doc.ParseInsitu<ParseFlag::kParseNumbersAsStringsFlag>(input);
+    if (doc.HasParseError()) {
+      return {};
+    }
+    return std::move(doc);
+  }
+
   Outcome<Buffer> format(JIn j) {
-    StringBuffer buffer;
-    rapidjson::Writer<StringBuffer> writer{buffer};
-    if (j->Accept(writer)) {
-      std::string_view s{buffer.GetString(), buffer.GetSize()};
-      return Buffer{common::span::cbytes(s)};
+    Buffer buffer;
+    if (formatTo(j, buffer)) {
+      return std::move(buffer);
     }
     return {};
   }
 
+  bool formatTo(JIn j, Buffer &out) {
+    BufferStream stream{out};
+    rapidjson::Writer<BufferStream> writer{stream};
+    return j->Accept(writer);
+  }
+
   Outcome<Buffer> format(Document &&doc) {
     return format(&doc);
   }
 
+  void encodeCbor(CborEncodeStream &s, const Value &j) {
+    if (j.IsNull()) {
+      s << nullptr;
+    } else if (j.IsBool()) {
+      s << j.GetBool();
+    } else if (j.IsUint64()) {
+      s << j.GetUint64();
+    } else if (j.IsInt64()) {
+      s << j.GetInt64();
+    } else if (j.IsNumber()) {
+      s << std::to_string(j.GetDouble());
+    } else if (j.IsString()) {
+      s << std::string{j.GetString(), j.GetStringLength()};
+    } else if (j.IsArray()) {
+      auto l{CborEncodeStream::list()};
+      for (auto it{j.Begin()}; it != j.End(); ++it) {
+        encodeCbor(l, *it);
+      }
+      s << l;
+    } else {
+      auto m{CborEncodeStream::map()};
+      for (auto it{j.MemberBegin()}; it != j.MemberEnd(); ++it) {
+        encodeCbor(
+            m[std::string{it->name.GetString(), it->name.GetStringLength()}],
+            it->value);
+      }
+      s << m;
+    }
+  }
+
+  Value decodeCbor(CborDecodeStream &s,
+                   rapidjson::MemoryPoolAllocator<> &allocator) {
+    if (s.isNull()) {
+      s.next();
+      return {};
+    }
+    if (s.isBool()) {
+      bool v;
+      s >> v;
+      return Value{v};
+    }
+    if (s.isInt()) {
+      try {
+        uint64_t v;
+        s >> v;
+        return Value{v};
+      } catch (std::system_error &) {
+        int64_t v;
+        s >> v;
+        return Value{v};
+      }
+    }
+    if (s.isStr()) {
+      std::string v;
+      s >> v;
+      return Value{
+          v.data(), static_cast<rapidjson::SizeType>(v.size()), allocator};
+    }
+    if (s.isList()) {
+      auto n{s.listLength()};
+      auto l{s.list()};
+      Value j{rapidjson::kArrayType};
+      j.Reserve(n, allocator);
+      for (auto i{0u}; i < n; ++i) {
+        j.PushBack(decodeCbor(l, allocator), allocator);
+      }
+      return j;
+    }
+    if (s.isMap()) {
+      Value j{rapidjson::kObjectType};
+      for (auto &[key, value] : s.map()) {
+        j.AddMember(
+            Value{key.data(),
+                  static_cast<rapidjson::SizeType>(key.size()),
+                  allocator},
+            decodeCbor(value, allocator),
+            allocator);
+      }
+      return j;
+    }
+    outcome::raise(CborDecodeError::kWrongType);
+  }
+
+  Outcome<Buffer> toCbor(JIn j) {
+    CborEncodeStream s;
+    encodeCbor(s, *j);
+    return Buffer{s.data()};
+  }
+
+  Outcome<Document> fromCbor(BytesIn input) {
+    try {
+      Document doc;
+      CborDecodeStream s{input};
+      static_cast<Value &>(doc) = decodeCbor(s, doc.GetAllocator());
+      return std::move(doc);
+    } catch (std::system_error &) {
+      return {};
+    }
+  }
+
   Outcome<JIn> jGet(JIn j, std::string_view key) {
     if (j->IsObject()) {
       auto it{j->FindMember(key.data())};
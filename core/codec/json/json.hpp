@@ -22,8 +22,37 @@ namespace fc::codec::json {
 
   Outcome<Document> parse(BytesIn input);
 
+  /**
+   * Parse null terminated input in place without copying strings.
+   * Strings of document point into input, so input must outlive document and
+   * values copied from it (see `copyConstStrings` argument of Value copy).
+   */
+  Outcome<Document> parseInsitu(char *input);
+
+  /// rapidjson output stream appending to buffer, so buffer can be reused
+  struct BufferStream {
+    using Ch = char;
+
+    void Put(Ch c) {
+      buffer.putUint8(static_cast<uint8_t>(c));
+    }
+    void Flush() {}
+
+    Buffer &buffer;
+  };
+
   Outcome<Buffer> format(JIn j);
   Outcome<Buffer> format(Document &&doc);
+  /// Append formatted json to buffer without intermediate string
+  bool formatTo(JIn j, Buffer &out);
+
+  /**
+   * Encode json as cbor, for binary rpc frames.
+   * Objects become maps, numbers which are not integers become strings.
+   */
+  Outcome<Buffer> toCbor(JIn j);
+  /// Decode json encoded by toCbor
+  Outcome<Document> fromCbor(BytesIn input);
 
   Outcome<JIn> jGet(JIn j, std::string_view key);
 
@@ -9,6 +9,7 @@
 #include "codec/rle/rle_plus_decoding_stream.hpp"
 #include "codec/rle/rle_plus_encoding_stream.hpp"
 #include "codec/rle/rle_plus_errors.hpp"
+#include "codec/rle/rle_plus_runs.hpp"
 #include "common/outcome.hpp"
 
 namespace fc::codec::rle {
@@ -53,6 +54,39 @@ namespace fc::codec::rle {
     }
     return data;
   }
+  /**
+   * @brief RLE+ encode run lengths
+   * @param runs - alternating unset and set run lengths, see toRuns
+   * @return Encoded byte-vector
+   */
+  inline std::vector<uint8_t> encodeRuns(const Runs64 &runs) {
+    RunsWriter writer;
+    for (auto run : runs) {
+      writer.push(run);
+    }
+    return std::move(writer).data();
+  }
+
+  /**
+   * @brief RLE+ decode run lengths, limits count of runs instead of integers
+   * @param input - data to decode
+   * @return Alternating unset and set run lengths, see toRuns
+   */
+  inline outcome::result<Runs64> decodeRuns(gsl::span<const uint8_t> input) {
+    Runs64 runs;
+    OUTCOME_TRY(reader, RunsReader::make(input));
+    while (true) {
+      OUTCOME_TRY(run, reader.next());
+      if (!run) {
+        break;
+      }
+      if (runs.size() == OBJECT_MAX_SIZE / sizeof(uint64_t)) {
+        return RLEPlusDecodeError::kMaxSizeExceed;
+      }
+      runs.push_back(*run);
+    }
+    return runs;
+  }
 };  // namespace fc::codec::rle
 
 #endif
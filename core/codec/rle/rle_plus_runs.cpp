@@ -0,0 +1,138 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "codec/rle/rle_plus_runs.hpp"
+
+#include <cstring>
+
+#include <boost/endian/conversion.hpp>
+
+#include "codec/rle/rle_plus_config.hpp"
+
+namespace fc::codec::rle {
+  RunsReader::RunsReader(gsl::span<const uint8_t> input) : input_{input} {
+    auto bytes{static_cast<size_t>(input_.size())};
+    while (bytes != 0 && input_[bytes - 1] == 0) {
+      --bytes;
+    }
+    if (bytes != 0) {
+      end_ = bytes * 8 - __builtin_clz(input_[bytes - 1]) + 24;
+    }
+  }
+
+  outcome::result<RunsReader> RunsReader::make(
+      gsl::span<const uint8_t> input) {
+    RunsReader reader{input};
+    if (input.empty()) {
+      return reader;
+    }
+    if (input.size() * 8 < SMALL_BLOCK_LENGTH || reader.read(2) != 0) {
+      return RLEPlusDecodeError::kVersionMismatch;
+    }
+    return reader;
+  }
+
+  outcome::result<boost::optional<uint64_t>> RunsReader::next() {
+    if (input_.empty()) {
+      return boost::none;
+    }
+    if (first_) {
+      first_ = false;
+      // first set run starts at zero
+      if (read(1) == 1) {
+        return 0;
+      }
+    }
+    if (bit_ >= end_) {
+      return boost::none;
+    }
+    if (read(1) == 1) {
+      return 1;
+    }
+    if (read(1) == 1) {
+      return read(SMALL_BLOCK_LENGTH);
+    }
+    uint64_t value{};
+    size_t shift{};
+    while (true) {
+      if (shift > 64) {
+        return RLEPlusDecodeError::kUnpackOverflow;
+      }
+      auto byte{read(BYTE_BITS_COUNT)};
+      if (byte < BYTE_SLICE_VALUE) {
+        return value | (byte << shift);
+      }
+      value |= (byte & UNPACK_BYTE_MASK) << shift;
+      shift += PACK_BYTE_SHIFT;
+    }
+  }
+
+  uint64_t RunsReader::read(size_t count) {
+    auto byte{bit_ / 8};
+    auto shift{bit_ % 8};
+    bit_ += count;
+    auto size{static_cast<size_t>(input_.size())};
+    uint64_t word;
+    if (byte + 8 <= size) {
+      std::memcpy(&word, input_.data() + byte, sizeof(word));
+      word = boost::endian::little_to_native(word);
+    } else {
+      word = 0;
+      for (size_t i{0}; byte + i < size; ++i) {
+        word |= uint64_t{input_[byte + i]} << (8 * i);
+      }
+    }
+    // callers read at most 8 bits, so shift + count < 64
+    return (word >> shift) & ((uint64_t{1} << count) - 1);
+  }
+
+  RunsWriter::RunsWriter() {
+    // version
+    write(0, 2);
+  }
+
+  void RunsWriter::push(uint64_t run) {
+    if (runs_++ == 0) {
+      write(run == 0 ? 1 : 0, 1);
+      if (run == 0) {
+        return;
+      }
+    }
+    if (run == 1) {
+      write(1, 1);
+    } else if (run < LONG_BLOCK_VALUE) {
+      write(0b10 | (run << 2), 2 + SMALL_BLOCK_LENGTH);
+    } else {
+      write(0b00, 2);
+      while (run >= BYTE_SLICE_VALUE) {
+        write((run & UNPACK_BYTE_MASK) | BYTE_SLICE_VALUE, BYTE_BITS_COUNT);
+        run >>= PACK_BYTE_SHIFT;
+      }
+      write(run, BYTE_BITS_COUNT);
+    }
+  }
+
+  std::vector<uint8_t> RunsWriter::data() && {
+    if (runs_ == 0) {
+      return {};
+    }
+    while (acc_bits_ > 0) {
+      bytes_.push_back(acc_);
+      acc_ >>= 8;
+      acc_bits_ = acc_bits_ > 8 ? acc_bits_ - 8 : 0;
+    }
+    return std::move(bytes_);
+  }
+
+  void RunsWriter::write(uint64_t bits, size_t count) {
+    acc_ |= bits << acc_bits_;
+    acc_bits_ += count;
+    while (acc_bits_ >= 8) {
+      bytes_.push_back(acc_);
+      acc_ >>= 8;
+      acc_bits_ -= 8;
+    }
+  }
+}  // namespace fc::codec::rle
@@ -0,0 +1,62 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <gsl/span>
+
+#include "codec/rle/rle_plus_errors.hpp"
+
+namespace fc::codec::rle {
+  /**
+   * Reads RLE+ run lengths straight from encoded bytes, up to 64 bits at
+   * once, without buffers. Runs alternate unset and set, first run is unset
+   * and may be empty, see toRuns.
+   */
+  class RunsReader {
+   public:
+    /// Checks header, empty input has no runs
+    static outcome::result<RunsReader> make(gsl::span<const uint8_t> input);
+
+    /// Returns next run length, or none after last run
+    outcome::result<boost::optional<uint64_t>> next();
+
+   private:
+    explicit RunsReader(gsl::span<const uint8_t> input);
+
+    /// Returns next `count` bits, bits after input are zeros
+    uint64_t read(size_t count);
+
+    gsl::span<const uint8_t> input_;
+    /// Bit position
+    size_t bit_{};
+    /// Bits after last set bit are padding
+    size_t end_{};
+    bool first_{true};
+  };
+
+  /// Writes RLE+ run lengths, up to 64 bits at once
+  class RunsWriter {
+   public:
+    RunsWriter();
+
+    /// Appends run length, runs alternate unset and set starting with unset
+    void push(uint64_t run);
+
+    /// Encoded bytes, empty if there were no set runs
+    std::vector<uint8_t> data() &&;
+
+   private:
+    void write(uint64_t bits, size_t count);
+
+    std::vector<uint8_t> bytes_;
+    uint64_t acc_{};
+    size_t acc_bits_{};
+    size_t runs_{};
+  };
+}  // namespace fc::codec::rle
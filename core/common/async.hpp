@@ -6,6 +6,8 @@
 #pragma once
 
 #include <atomic>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
 #include <memory>
 
 #include "common/outcome.hpp"
@@ -42,4 +44,41 @@ namespace fc {
     std::vector<T> values;
     Cb cb;
   };
+
+  /**
+   * Wraps callback of async operation, so it is called once: with result of
+   * operation, or with std::errc::timed_out if operation didn't finish in
+   * timeout. Late result is dropped. Operation must complete on io thread.
+   */
+  template <typename T>
+  CbT<T> withTimeout(boost::asio::io_context &io,
+                     std::chrono::milliseconds timeout,
+                     CbT<T> cb) {
+    struct State {
+      State(boost::asio::io_context &io, CbT<T> cb)
+          : timer{io}, cb{std::move(cb)} {}
+
+      void done(outcome::result<T> result) {
+        if (cb) {
+          auto _cb{std::move(cb)};
+          cb = nullptr;
+          _cb(std::move(result));
+        }
+      }
+
+      boost::asio::steady_timer timer;
+      CbT<T> cb;
+    };
+    auto state{std::make_shared<State>(io, std::move(cb))};
+    state->timer.expires_after(timeout);
+    state->timer.async_wait([state](auto ec) {
+      if (!ec) {
+        state->done(std::errc::timed_out);
+      }
+    });
+    return [state](outcome::result<T> result) {
+      state->timer.cancel();
+      state->done(std::move(result));
+    };
+  }
 }  // namespace fc
@@ -11,22 +11,11 @@
 namespace fc::common {
   inline uint64_t countTrailingZeros(uint64_t n) {
     if (n == 0) return 64;
-
-    unsigned int count = 0;
-    while ((n & 1) == 0) {
-      count += 1;
-      n >>= 1;
-    }
-    return count;
+    return __builtin_ctzll(n);
   }
 
   inline uint64_t countSetBits(uint64_t n) {
-    unsigned int count = 0;
-    while (n != 0) {
-      count += n & 1;
-      n >>= 1;
-    }
-    return count;
+    return __builtin_popcountll(n);
   }
 
 }  // namespace fc::common
@@ -0,0 +1,64 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <gsl/span>
+
+namespace fc::common {
+  /**
+   * Set of byte keys which may answer "maybe" for absent key, but never
+   * answers "no" for inserted key. Uses ~bits_per_key bits per key, false
+   * positive rate is ~1% for 10 bits per key.
+   * Not thread-safe, callers must synchronize.
+   */
+  class BloomFilter {
+   public:
+    BloomFilter(size_t keys, size_t bits_per_key)
+        : hashes_{std::clamp<size_t>(bits_per_key * 69 / 100, 1, 30)},
+          bits_((std::max<size_t>(keys, 1) * bits_per_key + 63) / 64) {}
+
+    void insert(gsl::span<const uint8_t> key) {
+      auto [h1, h2]{hash(key)};
+      for (size_t i{0}; i < hashes_; ++i, h1 += h2) {
+        auto bit{h1 % (bits_.size() * 64)};
+        bits_[bit / 64] |= uint64_t{1} << (bit % 64);
+      }
+    }
+
+    bool mayContain(gsl::span<const uint8_t> key) const {
+      auto [h1, h2]{hash(key)};
+      for (size_t i{0}; i < hashes_; ++i, h1 += h2) {
+        auto bit{h1 % (bits_.size() * 64)};
+        if ((bits_[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+   private:
+    /// Two independent hashes, other are derived by double hashing
+    static std::pair<uint64_t, uint64_t> hash(gsl::span<const uint8_t> key) {
+      // FNV-1a
+      uint64_t h{0xcbf29ce484222325};
+      for (auto byte : key) {
+        h = (h ^ byte) * 0x100000001b3;
+      }
+      // murmur3 finalizer
+      auto h2{h};
+      h2 = (h2 ^ (h2 >> 33)) * 0xff51afd7ed558ccd;
+      h2 = (h2 ^ (h2 >> 33)) * 0xc4ceb9fe1a85ec53;
+      h2 ^= h2 >> 33;
+      return {h, h2 | 1};
+    }
+
+    size_t hashes_;
+    std::vector<uint64_t> bits_;
+  };
+}  // namespace fc::common
@@ -0,0 +1,72 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/buffer_pool.hpp"
+
+#include <algorithm>
+
+namespace fc::common {
+  namespace {
+    /// Number of bits needed to represent value
+    size_t bitWidth(size_t value) {
+      size_t bits{0};
+      for (; value != 0; value >>= 1) {
+        ++bits;
+      }
+      return bits;
+    }
+  }  // namespace
+
+  BufferPool &BufferPool::instance() {
+    static BufferPool pool;
+    return pool;
+  }
+
+  BufferPool::Bytes BufferPool::acquire(size_t size) {
+    auto cls{std::max(kMinClass, bitWidth(size - (size != 0)))};
+    if (cls > kMaxClass) {
+      return Bytes(size);
+    }
+    Bytes bytes;
+    {
+      std::lock_guard lock{mutex_};
+      auto &free{free_[cls]};
+      if (!free.empty()) {
+        bytes = std::move(free.back());
+        free.pop_back();
+      }
+    }
+    if (bytes.capacity() == 0) {
+      bytes.reserve(size_t{1} << cls);
+    }
+    bytes.resize(size);
+    return bytes;
+  }
+
+  void BufferPool::release(Bytes &&bytes) {
+    if (bytes.capacity() == 0) {
+      return;
+    }
+    // capacity is at least 1 << cls
+    auto cls{bitWidth(bytes.capacity()) - 1};
+    if (cls < kMinClass || cls > kMaxClass) {
+      return;
+    }
+    bytes.clear();
+    std::lock_guard lock{mutex_};
+    auto &free{free_[cls]};
+    if (free.size() < kMaxFree) {
+      free.push_back(std::move(bytes));
+    }
+  }
+
+  std::shared_ptr<const BufferPool::Bytes> BufferPool::share(Bytes &&bytes) {
+    return std::shared_ptr<Bytes>{new Bytes{std::move(bytes)},
+                                  [this](Bytes *bytes) {
+                                    release(std::move(*bytes));
+                                    delete bytes;
+                                  }};
+  }
+}  // namespace fc::common
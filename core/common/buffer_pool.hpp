@@ -0,0 +1,45 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fc::common {
+  /**
+   * Free lists of byte vectors by power of two capacity, so short lived
+   * buffers of similar size (e.g. network frames) reuse memory instead of
+   * allocating it for each message. Thread-safe.
+   */
+  class BufferPool {
+   public:
+    using Bytes = std::vector<uint8_t>;
+
+    /// Log2 of smallest pooled capacity, smaller buffers are cheap
+    static constexpr size_t kMinClass{8};
+    /// Log2 of largest pooled capacity, larger buffers are freed
+    static constexpr size_t kMaxClass{22};
+    /// Free buffers kept for each capacity
+    static constexpr size_t kMaxFree{16};
+
+    static BufferPool &instance();
+
+    /// Returns buffer of size, reusing free buffer of same class if any
+    Bytes acquire(size_t size);
+
+    /// Keeps buffer memory for next acquire
+    void release(Bytes &&bytes);
+
+    /// Shares buffer, its memory is released when last reference is gone
+    std::shared_ptr<const Bytes> share(Bytes &&bytes);
+
+   private:
+    std::mutex mutex_;
+    std::array<std::vector<Bytes>, kMaxClass + 1> free_;
+  };
+}  // namespace fc::common
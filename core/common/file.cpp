@@ -5,7 +5,14 @@
 
 #include "common/file.hpp"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <fstream>
+#include <vector>
+#if __linux__
+#include <sys/sendfile.h>
+#endif
 
 #include "common/span.hpp"
 
@@ -31,4 +38,63 @@ namespace fc::common {
     }
     return OutcomeError::kDefault;
   }
+
+  outcome::result<void> sendFile(int fd,
+                                 int file,
+                                 uint64_t offset,
+                                 uint64_t size) {
+    auto end{offset + size};
+    auto _offset{static_cast<off_t>(offset)};
+#if __linux__
+    while (static_cast<uint64_t>(_offset) < end) {
+      if (sendfile(fd, file, &_offset, end - _offset) <= 0) {
+        break;
+      }
+    }
+#endif
+    // fallback for other platforms and fd types sendfile doesn't support
+    std::vector<char> buffer(1 << 20);
+    while (static_cast<uint64_t>(_offset) < end) {
+      auto read{::pread(file,
+                        buffer.data(),
+                        std::min<uint64_t>(buffer.size(), end - _offset),
+                        _offset)};
+      if (read <= 0) {
+        return OutcomeError::kDefault;
+      }
+      for (ssize_t written{0}; written < read;) {
+        auto n{::write(fd, buffer.data() + written, read - written)};
+        if (n <= 0) {
+          return OutcomeError::kDefault;
+        }
+        written += n;
+      }
+      _offset += read;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<uint64_t> prewarmFile(const std::string &path,
+                                        uint64_t max_size) {
+    auto fd{::open(path.c_str(), O_RDONLY)};
+    if (fd == -1) {
+      return OutcomeError::kDefault;
+    }
+    uint64_t size{};
+    struct stat st {};
+    if (::fstat(fd, &st) == 0
+        && static_cast<uint64_t>(st.st_size) <= max_size) {
+      size = st.st_size;
+#if __linux__
+      // readahead is started by kernel, call doesn't wait for disk
+      if (::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED) != 0) {
+        size = 0;
+      }
+#else
+      size = 0;
+#endif
+    }
+    ::close(fd);
+    return size;
+  }
 }  // namespace fc::common
@@ -12,4 +12,22 @@ namespace fc::common {
   Outcome<Buffer> readFile(std::string_view path);
 
   outcome::result<void> writeFile(std::string_view path, BytesIn input);
+
+  /**
+   * Writes size bytes of file from offset to fd, e.g. socket.
+   * Uses sendfile where supported, so bytes are not copied to user space.
+   */
+  outcome::result<void> sendFile(int fd,
+                                 int file,
+                                 uint64_t offset,
+                                 uint64_t size);
+
+  /**
+   * Asks kernel to read file into page cache in background
+   * (posix_fadvise WILLNEED), so later reads don't wait for disk.
+   * Files larger than max_size are skipped, they would evict more than
+   * they warm. Returns number of bytes requested.
+   */
+  outcome::result<uint64_t> prewarmFile(const std::string &path,
+                                        uint64_t max_size);
 }  // namespace fc::common
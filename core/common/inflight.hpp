@@ -0,0 +1,133 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "common/async.hpp"
+
+namespace fc::common {
+  /**
+   * Coalesces concurrent async operations with same key: first waiter starts
+   * operation, later ones are queued, all get result of that operation.
+   * Not thread-safe, callers must synchronize (e.g. run on io thread).
+   */
+  template <typename Key, typename T, typename Hash = std::hash<Key>>
+  class Inflight {
+   public:
+    using Cb = CbT<T>;
+
+    /// Adds waiter, returns true if caller must start operation and call done
+    bool wait(const Key &key, Cb cb) {
+      auto [it, first]{waiters_.emplace(key, std::vector<Cb>{})};
+      it->second.push_back(std::move(cb));
+      return first;
+    }
+
+    /// Calls and removes all waiters of key
+    void done(const Key &key, const outcome::result<T> &result) {
+      auto it{waiters_.find(key)};
+      if (it == waiters_.end()) {
+        return;
+      }
+      // waiter may start operation with same key again
+      auto cbs{std::move(it->second)};
+      waiters_.erase(it);
+      for (auto &cb : cbs) {
+        cb(result);
+      }
+    }
+
+    bool has(const Key &key) const {
+      return waiters_.find(key) != waiters_.end();
+    }
+
+    /// Operations in flight
+    size_t size() const {
+      return waiters_.size();
+    }
+
+   private:
+    std::unordered_map<Key, std::vector<Cb>, Hash> waiters_;
+  };
+
+  /**
+   * Remembers failures for short time, so repeated requests fail fast
+   * instead of going to network again.
+   * Not thread-safe, callers must synchronize.
+   */
+  template <typename Key, typename Hash = std::hash<Key>>
+  class NegativeCache {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Expired entries are pruned when size reaches limit
+    explicit NegativeCache(std::chrono::milliseconds ttl, size_t limit = 1024)
+        : ttl_{ttl}, limit_{limit} {}
+
+    void insert(const Key &key,
+                std::error_code error,
+                Clock::time_point now = Clock::now()) {
+      if (ttl_.count() == 0) {
+        return;
+      }
+      if (entries_.size() >= limit_) {
+        prune(now);
+      }
+      entries_[key] = {error, now + ttl_};
+    }
+
+    /// Error of recent failure, if it didn't expire
+    boost::optional<std::error_code> find(
+        const Key &key, Clock::time_point now = Clock::now()) {
+      auto it{entries_.find(key)};
+      if (it == entries_.end()) {
+        return boost::none;
+      }
+      if (it->second.until <= now) {
+        entries_.erase(it);
+        return boost::none;
+      }
+      return it->second.error;
+    }
+
+    void erase(const Key &key) {
+      entries_.erase(key);
+    }
+
+    size_t size() const {
+      return entries_.size();
+    }
+
+   private:
+    struct Entry {
+      std::error_code error;
+      Clock::time_point until;
+    };
+
+    void prune(Clock::time_point now) {
+      for (auto it{entries_.begin()}; it != entries_.end();) {
+        if (it->second.until <= now) {
+          it = entries_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      if (entries_.size() >= limit_) {
+        // all are fresh, drop arbitrary one to stay bounded
+        entries_.erase(entries_.begin());
+      }
+    }
+
+    std::chrono::milliseconds ttl_;
+    size_t limit_;
+    std::unordered_map<Key, Entry, Hash> entries_;
+  };
+}  // namespace fc::common
@@ -5,9 +5,18 @@
 
 #include "common/libp2p/cbor_stream.hpp"
 
+#include "common/buffer_pool.hpp"
+
 namespace fc::common::libp2p {
   CborStream::CborStream(std::shared_ptr<Stream> stream)
-      : stream_{std::move(stream)} {}
+      : stream_{std::move(stream)},
+        buffer_{BufferPool::instance().acquire(kReserveBytes)} {
+    buffer_.clear();
+  }
+
+  CborStream::~CborStream() {
+    BufferPool::instance().release(std::move(buffer_));
+  }
 
   std::shared_ptr<CborStream::Stream> CborStream::stream() const {
     return stream_;
@@ -25,6 +25,9 @@ namespace fc::common::libp2p {
 
     explicit CborStream(std::shared_ptr<Stream> stream);
 
+    /// Returns read buffer to pool
+    ~CborStream();
+
     /// Get underlying stream
     std::shared_ptr<Stream> stream() const;
 
@@ -5,9 +5,13 @@
 
 #include "common/logger.hpp"
 
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
 namespace {
+  /// Max queued messages, memory is preallocated
+  constexpr size_t kQueueSize{8192};
+
   void setGlobalPattern(spdlog::logger &logger) {
     logger.set_pattern("[%Y-%m-%d %H:%M:%S.%F] %n %v");
   }
@@ -18,12 +22,19 @@ namespace {
 
   std::shared_ptr<spdlog::logger> createLogger(const std::string &tag,
                                                bool debug_mode = true) {
-    auto logger = spdlog::stdout_color_mt(tag);
+    // single sink and writer thread shared by all loggers
+    static auto sink{std::make_shared<spdlog::sinks::stdout_color_sink_mt>()};
+    static auto pool{
+        std::make_shared<spdlog::details::thread_pool>(kQueueSize, 1)};
+    auto logger{std::make_shared<spdlog::async_logger>(
+        tag, sink, pool, spdlog::async_overflow_policy::overrun_oldest)};
     if (debug_mode) {
       setDebugPattern(*logger);
     } else {
       setGlobalPattern(*logger);
     }
+    logger->flush_on(spdlog::level::err);
+    spdlog::register_logger(logger);
     return logger;
   }
 }  // namespace
@@ -6,18 +6,92 @@
 #ifndef CPP_FILECOIN_LOGGER_HPP
 #define CPP_FILECOIN_LOGGER_HPP
 
+#include <atomic>
+#include <chrono>
+#include <optional>
+
 #include <spdlog/fmt/ostr.h>
 #include <spdlog/spdlog.h>
 
+/// Levels below are compiled out by FC_LOG_* macros
+#ifndef FC_LOG_ACTIVE_LEVEL
+#define FC_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
+/**
+ * Log if level is compiled in and enabled for logger, arguments are not
+ * evaluated otherwise
+ */
+#define FC_LOG_AT(active, level, logger, ...)       \
+  do {                                              \
+    if constexpr ((active) >= FC_LOG_ACTIVE_LEVEL) { \
+      auto &&_fc_logger{logger};                    \
+      if (_fc_logger->should_log(level)) {          \
+        _fc_logger->log(level, __VA_ARGS__);        \
+      }                                             \
+    }                                               \
+  } while (false)
+
+#define FC_LOG_TRACE(logger, ...) \
+  FC_LOG_AT(SPDLOG_LEVEL_TRACE, spdlog::level::trace, logger, __VA_ARGS__)
+#define FC_LOG_DEBUG(logger, ...) \
+  FC_LOG_AT(SPDLOG_LEVEL_DEBUG, spdlog::level::debug, logger, __VA_ARGS__)
+#define FC_LOG_INFO(logger, ...) \
+  FC_LOG_AT(SPDLOG_LEVEL_INFO, spdlog::level::info, logger, __VA_ARGS__)
+
+/**
+ * Log info at most once per interval from call site, number of skipped
+ * messages is logged with next one
+ */
+#define FC_LOG_INFO_EVERY(interval, logger, ...)                           \
+  do {                                                                     \
+    static fc::common::LogRateLimit _fc_limit{interval};                   \
+    if (auto _fc_skipped{_fc_limit.allow()}) {                             \
+      FC_LOG_INFO(logger, __VA_ARGS__);                                    \
+      if (*_fc_skipped != 0) {                                             \
+        FC_LOG_INFO(logger, "({} similar messages skipped)", *_fc_skipped); \
+      }                                                                    \
+    }                                                                      \
+  } while (false)
+
 namespace fc::common {
   using Logger = std::shared_ptr<spdlog::logger>;
 
   /**
-   * Provide logger object
+   * Provide logger object.
+   * Loggers write to shared stdout sink from background thread through
+   * bounded queue, oldest messages are dropped when queue is full.
    * @param tag - tagging name for identifying logger
    * @return logger object
    */
   Logger createLogger(const std::string &tag);
+
+  /// Per call site log rate limit, thread-safe
+  class LogRateLimit {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit LogRateLimit(Clock::duration interval)
+        : interval_{interval.count()} {}
+
+    /// Returns number of skipped messages if message may be logged now
+    std::optional<uint64_t> allow() {
+      auto now{Clock::now().time_since_epoch().count()};
+      auto next{next_.load(std::memory_order_relaxed)};
+      if (now < next
+          || !next_.compare_exchange_strong(
+              next, now + interval_, std::memory_order_relaxed)) {
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+      }
+      return skipped_.exchange(0, std::memory_order_relaxed);
+    }
+
+   private:
+    Clock::rep interval_;
+    std::atomic<Clock::rep> next_{};
+    std::atomic<uint64_t> skipped_{};
+  };
 }  // namespace fc::common
 
 #endif  // CPP_FILECOIN_LOGGER_HPP
@@ -0,0 +1,111 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+namespace fc::common {
+  /**
+   * Least recently used cache bounded by total weight of values.
+   * Each value has weight (e.g. size in bytes), entries are evicted until
+   * total weight fits into limit.
+   * Not thread-safe, callers must synchronize.
+   */
+  template <typename K, typename V, typename Hash = std::hash<K>>
+  class LruCache {
+   public:
+    explicit LruCache(size_t max_weight) : max_weight_{max_weight} {}
+
+    /// Get value and mark it as recently used
+    boost::optional<V> get(const K &key) {
+      auto it{index_.find(key)};
+      if (it == index_.end()) {
+        return boost::none;
+      }
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return it->second->value;
+    }
+
+    /// Insert or replace value, evicting least recently used entries
+    void put(const K &key, V value, size_t weight) {
+      auto it{index_.find(key)};
+      if (it != index_.end()) {
+        weight_ -= it->second->weight;
+        entries_.erase(it->second);
+        index_.erase(it);
+      }
+      if (weight > max_weight_) {
+        return;
+      }
+      entries_.push_front({key, std::move(value), weight});
+      index_.emplace(key, entries_.begin());
+      weight_ += weight;
+      evict();
+    }
+
+    bool contains(const K &key) const {
+      return index_.find(key) != index_.end();
+    }
+
+    void erase(const K &key) {
+      auto it{index_.find(key)};
+      if (it != index_.end()) {
+        weight_ -= it->second->weight;
+        entries_.erase(it->second);
+        index_.erase(it);
+      }
+    }
+
+    void clear() {
+      index_.clear();
+      entries_.clear();
+      weight_ = 0;
+    }
+
+    /// Change limit, evicting entries if needed
+    void setMaxWeight(size_t max_weight) {
+      max_weight_ = max_weight;
+      evict();
+    }
+
+    size_t size() const {
+      return index_.size();
+    }
+
+    size_t weight() const {
+      return weight_;
+    }
+
+    size_t maxWeight() const {
+      return max_weight_;
+    }
+
+   private:
+    struct Entry {
+      K key;
+      V value;
+      size_t weight;
+    };
+    using Entries = std::list<Entry>;
+
+    void evict() {
+      while (weight_ > max_weight_) {
+        auto &last{entries_.back()};
+        weight_ -= last.weight;
+        index_.erase(last.key);
+        entries_.pop_back();
+      }
+    }
+
+    size_t max_weight_;
+    size_t weight_{};
+    Entries entries_;
+    std::unordered_map<K, typename Entries::iterator, Hash> index_;
+  };
+}  // namespace fc::common
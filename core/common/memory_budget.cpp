@@ -0,0 +1,168 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/memory_budget.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#include "common/metrics.hpp"
+
+namespace fc::common {
+  namespace {
+    /// Reads number from cgroup file, "max" and absent files are none
+    boost::optional<size_t> readCgroup(const std::string &path) {
+      std::ifstream file{path};
+      std::string str;
+      if (!(file >> str) || str == "max") {
+        return boost::none;
+      }
+      try {
+        auto value{std::stoull(str)};
+        // v1 reports unlimited as huge page aligned value
+        if (value >= (size_t{1} << 60)) {
+          return boost::none;
+        }
+        return value;
+      } catch (std::logic_error &) {
+        return boost::none;
+      }
+    }
+
+    boost::optional<size_t> readCgroup(const std::string &v2,
+                                       const std::string &v1) {
+      if (auto value{readCgroup("/sys/fs/cgroup/" + v2)}) {
+        return value;
+      }
+      return readCgroup("/sys/fs/cgroup/memory/" + v1);
+    }
+  }  // namespace
+
+  MemoryBudget::Registration::Registration(MemoryBudget &budget, uint64_t id)
+      : budget_{budget}, id_{id} {}
+
+  MemoryBudget::Registration::~Registration() {
+    budget_.remove(id_);
+  }
+
+  MemoryBudget &MemoryBudget::instance() {
+    static MemoryBudget budget;
+    return budget;
+  }
+
+  std::unique_ptr<MemoryBudget::Registration> MemoryBudget::add(
+      Consumer consumer) {
+    std::lock_guard lock{mutex_};
+    auto id{next_id_++};
+    consumers_[id].consumer = std::move(consumer);
+    rebalance();
+    return std::make_unique<Registration>(*this, id);
+  }
+
+  void MemoryBudget::setLimit(boost::optional<size_t> bytes) {
+    std::lock_guard lock{mutex_};
+    limit_ = bytes;
+    rebalance();
+  }
+
+  boost::optional<size_t> MemoryBudget::limit() const {
+    std::lock_guard lock{mutex_};
+    return limit_;
+  }
+
+  void MemoryBudget::checkPressure() {
+    auto limit{cgroupLimit()};
+    auto used{cgroupUsage()};
+    if (limit && used) {
+      onPressure(*used, *limit);
+    }
+    for (auto &[name, usage] : usage()) {
+      auto labels{"cache=\"" + name + "\""};
+      metrics::gauge("fc_cache_bytes", "Bytes used by cache", labels)
+          .set(usage.bytes);
+      metrics::gauge("fc_cache_limit_bytes", "Memory budget of cache", labels)
+          .set(usage.limit);
+    }
+  }
+
+  void MemoryBudget::onPressure(size_t used, size_t limit) {
+    std::lock_guard lock{mutex_};
+    auto scale{scale_percent_};
+    if (used * 100 > limit * kHighPercent) {
+      scale = std::max(kMinScalePercent, scale * 3 / 4);
+    } else if (used * 100 < limit * kLowPercent) {
+      scale = std::min<size_t>(100, scale + 10);
+    }
+    if (scale != scale_percent_) {
+      scale_percent_ = scale;
+      rebalance();
+    }
+  }
+
+  std::map<std::string, MemoryBudget::Usage> MemoryBudget::usage() const {
+    std::lock_guard lock{mutex_};
+    std::map<std::string, Usage> usage;
+    for (auto &[id, entry] : consumers_) {
+      auto &item{usage[entry.consumer.name]};
+      item.bytes += entry.consumer.usage();
+      item.limit += entry.limit;
+    }
+    return usage;
+  }
+
+  boost::optional<size_t> MemoryBudget::cgroupLimit() {
+    return readCgroup("memory.max", "memory.limit_in_bytes");
+  }
+
+  boost::optional<size_t> MemoryBudget::cgroupUsage() {
+    return readCgroup("memory.current", "memory.usage_in_bytes");
+  }
+
+  void MemoryBudget::remove(uint64_t id) {
+    std::lock_guard lock{mutex_};
+    consumers_.erase(id);
+    rebalance();
+  }
+
+  void MemoryBudget::rebalance() {
+    size_t total{0};
+    for (auto &[id, entry] : consumers_) {
+      total += entry.consumer.max_bytes;
+    }
+    auto budget{(limit_ ? std::min(*limit_, total) : total) * scale_percent_
+                / 100};
+    // consumers whose max is below their share get max, rest is split again
+    std::vector<Entry *> pending;
+    for (auto &[id, entry] : consumers_) {
+      pending.push_back(&entry);
+    }
+    while (!pending.empty()) {
+      size_t weights{0};
+      for (auto entry : pending) {
+        weights += std::max<size_t>(entry->consumer.weight, 1);
+      }
+      auto share{[&](Entry *entry) {
+        return budget * std::max<size_t>(entry->consumer.weight, 1) / weights;
+      }};
+      auto capped{std::partition(pending.begin(), pending.end(), [&](auto e) {
+        return e->consumer.max_bytes > share(e);
+      })};
+      if (capped == pending.end()) {
+        for (auto entry : pending) {
+          entry->limit = share(entry);
+        }
+        break;
+      }
+      for (auto it{capped}; it != pending.end(); ++it) {
+        (*it)->limit = (*it)->consumer.max_bytes;
+        budget -= (*it)->limit;
+      }
+      pending.erase(capped, pending.end());
+    }
+    for (auto &[id, entry] : consumers_) {
+      entry.consumer.set_limit(entry.limit);
+    }
+  }
+}  // namespace fc::common
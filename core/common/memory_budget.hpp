@@ -0,0 +1,111 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+namespace fc::common {
+  /**
+   * Shared memory budget of process caches.
+   * Caches register their usage and limit setter, budget is split between
+   * them by weight, never above own max of cache. Without budget limit
+   * caches use their own max.
+   * Under cgroup memory pressure budget shrinks, and grows back when
+   * pressure ends. Per cache usage is exported as metrics.
+   * Thread-safe. Consumer callbacks are called under budget lock, so they
+   * must not register or unregister consumers.
+   */
+  class MemoryBudget {
+   public:
+    struct Consumer {
+      /// Metrics label, consumers with same name are reported together
+      std::string name;
+      /// Share of budget relative to other consumers
+      size_t weight{1};
+      /// Limit without budget, consumer never gets more
+      size_t max_bytes{};
+      std::function<size_t()> usage;
+      std::function<void(size_t)> set_limit;
+    };
+
+    /// Removes consumer when destroyed
+    class Registration {
+     public:
+      Registration(MemoryBudget &budget, uint64_t id);
+      Registration(const Registration &) = delete;
+      Registration &operator=(const Registration &) = delete;
+      ~Registration();
+
+     private:
+      MemoryBudget &budget_;
+      uint64_t id_;
+    };
+
+    struct Usage {
+      size_t bytes{};
+      size_t limit{};
+    };
+
+    /// Usage is high above this part of cgroup limit, in percents
+    static constexpr size_t kHighPercent{90};
+    /// Usage is low below this part of cgroup limit, in percents
+    static constexpr size_t kLowPercent{70};
+    /// Budget never shrinks below this part, in percents
+    static constexpr size_t kMinScalePercent{10};
+
+    static MemoryBudget &instance();
+
+    /// Consumer gets its limit before return
+    std::unique_ptr<Registration> add(Consumer consumer);
+
+    /// Total bytes of caches, none means own max of each cache
+    void setLimit(boost::optional<size_t> bytes);
+
+    boost::optional<size_t> limit() const;
+
+    /**
+     * Shrinks budget by quarter if cgroup usage is high, grows it by
+     * tenth if low, and updates metrics. Called periodically.
+     */
+    void checkPressure();
+
+    /// Shrinks or grows budget as checkPressure does for given usage
+    void onPressure(size_t used, size_t limit);
+
+    /// Usage and limits by consumer name
+    std::map<std::string, Usage> usage() const;
+
+    /// Memory limit of process cgroup, v2 or v1
+    static boost::optional<size_t> cgroupLimit();
+
+    /// Memory usage of process cgroup, v2 or v1
+    static boost::optional<size_t> cgroupUsage();
+
+   private:
+    struct Entry {
+      Consumer consumer;
+      size_t limit{};
+    };
+
+    void remove(uint64_t id);
+
+    /// Splits budget between consumers, under lock
+    void rebalance();
+
+    mutable std::mutex mutex_;
+    std::map<uint64_t, Entry> consumers_;
+    uint64_t next_id_{};
+    boost::optional<size_t> limit_;
+    size_t scale_percent_{100};
+  };
+}  // namespace fc::common
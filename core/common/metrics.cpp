@@ -0,0 +1,126 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/metrics.hpp"
+
+#include <sstream>
+
+namespace fc::common::metrics {
+  namespace {
+    /// Labels in braces, with extra label appended
+    std::string braces(const std::string &labels,
+                       const std::string &extra = {}) {
+      if (labels.empty() && extra.empty()) {
+        return {};
+      }
+      auto sep{!labels.empty() && !extra.empty() ? "," : ""};
+      return "{" + labels + sep + extra + "}";
+    }
+
+    std::string seconds(uint64_t micros) {
+      std::ostringstream s;
+      s << micros / 1000000 << '.';
+      s.width(6);
+      s.fill('0');
+      s << micros % 1000000;
+      return s.str();
+    }
+  }  // namespace
+
+  void Histogram::observe(Duration duration) {
+    auto micros{static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0))};
+    size_t i{0};
+    while (i < kBuckets && micros >= bound(i)) {
+      ++i;
+    }
+    buckets_[i].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(micros, std::memory_order_relaxed);
+  }
+
+  Registry &Registry::instance() {
+    static Registry registry;
+    return registry;
+  }
+
+  Counter &Registry::counter(const std::string &name,
+                             const std::string &help,
+                             const std::string &labels) {
+    std::lock_guard lock{mutex_};
+    auto &family{families_[name]};
+    family.help = help;
+    auto &counter{family.counters[labels]};
+    if (!counter) {
+      counter = std::make_unique<Counter>();
+    }
+    return *counter;
+  }
+
+  Histogram &Registry::histogram(const std::string &name,
+                                 const std::string &help,
+                                 const std::string &labels) {
+    std::lock_guard lock{mutex_};
+    auto &family{families_[name]};
+    family.help = help;
+    auto &histogram{family.histograms[labels]};
+    if (!histogram) {
+      histogram = std::make_unique<Histogram>();
+    }
+    return *histogram;
+  }
+
+  Gauge &Registry::gauge(const std::string &name,
+                         const std::string &help,
+                         const std::string &labels) {
+    std::lock_guard lock{mutex_};
+    auto &family{families_[name]};
+    family.help = help;
+    auto &gauge{family.gauges[labels]};
+    if (!gauge) {
+      gauge = std::make_unique<Gauge>();
+    }
+    return *gauge;
+  }
+
+  std::string Registry::prometheus() const {
+    std::lock_guard lock{mutex_};
+    std::ostringstream s;
+    for (auto &[name, family] : families_) {
+      s << "# HELP " << name << " " << family.help << "\n";
+      if (!family.counters.empty()) {
+        s << "# TYPE " << name << " counter\n";
+        for (auto &[labels, counter] : family.counters) {
+          s << name << braces(labels) << " " << counter->value() << "\n";
+        }
+      }
+      if (!family.gauges.empty()) {
+        s << "# TYPE " << name << " gauge\n";
+        for (auto &[labels, gauge] : family.gauges) {
+          s << name << braces(labels) << " " << gauge->value() << "\n";
+        }
+      }
+      if (!family.histograms.empty()) {
+        s << "# TYPE " << name << " histogram\n";
+        for (auto &[labels, histogram] : family.histograms) {
+          uint64_t total{0};
+          for (size_t i{0}; i < Histogram::kBuckets; ++i) {
+            total += histogram->bucket(i);
+            s << name << "_bucket"
+              << braces(labels,
+                        "le=\"" + seconds(Histogram::bound(i)) + "\"")
+              << " " << total << "\n";
+          }
+          total += histogram->bucket(Histogram::kBuckets);
+          s << name << "_bucket" << braces(labels, "le=\"+Inf\"") << " "
+            << total << "\n";
+          s << name << "_sum" << braces(labels) << " "
+            << seconds(histogram->sum().count()) << "\n";
+          s << name << "_count" << braces(labels) << " " << total << "\n";
+        }
+      }
+    }
+    return s.str();
+  }
+}  // namespace fc::common::metrics
@@ -0,0 +1,160 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace fc::common::metrics {
+  /// Monotonic counter, increments are relaxed atomics
+  class Counter {
+   public:
+    inline void inc(uint64_t n = 1) {
+      value_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    inline uint64_t value() const {
+      return value_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<uint64_t> value_{};
+  };
+
+  /// Value which may go up and down, e.g. bytes used
+  class Gauge {
+   public:
+    inline void set(int64_t value) {
+      value_.store(value, std::memory_order_relaxed);
+    }
+
+    inline int64_t value() const {
+      return value_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<int64_t> value_{};
+  };
+
+  /**
+   * Latency histogram with power of two microsecond buckets, from 1us to
+   * ~67s, bucket bound is at most twice the observed value.
+   */
+  class Histogram {
+   public:
+    using Duration = std::chrono::microseconds;
+
+    static constexpr size_t kBuckets{27};
+
+    void observe(Duration duration);
+
+    /// Observes time passed since start, for async operations
+    inline void observeSince(std::chrono::steady_clock::time_point start) {
+      observe(std::chrono::duration_cast<Duration>(
+          std::chrono::steady_clock::now() - start));
+    }
+
+    /// Microseconds below which bucket values are
+    static constexpr uint64_t bound(size_t bucket) {
+      return uint64_t{1} << bucket;
+    }
+
+    /// Observations in bucket, last bucket is for values above all bounds
+    inline uint64_t bucket(size_t i) const {
+      return buckets_[i].load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t count() const {
+      return count_.load(std::memory_order_relaxed);
+    }
+
+    inline Duration sum() const {
+      return Duration{sum_.load(std::memory_order_relaxed)};
+    }
+
+   private:
+    std::array<std::atomic<uint64_t>, kBuckets + 1> buckets_{};
+    std::atomic<uint64_t> count_{};
+    std::atomic<uint64_t> sum_{};
+  };
+
+  /// Observes time from construction to destruction
+  class Timer {
+   public:
+    explicit Timer(Histogram &histogram)
+        : histogram_{histogram}, start_{std::chrono::steady_clock::now()} {}
+
+    Timer(const Timer &) = delete;
+    Timer &operator=(const Timer &) = delete;
+
+    ~Timer() {
+      histogram_.observeSince(start_);
+    }
+
+   private:
+    Histogram &histogram_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  /**
+   * Named metrics, optionally with prometheus labels (e.g. `method="X"`).
+   * Metrics are never removed, so hot paths look them up once and keep
+   * references.
+   */
+  class Registry {
+   public:
+    static Registry &instance();
+
+    Counter &counter(const std::string &name,
+                     const std::string &help,
+                     const std::string &labels = {});
+
+    Histogram &histogram(const std::string &name,
+                         const std::string &help,
+                         const std::string &labels = {});
+
+    Gauge &gauge(const std::string &name,
+                 const std::string &help,
+                 const std::string &labels = {});
+
+    /// Prometheus text exposition format
+    std::string prometheus() const;
+
+   private:
+    struct Family {
+      std::string help;
+      std::map<std::string, std::unique_ptr<Counter>> counters;
+      std::map<std::string, std::unique_ptr<Histogram>> histograms;
+      std::map<std::string, std::unique_ptr<Gauge>> gauges;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+  };
+
+  inline Counter &counter(const std::string &name,
+                          const std::string &help,
+                          const std::string &labels = {}) {
+    return Registry::instance().counter(name, help, labels);
+  }
+
+  inline Histogram &histogram(const std::string &name,
+                              const std::string &help,
+                              const std::string &labels = {}) {
+    return Registry::instance().histogram(name, help, labels);
+  }
+
+  inline Gauge &gauge(const std::string &name,
+                      const std::string &help,
+                      const std::string &labels = {}) {
+    return Registry::instance().gauge(name, help, labels);
+  }
+}  // namespace fc::common::metrics
@@ -0,0 +1,65 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include <boost/optional.hpp>
+
+namespace fc::common {
+  /**
+   * Unbounded lock-free queue for many producers and single consumer.
+   * Push is one atomic exchange. Pop may miss value which push didn't link
+   * yet, so producer must notify consumer after push returns.
+   */
+  template <typename T>
+  class MpscQueue {
+   public:
+    MpscQueue() : head_{new Node}, tail_{head_.load()} {}
+
+    ~MpscQueue() {
+      while (pop()) {
+      }
+      delete tail_;
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /// Thread-safe
+    void push(T value) {
+      auto node{new Node};
+      node->value = std::move(value);
+      auto prev{head_.exchange(node, std::memory_order_acq_rel)};
+      prev->next.store(node, std::memory_order_release);
+    }
+
+    /// Consumer thread only
+    boost::optional<T> pop() {
+      auto next{tail_->next.load(std::memory_order_acquire)};
+      if (!next) {
+        return boost::none;
+      }
+      delete tail_;
+      // next becomes stub node
+      tail_ = next;
+      auto value{std::move(next->value)};
+      next->value.reset();
+      return value;
+    }
+
+   private:
+    struct Node {
+      std::atomic<Node *> next{nullptr};
+      boost::optional<T> value;
+    };
+
+    /// Last pushed node
+    std::atomic<Node *> head_;
+    /// Stub node, values are after it
+    Node *tail_;
+  };
+}  // namespace fc::common
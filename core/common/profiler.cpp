@@ -0,0 +1,194 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/profiler.hpp"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace fc::common::profiler {
+  namespace {
+    constexpr size_t kMaxDepth{64};
+    /// Frames of signal handler and trampoline
+    constexpr int kSkipFrames{2};
+    constexpr size_t kMaxSamples{1 << 14};
+
+    struct Sample {
+      pid_t tid;
+      int depth;
+      std::array<void *, kMaxDepth> frames;
+    };
+
+    std::atomic_flag running = ATOMIC_FLAG_INIT;
+    /**
+     * Allocated by first profile and kept, handler stays installed too, so
+     * late signals never touch freed memory or default action.
+     */
+    Sample *samples{};
+    /// Slots handler may claim, zero when not collecting
+    std::atomic<size_t> sample_limit{};
+    std::atomic<size_t> next_sample{};
+
+    void onSignal(int) {
+      auto saved_errno{errno};
+      auto i{next_sample.fetch_add(1, std::memory_order_relaxed)};
+      if (i < sample_limit.load(std::memory_order_relaxed)) {
+        auto &sample{samples[i]};
+        sample.tid = static_cast<pid_t>(syscall(SYS_gettid));
+        sample.depth = backtrace(sample.frames.data(), kMaxDepth);
+      }
+      errno = saved_errno;
+    }
+
+    std::string threadName(pid_t tid) {
+      std::ifstream file{"/proc/self/task/" + std::to_string(tid) + "/comm"};
+      std::string name;
+      std::getline(file, name);
+      return name.empty() ? std::to_string(tid) : name;
+    }
+
+    std::string symbol(void *address) {
+      Dl_info info{};
+      if (dladdr(address, &info) == 0 || info.dli_sname == nullptr) {
+        // module and offset, may be resolved offline with addr2line
+        std::array<char, 32> offset{};
+        if (info.dli_fname == nullptr) {
+          snprintf(offset.data(), offset.size(), "%p", address);
+          return offset.data();
+        }
+        snprintf(offset.data(),
+                 offset.size(),
+                 "+0x%zx",
+                 static_cast<size_t>(static_cast<char *>(address)
+                                     - static_cast<char *>(info.dli_fbase)));
+        std::string module{info.dli_fname};
+        return module.substr(module.rfind('/') + 1) + offset.data();
+      }
+      int status{};
+      std::unique_ptr<char, decltype(&free)> demangled{
+          abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status),
+          free};
+      std::string name{status == 0 ? demangled.get() : info.dli_sname};
+      // ';' separates frames
+      for (auto &c : name) {
+        if (c == ';') {
+          c = ':';
+        }
+      }
+      return name;
+    }
+
+    std::string collapse(size_t count) {
+      std::unordered_map<void *, std::string> symbols;
+      std::unordered_map<pid_t, std::string> threads;
+      std::map<std::string, size_t> stacks;
+      for (size_t i{0}; i < count; ++i) {
+        auto &sample{samples[i]};
+        auto thread{threads.find(sample.tid)};
+        if (thread == threads.end()) {
+          thread = threads.emplace(sample.tid, threadName(sample.tid)).first;
+        }
+        auto stack{thread->second};
+        for (auto j{sample.depth - 1}; j >= kSkipFrames; --j) {
+          auto address{sample.frames[j]};
+          auto it{symbols.find(address)};
+          if (it == symbols.end()) {
+            it = symbols.emplace(address, symbol(address)).first;
+          }
+          stack += ';';
+          stack += it->second;
+        }
+        ++stacks[stack];
+      }
+      std::string out;
+      for (auto &[stack, n] : stacks) {
+        out += stack;
+        out += ' ';
+        out += std::to_string(n);
+        out += '\n';
+      }
+      return out;
+    }
+  }  // namespace
+
+  outcome::result<std::string> profileCpu(std::chrono::milliseconds duration,
+                                          int frequency) {
+    if (frequency <= 0 || frequency > 1000 || duration.count() <= 0) {
+      return std::errc::invalid_argument;
+    }
+    if (running.test_and_set()) {
+      return std::errc::device_or_resource_busy;
+    }
+    if (samples == nullptr) {
+      samples = new Sample[kMaxSamples];
+      // first call loads unwinder, which allocates
+      std::array<void *, 1> warmup{};
+      backtrace(warmup.data(), warmup.size());
+      struct sigaction action {};
+      action.sa_handler = onSignal;
+      action.sa_flags = SA_RESTART;
+      sigemptyset(&action.sa_mask);
+      sigaction(SIGPROF, &action, nullptr);
+    }
+    next_sample = 0;
+    sample_limit = kMaxSamples;
+    itimerval timer{};
+    timer.it_interval.tv_usec = 1000000 / frequency;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+
+    std::this_thread::sleep_for(duration);
+
+    timer = {};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    sample_limit = 0;
+    // let handlers in flight finish writing
+    std::this_thread::sleep_for(std::chrono::milliseconds{1000 / frequency});
+
+    auto out{collapse(std::min(next_sample.load(), kMaxSamples))};
+    running.clear();
+    return out;
+  }
+
+  std::string heapInfo() {
+#ifdef __GLIBC__
+    char *data{};
+    size_t size{};
+    if (auto file{open_memstream(&data, &size)}) {
+      malloc_info(0, file);
+      fclose(file);
+      std::string out{data, size};
+      free(data);
+      return out;
+    }
+#endif
+    return {};
+  }
+
+  void setThreadName(const std::string &name) {
+#if __linux__
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#endif
+  }
+}  // namespace fc::common::profiler
@@ -0,0 +1,33 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "common/outcome.hpp"
+
+/**
+ * In-process sampling profiler for live diagnostics, when perf can't be
+ * attached.
+ */
+namespace fc::common::profiler {
+  /**
+   * Samples stacks of threads consuming cpu with SIGPROF for duration and
+   * returns them in collapsed format ("thread;outer;...;inner count" lines),
+   * accepted by flamegraph.pl and speedscope.
+   * Blocks calling thread, only one profile runs at a time.
+   * Symbols of executable are resolved only if it is linked with -rdynamic.
+   */
+  outcome::result<std::string> profileCpu(std::chrono::milliseconds duration,
+                                          int frequency = 99);
+
+  /// Heap statistics of allocator, glibc malloc_info xml
+  std::string heapInfo();
+
+  /// Names current thread, name is truncated to 15 chars
+  void setThreadName(const std::string &name);
+}  // namespace fc::common::profiler
@@ -7,8 +7,12 @@
 
 #include <libarchive/archive.h>
 #include <libarchive/archive_entry.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <boost/filesystem.hpp>
+#include <functional>
 #include "common/ffi.hpp"
+#include "common/file.hpp"
 #include "common/logger.hpp"
 
 namespace fs = boost::filesystem;
@@ -38,8 +42,10 @@ namespace fc::common {
     }
   }
 
-  outcome::result<void> extractTar(const std::string &tar_path,
-                                   const std::string &output_path) {
+  using ArchiveOpen = std::function<int(struct archive *)>;
+
+  outcome::result<void> extractTarArchive(const ArchiveOpen &open,
+                                          const std::string &output_path) {
     if (!fs::exists(output_path)) {
       boost::system::error_code ec;
       if (!fs::create_directories(output_path, ec)) {
@@ -65,8 +71,7 @@ namespace fc::common {
     auto ext = ffi::wrap(archive_write_disk_new(), archive_write_free);
     archive_write_disk_set_options(ext.get(), flags);
     archive_write_disk_set_standard_lookup(ext.get());
-    if (archive_read_open_filename(a.get(), tar_path.c_str(), kTarBlockSize)
-        != ARCHIVE_OK) {
+    if (open(a.get()) != ARCHIVE_OK) {
       logger->error("Extract tar: {}", archive_error_string(a.get()));
       return TarErrors::kCannotUntarArchive;
     }
@@ -118,6 +123,169 @@ namespace fc::common {
     return outcome::success();
   }
 
+  outcome::result<void> extractTar(const std::string &tar_path,
+                                   const std::string &output_path) {
+    return extractTarArchive(
+        [&](struct archive *a) {
+          return archive_read_open_filename(a, tar_path.c_str(), kTarBlockSize);
+        },
+        output_path);
+  }
+
+  outcome::result<void> extractTar(int fd, const std::string &output_path) {
+    return extractTarArchive(
+        [&](struct archive *a) {
+          return archive_read_open_fd(a, fd, kTarBlockSize);
+        },
+        output_path);
+  }
+
+  namespace {
+    constexpr size_t kTarRecord{512};
+    /// Largest size of octal ustar size field
+    constexpr uint64_t kTarMaxOctal{(uint64_t{1} << 33) - 1};
+
+    uint64_t tarPadding(uint64_t size) {
+      return (kTarRecord - size % kTarRecord) % kTarRecord;
+    }
+
+    void tarOctal(char *field, size_t length, uint64_t value) {
+      snprintf(field,
+               length,
+               "%0*llo",
+               static_cast<int>(length - 1),
+               static_cast<unsigned long long>(value));
+    }
+
+    /// Ustar header, long names are split to prefix
+    bool tarHeader(const TarEntry &entry, char *header) {
+      std::fill(header, header + kTarRecord, 0);
+      auto name{entry.is_dir ? entry.name + "/" : entry.name};
+      std::string prefix;
+      if (name.size() > 100) {
+        auto slash{name.rfind('/', name.size() - 2)};
+        if (slash == std::string::npos || slash > 155
+            || name.size() - slash - 1 > 100) {
+          return false;
+        }
+        prefix = name.substr(0, slash);
+        name = name.substr(slash + 1);
+      }
+      std::copy(name.begin(), name.end(), header);
+      tarOctal(header + 100, 8, entry.is_dir ? 0755 : 0644);
+      tarOctal(header + 108, 8, 0);
+      tarOctal(header + 116, 8, 0);
+      if (entry.size <= kTarMaxOctal) {
+        tarOctal(header + 124, 12, entry.size);
+      } else {
+        // base-256 extension for files of 8GiB and more
+        header[124] = static_cast<char>(0x80);
+        for (size_t i{0}; i < 8; ++i) {
+          header[135 - i] = static_cast<char>((entry.size >> (8 * i)) & 0xff);
+        }
+      }
+      tarOctal(header + 136, 12, 0);
+      header[156] = entry.is_dir ? '5' : '0';
+      std::copy_n("ustar", 6, header + 257);
+      std::copy_n("00", 2, header + 263);
+      std::copy(prefix.begin(), prefix.end(), header + 345);
+      std::fill(header + 148, header + 156, ' ');
+      unsigned sum{0};
+      for (size_t i{0}; i < kTarRecord; ++i) {
+        sum += static_cast<uint8_t>(header[i]);
+      }
+      tarOctal(header + 148, 7, sum);
+      return true;
+    }
+
+    bool writeAll(int fd, const char *data, size_t size) {
+      while (size != 0) {
+        auto written{::write(fd, data, size)};
+        if (written <= 0) {
+          return false;
+        }
+        data += written;
+        size -= written;
+      }
+      return true;
+    }
+  }  // namespace
+
+  outcome::result<std::vector<TarEntry>> tarEntries(const std::string &dir) {
+    std::vector<TarEntry> entries;
+    boost::system::error_code ec;
+    for (fs::recursive_directory_iterator it{dir, ec}, end; it != end;
+         it.increment(ec)) {
+      if (ec) {
+        break;
+      }
+      TarEntry entry;
+      entry.path = it->path().string();
+      entry.name = it->path().lexically_relative(dir).generic_string();
+      entry.is_dir = fs::is_directory(it->status());
+      if (!entry.is_dir) {
+        if (!fs::is_regular_file(it->status())) {
+          continue;
+        }
+        entry.size = fs::file_size(it->path(), ec);
+        if (ec) {
+          break;
+        }
+      }
+      entries.push_back(std::move(entry));
+    }
+    if (ec) {
+      logger->error("Tar: {}", ec.message());
+      return TarErrors::kCannotTarArchive;
+    }
+    return entries;
+  }
+
+  uint64_t tarSize(const std::vector<TarEntry> &entries) {
+    uint64_t size{0};
+    for (const auto &entry : entries) {
+      size += kTarRecord + entry.size + tarPadding(entry.size);
+    }
+    // end of archive
+    return size + 2 * kTarRecord;
+  }
+
+  outcome::result<void> writeTar(const std::vector<TarEntry> &entries,
+                                 int fd) {
+    char header[kTarRecord];
+    for (const auto &entry : entries) {
+      if (!tarHeader(entry, header)) {
+        logger->error("Tar: too long name {}", entry.name);
+        return TarErrors::kCannotTarArchive;
+      }
+      if (!writeAll(fd, header, kTarRecord)) {
+        return TarErrors::kCannotTarArchive;
+      }
+      if (entry.is_dir) {
+        continue;
+      }
+      auto file{::open(entry.path.c_str(), O_RDONLY)};
+      if (file < 0) {
+        return TarErrors::kCannotTarArchive;
+      }
+      auto sent{sendFile(fd, file, 0, entry.size)};
+      ::close(file);
+      if (!sent) {
+        return TarErrors::kCannotTarArchive;
+      }
+      std::fill(header, header + kTarRecord, 0);
+      if (!writeAll(fd, header, tarPadding(entry.size))) {
+        return TarErrors::kCannotTarArchive;
+      }
+    }
+    std::fill(header, header + kTarRecord, 0);
+    if (!writeAll(fd, header, kTarRecord)
+        || !writeAll(fd, header, kTarRecord)) {
+      return TarErrors::kCannotTarArchive;
+    }
+    return outcome::success();
+  }
+
 }  // namespace fc::common
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::common, TarErrors, e) {
@@ -127,6 +295,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::common, TarErrors, e) {
       return "Tar Util: cannot create output dir";
     case (TarErrors::kCannotUntarArchive):
       return "Tar Util: cannot untar archive";
+    case (TarErrors::kCannotTarArchive):
+      return "Tar Util: cannot tar archive";
     default:
       return "Tar Util: unknown error";
   }
@@ -7,6 +7,7 @@
 #define CPP_FILECOIN_CORE_COMMON_TAR_UTIL_HPP
 
 #include <string>
+#include <vector>
 #include "common/outcome.hpp"
 
 namespace fc::common {
@@ -16,9 +17,34 @@ namespace fc::common {
   outcome::result<void> extractTar(const std::string &tar_path,
                                    const std::string &output_path);
 
+  /// Extracts tar read from file descriptor, e.g. pipe filled by download
+  outcome::result<void> extractTar(int fd, const std::string &output_path);
+
+  /// Entry of tar streamed by writeTar
+  struct TarEntry {
+    std::string path;
+    /// Name inside archive, relative to archived directory
+    std::string name;
+    uint64_t size{};
+    bool is_dir{false};
+  };
+
+  /// Lists entries of directory, so tar size is known before streaming
+  outcome::result<std::vector<TarEntry>> tarEntries(const std::string &dir);
+
+  /// Size of tar with entries
+  uint64_t tarSize(const std::vector<TarEntry> &entries);
+
+  /**
+   * Writes tar with entries to file descriptor, without temporary archive.
+   * File bodies are copied with sendfile where supported.
+   */
+  outcome::result<void> writeTar(const std::vector<TarEntry> &entries, int fd);
+
   enum class TarErrors {
     kCannotCreateDir = 1,
     kCannotUntarArchive,
+    kCannotTarArchive,
   };
 
 }  // namespace fc::common
@@ -0,0 +1,23 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <future>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+namespace fc {
+  /// Run function on pool, its result is available through future
+  template <typename F>
+  auto postFuture(boost::asio::thread_pool &pool, F &&f) {
+    using R = std::invoke_result_t<F>;
+    auto task{std::make_shared<std::packaged_task<R()>>(std::forward<F>(f))};
+    auto future{task->get_future()};
+    boost::asio::post(pool, [task] { (*task)(); });
+    return future;
+  }
+}  // namespace fc
@@ -0,0 +1,307 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/tracing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+
+namespace fc::common::tracing {
+  namespace {
+    struct State {
+      std::shared_mutex mutex;
+      Exporter exporter;
+
+      State() {
+        if (auto path{getenv("FC_TRACE_FILE")}) {
+          auto service{getenv("FC_TRACE_SERVICE")};
+          exporter = fileExporter(path, service ? service : "fuhon");
+        }
+      }
+    };
+
+    State &state() {
+      static State state;
+      return state;
+    }
+
+    std::atomic_bool &enabledFlag() {
+      static std::atomic_bool flag{static_cast<bool>(state().exporter)};
+      return flag;
+    }
+
+    thread_local SpanContext current_context;
+
+    template <size_t N>
+    void randomBytes(std::array<uint8_t, N> &bytes) {
+      thread_local std::mt19937_64 random{std::random_device{}()};
+      for (size_t i{0}; i < N; i += 8) {
+        auto value{random()};
+        for (size_t j{0}; j < 8 && i + j < N; ++j, value >>= 8) {
+          bytes[i + j] = static_cast<uint8_t>(value);
+        }
+      }
+    }
+
+    template <size_t N>
+    bool isZero(const std::array<uint8_t, N> &bytes) {
+      return std::all_of(
+          bytes.begin(), bytes.end(), [](auto b) { return b == 0; });
+    }
+
+    template <size_t N>
+    std::string hex(const std::array<uint8_t, N> &bytes) {
+      constexpr auto kDigits{"0123456789abcdef"};
+      std::string str;
+      str.reserve(2 * N);
+      for (auto byte : bytes) {
+        str += kDigits[byte >> 4];
+        str += kDigits[byte & 0xf];
+      }
+      return str;
+    }
+
+    template <size_t N>
+    bool unhex(std::string_view str, std::array<uint8_t, N> &bytes) {
+      if (str.size() != 2 * N) {
+        return false;
+      }
+      auto digit{[](char c) -> int {
+        if (c >= '0' && c <= '9') {
+          return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+          return c - 'a' + 10;
+        }
+        return -1;
+      }};
+      for (size_t i{0}; i < N; ++i) {
+        auto high{digit(str[2 * i])}, low{digit(str[2 * i + 1])};
+        if (high < 0 || low < 0) {
+          return false;
+        }
+        bytes[i] = static_cast<uint8_t>(high << 4 | low);
+      }
+      return true;
+    }
+
+    void jsonString(std::string &out, std::string_view str) {
+      out += '"';
+      for (auto c : str) {
+        switch (c) {
+          case '"':
+            out += "\\\"";
+            break;
+          case '\\':
+            out += "\\\\";
+            break;
+          case '\n':
+            out += "\\n";
+            break;
+          default:
+            if (static_cast<uint8_t>(c) < 0x20) {
+              constexpr auto kDigits{"0123456789abcdef"};
+              out += "\\u00";
+              out += kDigits[c >> 4];
+              out += kDigits[c & 0xf];
+            } else {
+              out += c;
+            }
+        }
+      }
+      out += '"';
+    }
+
+    void jsonKeyValue(std::string &out,
+                      std::string_view key,
+                      std::string_view value) {
+      out += "{\"key\":";
+      jsonString(out, key);
+      out += ",\"value\":{\"stringValue\":";
+      jsonString(out, value);
+      out += "}}";
+    }
+
+    std::string nanos(std::chrono::system_clock::time_point time) {
+      return std::to_string(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              time.time_since_epoch())
+              .count());
+    }
+
+    std::chrono::system_clock::time_point toSystem(Clock::time_point time) {
+      return std::chrono::system_clock::now()
+             - std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                 Clock::now() - time);
+    }
+  }  // namespace
+
+  bool SpanContext::valid() const {
+    return !isZero(trace_id);
+  }
+
+  std::string SpanContext::traceparent() const {
+    if (!valid()) {
+      return {};
+    }
+    return "00-" + hex(trace_id) + "-" + hex(span_id) + "-01";
+  }
+
+  SpanContext SpanContext::fromTraceparent(std::string_view str) {
+    // 00-<trace id>-<parent id>-<flags>
+    SpanContext context;
+    if (str.size() != 55 || str.substr(0, 3) != "00-" || str[35] != '-'
+        || str[52] != '-' || !unhex(str.substr(3, 32), context.trace_id)
+        || !unhex(str.substr(36, 16), context.span_id)
+        || isZero(context.span_id)) {
+      return {};
+    }
+    return context;
+  }
+
+  void setExporter(Exporter exporter) {
+    auto &s{state()};
+    std::unique_lock lock{s.mutex};
+    enabledFlag() = static_cast<bool>(exporter);
+    s.exporter = std::move(exporter);
+  }
+
+  bool enabled() {
+    return enabledFlag().load(std::memory_order_relaxed);
+  }
+
+  Exporter fileExporter(const std::string &path, const std::string &service) {
+    auto file{std::make_shared<std::ofstream>(path, std::ios::app)};
+    auto mutex{std::make_shared<std::mutex>()};
+    return [file, mutex, service](const SpanData &span) {
+      auto json{otlpJson(span, service)};
+      std::lock_guard lock{*mutex};
+      *file << json << '\n';
+      file->flush();
+    };
+  }
+
+  std::string otlpJson(const SpanData &span, const std::string &service) {
+    std::string out;
+    out += "{\"resourceSpans\":[{\"resource\":{\"attributes\":[";
+    jsonKeyValue(out, "service.name", service);
+    out += "]},\"scopeSpans\":[{\"scope\":{\"name\":\"fc\"},\"spans\":[{";
+    out += "\"traceId\":\"" + hex(span.context.trace_id) + "\"";
+    out += ",\"spanId\":\"" + hex(span.context.span_id) + "\"";
+    if (!isZero(span.parent_span_id)) {
+      out += ",\"parentSpanId\":\"" + hex(span.parent_span_id) + "\"";
+    }
+    out += ",\"name\":";
+    jsonString(out, span.name);
+    out += ",\"kind\":1";
+    out += ",\"startTimeUnixNano\":\"" + nanos(span.start) + "\"";
+    out += ",\"endTimeUnixNano\":\"" + nanos(span.end) + "\"";
+    out += ",\"attributes\":[";
+    for (size_t i{0}; i < span.attributes.size(); ++i) {
+      if (i != 0) {
+        out += ',';
+      }
+      jsonKeyValue(out, span.attributes[i].first, span.attributes[i].second);
+    }
+    out += "],\"status\":{\"code\":";
+    out += span.error ? "2" : "1";
+    out += "}}]}]}]}";
+    return out;
+  }
+
+  SpanContext current() {
+    return current_context;
+  }
+
+  SpanContext child(const SpanContext &parent) {
+    SpanContext context;
+    if (!enabled()) {
+      return context;
+    }
+    if (parent.valid()) {
+      context.trace_id = parent.trace_id;
+    } else {
+      randomBytes(context.trace_id);
+    }
+    do {
+      randomBytes(context.span_id);
+    } while (isZero(context.span_id));
+    return context;
+  }
+
+  void record(std::string name,
+              const SpanContext &context,
+              const SpanContext &parent,
+              Clock::time_point start,
+              Clock::time_point end,
+              Attributes attributes,
+              bool error) {
+    if (!context.valid()) {
+      return;
+    }
+    SpanData span{std::move(name),
+                  context,
+                  parent.valid() ? parent.span_id : decltype(parent.span_id){},
+                  toSystem(start),
+                  toSystem(end),
+                  std::move(attributes),
+                  error};
+    auto &s{state()};
+    std::shared_lock lock{s.mutex};
+    if (s.exporter) {
+      s.exporter(span);
+    }
+  }
+
+  Scope::Scope(const SpanContext &context) : previous_{current_context} {
+    current_context = context;
+  }
+
+  Scope::~Scope() {
+    current_context = previous_;
+  }
+
+  Span::Span(std::string name, const SpanContext &parent)
+      : context_{child(parent)} {
+    if (context_.valid()) {
+      parent_ = parent;
+      name_ = std::move(name);
+      start_ = Clock::now();
+      scope_.emplace(context_);
+    }
+  }
+
+  Span::~Span() {
+    if (context_.valid()) {
+      scope_.reset();
+      record(std::move(name_),
+             context_,
+             parent_,
+             start_,
+             Clock::now(),
+             std::move(attributes_),
+             error_);
+    }
+  }
+
+  void Span::attribute(std::string key, std::string value) {
+    if (context_.valid()) {
+      attributes_.emplace_back(std::move(key), std::move(value));
+    }
+  }
+
+  void Span::error() {
+    error_ = true;
+  }
+
+  const SpanContext &Span::context() const {
+    return context_;
+  }
+}  // namespace fc::common::tracing
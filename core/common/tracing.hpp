@@ -0,0 +1,117 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Span tracing with W3C trace context.
+ * Tracing is enabled by FC_TRACE_FILE environment variable, spans are
+ * appended there as OTLP json lines (OpenTelemetry collector
+ * "otlpjsonfile" receiver format), service name is FC_TRACE_SERVICE.
+ * When disabled spans are not created and cost one check.
+ */
+namespace fc::common::tracing {
+  using Clock = std::chrono::steady_clock;
+  using Attributes = std::vector<std::pair<std::string, std::string>>;
+
+  struct SpanContext {
+    std::array<uint8_t, 16> trace_id{};
+    std::array<uint8_t, 8> span_id{};
+
+    /// Has trace id, default constructed context is not valid
+    bool valid() const;
+
+    /// W3C "traceparent" header value, empty if not valid
+    std::string traceparent() const;
+
+    /// Parses "traceparent" header value, returns invalid context on error
+    static SpanContext fromTraceparent(std::string_view str);
+  };
+
+  struct SpanData {
+    std::string name;
+    SpanContext context;
+    std::array<uint8_t, 8> parent_span_id{};
+    std::chrono::system_clock::time_point start, end;
+    Attributes attributes;
+    bool error{};
+  };
+
+  using Exporter = std::function<void(const SpanData &)>;
+
+  /// Replaces exporter, nullptr disables tracing
+  void setExporter(Exporter exporter);
+
+  bool enabled();
+
+  /// Appends spans to file as OTLP json lines
+  Exporter fileExporter(const std::string &path, const std::string &service);
+
+  /// OTLP json of one span export request
+  std::string otlpJson(const SpanData &span, const std::string &service);
+
+  /// Context of innermost span or scope on this thread
+  SpanContext current();
+
+  /**
+   * New span context in trace of parent, or in new trace if parent is not
+   * valid. Returns invalid context when tracing is disabled.
+   */
+  SpanContext child(const SpanContext &parent);
+
+  /// Exports span measured elsewhere, e.g. queue wait
+  void record(std::string name,
+              const SpanContext &context,
+              const SpanContext &parent,
+              Clock::time_point start,
+              Clock::time_point end,
+              Attributes attributes = {},
+              bool error = false);
+
+  /// Makes context current on this thread until destroyed
+  class Scope {
+   public:
+    explicit Scope(const SpanContext &context);
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+    ~Scope();
+
+   private:
+    SpanContext previous_;
+  };
+
+  /// Span from construction to destruction, current on this thread
+  class Span {
+   public:
+    explicit Span(std::string name, const SpanContext &parent = current());
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+    ~Span();
+
+    void attribute(std::string key, std::string value);
+
+    /// Marks span status as error
+    void error();
+
+    const SpanContext &context() const;
+
+   private:
+    SpanContext context_;
+    SpanContext parent_;
+    std::string name_;
+    Clock::time_point start_;
+    Attributes attributes_;
+    bool error_{};
+    std::optional<Scope> scope_;
+  };
+}  // namespace fc::common::tracing
@@ -25,7 +25,9 @@ namespace fc {
   constexpr auto kPackingEfficiencyDenom{5};
   constexpr auto kPackingEfficiencyNum{4};
   constexpr auto kPropagationDelaySecs{6};
+  constexpr auto kTicketRandomnessLookback{1};
   constexpr auto kUpgradeSmokeHeight{51000};
+  constexpr auto kWinningPoStSectorSetLookback{10};
 
   extern BigInt kConsensusMinerMinPower;
 }  // namespace fc
@@ -5,21 +5,19 @@
 
 #include "crypto/blake2/blake2b160.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define FC_BLAKE2B_AVX2
+#endif
+
 #ifndef ROTR64
 #define ROTR64(x, y) (((x) >> (y)) ^ ((x) << (64 - (y))))
 #endif
 
-#define B2B_GET64(p)                                                        \
-  (((uint64_t)((uint8_t *)(p))[0]) ^ (((uint64_t)((uint8_t *)(p))[1]) << 8) \
-   ^ (((uint64_t)((uint8_t *)(p))[2]) << 16)                                \
-   ^ (((uint64_t)((uint8_t *)(p))[3]) << 24)                                \
-   ^ (((uint64_t)((uint8_t *)(p))[4]) << 32)                                \
-   ^ (((uint64_t)((uint8_t *)(p))[5]) << 40)                                \
-   ^ (((uint64_t)((uint8_t *)(p))[6]) << 48)                                \
-   ^ (((uint64_t)((uint8_t *)(p))[7]) << 56))
-
 #define B2B_G(a, b, c, d, x, y)     \
   {                                 \
     v[a] = v[a] + v[b] + (x);       \
@@ -32,8 +30,35 @@
     v[b] = ROTR64(v[b] ^ v[c], 63); \
   }
 
+#define B2B_ROUND(G, r)                                     \
+  {                                                         \
+    G(0, 4, 8, 12, m[sigma[r][0]], m[sigma[r][1]]);         \
+    G(1, 5, 9, 13, m[sigma[r][2]], m[sigma[r][3]]);         \
+    G(2, 6, 10, 14, m[sigma[r][4]], m[sigma[r][5]]);        \
+    G(3, 7, 11, 15, m[sigma[r][6]], m[sigma[r][7]]);        \
+    G(0, 5, 10, 15, m[sigma[r][8]], m[sigma[r][9]]);        \
+    G(1, 6, 11, 12, m[sigma[r][10]], m[sigma[r][11]]);      \
+    G(2, 7, 8, 13, m[sigma[r][12]], m[sigma[r][13]]);       \
+    G(3, 4, 9, 14, m[sigma[r][14]], m[sigma[r][15]]);       \
+  }
+
+/// Rounds are unrolled, so sigma indices are constants
+#define B2B_ROUNDS(G) \
+  B2B_ROUND(G, 0)     \
+  B2B_ROUND(G, 1)     \
+  B2B_ROUND(G, 2)     \
+  B2B_ROUND(G, 3)     \
+  B2B_ROUND(G, 4)     \
+  B2B_ROUND(G, 5)     \
+  B2B_ROUND(G, 6)     \
+  B2B_ROUND(G, 7)     \
+  B2B_ROUND(G, 8)     \
+  B2B_ROUND(G, 9)     \
+  B2B_ROUND(G, 10)    \
+  B2B_ROUND(G, 11)
+
 namespace fc::crypto::blake2b {
-  static const uint64_t iv[8]{
+  constexpr uint64_t iv[8]{
       0x6A09E667F3BCC908,
       0xBB67AE8584CAA73B,
       0x3C6EF372FE94F82B,
@@ -43,7 +68,7 @@ namespace fc::crypto::blake2b {
       0x1F83D9ABFB41BD6B,
       0x5BE0CD19137E2179,
   };
-  static const uint8_t sigma[12][16]{
+  constexpr uint8_t sigma[12][16]{
       {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
       {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
       {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
@@ -57,6 +82,21 @@ namespace fc::crypto::blake2b {
       {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
       {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
   };
+  /// Little-endian 64-bit word
+  inline uint64_t load64(const uint8_t *p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+#else
+    uint64_t w{};
+    for (auto i{0}; i < 8; ++i) {
+      w |= uint64_t{p[i]} << (8 * i);
+    }
+    return w;
+#endif
+  }
+
   Ctx::Ctx(size_t outlen, BytesIn key) : outlen{outlen} {
     assert(outlen > 0 && outlen <= 64);
     assert(key.size() >= 0 && key.size() <= 64);
@@ -68,7 +108,10 @@ namespace fc::crypto::blake2b {
     }
   }
   void Ctx::update(BytesIn in) {
-    for (auto i{0}; i < in.size(); ++i) {
+    auto data{in.data()};
+    size_t left = in.size();
+    while (left != 0) {
+      // last block is compressed by final
       if (c == 128) {
         t[0] += c;
         if (t[0] < c) {
@@ -77,7 +120,11 @@ namespace fc::crypto::blake2b {
         _compress(false);
         c = 0;
       }
-      b[c++] = in[i];
+      auto n{std::min(128 - c, left)};
+      memcpy(b + c, data, n);
+      c += n;
+      data += n;
+      left -= n;
     }
   }
   void Ctx::_compress(bool last) {
@@ -93,18 +140,9 @@ namespace fc::crypto::blake2b {
       v[14] = ~v[14];
     }
     for (auto i{0}; i < 16; ++i) {
-      m[i] = B2B_GET64(&b[8 * i]);
-    }
-    for (auto i{0}; i < 12; ++i) {
-      B2B_G(0, 4, 8, 12, m[sigma[i][0]], m[sigma[i][1]]);
-      B2B_G(1, 5, 9, 13, m[sigma[i][2]], m[sigma[i][3]]);
-      B2B_G(2, 6, 10, 14, m[sigma[i][4]], m[sigma[i][5]]);
-      B2B_G(3, 7, 11, 15, m[sigma[i][6]], m[sigma[i][7]]);
-      B2B_G(0, 5, 10, 15, m[sigma[i][8]], m[sigma[i][9]]);
-      B2B_G(1, 6, 11, 12, m[sigma[i][10]], m[sigma[i][11]]);
-      B2B_G(2, 7, 8, 13, m[sigma[i][12]], m[sigma[i][13]]);
-      B2B_G(3, 4, 9, 14, m[sigma[i][14]], m[sigma[i][15]]);
+      m[i] = load64(&b[8 * i]);
     }
+    B2B_ROUNDS(B2B_G)
     for (auto i{0}; i < 8; ++i) {
       h[i] ^= v[i] ^ v[i + 8];
     }
@@ -142,6 +180,152 @@ namespace fc::crypto::blake2b {
     return res;
   }
 
+#ifdef FC_BLAKE2B_AVX2
+#define B2B_ADD4 _mm256_add_epi64
+#define B2B_XOR4 _mm256_xor_si256
+#define B2B_ROTR4_32(x) _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1))
+#define B2B_ROTR4_24(x) _mm256_shuffle_epi8(x, rotr24)
+#define B2B_ROTR4_16(x) _mm256_shuffle_epi8(x, rotr16)
+#define B2B_ROTR4_63(x) \
+  _mm256_or_si256(_mm256_srli_epi64(x, 63), _mm256_add_epi64(x, x))
+
+#define B2B_G4(a, b, c, d, x, y)                          \
+  {                                                       \
+    v[a] = B2B_ADD4(B2B_ADD4(v[a], v[b]), (x));           \
+    v[d] = B2B_ROTR4_32(B2B_XOR4(v[d], v[a]));            \
+    v[c] = B2B_ADD4(v[c], v[d]);                          \
+    v[b] = B2B_ROTR4_24(B2B_XOR4(v[b], v[c]));            \
+    v[a] = B2B_ADD4(B2B_ADD4(v[a], v[b]), (y));           \
+    v[d] = B2B_ROTR4_16(B2B_XOR4(v[d], v[a]));            \
+    v[c] = B2B_ADD4(v[c], v[d]);                          \
+    v[b] = B2B_ROTR4_63(B2B_XOR4(v[b], v[c]));            \
+  }
+
+  /// Number of 128 byte blocks, empty input has one padding block
+  inline size_t blockCount(size_t size) {
+    return std::max<size_t>(1, (size + 127) / 128);
+  }
+
+  /**
+   * Hashes 4 inputs at once, one input per 64-bit lane. Lanes which inputs
+   * have less blocks keep their state until other lanes finish.
+   */
+  __attribute__((target("avx2"))) void hash4(const BytesIn *inputs,
+                                             Blake2b256Hash *hashes) {
+    const auto rotr24{_mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2,
+                                       11, 12, 13, 14, 15, 8, 9, 10,
+                                       3, 4, 5, 6, 7, 0, 1, 2,
+                                       11, 12, 13, 14, 15, 8, 9, 10)};
+    const auto rotr16{_mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1,
+                                       10, 11, 12, 13, 14, 15, 8, 9,
+                                       2, 3, 4, 5, 6, 7, 0, 1,
+                                       10, 11, 12, 13, 14, 15, 8, 9)};
+    size_t blocks[4];
+    size_t max_blocks{0};
+    for (auto l{0}; l < 4; ++l) {
+      blocks[l] = blockCount(inputs[l].size());
+      max_blocks = std::max(max_blocks, blocks[l]);
+    }
+    __m256i h[8];
+    for (auto i{0}; i < 8; ++i) {
+      h[i] = _mm256_set1_epi64x(iv[i]);
+    }
+    h[0] = B2B_XOR4(h[0],
+                    _mm256_set1_epi64x(0x01010000 ^ BLAKE2B256_HASH_LENGTH));
+    for (size_t j{0}; j < max_blocks; ++j) {
+      alignas(32) uint64_t words[16][4];
+      alignas(32) uint64_t counter[4];
+      alignas(32) uint64_t final[4];
+      alignas(32) uint64_t active[4];
+      for (auto l{0}; l < 4; ++l) {
+        uint8_t block[128]{};
+        auto size{static_cast<size_t>(inputs[l].size())};
+        auto offset{j * 128};
+        auto last{j + 1 == blocks[l]};
+        if (j < blocks[l] && offset < size) {
+          memcpy(block,
+                 inputs[l].data() + offset,
+                 std::min<size_t>(size - offset, 128));
+        }
+        for (auto i{0}; i < 16; ++i) {
+          words[i][l] = load64(block + 8 * i);
+        }
+        counter[l] = last ? size : offset + 128;
+        final[l] = last ? ~uint64_t{0} : 0;
+        active[l] = j < blocks[l] ? ~uint64_t{0} : 0;
+      }
+      __m256i m[16];
+      for (auto i{0}; i < 16; ++i) {
+        m[i] = _mm256_load_si256(reinterpret_cast<const __m256i *>(words[i]));
+      }
+      __m256i v[16];
+      for (auto i{0}; i < 8; ++i) {
+        v[i] = h[i];
+        v[i + 8] = _mm256_set1_epi64x(iv[i]);
+      }
+      v[12] = B2B_XOR4(
+          v[12], _mm256_load_si256(reinterpret_cast<const __m256i *>(counter)));
+      v[14] = B2B_XOR4(
+          v[14], _mm256_load_si256(reinterpret_cast<const __m256i *>(final)));
+      B2B_ROUNDS(B2B_G4)
+      auto mask{_mm256_load_si256(reinterpret_cast<const __m256i *>(active))};
+      for (auto i{0}; i < 8; ++i) {
+        h[i] = _mm256_blendv_epi8(
+            h[i], B2B_XOR4(h[i], B2B_XOR4(v[i], v[i + 8])), mask);
+      }
+    }
+    alignas(32) uint64_t out[8][4];
+    for (auto i{0}; i < 8; ++i) {
+      _mm256_store_si256(reinterpret_cast<__m256i *>(out[i]), h[i]);
+    }
+    for (auto l{0}; l < 4; ++l) {
+      for (auto i{0u}; i < BLAKE2B256_HASH_LENGTH; ++i) {
+        hashes[l][i] = (out[i >> 3][l] >> (8 * (i & 7))) & 0xFF;
+      }
+    }
+  }
+#endif
+
+  std::vector<Blake2b256Hash> blake2b_256_many(
+      gsl::span<const BytesIn> inputs) {
+    std::vector<Blake2b256Hash> hashes(inputs.size());
+    size_t i{0};
+#ifdef FC_BLAKE2B_AVX2
+    static const bool avx2{__builtin_cpu_supports("avx2") != 0};
+    if (avx2) {
+      // long inputs would keep other lanes idle
+      constexpr size_t kMaxLaneBlocks{8};
+      std::vector<size_t> small;
+      for (size_t j{0}; j < inputs.size(); ++j) {
+        if (blockCount(inputs[j].size()) <= kMaxLaneBlocks) {
+          small.push_back(j);
+        } else {
+          hashn(hashes[j], inputs[j]);
+        }
+      }
+      for (; i + 4 <= small.size(); i += 4) {
+        BytesIn lanes[4];
+        Blake2b256Hash lane_hashes[4];
+        for (auto l{0}; l < 4; ++l) {
+          lanes[l] = inputs[small[i + l]];
+        }
+        hash4(lanes, lane_hashes);
+        for (auto l{0}; l < 4; ++l) {
+          hashes[small[i + l]] = lane_hashes[l];
+        }
+      }
+      for (; i < small.size(); ++i) {
+        hashn(hashes[small[i]], inputs[small[i]]);
+      }
+      return hashes;
+    }
+#endif
+    for (; i < inputs.size(); ++i) {
+      hashn(hashes[i], inputs[i]);
+    }
+    return hashes;
+  }
+
   Blake2b512Hash blake2b_512_from_file(std::ifstream &file_stream) {
     if (!file_stream.is_open()) return {};
 
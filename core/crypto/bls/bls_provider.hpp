@@ -59,6 +59,34 @@ namespace fc::crypto::bls {
      */
     virtual outcome::result<Signature> aggregateSignatures(
         gsl::span<const Signature> signatures) const = 0;
+
+    /**
+     * @brief Verify aggregated BLS signature of several messages in one
+     * pairing batch
+     * @param messages - signed data, i-th message is signed with i-th key
+     * @param keys - BLS public keys
+     * @param signature - aggregated signature
+     * @return signature status or error code
+     */
+    virtual outcome::result<bool> verifyAggregateSignature(
+        gsl::span<const std::vector<uint8_t>> messages,
+        gsl::span<const PublicKey> keys,
+        const Signature &signature) const = 0;
+
+    /**
+     * @brief Verify several signatures at once. Each signature is checked on
+     * its own, batch is spread over threads. Unlike aggregate verification,
+     * invalid signatures which cancel each other in sum are rejected, so
+     * result is usable as validity of each message.
+     * @param messages - signed data, i-th message is signed with i-th key
+     * @param signatures - signatures of messages
+     * @param keys - BLS public keys
+     * @return status of each signature or error code
+     */
+    virtual outcome::result<std::vector<bool>> verifySignatures(
+        gsl::span<const std::vector<uint8_t>> messages,
+        gsl::span<const Signature> signatures,
+        gsl::span<const PublicKey> keys) const = 0;
   };
 }  // namespace fc::crypto::bls
 
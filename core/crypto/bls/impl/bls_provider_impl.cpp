@@ -6,6 +6,8 @@
 #include "crypto/bls/impl/bls_provider_impl.hpp"
 
 #include <filecoin-ffi/filcrypto.h>
+#include <future>
+#include <thread>
 
 #include "common/ffi.hpp"
 #include "common/span.hpp"
@@ -13,6 +15,9 @@
 namespace fc::crypto::bls {
   namespace ffi = common::ffi;
 
+  /// Signatures verified by one thread in batch
+  constexpr size_t kVerifyChunk{16};
+
   outcome::result<KeyPair> BlsProviderImpl::generateKeyPair() const {
     auto response{ffi::wrap(fil_private_key_generate(),
                             fil_destroy_private_key_generate_response)};
@@ -86,6 +91,81 @@ namespace fc::crypto::bls {
     }
     return ffi::array(response->signature.inner);
   }
+
+  outcome::result<bool> BlsProviderImpl::verifyAggregateSignature(
+      gsl::span<const std::vector<uint8_t>> messages,
+      gsl::span<const PublicKey> keys,
+      const Signature &signature) const {
+    if (messages.size() != keys.size()) {
+      return false;
+    }
+    if (messages.empty()) {
+      OUTCOME_TRY(empty, aggregateSignatures({}));
+      return signature == empty;
+    }
+    std::vector<uint8_t> digests;
+    digests.reserve(messages.size() * std::tuple_size_v<Digest>);
+    for (auto &message : messages) {
+      OUTCOME_TRY(digest, generateHash(message));
+      digests.insert(digests.end(), digest.begin(), digest.end());
+    }
+    return fil_verify(signature.data(),
+                      digests.data(),
+                      digests.size(),
+                      common::span::cast<const uint8_t>(keys).data(),
+                      keys.size_bytes())
+           > 0;
+  }
+
+  outcome::result<std::vector<bool>> BlsProviderImpl::verifySignatures(
+      gsl::span<const std::vector<uint8_t>> messages,
+      gsl::span<const Signature> signatures,
+      gsl::span<const PublicKey> keys) const {
+    if (messages.size() != keys.size()
+        || messages.size() != signatures.size()) {
+      return Errors::kSignatureVerificationFailed;
+    }
+    // aggregate of independent signatures is not checked, because
+    // invalid signatures can cancel each other in sum
+    std::vector<char> valid(messages.size(), false);
+    auto verify{[&](size_t begin, size_t end) -> outcome::result<void> {
+      for (auto i{begin}; i < end; ++i) {
+        OUTCOME_TRY(_valid,
+                    verifySignature(messages[i], signatures[i], keys[i]));
+        valid[i] = _valid;
+      }
+      return outcome::success();
+    }};
+    OUTCOME_TRY(parallel(messages.size(), verify));
+    return std::vector<bool>{valid.begin(), valid.end()};
+  }
+
+  outcome::result<void> BlsProviderImpl::parallel(
+      size_t count,
+      const std::function<outcome::result<void>(size_t, size_t)> &chunk) {
+    auto threads{std::min<size_t>(
+        std::max(1u, std::thread::hardware_concurrency()),
+        (count + kVerifyChunk - 1) / kVerifyChunk)};
+    if (threads <= 1) {
+      return chunk(0, count);
+    }
+    auto per_thread{(count + threads - 1) / threads};
+    std::vector<std::future<outcome::result<void>>> futures;
+    for (size_t begin{0}; begin < count; begin += per_thread) {
+      futures.push_back(std::async(std::launch::async,
+                                   chunk,
+                                   begin,
+                                   std::min(begin + per_thread, count)));
+    }
+    outcome::result<void> result{outcome::success()};
+    for (auto &future : futures) {
+      auto _result{future.get()};
+      if (!_result && result) {
+        result = _result.error();
+      }
+    }
+    return result;
+  }
 };  // namespace fc::crypto::bls
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::crypto::bls, Errors, e) {
@@ -6,6 +6,8 @@
 #ifndef CRYPTO_BLS_PROVIDER_IMPL_HPP
 #define CRYPTO_BLS_PROVIDER_IMPL_HPP
 
+#include <functional>
+
 #include "crypto/bls/bls_provider.hpp"
 
 namespace fc::crypto::bls {
@@ -26,7 +28,23 @@ namespace fc::crypto::bls {
     outcome::result<Signature> aggregateSignatures(
         gsl::span<const Signature> signatures) const override;
 
+    outcome::result<bool> verifyAggregateSignature(
+        gsl::span<const std::vector<uint8_t>> messages,
+        gsl::span<const PublicKey> keys,
+        const Signature &signature) const override;
+
+    outcome::result<std::vector<bool>> verifySignatures(
+        gsl::span<const std::vector<uint8_t>> messages,
+        gsl::span<const Signature> signatures,
+        gsl::span<const PublicKey> keys) const override;
+
    private:
+    /// Calls `chunk` for ranges of [0, count), on several threads for large
+    /// count
+    static outcome::result<void> parallel(
+        size_t count,
+        const std::function<outcome::result<void>(size_t, size_t)> &chunk);
+
     /**
      * @brief Generate BLS message digest
      * @param message - data for hashing
@@ -13,10 +13,11 @@
 
 namespace fc::crypto::secp256k1 {
 
-  Secp256k1ProviderImpl::Secp256k1ProviderImpl()
+  Secp256k1ProviderImpl::Secp256k1ProviderImpl(size_t recover_cache_size)
       : context_(secp256k1_context_create(SECP256K1_CONTEXT_SIGN
                                           | SECP256K1_CONTEXT_VERIFY),
-                 secp256k1_context_destroy) {}
+                 secp256k1_context_destroy),
+        recover_cache_{recover_cache_size} {}
 
   outcome::result<KeyPair> Secp256k1ProviderImpl::generate() const {
     PublicKeyUncompressed public_key{};
@@ -111,6 +112,19 @@ namespace fc::crypto::secp256k1 {
       const SignatureCompact &signature) const {
     OUTCOME_TRY(checkSignature(signature));
 
+    // only 32 byte digests are signed
+    boost::optional<RecoverKey> cache_key;
+    if (message.size() == 32) {
+      cache_key = RecoverKey{};
+      auto &key{*cache_key};
+      std::copy(message.begin(), message.end(), key.begin());
+      std::copy(signature.begin(), signature.end(), key.begin() + 32);
+      std::lock_guard lock{recover_cache_mutex_};
+      if (auto cached{recover_cache_.get(key)}) {
+        return *cached;
+      }
+    }
+
     secp256k1_ecdsa_recoverable_signature sig_rec;
     secp256k1_pubkey pubkey;
 
@@ -132,6 +146,10 @@ namespace fc::crypto::secp256k1 {
       return Secp256k1Error::kPubkeySerializationError;
     }
 
+    if (cache_key) {
+      std::lock_guard lock{recover_cache_mutex_};
+      recover_cache_.put(*cache_key, pubkey_out, 1);
+    }
     return pubkey_out;
   }
 
@@ -6,6 +6,10 @@
 #ifndef CPP_FILECOIN_CORE_CRYPTO_SECP256K1_SECP256K1_PROVIDER_RECOVER_HPP
 #define CPP_FILECOIN_CORE_CRYPTO_SECP256K1_SECP256K1_PROVIDER_RECOVER_HPP
 
+#include <cstring>
+#include <mutex>
+
+#include "common/lru_cache.hpp"
 #include "crypto/secp256k1/secp256k1_provider.hpp"
 #include "crypto/secp256k1/secp256k1_types.hpp"
 #include "secp256k1.h"
@@ -20,7 +24,16 @@ namespace fc::crypto::secp256k1 {
    */
   class Secp256k1ProviderImpl : public Secp256k1ProviderDefault {
    public:
-    Secp256k1ProviderImpl();
+    /// Recovered keys remembered by default
+    static constexpr size_t kRecoverCacheSize{1 << 15};
+
+    /**
+     * @param recover_cache_size - number of (digest, signature) pairs which
+     * recovered keys are remembered, e.g. message verified by mpool is not
+     * recovered again by block validation
+     */
+    explicit Secp256k1ProviderImpl(
+        size_t recover_cache_size = kRecoverCacheSize);
 
     outcome::result<KeyPair> generate() const override;
 
@@ -40,8 +53,23 @@ namespace fc::crypto::secp256k1 {
         const SignatureCompact &signature) const override;
 
    private:
+    /// Digest followed by signature
+    using RecoverKey = std::array<uint8_t, 32 + kSignatureLength>;
+    struct RecoverKeyHash {
+      size_t operator()(const RecoverKey &key) const {
+        // digest bytes are uniformly distributed
+        size_t hash;
+        memcpy(&hash, key.data(), sizeof(hash));
+        return hash;
+      }
+    };
+
     std::unique_ptr<secp256k1_context, void (*)(secp256k1_context *)> context_;
 
+    mutable std::mutex recover_cache_mutex_;
+    mutable common::LruCache<RecoverKey, PublicKeyUncompressed, RecoverKeyHash>
+        recover_cache_;
+
     outcome::result<void> checkSignature(
         const SignatureCompact &signature) const;
   };
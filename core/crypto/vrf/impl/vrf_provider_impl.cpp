@@ -38,4 +38,25 @@ namespace fc::crypto::vrf {
     }
     return res.value();
   }
+
+  outcome::result<std::vector<bool>> VRFProviderImpl::verifyVRFs(
+      gsl::span<const VRFVerifyRequest> requests) const {
+    std::vector<std::vector<uint8_t>> messages;
+    std::vector<bls::Signature> proofs;
+    std::vector<bls::PublicKey> keys;
+    messages.reserve(requests.size());
+    proofs.reserve(requests.size());
+    keys.reserve(requests.size());
+    for (const auto &request : requests) {
+      messages.emplace_back(request.message.begin(), request.message.end());
+      proofs.push_back(request.proof);
+      keys.push_back(request.public_key);
+    }
+    // not aggregate, proofs are randomness and must be valid one by one
+    auto &&res = bls_provider_->verifySignatures(messages, proofs, keys);
+    if (res.has_failure()) {
+      return VRFError::kVerificationFailed;
+    }
+    return res.value();
+  }
 }  // namespace fc::crypto::vrf
@@ -24,6 +24,9 @@ namespace fc::crypto::vrf {
                                     const VRFParams &message,
                                     const VRFProof &vrf_proof) const override;
 
+    outcome::result<std::vector<bool>> verifyVRFs(
+        gsl::span<const VRFVerifyRequest> requests) const override;
+
    private:
     std::shared_ptr<bls::BlsProvider> bls_provider_;
   };
@@ -40,6 +40,15 @@ namespace fc::crypto::vrf {
     virtual outcome::result<bool> verifyVRF(const VRFPublicKey &public_key,
                                             const VRFParams &params,
                                             const VRFProof &proof) const = 0;
+
+    /**
+     * @brief verifies several proofs (e.g. tickets and election proofs of
+     * tipset) at once, each proof on its own, spread over threads
+     * @param requests proofs with keys and messages
+     * @return status of each proof or error
+     */
+    virtual outcome::result<std::vector<bool>> verifyVRFs(
+        gsl::span<const VRFVerifyRequest> requests) const = 0;
   };
 
 }  // namespace fc::crypto::vrf
@@ -46,6 +46,16 @@ namespace fc::crypto::vrf {
     common::Buffer message;
   };
 
+  /**
+   * @brief vrf proof with key and signed message, e.g. randomness drawn for
+   * block ticket or election proof
+   */
+  struct VRFVerifyRequest {
+    VRFPublicKey public_key;
+    common::Buffer message;
+    VRFProof proof;
+  };
+
   /**
    * @brief VRF key pair definition
    */
@@ -5,9 +5,11 @@
 
 #include "data_transfer/dt.hpp"
 
+#include <boost/asio/io_context.hpp>
 #include <libp2p/host/host.hpp>
 
 #include "common/libp2p/cbor_stream.hpp"
+#include "common/logger.hpp"
 #include "common/ptr.hpp"
 #include "storage/ipld/traverser.hpp"
 
@@ -28,6 +30,60 @@ namespace fc::data_transfer {
   using common::libp2p::CborStream;
   using libp2p::protocol::Subscription;
   using storage::ipld::kAllSelector;
+  using storage::ipld::traverser::Traverser;
+
+  /// Blocks of pushed dag loaded ahead while previous blocks are sent
+  constexpr size_t kPushPrefetch{32};
+  /// Blocks of one push sent per turn, before other pushes
+  constexpr size_t kPushSlice{16};
+  /// Received blocks persisted together
+  constexpr size_t kCheckpointBlocks{64};
+  /// Restarts of received push after connection errors
+  constexpr size_t kMaxRestarts{5};
+
+  struct DataTransfer::Sending {
+    Sending(const PeerGsId &pgsid,
+            const PeerDtId &pdtid,
+            IpldPtr _ipld,
+            const CID &root,
+            const Selector &selector,
+            std::set<CID> skip)
+        : pgsid{pgsid},
+          pdtid{pdtid},
+          ipld{std::move(_ipld)},
+          skip{std::move(skip)},
+          traverser{*ipld, root, selector, kPushPrefetch} {}
+
+    PeerGsId pgsid;
+    PeerDtId pdtid;
+    IpldPtr ipld;
+    /// Blocks receiver already has
+    std::set<CID> skip;
+    Traverser traverser;
+  };
+
+  /// Errors after which transfer may continue from where it stopped
+  bool isRestartable(gsns::ResponseStatusCode code) {
+    switch (code) {
+      case gsns::ResponseStatusCode::RS_NO_PEERS:
+      case gsns::ResponseStatusCode::RS_CANNOT_CONNECT:
+      case gsns::ResponseStatusCode::RS_TIMEOUT:
+      case gsns::ResponseStatusCode::RS_CONNECTION_ERROR:
+      case gsns::ResponseStatusCode::RS_SLOW_STREAM:
+      case gsns::ResponseStatusCode::RS_TRY_AGAIN:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /// Peer, transfer id and chunk index, chunks of transfer are adjacent
+  Buffer checkpointKey(const PeerDtId &pdtid, size_t chunk) {
+    Buffer key{pdtid.peer.toVector()};
+    key.putUint64(pdtid.id);
+    key.putUint64(chunk);
+    return key;
+  }
 
   void _read(std::weak_ptr<DataTransfer> _dt, std::shared_ptr<CborStream> s) {
     if (_dt.expired()) {
@@ -50,10 +106,13 @@ namespace fc::data_transfer {
   }
 
   std::shared_ptr<DataTransfer> DataTransfer::make(
-      std::shared_ptr<Host> host, std::shared_ptr<Graphsync> gs) {
+      std::shared_ptr<Host> host,
+      std::shared_ptr<Graphsync> gs,
+      std::shared_ptr<boost::asio::io_context> io) {
     auto dt{std::make_shared<DataTransfer>()};
     dt->host = host;
     dt->gs = gs;
+    dt->io = io;
     gs->setRequestHandler(
         [_dt{weaken(dt)}](auto pgsid, auto req) {
           auto dt{_dt.lock()};
@@ -76,32 +135,38 @@ namespace fc::data_transfer {
             auto it{dt->pushing_out.find(pdtid)};
             if (it != dt->pushing_out.end()) {
               auto &push{it->second};
-              if (push.on_begin) {
+              auto restart{!push.on_begin};
+              if (!restart) {
                 push.on_begin(res.is_accepted);
                 push.on_begin = {};
-                if (res.is_accepted) {
-                  storage::ipld::traverser::Traverser t{
-                      *push.ipld, req.root_cid, CborRaw{req.selector}};
-                  gsns::Response res{
-                      gsns::ResponseStatusCode::RS_FULL_CONTENT, {}, {}};
-                  if (auto _cids{t.traverseAll()}) {
-                    auto ok{true};
-                    for (auto &cid : _cids.value()) {
-                      if (auto _data{push.ipld->get(cid)}) {
-                        res.data.push_back(
-                            {std::move(cid), std::move(_data.value())});
-                      } else {
-                        ok = false;
-                        break;
-                      }
-                    }
-                    if (ok) {
-                      return dt->gs->postResponse(pgsid, res);
-                    }
+              }
+              if (res.is_accepted) {
+                std::set<CID> skip;
+                if (auto _skip{gsns::Extension::find(
+                        gsns::kDontSendCidsProtocol, req.extensions)}) {
+                  if (auto cids{
+                          codec::cbor::decode<std::vector<CID>>(*_skip)}) {
+                    skip.insert(cids.value().begin(), cids.value().end());
                   }
-                  push.on_end(false);
                 }
-              } else {
+                if (restart) {
+                  // previous request of push is not answered anymore
+                  auto &q{dt->sending};
+                  q.erase(std::remove_if(
+                              q.begin(),
+                              q.end(),
+                              [&](auto &send) { return send->pdtid == pdtid; }),
+                          q.end());
+                }
+                return dt->sendPush(
+                    std::make_shared<Sending>(pgsid,
+                                              pdtid,
+                                              push.ipld,
+                                              req.root_cid,
+                                              CborRaw{req.selector},
+                                              std::move(skip)));
+              }
+              if (restart) {
                 push.on_end(false);
               }
               dt->pushing_out.erase(it);
@@ -150,23 +215,61 @@ namespace fc::data_transfer {
 
   void DataTransfer::acceptPush(const PeerDtId &pdtid,
                                 const CID &root,
-                                OkCb on_end) {
+                                OkCb on_end,
+                                OnCid on_cid) {
+    pushing_in[pdtid] = {
+        root, std::move(on_end), std::move(on_cid), loadCheckpoints(pdtid)};
+    requestPush(pdtid);
+  }
+
+  void DataTransfer::requestPush(const PeerDtId &pdtid) {
+    auto &in{pushing_in.at(pdtid)};
+    std::vector<gsns::Extension> extensions{makeExt(DataTransferResponse{
+        MessageType::kNewMessage,
+        true,
+        false,
+        pdtid.id,
+        {},
+        {},
+    })};
+    if (!in.received.empty()) {
+      extensions.push_back({std::string{gsns::kDontSendCidsProtocol},
+                            codec::cbor::encode(in.received).value()});
+    }
     auto sub{std::make_shared<Subscription>()};
     *sub = gs->makeRequest(
         pdtid.peer,
         {},
-        root,
+        in.root,
         kAllSelector.b,
-        {makeExt(DataTransferResponse{
-            MessageType::kNewMessage,
-            true,
-            false,
-            pdtid.id,
-            {},
-            {},
-        })},
-        [this, pdtid, MOVE(on_end), sub](auto code, auto) {
+        extensions,
+        [this, pdtid, sub](auto code, auto ext) {
+          auto it{pushing_in.find(pdtid)};
+          if (it == pushing_in.end()) {
+            return;
+          }
+          auto &in{it->second};
+          if (auto _ext{gsns::Extension::find(gsns::kResponseMetadataProtocol,
+                                              ext)}) {
+            OUTCOME_EXCEPT(meta,
+                           codec::cbor::decode<gsns::ResponseMetadata>(*_ext));
+            for (auto &p : meta) {
+              if (p.present) {
+                in.received.push_back(p.cid);
+                if (in.received.size() % kCheckpointBlocks == 0) {
+                  checkpoint(pdtid, in);
+                }
+                if (in.on_cid) {
+                  in.on_cid(p.cid);
+                }
+              }
+            }
+          }
           if (gsns::isTerminal(code)) {
+            if (isRestartable(code) && in.restarts < kMaxRestarts) {
+              ++in.restarts;
+              return requestPush(pdtid);
+            }
             auto ok{code == gsns::ResponseStatusCode::RS_FULL_CONTENT};
             if (ok) {
               dtSend(pdtid.peer,
@@ -179,11 +282,126 @@ namespace fc::data_transfer {
                          {},
                      });
             }
+            auto on_end{std::move(in.on_end)};
+            // progress is kept for later accept of same transfer
+            if (!isRestartable(code)) {
+              removeCheckpoints(pdtid, in.received.size());
+            }
+            pushing_in.erase(it);
             on_end(ok);
           }
         });
   }
 
+  void DataTransfer::checkpoint(const PeerDtId &pdtid, const PushingIn &in) {
+    if (!progress) {
+      return;
+    }
+    auto chunk{in.received.size() / kCheckpointBlocks - 1};
+    std::vector<CID> cids{in.received.begin() + chunk * kCheckpointBlocks,
+                          in.received.end()};
+    OUTCOME_EXCEPT(bytes, codec::cbor::encode(cids));
+    if (auto put{progress->put(checkpointKey(pdtid, chunk), bytes)}; !put) {
+      spdlog::warn("DataTransfer checkpoint: {}", put.error().message());
+    }
+  }
+
+  std::vector<CID> DataTransfer::loadCheckpoints(const PeerDtId &pdtid) {
+    std::vector<CID> received;
+    if (!progress) {
+      return received;
+    }
+    for (size_t chunk{0};; ++chunk) {
+      auto key{checkpointKey(pdtid, chunk)};
+      if (!progress->contains(key)) {
+        break;
+      }
+      auto bytes{progress->get(key)};
+      if (!bytes) {
+        break;
+      }
+      auto cids{codec::cbor::decode<std::vector<CID>>(bytes.value())};
+      if (!cids) {
+        break;
+      }
+      received.insert(received.end(), cids.value().begin(), cids.value().end());
+    }
+    return received;
+  }
+
+  void DataTransfer::removeCheckpoints(const PeerDtId &pdtid,
+                                       size_t received) {
+    if (!progress) {
+      return;
+    }
+    for (size_t chunk{0}; chunk < received / kCheckpointBlocks; ++chunk) {
+      std::ignore = progress->remove(checkpointKey(pdtid, chunk));
+    }
+  }
+
+  void DataTransfer::sendPush(std::shared_ptr<Sending> send) {
+    sending.push_back(std::move(send));
+    if (!sending_scheduled) {
+      sending_scheduled = true;
+      sendTurns();
+    }
+  }
+
+  void DataTransfer::sendTurns() {
+    do {
+      for (auto turns{sending.size()}; turns != 0; --turns) {
+        auto send{sending.front()};
+        sending.pop_front();
+        if (!sendSlice(*send)) {
+          sending.push_back(std::move(send));
+        }
+      }
+    } while (!io && !sending.empty());
+    if (sending.empty()) {
+      sending_scheduled = false;
+      return;
+    }
+    // let network and other handlers run between turns
+    io->post([_dt{weak_from_this()}] {
+      if (auto dt{_dt.lock()}) {
+        dt->sendTurns();
+      }
+    });
+  }
+
+  bool DataTransfer::sendSlice(Sending &send) {
+    auto &t{send.traverser};
+    // blocks are sent as loaded, not collected in memory
+    for (size_t sent{0}; sent < kPushSlice && !t.isCompleted();) {
+      auto _block{t.advanceBlock()};
+      if (!_block) {
+        auto it{pushing_out.find(send.pdtid)};
+        if (it != pushing_out.end()) {
+          it->second.on_end(false);
+          pushing_out.erase(it);
+        }
+        gs->postResponse(send.pgsid,
+                         {gsns::ResponseStatusCode::RS_REJECTED, {}, {}});
+        return true;
+      }
+      auto &block{_block.value()};
+      if (send.skip.count(block.cid) != 0) {
+        continue;
+      }
+      gs->postResponse(send.pgsid,
+                       {gsns::ResponseStatusCode::RS_PARTIAL_RESPONSE,
+                        {},
+                        {{std::move(block.cid), std::move(block.bytes)}}});
+      ++sent;
+    }
+    if (!t.isCompleted()) {
+      return false;
+    }
+    gs->postResponse(send.pgsid,
+                     {gsns::ResponseStatusCode::RS_FULL_CONTENT, {}, {}});
+    return true;
+  }
+
   void DataTransfer::rejectPush(const PeerDtId &pdtid) {
     dtSend(pdtid.peer,
            DataTransferResponse{
@@ -5,8 +5,11 @@
 
 #pragma once
 
+#include <deque>
+
 #include "data_transfer/message.hpp"
 #include "node/fwd.hpp"
+#include "storage/buffer_map.hpp"
 #include "storage/ipfs/graphsync/graphsync.hpp"
 
 namespace fc::data_transfer {
@@ -25,6 +28,7 @@ namespace fc::data_transfer {
 
   using gsns::Graphsync;
   using libp2p::Host;
+  using storage::PersistentBufferMap;
   using PeerGsId = gsns::FullRequestId;
 
   using DtId = uint64_t;
@@ -36,7 +40,13 @@ namespace fc::data_transfer {
     return l.peer == r.peer && l.id == r.id;
   }
 
-  struct DataTransfer {
+  /**
+   * Data transfer over graphsync.
+   * Received push is restarted on connection errors asking responder not to
+   * send already received blocks. Pushes being sent are interleaved, so
+   * concurrent transfers share outbound data fairly.
+   */
+  struct DataTransfer : std::enable_shared_from_this<DataTransfer> {
     static inline const std::string kProtocol{"/fil/datatransfer/1.0.0"};
     static inline const std::string kExtension{"fil/data-transfer"};
 
@@ -54,10 +64,28 @@ namespace fc::data_transfer {
       OkCb on_begin, on_end;
     };
 
+    struct PushingIn {
+      CID root;
+      OkCb on_end;
+      OnCid on_cid;
+      /// Received blocks, not sent again when request is restarted
+      std::vector<CID> received;
+      size_t restarts{};
+    };
+
+    /// Pushed dag being sent as graphsync response
+    struct Sending;
+
     static gsns::Extension makeExt(const DataTransferMessage &msg);
 
-    static std::shared_ptr<DataTransfer> make(std::shared_ptr<Host> host,
-                                              std::shared_ptr<Graphsync> gs);
+    /**
+     * @param io - if set, pushes are sent in slices posted to io, otherwise
+     * each push is sent at once
+     */
+    static std::shared_ptr<DataTransfer> make(
+        std::shared_ptr<Host> host,
+        std::shared_ptr<Graphsync> gs,
+        std::shared_ptr<boost::asio::io_context> io = nullptr);
 
     void push(const PeerInfo &peer,
               const CID &root,
@@ -66,7 +94,11 @@ namespace fc::data_transfer {
               Buffer voucher,
               OkCb on_begin,
               OkCb on_end);
-    void acceptPush(const PeerDtId &pdtid, const CID &root, OkCb on_end);
+    /// on_cid is called for blocks in order responder traversed them
+    void acceptPush(const PeerDtId &pdtid,
+                    const CID &root,
+                    OkCb on_end,
+                    OnCid on_cid = {});
     void rejectPush(const PeerDtId &pdtid);
     PeerDtId pull(const PeerInfo &peer,
                   const CID &root,
@@ -85,17 +117,36 @@ namespace fc::data_transfer {
                     std::string type,
                     boost::optional<CborRaw> voucher);
 
+    /// Issues graphsync request of accepted push, skipping received blocks
+    void requestPush(const PeerDtId &pdtid);
+    /// Persists full checkpoint chunks of received blocks
+    void checkpoint(const PeerDtId &pdtid, const PushingIn &in);
+    /// Loads persisted received blocks
+    std::vector<CID> loadCheckpoints(const PeerDtId &pdtid);
+    void removeCheckpoints(const PeerDtId &pdtid, size_t received);
+    void sendPush(std::shared_ptr<Sending> send);
+    /// Sends one slice of each queued push
+    void sendTurns();
+    /// @return true if push was sent or failed
+    bool sendSlice(Sending &send);
+
     void onMsg(const PeerId &peer, const DataTransferMessage &msg);
     void dtSend(const PeerId &peer, const DataTransferMessage &msg);
     void dtSend(const PeerInfo &peer, const DataTransferMessage &msg);
 
     std::shared_ptr<Host> host;
     std::shared_ptr<Graphsync> gs;
+    std::shared_ptr<boost::asio::io_context> io;
+    /// Received push progress, checkpoints survive restart if set
+    std::shared_ptr<PersistentBufferMap> progress;
     std::map<std::string, OnPush> on_push;
     std::map<std::string, OnPull> on_pull;
     std::unordered_map<PeerDtId, OnData> pulling_out;
     std::unordered_map<PeerDtId, OnData> pulling_in;
     std::unordered_map<PeerDtId, PushingOut> pushing_out;
+    std::unordered_map<PeerDtId, PushingIn> pushing_in;
+    std::deque<std::shared_ptr<Sending>> sending;
+    bool sending_scheduled{};
     DtId next_dtid;
   };
 }  // namespace fc::data_transfer
@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_CORE_DRAND_BEACONIZER_HPP
 #define CPP_FILECOIN_CORE_DRAND_BEACONIZER_HPP
 
+#include <gsl/span>
+
 #include "common/async.hpp"
 #include "drand/messages.hpp"
 #include "primitives/chain_epoch/chain_epoch.hpp"
@@ -24,6 +26,17 @@ namespace fc::drand {
     /// Verifies a beacon against the previous
     virtual outcome::result<void> verifyEntry(const BeaconEntry &current,
                                               const BeaconEntry &previous) = 0;
+
+    /// Verifies chain of beacons following previous, e.g. of synced block
+    virtual outcome::result<void> verifyEntries(
+        gsl::span<const BeaconEntry> entries, const BeaconEntry &previous) {
+      auto *prev{&previous};
+      for (auto &entry : entries) {
+        OUTCOME_TRY(verifyEntry(entry, *prev));
+        prev = &entry;
+      }
+      return outcome::success();
+    }
   };
 
   struct DrandSchedule {
@@ -5,6 +5,7 @@
 
 #include "drand/impl/beaconizer.hpp"
 
+#include <algorithm>
 #include <boost/random.hpp>
 #include <libp2p/common/byteutil.hpp>
 #include <libp2p/crypto/sha/sha256.hpp>
@@ -41,74 +42,159 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::drand, BeaconizerImpl::Error, e) {
 }
 
 namespace fc::drand {
+  namespace {
+    /// Message signed by drand for round
+    std::vector<uint8_t> beaconMessage(
+        Round round, gsl::span<const uint8_t> previous_signature) {
+      std::vector<uint8_t> buffer;
+      buffer.reserve(previous_signature.size() + sizeof(uint64_t));
+      buffer.insert(
+          buffer.end(), previous_signature.begin(), previous_signature.end());
+      libp2p::common::putUint64BE(buffer, round);
+      auto hash{libp2p::crypto::sha256(buffer)};
+      return {hash.begin(), hash.end()};
+    }
+
+    Buffer storeKey(Round round) {
+      Buffer key;
+      libp2p::common::putUint64BE(key, round);
+      return key;
+    }
+  }  // namespace
+
   BeaconizerImpl::BeaconizerImpl(std::shared_ptr<io_context> io,
                                  std::shared_ptr<UTCClock> clock,
                                  std::shared_ptr<Scheduler> scheduler,
                                  const ChainInfo &info,
                                  std::vector<std::string> drand_servers,
-                                 size_t max_cache_size)
+                                 size_t max_cache_size,
+                                 std::shared_ptr<BufferMap> store)
       : MOVE(io),
         MOVE(clock),
         MOVE(scheduler),
         info{info},
         peers_{drand_servers},
         cache_{max_cache_size},
+        store_{std::move(store)},
         bls_{std::make_unique<crypto::bls::BlsProviderImpl>()} {
     assert(!drand_servers.empty());
     assert(max_cache_size != 0);
-    rotatePeersIndex();
   }
 
   void BeaconizerImpl::entry(Round round, CbT<BeaconEntry> cb) {
     if (auto cached{lookupCache(round)}) {
       return cb(BeaconEntry{round, std::move(*cached)});
     }
-    auto fetch{[self{shared_from_this()}, round, MOVE(cb)]() {
-      http::getEntry(*self->io,
-                     self->peers_[self->peer_index_],
-                     round,
-                     [self, MOVE(cb), round](auto &&_res) {
-                       std::error_code error;
-                       if (!_res) {
-                         error = _res.error();
-                       } else {
-                         auto res{_res.value()};
-                         if (res.round != round) {
-                           error = Error::kInvalidBeacon;
-                         } else {
-                           BeaconEntry entry{round, Buffer{res.signature}};
-                           auto _valid{self->verifyEntry(
-                               entry, {round - 1, std::move(res.prev)})};
-                           if (!_valid) {
-                             error = _valid.error();
-                           } else {
-                             return cb(std::move(entry));
-                           }
-                         }
-                       }
-                       spdlog::error("drand host {} error {}",
-                                     self->peers_[self->peer_index_],
-                                     error);
-                       self->rotatePeersIndex();
-                       // TODO: retry
-                       return cb(error);
-                     });
-    }};
+    {
+      std::lock_guard lock{fetch_mutex_};
+      auto &cbs{fetching_[round]};
+      cbs.push_back(std::move(cb));
+      if (cbs.size() != 1) {
+        // already fetching
+        return;
+      }
+    }
     auto now{clock->nowUTC()};
     auto time{info.genesis + round * info.period};
     if (now < time) {
       scheduler
           ->schedule(libp2p::protocol::scheduler::toTicks(time - now),
-                     std::move(fetch))
+                     [self{shared_from_this()}, round] { self->fetch(round); })
           .detach();
     } else {
-      fetch();
+      fetch(round);
+    }
+  }
+
+  void BeaconizerImpl::fetch(Round round) {
+    struct Race {
+      size_t pending{};
+      bool done{};
+    };
+    auto race{std::make_shared<Race>()};
+    race->pending = peers_.size();
+    for (auto &peer : peers_) {
+      http::getEntry(
+          *io,
+          peer,
+          round,
+          [self{shared_from_this()}, race, round, peer](auto &&_res) {
+            outcome::result<BeaconEntry> entry{Error::kInvalidBeacon};
+            if (!_res) {
+              entry = _res.error();
+            } else if (_res.value().round == round) {
+              auto &res{_res.value()};
+              BeaconEntry _entry{round, Buffer{res.signature}};
+              auto valid{self->verifyEntry(
+                  _entry, {round - 1, std::move(res.prev)})};
+              if (valid) {
+                entry = std::move(_entry);
+              } else {
+                entry = valid.error();
+              }
+            }
+            {
+              std::lock_guard lock{self->fetch_mutex_};
+              if (race->done) {
+                return;
+              }
+              if (!entry) {
+                spdlog::error("drand host {} error {}", peer, entry.error());
+                // wait other peers
+                if (--race->pending != 0) {
+                  return;
+                }
+              }
+              race->done = true;
+            }
+            // TODO: retry
+            self->fetched(round, entry);
+          });
     }
   }
 
+  void BeaconizerImpl::fetched(Round round,
+                               const outcome::result<BeaconEntry> &entry) {
+    std::vector<CbT<BeaconEntry>> cbs;
+    {
+      std::lock_guard lock{fetch_mutex_};
+      auto it{fetching_.find(round)};
+      if (it == fetching_.end()) {
+        return;
+      }
+      cbs = std::move(it->second);
+      fetching_.erase(it);
+    }
+    for (auto &cb : cbs) {
+      cb(entry);
+    }
+  }
+
+  void BeaconizerImpl::prefetch(std::shared_ptr<DrandSchedule> schedule,
+                                ChainEpoch epoch) {
+    entry(schedule->maxRound(epoch),
+          [weak{weak_from_this()}, schedule, epoch](auto _entry) {
+            if (auto self{weak.lock()}) {
+              if (!_entry) {
+                spdlog::warn("drand prefetch epoch {} error {}",
+                             epoch,
+                             _entry.error());
+              }
+              self->prefetch(schedule, epoch + 1);
+            }
+          });
+  }
+
   outcome::result<void> BeaconizerImpl::verifyEntry(
       const BeaconEntry &current, const BeaconEntry &previous) {
-    if (0 == previous.round || lookupCache(current.round)) {
+    if (0 == previous.round) {
+      return outcome::success();
+    }
+    if (auto cached{lookupCache(current.round)}) {
+      // cached entry was verified, other data for round is forged
+      if (*cached != current.data) {
+        return Error::kInvalidBeacon;
+      }
       return outcome::success();
     }
     OUTCOME_TRY(is_valid,
@@ -120,45 +206,89 @@ namespace fc::drand {
     return outcome::success();
   }
 
+  outcome::result<void> BeaconizerImpl::verifyEntries(
+      gsl::span<const BeaconEntry> entries, const BeaconEntry &previous) {
+    std::vector<std::vector<uint8_t>> messages;
+    std::vector<crypto::bls::Signature> signatures;
+    std::vector<const BeaconEntry *> verified;
+    auto *prev{&previous};
+    for (auto &entry : entries) {
+      if (0 != prev->round) {
+        if (auto cached{lookupCache(entry.round)}) {
+          if (*cached != entry.data) {
+            return Error::kInvalidBeacon;
+          }
+        } else {
+          auto &signature{signatures.emplace_back()};
+          if (signature.size() != entry.data.size()) {
+            return Error::kInvalidSignatureFormat;
+          }
+          std::copy(entry.data.begin(), entry.data.end(), signature.begin());
+          messages.push_back(beaconMessage(entry.round, prev->data));
+          verified.push_back(&entry);
+        }
+      }
+      prev = &entry;
+    }
+    if (verified.empty()) {
+      return outcome::success();
+    }
+    // entries are independent, so each is verified on its own instead of
+    // aggregate where forged signatures could cancel each other
+    std::vector<crypto::bls::PublicKey> keys(messages.size(), info.key);
+    OUTCOME_TRY(valid, bls_->verifySignatures(messages, signatures, keys));
+    if (std::find(valid.begin(), valid.end(), false) != valid.end()) {
+      return Error::kInvalidBeacon;
+    }
+    for (auto entry : verified) {
+      cacheEntry(entry->round, entry->data);
+    }
+    return outcome::success();
+  }
+
   // private stuff goes below
 
   boost::optional<Buffer> BeaconizerImpl::lookupCache(Round round) {
     std::lock_guard<std::mutex> lock(cache_mutex_);
-    auto bytes = cache_.get(round);
-    return bytes;
+    if (auto bytes{cache_.get(round)}) {
+      return bytes;
+    }
+    if (store_) {
+      auto key{storeKey(round)};
+      if (store_->contains(key)) {
+        if (auto bytes{store_->get(key)}) {
+          cache_.insert(round, bytes.value());
+          return std::move(bytes.value());
+        }
+      }
+    }
+    return boost::none;
   }
 
   void BeaconizerImpl::cacheEntry(Round round, const Buffer &signature) {
     std::lock_guard<std::mutex> lock(cache_mutex_);
     cache_.insert(round, signature);
+    if (store_) {
+      auto stored{store_->put(storeKey(round), signature)};
+      if (!stored) {
+        spdlog::warn("drand store round {} error {}", round, stored.error());
+      }
+    }
   }
 
   outcome::result<bool> BeaconizerImpl::verifyBeaconData(
       uint64_t round,
       gsl::span<const uint8_t> signature,
       gsl::span<const uint8_t> previous_signature) {
-    auto message = [round, &previous_signature]() {
-      std::vector<uint8_t> buffer;
-      buffer.reserve(previous_signature.size() + sizeof(uint64_t));
-      buffer.insert(
-          buffer.end(), previous_signature.begin(), previous_signature.end());
-      libp2p::common::putUint64BE(buffer, round);
-      auto hash = libp2p::crypto::sha256(buffer);
-      return hash;
-    };
     crypto::bls::Signature bls_sig;
     if (bls_sig.size() != signature.size()) {
       return Error::kInvalidSignatureFormat;
     }
     std::copy(signature.begin(), signature.end(), bls_sig.begin());
-    OUTCOME_TRY(is_valid, bls_->verifySignature(message(), bls_sig, info.key));
+    OUTCOME_TRY(is_valid,
+                bls_->verifySignature(beaconMessage(round, previous_signature),
+                                      bls_sig,
+                                      info.key));
     return is_valid;
   }
-
-  void BeaconizerImpl::rotatePeersIndex() {
-    boost::random::mt19937 rng;
-    boost::random::uniform_int_distribution<> generator(0, peers_.size() - 1);
-    auto new_index = generator(rng);
-    peer_index_.store(new_index);
-  }
 }  // namespace fc::drand
@@ -6,11 +6,10 @@
 #ifndef CPP_FILECOIN_CORE_DRAND_IMPL_BEACONIZER_HPP
 #define CPP_FILECOIN_CORE_DRAND_IMPL_BEACONIZER_HPP
 
-#include <atomic>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include <boost/compute/detail/lru_cache.hpp>
@@ -18,11 +17,13 @@
 
 #include "drand/beaconizer.hpp"
 #include "node/fwd.hpp"
+#include "storage/buffer_map.hpp"
 
 namespace fc::drand {
   using boost::asio::io_context;
   using clock::UTCClock;
   using libp2p::protocol::Scheduler;
+  using storage::BufferMap;
 
   struct DrandScheduleImpl : DrandSchedule {
     DrandScheduleImpl(const ChainInfo &info,
@@ -53,18 +54,35 @@ namespace fc::drand {
       kNegativeEpoch,
     };
 
+    /**
+     * @param drand_servers - entries are requested from all servers, first
+     * valid response is used
+     * @param store - persistent cache of verified entries, optional
+     */
     BeaconizerImpl(std::shared_ptr<io_context> io,
                    std::shared_ptr<UTCClock> clock,
                    std::shared_ptr<Scheduler> scheduler,
                    const ChainInfo &info,
                    std::vector<std::string> drand_servers,
-                   size_t max_cache_size);
+                   size_t max_cache_size,
+                   std::shared_ptr<BufferMap> store = nullptr);
 
     void entry(Round round, CbT<BeaconEntry> cb) override;
 
     outcome::result<void> verifyEntry(const BeaconEntry &current,
                                       const BeaconEntry &previous) override;
 
+    /// Signatures of entries not cached yet are verified as one aggregate
+    outcome::result<void> verifyEntries(gsl::span<const BeaconEntry> entries,
+                                        const BeaconEntry &previous) override;
+
+    /**
+     * Fetches beacon of each epoch starting from given as soon as it is
+     * published, so it is cached when mining or validation asks for it.
+     * Stops when beaconizer is destroyed.
+     */
+    void prefetch(std::shared_ptr<DrandSchedule> schedule, ChainEpoch epoch);
+
    private:
     //
     // METHODS
@@ -79,7 +97,11 @@ namespace fc::drand {
         gsl::span<const uint8_t> signature,
         gsl::span<const uint8_t> previous_signature);
 
-    void rotatePeersIndex();
+    /// Requests entry from all peers
+    void fetch(Round round);
+
+    /// Calls callbacks waiting for round
+    void fetched(Round round, const outcome::result<BeaconEntry> &entry);
 
     //
     // FIELDS
@@ -91,11 +113,15 @@ namespace fc::drand {
 
     ChainInfo info;
 
-    std::atomic_size_t peer_index_;
     std::vector<std::string> peers_;
 
     std::mutex cache_mutex_;
     boost::compute::detail::lru_cache<Round, Buffer> cache_;
+    std::shared_ptr<BufferMap> store_;
+
+    /// Callbacks of rounds being fetched, one fetch serves all of them
+    std::mutex fetch_mutex_;
+    std::map<Round, std::vector<CbT<BeaconEntry>>> fetching_;
 
     std::unique_ptr<crypto::bls::BlsProvider> bls_;
   };
@@ -6,18 +6,22 @@
 #ifndef CPP_FILECOIN_CORE_FSM_FSM_HPP
 #define CPP_FILECOIN_CORE_FSM_FSM_HPP
 
+#include <atomic>
 #include <functional>
 #include <mutex>
-#include <queue>
 #include <set>
 #include <shared_mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/optional.hpp>
-#include <libp2p/protocol/common/asio/asio_scheduler.hpp>
 #include <libp2p/protocol/common/scheduler.hpp>
+#include "common/mpsc_queue.hpp"
 #include "common/outcome.hpp"
 #include "host/context/host_context.hpp"
 
@@ -33,8 +37,6 @@ namespace fc::fsm {
   using libp2p::protocol::Scheduler;
   using Ticks = libp2p::protocol::Scheduler::Ticks;
 
-  const Scheduler::Ticks kSlowModeDelayMs = 100;
-
   /**
    * Container for state transitions caused by an event
    *
@@ -259,25 +261,32 @@ namespace fc::fsm {
         StateEnumType /* transition destination state */)>;
 
     /**
-     * Creates a state machine
+     * Creates a state machine.
+     * Events are dispatched on io context of host context as soon as they
+     * are sent, without polling.
      * @param transition_rules - defines state transitions
-     * @param scheduler - libp2p Scheduler for async events processing
+     * @param context - host context for async events processing
+     * @param ticks - unused, kept for compatibility
+     * @param pool - if set, transitions and actions run on pool, events of
+     * one entity are processed in order and never concurrently
      */
     FSM(std::vector<TransitionRule> transition_rules,
         HostContext context,
-        Ticks ticks = 50)
+        [[maybe_unused]] Ticks ticks = 50,
+        std::shared_ptr<boost::asio::thread_pool> pool = nullptr)
         : running_{true},
-          delay_{kSlowModeDelayMs},
-          host_context_(std::move(context)) {
+          host_context_(std::move(context)),
+          alive_{std::make_shared<bool>(true)},
+          pool_{std::move(pool)} {
       initTransitions(std::move(transition_rules));
-      scheduler_ = std::make_shared<libp2p::protocol::AsioScheduler>(
-          *host_context_->getIoContext(),
-          libp2p::protocol::SchedulerConfig{ticks});
-      scheduler_handle_ = scheduler_->schedule(1000, [this] { onTimer(); });
     }
 
+    /// Waits for events being processed on pool
     ~FSM() {
       stop();
+      while (in_flight_ != 0) {
+        std::this_thread::yield();
+      }
     }
 
     /**
@@ -321,9 +330,17 @@ namespace fc::fsm {
       if (not running_) {
         return FsmError::kMachineStopped;
       }
-      std::lock_guard lock(event_queue_mutex_);
-      event_queue_.emplace(entity_ptr,
-                           std::make_pair(event, std::move(event_context)));
+      event_queue_.push({entity_ptr, {event, event_context}});
+      // after push, so wakeup which missed event is followed by another one
+      if (wakeup_posted_.exchange(true)) {
+        return outcome::success();
+      }
+      boost::asio::post(*host_context_->getIoContext(),
+                        [this, alive{std::weak_ptr<bool>{alive_}}] {
+                          if (alive.lock()) {
+                            onWakeup();
+                          }
+                        });
       return outcome::success();
     }
 
@@ -363,7 +380,7 @@ namespace fc::fsm {
     /// Prevent further events processing
     void stop() {
       running_ = false;
-      scheduler_handle_.cancel();
+      alive_.reset();
     }
 
     /// Is events processing still enabled
@@ -398,23 +415,42 @@ namespace fc::fsm {
       }
     }
 
-    /// async events processor routine
-    void onTimer() {
-      EventQueueItem event_pair;
-      if (not running_) {
+    /// dispatches all queued events
+    void onWakeup() {
+      wakeup_posted_ = false;
+      while (running_) {
+        auto event{event_queue_.pop()};
+        if (not event) {
+          break;
+        }
+        dispatch(std::move(*event));
+      }
+    }
+
+    /// processes event inline or on strand of entity
+    void dispatch(EventQueueItem event) {
+      if (not pool_) {
+        processEvent(event);
         return;
       }
-      {
-        std::lock_guard lock(event_queue_mutex_);
-        if (event_queue_.empty()) {
-          scheduler_handle_.reschedule(kSlowModeDelayMs);
-          return;
-        }
-        scheduler_handle_.reschedule(0);
-        event_pair = event_queue_.front();
-        event_queue_.pop();
+      auto strand{strands_.find(event.first)};
+      if (strand == strands_.end()) {
+        strand = strands_
+                     .emplace(event.first,
+                              boost::asio::make_strand(pool_->get_executor()))
+                     .first;
       }
+      ++in_flight_;
+      boost::asio::post(strand->second, [this, event{std::move(event)}] {
+        if (running_) {
+          processEvent(event);
+        }
+        --in_flight_;
+      });
+    }
 
+    /// applies transition for event
+    void processEvent(const EventQueueItem &event_pair) {
       StateEnumType source_state;
       {
         std::shared_lock lock(states_mutex_);
@@ -449,14 +485,23 @@ namespace fc::fsm {
       }
     }
 
-    bool running_;            ///< FSM is enabled to process events
-    Scheduler::Ticks delay_;  ///< minimum async loop delay
+    std::atomic_bool running_;  ///< FSM is enabled to process events
 
-    std::mutex event_queue_mutex_;
-    std::queue<EventQueueItem> event_queue_;
-    std::shared_ptr<Scheduler> scheduler_;
-    Scheduler::Handle scheduler_handle_;
+    common::MpscQueue<EventQueueItem> event_queue_;
+    /// dispatching of queued events is posted to io context
+    std::atomic_bool wakeup_posted_{false};
     HostContext host_context_;
+    /// expires when machine is stopped, guards posted wakeups
+    std::shared_ptr<bool> alive_;
+
+    std::shared_ptr<boost::asio::thread_pool> pool_;
+    /// orders events of entity on pool, used on io context only
+    std::unordered_map<
+        EntityPtr,
+        boost::asio::strand<boost::asio::thread_pool::executor_type>>
+        strands_;
+    /// events posted to pool and not processed yet
+    std::atomic_size_t in_flight_{0};
 
     /// a dispatching list of events and what to do on event
     std::unordered_map<EventEnumType, TransitionRule> transitions_;
@@ -5,46 +5,148 @@
 
 #include "markets/discovery/discovery.hpp"
 #include "codec/cbor/cbor.hpp"
-#include "common/libp2p/peer/cbor_peer_info.hpp"
 
 namespace fc::markets::discovery {
+  /// Min keys bloom filter is sized for
+  constexpr size_t kMinBloomCapacity{1024};
 
-  Discovery::Discovery(std::shared_ptr<Datastore> datastore)
-      : datastore_{std::move(datastore)} {}
+  Discovery::Discovery(std::shared_ptr<Datastore> datastore,
+                       size_t bloom_bits_per_key)
+      : datastore_{std::move(datastore)},
+        bloom_bits_per_key_{bloom_bits_per_key},
+        bloom_{kMinBloomCapacity, bloom_bits_per_key} {
+    rebuildIndex();
+  }
 
   outcome::result<void> Discovery::addPeer(const CID &cid,
                                            const PeerInfo &peer) {
     OUTCOME_TRY(cid_bytes, cid.toBytes());
     Buffer cid_key{cid_bytes};
-    std::vector<PeerInfo> peers;
-
-    if (datastore_->contains(cid_key)) {
-      OUTCOME_TRY(stored_peers_cbored, datastore_->get(cid_key));
-      OUTCOME_TRYA(
-          peers,
-          codec::cbor::decode<std::vector<PeerInfo>>(stored_peers_cbored));
+    std::unique_lock lock{mutex_};
+    OUTCOME_TRY(offers, load(cid_key));
+    for (const auto &offer : offers) {
       // if already present
-      if (std::find(peers.begin(), peers.end(), peer) != peers.end()) {
+      if (offer.peer == peer) {
         return outcome::success();
       }
     }
-    peers.push_back(peer);
-    OUTCOME_TRY(peers_cbored, codec::cbor::encode(peers));
-    OUTCOME_TRY(datastore_->put(cid_key, peers_cbored));
+    offers.push_back(ProviderOffer{peer, 0, 0});
+    OUTCOME_TRY(offers_cbored, codec::cbor::encode(offers));
+    OUTCOME_TRY(datastore_->put(cid_key, offers_cbored));
+    if (offers.size() == 1) {
+      index(cid_key);
+    }
     return outcome::success();
   }
 
   outcome::result<std::vector<PeerInfo>> Discovery::getPeers(
       const CID &cid) const {
+    OUTCOME_TRY(offers, getOffers(cid));
+    std::vector<PeerInfo> peers;
+    peers.reserve(offers.size());
+    for (auto &offer : offers) {
+      peers.push_back(std::move(offer.peer));
+    }
+    return std::move(peers);
+  }
+
+  outcome::result<std::vector<ProviderOffer>> Discovery::getOffers(
+      const CID &cid) const {
+    OUTCOME_TRY(cid_bytes, cid.toBytes());
+    std::shared_lock lock{mutex_};
+    if (!bloom_.mayContain(cid_bytes)) {
+      return std::vector<ProviderOffer>{};
+    }
+    return load(Buffer{cid_bytes});
+  }
+
+  outcome::result<void> Discovery::putOffer(const CID &cid,
+                                            const ProviderOffer &offer) {
     OUTCOME_TRY(cid_bytes, cid.toBytes());
     Buffer cid_key{cid_bytes};
+    std::unique_lock lock{mutex_};
+    OUTCOME_TRY(offers, load(cid_key));
+    auto it{std::find_if(offers.begin(), offers.end(), [&](auto &other) {
+      return other.peer.id == offer.peer.id;
+    })};
+    if (it != offers.end()) {
+      *it = offer;
+    } else {
+      offers.push_back(offer);
+    }
+    OUTCOME_TRY(offers_cbored, codec::cbor::encode(offers));
+    OUTCOME_TRY(datastore_->put(cid_key, offers_cbored));
+    if (offers.size() == 1) {
+      index(cid_key);
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Discovery::refresh(uint64_t now,
+                                           uint64_t max_age,
+                                           const QueryProvider &query) {
+    std::vector<std::pair<CID, ProviderOffer>> stale;
+    {
+      std::shared_lock lock{mutex_};
+      auto cursor{datastore_->cursor()};
+      for (cursor->seekToFirst(); cursor->isValid(); cursor->next()) {
+        OUTCOME_TRY(cid, CID::fromBytes(cursor->key()));
+        OUTCOME_TRY(offers,
+                    codec::cbor::decode<std::vector<ProviderOffer>>(
+                        cursor->value()));
+        for (auto &offer : offers) {
+          if (offer.last_seen + max_age <= now) {
+            stale.emplace_back(cid, std::move(offer));
+          }
+        }
+      }
+    }
+    // callbacks may be called synchronously, so lock is released before
+    for (auto &[cid, offer] : stale) {
+      query(cid,
+            offer.peer,
+            [this, cid{cid}, offer{offer}, now](auto _price) mutable {
+              if (_price) {
+                offer.price_per_byte = std::move(_price.value());
+                offer.last_seen = now;
+                // offer is refreshed again on next refresh if put fails
+                std::ignore = putOffer(cid, offer);
+              }
+            });
+    }
+    return outcome::success();
+  }
+
+  outcome::result<std::vector<ProviderOffer>> Discovery::load(
+      const Buffer &cid_key) const {
     if (!datastore_->contains(cid_key)) {
-      return std::vector<PeerInfo>{};
+      return std::vector<ProviderOffer>{};
     }
-    OUTCOME_TRY(peers_cbored, datastore_->get(cid_key));
-    OUTCOME_TRY(peers,
-                codec::cbor::decode<std::vector<PeerInfo>>(peers_cbored));
-    return std::move(peers);
+    OUTCOME_TRY(offers_cbored, datastore_->get(cid_key));
+    return codec::cbor::decode<std::vector<ProviderOffer>>(offers_cbored);
+  }
+
+  void Discovery::index(const Buffer &cid_key) {
+    if (bloom_keys_ >= bloom_capacity_) {
+      return rebuildIndex();
+    }
+    bloom_.insert(cid_key);
+    ++bloom_keys_;
+  }
+
+  void Discovery::rebuildIndex() {
+    std::vector<Buffer> keys;
+    auto cursor{datastore_->cursor()};
+    for (cursor->seekToFirst(); cursor->isValid(); cursor->next()) {
+      keys.push_back(cursor->key());
+    }
+    // grows twice, so rebuilds are amortized
+    bloom_capacity_ = std::max(kMinBloomCapacity, keys.size() * 2);
+    bloom_ = common::BloomFilter{bloom_capacity_, bloom_bits_per_key_};
+    for (const auto &key : keys) {
+      bloom_.insert(key);
+    }
+    bloom_keys_ = keys.size();
   }
 
 }  // namespace fc::markets::discovery
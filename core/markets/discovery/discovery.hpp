@@ -7,25 +7,66 @@
 #define CPP_FILECOIN_CORE_MARKETS_DISCOVERY_DISCOVERY_HPP
 
 #include <libp2p/peer/peer_info.hpp>
+#include <shared_mutex>
+#include "codec/cbor/streams_annotation.hpp"
+#include "common/bloom_filter.hpp"
 #include "common/buffer.hpp"
+#include "common/libp2p/peer/cbor_peer_info.hpp"
 #include "common/outcome.hpp"
 #include "primitives/cid/cid.hpp"
+#include "primitives/types.hpp"
 #include "storage/face/persistent_map.hpp"
 
 namespace fc::markets::discovery {
 
   using common::Buffer;
   using libp2p::peer::PeerInfo;
+  using primitives::TokenAmount;
   using Datastore = fc::storage::face::PersistentMap<Buffer, Buffer>;
 
+  /// Provider of payload with retrieval terms from last query
+  struct ProviderOffer {
+    PeerInfo peer;
+    /// Min price per byte, zero if provider wasn't queried yet
+    TokenAmount price_per_byte;
+    /// Unix time of last successful query, zero if provider wasn't queried
+    uint64_t last_seen{};
+  };
+  CBOR_TUPLE(ProviderOffer, peer, price_per_byte, last_seen)
+}  // namespace fc::markets::discovery
+
+namespace fc::codec::cbor {
+  template <>
+  inline markets::discovery::ProviderOffer
+  kDefaultT<markets::discovery::ProviderOffer>() {
+    return {kDefaultT<PeerInfo>(), {}, {}};
+  }
+}  // namespace fc::codec::cbor
+
+namespace fc::markets::discovery {
+
   /**
    * Storage/retrieval markets peer resolver.
    * Storage market adds peers on deal by payload root cid. Later, retrieval
    * market can find provider peer by payload cid interested in.
+   * Offers are persisted by payload cid, keys are also kept in memory bloom
+   * filter, so lookups of unknown payload don't touch datastore. Offers are
+   * refreshed in background, lookups never query providers.
    */
   class Discovery {
    public:
-    explicit Discovery(std::shared_ptr<Datastore> datastore);
+    /// Queries provider for payload, callback gets min price per byte
+    using QueryProvider = std::function<void(
+        const CID &,
+        const PeerInfo &,
+        std::function<void(outcome::result<TokenAmount>)>)>;
+
+    /**
+     * Loads keys of datastore into bloom filter
+     * @param bloom_bits_per_key - bloom filter bits per payload cid
+     */
+    explicit Discovery(std::shared_ptr<Datastore> datastore,
+                       size_t bloom_bits_per_key = 10);
 
     /**
      * Add peer
@@ -42,8 +83,41 @@ namespace fc::markets::discovery {
      */
     outcome::result<std::vector<PeerInfo>> getPeers(const CID &cid) const;
 
+    /// Get offers of providers by payload root cid
+    outcome::result<std::vector<ProviderOffer>> getOffers(
+        const CID &cid) const;
+
+    /// Add or replace offer of provider
+    outcome::result<void> putOffer(const CID &cid, const ProviderOffer &offer);
+
+    /**
+     * Queries providers which offers were seen before now - max_age.
+     * Offers are updated when query callbacks are called, failed providers
+     * keep old offer and are queried again on next refresh.
+     * @param now - current unix time
+     */
+    outcome::result<void> refresh(uint64_t now,
+                                  uint64_t max_age,
+                                  const QueryProvider &query);
+
    private:
+    /// Reads offers, must be called with mutex_
+    outcome::result<std::vector<ProviderOffer>> load(
+        const Buffer &cid_key) const;
+
+    /// Adds key to bloom filter, rebuilds it when it is full
+    void index(const Buffer &cid_key);
+
+    void rebuildIndex();
+
     std::shared_ptr<Datastore> datastore_;
+    size_t bloom_bits_per_key_;
+
+    mutable std::shared_mutex mutex_;
+    common::BloomFilter bloom_;
+    /// Keys the bloom filter was sized for
+    size_t bloom_capacity_{};
+    size_t bloom_keys_{};
   };
 
 }  // namespace fc::markets::discovery
@@ -0,0 +1,179 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "markets/pieceio/piece_commitment_stream.hpp"
+
+#include <unistd.h>
+
+#include "proofs/proofs.hpp"
+
+namespace fc::markets::pieceio {
+  using primitives::piece::PieceData;
+  using proofs::Proofs;
+
+  namespace {
+    /// Writes all bytes to fd, returns false on error
+    bool writeAll(int fd, const uint8_t *data, uint64_t size) {
+      uint64_t written = 0;
+      while (written < size) {
+        auto n = ::write(fd, data + written, size - written);
+        if (n <= 0) {
+          return false;
+        }
+        written += n;
+      }
+      return true;
+    }
+  }  // namespace
+
+  PieceCommitmentStream::PieceCommitmentStream(RegisteredProof registered_proof,
+                                               UnpaddedPieceSize padded_size,
+                                               std::string path)
+      : registered_proof_{registered_proof},
+        padded_size_{padded_size},
+        path_{std::move(path)} {
+    if (!path_.empty()) {
+      file_.open(path_, std::ios::binary | std::ios::trunc);
+      if (!file_.good()) {
+        result_ = PieceIOError::kCannotWriteFile;
+        return;
+      }
+    }
+    int fds[2];
+    if (pipe(fds) < 0) {
+      result_ = PieceIOError::kCannotCreatePipe;
+      return;
+    }
+    writer_ = std::thread{[this, fd{fds[1]}] { writeLoop(fd); }};
+    hasher_ = std::thread{[this, fd{fds[0]}] { hashLoop(fd); }};
+  }
+
+  PieceCommitmentStream::~PieceCommitmentStream() {
+    {
+      std::lock_guard lock{mutex_};
+      if (!closed_) {
+        cancelled_ = true;
+      }
+    }
+    cv_.notify_all();
+    // hasher joins writer
+    if (hasher_.joinable()) {
+      hasher_.join();
+    }
+  }
+
+  void PieceCommitmentStream::write(Buffer data) {
+    {
+      std::lock_guard lock{mutex_};
+      if (closed_) {
+        return;
+      }
+      size_ += data.size();
+      queue_.push_back(std::move(data));
+    }
+    cv_.notify_one();
+  }
+
+  void PieceCommitmentStream::finish(OnCommitment cb) {
+    std::unique_lock lock{mutex_};
+    closed_ = true;
+    if (result_) {
+      auto result{std::move(*result_)};
+      lock.unlock();
+      return cb(std::move(result));
+    }
+    on_commitment_ = std::move(cb);
+    lock.unlock();
+    cv_.notify_one();
+  }
+
+  uint64_t PieceCommitmentStream::size() const {
+    std::lock_guard lock{mutex_};
+    return size_;
+  }
+
+  void PieceCommitmentStream::writeLoop(int pipe_fd) {
+    uint64_t written{0};
+    boost::optional<PieceIOError> error;
+    bool cancelled{false};
+    while (true) {
+      Buffer chunk;
+      {
+        std::unique_lock lock{mutex_};
+        cv_.wait(lock,
+                 [&] { return !queue_.empty() || closed_ || cancelled_; });
+        if (cancelled_) {
+          cancelled = true;
+          break;
+        }
+        if (queue_.empty()) {
+          break;
+        }
+        chunk = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      if (written + chunk.size() > padded_size_) {
+        error = PieceIOError::kPieceTooLarge;
+        break;
+      }
+      if (file_.is_open()) {
+        file_.write(reinterpret_cast<const char *>(chunk.data()),
+                    chunk.size());
+        if (!file_.good()) {
+          error = PieceIOError::kCannotWriteFile;
+          break;
+        }
+      }
+      if (!writeAll(pipe_fd, chunk.data(), chunk.size())) {
+        error = PieceIOError::kCannotWritePipe;
+        break;
+      }
+      written += chunk.size();
+    }
+    file_.close();
+    if (!error && !cancelled) {
+      static const std::vector<uint8_t> zeros(64 << 10, 0);
+      while (written < padded_size_) {
+        auto n{std::min<uint64_t>(zeros.size(), padded_size_ - written)};
+        if (!writeAll(pipe_fd, zeros.data(), n)) {
+          error = PieceIOError::kCannotWritePipe;
+          break;
+        }
+        written += n;
+      }
+    }
+    close(pipe_fd);
+    std::lock_guard lock{mutex_};
+    error_ = error;
+  }
+
+  void PieceCommitmentStream::hashLoop(int pipe_fd) {
+    PieceData piece{pipe_fd};
+    auto commitment{
+        Proofs::generatePieceCID(registered_proof_, piece, padded_size_)};
+    // drain unread data, so writer doesn't block
+    char drain[4096];
+    while (read(piece.getFd(), drain, sizeof(drain)) > 0) {
+    }
+    writer_.join();
+
+    std::unique_lock lock{mutex_};
+    outcome::result<Commitment> result{PieceIOError::kCannotWritePipe};
+    if (error_) {
+      result = *error_;
+    } else if (!commitment) {
+      result = commitment.error();
+    } else {
+      result = Commitment{commitment.value(), padded_size_};
+    }
+    if (!on_commitment_) {
+      result_ = std::move(result);
+      return;
+    }
+    auto cb{std::move(on_commitment_)};
+    lock.unlock();
+    cb(std::move(result));
+  }
+}  // namespace fc::markets::pieceio
@@ -0,0 +1,88 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "common/buffer.hpp"
+#include "common/outcome.hpp"
+#include "markets/pieceio/pieceio_error.hpp"
+#include "primitives/cid/cid.hpp"
+#include "primitives/piece/piece.hpp"
+#include "primitives/sector/sector.hpp"
+
+namespace fc::markets::pieceio {
+  using common::Buffer;
+  using primitives::piece::UnpaddedPieceSize;
+  using primitives::sector::RegisteredProof;
+
+  /**
+   * Computes piece commitment of data written in chunks as it arrives (e.g.
+   * car bytes of received blocks), and optionally saves data to file. Writes
+   * are queued and don't block, data is saved and hashed on own threads, so
+   * commitment is ready soon after last chunk without second read of file.
+   */
+  class PieceCommitmentStream {
+   public:
+    using Commitment = std::pair<CID, UnpaddedPieceSize>;
+    using OnCommitment = std::function<void(outcome::result<Commitment>)>;
+
+    /**
+     * @param padded_size - unpadded size of piece, data is followed by zeros
+     * up to it
+     * @param path - file to save data to, empty if data is only hashed
+     */
+    PieceCommitmentStream(RegisteredProof registered_proof,
+                          UnpaddedPieceSize padded_size,
+                          std::string path);
+
+    /// Cancels hashing if finish wasn't called and waits for threads
+    ~PieceCommitmentStream();
+
+    PieceCommitmentStream(const PieceCommitmentStream &) = delete;
+    PieceCommitmentStream &operator=(const PieceCommitmentStream &) = delete;
+
+    /// Queues data chunk
+    void write(Buffer data);
+
+    /// Ends data, cb is called on hashing thread with commitment
+    void finish(OnCommitment cb);
+
+    /// Bytes written so far
+    uint64_t size() const;
+
+   private:
+    /// Saves queued chunks to file and pipe, then pads pipe with zeros
+    void writeLoop(int pipe_fd);
+
+    void hashLoop(int pipe_fd);
+
+    RegisteredProof registered_proof_;
+    UnpaddedPieceSize padded_size_;
+    std::string path_;
+    std::ofstream file_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Buffer> queue_;
+    uint64_t size_{};
+    bool closed_{false};
+    bool cancelled_{false};
+    /// Data didn't fit or couldn't be saved
+    boost::optional<PieceIOError> error_;
+    /// Commitment computed before finish was called, e.g. error
+    boost::optional<outcome::result<Commitment>> result_;
+    OnCommitment on_commitment_;
+
+    std::thread writer_;
+    std::thread hasher_;
+  };
+}  // namespace fc::markets::pieceio
@@ -0,0 +1,116 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "markets/pieceio/piece_reader.hpp"
+
+#include <unistd.h>
+#include <set>
+
+#include "markets/pieceio/pieceio_error.hpp"
+#include "storage/car/car.hpp"
+#include "storage/ipld/traverser.hpp"
+
+namespace fc::markets::pieceio {
+  using common::Buffer;
+  using fc::storage::ipld::traverser::Traverser;
+
+  namespace {
+    /// Blocks loaded ahead while previous blocks are written to pipe
+    constexpr size_t kReadPrefetch{16};
+
+    /// Writes all bytes to fd, returns false on error
+    bool writeAll(int fd, const uint8_t *data, uint64_t size) {
+      uint64_t written = 0;
+      while (written < size) {
+        auto n = ::write(fd, data + written, size - written);
+        if (n <= 0) {
+          return false;
+        }
+        written += n;
+      }
+      return true;
+    }
+
+    /// Writes car and zeros up to padded size, stops on error or overflow
+    void writePiece(int fd,
+                    Ipld &ipld,
+                    const CID &payload_cid,
+                    const Selector &selector,
+                    uint64_t padded_size) {
+      uint64_t written{0};
+      auto put{[&](const Buffer &bytes) {
+        if (written + bytes.size() > padded_size
+            || !writeAll(fd, bytes.data(), bytes.size())) {
+          return false;
+        }
+        written += bytes.size();
+        return true;
+      }};
+      Buffer header;
+      fc::storage::car::writeHeader(header, {payload_cid});
+      if (!put(header)) {
+        return;
+      }
+      std::set<CID> cids;
+      Traverser traverser{ipld, payload_cid, selector, kReadPrefetch};
+      while (!traverser.isCompleted()) {
+        auto _block{traverser.advanceBlock()};
+        if (!_block) {
+          return;
+        }
+        auto &block{_block.value()};
+        if (!cids.insert(block.cid).second) {
+          continue;
+        }
+        Buffer item;
+        fc::storage::car::writeItem(item, block.cid, block.bytes);
+        if (!put(item)) {
+          return;
+        }
+      }
+      static const Buffer zeros(64 << 10, 0);
+      while (written < padded_size) {
+        auto n{std::min<uint64_t>(zeros.size(), padded_size - written)};
+        if (!writeAll(fd, zeros.data(), n)) {
+          return;
+        }
+        written += n;
+      }
+    }
+  }  // namespace
+
+  outcome::result<std::unique_ptr<PieceReader>> PieceReader::make(
+      std::shared_ptr<Ipld> ipld,
+      const CID &payload_cid,
+      const Selector &selector,
+      UnpaddedPieceSize padded_size) {
+    int fds[2];
+    if (pipe(fds) < 0) {
+      return PieceIOError::kCannotCreatePipe;
+    }
+    std::unique_ptr<PieceReader> reader{new PieceReader{fds[0]}};
+    auto fd{fds[1]};
+    reader->writer_ = std::thread{
+        [ipld{std::move(ipld)}, payload_cid, selector, padded_size, fd] {
+          writePiece(fd, *ipld, payload_cid, selector, padded_size);
+          // short piece fails reader
+          close(fd);
+        }};
+    return reader;
+  }
+
+  PieceReader::PieceReader(int read_fd) : read_fd_{read_fd}, data_{read_fd_} {}
+
+  PieceReader::~PieceReader() {
+    char drain[4096];
+    while (read(data_.getFd(), drain, sizeof(drain)) > 0) {
+    }
+    writer_.join();
+  }
+
+  const PieceData &PieceReader::data() const {
+    return data_;
+  }
+}  // namespace fc::markets::pieceio
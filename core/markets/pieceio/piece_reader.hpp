@@ -0,0 +1,49 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <thread>
+
+#include "primitives/piece/piece.hpp"
+#include "primitives/piece/piece_data.hpp"
+#include "storage/ipfs/datastore.hpp"
+#include "storage/ipld/selector.hpp"
+
+namespace fc::markets::pieceio {
+  using fc::storage::ipld::Selector;
+  using primitives::piece::PieceData;
+  using primitives::piece::UnpaddedPieceSize;
+  using Ipld = fc::storage::ipfs::IpfsDatastore;
+
+  /**
+   * Piece data read from pipe, writer thread streams car of payload from
+   * store followed by zeros up to padded size. Piece is added to sector
+   * straight from store, without staging car file.
+   */
+  class PieceReader {
+   public:
+    static outcome::result<std::unique_ptr<PieceReader>> make(
+        std::shared_ptr<Ipld> ipld,
+        const CID &payload_cid,
+        const Selector &selector,
+        UnpaddedPieceSize padded_size);
+
+    /// Drains unread data, so writer doesn't block, and joins writer
+    ~PieceReader();
+
+    PieceReader(const PieceReader &) = delete;
+    PieceReader &operator=(const PieceReader &) = delete;
+
+    const PieceData &data() const;
+
+   private:
+    explicit PieceReader(int read_fd);
+
+    int read_fd_;
+    PieceData data_;
+    std::thread writer_;
+  };
+}  // namespace fc::markets::pieceio
@@ -16,6 +16,10 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::markets::pieceio, PieceIOError, e) {
       return "PieceIOError: cannot close pipe";
     case PieceIOError::kFileNotExist:
       return "PieceIOError: file doesn't exist";
+    case PieceIOError::kPieceTooLarge:
+      return "PieceIOError: data exceeds piece size";
+    case PieceIOError::kCannotWriteFile:
+      return "PieceIOError: cannot write file";
     default:
       return "Unknown error";
   }
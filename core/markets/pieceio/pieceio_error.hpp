@@ -15,6 +15,8 @@ namespace fc::markets::pieceio {
     kCannotWritePipe,
     kCannotClosePipe,
     kFileNotExist,
+    kPieceTooLarge,
+    kCannotWriteFile,
   };
 
 }
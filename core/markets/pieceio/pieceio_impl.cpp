@@ -7,6 +7,8 @@
 
 #include <unistd.h>
 #include <boost/filesystem.hpp>
+#include <fstream>
+#include <thread>
 #include "markets/pieceio/pieceio_error.hpp"
 #include "proofs/proofs.hpp"
 #include "storage/car/car.hpp"
@@ -47,27 +49,69 @@ namespace fc::markets::pieceio {
     return {commitment, padded_size};
   }
 
+  namespace {
+      /**
+     * Hashes data written by write to pipe, followed by zeros up to padded
+     * size. Data is read once, without temporary copy.
+     */
+    template <typename F>
+    outcome::result<CID> pieceCidFromPipe(const RegisteredProof &registered_proof,
+                                          UnpaddedPieceSize padded_size,
+                                          const F &write_data) {
+      int fds[2];
+      if (pipe(fds) < 0) {
+        return PieceIOError::kCannotCreatePipe;
+      }
+      auto write_fd = fds[1];
+      std::thread writer([&] {
+        uint64_t written = write_data(write_fd);
+        static const std::vector<uint8_t> zeros(64 << 10, 0);
+        while (written < padded_size) {
+          auto n = ::write(
+              write_fd,
+              zeros.data(),
+              std::min<uint64_t>(zeros.size(), padded_size - written));
+          if (n <= 0) {
+            break;
+          }
+          written += n;
+        }
+        close(write_fd);
+      });
+      PieceData piece{fds[0]};
+      auto commitment =
+          Proofs::generatePieceCID(registered_proof, piece, padded_size);
+      // drain unread data, so writer doesn't block
+      char drain[4096];
+      while (read(piece.getFd(), drain, sizeof(drain)) > 0) {
+      }
+      writer.join();
+      return commitment;
+    }
+
+    /// Writes all bytes to fd, returns number of bytes written
+    uint64_t writeAll(int fd, const uint8_t *data, uint64_t size) {
+      uint64_t written = 0;
+      while (written < size) {
+        auto n = ::write(fd, data + written, size - written);
+        if (n <= 0) {
+          break;
+        }
+        written += n;
+      }
+      return written;
+    }
+  }  // namespace
+
   outcome::result<std::pair<CID, UnpaddedPieceSize>>
   PieceIOImpl::generatePieceCommitment(const RegisteredProof &registered_proof,
                                        const Buffer &piece) {
     UnpaddedPieceSize padded_size = paddedSize(piece.size());
 
-    int fds[2];
-    if (pipe(fds) < 0) {
-      return PieceIOError::kCannotCreatePipe;
-    }
-    std::vector<uint8_t> data = piece.toVector();
-    data.resize(padded_size, 0);
-    if (write(fds[1], data.data(), padded_size) == -1) {
-      return PieceIOError::kCannotCreatePipe;
-    }
-    if (close(fds[1]) == -1) {
-      return PieceIOError::kCannotClosePipe;
-    }
-
     OUTCOME_TRY(commitment,
-                Proofs::generatePieceCID(
-                    registered_proof, PieceData{fds[0]}, padded_size));
+                pieceCidFromPipe(registered_proof, padded_size, [&](int fd) {
+                  return writeAll(fd, piece.data(), piece.size());
+                }));
 
     return {commitment, padded_size};
   }
@@ -81,18 +125,24 @@ namespace fc::markets::pieceio {
     uint64_t original_size = fs::file_size(path);
     UnpaddedPieceSize padded_size = paddedSize(original_size);
 
-    auto copy_path = fs::path(temp_dir_) / fs::unique_path();
-
-    fs::copy_file(path, copy_path);
-
-    auto _ = gsl::finally([&copy_path]() { fs::remove_all(copy_path); });
-
-    fs::resize_file(copy_path, padded_size);
-
-    OUTCOME_TRY(
-        commitment,
-        Proofs::generatePieceCID(
-            registered_proof, PieceData(copy_path.string()), padded_size));
+    // file is streamed with padding instead of padded copy
+    OUTCOME_TRY(commitment,
+                pieceCidFromPipe(registered_proof, padded_size, [&](int fd) {
+                  std::ifstream file{path, std::ios::binary};
+                  std::vector<uint8_t> buffer(1 << 20);
+                  uint64_t written = 0;
+                  while (written < original_size && file) {
+                    file.read(reinterpret_cast<char *>(buffer.data()),
+                              std::min<uint64_t>(buffer.size(),
+                                                 original_size - written));
+                    auto n = static_cast<uint64_t>(file.gcount());
+                    if (n == 0 || writeAll(fd, buffer.data(), n) != n) {
+                      break;
+                    }
+                    written += n;
+                  }
+                  return written;
+                }));
 
     return {commitment, padded_size};
   }
@@ -28,6 +28,10 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::markets::retrieval::client,
       return "RetrievalClient: too much money requested for bytes sent";
     case RetrievalClientError::kBlockCidParseError:
       return "RetrievalClient: block cid parse error";
+    case RetrievalClientError::kStalled:
+      return "RetrievalClient: provider stalled";
+    case RetrievalClientError::kNoProviders:
+      return "RetrievalClient: no providers";
     default:
       return "RetrievalClient: unknown error";
   }
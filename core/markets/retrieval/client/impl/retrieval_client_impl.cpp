@@ -14,11 +14,13 @@ namespace fc::markets::retrieval::client {
       std::shared_ptr<Host> host,
       std::shared_ptr<DataTransfer> datatransfer,
       std::shared_ptr<Api> api,
-      std::shared_ptr<IpfsDatastore> ipfs)
+      std::shared_ptr<IpfsDatastore> ipfs,
+      std::shared_ptr<boost::asio::io_context> io)
       : host_{std::move(host)},
         datatransfer_{std::move(datatransfer)},
         api_{std::move(api)},
-        ipfs_{std::move(ipfs)} {}
+        ipfs_{std::move(ipfs)},
+        io_{std::move(io)} {}
 
   outcome::result<std::vector<PeerInfo>> RetrievalClientImpl::findProviders(
       const CID &piece_cid) const {
@@ -77,6 +79,82 @@ namespace fc::markets::retrieval::client {
                                      const Address &miner_wallet,
                                      const TokenAmount &total_funds,
                                      const RetrieveResponseHandler &handler) {
+    startDeal(payload_cid,
+              deal_params,
+              provider_peer,
+              client_wallet,
+              miner_wallet,
+              total_funds,
+              handler);
+  }
+
+  void RetrievalClientImpl::retrieveAny(
+      const CID &payload_cid,
+      const DealProposalParams &deal_params,
+      const std::vector<RetrievalPeer> &providers,
+      const Address &client_wallet,
+      const RetrieveResponseHandler &handler) {
+    tryNextProvider(std::make_shared<AnyRetrieval>(AnyRetrieval{
+        payload_cid, deal_params, providers, client_wallet, handler}));
+  }
+
+  void RetrievalClientImpl::tryNextProvider(
+      const std::shared_ptr<AnyRetrieval> &any) {
+    if (any->next >= any->providers.size()) {
+      return any->handler(any->error);
+    }
+    const auto &provider{any->providers[any->next++]};
+    auto deal{startDeal(
+        any->payload_cid,
+        any->deal_params,
+        provider.peer,
+        any->client_wallet,
+        provider.miner_wallet,
+        provider.total_funds,
+        [this, any, peer{provider.peer}](outcome::result<void> res) {
+          if (res) {
+            return any->handler(res);
+          }
+          logger_->warn("retrieval from {} failed: {}",
+                        peerInfoToPrettyString(peer),
+                        res.error().message());
+          any->error = res.error();
+          tryNextProvider(any);
+        })};
+    if (io_) {
+      deal->stall_timer = std::make_unique<boost::asio::steady_timer>(*io_);
+      checkStalled(deal);
+    }
+  }
+
+  void RetrievalClientImpl::checkStalled(
+      const std::shared_ptr<DealState> &deal) {
+    auto deadline{deal->last_progress + kRetrievalStallTimeout};
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return failDeal(deal, RetrievalClientError::kStalled);
+    }
+    deal->stall_timer->expires_at(deadline);
+    deal->stall_timer->async_wait(
+        [this, _deal{std::weak_ptr{deal}}](auto ec) {
+          if (ec) {
+            return;
+          }
+          if (auto deal{_deal.lock()}) {
+            if (!deal->done) {
+              checkStalled(deal);
+            }
+          }
+        });
+  }
+
+  std::shared_ptr<DealState> RetrievalClientImpl::startDeal(
+      const CID &payload_cid,
+      const DealProposalParams &deal_params,
+      const PeerInfo &provider_peer,
+      const Address &client_wallet,
+      const Address &miner_wallet,
+      const TokenAmount &total_funds,
+      const RetrieveResponseHandler &handler) {
     DealProposal::Named proposal{{.payload_cid = payload_cid,
                                   .deal_id = next_deal_id++,
                                   .params = deal_params}};
@@ -89,6 +167,10 @@ namespace fc::markets::retrieval::client {
         DealProposal::Named::type,
         codec::cbor::encode(proposal).value(),
         [this, deal](auto &type, auto _voucher) {
+          if (deal->done) {
+            return;
+          }
+          deal->last_progress = std::chrono::steady_clock::now();
           OUTCOME_EXCEPT(res,
                          codec::cbor::decode<DealResponse::Named>(_voucher));
           if (!deal->accepted) {
@@ -96,7 +178,7 @@ namespace fc::markets::retrieval::client {
             deal->accepted =
                 unseal || res.status == DealStatus::kDealStatusAccepted;
             if (!deal->accepted) {
-              deal->handler(
+              deal->finish(
                   res.status == DealStatus::kDealStatusRejected
                       ? RetrievalClientError::kResponseDealRejected
                       : res.status == DealStatus::kDealStatusDealNotFound
@@ -108,18 +190,18 @@ namespace fc::markets::retrieval::client {
             auto _paych{api_->PaychGet(
                 deal->client_wallet, deal->miner_wallet, deal->total_funds)};
             if (!_paych) {
-              return deal->handler(_paych.error());
+              return failDeal(deal, _paych.error());
             }
             auto &paych{_paych.value().channel};
             deal->payment_channel_address = paych;
             auto _lane{api_->PaychAllocateLane(paych)};
             if (!_lane) {
-              return deal->handler(_lane.error());
+              return failDeal(deal, _lane.error());
             }
             deal->lane_id = _lane.value();
           }
           if (res.status == DealStatus::kDealStatusCompleted) {
-            deal->handler(outcome::success());
+            deal->finish(outcome::success());
             datatransfer_->pulling_out.erase(deal->pdtid);
             return;
           }
@@ -128,6 +210,10 @@ namespace fc::markets::retrieval::client {
           }
         },
         [this, deal](auto &cid) {
+          if (deal->done) {
+            return;
+          }
+          deal->last_progress = std::chrono::steady_clock::now();
           if (auto _data{ipfs_->get(cid)}) {
             if (auto _done{
                     deal->verifier.verifyNextBlock(cid, _data.value())}) {
@@ -144,6 +230,7 @@ namespace fc::markets::retrieval::client {
             failDeal(deal, _data.error());
           }
         });
+    return deal;
   }
 
   void RetrievalClientImpl::processPaymentRequest(
@@ -183,7 +270,7 @@ namespace fc::markets::retrieval::client {
   void RetrievalClientImpl::failDeal(
       const std::shared_ptr<DealState> &deal_state,
       const std::error_code &error) {
-    deal_state->handler(error);
+    deal_state->finish(error);
     datatransfer_->pulling_out.erase(deal_state->pdtid);
   }
 
@@ -6,6 +6,9 @@
 #ifndef CPP_FILECOIN_CORE_MARKETS_RETRIEVAL_CLIENT_IMPL_HPP
 #define CPP_FILECOIN_CORE_MARKETS_RETRIEVAL_CLIENT_IMPL_HPP
 
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
 #include <memory>
 
 #include <libp2p/host/host.hpp>
@@ -30,6 +33,9 @@ namespace fc::markets::retrieval::client {
   using primitives::BigInt;
   using vm::actor::builtin::v0::payment_channel::LaneId;
 
+  /// Provider which sent nothing for this time is abandoned by retrieveAny
+  constexpr std::chrono::seconds kRetrievalStallTimeout{60};
+
   /**
    * State of ongoing retrieval deal.
    */
@@ -45,7 +51,16 @@ namespace fc::markets::retrieval::client {
           client_wallet{client_wallet},
           miner_wallet{miner_wallet},
           total_funds(total_funds),
-          verifier{proposal.payload_cid, proposal.params.selector} {}
+          verifier{proposal.payload_cid, proposal.params.selector},
+          last_progress{std::chrono::steady_clock::now()} {}
+
+    /// Calls handler once, later results of failed deal are ignored
+    void finish(outcome::result<void> res) {
+      if (!done) {
+        done = true;
+        handler(res);
+      }
+    }
 
     DealProposal proposal;
     State state;
@@ -68,6 +83,14 @@ namespace fc::markets::retrieval::client {
      * Received ipld blocks verifier
      */
     Verifier verifier;
+
+    bool done{};
+
+    /** Time of last received block or response, for stall detection */
+    std::chrono::steady_clock::time_point last_progress;
+
+    /** Stall check timer, set by retrieveAny */
+    std::unique_ptr<boost::asio::steady_timer> stall_timer;
   };
 
   class RetrievalClientImpl
@@ -78,11 +101,14 @@ namespace fc::markets::retrieval::client {
      * @brief Constructor
      * @param host - libp2p network backend
      * @param IpfsDatastore - ipfs datastore
+     * @param io - context for stall timers of retrieveAny, without it
+     * providers are switched only on errors
      */
     RetrievalClientImpl(std::shared_ptr<Host> host,
                         std::shared_ptr<DataTransfer> datatransfer,
                         std::shared_ptr<Api> api,
-                        std::shared_ptr<IpfsDatastore> ipfs);
+                        std::shared_ptr<IpfsDatastore> ipfs,
+                        std::shared_ptr<boost::asio::io_context> io = nullptr);
 
     outcome::result<std::vector<PeerInfo>> findProviders(
         const CID &piece_cid) const override;
@@ -99,7 +125,36 @@ namespace fc::markets::retrieval::client {
                   const TokenAmount &total_funds,
                   const RetrieveResponseHandler &handler) override;
 
+    void retrieveAny(const CID &payload_cid,
+                     const DealProposalParams &deal_params,
+                     const std::vector<RetrievalPeer> &providers,
+                     const Address &client_wallet,
+                     const RetrieveResponseHandler &handler) override;
+
    private:
+    struct AnyRetrieval {
+      CID payload_cid;
+      DealProposalParams deal_params;
+      std::vector<RetrievalPeer> providers;
+      Address client_wallet;
+      RetrieveResponseHandler handler;
+      size_t next{};
+      std::error_code error{RetrievalClientError::kNoProviders};
+    };
+
+    std::shared_ptr<DealState> startDeal(
+        const CID &payload_cid,
+        const DealProposalParams &deal_params,
+        const PeerInfo &provider_peer,
+        const Address &client_wallet,
+        const Address &miner_wallet,
+        const TokenAmount &total_funds,
+        const RetrieveResponseHandler &handler);
+
+    void tryNextProvider(const std::shared_ptr<AnyRetrieval> &any);
+
+    void checkStalled(const std::shared_ptr<DealState> &deal);
+
     void closeQueryStream(const std::shared_ptr<CborStream> &stream,
                           const QueryResponseHandler &handler);
 
@@ -114,6 +169,7 @@ namespace fc::markets::retrieval::client {
     std::shared_ptr<DataTransfer> datatransfer_;
     std::shared_ptr<Api> api_;
     std::shared_ptr<IpfsDatastore> ipfs_;
+    std::shared_ptr<boost::asio::io_context> io_;
     common::Logger logger_ = common::createLogger("RetrievalMarketClient");
   };
 
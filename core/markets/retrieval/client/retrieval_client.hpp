@@ -21,6 +21,15 @@ namespace fc::markets::retrieval::client {
       std::function<void(outcome::result<QueryResponse>)>;
   using RetrieveResponseHandler = std::function<void(outcome::result<void>)>;
 
+  /// Provider of payload for multi-provider retrieval
+  struct RetrievalPeer {
+    PeerInfo peer;
+    /// Miner wallet to pay to, each provider gets own payment channel
+    Address miner_wallet;
+    /// Funds for deal with this provider
+    TokenAmount total_funds;
+  };
+
   /*
    * @class Retrieval market client
    */
@@ -66,6 +75,21 @@ namespace fc::markets::retrieval::client {
                           const Address &miner_wallet,
                           const TokenAmount &total_funds,
                           const RetrieveResponseHandler &handler) = 0;
+
+    /**
+     * @brief Retrieve payload from one of providers. Providers are tried in
+     * order, next one is tried when deal fails or provider stalls
+     * @param payload_cid - identifier of the data to retrieve
+     * @param deal_params - deal properties
+     * @param providers - providers with payload, e.g. from discovery
+     * @param client_wallet - client wallet to send funds for deal from
+     * @param handler - called with last error if all providers failed
+     */
+    virtual void retrieveAny(const CID &payload_cid,
+                             const DealProposalParams &deal_params,
+                             const std::vector<RetrievalPeer> &providers,
+                             const Address &client_wallet,
+                             const RetrieveResponseHandler &handler) = 0;
   };
 
 }  // namespace fc::markets::retrieval::client
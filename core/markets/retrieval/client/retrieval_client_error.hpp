@@ -22,6 +22,8 @@ namespace fc::markets::retrieval::client {
     kBadPaymentRequestBytesNotReceived,
     kBadPaymentRequestTooMuch,
     kBlockCidParseError,
+    kStalled,
+    kNoProviders,
   };
 
 }  // namespace fc::markets::retrieval::client
@@ -5,10 +5,11 @@
 
 #include "markets/retrieval/provider/impl/retrieval_provider_impl.hpp"
 
+#include <boost/asio/post.hpp>
 #include <boost/filesystem.hpp>
 #include "common/libp2p/peer/peer_info_helper.hpp"
 #include "markets/common.hpp"
-#include "storage/car/car.hpp"
+#include "storage/car/indexed_car.hpp"
 #include "storage/piece/impl/piece_storage_error.hpp"
 
 #define _SELF_IF_ERROR_RESPOND_AND_RETURN(res, expr, status, stream)        \
@@ -33,7 +34,8 @@ namespace fc::markets::retrieval::provider {
       std::shared_ptr<Ipld> ipld,
       const ProviderConfig &config,
       std::shared_ptr<Manager> sealer,
-      std::shared_ptr<Miner> miner)
+      std::shared_ptr<Miner> miner,
+      std::shared_ptr<boost::asio::io_context> io)
       : host_{std::move(host)},
         datatransfer_{std::move(datatransfer)},
         api_{std::move(api)},
@@ -41,7 +43,13 @@ namespace fc::markets::retrieval::provider {
         ipld_{std::move(ipld)},
         config_{config},
         sealer_{std::move(sealer)},
-        miner_{std::move(miner)} {
+        miner_{std::move(miner)},
+        io_{std::move(io)} {
+    if (io_) {
+      unseal_pool_ = std::make_unique<boost::asio::thread_pool>(kUnsealThreads);
+      payment_pool_ =
+          std::make_unique<boost::asio::thread_pool>(kPaymentThreads);
+    }
     datatransfer_->on_pull.emplace(
         DealProposal::Named::type,
         [this](auto &pdtid, auto &pgsid, auto &, auto _voucher) {
@@ -53,6 +61,15 @@ namespace fc::markets::retrieval::provider {
         });
   }
 
+  RetrievalProviderImpl::~RetrievalProviderImpl() {
+    if (unseal_pool_) {
+      unseal_pool_->join();
+    }
+    if (payment_pool_) {
+      payment_pool_->join();
+    }
+  }
+
   void RetrievalProviderImpl::onProposal(const PeerDtId &pdtid,
                                          const PeerGsId &pgsid,
                                          const DealProposal &proposal) {
@@ -81,7 +98,7 @@ namespace fc::markets::retrieval::provider {
       return reject(DealStatus::kDealStatusFailed, "Payload not found");
     }
 
-    auto deal{std::make_shared<DealState>(ipld_, pdtid, pgsid, proposal)};
+    auto deal{std::make_shared<DealState>(pdtid, pgsid, proposal)};
     auto &unseal{deal->state.owed};
 
     datatransfer_->acceptPull(
@@ -114,23 +131,52 @@ namespace fc::markets::retrieval::provider {
 
   void RetrievalProviderImpl::onPayment(std::shared_ptr<DealState> deal,
                                         const DealPayment &payment) {
-    auto _received{api_->PaychVoucherAdd(payment.payment_channel,
-                                         payment.payment_voucher,
-                                         {},
-                                         deal->state.owed)};
-    if (!_received) {
-      return doFail(deal, _received.error().message());
+    if (deal->failed) {
+      return;
     }
-    auto &received{_received.value()};
-    if (received == 0) {
-      received = payment.payment_voucher.amount - deal->state.paid;
-      if (received > deal->state.owed) {
-        received = deal->state.owed;
-      }
+    // voucher amount is cumulative for lane
+    TokenAmount credit{payment.payment_voucher.amount - deal->state.paid};
+    if (credit > deal->state.owed) {
+      credit = deal->state.owed;
     }
+    if (io_ && credit > 0
+        && deal->unverified + credit <= config_.payment_credit) {
+      // credited before voucher is verified, deal fails if it is invalid
+      deal->unverified += credit;
+      deal->state.pay(credit);
+      verifyPaymentAsync(payment,
+                         deal->state.owed,
+                         [this, deal, credit](auto _received) {
+                           deal->unverified -= credit;
+                           if (!_received && !deal->failed) {
+                             doFail(deal, _received.error().message());
+                           }
+                         });
+      return onPaid(deal);
+    }
+    verifyPaymentAsync(
+        payment,
+        deal->state.owed,
+        [this, deal, paid{deal->state.paid}, payment](auto _received) {
+          if (deal->failed) {
+            return;
+          }
+          if (!_received) {
+            return doFail(deal, _received.error().message());
+          }
+          auto &received{_received.value()};
+          if (received == 0) {
+            received = payment.payment_voucher.amount - paid;
+          }
+          if (received > deal->state.owed) {
+            received = deal->state.owed;
+          }
+          deal->state.pay(received);
+          onPaid(deal);
+        });
+  }
 
-    deal->state.pay(received);
-
+  void RetrievalProviderImpl::onPaid(std::shared_ptr<DealState> deal) {
     if (hasOwed(deal)) {
       return;
     }
@@ -138,46 +184,133 @@ namespace fc::markets::retrieval::provider {
     if (!deal->unsealed) {
       return doUnseal(deal);
     }
-    if (!deal->traverser.isCompleted()) {
+    if (!deal->traverser->isCompleted()) {
       return doBlocks(deal);
     }
     doComplete(deal);
   }
 
+  void RetrievalProviderImpl::verifyPaymentAsync(
+      const DealPayment &payment,
+      const TokenAmount &owed,
+      std::function<void(outcome::result<TokenAmount>)> cb) {
+    auto verify{[this, payment, owed] {
+      return api_->PaychVoucherAdd(
+          payment.payment_channel, payment.payment_voucher, {}, owed);
+    }};
+    if (!io_) {
+      return cb(verify());
+    }
+    boost::asio::post(*payment_pool_, [this, verify, cb{std::move(cb)}] {
+      auto res{verify()};
+      boost::asio::post(*io_, [cb, res{std::move(res)}] { cb(res); });
+    });
+  }
+
   void RetrievalProviderImpl::doUnseal(std::shared_ptr<DealState> deal) {
-    if (hasOwed(deal)) {
+    if (hasOwed(deal) || deal->unsealing) {
       return;
     }
-    auto _piece{piece_storage_->getPieceInfoFromCid(
-        deal->proposal.payload_cid, deal->proposal.params.piece)};
-    if (!_piece) {
-      return doFail(deal, _piece.error().message());
+    deal->unsealing = true;
+    unsealAsync(deal->proposal.payload_cid,
+                deal->proposal.params.piece,
+                [this, deal](outcome::result<std::string> _car_path) {
+                  deal->unsealing = false;
+                  if (!_car_path) {
+                    return doFail(deal, _car_path.error().message());
+                  }
+                  auto &car_path{_car_path.value()};
+                  // blocks are served from mapped car, files are unlinked
+                  // and live until deal state is dropped
+                  auto _car{::fc::storage::car::IndexedCar::open(car_path)};
+                  boost::system::error_code ec;
+                  fs::remove_all(car_path, ec);
+                  fs::remove_all(::fc::storage::car::indexPath(car_path), ec);
+                  if (!_car) {
+                    return doFail(deal, _car.error().message());
+                  }
+                  deal->car = std::move(_car.value());
+                  deal->traverser.emplace(*deal->car,
+                                          deal->proposal.payload_cid,
+                                          deal->proposal.params.selector,
+                                          kRetrievalPrefetch);
+                  deal->unsealed = true;
+                  doBlocks(deal);
+                });
+  }
+
+  outcome::result<void> RetrievalProviderImpl::unsealPayload(
+      const CID &payload_cid,
+      const boost::optional<CID> &piece_cid,
+      const std::string &car_path) {
+    OUTCOME_TRY(piece,
+                piece_storage_->getPieceInfoFromCid(payload_cid, piece_cid));
+    outcome::result<void> res{PieceStorageError::kPieceNotFound};
+    for (auto &info : piece.deals) {
+      res = unsealSector(info.sector_id,
+                         info.offset.unpadded(),
+                         info.length.unpadded(),
+                         car_path);
+      if (res) {
+        assert(info.length.unpadded() == fs::file_size(car_path));
+        break;
+      }
     }
+    return res;
+  }
+
+  void RetrievalProviderImpl::unsealAsync(
+      const CID &payload_cid,
+      const boost::optional<CID> &piece_cid,
+      std::function<void(outcome::result<std::string>)> cb) {
     if (!fs::exists(config_.filestore_path)) {
       fs::create_directories(config_.filestore_path);
     }
-    auto car_path = fs::path(config_.filestore_path) / fs::unique_path();
-    auto _ = gsl::finally([&car_path]() {
-      if (fs::exists(car_path)) {
-        fs::remove_all(car_path);
+    auto car_path{
+        (fs::path(config_.filestore_path) / fs::unique_path()).string()};
+    auto unseal{[this, payload_cid, piece_cid, car_path]()
+                    -> outcome::result<std::string> {
+      auto res{unsealPayload(payload_cid, piece_cid, car_path)};
+      if (!res) {
+        boost::system::error_code ec;
+        fs::remove_all(car_path, ec);
+        return res.error();
       }
+      return car_path;
+    }};
+    if (!io_) {
+      return cb(unseal());
+    }
+    // unseal may take long, deal flow continues on io context
+    boost::asio::post(*unseal_pool_, [this, unseal, cb{std::move(cb)}] {
+      auto res{unseal()};
+      boost::asio::post(*io_, [cb, res{std::move(res)}] { cb(res); });
     });
-    for (auto &info : _piece.value().deals) {
-      if (auto _error{unsealSector(info.sector_id,
-                                   info.offset.unpadded(),
-                                   info.length.unpadded(),
-                                   car_path.string())}) {
-        assert(info.length.unpadded() == fs::file_size(car_path));
-        auto _load{::fc::storage::car::loadCar(*ipld_, car_path.string())};
-        if (!_load) {
-          return doFail(deal, _piece.error().message());
-        }
-        deal->unsealed = true;
-        doBlocks(deal);
-        return;
-      }
+  }
+
+  void RetrievalProviderImpl::countQuery(const QueryRequest &query) {
+    if (!io_ || config_.unseal_prefetch_queries == 0
+        || prefetched_.count(query.payload_cid) != 0) {
+      return;
+    }
+    if (++query_counts_[query.payload_cid] < config_.unseal_prefetch_queries) {
+      return;
     }
-    doFail(deal, "unsealing all failed");
+    query_counts_.erase(query.payload_cid);
+    prefetched_.insert(query.payload_cid);
+    logger_->info("unsealing popular payload "
+                  + query.payload_cid.toString().value());
+    // unsealed copy stays with sector storage, temporary car is not needed
+    unsealAsync(query.payload_cid,
+                query.params.piece_cid,
+                [this, cid{query.payload_cid}](auto _car_path) {
+                  if (!_car_path) {
+                    prefetched_.erase(cid);
+                    return;
+                  }
+                  boost::system::error_code ec;
+                  fs::remove_all(_car_path.value(), ec);
+                });
   }
 
   void RetrievalProviderImpl::doBlocks(std::shared_ptr<DealState> deal) {
@@ -185,23 +318,19 @@ namespace fc::markets::retrieval::provider {
       return;
     }
     while (true) {
-      auto _cid{deal->traverser.advance()};
-      if (!_cid) {
-        return doFail(deal, _cid.error().message());
+      auto _block{deal->traverser->advanceBlock()};
+      if (!_block) {
+        return doFail(deal, _block.error().message());
       }
-      auto &cid{_cid.value()};
-      auto _data{ipld_->get(cid)};
-      if (!_data) {
-        return doFail(deal, _data.error().message());
-      }
-      auto &data{_data.value()};
-      deal->state.block(data.size());
-      datatransfer_->gs->postResponse(deal->pgsid,
-                                      {GsResStatus::RS_PARTIAL_RESPONSE,
-                                       {},
-                                       {{std::move(cid), std::move(data)}}});
-
-      if (deal->traverser.isCompleted()) {
+      auto &block{_block.value()};
+      deal->state.block(block.bytes.size());
+      datatransfer_->gs->postResponse(
+          deal->pgsid,
+          {GsResStatus::RS_PARTIAL_RESPONSE,
+           {},
+           {{std::move(block.cid), std::move(block.bytes)}}});
+
+      if (deal->traverser->isCompleted()) {
         return doComplete(deal);
       }
 
@@ -253,7 +382,7 @@ namespace fc::markets::retrieval::provider {
              CborRaw{codec::cbor::encode(
                          DealResponse::Named{{
                              deal->unsealed
-                                 ? deal->traverser.isCompleted()
+                                 ? deal->traverser->isCompleted()
                                        ? DealStatus::
                                            kDealStatusFundsNeededLastPayment
                                        : DealStatus::kDealStatusFundsNeeded
@@ -271,6 +400,7 @@ namespace fc::markets::retrieval::provider {
 
   void RetrievalProviderImpl::doFail(std::shared_ptr<DealState> deal,
                                      std::string error) {
+    deal->failed = true;
     datatransfer_->pulling_in.erase(deal->pdtid);
     datatransfer_->rejectPull(
         deal->pdtid,
@@ -336,21 +466,23 @@ namespace fc::markets::retrieval::provider {
     OUTCOME_TRY(minfo,
                 api_->StateMinerInfo(miner_->getAddress(), chain_head->key));
 
-    OUTCOME_TRY(piece_available,
-                piece_storage_->hasPieceInfo(query.payload_cid,
-                                             query.params.piece_cid));
-    if (!piece_available) {
+    // one indexed read gives availability and size
+    auto _piece{piece_storage_->getPieceInfoFromCid(query.payload_cid,
+                                                    query.params.piece_cid)};
+    if (!_piece && _piece.error() != PieceStorageError::kPieceNotFound
+        && _piece.error() != PieceStorageError::kPayloadNotFound) {
+      return _piece.error();
+    }
+    if (!_piece || _piece.value().deals.empty()) {
       return QueryResponse{
           .response_status = QueryResponseStatus::kQueryResponseUnavailable,
           .item_status = QueryItemStatus::kQueryItemUnavailable};
     }
-    OUTCOME_TRY(piece_size,
-                piece_storage_->getPieceSize(query.payload_cid,
-                                             query.params.piece_cid));
+    countQuery(query);
     return QueryResponse{
         .response_status = QueryResponseStatus::kQueryResponseAvailable,
         .item_status = QueryItemStatus::kQueryItemAvailable,
-        .item_size = piece_size,
+        .item_size = _piece.value().deals.front().length,
         .payment_address = minfo.worker,
         .min_price_per_byte = config_.price_per_byte,
         .payment_interval = config_.payment_interval,
@@ -6,6 +6,11 @@
 #ifndef CPP_FILECOIN_CORE_MARKETS_RETRIEVAL_PROVIDER_IMPL_HPP
 #define CPP_FILECOIN_CORE_MARKETS_RETRIEVAL_PROVIDER_IMPL_HPP
 
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <map>
+#include <set>
+
 #include "api/api.hpp"
 #include "common/libp2p/cbor_stream.hpp"
 #include "common/logger.hpp"
@@ -46,25 +51,45 @@ namespace fc::markets::retrieval::provider {
     uint64_t interval_increase;
     TokenAmount unseal_price;
     Path filestore_path = kFilestoreTempDir;
+    /// Queries of payload after which its piece is unsealed in background,
+    /// so later deals find unsealed copy. 0 disables
+    uint64_t unseal_prefetch_queries = 3;
+    /// Amount of payments accepted before vouchers are verified, so blocks
+    /// are sent while voucher is checked. 0 waits for each voucher
+    TokenAmount payment_credit;
   };
 
+  /// Threads waiting for unseal done by sector manager
+  constexpr size_t kUnsealThreads{2};
+
+  /// Vouchers are verified one by one in arrival order
+  constexpr size_t kPaymentThreads{1};
+
+  /// Blocks loaded ahead while previous blocks are sent
+  constexpr size_t kRetrievalPrefetch{32};
+
   struct DealState {
-    DealState(std::shared_ptr<Ipld> ipld,
-              const PeerDtId &pdtid,
+    DealState(const PeerDtId &pdtid,
               const PeerGsId &pgsid,
               const DealProposal &proposal)
         : proposal{proposal},
           state{proposal.params},
           pdtid{pdtid},
-          pgsid{pgsid},
-          traverser{*ipld, proposal.payload_cid, proposal.params.selector} {}
+          pgsid{pgsid} {}
 
     DealProposal proposal;
     State state;
     PeerDtId pdtid;
     PeerGsId pgsid;
+    bool unsealing{false};
     bool unsealed{false};
-    Traverser traverser;
+    /// Paid amount which vouchers are still being verified
+    TokenAmount unverified;
+    bool failed{false};
+    /// Unsealed payload car
+    std::shared_ptr<Ipld> car;
+    /// Traverses unsealed car, set when unsealed
+    boost::optional<Traverser> traverser;
   };
 
   class RetrievalProviderImpl
@@ -78,12 +103,16 @@ namespace fc::markets::retrieval::provider {
                           IpldPtr ipld,
                           const ProviderConfig &config,
                           std::shared_ptr<Manager> sealer,
-                          std::shared_ptr<Miner> miner);
+                          std::shared_ptr<Miner> miner,
+                          std::shared_ptr<boost::asio::io_context> io = nullptr);
+
+    ~RetrievalProviderImpl() override;
 
     void onProposal(const PeerDtId &pdtid,
                     const PeerGsId &pgsid,
                     const DealProposal &proposal);
     void onPayment(std::shared_ptr<DealState> deal, const DealPayment &payment);
+    void onPaid(std::shared_ptr<DealState> deal);
     void doUnseal(std::shared_ptr<DealState> deal);
     void doBlocks(std::shared_ptr<DealState> deal);
     void doComplete(std::shared_ptr<DealState> deal);
@@ -131,6 +160,31 @@ namespace fc::markets::retrieval::provider {
                                        UnpaddedPieceSize size,
                                        const std::string &output_path);
 
+    /// Unseals piece with payload to car file from any sector having it
+    outcome::result<void> unsealPayload(const CID &payload_cid,
+                                        const boost::optional<CID> &piece_cid,
+                                        const std::string &car_path);
+
+    /**
+     * Runs unseal on unseal pool and calls cb on io context, or runs it
+     * synchronously without io context
+     */
+    void unsealAsync(const CID &payload_cid,
+                     const boost::optional<CID> &piece_cid,
+                     std::function<void(outcome::result<std::string>)> cb);
+
+    /**
+     * Verifies voucher on payment pool and calls cb on io context, or runs it
+     * synchronously without io context
+     */
+    void verifyPaymentAsync(
+        const DealPayment &payment,
+        const TokenAmount &owed,
+        std::function<void(outcome::result<TokenAmount>)> cb);
+
+    /// Counts query and unseals popular payload in background
+    void countQuery(const QueryRequest &query);
+
     std::shared_ptr<Host> host_;
     std::shared_ptr<DataTransfer> datatransfer_;
     std::shared_ptr<api::Api> api_;
@@ -139,6 +193,13 @@ namespace fc::markets::retrieval::provider {
     ProviderConfig config_;
     std::shared_ptr<Manager> sealer_;
     std::shared_ptr<Miner> miner_;
+    std::shared_ptr<boost::asio::io_context> io_;
+    std::unique_ptr<boost::asio::thread_pool> unseal_pool_;
+    std::unique_ptr<boost::asio::thread_pool> payment_pool_;
+    /// Available payload queries count
+    std::map<CID, uint64_t> query_counts_;
+    /// Payloads unsealed in background
+    std::set<CID> prefetched_;
     common::Logger logger_ = common::createLogger("RetrievalProvider");
   };
 }  // namespace fc::markets::retrieval::provider
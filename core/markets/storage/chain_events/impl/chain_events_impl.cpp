@@ -32,10 +32,7 @@ namespace fc::markets::storage::chain_events {
                                               const DealId &deal_id,
                                               Cb cb) {
     std::unique_lock lock(watched_events_mutex_);
-    watched_events_.emplace_back(EventWatch{.provider = provider,
-                                            .deal_id = deal_id,
-                                            .sector_number = boost::none,
-                                            .cb = std::move(cb)});
+    watched_events_[provider].deals[deal_id].push_back(std::move(cb));
   }
 
   /**
@@ -48,6 +45,13 @@ namespace fc::markets::storage::chain_events {
       const boost::optional<std::vector<HeadChange>> &changes) {
     if (changes) {
       for (const auto &change : changes.get()) {
+        {
+          // messages are not loaded while nothing is watched
+          std::shared_lock lock(watched_events_mutex_);
+          if (watched_events_.empty()) {
+            continue;
+          }
+        }
         if (change.type == HeadChangeType::APPLY) {
           for (auto &block_cid : change.value->key.cids()) {
             auto block_messages = api_->ChainGetBlockMessages(block_cid);
@@ -80,58 +84,57 @@ namespace fc::markets::storage::chain_events {
 
   outcome::result<void> ChainEventsImpl::onMessage(
       const UnsignedMessage &message, const CID &cid) {
-    std::vector<EventWatch>::iterator watch_it;
-    boost::optional<SectorNumber> update_sector_number;
-    bool prove_sector_committed = false;
+    if (message.method != PreCommitSector::Number
+        && message.method != ProveCommitSector::Number) {
+      return outcome::success();
+    }
+    std::vector<Cb> committed;
     {
-      std::shared_lock lock(watched_events_mutex_);
-      for (watch_it = watched_events_.begin();
-           watch_it != watched_events_.end();
-           ++watch_it) {
-        if (message.to == watch_it->provider) {
-          if (message.method == PreCommitSector::Number) {
-            OUTCOME_TRY(
-                pre_commit_info,
-                codec::cbor::decode<SectorPreCommitInfo>(message.params));
-            auto deal_ids = pre_commit_info.deal_ids;
-            // save sector number if deal id matches and it is not saved yet
-            if (std::find(deal_ids.begin(), deal_ids.end(), watch_it->deal_id)
-                    != deal_ids.end()
-                && !watch_it->sector_number) {
-              update_sector_number = pre_commit_info.sector;
-              break;
-            }
-          } else if (message.method == ProveCommitSector::Number) {
-            OUTCOME_TRY(
-                prove_commit_params,
-                codec::cbor::decode<ProveCommitSector::Params>(message.params));
-            // notify if sector number matches,
-            if (watch_it->sector_number
-                && prove_commit_params.sector == watch_it->sector_number) {
-              prove_sector_committed = true;
-              break;
-            }
+      std::unique_lock lock(watched_events_mutex_);
+      auto provider_it{watched_events_.find(message.to)};
+      if (provider_it == watched_events_.end()) {
+        return outcome::success();
+      }
+      auto &watches{provider_it->second};
+      if (message.method == PreCommitSector::Number) {
+        OUTCOME_TRY(pre_commit_info,
+                    codec::cbor::decode<SectorPreCommitInfo>(message.params));
+        // deals wait for prove commit of sector
+        for (auto &deal_id : pre_commit_info.deal_ids) {
+          auto deal_it{watches.deals.find(deal_id)};
+          if (deal_it == watches.deals.end()) {
+            continue;
           }
+          auto &cbs{watches.sectors[pre_commit_info.sector]};
+          cbs.insert(cbs.end(),
+                     std::make_move_iterator(deal_it->second.begin()),
+                     std::make_move_iterator(deal_it->second.end()));
+          watches.deals.erase(deal_it);
         }
+        return outcome::success();
       }
-    }
-
-    if (watch_it != watched_events_.end()) {
-      std::unique_lock lock(watched_events_mutex_);
-      if (update_sector_number) {
-        watch_it->sector_number = update_sector_number;
+      OUTCOME_TRY(
+          prove_commit_params,
+          codec::cbor::decode<ProveCommitSector::Params>(message.params));
+      auto sector_it{watches.sectors.find(prove_commit_params.sector)};
+      if (sector_it == watches.sectors.end()) {
+        return outcome::success();
       }
-
-      if (prove_sector_committed) {
-        OUTCOME_TRY(wait, api_->StateWaitMsg(cid, api::kNoConfidence));
-        wait.waitOwn([cb{std::move(watch_it->cb)}](auto _r) {
-          if (_r) {
-            cb();
-          }
-        });
-        watched_events_.erase(watch_it);
+      committed = std::move(sector_it->second);
+      watches.sectors.erase(sector_it);
+      if (watches.deals.empty() && watches.sectors.empty()) {
+        watched_events_.erase(provider_it);
       }
     }
+
+    OUTCOME_TRY(wait, api_->StateWaitMsg(cid, api::kNoConfidence));
+    wait.waitOwn([cbs{std::move(committed)}](auto _r) {
+      if (_r) {
+        for (auto &cb : cbs) {
+          cb();
+        }
+      }
+    });
     return outcome::success();
   }
 
@@ -8,6 +8,7 @@
 
 #include "markets/storage/chain_events/chain_events.hpp"
 
+#include <map>
 #include <shared_mutex>
 
 #include "api/api.hpp"
@@ -47,8 +48,20 @@ namespace fc::markets::storage::chain_events {
      */
     std::shared_ptr<Channel<std::vector<HeadChange>>> channel_;
 
+    /// Watches of one provider, indexed by deal and by precommitted sector
+    struct ProviderWatches {
+      /// Callbacks of deals which sector isn't precommitted yet
+      std::map<DealId, std::vector<Cb>> deals;
+      /// Callbacks of deals by precommitted sector
+      std::map<SectorNumber, std::vector<Cb>> sectors;
+    };
+
+    /**
+     * Message is matched by to-address and method, then by its deal ids or
+     * sector number, so head change takes O(messages) lookups
+     */
     mutable std::shared_mutex watched_events_mutex_;
-    std::vector<EventWatch> watched_events_;
+    std::map<Address, ProviderWatches> watched_events_;
 
     common::Logger logger_ = common::createLogger("StorageMarketEvents");
   };
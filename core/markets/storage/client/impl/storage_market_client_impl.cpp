@@ -5,6 +5,8 @@
 
 #include "storage_market_client_impl.hpp"
 
+#include <unordered_map>
+
 #include <libp2p/peer/peer_id.hpp>
 #include <libp2p/protocol/common/asio/asio_scheduler.hpp>
 #include "codec/cbor/cbor.hpp"
@@ -65,75 +67,146 @@ namespace fc::markets::storage::client {
       std::shared_ptr<DataTransfer> datatransfer,
       std::shared_ptr<Discovery> discovery,
       std::shared_ptr<Api> api,
-      std::shared_ptr<PieceIO> piece_io)
+      std::shared_ptr<PieceIO> piece_io,
+      std::shared_ptr<ChainEvents> chain_events)
       : host_{std::move(host)},
         context_{std::move(context)},
         api_{std::move(api)},
         piece_io_{std::move(piece_io)},
         discovery_{std::move(discovery)},
         ipld{ipld},
-        datatransfer_{std::move(datatransfer)} {}
+        datatransfer_{std::move(datatransfer)},
+        chain_events_{std::move(chain_events)} {}
 
   bool StorageMarketClientImpl::pollWaiting() {
-    std::lock_guard lock{waiting_mutex};
-    auto any{!waiting_deals.empty()};
-    for (auto &deal : waiting_deals) {
-      askDealStatus(deal);
+    std::unordered_map<PeerId, std::vector<std::shared_ptr<ClientDeal>>>
+        providers;
+    {
+      std::lock_guard lock{waiting_mutex};
+      for (auto &deal : waiting_deals) {
+        providers[deal->miner.id].push_back(deal);
+      }
+      waiting_deals.clear();
     }
-    waiting_deals.clear();
-    return any;
+    for (auto &[_, deals] : providers) {
+      askDealStatus(std::move(deals));
+    }
+    return !providers.empty();
   }
 
   void StorageMarketClientImpl::askDealStatus(
-      std::shared_ptr<ClientDeal> deal) {
-    auto cb{weakCb0(
-        weak_from_this(), [=](outcome::result<DealStatusResponse> &&_res) {
-          if (_res) {
-            auto &res{_res.value()};
-            auto state{res.state.status};
-            if (state == StorageDealStatus::STORAGE_DEAL_STAGED
-                || state == StorageDealStatus::STORAGE_DEAL_SEALING
-                || state == StorageDealStatus::STORAGE_DEAL_ACTIVE
-                || state == StorageDealStatus::STORAGE_DEAL_EXPIRED
-                || state == StorageDealStatus::STORAGE_DEAL_SLASHED) {
-              deal->publish_message = *res.state.publish_cid;
-              FSM_SEND(deal, ClientEvent::ClientEventDealAccepted);
-            } else if (state == StorageDealStatus::STORAGE_DEAL_FAILING
-                       || state == StorageDealStatus::STORAGE_DEAL_ERROR) {
-              FSM_SEND(deal, ClientEvent::ClientEventDealRejected);
-            } else {
-              std::lock_guard lock{waiting_mutex};
-              waiting_deals.push_back(deal);
+      std::vector<std::shared_ptr<ClientDeal>> deals) {
+    auto batch{std::make_shared<StatusBatch>()};
+    for (auto &deal : deals) {
+      DealStatusRequest req;
+      req.proposal = deal->proposal_cid;
+      OUTCOME_EXCEPT(bytes, codec::cbor::encode(req.proposal));
+      auto signature{
+          api_->WalletSign(deal->client_deal_proposal.proposal.client, bytes)};
+      if (!signature) {
+        spdlog::error(
+            "askDealStatus {} {}", deal->proposal_cid, signature.error());
+        std::lock_guard lock{waiting_mutex};
+        waiting_deals.push_back(deal);
+        continue;
+      }
+      req.signature = std::move(signature.value());
+      batch->deals.push_back(deal);
+      batch->requests.push_back(std::move(req));
+    }
+    if (batch->deals.empty()) {
+      return;
+    }
+    host_->newStream(
+        batch->deals.front()->miner,
+        kDealStatusProtocolId,
+        weakCb0(weak_from_this(), [=](auto &&_stream) {
+          if (!_stream) {
+            spdlog::error("askDealStatus {}", _stream.error());
+            std::lock_guard lock{waiting_mutex};
+            waiting_deals.insert(
+                waiting_deals.end(), batch->deals.begin(), batch->deals.end());
+            return;
+          }
+          askDealStatus(std::make_shared<CborStream>(_stream.value()), batch);
+        }));
+  }
+
+  void StorageMarketClientImpl::askDealStatus(
+      const std::shared_ptr<CborStream> &stream,
+      const std::shared_ptr<StatusBatch> &batch) {
+    if (batch->next == batch->deals.size()) {
+      return stream->close();
+    }
+    auto fail{[=](const std::error_code &error) {
+      stream->close();
+      auto it{batch->deals.begin() + batch->next};
+      spdlog::error("askDealStatus {} {}", (*it)->proposal_cid, error);
+      std::lock_guard lock{waiting_mutex};
+      waiting_deals.insert(waiting_deals.end(), it, batch->deals.end());
+    }};
+    stream->write(
+        batch->requests[batch->next],
+        weakCb0(weak_from_this(), [=](auto &&_n) {
+          if (!_n) {
+            return fail(_n.error());
+          }
+          stream->read<DealStatusResponse>(
+              weakCb0(weak_from_this(), [=](auto &&_res) {
+                if (!_res) {
+                  return fail(_res.error());
+                }
+                auto &state{_res.value().state};
+                auto &deal{batch->deals[batch->next++]};
+                if (!onDealStatus(deal, state.status, state.publish_cid)) {
+                  std::lock_guard lock{waiting_mutex};
+                  waiting_deals.push_back(deal);
+                }
+                askDealStatus(stream, batch);
+              }));
+        }));
+  }
+
+  void StorageMarketClientImpl::waitStatusPush(
+      std::shared_ptr<ClientDeal> deal, std::shared_ptr<CborStream> stream) {
+    stream->read<SignedResponse>(weakCb0(
+        weak_from_this(), [=](outcome::result<SignedResponse> _pushed) {
+          if (_pushed) {
+            auto &res{_pushed.value().response};
+            if (verifyDealResponseSignature(_pushed.value(), deal)
+                && res.proposal == deal->proposal_cid) {
+              deal->message = res.message;
+              if (onDealStatus(deal, res.state, res.publish_message)) {
+                return;
+              }
             }
-          } else {
-            spdlog::error(
-                "askDealStatus {} {}", deal->proposal_cid, _res.error());
           }
-        })};
-    DealStatusRequest req;
-    req.proposal = deal->proposal_cid;
-    OUTCOME_EXCEPT(bytes, codec::cbor::encode(req.proposal));
-    OUTCOME_CB(
-        req.signature,
-        api_->WalletSign(deal->client_deal_proposal.proposal.client, bytes));
-    host_->newStream(deal->miner,
-                     kDealStatusProtocolId,
-                     [MOVE(cb), MOVE(req)](auto &&_stream) {
-                       OUTCOME_CB1(_stream);
-                       auto stream{std::make_shared<common::libp2p::CborStream>(
-                           std::move(_stream.value()))};
-                       stream->write(req, [MOVE(cb), stream](auto &&_n) {
-                         if (!_n) {
-                           stream->close();
-                         }
-                         OUTCOME_CB1(_n);
-                         stream->template read<DealStatusResponse>(
-                             [MOVE(cb), stream](auto &&_res) {
-                               stream->close();
-                               cb(std::move(_res));
-                             });
-                       });
-                     });
+          // provider without push closes stream after accept
+          std::lock_guard lock{waiting_mutex};
+          waiting_deals.push_back(deal);
+        }));
+  }
+
+  bool StorageMarketClientImpl::onDealStatus(
+      const std::shared_ptr<ClientDeal> &deal,
+      StorageDealStatus state,
+      const boost::optional<CID> &publish_message) {
+    if (publish_message
+        && (state == StorageDealStatus::STORAGE_DEAL_STAGED
+            || state == StorageDealStatus::STORAGE_DEAL_SEALING
+            || state == StorageDealStatus::STORAGE_DEAL_ACTIVE
+            || state == StorageDealStatus::STORAGE_DEAL_EXPIRED
+            || state == StorageDealStatus::STORAGE_DEAL_SLASHED)) {
+      deal->publish_message = *publish_message;
+      FSM_SEND(deal, ClientEvent::ClientEventDealAccepted);
+      return true;
+    }
+    if (state == StorageDealStatus::STORAGE_DEAL_FAILING
+        || state == StorageDealStatus::STORAGE_DEAL_ERROR) {
+      FSM_SEND(deal, ClientEvent::ClientEventDealRejected);
+      return true;
+    }
+    return false;
   }
 
   outcome::result<void> StorageMarketClientImpl::init() {
@@ -420,10 +493,7 @@ namespace fc::markets::storage::client {
   }
 
   outcome::result<bool> StorageMarketClientImpl::verifyDealPublished(
-      std::shared_ptr<ClientDeal> deal) {
-    OUTCOME_TRY(msg_wait,
-                api_->StateWaitMsg(deal->publish_message, api::kNoConfidence));
-    OUTCOME_TRY(msg_state, msg_wait.waitSync());
+      std::shared_ptr<ClientDeal> deal, const MsgWait &msg_state) {
     if (msg_state.receipt.exit_code != VMExitCode::kOk) {
       deal->message =
           "Publish deal exit code "
@@ -636,8 +706,7 @@ namespace fc::markets::storage::client {
           [](auto) {},
           [](auto) {});
 
-      std::lock_guard lock{self->waiting_mutex};
-      self->waiting_deals.push_back(deal);
+      self->waitStatusPush(deal, stream);
     });
   }
 
@@ -655,13 +724,20 @@ namespace fc::markets::storage::client {
       ClientEvent event,
       StorageDealStatus from,
       StorageDealStatus to) {
-    auto verified = verifyDealPublished(deal);
-    FSM_HALT_ON_ERROR(verified, "Cannot get publish message", deal);
-    if (!verified.value()) {
-      FSM_SEND(deal, ClientEvent::ClientEventFailed);
-      return;
-    }
-    FSM_SEND(deal, ClientEvent::ClientEventDealPublished);
+    // publish is verified when message is applied, fsm isn't blocked on wait
+    auto wait{api_->StateWaitMsg(deal->publish_message, api::kNoConfidence)};
+    FSM_HALT_ON_ERROR(wait, "Cannot get publish message", deal);
+    wait.value().waitOwn(weakCb0(
+        weak_from_this(), [=](outcome::result<MsgWait> _msg_state) {
+          FSM_HALT_ON_ERROR(_msg_state, "Wait publish message error", deal);
+          auto verified{verifyDealPublished(deal, _msg_state.value())};
+          FSM_HALT_ON_ERROR(verified, "Cannot get publish message", deal);
+          if (!verified.value()) {
+            FSM_SEND(deal, ClientEvent::ClientEventFailed);
+            return;
+          }
+          FSM_SEND(deal, ClientEvent::ClientEventDealPublished);
+        }));
   }
 
   void StorageMarketClientImpl::onClientEventDealPublished(
@@ -669,8 +745,16 @@ namespace fc::markets::storage::client {
       ClientEvent event,
       StorageDealStatus from,
       StorageDealStatus to) {
-    // TODO (a.chernyshov) verify deal activated - on deal sector commit
-    OUTCOME_EXCEPT(fsm_->send(deal, ClientEvent::ClientEventDealActivated, {}));
+    if (!chain_events_) {
+      FSM_SEND(deal, ClientEvent::ClientEventDealActivated);
+      return;
+    }
+    chain_events_->onDealSectorCommitted(
+        deal->client_deal_proposal.proposal.provider,
+        deal->deal_id,
+        weakCb0(weak_from_this(), [=] {
+          FSM_SEND(deal, ClientEvent::ClientEventDealActivated);
+        }));
   }
 
   void StorageMarketClientImpl::onClientEventDealActivated(
@@ -16,6 +16,7 @@
 #include "markets/common.hpp"
 #include "markets/discovery/discovery.hpp"
 #include "markets/pieceio/pieceio_impl.hpp"
+#include "markets/storage/chain_events/chain_events.hpp"
 #include "markets/storage/client/client_events.hpp"
 #include "markets/storage/client/storage_market_client.hpp"
 #include "storage/filestore/filestore.hpp"
@@ -24,6 +25,7 @@
 namespace fc::markets::storage::client {
 
   using api::Api;
+  using chain_events::ChainEvents;
   using common::Buffer;
   using common::libp2p::CborStream;
   using discovery::Discovery;
@@ -45,17 +47,28 @@ namespace fc::markets::storage::client {
       : public StorageMarketClient,
         public std::enable_shared_from_this<StorageMarketClientImpl> {
    public:
-    StorageMarketClientImpl(std::shared_ptr<Host> host,
-                            std::shared_ptr<boost::asio::io_context> context,
-                            IpldPtr ipld,
-                            std::shared_ptr<DataTransfer> datatransfer,
-                            std::shared_ptr<Discovery> discovery,
-                            std::shared_ptr<Api> api,
-                            std::shared_ptr<PieceIO> piece_io);
+    StorageMarketClientImpl(
+        std::shared_ptr<Host> host,
+        std::shared_ptr<boost::asio::io_context> context,
+        IpldPtr ipld,
+        std::shared_ptr<DataTransfer> datatransfer,
+        std::shared_ptr<Discovery> discovery,
+        std::shared_ptr<Api> api,
+        std::shared_ptr<PieceIO> piece_io,
+        std::shared_ptr<ChainEvents> chain_events = nullptr);
 
+    /**
+     * Asks status of deals which provider didn't push, deals of one provider
+     * are asked over one stream
+     * @return true if any deal was asked
+     */
     bool pollWaiting();
 
-    void askDealStatus(std::shared_ptr<ClientDeal> deal);
+    /**
+     * Asks status of deals with same provider one by one over one stream,
+     * deals not resolved return to waiting
+     */
+    void askDealStatus(std::vector<std::shared_ptr<ClientDeal>> deals);
 
     outcome::result<void> init() override;
 
@@ -94,6 +107,31 @@ namespace fc::markets::storage::client {
                                            const TokenAmount &amount) override;
 
    private:
+    /// Requests to one provider asked over one stream
+    struct StatusBatch {
+      std::vector<std::shared_ptr<ClientDeal>> deals;
+      std::vector<DealStatusRequest> requests;
+      size_t next{};
+    };
+
+    void askDealStatus(const std::shared_ptr<CborStream> &stream,
+                       const std::shared_ptr<StatusBatch> &batch);
+
+    /**
+     * Waits for provider to push deal status on proposal stream, deal returns
+     * to waiting if stream is closed without push
+     */
+    void waitStatusPush(std::shared_ptr<ClientDeal> deal,
+                        std::shared_ptr<CborStream> stream);
+
+    /**
+     * Moves deal according to status reported by provider
+     * @return false if deal is still pending
+     */
+    bool onDealStatus(const std::shared_ptr<ClientDeal> &deal,
+                      StorageDealStatus state,
+                      const boost::optional<CID> &publish_message);
+
     outcome::result<SignedStorageAsk> validateAskResponse(
         const outcome::result<AskResponse> &response,
         const StorageProviderInfo &info) const;
@@ -120,9 +158,11 @@ namespace fc::markets::storage::client {
     /**
      * Verifies if deal was published correctly
      * @param deal state with publish message cid set
+     * @param msg_state - applied publish message
      * @return true if published or false otherwise
      */
-    outcome::result<bool> verifyDealPublished(std::shared_ptr<ClientDeal> deal);
+    outcome::result<bool> verifyDealPublished(std::shared_ptr<ClientDeal> deal,
+                                              const api::MsgWait &msg_state);
 
     /**
      * Look up stream by proposal cid
@@ -290,9 +330,12 @@ namespace fc::markets::storage::client {
     std::shared_ptr<Discovery> discovery_;
     IpldPtr ipld;
     std::shared_ptr<DataTransfer> datatransfer_;
+    /// Sector commit watch for deal activation, deal is active once published
+    /// if not set
+    std::shared_ptr<ChainEvents> chain_events_;
 
+    /// Deals which provider didn't push status
     std::mutex waiting_mutex;
-    std::shared_ptr<void> waiting_sub;
     std::vector<std::shared_ptr<ClientDeal>> waiting_deals;
 
     // connection manager
@@ -182,11 +182,11 @@ namespace fc::markets::storage {
     std::string message;
     CID proposal;
 
-    // StorageDealProposalAccepted
-    boost::optional<CID> _unused;
+    // StorageDealStaged and later, pushed when deal is published
+    boost::optional<CID> publish_message;
   };
 
-  CBOR_TUPLE(Response, state, message, proposal, _unused)
+  CBOR_TUPLE(Response, state, message, proposal, publish_message)
 
   /**
    * SignedResponse is a response that is signed
@@ -5,6 +5,9 @@
 
 #include "provider_impl.hpp"
 
+#include <boost/asio/post.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <future>
 #include <libp2p/protocol/common/asio/asio_scheduler.hpp>
 #include "common/libp2p/peer/peer_info_helper.hpp"
 #include "common/todo_error.hpp"
@@ -14,6 +17,7 @@
 #include "markets/storage/provider/stored_ask.hpp"
 #include "markets/storage/storage_datatransfer_voucher.hpp"
 #include "storage/car/car.hpp"
+#include "storage/car/indexed_car.hpp"
 #include "vm/actor/builtin/v0/market/actor.hpp"
 
 #define CALLBACK_ACTION(_action)                                    \
@@ -66,7 +70,8 @@ namespace fc::markets::storage::provider {
       std::shared_ptr<ChainEvents> chain_events,
       const Address &miner_actor_address,
       std::shared_ptr<PieceIO> piece_io,
-      std::shared_ptr<FileStore> filestore)
+      std::shared_ptr<FileStore> filestore,
+      PublishBatchConfig publish_batch)
       : registered_proof_{registered_proof},
         host_{std::move(host)},
         context_{std::move(context)},
@@ -79,7 +84,11 @@ namespace fc::markets::storage::provider {
         piece_storage_{std::move(piece_storage)},
         filestore_{filestore},
         ipld_{ipld},
-        datatransfer_{datatransfer} {}
+        datatransfer_{datatransfer},
+        publish_batch_config_{publish_batch},
+        publish_timer_{*context_} {
+    verify_pool_ = std::make_unique<boost::asio::thread_pool>(kVerifyThreads);
+  }
 
   std::shared_ptr<MinerDeal> StorageProviderImpl::getDealPtr(
       const CID &proposal_cid) {
@@ -116,13 +125,20 @@ namespace fc::markets::storage::provider {
           if (auto _voucher2{
                   codec::cbor::decode<StorageDataTransferVoucher>(_voucher)}) {
             if (auto deal{getDealPtr(_voucher2.value().proposal_cid)}) {
+              startReceivedCar(deal);
               return datatransfer_->acceptPush(
-                  pdtid, root, [this, deal](auto ok) {
+                  pdtid,
+                  root,
+                  [this, deal](auto ok) {
+                    if (!ok) {
+                      received_cars_.erase(deal->proposal_cid);
+                    }
                     FSM_SEND(
                         deal,
                         ok ? ProviderEvent::ProviderEventDataTransferCompleted
                            : ProviderEvent::ProviderEventFailed);
-                  });
+                  },
+                  [this, deal](auto &cid) { onReceivedBlock(deal, cid); });
             }
           }
           datatransfer_->rejectPush(pdtid);
@@ -188,9 +204,14 @@ namespace fc::markets::storage::provider {
 
     OUTCOME_TRY(piece_commitment,
                 piece_io_->generatePieceCommitment(registered_proof_, path));
+    return onPieceCommitment(deal, piece_commitment.first, path);
+  }
 
-    if (piece_commitment.first
-        != deal->client_deal_proposal.proposal.piece_cid) {
+  outcome::result<void> StorageProviderImpl::onPieceCommitment(
+      std::shared_ptr<MinerDeal> deal,
+      const CID &piece_cid,
+      const std::string &path) {
+    if (piece_cid != deal->client_deal_proposal.proposal.piece_cid) {
       return StorageMarketProviderError::kPieceCIDDoesNotMatch;
     }
     deal->piece_path = path;
@@ -199,6 +220,35 @@ namespace fc::markets::storage::provider {
     return outcome::success();
   }
 
+  void StorageProviderImpl::startReceivedCar(std::shared_ptr<MinerDeal> deal) {
+    auto &received{received_cars_[deal->proposal_cid]};
+    // blocks are in store, so car is only hashed and not staged to file
+    received.commp = std::make_unique<PieceCommitmentStream>(
+        registered_proof_,
+        deal->client_deal_proposal.proposal.piece_size.unpadded(),
+        "");
+    Buffer header;
+    fc::storage::car::writeHeader(header, {deal->ref.root});
+    received.commp->write(std::move(header));
+  }
+
+  void StorageProviderImpl::onReceivedBlock(std::shared_ptr<MinerDeal> deal,
+                                            const CID &cid) {
+    auto it{received_cars_.find(deal->proposal_cid)};
+    if (it == received_cars_.end() || !it->second.blocks.insert(cid).second) {
+      return;
+    }
+    auto _bytes{ipld_->get(cid)};
+    if (!_bytes) {
+      // car is made from store after transfer
+      received_cars_.erase(it);
+      return;
+    }
+    Buffer item;
+    fc::storage::car::writeItem(item, cid, _bytes.value());
+    it->second.commp->write(std::move(item));
+  }
+
   outcome::result<Signature> StorageProviderImpl::sign(const Buffer &input) {
     OUTCOME_TRY(chain_head, api_->ChainHead());
     OUTCOME_TRY(worker_info,
@@ -247,36 +297,32 @@ namespace fc::markets::storage::provider {
         });
   }
 
-  outcome::result<bool> StorageProviderImpl::verifyDealProposal(
+  outcome::result<bool> StorageProviderImpl::verifyDealSignature(
       std::shared_ptr<MinerDeal> deal) const {
-    auto proposal = deal->client_deal_proposal.proposal;
+    auto &proposal = deal->client_deal_proposal.proposal;
     OUTCOME_TRY(proposal_bytes, codec::cbor::encode(proposal));
-    OUTCOME_TRY(
-        verified,
-        api_->WalletVerify(proposal.client,
-                           proposal_bytes,
-                           deal->client_deal_proposal.client_signature));
-    if (!verified) {
-      deal->message = "Deal proposal verification failed, wrong signature";
-      return false;
-    }
+    return api_->WalletVerify(proposal.client,
+                              proposal_bytes,
+                              deal->client_deal_proposal.client_signature);
+  }
 
+  bool StorageProviderImpl::verifyDealTerms(std::shared_ptr<MinerDeal> deal,
+                                            ChainEpoch head_epoch,
+                                            const SignedStorageAsk &ask) const {
+    auto &proposal = deal->client_deal_proposal.proposal;
     if (proposal.provider != miner_actor_address_) {
       deal->message =
           "Deal proposal verification failed, incorrect provider for deal";
       return false;
     }
 
-    OUTCOME_TRY(chain_head, api_->ChainHead());
-    if (chain_head->epoch()
-        > proposal.start_epoch - kDefaultDealAcceptanceBuffer) {
+    if (head_epoch > proposal.start_epoch - kDefaultDealAcceptanceBuffer) {
       deal->message =
           "Deal proposal verification failed, deal start epoch is too soon or "
           "deal already expired";
       return false;
     }
 
-    OUTCOME_TRY(ask, stored_ask_->getAsk(miner_actor_address_));
     auto min_price = bigdiv(
         ask.ask.price * static_cast<uint64_t>(proposal.piece_size), 1 << 30);
     if (proposal.storage_price_per_epoch < min_price) {
@@ -304,22 +350,118 @@ namespace fc::markets::storage::provider {
       deal->message = ss.str();
       return false;
     }
+    return true;
+  }
+
+  std::vector<outcome::result<bool>> StorageProviderImpl::verifyDealProposals(
+      const std::vector<std::shared_ptr<MinerDeal>> &deals,
+      const outcome::result<SignedStorageAsk> &ask) {
+    // signatures are verified concurrently with shared lookups below
+    std::vector<std::future<outcome::result<bool>>> signatures;
+    for (auto &deal : deals) {
+      auto task{std::make_shared<std::packaged_task<outcome::result<bool>()>>(
+          [this, deal] { return verifyDealSignature(deal); })};
+      signatures.push_back(task->get_future());
+      boost::asio::post(*verify_pool_, [task] { (*task)(); });
+    }
 
-    // This doesn't guarantee that the client won't withdraw / lock those funds
-    // but it's a decent first filter
-    OUTCOME_TRY(client_balance,
-                api_->StateMarketBalance(proposal.client, chain_head->key));
-    TokenAmount available = client_balance.escrow - client_balance.locked;
-    if (available < proposal.getTotalStorageFee()) {
-      std::stringstream ss;
-      ss << "Deal proposal verification failed, client market available "
-            "balance too small: "
-         << available << " < " << proposal.getTotalStorageFee();
-      deal->message = ss.str();
-      return false;
+    auto chain_head{api_->ChainHead()};
+    if (chain_head && balances_head_ != chain_head.value()->key) {
+      balances_head_ = chain_head.value()->key;
+      balances_.clear();
     }
 
-    return true;
+    std::vector<outcome::result<bool>> results;
+    for (size_t i{0}; i < deals.size(); ++i) {
+      auto &deal{deals[i]};
+      auto verified{signatures[i].get()};
+      if (!verified || !verified.value()) {
+        if (verified) {
+          deal->message = "Deal proposal verification failed, wrong signature";
+        }
+        results.push_back(verified);
+        continue;
+      }
+      if (!chain_head) {
+        results.push_back(chain_head.error());
+        continue;
+      }
+      if (!ask) {
+        results.push_back(ask.error());
+        continue;
+      }
+      if (!verifyDealTerms(deal, chain_head.value()->epoch(), ask.value())) {
+        results.push_back(false);
+        continue;
+      }
+
+      // This doesn't guarantee that the client won't withdraw / lock those
+      // funds but it's a decent first filter. Balance is looked up once per
+      // client and head, and fees of accepted proposals are reserved from it
+      auto &proposal{deal->client_deal_proposal.proposal};
+      auto it{balances_.find(proposal.client)};
+      if (it == balances_.end()) {
+        auto client_balance{api_->StateMarketBalance(
+            proposal.client, chain_head.value()->key)};
+        if (!client_balance) {
+          results.push_back(client_balance.error());
+          continue;
+        }
+        it = balances_
+                 .emplace(proposal.client,
+                          client_balance.value().escrow
+                              - client_balance.value().locked)
+                 .first;
+      }
+      auto &available{it->second};
+      if (available < proposal.getTotalStorageFee()) {
+        std::stringstream ss;
+        ss << "Deal proposal verification failed, client market available "
+              "balance too small: "
+           << available << " < " << proposal.getTotalStorageFee();
+        deal->message = ss.str();
+        results.push_back(false);
+        continue;
+      }
+      available -= proposal.getTotalStorageFee();
+      results.push_back(true);
+    }
+    return results;
+  }
+
+  void StorageProviderImpl::verifyQueued() {
+    if (verifying_ || verify_queue_.empty()) {
+      return;
+    }
+    verifying_ = true;
+    std::vector<std::shared_ptr<MinerDeal>> deals;
+    std::swap(deals, verify_queue_);
+    auto ask{stored_ask_->getAsk(miner_actor_address_)};
+    boost::asio::post(*verify_pool_, [_self{weak_from_this()}, deals, ask] {
+      auto self{_self.lock()};
+      if (!self) {
+        return;
+      }
+      auto results{self->verifyDealProposals(deals, ask)};
+      auto &context{*self->context_};
+      // provider is released on io context, not on its own pool
+      context.post([self{std::move(self)}, deals, results{std::move(results)}] {
+        for (size_t i{0}; i < deals.size(); ++i) {
+          auto &deal{deals[i]};
+          auto &verified{results[i]};
+          if (!verified) {
+            deal->message = "Deal proposal verify error. "
+                            + verified.error().message();
+          }
+          SELF_FSM_SEND(deal,
+                        verified && verified.value()
+                            ? ProviderEvent::ProviderEventDealAccepted
+                            : ProviderEvent::ProviderEventFailed);
+        }
+        self->verifying_ = false;
+        self->verifyQueued();
+      });
+    });
   }
 
   outcome::result<boost::optional<CID>>
@@ -335,14 +477,18 @@ namespace fc::markets::storage::provider {
     return std::move(maybe_cid);
   }
 
-  outcome::result<CID> StorageProviderImpl::publishDeal(
-      std::shared_ptr<MinerDeal> deal) {
+  outcome::result<CID> StorageProviderImpl::publishDeals(
+      const std::vector<std::shared_ptr<MinerDeal>> &deals) {
     OUTCOME_TRY(chain_head, api_->ChainHead());
     OUTCOME_TRY(
         worker_info,
-        api_->StateMinerInfo(deal->client_deal_proposal.proposal.provider,
-                             chain_head->key));
-    PublishStorageDeals::Params params{{deal->client_deal_proposal}};
+        api_->StateMinerInfo(
+            deals.front()->client_deal_proposal.proposal.provider,
+            chain_head->key));
+    PublishStorageDeals::Params params;
+    for (auto &deal : deals) {
+      params.deals.push_back(deal->client_deal_proposal);
+    }
     OUTCOME_TRY(encoded_params, codec::cbor::encode(params));
     UnsignedMessage unsigned_message(vm::actor::kStorageMarketAddress,
                                      worker_info.worker,
@@ -356,22 +502,136 @@ namespace fc::markets::storage::provider {
                 api_->MpoolPushMessage(unsigned_message, api::kPushNoSpec));
     CID cid = signed_message.getCid();
     OUTCOME_TRY(str_cid, cid.toString());
-    logger_->debug("Deal published with CID = " + str_cid);
+    logger_->debug("Published " + std::to_string(deals.size())
+                   + " deals with CID = " + str_cid);
     return std::move(cid);
   }
 
+  void StorageProviderImpl::queuePublish(std::shared_ptr<MinerDeal> deal) {
+    publish_batch_.push_back(std::move(deal));
+    if (publish_batch_.size() >= publish_batch_config_.max_deals) {
+      publish_timer_.cancel();
+      return flushPublish();
+    }
+    if (publish_batch_.size() != 1) {
+      return;
+    }
+    // first deal of batch starts window
+    publish_timer_.expires_after(publish_batch_config_.window);
+    publish_timer_.async_wait([_self{weak_from_this()}](auto &ec) {
+      if (ec) {
+        return;
+      }
+      if (auto self{_self.lock()}) {
+        self->flushPublish();
+      }
+    });
+  }
+
+  void StorageProviderImpl::flushPublish() {
+    if (publish_batch_.empty()) {
+      return;
+    }
+    std::vector<std::shared_ptr<MinerDeal>> deals;
+    std::swap(deals, publish_batch_);
+    publishBatch(std::move(deals));
+  }
+
+  void StorageProviderImpl::publishBatch(
+      std::vector<std::shared_ptr<MinerDeal>> deals) {
+    auto maybe_cid{publishDeals(deals)};
+    if (!maybe_cid) {
+      return onPublishFailed(
+          std::move(deals),
+          "Publish deal error. " + maybe_cid.error().message());
+    }
+    auto &cid{maybe_cid.value()};
+    for (auto &deal : deals) {
+      // deals of split batch were already initiated
+      auto initiated{deal->publish_cid.has_value()};
+      deal->publish_cid = cid;
+      if (!initiated) {
+        FSM_SEND(deal, ProviderEvent::ProviderEventDealPublishInitiated);
+      }
+    }
+    auto maybe_wait{api_->StateWaitMsg(cid, api::kNoConfidence)};
+    if (!maybe_wait) {
+      return onPublishFailed(
+          std::move(deals),
+          "Wait for publish failed. " + maybe_wait.error().message());
+    }
+    maybe_wait.value().waitOwn([self{shared_from_this()}, deals](
+                                   outcome::result<MsgWait> result) {
+      if (!result) {
+        for (auto &deal : deals) {
+          deal->message = "Publish storage deal message error. "
+                          + result.error().message();
+          SELF_FSM_SEND(deal, ProviderEvent::ProviderEventFailed);
+        }
+        return;
+      }
+      if (result.value().receipt.exit_code != VMExitCode::kOk) {
+        return self->onPublishFailed(
+            deals,
+            "Publish storage deal exit code "
+                + std::to_string(static_cast<uint64_t>(
+                    result.value().receipt.exit_code)));
+      }
+      auto maybe_res = codec::cbor::decode<PublishStorageDeals::Result>(
+          result.value().receipt.return_value);
+      std::string error;
+      if (!maybe_res) {
+        error = "Publish storage deal decode result error. "
+                + maybe_res.error().message();
+      } else if (maybe_res.value().deals.size() != deals.size()) {
+        error = "Publish storage deal result size error";
+      }
+      if (!error.empty()) {
+        for (auto &deal : deals) {
+          deal->message = error;
+          SELF_FSM_SEND(deal, ProviderEvent::ProviderEventFailed);
+        }
+        return;
+      }
+      auto &ids{maybe_res.value().deals};
+      for (size_t i{0}; i < deals.size(); ++i) {
+        deals[i]->deal_id = ids[i];
+        SELF_FSM_SEND(deals[i], ProviderEvent::ProviderEventDealPublished);
+      }
+    });
+  }
+
+  void StorageProviderImpl::onPublishFailed(
+      std::vector<std::shared_ptr<MinerDeal>> deals,
+      const std::string &message) {
+    if (deals.size() == 1) {
+      auto &deal{deals.front()};
+      deal->message = message;
+      FSM_SEND(deal, ProviderEvent::ProviderEventFailed);
+      return;
+    }
+    logger_->warn("Publish of " + std::to_string(deals.size())
+                  + " deals failed, splitting batch. " + message);
+    auto middle{deals.begin() + deals.size() / 2};
+    std::vector<std::shared_ptr<MinerDeal>> left{deals.begin(), middle};
+    std::vector<std::shared_ptr<MinerDeal>> right{middle, deals.end()};
+    publishBatch(std::move(left));
+    publishBatch(std::move(right));
+  }
+
   outcome::result<void> StorageProviderImpl::sendSignedResponse(
-      std::shared_ptr<MinerDeal> deal) {
+      std::shared_ptr<MinerDeal> deal, bool close) {
     Response response{.state = deal->state,
                       .message = deal->message,
-                      .proposal = deal->proposal_cid};
+                      .proposal = deal->proposal_cid,
+                      .publish_message = deal->publish_cid};
     OUTCOME_TRY(encoded_response, codec::cbor::encode(response));
     OUTCOME_TRY(signature, sign(encoded_response));
     SignedResponse signed_response{.response = response,
                                    .signature = signature};
     OUTCOME_TRY(stream, getStream(deal->proposal_cid));
     stream->write(signed_response,
-                  [self{shared_from_this()}, stream, deal](
+                  [self{shared_from_this()}, stream, deal, close](
                       outcome::result<size_t> maybe_res) {
                     if (maybe_res.has_error()) {
                       // assume client disconnected
@@ -379,7 +639,9 @@ namespace fc::markets::storage::provider {
                                            + maybe_res.error().message());
                       return;
                     }
-                    closeStreamGracefully(stream, self->logger_);
+                    if (close) {
+                      closeStreamGracefully(stream, self->logger_);
+                    }
                   });
 
     return outcome::success();
@@ -417,10 +679,9 @@ namespace fc::markets::storage::provider {
     } else {
       locations[deal->ref.root] = {};
     }
-    OUTCOME_TRY(piece_storage_->addPayloadLocations(
-        deal->client_deal_proposal.proposal.piece_cid, locations));
-    OUTCOME_TRY(piece_storage_->addDealForPiece(
+    OUTCOME_TRY(piece_storage_->addPieceDeal(
         deal->client_deal_proposal.proposal.piece_cid,
+        locations,
         DealInfo{.deal_id = deal->deal_id,
                  .sector_id = piece_location.sector_number,
                  .offset = PaddedPieceSize(piece_location.offset),
@@ -448,6 +709,9 @@ namespace fc::markets::storage::provider {
     }
     if (!deal->piece_path.empty()) {
       OUTCOME_TRY(filestore_->remove(deal->piece_path));
+      boost::system::error_code ec;
+      boost::filesystem::remove(
+          fc::storage::car::indexPath(deal->piece_path), ec);
     }
     if (!deal->metadata_path.empty()) {
       OUTCOME_TRY(filestore_->remove(deal->metadata_path));
@@ -522,13 +786,9 @@ namespace fc::markets::storage::provider {
                                                 ProviderEvent event,
                                                 StorageDealStatus from,
                                                 StorageDealStatus to) {
-    auto verified = verifyDealProposal(deal);
-    FSM_HALT_ON_ERROR(verified, "Deal proposal verify error", deal);
-    if (!verified.value()) {
-      FSM_SEND(deal, ProviderEvent::ProviderEventFailed);
-      return;
-    }
-    FSM_SEND(deal, ProviderEvent::ProviderEventDealAccepted);
+    // proposals opened together are verified in one batch on pool
+    verify_queue_.push_back(deal);
+    verifyQueued();
   }
 
   void StorageProviderImpl::onProviderEventDealAccepted(
@@ -537,8 +797,9 @@ namespace fc::markets::storage::provider {
       StorageDealStatus from,
       StorageDealStatus to) {
     deal->state = StorageDealStatus::STORAGE_DEAL_WAITING_FOR_DATA;
+    // client waits on same stream for publish push
     FSM_HALT_ON_ERROR(
-        sendSignedResponse(deal), "Error when sending response", deal);
+        sendSignedResponse(deal, false), "Error when sending response", deal);
 
     FSM_SEND(deal, ProviderEvent::ProviderEventWaitingForManualData);
   }
@@ -578,10 +839,7 @@ namespace fc::markets::storage::provider {
       ProviderEvent event,
       StorageDealStatus from,
       StorageDealStatus to) {
-    auto maybe_cid = publishDeal(deal);
-    FSM_HALT_ON_ERROR(maybe_cid, "Publish deal error", deal);
-    deal->publish_cid = maybe_cid.value();
-    FSM_SEND(deal, ProviderEvent::ProviderEventDealPublishInitiated);
+    queuePublish(deal);
   }
 
   void StorageProviderImpl::onProviderEventDataTransferInitiated(
@@ -605,6 +863,23 @@ namespace fc::markets::storage::provider {
     // if compare pieceCid != deal.Proposal.PieceCID error
     // else ok
 
+    auto received{received_cars_.find(deal->proposal_cid)};
+    if (received != received_cars_.end()) {
+      // car was hashed while blocks were received, empty piece path means
+      // piece is read from store when added to sector
+      received->second.commp->finish([this, deal](auto _commitment) {
+        context_->post([this, deal, _commitment{std::move(_commitment)}] {
+          received_cars_.erase(deal->proposal_cid);
+          FSM_HALT_ON_ERROR(_commitment, "Piece commitment", deal);
+          FSM_HALT_ON_ERROR(
+              onPieceCommitment(deal, _commitment.value().first, ""),
+              "Verify piece commitment",
+              deal);
+        });
+      });
+      return;
+    }
+
     auto _cid_str{deal->proposal_cid.toString()};
     FSM_HALT_ON_ERROR(_cid_str, "CIDtoString", deal);
     auto &cid_str{_cid_str.value()};
@@ -612,6 +887,9 @@ namespace fc::markets::storage::provider {
     auto _error{fc::storage::car::makeSelectiveCar(
         *ipld_, {{deal->ref.root, Selector{}}}, car_path)};
     FSM_HALT_ON_ERROR(_error, "makeSelectiveCar", deal);
+    // staged car is indexed, so its blocks are readable without scan
+    auto _index{fc::storage::car::writeIndex(car_path)};
+    FSM_HALT_ON_ERROR(_index, "writeIndex", deal);
     auto _import{importDataForDeal(deal->proposal_cid, car_path)};
     FSM_HALT_ON_ERROR(_import, "importDataForDeal", deal);
   }
@@ -639,33 +917,7 @@ namespace fc::markets::storage::provider {
       ProviderEvent event,
       StorageDealStatus from,
       StorageDealStatus to) {
-    auto maybe_wait =
-        api_->StateWaitMsg(deal->publish_cid.get(), api::kNoConfidence);
-    FSM_HALT_ON_ERROR(maybe_wait, "Wait for publish failed", deal);
-    maybe_wait.value().waitOwn(
-        [self{shared_from_this()}, deal, to](outcome::result<MsgWait> result) {
-          SELF_FSM_HALT_ON_ERROR(
-              result, "Publish storage deal message error", deal);
-          if (result.value().receipt.exit_code != VMExitCode::kOk) {
-            deal->message = "Publish storage deal exit code "
-                            + std::to_string(static_cast<uint64_t>(
-                                result.value().receipt.exit_code));
-            SELF_FSM_SEND(deal, ProviderEvent::ProviderEventFailed);
-            return;
-          }
-          auto maybe_res = codec::cbor::decode<PublishStorageDeals::Result>(
-              result.value().receipt.return_value);
-          SELF_FSM_HALT_ON_ERROR(
-              maybe_res, "Publish storage deal decode result error", deal);
-          if (maybe_res.value().deals.size() != 1) {
-            deal->message = "Publish storage deal result size error";
-            SELF_FSM_SEND(deal, ProviderEvent::ProviderEventFailed);
-            return;
-          }
-          deal->deal_id = maybe_res.value().deals.front();
-          deal->state = to;
-          SELF_FSM_SEND(deal, ProviderEvent::ProviderEventDealPublished);
-        });
+    // nothing, publish batch waits for message and sends deal ids
   }
 
   void StorageProviderImpl::onProviderEventDealPublished(
@@ -673,12 +925,27 @@ namespace fc::markets::storage::provider {
       ProviderEvent event,
       StorageDealStatus from,
       StorageDealStatus to) {
+    // push publish to client, so it doesn't poll status
+    deal->state = to;
+    if (auto pushed{sendSignedResponse(deal)}; !pushed) {
+      logger_->warn("Push deal published to client. "
+                    + pushed.error().message());
+    }
     // TODO hand off
     auto &p{deal->client_deal_proposal.proposal};
-    OUTCOME_EXCEPT(sector_blocks_->addPiece(
-        p.piece_size.unpadded(),
-        deal->piece_path,
-        {deal->deal_id, {p.start_epoch, p.end_epoch}}));
+    api::DealInfo deal_info{deal->deal_id, {p.start_epoch, p.end_epoch}};
+    if (deal->piece_path.empty()) {
+      // piece is streamed from store to unsealed sector
+      auto reader{pieceio::PieceReader::make(
+          ipld_, deal->ref.root, Selector{}, p.piece_size.unpadded())};
+      FSM_HALT_ON_ERROR(reader, "Read piece", deal);
+      auto added{sector_blocks_->addPiece(
+          p.piece_size.unpadded(), reader.value()->data(), deal_info)};
+      FSM_HALT_ON_ERROR(added, "Add piece", deal);
+    } else {
+      OUTCOME_EXCEPT(sector_blocks_->addPiece(
+          p.piece_size.unpadded(), deal->piece_path, deal_info));
+    }
     FSM_SEND(deal, ProviderEvent::ProviderEventDealHandedOff);
   }
 
@@ -743,9 +1010,13 @@ namespace fc::markets::storage::provider {
         stream->template read<AskRequest>([_asker, stream](auto _request) {
           if (_request) {
             if (auto asker{_asker.lock()}) {
-              if (auto _ask{asker->getAsk(_request.value().miner)}) {
-                return stream->write(AskResponse{_ask.value()},
-                                     [stream](auto) { stream->close(); });
+              auto _response{asker->getAskResponse(_request.value().miner)};
+              if (_response) {
+                auto &response{_response.value()};
+                // bytes are kept alive until written
+                return stream->writeRaw(*response, [stream, response](auto) {
+                  stream->close();
+                });
               }
             }
           }
@@ -757,43 +1028,52 @@ namespace fc::markets::storage::provider {
     handle(kAskProtocolId);
   }
 
+  void readDealStatus(const std::shared_ptr<CborStream> &stream,
+                      std::weak_ptr<StorageProviderImpl> _provider) {
+    stream->read<DealStatusRequest>([_provider, stream](auto _request) {
+      if (!_request) {
+        // client has no more requests
+        return stream->close();
+      }
+      auto &request{_request.value()};
+      // TODO: check client signature
+      if (auto provider{_provider.lock()}) {
+        if (auto _deal{provider->getDeal(request.proposal)}) {
+          auto &deal{_deal.value()};
+          DealStatusResponse response{
+              {
+                  deal.state,
+                  deal.message,
+                  deal.client_deal_proposal.proposal,
+                  deal.proposal_cid,
+                  deal.add_funds_cid,
+                  deal.publish_cid,
+                  deal.deal_id,
+                  // TODO: fast retrieval
+                  false,
+              },
+              {}};
+          OUTCOME_EXCEPT(input, codec::cbor::encode(response.state));
+          if (auto _sig{provider->sign(input)}) {
+            response.signature = std::move(_sig.value());
+            return stream->write(response, [_provider, stream](auto _n) {
+              if (!_n) {
+                return stream->close();
+              }
+              readDealStatus(stream, _provider);
+            });
+          }
+        }
+      }
+      stream->stream()->reset();
+    });
+  }
+
   void serveDealStatus(libp2p::Host &host,
                        std::weak_ptr<StorageProviderImpl> _provider) {
     auto handle{[&](auto &&protocol) {
       host.setProtocolHandler(protocol, [_provider](auto _stream) {
-        auto stream{std::make_shared<common::libp2p::CborStream>(_stream)};
-        stream->template read<DealStatusRequest>(
-            [_provider, stream](auto _request) {
-              if (_request) {
-                auto &request{_request.value()};
-                // TODO: check client signature
-                if (auto provider{_provider.lock()}) {
-                  if (auto _deal{provider->getDeal(request.proposal)}) {
-                    auto &deal{_deal.value()};
-                    DealStatusResponse response{
-                        {
-                            deal.state,
-                            deal.message,
-                            deal.client_deal_proposal.proposal,
-                            deal.proposal_cid,
-                            deal.add_funds_cid,
-                            deal.publish_cid,
-                            deal.deal_id,
-                            // TODO: fast retrieval
-                            false,
-                        },
-                        {}};
-                    OUTCOME_EXCEPT(input, codec::cbor::encode(response.state));
-                    if (auto _sig{provider->sign(input)}) {
-                      response.signature = std::move(_sig.value());
-                      return stream->write(response,
-                                           [stream](auto) { stream->close(); });
-                    }
-                  }
-                }
-              }
-              stream->stream()->reset();
-            });
+        readDealStatus(std::make_shared<CborStream>(_stream), _provider);
       });
     }};
     handle(kDealStatusProtocolId);
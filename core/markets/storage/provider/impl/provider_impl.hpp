@@ -6,13 +6,20 @@
 #ifndef CPP_FILECOIN_MARKETS_STORAGE_PROVIDER_PROVIDER_HPP
 #define CPP_FILECOIN_MARKETS_STORAGE_PROVIDER_PROVIDER_HPP
 
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <chrono>
 #include <libp2p/host/host.hpp>
+#include <map>
 #include <mutex>
+#include <set>
 #include "api/miner_api.hpp"
 #include "common/logger.hpp"
 #include "data_transfer/dt.hpp"
 #include "fsm/fsm.hpp"
 #include "markets/common.hpp"
+#include "markets/pieceio/piece_commitment_stream.hpp"
+#include "markets/pieceio/piece_reader.hpp"
 #include "markets/pieceio/pieceio.hpp"
 #include "markets/storage/chain_events/chain_events.hpp"
 #include "markets/storage/provider/provider.hpp"
@@ -31,11 +38,14 @@ namespace fc::markets::storage::provider {
   using fc::storage::filestore::Path;
   using fc::storage::piece::PieceStorage;
   using libp2p::Host;
+  using pieceio::PieceCommitmentStream;
   using pieceio::PieceIO;
   using primitives::BigInt;
+  using primitives::ChainEpoch;
   using primitives::EpochDuration;
   using primitives::GasAmount;
   using primitives::sector::RegisteredProof;
+  using primitives::tipset::TipsetKey;
   using sectorblocks::SectorBlocks;
   using ProviderTransition =
       fsm::Transition<ProviderEvent, void, StorageDealStatus, MinerDeal>;
@@ -45,8 +55,19 @@ namespace fc::markets::storage::provider {
 
   const EpochDuration kDefaultDealAcceptanceBuffer{100};
 
+  /// Threads verifying deal proposals
+  constexpr size_t kVerifyThreads{4};
+
   const Path kFilestoreTempDir = "/tmp/fuhon/storage-market/";
 
+  /// Funded deals are published together in one PublishStorageDeals message
+  struct PublishBatchConfig {
+    /// Batch is published as soon as it has that many deals
+    size_t max_deals{8};
+    /// Time first deal of batch waits for other deals
+    std::chrono::milliseconds window{0};
+  };
+
   class StorageProviderImpl
       : public StorageProvider,
         public std::enable_shared_from_this<StorageProviderImpl> {
@@ -63,7 +84,8 @@ namespace fc::markets::storage::provider {
                         std::shared_ptr<ChainEvents> events,
                         const Address &miner_actor_address,
                         std::shared_ptr<PieceIO> piece_io,
-                        std::shared_ptr<FileStore> filestore);
+                        std::shared_ptr<FileStore> filestore,
+                        PublishBatchConfig publish_batch = {});
 
     std::shared_ptr<MinerDeal> getDealPtr(const CID &proposal_cid);
 
@@ -98,9 +120,27 @@ namespace fc::markets::storage::provider {
      * @param deal to verify
      * @return true if verified or false otherwise
      */
-    outcome::result<bool> verifyDealProposal(
+    outcome::result<bool> verifyDealSignature(
         std::shared_ptr<MinerDeal> deal) const;
 
+    /// Checks deal provider, start epoch, price and size against ask
+    bool verifyDealTerms(std::shared_ptr<MinerDeal> deal,
+                         ChainEpoch head_epoch,
+                         const SignedStorageAsk &ask) const;
+
+    /**
+     * Verifies proposals opened together, on verify pool. Head is loaded
+     * once, client balances once per client and head, signatures are
+     * verified concurrently
+     * @return true if deal is verified, false with deal message otherwise
+     */
+    std::vector<outcome::result<bool>> verifyDealProposals(
+        const std::vector<std::shared_ptr<MinerDeal>> &deals,
+        const outcome::result<SignedStorageAsk> &ask);
+
+    /// Starts verification of queued proposals unless batch is in progress
+    void verifyQueued();
+
     /**
      * Ensure provider has enough funds
      * @param deal - storage deal
@@ -110,17 +150,50 @@ namespace fc::markets::storage::provider {
         std::shared_ptr<MinerDeal> deal);
 
     /**
-     * Publish storage deal
-     * @param deal to publish
+     * Publish storage deals in one message
+     * @param deals to publish
      * @return CID of message sent
      */
-    outcome::result<CID> publishDeal(std::shared_ptr<MinerDeal> deal);
+    outcome::result<CID> publishDeals(
+        const std::vector<std::shared_ptr<MinerDeal>> &deals);
+
+    /// Adds funded deal to publish batch
+    void queuePublish(std::shared_ptr<MinerDeal> deal);
+
+    /// Publishes queued batch
+    void flushPublish();
 
     /**
-     * Send signed response to storage deal proposal and close connection
+     * Publishes deals, waits for message and sends deal ids to deals.
+     * Failed batch is split in halves and published again, so invalid
+     * proposal fails only its own deal.
+     */
+    void publishBatch(std::vector<std::shared_ptr<MinerDeal>> deals);
+
+    /// Splits failed batch or fails its only deal
+    void onPublishFailed(std::vector<std::shared_ptr<MinerDeal>> deals,
+                         const std::string &message);
+
+    /// Checks piece commitment of deal data and sends verified event
+    outcome::result<void> onPieceCommitment(std::shared_ptr<MinerDeal> deal,
+                                            const CID &piece_cid,
+                                            const std::string &path);
+
+    /// Starts car of pushed deal data, it is hashed as blocks arrive and
+    /// later read from store straight to sector
+    void startReceivedCar(std::shared_ptr<MinerDeal> deal);
+
+    /// Appends received block to deal car
+    void onReceivedBlock(std::shared_ptr<MinerDeal> deal, const CID &cid);
+
+    /**
+     * Send signed response to storage deal proposal
      * @param deal - state of deal
+     * @param close - close connection after response, otherwise it stays open
+     * for status push
      */
-    outcome::result<void> sendSignedResponse(std::shared_ptr<MinerDeal> deal);
+    outcome::result<void> sendSignedResponse(std::shared_ptr<MinerDeal> deal,
+                                             bool close = true);
 
     /**
      * Locate piece for deal
@@ -370,9 +443,34 @@ namespace fc::markets::storage::provider {
     IpldPtr ipld_;
     std::shared_ptr<DataTransfer> datatransfer_;
 
+    /// Car of pushed deal data with blocks already hashed
+    struct ReceivedCar {
+      std::unique_ptr<PieceCommitmentStream> commp;
+      std::set<CID> blocks;
+    };
+    /// Cars being received, by proposal cid
+    std::map<CID, ReceivedCar> received_cars_;
+
+    std::unique_ptr<boost::asio::thread_pool> verify_pool_;
+    /// Opened deals waiting for verification
+    std::vector<std::shared_ptr<MinerDeal>> verify_queue_;
+    bool verifying_{false};
+    /// Client available market balances at head, used by verify pool only
+    TipsetKey balances_head_;
+    std::map<Address, TokenAmount> balances_;
+
+    PublishBatchConfig publish_batch_config_;
+    /// Funded deals waiting for publish
+    std::vector<std::shared_ptr<MinerDeal>> publish_batch_;
+    boost::asio::steady_timer publish_timer_;
+
     common::Logger logger_ = common::createLogger("StorageMarketProvider");
   };
 
+  /**
+   * Serves deal status requests, one stream answers requests until client
+   * closes it, so client asks about all its deals with provider at once
+   */
   void serveDealStatus(libp2p::Host &host,
                        std::weak_ptr<StorageProviderImpl> _provider);
 
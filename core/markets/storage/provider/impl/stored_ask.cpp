@@ -19,6 +19,7 @@ namespace fc::markets::storage::provider {
 
   outcome::result<void> StoredAsk::addAsk(const TokenAmount &price,
                                           ChainEpoch duration) {
+    std::lock_guard lock{mutex_};
     OUTCOME_TRY(chain_head, api_->ChainHead());
     ChainEpoch timestamp = chain_head->height();
     ChainEpoch expiry = chain_head->height() + duration;
@@ -41,11 +42,34 @@ namespace fc::markets::storage::provider {
     if (address != actor_) {
       return StoredAskError::kWrongAddress;
     }
+    std::lock_guard lock{mutex_};
+    OUTCOME_TRY(loadCached());
+    return last_signed_storage_ask_.value();
+  }
+
+  outcome::result<std::shared_ptr<const Buffer>> StoredAsk::getAskResponse(
+      const Address &address) {
+    if (address != actor_) {
+      return StoredAskError::kWrongAddress;
+    }
+    std::lock_guard lock{mutex_};
+    OUTCOME_TRY(loadCached());
+    return encoded_response_;
+  }
+
+  outcome::result<void> StoredAsk::loadCached() {
     if (!last_signed_storage_ask_) {
       OUTCOME_TRY(ask, loadSignedAsk());
-      last_signed_storage_ask_ = ask;
+      OUTCOME_TRY(setCached(std::move(ask)));
     }
-    return last_signed_storage_ask_.value();
+    return outcome::success();
+  }
+
+  outcome::result<void> StoredAsk::setCached(SignedStorageAsk ask) {
+    OUTCOME_TRY(encoded, codec::cbor::encode(AskResponse{ask}));
+    encoded_response_ = std::make_shared<const Buffer>(std::move(encoded));
+    last_signed_storage_ask_ = std::move(ask);
+    return outcome::success();
   }
 
   outcome::result<SignedStorageAsk> StoredAsk::loadSignedAsk() {
@@ -75,8 +99,7 @@ namespace fc::markets::storage::provider {
   outcome::result<void> StoredAsk::saveSignedAsk(const SignedStorageAsk &ask) {
     OUTCOME_TRY(cbored_ask, codec::cbor::encode(ask));
     OUTCOME_TRY(datastore_->put(kBestAskKey, cbored_ask));
-    last_signed_storage_ask_ = ask;
-    return outcome::success();
+    return setCached(ask);
   }
 
   outcome::result<SignedStorageAsk> StoredAsk::signAsk(
@@ -38,6 +38,7 @@ namespace fc::markets::storage::provider {
 
   /**
    * Storage for storage market asks.
+   * Ask is signed and encoded once per change, requests are served from cache.
    */
   class StoredAsk {
    public:
@@ -50,7 +51,24 @@ namespace fc::markets::storage::provider {
 
     auto getAsk(const Address &address) -> outcome::result<SignedStorageAsk>;
 
+    /**
+     * Get cbor encoded ask response, shared bytes stay valid while written to
+     * stream after ask changes
+     */
+    auto getAskResponse(const Address &address)
+        -> outcome::result<std::shared_ptr<const Buffer>>;
+
    private:
+    /**
+     * Loads ask into cache if not loaded yet, called with lock held
+     */
+    auto loadCached() -> outcome::result<void>;
+
+    /**
+     * Sets cached ask and its encoded response
+     */
+    auto setCached(SignedStorageAsk ask) -> outcome::result<void>;
+
     /**
      * Loads last storage ask or creates default one
      */
@@ -65,7 +83,9 @@ namespace fc::markets::storage::provider {
     auto signAsk(const StorageAsk &ask, const Tipset &chain_head)
         -> outcome::result<SignedStorageAsk>;
 
+    std::mutex mutex_;
     boost::optional<SignedStorageAsk> last_signed_storage_ask_;
+    std::shared_ptr<const Buffer> encoded_response_;
     std::shared_ptr<Datastore> datastore_;
     std::shared_ptr<Api> api_;
     Address actor_;
@@ -0,0 +1,70 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "miner/head_hub.hpp"
+
+namespace fc::mining {
+  using primitives::tipset::HeadChangeType;
+
+  outcome::result<std::shared_ptr<HeadHub>> HeadHub::create(
+      std::shared_ptr<Api> api, std::shared_ptr<TipsetCache> tipset_cache) {
+    OUTCOME_TRY(chan, api->ChainNotify());
+    auto hub{std::make_shared<HeadHub>()};
+    hub->tipset_cache_ = std::move(tipset_cache);
+    hub->channel_ = std::move(chan.channel);
+    hub->channel_->read([weak{hub->weak_from_this()}](auto changes) {
+      if (auto hub{weak.lock()}) {
+        return hub->onChanges(changes);
+      }
+      return false;
+    });
+    return hub;
+  }
+
+  Chan<HeadHub::Changes> HeadHub::subscribe() {
+    auto channel{std::make_shared<Channel<Changes>>()};
+    std::lock_guard lock{mutex_};
+    if (head_) {
+      channel->write({{HeadChangeType::CURRENT, head_}});
+    }
+    subscribers_.push_back(channel);
+    return channel;
+  }
+
+  void HeadHub::install(Api &api) {
+    api.ChainNotify =
+        [weak{weak_from_this()}]() -> outcome::result<Chan<Changes>> {
+      if (auto hub{weak.lock()}) {
+        return hub->subscribe();
+      }
+      return std::errc::owner_dead;
+    };
+    api.ChainGetTipSet = [cache{tipset_cache_},
+                          get{std::move(api.ChainGetTipSet)}](
+                             auto &key) -> outcome::result<TipsetCPtr> {
+      if (auto tipset{cache->get(key)}) {
+        return std::move(tipset);
+      }
+      OUTCOME_TRY(tipset, get(key));
+      cache->put(tipset);
+      return std::move(tipset);
+    };
+  }
+
+  bool HeadHub::onChanges(const boost::optional<Changes> &changes) {
+    if (!changes) {
+      return false;
+    }
+    std::lock_guard lock{mutex_};
+    for (auto &change : *changes) {
+      tipset_cache_->put(change.value);
+      if (change.type != HeadChangeType::REVERT) {
+        head_ = change.value;
+      }
+    }
+    adt::writeMany(subscribers_, *changes);
+    return true;
+  }
+}  // namespace fc::mining
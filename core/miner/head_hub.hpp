@@ -0,0 +1,53 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "api/api.hpp"
+#include "primitives/tipset/tipset_cache.hpp"
+
+namespace fc::mining {
+  using adt::Channel;
+  using api::Api;
+  using api::Chan;
+  using primitives::tipset::HeadChange;
+  using primitives::tipset::TipsetCache;
+  using primitives::tipset::TipsetCPtr;
+
+  /**
+   * Single node head change subscription shared by miner components.
+   * Changes are decoded once and written to local channels. New subscriber
+   * gets current head first, as with node subscription. Tipsets of changes
+   * are put into shared tipset cache.
+   */
+  class HeadHub : public std::enable_shared_from_this<HeadHub> {
+   public:
+    using Changes = std::vector<HeadChange>;
+
+    static outcome::result<std::shared_ptr<HeadHub>> create(
+        std::shared_ptr<Api> api,
+        std::shared_ptr<TipsetCache> tipset_cache =
+            std::make_shared<TipsetCache>());
+
+    /// Local subscription, handlers must not subscribe again
+    Chan<Changes> subscribe();
+
+    /**
+     * Replaces ChainNotify of api with local subscription, and
+     * ChainGetTipSet with lookup in shared tipset cache, so components
+     * using api share hub
+     */
+    void install(Api &api);
+
+   private:
+    bool onChanges(const boost::optional<Changes> &changes);
+
+    std::shared_ptr<TipsetCache> tipset_cache_;
+    std::shared_ptr<Channel<Changes>> channel_;
+    std::mutex mutex_;
+    Channel<Changes>::Many subscribers_;
+    TipsetCPtr head_;
+  };
+}  // namespace fc::mining
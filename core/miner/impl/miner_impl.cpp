@@ -29,7 +29,7 @@ namespace fc::miner {
                        Address miner_address,
                        Address worker_address,
                        std::shared_ptr<Counter> counter,
-                       std::shared_ptr<BufferMap> sealing_fsm_kv,
+                       std::shared_ptr<PersistentBufferMap> sealing_fsm_kv,
                        std::shared_ptr<Manager> sector_manager,
                        std::shared_ptr<boost::asio::io_context> context)
       : api_{std::move(api)},
@@ -50,7 +50,10 @@ namespace fc::miner {
     std::shared_ptr<TipsetCache> tipset_cache =
         std::make_shared<TipsetCacheImpl>(
             2 * kGlobalChainConfidence,
-            [=](auto h) { return api_->ChainGetTipSetByHeight(h, {}); });
+            [=](auto h) { return api_->ChainGetTipSetByHeight(h, {}); },
+            [=](auto min, auto max, auto &head) {
+              return api_->ChainGetTipSetRange(min, max, head);
+            });
     std::shared_ptr<Events> events =
         std::make_shared<EventsImpl>(api_, tipset_cache);
     OUTCOME_TRY(events->subscribeHeadChanges());
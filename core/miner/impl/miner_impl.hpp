@@ -30,7 +30,7 @@ namespace fc::miner {
   using primitives::piece::PieceData;
   using primitives::piece::UnpaddedPieceSize;
   using sector_storage::Manager;
-  using storage::BufferMap;
+  using storage::PersistentBufferMap;
 
   class MinerImpl : public Miner {
    public:
@@ -38,7 +38,7 @@ namespace fc::miner {
               Address miner_address,
               Address worker_address,
               std::shared_ptr<Counter> counter,
-              std::shared_ptr<BufferMap> sealing_fsm_kv,
+              std::shared_ptr<PersistentBufferMap> sealing_fsm_kv,
               std::shared_ptr<Manager> sector_manager,
               std::shared_ptr<boost::asio::io_context> context);
 
@@ -72,7 +72,7 @@ namespace fc::miner {
     Address worker_address_;
     std::shared_ptr<Sealing> sealing_;
     std::shared_ptr<Counter> counter_;
-    std::shared_ptr<BufferMap> sealing_fsm_kv_;
+    std::shared_ptr<PersistentBufferMap> sealing_fsm_kv_;
     std::shared_ptr<Manager> sector_manager_;
     std::shared_ptr<boost::asio::io_context> context_;
   };
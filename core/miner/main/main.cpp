@@ -16,12 +16,14 @@
 #include "codec/json/json.hpp"
 #include "common/file.hpp"
 #include "common/peer_key.hpp"
+#include "miner/head_hub.hpp"
 #include "miner/impl/miner_impl.hpp"
 #include "miner/mining.hpp"
 #include "miner/windowpost.hpp"
 #include "proofs/proof_param_provider.hpp"
 #include "sector_storage/impl/manager_impl.hpp"
 #include "sector_storage/impl/scheduler_impl.hpp"
+#include "sector_storage/stores/impl/fetch_handler.hpp"
 #include "sector_storage/stores/impl/index_impl.hpp"
 #include "sector_storage/stores/impl/local_store.hpp"
 #include "sector_storage/stores/impl/storage_impl.hpp"
@@ -41,6 +43,8 @@ namespace fc {
 
   static const Buffer kActor{cbytes("actor")};
 
+  constexpr size_t kWindowPoStThreads{4};
+
   struct Config {
     boost::filesystem::path repo_path;
     std::pair<Multiaddress, std::string> node_api{
@@ -48,6 +52,8 @@ namespace fc {
     boost::optional<Address> actor, owner, worker;
     boost::optional<RegisteredSealProof> seal_type;
     int api_port;
+    /// PreCommit1 sectors started together on one worker
+    size_t pc1_batch;
 
     auto join(const std::string &path) const {
       return (repo_path / path).string();
@@ -73,6 +79,7 @@ namespace fc {
     option("owner", po::value(&raw.owner));
     option("worker", po::value(&raw.worker));
     option("sector-size", po::value(&raw.sector_size));
+    option("pc1-batch", po::value(&config.pc1_batch)->default_value(1));
 
     po::variables_map vm;
     po::store(parse_command_line(argc, argv, desc), vm);
@@ -268,10 +275,14 @@ namespace fc {
     OUTCOME_TRY(setupMiner(config, *leveldb, host->getId()));
 
     auto napi{std::make_shared<api::Api>()};
-    api::rpc::Client wsc{*io};
+    // PoSt and sealing calls don't wait behind large responses
+    api::rpc::ClientPool wsc{*io};
     wsc.setup(*napi);
     OUTCOME_TRY(wsc.connect(config.node_api.first, config.node_api.second));
     OUTCOME_TRY(minfo, napi->StateMinerInfo(*config.actor, {}));
+    // one node subscription for events, window post and markets
+    OUTCOME_TRY(head_hub, mining::HeadHub::create(napi));
+    head_hub->install(*napi);
 
     host->start();
     OUTCOME_TRY(node_peer, napi->NetAddrsListen());
@@ -299,21 +310,30 @@ namespace fc {
                 sector_storage::stores::LocalStoreImpl::newLocalStore(
                     storage,
                     std::make_shared<sector_storage::stores::SectorIndexImpl>(),
-                    std::vector<std::string>{"http://127.0.0.1"},
+                    std::vector<std::string>{
+                        "http://127.0.0.1:" + std::to_string(config.api_port)
+                        + "/remote"},
                     scheduler));
+    auto sealing_scheduler{std::make_shared<sector_storage::SchedulerImpl>(
+        minfo.seal_proof_type,
+        std::make_shared<sector_storage::TaskCalibration>(
+            prefixed("task_calibration/")))};
+    sealing_scheduler->setTaskBatch(primitives::kTTPreCommit1,
+                                    config.pc1_batch);
     OUTCOME_TRY(
         manager,
         sector_storage::ManagerImpl::newManager(
             std::make_shared<sector_storage::stores::RemoteStoreImpl>(
                 local_store, std::unordered_map<std::string, std::string>{}),
-            std::make_shared<sector_storage::SchedulerImpl>(
-                minfo.seal_proof_type),
+            sealing_scheduler,
             {true, true, true, true}));
     auto miner{std::make_shared<miner::MinerImpl>(
         napi,
         *config.actor,
         *config.worker,
-        std::make_shared<primitives::StoredCounter>(leveldb, "sector_counter"),
+        // reserve sector numbers in blocks, unused ones are skipped on restart
+        std::make_shared<primitives::StoredCounter>(
+            leveldb, "sector_counter", 100),
         prefixed("sealing_fsm/"),
         manager,
         io)};
@@ -325,14 +345,24 @@ namespace fc {
         mining::Mining::create(scheduler, clock, napi, manager, *config.actor));
     mining->start();
 
+    // partition batches of deadline are proved in parallel
+    auto window_pool{std::make_shared<boost::asio::thread_pool>(
+        kWindowPoStThreads)};
     auto window{mining::WindowPoStScheduler::create(
-        napi, manager, manager, *config.actor)};
+        napi, manager, manager, *config.actor, io, window_pool)};
 
     auto mapi{std::make_shared<api::Api>()};
     mapi->PledgeSector = [&]() -> outcome::result<void> {
       return sealing->pledgeSector();
     };
-    api::serve(mapi, *io, "127.0.0.1", config.api_port);
+    api::serve(
+        mapi,
+        *io,
+        "127.0.0.1",
+        config.api_port,
+        nullptr,
+        api::kPooledMethods,
+        {{"/remote", sector_storage::stores::FetchHandler{local_store}}});
     api::rpc::saveInfo(config.repo_path, config.api_port, "stub");
 
     spdlog::info("fuhon miner started");
@@ -5,6 +5,8 @@
 
 #include "miner/mining.hpp"
 
+#include <future>
+
 #include "const.hpp"
 #include "vm/actor/builtin/v0/market/policy.hpp"
 #include "vm/runtime/pricelist.hpp"
@@ -48,6 +50,10 @@ namespace fc::mining {
 
   void Mining::waitParent() {
     OUTCOME_LOG("Mining::waitParent error", bestParent());
+    // base info is computed by node while waiting for parent time and beacon
+    if (mined.count({ts->key, skip}) == 0) {
+      OUTCOME_LOG("Mining::prefetchInfo error", prefetchInfo());
+    }
     wait(ts->getMinTimestamp() + propagation, true, [this] {
       OUTCOME_LOG("Mining::waitBeacon error", waitBeacon());
     });
@@ -66,17 +72,57 @@ namespace fc::mining {
     OUTCOME_TRY(bestParent());
     if (!mined.emplace(ts->key, skip).second) {
       wait(block_delay, false, [this] { waitParent(); });
+      return outcome::success();
+    }
+    // no-op if parent didn't change since waitParent
+    OUTCOME_TRY(prefetchInfo());
+    if (info_result) {
+      onInfo();
     } else {
-      OUTCOME_TRY(_wait, api->MinerGetBaseInfo(miner, height(), ts->key));
-      _wait.waitOwn([self{shared_from_this()}](auto _info) {
-        OUTCOME_LOG("Mining::waitInfo error", _info);
-        self->info = std::move(_info.value());
-        OUTCOME_LOG("Mining::prepare error", self->prepare());
-      });
+      info_wanted = true;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Mining::prefetchInfo() {
+    std::pair key{ts->key, skip};
+    if (info_for && *info_for == key) {
+      return outcome::success();
     }
+    info_for = key;
+    info_result.reset();
+    info_wanted = false;
+    OUTCOME_TRY(_wait, api->MinerGetBaseInfo(miner, height(), ts->key));
+    _wait.waitOwn([self{shared_from_this()}, key](auto _info) {
+      if (!self->info_for || *self->info_for != key) {
+        // parent changed
+        return;
+      }
+      self->info_result = std::move(_info);
+      if (self->info_wanted) {
+        self->info_wanted = false;
+        self->onInfo();
+      }
+    });
     return outcome::success();
   }
 
+  void Mining::onInfo() {
+    auto _info{std::move(*info_result)};
+    info_result.reset();
+    OUTCOME_LOG("Mining::waitInfo error", _info);
+    info = std::move(_info.value());
+    if (info && info->has_min_power && !info->sectors.empty()) {
+      // challenged sectors are known with beacon, disk reads overlap with
+      // election and proof is generated from page cache if block is won
+      auto _prewarm{prover->prewarmWinningPoSt(miner.getId(), info->sectors)};
+      if (!_prewarm) {
+        spdlog::warn("Mining::prewarm error: {}", _prewarm.error().message());
+      }
+    }
+    OUTCOME_LOG("Mining::prepare error", prepare());
+  }
+
   outcome::result<void> Mining::prepare() {
     OUTCOME_TRY(block1, prepareBlock());
     auto time{ts->getMinTimestamp() + (skip + 1) * block_delay};
@@ -136,7 +182,6 @@ namespace fc::mining {
         .detach();
   }
 
-  constexpr auto kTicketRandomnessLookback{1};
   outcome::result<boost::optional<BlockTemplate>> Mining::prepareBlock() {
     if (info && info->has_min_power) {
       auto vrf{[&](auto tag,
@@ -163,25 +208,35 @@ namespace fc::mining {
                      bigdiv(100 * info->miner_power, info->network_power),
                      common::hex_lower(election_vrf));
 
+        // proof is generated while ticket is signed and messages selected
+        auto post_future{std::async(
+            std::launch::async,
+            [this,
+             post_rand{drawRandomness(
+                 info->beacon().data,
+                 DomainSeparationTag::WinningPoStChallengeSeed,
+                 height(),
+                 miner_seed)}] {
+              return prover->generateWinningPoSt(
+                  miner.getId(), info->sectors, post_rand);
+            })};
         auto ticket_seed{miner_seed};
         if (height() > kUpgradeSmokeHeight) {
           ticket_seed.put(ts->getMinTicketBlock().ticket->bytes);
         }
-        OUTCOME_TRY(ticket_vrf,
-                    vrf(DomainSeparationTag::TicketProduction,
-                        height() - kTicketRandomnessLookback,
-                        ticket_seed));
-        OUTCOME_TRY(
-            post_proof,
-            prover->generateWinningPoSt(
-                miner.getId(),
-                info->sectors,
-                drawRandomness(info->beacon().data,
-                               DomainSeparationTag::WinningPoStChallengeSeed,
-                               height(),
-                               miner_seed)));
-        OUTCOME_TRY(messages,
-                    api->MpoolSelect(ts->key, ticketQuality(ticket_vrf)));
+        auto _ticket_vrf{vrf(DomainSeparationTag::TicketProduction,
+                             height() - kTicketRandomnessLookback,
+                             ticket_seed)};
+        auto _messages{
+            [&]() -> outcome::result<std::vector<SignedMessage>> {
+              OUTCOME_TRY(ticket_vrf, _ticket_vrf);
+              return api->MpoolSelect(ts->key, ticketQuality(ticket_vrf));
+            }()};
+        // wait proof before leaving scope, task references this
+        auto _post_proof{post_future.get()};
+        OUTCOME_TRY(ticket_vrf, _ticket_vrf);
+        OUTCOME_TRY(messages, _messages);
+        OUTCOME_TRY(post_proof, _post_proof);
         return BlockTemplate{
             miner,
             ts->key.cids(),
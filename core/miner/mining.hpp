@@ -45,6 +45,9 @@ namespace fc::mining {
     void waitParent();
     outcome::result<void> waitBeacon();
     outcome::result<void> waitInfo();
+    /// Request base info for current parent ahead of its use
+    outcome::result<void> prefetchInfo();
+    void onInfo();
     outcome::result<void> prepare();
     outcome::result<void> submit(BlockTemplate block1);
     outcome::result<void> bestParent();
@@ -63,6 +66,12 @@ namespace fc::mining {
     size_t skip{};
     std::unordered_set<std::pair<TipsetKey, size_t>, pair_hash> mined;
     boost::optional<MiningBaseInfo> info;
+    /// Parent and skip of requested base info
+    boost::optional<std::pair<TipsetKey, size_t>> info_for;
+    boost::optional<outcome::result<boost::optional<MiningBaseInfo>>>
+        info_result;
+    /// waitInfo is waiting for requested base info
+    bool info_wanted{};
   };
 
   int64_t computeWinCount(BytesIn ticket,
@@ -12,30 +12,25 @@
 #include "storage/ipfs/api_ipfs_datastore/api_ipfs_datastore.hpp"
 #include "storage/ipfs/api_ipfs_datastore/api_ipfs_datastore_error.hpp"
 #include "vm/actor/builtin/v0/codes.hpp"
+#include "vm/actor/builtin/v0/market/actor.hpp"
 #include "vm/actor/builtin/v2/codes.hpp"
 #include "vm/actor/builtin/v2/miner/actor.hpp"
 
 namespace fc::mining::checks {
   using crypto::randomness::DomainSeparationTag;
-  using primitives::BigInt;
+  using crypto::randomness::Randomness;
   using primitives::ChainEpoch;
-  using primitives::DealId;
-  using primitives::sector::OnChainSealVerifyInfo;
+  using primitives::piece::PieceInfo;
+  using primitives::sector::RegisteredProof;
   using primitives::sector::SealVerifyInfo;
   using proofs::Proofs;
   using sector_storage::zerocomm::getZeroPieceCommitment;
   using storage::ipfs::ApiIpfsDatastore;
-  using vm::VMExitCode;
   using vm::actor::kStorageMarketAddress;
-  using vm::actor::MethodParams;
-  using vm::actor::builtin::v0::market::ComputeDataCommitment;
   using vm::actor::builtin::v0::miner::kChainFinalityish;
   using vm::actor::builtin::v0::miner::kPreCommitChallengeDelay;
   using vm::actor::builtin::v0::miner::maxSealDuration;
   using vm::actor::builtin::v0::miner::SectorPreCommitOnChainInfo;
-  using vm::message::kDefaultGasLimit;
-  using vm::message::kDefaultGasPrice;
-  using vm::message::UnsignedMessage;
 
   outcome::result<EpochDuration> getMaxProveCommitDuration(
       NetworkVersion network, const std::shared_ptr<SectorInfo> &sector_info) {
@@ -48,69 +43,262 @@ namespace fc::mining::checks {
     }
   }
 
-  outcome::result<void> checkPieces(
-      const std::shared_ptr<SectorInfo> &sector_info,
-      const std::shared_ptr<Api> &api) {
-    OUTCOME_TRY(chain_head, api->ChainHead());
+  namespace {
+    using MarketActorState = vm::actor::builtin::v0::market::State;
+    using MinerActorState = vm::actor::builtin::v0::miner::MinerActorState;
+
+    /// State read once per check cycle and shared by checked sectors
+    struct Snapshot {
+      explicit Snapshot(const std::shared_ptr<Api> &api)
+          : api{api}, ipfs{std::make_shared<ApiIpfsDatastore>(api)} {}
+
+      /**
+       * Deal proposals are looked up in this state, with batched reads.
+       * Not loaded if sectors have no deals.
+       */
+      outcome::result<MarketActorState *> market(
+          const TipsetKey &tipset_key,
+          const std::vector<std::shared_ptr<SectorInfo>> &sectors) {
+        auto deals{std::any_of(sectors.begin(), sectors.end(), [](auto &s) {
+          return !s->getDealIDs().empty();
+        })};
+        if (!deals) {
+          return nullptr;
+        }
+        if (!market_state) {
+          OUTCOME_TRY(actor,
+                      api->StateGetActor(kStorageMarketAddress, tipset_key));
+          OUTCOME_TRYA(market_state,
+                       ipfs->getCbor<MarketActorState>(actor.head));
+        }
+        return &*market_state;
+      }
+
+      outcome::result<MinerActorState *> miner(const Address &miner_address,
+                                               const TipsetKey &tipset_key) {
+        if (!miner_state) {
+          OUTCOME_TRY(actor, api->StateGetActor(miner_address, tipset_key));
+          MinerActorState state;
+          if (actor.code == vm::actor::builtin::v0::kStorageMinerCodeCid) {
+            OUTCOME_TRYA(state, ipfs->getCbor<MinerActorState>(actor.head));
+          } else if (actor.code
+                     == vm::actor::builtin::v2::kStorageMinerCodeCid) {
+            OUTCOME_TRY(state2,
+                        ipfs->getCbor<vm::actor::builtin::v2::miner::State>(
+                            actor.head));
+            state.precommitted_sectors = state2.precommitted_sectors;
+            state.allocated_sectors = state2.allocated_sectors;
+          } else {
+            return ChecksError::kMinerVersion;
+          }
+          miner_state = std::move(state);
+        }
+        return &*miner_state;
+      }
 
-    for (const auto &piece : sector_info->pieces) {
-      if (!piece.deal_info.has_value()) {
-        OUTCOME_TRY(expected_cid,
-                    getZeroPieceCommitment(piece.piece.size.unpadded()));
-        if (piece.piece.cid != expected_cid) {
+      std::shared_ptr<Api> api;
+      std::shared_ptr<ApiIpfsDatastore> ipfs;
+      boost::optional<MarketActorState> market_state;
+      boost::optional<MinerActorState> miner_state;
+    };
+
+    outcome::result<void> checkPiecesIn(const SectorInfo &sector_info,
+                                        ChainEpoch epoch,
+                                        MarketActorState *market) {
+      for (const auto &piece : sector_info.pieces) {
+        if (!piece.deal_info.has_value()) {
+          OUTCOME_TRY(expected_cid,
+                      getZeroPieceCommitment(piece.piece.size.unpadded()));
+          if (piece.piece.cid != expected_cid) {
+            return ChecksError::kInvalidDeal;
+          }
+          continue;
+        }
+
+        OUTCOME_TRY(proposal,
+                    market->proposals.get(piece.deal_info->deal_id));
+
+        if (piece.piece.cid != proposal.piece_cid) {
+          return ChecksError::kInvalidDeal;
+        }
+
+        if (piece.piece.size != proposal.piece_size) {
           return ChecksError::kInvalidDeal;
         }
-        continue;
+
+        if (epoch >= proposal.start_epoch) {
+          return ChecksError::kExpiredDeal;
+        }
+      }
+      return outcome::success();
+    }
+
+    /// Computes data commitment like ComputeDataCommitment of market actor
+    outcome::result<CID> getDataCommitment(const SectorInfo &sector_info,
+                                           MarketActorState *market) {
+      std::vector<PieceInfo> pieces;
+      for (const auto &deal_id : sector_info.getDealIDs()) {
+        OUTCOME_TRY(deal, market->proposals.get(deal_id));
+        pieces.push_back(PieceInfo{.size = deal.piece_size,
+                                   .cid = deal.piece_cid});
       }
+      return Proofs::generateUnsealedCID(sector_info.sector_type, pieces, true);
+    }
 
-      OUTCOME_TRY(proposal,
-                  api->StateMarketStorageDeal(piece.deal_info->deal_id,
-                                              chain_head->key));
+    outcome::result<boost::optional<SectorPreCommitOnChainInfo>>
+    getPreCommitInfo(MinerActorState &state, const SectorInfo &sector_info) {
+      boost::optional<SectorPreCommitOnChainInfo> result;
+      OUTCOME_TRY(has,
+                  state.precommitted_sectors.has(sector_info.sector_number));
+      if (has) {
+        OUTCOME_TRYA(result,
+                     state.precommitted_sectors.get(sector_info.sector_number));
+      } else {
+        OUTCOME_TRY(allocated_bitset, state.allocated_sectors.get());
+        if (allocated_bitset.has(sector_info.sector_number)) {
+          return ChecksError::kSectorAllocated;
+        }
+      }
+      return result;
+    }
 
-      if (piece.piece.cid != proposal.proposal.piece_cid) {
-        return ChecksError::kInvalidDeal;
+    outcome::result<void> checkPrecommitIn(
+        const std::shared_ptr<SectorInfo> &sector_info,
+        ChainEpoch height,
+        NetworkVersion network,
+        MarketActorState *market,
+        MinerActorState &miner) {
+      OUTCOME_TRY(commD, getDataCommitment(*sector_info, market));
+      if (commD != sector_info->comm_d) {
+        return ChecksError::kBadCommD;
       }
 
-      if (piece.piece.size != proposal.proposal.piece_size) {
-        return ChecksError::kInvalidDeal;
+      OUTCOME_TRY(seal_duration,
+                  getMaxProveCommitDuration(network, sector_info));
+      if (height - (sector_info->ticket_epoch + kChainFinalityish)
+          > seal_duration) {
+        return ChecksError::kExpiredTicket;
       }
 
-      if (chain_head->epoch() >= proposal.proposal.start_epoch) {
-        return ChecksError::kExpiredDeal;
+      OUTCOME_TRY(state_sector_precommit_info,
+                  getPreCommitInfo(miner, *sector_info));
+      if (state_sector_precommit_info.has_value()) {
+        if (state_sector_precommit_info.value().info.seal_epoch
+            != sector_info->ticket_epoch) {
+          return ChecksError::kBadTicketEpoch;
+        }
+        return ChecksError::kPrecommitOnChain;
       }
+      return outcome::success();
     }
 
-    return outcome::success();
-  }
+    /// Seed randomness of sectors, sectors with same seed epoch share call
+    using Seeds = std::map<ChainEpoch, outcome::result<Randomness>>;
 
-  outcome::result<CID> getDataCommitment(
-      const Address &miner_address,
-      const std::shared_ptr<SectorInfo> &sector_info,
-      const TipsetKey &tipset_key,
-      const std::shared_ptr<Api> &api) {
-    std::vector<DealId> deal_ids;
-    for (const auto &piece : sector_info->pieces) {
-      if (piece.deal_info.has_value()) {
-        deal_ids.push_back(piece.deal_info->deal_id);
+    outcome::result<void> checkCommitIn(const Address &miner_address,
+                                        const SectorInfo &sector_info,
+                                        const Proof &proof,
+                                        const TipsetKey &tipset_key,
+                                        const std::shared_ptr<Api> &api,
+                                        MinerActorState &miner,
+                                        RegisteredProof seal_proof_type,
+                                        Seeds &seeds) {
+      if (sector_info.seed_epoch == 0) {
+        return ChecksError::kBadSeed;
+      }
+
+      auto maybe_precomit_info = getPreCommitInfo(miner, sector_info);
+
+      if (maybe_precomit_info.has_error()) {
+        if (maybe_precomit_info
+                == outcome::failure(ChecksError::kSectorAllocated)
+            && sector_info.message.has_value()) {
+          return ChecksError::kCommitWaitFail;
+        }
+
+        return maybe_precomit_info.error();
+      }
+
+      auto state_sector_precommit_info = maybe_precomit_info.value();
+      if (!state_sector_precommit_info.has_value()) {
+        return ChecksError::kPrecommitNotFound;
+      }
+
+      if (state_sector_precommit_info->precommit_epoch
+              + kPreCommitChallengeDelay
+          != sector_info.seed_epoch) {
+        return ChecksError::kBadSeed;
+      }
+
+      auto seed_it{seeds.find(sector_info.seed_epoch)};
+      if (seed_it == seeds.end()) {
+        OUTCOME_TRY(miner_address_encoded, codec::cbor::encode(miner_address));
+        seed_it = seeds
+                      .emplace(sector_info.seed_epoch,
+                               api->ChainGetRandomnessFromBeacon(
+                                   tipset_key,
+                                   DomainSeparationTag::
+                                       InteractiveSealChallengeSeed,
+                                   sector_info.seed_epoch,
+                                   miner_address_encoded))
+                      .first;
+      }
+      OUTCOME_TRY(seed, seed_it->second);
+      if (seed != sector_info.seed) {
+        return ChecksError::kBadSeed;
+      }
+
+      if (sector_info.comm_r != state_sector_precommit_info->info.sealed_cid) {
+        return ChecksError::kBadSealedCid;
       }
+      OUTCOME_TRY(
+          verified,
+          Proofs::verifySeal(SealVerifyInfo{
+              .seal_proof = seal_proof_type,
+              .sector = SectorId{.miner = miner_address.getId(),
+                                 .sector = sector_info.sector_number},
+              .deals = {},
+              .randomness = sector_info.ticket,
+              .interactive_randomness = sector_info.seed,
+              .proof = proof,
+              .sealed_cid = state_sector_precommit_info->info.sealed_cid,
+              .unsealed_cid = sector_info.comm_d.get()}));
+      if (!verified) {
+        return ChecksError::kInvalidProof;
+      }
+
+      return outcome::success();
+    }
+
+    /// Result of single sector batch check
+    outcome::result<void> single(const outcome::result<BatchChecks> &checks,
+                                 SectorNumber sector) {
+      if (!checks) {
+        return checks.error();
+      }
+      return checks.value().at(sector);
     }
-    ComputeDataCommitment::Params params{
-        .deals = deal_ids, .sector_type = sector_info->sector_type};
-    OUTCOME_TRY(encoded_params, codec::cbor::encode(params));
-    UnsignedMessage message{kStorageMarketAddress,
-                            miner_address,
-                            {},
-                            BigInt{0},
-                            kDefaultGasPrice,
-                            kDefaultGasLimit,
-                            ComputeDataCommitment::Number,
-                            MethodParams{encoded_params}};
-    OUTCOME_TRY(invocation_result, api->StateCall(message, tipset_key));
-    if (invocation_result.receipt.exit_code != VMExitCode::kOk) {
-      return ChecksError::kInvocationErrored;
+  }  // namespace
+
+  outcome::result<void> checkPieces(
+      const std::shared_ptr<SectorInfo> &sector_info,
+      const std::shared_ptr<Api> &api) {
+    return single(checkPiecesBatch({sector_info}, api),
+                  sector_info->sector_number);
+  }
+
+  outcome::result<BatchChecks> checkPiecesBatch(
+      const std::vector<std::shared_ptr<SectorInfo>> &sectors,
+      const std::shared_ptr<Api> &api) {
+    OUTCOME_TRY(chain_head, api->ChainHead());
+    Snapshot snapshot{api};
+    OUTCOME_TRY(market, snapshot.market(chain_head->key, sectors));
+    BatchChecks checks;
+    for (const auto &sector_info : sectors) {
+      checks.emplace(sector_info->sector_number,
+                     checkPiecesIn(*sector_info, chain_head->epoch(), market));
     }
-    return codec::cbor::decode<ComputeDataCommitment::Result>(
-        invocation_result.receipt.return_value);
+    return checks;
   }
 
   outcome::result<boost::optional<SectorPreCommitOnChainInfo>>
@@ -118,34 +306,9 @@ namespace fc::mining::checks {
                               const std::shared_ptr<SectorInfo> &sector_info,
                               const TipsetKey &tipset_key,
                               const std::shared_ptr<Api> &api) {
-    boost::optional<SectorPreCommitOnChainInfo> result;
-
-    OUTCOME_TRY(actor, api->StateGetActor(miner_address, tipset_key));
-    auto ipfs = std::make_shared<ApiIpfsDatastore>(api);
-    vm::actor::builtin::v0::miner::MinerActorState state;
-    if (actor.code == vm::actor::builtin::v0::kStorageMinerCodeCid) {
-      OUTCOME_TRYA(state, ipfs->getCbor<decltype(state)>(actor.head));
-    } else if (actor.code == vm::actor::builtin::v2::kStorageMinerCodeCid) {
-      OUTCOME_TRY(
-          state2,
-          ipfs->getCbor<vm::actor::builtin::v2::miner::State>(actor.head));
-      state.precommitted_sectors = state2.precommitted_sectors;
-      state.allocated_sectors = state2.allocated_sectors;
-    } else {
-      return ChecksError::kMinerVersion;
-    }
-    OUTCOME_TRY(has,
-                state.precommitted_sectors.has(sector_info->sector_number));
-    if (has) {
-      OUTCOME_TRYA(result,
-                   state.precommitted_sectors.get(sector_info->sector_number));
-    } else {
-      OUTCOME_TRY(allocated_bitset, state.allocated_sectors.get());
-      if (allocated_bitset.has(sector_info->sector_number)) {
-        return ChecksError::kSectorAllocated;
-      }
-    }
-    return result;
+    Snapshot snapshot{api};
+    OUTCOME_TRY(miner, snapshot.miner(miner_address, tipset_key));
+    return getPreCommitInfo(*miner, *sector_info);
   }
 
   outcome::result<void> checkPrecommit(
@@ -154,31 +317,28 @@ namespace fc::mining::checks {
       const TipsetKey &tipset_key,
       const ChainEpoch &height,
       const std::shared_ptr<Api> &api) {
-    OUTCOME_TRY(commD,
-                getDataCommitment(miner_address, sector_info, tipset_key, api));
-    if (commD != sector_info->comm_d) {
-      return ChecksError::kBadCommD;
-    }
+    return single(checkPrecommitBatch(
+                      miner_address, {sector_info}, tipset_key, height, api),
+                  sector_info->sector_number);
+  }
 
+  outcome::result<BatchChecks> checkPrecommitBatch(
+      const Address &miner_address,
+      const std::vector<std::shared_ptr<SectorInfo>> &sectors,
+      const TipsetKey &tipset_key,
+      const ChainEpoch &height,
+      const std::shared_ptr<Api> &api) {
     OUTCOME_TRY(network, api->StateNetworkVersion(tipset_key));
-    OUTCOME_TRY(seal_duration, getMaxProveCommitDuration(network, sector_info));
-    if (height - (sector_info->ticket_epoch + kChainFinalityish)
-        > seal_duration) {
-      return ChecksError::kExpiredTicket;
+    Snapshot snapshot{api};
+    OUTCOME_TRY(market, snapshot.market(tipset_key, sectors));
+    OUTCOME_TRY(miner, snapshot.miner(miner_address, tipset_key));
+    BatchChecks checks;
+    for (const auto &sector_info : sectors) {
+      checks.emplace(
+          sector_info->sector_number,
+          checkPrecommitIn(sector_info, height, network, market, *miner));
     }
-
-    OUTCOME_TRY(state_sector_precommit_info,
-                getStateSectorPreCommitInfo(
-                    miner_address, sector_info, tipset_key, api));
-    if (state_sector_precommit_info.has_value()) {
-      if (state_sector_precommit_info.value().info.seal_epoch
-          != sector_info->ticket_epoch) {
-        return ChecksError::kBadTicketEpoch;
-      }
-      return ChecksError::kPrecommitOnChain;
-    }
-
-    return outcome::success();
+    return checks;
   }
 
   outcome::result<void> checkCommit(
@@ -187,64 +347,42 @@ namespace fc::mining::checks {
       const Proof &proof,
       const TipsetKey &tipset_key,
       const std::shared_ptr<Api> &api) {
-    if (sector_info->seed_epoch == 0) {
-      return ChecksError::kBadSeed;
-    }
-
-    auto maybe_precomit_info = getStateSectorPreCommitInfo(
-        miner_address, sector_info, tipset_key, api);
-
-    if (maybe_precomit_info.has_error()) {
-      if (maybe_precomit_info == outcome::failure(ChecksError::kSectorAllocated)
-          && sector_info->message.has_value()) {
-        return ChecksError::kCommitWaitFail;
-      }
-
-      return maybe_precomit_info.error();
-    }
-
-    auto state_sector_precommit_info = maybe_precomit_info.value();
-    if (!state_sector_precommit_info.has_value()) {
-      return ChecksError::kPrecommitNotFound;
-    }
-
-    if (state_sector_precommit_info->precommit_epoch + kPreCommitChallengeDelay
-        != sector_info->seed_epoch) {
-      return ChecksError::kBadSeed;
-    }
-
-    OUTCOME_TRY(miner_address_encoded, codec::cbor::encode(miner_address));
-    OUTCOME_TRY(seed,
-                api->ChainGetRandomnessFromBeacon(
-                    tipset_key,
-                    DomainSeparationTag::InteractiveSealChallengeSeed,
-                    sector_info->seed_epoch,
-                    miner_address_encoded));
-    if (seed != sector_info->seed) {
-      return ChecksError::kBadSeed;
-    }
-
+    Snapshot snapshot{api};
+    OUTCOME_TRY(miner, snapshot.miner(miner_address, tipset_key));
     OUTCOME_TRY(minfo, api->StateMinerInfo(miner_address, tipset_key));
+    Seeds seeds;
+    return checkCommitIn(miner_address,
+                         *sector_info,
+                         proof,
+                         tipset_key,
+                         api,
+                         *miner,
+                         minfo.seal_proof_type,
+                         seeds);
+  }
 
-    if (sector_info->comm_r != state_sector_precommit_info->info.sealed_cid) {
-      return ChecksError::kBadSealedCid;
-    }
-    OUTCOME_TRY(verified,
-                Proofs::verifySeal(SealVerifyInfo{
-                    .seal_proof = minfo.seal_proof_type,
-                    .sector = SectorId{.miner = miner_address.getId(),
-                                       .sector = sector_info->sector_number},
-                    .deals = {},
-                    .randomness = sector_info->ticket,
-                    .interactive_randomness = sector_info->seed,
-                    .proof = proof,
-                    .sealed_cid = state_sector_precommit_info->info.sealed_cid,
-                    .unsealed_cid = sector_info->comm_d.get()}));
-    if (!verified) {
-      return ChecksError::kInvalidProof;
+  outcome::result<BatchChecks> checkCommitBatch(
+      const Address &miner_address,
+      const std::vector<std::shared_ptr<SectorInfo>> &sectors,
+      const TipsetKey &tipset_key,
+      const std::shared_ptr<Api> &api) {
+    Snapshot snapshot{api};
+    OUTCOME_TRY(miner, snapshot.miner(miner_address, tipset_key));
+    OUTCOME_TRY(minfo, api->StateMinerInfo(miner_address, tipset_key));
+    Seeds seeds;
+    BatchChecks checks;
+    for (const auto &sector_info : sectors) {
+      checks.emplace(sector_info->sector_number,
+                     checkCommitIn(miner_address,
+                                   *sector_info,
+                                   sector_info->proof,
+                                   tipset_key,
+                                   api,
+                                   *miner,
+                                   minfo.seal_proof_type,
+                                   seeds));
     }
-
-    return outcome::success();
+    return checks;
   }
 
 }  // namespace fc::mining::checks
@@ -16,6 +16,7 @@ namespace fc::mining::checks {
   using common::Buffer;
   using primitives::ChainEpoch;
   using primitives::EpochDuration;
+  using primitives::SectorNumber;
   using primitives::address::Address;
   using primitives::sector::Proof;
   using primitives::tipset::TipsetKey;
@@ -24,10 +25,22 @@ namespace fc::mining::checks {
   outcome::result<EpochDuration> getMaxProveCommitDuration(
       NetworkVersion network, const std::shared_ptr<SectorInfo> &sector_info);
 
+  /// Results of sectors checked together, by sector number
+  using BatchChecks = std::map<SectorNumber, outcome::result<void>>;
+
   outcome::result<void> checkPieces(
       const std::shared_ptr<SectorInfo> &sector_info,
       const std::shared_ptr<Api> &api);
 
+  /**
+   * Checks pieces of sectors against one chain head. Deal proposals are read
+   * from one market state with batched ipld reads, not with call per deal.
+   * Error is returned only if shared state can't be read.
+   */
+  outcome::result<BatchChecks> checkPiecesBatch(
+      const std::vector<std::shared_ptr<SectorInfo>> &sectors,
+      const std::shared_ptr<Api> &api);
+
   outcome::result<boost::optional<SectorPreCommitOnChainInfo>>
   getStateSectorPreCommitInfo(const Address &miner_address,
                               const std::shared_ptr<SectorInfo> &sector_info,
@@ -45,6 +58,18 @@ namespace fc::mining::checks {
       const ChainEpoch &height,
       const std::shared_ptr<Api> &api);
 
+  /**
+   * Checks sectors like checkPrecommit against one tipset snapshot.
+   * Data commitments are computed from deals of one market state like
+   * market actor does, precommits are read from one miner state.
+   */
+  outcome::result<BatchChecks> checkPrecommitBatch(
+      const Address &miner_address,
+      const std::vector<std::shared_ptr<SectorInfo>> &sectors,
+      const TipsetKey &tipset_key,
+      const ChainEpoch &height,
+      const std::shared_ptr<Api> &api);
+
   outcome::result<void> checkCommit(
       const Address &miner_address,
       const std::shared_ptr<SectorInfo> &sector_info,
@@ -52,6 +77,17 @@ namespace fc::mining::checks {
       const TipsetKey &tipset_key,
       const std::shared_ptr<Api> &api);
 
+  /**
+   * Checks proofs of sectors like checkCommit against one tipset snapshot.
+   * Uses proof of sector info, sectors with same seed epoch share
+   * randomness call.
+   */
+  outcome::result<BatchChecks> checkCommitBatch(
+      const Address &miner_address,
+      const std::vector<std::shared_ptr<SectorInfo>> &sectors,
+      const TipsetKey &tipset_key,
+      const std::shared_ptr<Api> &api);
+
   enum class ChecksError {
     kInvalidDeal = 1,
     kExpiredDeal,
@@ -51,6 +51,7 @@ namespace fc::mining {
     }
 
     ChainEpoch best_height = best_tipset->height();
+    bool called = false;
 
     if (best_height >= height + confidence) {
       OUTCOME_TRY(tipset, tipset_cache_->getNonNull(height));
@@ -58,6 +59,7 @@ namespace fc::mining {
       lock.unlock();
 
       OUTCOME_TRY(handler(tipset, best_height));
+      called = true;
 
       lock.lock();
       best_tipset = tipset_cache_->best();
@@ -76,178 +78,139 @@ namespace fc::mining {
 
     uint64_t id = global_id_++;
 
-    height_triggers_[id] = HeightHandle{
+    height_triggers_[id] = std::make_shared<HeightHandle>(HeightHandle{
         .confidence = confidence,
-        .called = false,
-        .handler = handler,
-        .revert = revert_handler,
-    };
+        .height = height,
+        .called = called,
+        .handler = std::move(handler),
+        .revert = std::move(revert_handler),
+    });
 
-    message_height_to_trigger_[height].insert(id);
-    height_to_trigger_[trigger_at].insert(id);
+    message_height_to_trigger_.emplace(height, id);
+    height_to_trigger_.emplace(trigger_at, id);
 
     return outcome::success();
   }
 
   bool EventsImpl::callback_function(const HeadChange &change) {
     if (change.type == HeadChangeType::APPLY) {
-      std::unique_lock<std::mutex> lock(mutex_);
+      return onApply(*change.value);
+    }
+    if (change.type == HeadChangeType::REVERT) {
+      return onRevert(*change.value);
+    }
+    return true;
+  }
 
-      auto maybe_error = tipset_cache_->add(*change.value);
+  bool EventsImpl::onApply(const Tipset &tipset) {
+    struct Call {
+      HandlePtr trigger;
+      Tipset tipset;
+      ChainEpoch height;
+    };
+    std::vector<Call> calls;
+    {
+      std::lock_guard lock{mutex_};
+      auto parent = tipset_cache_->best();
+      auto maybe_error = tipset_cache_->add(tipset);
       if (maybe_error.has_error()) {
         logger_->error("Adding tipset into cache failed: {}",
                        maybe_error.error().message());
         return false;
       }
 
-      auto apply = [&](ChainEpoch height) -> outcome::result<void> {
-        for (const auto tid : height_to_trigger_[height]) {
-          auto &handler{height_triggers_.at(tid)};
-          if (handler.called) {
-            return outcome::success();
-          }
-
-          auto trigger_height = height - handler.confidence;
-
-          OUTCOME_TRY(income_tipset, tipset_cache_->getNonNull(trigger_height));
-
-          auto &handle{handler.handler};
-          lock.unlock();
-          auto maybe_error = handle(income_tipset, height);
-          lock.lock();
-          height_triggers_[tid].called = true;
-          if (maybe_error.has_error()) {
-            logger_->error("Height handler is failed: {}",
-                           maybe_error.error().message());
-          }
+      // null rounds between parent and tipset are applied with it
+      ChainEpoch from = parent ? parent->height() + 1 : tipset.height();
+      auto begin = height_to_trigger_.lower_bound(from);
+      auto end = height_to_trigger_.upper_bound(tipset.height());
+      for (auto it = begin; it != end; ++it) {
+        auto &trigger{height_triggers_.at(it->second)};
+        if (trigger->called) {
+          continue;
         }
-        return outcome::success();
-      };
-      auto tipset = change.value;
-      maybe_error = apply(tipset->height());
-
-      if (maybe_error.has_error()) {
-        logger_->error("Applying tipset failed: {}",
-                       maybe_error.error().message());
-        return false;
-      }
-
-      ChainEpoch sub_height = tipset->height() - 1;
-      while (true) {
-        auto maybe_tipset_opt = tipset_cache_->get(sub_height);
-
-        if (maybe_tipset_opt.has_error()) {
-          logger_->error("Getting tipset from cache failed: {}",
-                         maybe_tipset_opt.error().message());
-          return false;
-        }
-
-        if (maybe_tipset_opt.value()) {
-          return true;
-        }
-
-        maybe_error = apply(sub_height);
-
-        if (maybe_error.has_error()) {
+        auto maybe_tipset = tipset_cache_->getNonNull(trigger->height);
+        if (maybe_tipset.has_error()) {
           logger_->error("Applying tipset failed: {}",
-                         maybe_error.error().message());
+                         maybe_tipset.error().message());
           return false;
         }
-
-        sub_height--;
+        trigger->called = true;
+        calls.push_back({trigger, std::move(maybe_tipset.value()), it->first});
       }
-
-      return true;
+      dropFinal(tipset.height());
     }
 
-    if (change.type == HeadChangeType::REVERT) {
-      std::unique_lock<std::mutex> lock(mutex_);
-
-      auto best_tipset = tipset_cache_->best();
+    for (auto &call : calls) {
+      auto maybe_error = call.trigger->handler(call.tipset, call.height);
+      if (maybe_error.has_error()) {
+        logger_->error("Height handler is failed: {}",
+                       maybe_error.error().message());
+      }
+    }
+    return true;
+  }
 
-      if (!best_tipset) {
-        logger_->error("Cache is empty");
+  bool EventsImpl::onRevert(const Tipset &tipset) {
+    std::vector<HandlePtr> reverts;
+    {
+      std::lock_guard lock{mutex_};
+      auto maybe_error = tipset_cache_->revert(tipset);
+      if (maybe_error.has_error()) {
+        logger_->error("Reverting tipset failed: {}",
+                       maybe_error.error().message());
         return false;
       }
-
-      ChainEpoch best_height = best_tipset->height();
-
-      auto revert = [&](ChainEpoch height, const Tipset &tipset) {
-        if (best_height >= height + kGlobalChainConfidence) {
-          logger_->warn("Tipset is deprecated");
-          for (const auto tid : message_height_to_trigger_[height]) {
-            auto &trigger{height_triggers_.at(tid)};
-            auto id = height + trigger.confidence;
-            auto maybe_error = trigger.revert(tipset);
-            if (maybe_error.has_error()) {
-              logger_->error("Revert tipset (height {}) is failed: {}",
-                             tipset.height(),
-                             maybe_error.has_error());
-            }
-            height_to_trigger_[id].erase(tid);
-            height_triggers_.erase(tid);
-          }
-          message_height_to_trigger_.erase(height);
-          return;
-        }
-
-        for (const auto tid : message_height_to_trigger_[height]) {
-          auto &revert_handle{height_triggers_[tid].revert};
-          lock.unlock();
-          auto maybe_error = revert_handle(tipset);
-          lock.lock();
-          height_triggers_[tid].called = false;
-
-          if (maybe_error.has_error()) {
-            logger_->error("Revert handler is failed: {}",
-                           maybe_error.error().message());
-          }
-
-          auto best_tipset = tipset_cache_->best();
-
-          if (!best_tipset) {
-            logger_->error("Cache is empty");
-            return;
-          }
-
-          best_height = best_tipset->height();
-        }
-      };
-
-      auto tipset = change.value;
-
-      revert(tipset->height(), *tipset);
-
-      ChainEpoch sub_height = tipset->height() - 1;
-      while (true) {
-        auto maybe_tipset_opt = tipset_cache_->get(sub_height);
-
-        if (maybe_tipset_opt.has_error()) {
-          logger_->error("Getting tipset from cache failed: {}",
-                         maybe_tipset_opt.error().message());
-          break;
-        }
-
-        if (maybe_tipset_opt.value()) {
-          break;
+      auto parent = tipset_cache_->best();
+
+      // null rounds between parent and tipset are reverted with it
+      ChainEpoch from = parent ? parent->height() + 1 : tipset.height();
+      auto begin = message_height_to_trigger_.lower_bound(from);
+      auto end = message_height_to_trigger_.upper_bound(tipset.height());
+      for (auto it = begin; it != end; ++it) {
+        auto &trigger{height_triggers_.at(it->second)};
+        if (trigger->called) {
+          trigger->called = false;
+          reverts.push_back(trigger);
         }
-
-        revert(sub_height, *tipset);
-        sub_height--;
       }
+    }
 
-      auto maybe_error = tipset_cache_->revert(*tipset);
+    // top down, as chain is reverted
+    for (auto it = reverts.rbegin(); it != reverts.rend(); ++it) {
+      auto maybe_error = (*it)->revert(tipset);
       if (maybe_error.has_error()) {
-        logger_->error("Reverting tipset failed: {}",
+        logger_->error("Revert handler is failed: {}",
                        maybe_error.error().message());
-        return false;
       }
-      return true;
     }
-
     return true;
   }
 
+  void EventsImpl::dropFinal(ChainEpoch best_height) {
+    // same bound as for new triggers in chainAt
+    auto end =
+        height_to_trigger_.upper_bound(best_height - kGlobalChainConfidence);
+    for (auto it = height_to_trigger_.begin(); it != end;) {
+      auto trigger{height_triggers_.find(it->second)};
+      eraseFromIndex(
+          message_height_to_trigger_, trigger->second->height, it->second);
+      height_triggers_.erase(trigger);
+      it = height_to_trigger_.erase(it);
+    }
+  }
+
+  void EventsImpl::eraseFromIndex(HeightIndex &index,
+                                  ChainEpoch height,
+                                  uint64_t id) {
+    auto [begin, end] = index.equal_range(height);
+    for (auto it = begin; it != end; ++it) {
+      if (it->second == id) {
+        index.erase(it);
+        return;
+      }
+    }
+  }
+
 }  // namespace fc::mining
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::mining, EventsError, e) {
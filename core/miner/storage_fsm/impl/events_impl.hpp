@@ -8,6 +8,8 @@
 
 #include "miner/storage_fsm/events.hpp"
 
+#include <map>
+
 #include "api/api.hpp"
 #include "common/logger.hpp"
 #include "miner/storage_fsm/tipset_cache.hpp"
@@ -36,14 +38,31 @@ namespace fc::mining {
    private:
     struct HeightHandle {
       EpochDuration confidence;
+      /// Height of tipset passed to handler
+      ChainEpoch height;
       bool called;
 
       HeightHandler handler;
       RevertHandler revert;
     };
+    using HandlePtr = std::shared_ptr<HeightHandle>;
+    using HeightIndex = std::multimap<ChainEpoch, uint64_t>;
 
     bool callback_function(const HeadChange &change);
 
+    /// Calls handlers with trigger height above parent up to tipset height
+    bool onApply(const Tipset &tipset);
+
+    /// Reverts called handlers with height above parent up to tipset height
+    bool onRevert(const Tipset &tipset);
+
+    /// Forgets triggers which can't be reverted anymore, mutex must be locked
+    void dropFinal(ChainEpoch best_height);
+
+    static void eraseFromIndex(HeightIndex &index,
+                               ChainEpoch height,
+                               uint64_t id);
+
     std::shared_ptr<Api> api_;
 
     /**
@@ -54,12 +73,15 @@ namespace fc::mining {
 
     uint64_t global_id_;
 
-    std::unordered_map<uint64_t, HeightHandle> height_triggers_;
+    /// Handlers are called without lock, so handles are shared
+    std::unordered_map<uint64_t, HandlePtr> height_triggers_;
 
-    std::map<ChainEpoch, std::set<uint64_t>> height_to_trigger_;  // for apply
-    std::map<ChainEpoch, std::set<uint64_t>>
-        message_height_to_trigger_;  // for revert
+    /// Trigger height to id, range of null rounds and tipset is applied
+    HeightIndex height_to_trigger_;
+    /// Tipset height to id, range of null rounds and tipset is reverted
+    HeightIndex message_height_to_trigger_;
 
+    /// Guards triggers and indices, never held while handlers run
     std::mutex mutex_;
 
     std::shared_ptr<TipsetCache> tipset_cache_;
@@ -0,0 +1,123 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "miner/storage_fsm/impl/message_batcher.hpp"
+
+#include <boost/asio/post.hpp>
+
+namespace fc::mining {
+  MessageBatcher::MessageBatcher(std::string name,
+                                 std::shared_ptr<Api> api,
+                                 std::shared_ptr<boost::asio::io_context> io,
+                                 BatcherConfig config)
+      : name_{std::move(name)},
+        api_{std::move(api)},
+        io_{std::move(io)},
+        config_{config},
+        timer_{*io_},
+        logger_{common::createLogger("batcher")} {}
+
+  void MessageBatcher::add(SectorNumber sector,
+                           UnsignedMessage message,
+                           Callback cb) {
+    std::unique_lock lock{mutex_};
+    queue_.insert_or_assign(sector, Item{std::move(message), std::move(cb)});
+    if (config_.max_wait.count() == 0 || queue_.size() >= config_.max_size) {
+      lock.unlock();
+      boost::asio::post(*io_, [weak{weak_from_this()}] {
+        if (auto self{weak.lock()}) {
+          self->flush();
+        }
+      });
+      return;
+    }
+    if (!timer_armed_) {
+      timer_armed_ = true;
+      boost::asio::post(*io_, [weak{weak_from_this()}] {
+        auto self{weak.lock()};
+        if (!self) {
+          return;
+        }
+        // timer is used only on io thread
+        self->timer_.expires_after(self->config_.max_wait);
+        self->timer_.async_wait([weak](auto ec) {
+          if (ec) {
+            return;
+          }
+          if (auto self{weak.lock()}) {
+            self->flush();
+          }
+        });
+      });
+    }
+  }
+
+  void MessageBatcher::flush() {
+    std::map<SectorNumber, Item> batch;
+    {
+      std::lock_guard lock{mutex_};
+      batch = std::move(queue_);
+      queue_.clear();
+      if (timer_armed_) {
+        timer_armed_ = false;
+        timer_.cancel();
+      }
+    }
+    if (batch.empty()) {
+      return;
+    }
+    if (precheck_) {
+      std::vector<SectorNumber> sectors;
+      for (auto &[sector, item] : batch) {
+        sectors.push_back(sector);
+      }
+      auto checks{precheck_(sectors)};
+      if (!checks) {
+        // sectors were checked when queued
+        logger_->warn(
+            "{}: precheck failed: {}", name_, checks.error().message());
+      } else {
+        for (auto &[sector, check] : checks.value()) {
+          auto it{batch.find(sector)};
+          if (!check && it != batch.end()) {
+            logger_->warn("{}: sector {} failed precheck: {}",
+                          name_,
+                          sector,
+                          check.error().message());
+            auto cb{std::move(it->second.cb)};
+            batch.erase(it);
+            cb(check.error());
+          }
+        }
+      }
+      if (batch.empty()) {
+        return;
+      }
+    }
+    logger_->info("{}: pushing {} messages", name_, batch.size());
+    for (auto &[sector, item] : batch) {
+      auto maybe_signed_msg{
+          api_->MpoolPushMessage(item.message, api::kPushNoSpec)};
+      if (maybe_signed_msg) {
+        item.cb(maybe_signed_msg.value().getCid());
+      } else {
+        logger_->error("{}: pushing message of sector {}: {}",
+                       name_,
+                       sector,
+                       maybe_signed_msg.error().message());
+        item.cb(maybe_signed_msg.error());
+      }
+    }
+  }
+
+  void MessageBatcher::setPrecheck(Precheck precheck) {
+    precheck_ = std::move(precheck);
+  }
+
+  size_t MessageBatcher::pending() const {
+    std::lock_guard lock{mutex_};
+    return queue_.size();
+  }
+}  // namespace fc::mining
@@ -0,0 +1,78 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <mutex>
+
+#include "api/api.hpp"
+#include "common/logger.hpp"
+
+namespace fc::mining {
+  using api::Api;
+  using primitives::SectorNumber;
+  using vm::message::UnsignedMessage;
+
+  struct BatcherConfig {
+    /// Time to collect messages before push, zero pushes immediately
+    std::chrono::milliseconds max_wait{30000};
+    /// Batch is pushed without waiting when it has this many messages
+    size_t max_size{16};
+  };
+
+  /**
+   * Collects sealing messages of sectors reaching same state within window
+   * and pushes them together in sector order, so they get consecutive nonces
+   * and usually land in same tipset.
+   * Actors v0 have no batch methods, so each sector still has own message.
+   * Push failure affects only its sector.
+   * Optional precheck validates all queued sectors with one round of calls
+   * before push, as state may change while messages wait.
+   */
+  class MessageBatcher : public std::enable_shared_from_this<MessageBatcher> {
+   public:
+    using Callback = std::function<void(outcome::result<CID>)>;
+    using Checks = std::map<SectorNumber, outcome::result<void>>;
+    /// Results by sector, sectors without result are pushed
+    using Precheck = std::function<outcome::result<Checks>(
+        const std::vector<SectorNumber> &)>;
+
+    MessageBatcher(std::string name,
+                   std::shared_ptr<Api> api,
+                   std::shared_ptr<boost::asio::io_context> io,
+                   BatcherConfig config);
+
+    /// Queue message of sector, callback gets cid of pushed message
+    void add(SectorNumber sector, UnsignedMessage message, Callback cb);
+
+    /// Push queued messages now
+    void flush();
+
+    /// Sectors failing precheck get its error instead of push
+    void setPrecheck(Precheck precheck);
+
+    size_t pending() const;
+
+   private:
+    struct Item {
+      UnsignedMessage message;
+      Callback cb;
+    };
+
+    std::string name_;
+    std::shared_ptr<Api> api_;
+    std::shared_ptr<boost::asio::io_context> io_;
+    BatcherConfig config_;
+    Precheck precheck_;
+    mutable std::mutex mutex_;
+    std::map<SectorNumber, Item> queue_;
+    boost::asio::steady_timer timer_;
+    bool timer_armed_{false};
+    common::Logger logger_;
+  };
+}  // namespace fc::mining
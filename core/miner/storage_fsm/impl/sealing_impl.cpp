@@ -5,7 +5,12 @@
 
 #include "miner/storage_fsm/impl/sealing_impl.hpp"
 
+#include <boost/asio/post.hpp>
+#include <libp2p/protocol/common/asio/asio_scheduler.hpp>
+
 #include "common/bitsutil.hpp"
+#include "common/metrics.hpp"
+#include "common/tracing.hpp"
 #include "host/context/impl/host_context_impl.hpp"
 #include "miner/storage_fsm/impl/checks.hpp"
 #include "miner/storage_fsm/impl/sector_stat_impl.hpp"
@@ -45,7 +50,7 @@ namespace fc::mining {
                            std::shared_ptr<Events> events,
                            const Address &miner_address,
                            std::shared_ptr<Counter> counter,
-                           std::shared_ptr<BufferMap> fsm_kv,
+                           std::shared_ptr<PersistentBufferMap> fsm_kv,
                            std::shared_ptr<Manager> sealer,
                            std::shared_ptr<PreCommitPolicy> policy,
                            std::shared_ptr<boost::asio::io_context> context,
@@ -65,10 +70,36 @@ namespace fc::mining {
     fsm_ = std::make_shared<StorageFSM>(makeFSMTransitions(), fsm_context);
     fsm_->setAnyChangeAction(
         [this](auto info, auto event, auto context, auto from, auto to) {
+          common::metrics::counter(
+              "fc_sealing_state_entered_total",
+              "Sector transitions to sealing state",
+              fmt::format("state=\"{}\"", static_cast<uint64_t>(to)))
+              .inc();
+          traceState(info->sector_number, from, to);
           callbackHandle(info, event, context, from, to);
         });
     stat_ = std::make_shared<SectorStatImpl>();
     logger_ = common::createLogger("sealing");
+    precommit_batcher_ = std::make_shared<MessageBatcher>(
+        "precommit", api_, context_, config_.batch);
+    commit_batcher_ = std::make_shared<MessageBatcher>(
+        "commit", api_, context_, config_.batch);
+    // queued sectors are checked against one snapshot before push
+    precommit_batcher_->setPrecheck(
+        [this](auto &numbers) -> outcome::result<checks::BatchChecks> {
+          OUTCOME_TRY(head, api_->ChainHead());
+          return checks::checkPrecommitBatch(miner_address_,
+                                             sectorInfos(numbers),
+                                             head->key,
+                                             head->height(),
+                                             api_);
+        });
+    commit_batcher_->setPrecheck(
+        [this](auto &numbers) -> outcome::result<checks::BatchChecks> {
+          OUTCOME_TRY(head, api_->ChainHead());
+          return checks::checkCommitBatch(
+              miner_address_, sectorInfos(numbers), head->key, api_);
+        });
   }
 
   uint64_t getDealPerSectorLimit(SectorSize size) {
@@ -108,25 +139,128 @@ namespace fc::mining {
   void SealingImpl::stop() {
     logger_->info("Sealing is stopped");
     fsm_->stop();
+    fsmFlush();
+  }
+
+  const std::string kSectorKeyPrefix{"s/"};
+  const std::string kStateKeyPrefix{"i/"};
+
+  Buffer sectorKey(SectorNumber sector) {
+    return Buffer{
+        common::span::cbytes(kSectorKeyPrefix + std::to_string(sector))};
+  }
+
+  std::string stateKeyPrefix(SealingState state) {
+    return kStateKeyPrefix + std::to_string(static_cast<uint64_t>(state))
+           + "/";
+  }
+
+  Buffer stateKey(SealingState state, SectorNumber sector) {
+    return Buffer{
+        common::span::cbytes(stateKeyPrefix(state) + std::to_string(sector))};
+  }
+
+  bool hasPrefix(const Buffer &key, const std::string &prefix) {
+    return key.size() >= prefix.size()
+           && std::equal(prefix.begin(), prefix.end(), key.begin());
   }
 
   outcome::result<void> SealingImpl::fsmLoad() {
+    std::vector<std::shared_ptr<SectorInfo>> legacy;
     if (auto it{fsm_kv_->cursor()}) {
       for (it->seekToFirst(); it->isValid(); it->next()) {
+        auto key{it->key()};
+        if (hasPrefix(key, kStateKeyPrefix)) {
+          continue;
+        }
         OUTCOME_TRY(_info, codec::cbor::decode<SectorInfo>(it->value()));
         auto info{std::make_shared<SectorInfo>(std::move(_info))};
+        if (hasPrefix(key, kSectorKeyPrefix)) {
+          indexed_[info->sector_number] = info->state;
+        } else {
+          legacy_keys_.push_back(std::move(key));
+          legacy.push_back(info);
+        }
         sectors_.emplace(info->sector_number, info);
         OUTCOME_TRY(fsm_->begin(info, info->state));
+        loading_ = true;
         callbackHandle(info, {}, {}, {}, info->state);
+        loading_ = false;
       }
     }
+    for (const auto &info : legacy) {
+      fsmSave(info);
+    }
     return outcome::success();
   }
 
   void SealingImpl::fsmSave(const std::shared_ptr<SectorInfo> &info) {
-    OUTCOME_EXCEPT(fsm_kv_->put(
-        Buffer{common::span::cbytes(std::to_string(info->sector_number))},
-        codec::cbor::encode(*info).value()));
+    if (loading_) {
+      return;
+    }
+    std::lock_guard lock(save_mutex_);
+    dirty_[info->sector_number] = info;
+    if (flush_posted_) {
+      return;
+    }
+    flush_posted_ = true;
+    boost::asio::post(*context_, [weak{weak_from_this()}] {
+      if (auto self{weak.lock()}) {
+        self->fsmFlush();
+      }
+    });
+  }
+
+  void SealingImpl::fsmFlush() {
+    std::lock_guard lock(save_mutex_);
+    flush_posted_ = false;
+    if (dirty_.empty() && legacy_keys_.empty()) {
+      return;
+    }
+    auto batch{fsm_kv_->batch()};
+    auto maybe_error = [&]() -> outcome::result<void> {
+      for (const auto &[sector, info] : dirty_) {
+        OUTCOME_TRY(value, codec::cbor::encode(*info));
+        OUTCOME_TRY(batch->put(sectorKey(sector), std::move(value)));
+        auto indexed{indexed_.find(sector)};
+        if (indexed != indexed_.end() && indexed->second != info->state) {
+          OUTCOME_TRY(batch->remove(stateKey(indexed->second, sector)));
+        }
+        if (indexed == indexed_.end() || indexed->second != info->state) {
+          OUTCOME_TRY(batch->put(stateKey(info->state, sector), Buffer{}));
+        }
+      }
+      for (const auto &key : legacy_keys_) {
+        OUTCOME_TRY(batch->remove(key));
+      }
+      return batch->commit();
+    }();
+    if (maybe_error.has_error()) {
+      logger_->error("saving {} sectors: {}",
+                     dirty_.size(),
+                     maybe_error.error().message());
+      return;
+    }
+    for (const auto &[sector, info] : dirty_) {
+      indexed_[sector] = info->state;
+    }
+    dirty_.clear();
+    legacy_keys_.clear();
+  }
+
+  outcome::result<std::vector<SectorNumber>> SealingImpl::getSectorsInState(
+      SealingState state) const {
+    std::vector<SectorNumber> sectors;
+    auto prefix{stateKeyPrefix(state)};
+    auto it{fsm_kv_->cursor()};
+    for (it->seek(Buffer{common::span::cbytes(prefix)});
+         it->isValid() && hasPrefix(it->key(), prefix);
+         it->next()) {
+      auto key{it->key()};
+      sectors.push_back(std::stoull(
+          std::string{key.begin() + prefix.size(), key.end()}));
+    }
+    return sectors;
   }
 
   outcome::result<PieceAttributes> SealingImpl::addPieceToAnySector(
@@ -206,6 +340,19 @@ namespace fc::mining {
     return maybe_sector->second;
   }
 
+  std::vector<std::shared_ptr<SectorInfo>> SealingImpl::sectorInfos(
+      const std::vector<SectorNumber> &ids) const {
+    std::vector<std::shared_ptr<SectorInfo>> infos;
+    std::lock_guard lock(sectors_mutex_);
+    for (const auto &id : ids) {
+      auto it{sectors_.find(id)};
+      if (it != sectors_.end()) {
+        infos.push_back(it->second);
+      }
+    }
+    return infos;
+  }
+
   outcome::result<void> SealingImpl::forceSectorState(SectorNumber id,
                                                       SealingState state) {
     OUTCOME_TRY(info, getSectorInfo(id));
@@ -256,6 +403,10 @@ namespace fc::mining {
       return outcome::success();  // cur sealing
     }
 
+    if (!canStartSector()) {
+      return outcome::success();  // pipeline is full
+    }
+
     scheduler_
         ->schedule([self{shared_from_this()}] {
           UnpaddedPieceSize size =
@@ -331,16 +482,30 @@ namespace fc::mining {
   SealingImpl::getSectorAndPadding(UnpaddedPieceSize size) {
     auto sector_size = sealer_->getSectorSize();
 
+    // best fit: least padding waste, then least space left after piece
+    boost::optional<SectorPaddingResponse> best;
+    uint64_t best_waste{}, best_left{};
     for (const auto &[key, value] : unsealed_sectors_) {
       auto pads =
           proofs::Proofs::GetRequiredPadding(value.stored, size.padded());
-      if (value.stored + size.padded() + pads.size < sector_size) {
-        return SectorPaddingResponse{
+      uint64_t end = value.stored + pads.size + size.padded();
+      if (end > sector_size) {
+        continue;
+      }
+      uint64_t waste = pads.size, left = sector_size - end;
+      if (!best || waste < best_waste
+          || (waste == best_waste && left < best_left)) {
+        best = SectorPaddingResponse{
             .sector = key,
             .pads = std::move(pads.pads),
         };
+        best_waste = waste;
+        best_left = left;
       }
     }
+    if (best) {
+      return std::move(*best);
+    }
 
     OUTCOME_TRY(new_sector, newDealSector());
 
@@ -398,6 +563,10 @@ namespace fc::mining {
       }
     }
 
+    if (!canStartSector()) {
+      return SealingError::kTooManySectors;
+    }
+
     if (config_.max_wait_deals_sectors > 0
         && unsealed_sectors_.size() >= config_.max_wait_deals_sectors) {
       // TODO: check get one before max or several every time
@@ -650,6 +819,26 @@ namespace fc::mining {
     info->state = to;
     fsmSave(info);
 
+    release(info->sector_number, from);
+    auto retry{[weak{weak_from_this()}, info, event, event_context, from, to] {
+      if (auto self{weak.lock()}) {
+        if (info->state != to) {
+          // sector left state while waiting
+          self->wakeAdmission(to);
+          return;
+        }
+        self->callbackHandle(info, event, event_context, from, to);
+      }
+    }};
+    if (!admit(info->sector_number, to, std::move(retry))) {
+      logger_->info("sector {}: waiting for free slot in state {}",
+                    info->sector_number,
+                    to);
+      return;
+    }
+
+    // sealer calls made by handler continue sector trace
+    common::tracing::Scope scope{stateTrace(info->sector_number)};
     auto maybe_error = [&]() -> outcome::result<void> {
       switch (to) {
         case SealingState::kWaitDeals: {
@@ -798,6 +987,103 @@ namespace fc::mining {
     return std::move(result);
   }
 
+  bool SealingImpl::admit(SectorNumber id,
+                          SealingState state,
+                          std::function<void()> retry) {
+    auto limit{config_.max_in_state.find(state)};
+    if (limit == config_.max_in_state.end() || limit->second == 0) {
+      return true;
+    }
+    std::lock_guard lock(admission_mutex_);
+    auto &admission{admission_[state]};
+    if (admission.admitted.count(id) != 0) {
+      return true;
+    }
+    if (admission.admitted.size() < limit->second) {
+      admission.admitted.insert(id);
+      return true;
+    }
+    admission.waiting.push_back(std::move(retry));
+    return false;
+  }
+
+  void SealingImpl::release(SectorNumber id, SealingState state) {
+    {
+      std::lock_guard lock(admission_mutex_);
+      auto it{admission_.find(state)};
+      if (it == admission_.end() || it->second.admitted.erase(id) == 0) {
+        return;
+      }
+    }
+    wakeAdmission(state);
+  }
+
+  void SealingImpl::wakeAdmission(SealingState state) {
+    std::function<void()> retry;
+    {
+      std::lock_guard lock(admission_mutex_);
+      auto it{admission_.find(state)};
+      if (it == admission_.end() || it->second.waiting.empty()) {
+        return;
+      }
+      retry = std::move(it->second.waiting.front());
+      it->second.waiting.pop_front();
+    }
+    boost::asio::post(*context_, std::move(retry));
+  }
+
+  void SealingImpl::traceState(SectorNumber id,
+                               SealingState from,
+                               SealingState to) {
+    if (!common::tracing::enabled()) {
+      return;
+    }
+    auto now{common::tracing::Clock::now()};
+    boost::optional<StateSpan> ended;
+    {
+      std::lock_guard lock{state_spans_mutex_};
+      auto it{state_spans_.find(id)};
+      if (it != state_spans_.end()) {
+        ended = it->second;
+      }
+      if (to == SealingState::kProving || to == SealingState::kRemoved) {
+        state_spans_.erase(id);
+      } else {
+        auto trace{ended ? ended->trace : common::tracing::child({})};
+        state_spans_[id] = {trace, common::tracing::child(trace), now};
+      }
+    }
+    if (ended) {
+      common::tracing::record(
+          "sealing.state",
+          ended->span,
+          {},
+          ended->start,
+          now,
+          {{"sector", std::to_string(id)},
+           {"state", std::to_string(static_cast<uint64_t>(from))}});
+    }
+  }
+
+  common::tracing::SpanContext SealingImpl::stateTrace(SectorNumber id) {
+    std::lock_guard lock{state_spans_mutex_};
+    auto it{state_spans_.find(id)};
+    return it == state_spans_.end() ? common::tracing::SpanContext{}
+                                    : it->second.span;
+  }
+
+  bool SealingImpl::canStartSector() {
+    // sectors already wait for bottleneck state
+    for (const auto &[state, limit] : config_.max_in_state) {
+      if (limit != 0 && stat_->inState(state) > limit) {
+        return false;
+      }
+    }
+    return config_.max_queued_precommit1 == 0
+           || sealer_->queuedTasks(primitives::kTTPreCommit1)
+                  < config_.max_queued_precommit1;
+  }
+
   SectorId SealingImpl::minerSector(SectorNumber num) {
     auto miner_id = miner_address_.getId();
 
@@ -949,7 +1235,8 @@ namespace fc::mining {
     deposit = std::max(deposit, collateral);
 
     logger_->info("submitting precommit for sector: {}", info->sector_number);
-    auto maybe_signed_msg = api_->MpoolPushMessage(
+    precommit_batcher_->add(
+        info->sector_number,
         vm::message::UnsignedMessage(
             miner_address_,
             minfo.worker,
@@ -959,30 +1246,29 @@ namespace fc::mining {
             {},
             vm::actor::builtin::v0::miner::PreCommitSector::Number,
             MethodParams{maybe_params.value()}),
-        api::kPushNoSpec);  // TODO: max fee options
-
-    if (maybe_signed_msg.has_error()) {
-      if (params.replace_capacity) {
-        maybe_error = markForUpgrade(params.replace_sector);
-        if (maybe_error.has_error()) {
-          logger_->error("error re-marking sector {} as for upgrade: {}",
-                         info->sector_number,
-                         maybe_error.error().message());
-        }
-      }
-      logger_->error("pushing message to mpool: {}",
-                     maybe_signed_msg.error().message());
-      FSM_SEND(info, SealingEvent::kSectorChainPreCommitFailed);
-      return outcome::success();
-    }
-
-    std::shared_ptr<SectorPreCommittedContext> context =
-        std::make_shared<SectorPreCommittedContext>();
-    context->precommit_message = maybe_signed_msg.value().getCid();
-    context->precommit_deposit = deposit;
-    context->precommit_info = std::move(params);
+        [=, params{std::move(params)}](auto maybe_cid) {
+          if (maybe_cid.has_error()) {
+            if (params.replace_capacity) {
+              auto maybe_error = markForUpgrade(params.replace_sector);
+              if (maybe_error.has_error()) {
+                logger_->error("error re-marking sector {} as for upgrade: {}",
+                               info->sector_number,
+                               maybe_error.error().message());
+              }
+            }
+            OUTCOME_EXCEPT(fsm_->send(
+                info, SealingEvent::kSectorChainPreCommitFailed, {}));
+            return;
+          }
 
-    FSM_SEND_CONTEXT(info, SealingEvent::kSectorPreCommitted, context);
+          std::shared_ptr<SectorPreCommittedContext> context =
+              std::make_shared<SectorPreCommittedContext>();
+          context->precommit_message = maybe_cid.value();
+          context->precommit_deposit = deposit;
+          context->precommit_info = params;
+          OUTCOME_EXCEPT(
+              fsm_->send(info, SealingEvent::kSectorPreCommitted, context));
+        });  // TODO: max fee options
     return outcome::success();
   }
 
@@ -1194,7 +1480,8 @@ namespace fc::mining {
     }
 
     // TODO: check seed / ticket are up to date
-    auto maybe_signed_msg = api_->MpoolPushMessage(
+    commit_batcher_->add(
+        info->sector_number,
         vm::message::UnsignedMessage(
             miner_address_,
             minfo.worker,
@@ -1204,20 +1491,20 @@ namespace fc::mining {
             {},
             vm::actor::builtin::v0::miner::ProveCommitSector::Number,
             MethodParams{maybe_params_encoded.value()}),
-        api::kPushNoSpec);
-
-    if (maybe_signed_msg.has_error()) {
-      logger_->error("pushing message to mpool: {}",
-                     maybe_signed_msg.error().message());
-      FSM_SEND(info, SealingEvent::kSectorCommitFailed);
-      return outcome::success();
-    }
+        [=, proof{maybe_proof.value()}](auto maybe_cid) {
+          if (maybe_cid.has_error()) {
+            OUTCOME_EXCEPT(
+                fsm_->send(info, SealingEvent::kSectorCommitFailed, {}));
+            return;
+          }
 
-    std::shared_ptr<SectorCommittedContext> context =
-        std::make_shared<SectorCommittedContext>();
-    context->proof = maybe_proof.value();
-    context->message = maybe_signed_msg.value().getCid();
-    FSM_SEND_CONTEXT(info, SealingEvent::kSectorCommitted, context);
+          std::shared_ptr<SectorCommittedContext> context =
+              std::make_shared<SectorCommittedContext>();
+          context->proof = proof;
+          context->message = maybe_cid.value();
+          OUTCOME_EXCEPT(
+              fsm_->send(info, SealingEvent::kSectorCommitted, context));
+        });
     return outcome::success();
   }
 
@@ -8,10 +8,15 @@
 
 #include "miner/storage_fsm/sealing.hpp"
 
+#include <deque>
+#include <map>
+
 #include "api/api.hpp"
 #include "common/logger.hpp"
+#include "common/tracing.hpp"
 #include "fsm/fsm.hpp"
 #include "miner/storage_fsm/events.hpp"
+#include "miner/storage_fsm/impl/message_batcher.hpp"
 #include "miner/storage_fsm/precommit_policy.hpp"
 #include "miner/storage_fsm/sealing_events.hpp"
 #include "miner/storage_fsm/sector_stat.hpp"
@@ -36,7 +41,7 @@ namespace fc::mining {
   using api::SectorPreCommitOnChainInfo;
   using primitives::Counter;
   using primitives::tipset::TipsetKey;
-  using storage::BufferMap;
+  using storage::PersistentBufferMap;
   using vm::actor::builtin::v0::miner::SectorPreCommitInfo;
 
   struct Config {
@@ -50,6 +55,17 @@ namespace fc::mining {
     uint64_t max_sealing_sectors_for_deals = 0;
 
     uint64_t wait_deals_delay;  // in milliseconds
+
+    // max sectors handled in state at once (e.g. PreCommit1, WaitSeed),
+    // others wait for free slot before state handler, 0 = no limit
+    std::map<SealingState, uint64_t> max_in_state;
+
+    // new sectors are not started while scheduler has so many PreCommit1
+    // tasks waiting for worker resources, 0 = no limit
+    uint64_t max_queued_precommit1 = 0;
+
+    // PreCommit and ProveCommit messages are pushed in batches
+    BatcherConfig batch;
   };
 
   class SealingImpl : public Sealing,
@@ -59,7 +75,7 @@ namespace fc::mining {
                 std::shared_ptr<Events> events,
                 const Address &miner_address,
                 std::shared_ptr<Counter> counter,
-                std::shared_ptr<BufferMap> fsm_kv,
+                std::shared_ptr<PersistentBufferMap> fsm_kv,
                 std::shared_ptr<Manager> sealer,
                 std::shared_ptr<PreCommitPolicy> policy,
                 std::shared_ptr<boost::asio::io_context> context,
@@ -69,8 +85,21 @@ namespace fc::mining {
 
     void stop() override;
 
+    /**
+     * Loads sectors from store.
+     * Sector infos are stored by "s/<sector>" keys, index by state by
+     * "i/<state>/<sector>" keys. Sectors stored by old "<sector>" keys are
+     * moved on next flush.
+     */
     outcome::result<void> fsmLoad();
+    /// Marks sector to be written on next flush
     void fsmSave(const std::shared_ptr<SectorInfo> &info);
+    /// Writes sectors changed since last flush with one batch
+    void fsmFlush();
+
+    /// Sectors in state as of last flush, read from index
+    outcome::result<std::vector<SectorNumber>> getSectorsInState(
+        SealingState state) const;
 
     outcome::result<PieceAttributes> addPieceToAnySector(
         UnpaddedPieceSize size,
@@ -99,6 +128,10 @@ namespace fc::mining {
     outcome::result<void> pledgeSector() override;
 
    private:
+    /// Infos of known sectors among ids
+    std::vector<std::shared_ptr<SectorInfo>> sectorInfos(
+        const std::vector<SectorNumber> &ids) const;
+
     struct SectorPaddingResponse {
       SectorNumber sector;
       std::vector<PaddedPieceSize> pads;
@@ -260,6 +293,33 @@ namespace fc::mining {
 
     SectorId minerSector(SectorNumber num);
 
+    /**
+     * Takes slot of state for sector, or queues retry to be called when slot
+     * is released
+     * @return true if sector may be handled in state now
+     */
+    bool admit(SectorNumber id,
+               SealingState state,
+               std::function<void()> retry);
+
+    /// Frees slot of state taken by sector
+    void release(SectorNumber id, SealingState state);
+
+    /// Calls first retry waiting for slot of state
+    void wakeAdmission(SealingState state);
+
+    /**
+     * Ends span of previous state of sector and starts span of new one.
+     * Spans of sector share trace, until sector is proving.
+     */
+    void traceState(SectorNumber id, SealingState from, SealingState to);
+
+    /// Context of current state span of sector
+    common::tracing::SpanContext stateTrace(SectorNumber id);
+
+    /// Pipeline has room for new sector
+    bool canStartSector();
+
     mutable std::mutex sectors_mutex_;
     std::unordered_map<SectorNumber, std::shared_ptr<SectorInfo>> sectors_;
 
@@ -276,6 +336,23 @@ namespace fc::mining {
     std::set<SectorNumber> to_upgrade_;
     std::shared_mutex upgrade_mutex_;
 
+    struct Admission {
+      std::set<SectorNumber> admitted;
+      std::deque<std::function<void()>> waiting;
+    };
+
+    std::map<SealingState, Admission> admission_;
+    std::mutex admission_mutex_;
+
+    struct StateSpan {
+      common::tracing::SpanContext trace;
+      common::tracing::SpanContext span;
+      common::tracing::Clock::time_point start;
+    };
+
+    std::unordered_map<SectorNumber, StateSpan> state_spans_;
+    std::mutex state_spans_mutex_;
+
     /** State machine */
     std::shared_ptr<boost::asio::io_context> context_;
     std::shared_ptr<StorageFSM> fsm_;
@@ -286,7 +363,18 @@ namespace fc::mining {
     std::shared_ptr<PreCommitPolicy> policy_;
 
     std::shared_ptr<Counter> counter_;
-    std::shared_ptr<BufferMap> fsm_kv_;
+    std::shared_ptr<PersistentBufferMap> fsm_kv_;
+
+    std::mutex save_mutex_;
+    /// Sectors changed since last flush
+    std::map<SectorNumber, std::shared_ptr<SectorInfo>> dirty_;
+    /// States of sectors written to index
+    std::unordered_map<SectorNumber, SealingState> indexed_;
+    /// Old layout keys to remove on flush
+    std::vector<Buffer> legacy_keys_;
+    bool flush_posted_{false};
+    /// Loaded sectors are not written back
+    bool loading_{false};
 
     std::shared_ptr<SectorStat> stat_;
 
@@ -297,6 +385,9 @@ namespace fc::mining {
 
     Config config_;
     std::shared_ptr<Scheduler> scheduler_;
+
+    std::shared_ptr<MessageBatcher> precommit_batcher_;
+    std::shared_ptr<MessageBatcher> commit_batcher_;
   };
 }  // namespace fc::mining
 
@@ -44,6 +44,13 @@ namespace fc::mining {
     uint64_t stat_state = toStatState(state);
     by_sector_[sector] = stat_state;
     totals_[stat_state]++;
+
+    auto maybe_state = states_.find(sector);
+    if (maybe_state != states_.end()) {
+      by_state_[maybe_state->second]--;
+    }
+    states_[sector] = state;
+    by_state_[state]++;
   }
 
   uint64_t SectorStatImpl::currentSealing() const {
@@ -51,4 +58,11 @@ namespace fc::mining {
 
     return totals_[StatState::kSealing] + totals_[StatState::kFailed];
   }
+
+  uint64_t SectorStatImpl::inState(SealingState state) const {
+    std::lock_guard lock(mutex_);
+
+    auto it = by_state_.find(state);
+    return it == by_state_.end() ? 0 : it->second;
+  }
 }  // namespace fc::mining
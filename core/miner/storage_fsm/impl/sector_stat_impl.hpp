@@ -27,11 +27,15 @@ namespace fc::mining {
 
     uint64_t currentSealing() const override;
 
+    uint64_t inState(SealingState state) const override;
+
    private:
     mutable std::mutex mutex_;
 
     std::map<SectorId, uint64_t> by_sector_;
     std::vector<uint64_t> totals_;
+    std::map<SectorId, SealingState> states_;
+    std::map<SealingState, uint64_t> by_state_;
   };
 }  // namespace fc::mining
 
@@ -10,11 +10,28 @@
 namespace fc::mining {
 
   TipsetCacheImpl::TipsetCacheImpl(uint64_t capability,
-                                   GetTipsetFunction get_function)
-      : get_function_(std::move(get_function)) {
+                                   GetTipsetFunction get_function,
+                                   GetRangeFunction get_range)
+      : get_function_(std::move(get_function)),
+        get_range_(std::move(get_range)) {
     cache_.resize(capability);
     start_ = 0;
     len_ = 0;
+    if (!get_range_) {
+      get_range_ = [this](ChainEpoch min, ChainEpoch max, auto &)
+          -> outcome::result<std::vector<primitives::tipset::TipsetCPtr>> {
+        std::vector<primitives::tipset::TipsetCPtr> tipsets;
+        while (min <= max) {
+          OUTCOME_TRY(tipset, get_function_(min));
+          if (tipset->epoch() > max) {
+            break;
+          }
+          min = tipset->epoch() + 1;
+          tipsets.push_back(std::move(tipset));
+        }
+        return tipsets;
+      };
+    }
   }
 
   outcome::result<void> TipsetCacheImpl::add(const Tipset &tipset) {
@@ -64,6 +81,11 @@ namespace fc::mining {
   }
 
   outcome::result<Tipset> TipsetCacheImpl::getNonNull(uint64_t height) {
+    if (len_ != 0 && (ChainEpoch)height < windowMin()) {
+      // get function skips null rounds
+      OUTCOME_TRY(tipset, get_function_(height));
+      return *tipset;
+    }
     while (true) {
       OUTCOME_TRY(tipset, get(height++));
 
@@ -81,31 +103,55 @@ namespace fc::mining {
       return std::move(*tipset);
     }
 
-    auto head_height = cache_[start_]->height();
+    ChainEpoch head_height = cache_[start_]->height();
+    ChainEpoch _height = height;
 
-    if (height > head_height) {
+    if (_height > head_height) {
       return TipsetCacheError::kNotInCache;
     }
 
-    boost::optional<Tipset> tail = boost::none;
-    uint64_t i;
-    for (i = 1; i <= len_; i++) {
-      tail = cache_[mod(start_ - len_ + i)];
-      if (tail) {
-        break;
-      }
-    }
-
-    if (height < tail->height()) {
+    if (_height < windowMin()) {
       OUTCOME_TRY(tipset, get_function_(height));
-      if (i > (tail->height() - height)) {
-        cache_[mod(start_ - len_ + i - (tail->height() - height))] = *tipset;
-        // TODO: Maybe extend cache, if len less than cache size
+      if (tipset->epoch() != _height) {
+        return boost::none;
       }
       return std::move(*tipset);
     }
 
-    return cache_[mod(start_ - (head_height - height))];
+    if (_height <= head_height - (ChainEpoch)len_) {
+      // whole window in one request
+      OUTCOME_TRY(backfill(windowMin()));
+    }
+
+    return slot(_height);
+  }
+
+  boost::optional<Tipset> &TipsetCacheImpl::slot(ChainEpoch height) {
+    return cache_[mod(start_ - (cache_[start_]->height() - height))];
+  }
+
+  ChainEpoch TipsetCacheImpl::windowMin() const {
+    ChainEpoch head_height = cache_[start_]->height();
+    return std::max<ChainEpoch>(0, head_height + 1 - (ChainEpoch)cache_.size());
+  }
+
+  outcome::result<void> TipsetCacheImpl::backfill(ChainEpoch min) {
+    ChainEpoch head_height = cache_[start_]->height();
+    ChainEpoch tail = head_height + 1 - (ChainEpoch)len_;
+    if (min >= tail) {
+      return outcome::success();
+    }
+    OUTCOME_TRY(tipsets, get_range_(min, tail - 1, cache_[start_]->key));
+    for (auto height{min}; height < tail; ++height) {
+      slot(height) = boost::none;
+    }
+    for (auto &tipset : tipsets) {
+      if (tipset->epoch() >= min && tipset->epoch() < tail) {
+        slot(tipset->epoch()) = *tipset;
+      }
+    }
+    len_ = static_cast<uint64_t>(head_height + 1 - min);
+    return outcome::success();
   }
 
   boost::optional<Tipset> TipsetCacheImpl::best() const {
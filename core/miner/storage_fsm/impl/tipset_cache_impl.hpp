@@ -13,13 +13,27 @@
 namespace fc::mining {
   using primitives::tipset::TipsetKey;
 
+  /**
+   * Ring of last tipsets by height. Heights between tail and head are
+   * tracked explicitly, empty slot is null round. Heights below tail but
+   * inside capability are backfilled with one range request, heights below
+   * capability are requested directly.
+   */
   class TipsetCacheImpl : public TipsetCache {
    public:
+    /// Lowest tipset not below height, on chain of node head
     using GetTipsetFunction =
         std::function<outcome::result<primitives::tipset::TipsetCPtr>(
             ChainEpoch)>;
+    /// Tipsets with heights in range on chain of tipset, ascending
+    using GetRangeFunction = std::function<
+        outcome::result<std::vector<primitives::tipset::TipsetCPtr>>(
+            ChainEpoch, ChainEpoch, const TipsetKey &)>;
 
-    TipsetCacheImpl(uint64_t capability, GetTipsetFunction get_function);
+    /// Without range function, range is loaded with get function
+    TipsetCacheImpl(uint64_t capability,
+                    GetTipsetFunction get_function,
+                    GetRangeFunction get_range = {});
 
     outcome::result<void> add(const Tipset &tipset) override;
 
@@ -34,6 +48,15 @@ namespace fc::mining {
    private:
     int64_t mod(int64_t x);
 
+    /// Slot of height between tail and head
+    boost::optional<Tipset> &slot(ChainEpoch height);
+
+    /// Lowest height which may be cached
+    ChainEpoch windowMin() const;
+
+    /// Loads heights from min up to tail and makes min new tail
+    outcome::result<void> backfill(ChainEpoch min);
+
     std::vector<boost::optional<Tipset>> cache_;
 
     int64_t start_;
@@ -41,6 +64,8 @@ namespace fc::mining {
     uint64_t len_;
 
     GetTipsetFunction get_function_;
+
+    GetRangeFunction get_range_;
   };
 }  // namespace fc::mining
 
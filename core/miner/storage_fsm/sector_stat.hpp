@@ -19,6 +19,9 @@ namespace fc::mining {
     virtual void updateSector(SectorId sector, SealingState state) = 0;
 
     virtual uint64_t currentSealing() const = 0;
+
+    /// Number of sectors in given state
+    virtual uint64_t inState(SealingState state) const = 0;
   };
 }  // namespace fc::mining
 
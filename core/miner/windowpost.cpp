@@ -5,6 +5,9 @@
 
 #include "miner/windowpost.hpp"
 
+#include <boost/asio/post.hpp>
+#include <future>
+
 #include "vm/version.hpp"
 
 namespace fc::mining {
@@ -14,11 +17,39 @@ namespace fc::mining {
 
   inline const api::MessageSendSpec kSpec{50 * kFilecoinPrecision};
 
+  /// Threads checking sectors of partitions
+  constexpr size_t kCheckThreads{8};
+
+  /// Call f(i) for each partition index on several threads
+  template <typename F>
+  std::vector<outcome::result<RleBitset>> checkParallel(size_t n, const F &f) {
+    std::vector<boost::optional<outcome::result<RleBitset>>> results(n);
+    std::vector<std::future<void>> threads;
+    for (size_t t{0}; t < std::min(n, kCheckThreads); ++t) {
+      threads.push_back(std::async(std::launch::async, [&, t] {
+        for (auto i{t}; i < n; i += kCheckThreads) {
+          results[i] = f(i);
+        }
+      }));
+    }
+    for (auto &thread : threads) {
+      thread.get();
+    }
+    std::vector<outcome::result<RleBitset>> checked;
+    checked.reserve(n);
+    for (auto &result : results) {
+      checked.push_back(std::move(*result));
+    }
+    return checked;
+  }
+
   outcome::result<std::shared_ptr<WindowPoStScheduler>>
   WindowPoStScheduler::create(std::shared_ptr<Api> api,
                               std::shared_ptr<Prover> prover,
                               std::shared_ptr<FaultTracker> fault_tracker,
-                              const Address &miner) {
+                              const Address &miner,
+                              std::shared_ptr<boost::asio::io_context> io,
+                              std::shared_ptr<boost::asio::thread_pool> pool) {
     OUTCOME_TRY(chan, api->ChainNotify());
     auto scheduler{std::make_shared<WindowPoStScheduler>()};
     scheduler->channel = std::move(chan.channel);
@@ -26,6 +57,8 @@ namespace fc::mining {
     scheduler->prover = std::move(prover);
     scheduler->fault_tracker = std::move(fault_tracker);
     scheduler->miner = miner;
+    scheduler->io = std::move(io);
+    scheduler->pool = std::move(pool);
     OUTCOME_TRY(info, api->StateMinerInfo(miner, {}));
     OUTCOME_TRYA(scheduler->worker, api->StateAccountKey(info.worker, {}));
     scheduler->part_size = info.window_post_partition_sectors;
@@ -47,6 +80,12 @@ namespace fc::mining {
   }
 
   void WindowPoStScheduler::onChange(TipsetCPtr revert, TipsetCPtr apply) {
+    head = apply;
+    for (auto &[open, cached] : cache) {
+      if (revert && revert->epoch() < open) {
+        cached.submitted = 0;
+      }
+    }
     DeadlineInfo deadline;
     if (auto _deadline{api->StateMinerProvingDeadline(miner, apply->key)}) {
       deadline = _deadline.value();
@@ -61,41 +100,21 @@ namespace fc::mining {
     }
     if (apply->epoch() >= deadline.challenge) {
       auto &cached{
-          cache.emplace(deadline.open, Cached{deadline, {}, 0}).first->second};
+          cache
+              .emplace(deadline.open,
+                       Cached{deadline,
+                              {},
+                              0,
+                              0,
+                              std::chrono::steady_clock::now()})
+              .first->second};
 
       // TODO: fault cutoff
       auto declare_index{(deadline.index + 2) % kWPoStPeriodDeadlines};
-      if (auto _parts{
-              api->StateMinerPartitions(miner, declare_index, apply->key)}) {
-        auto declare{[&](auto faults) {
-          DeclareFaults::Params params;
-          uint64_t _part{0};
-          for (auto &part : _parts.value()) {
-            if (auto _sectors{checkSectors(faults
-                                               ? part.live - part.faulty
-                                               : part.faulty - part.recovering,
-                                           !faults)}) {
-              auto &sectors{_sectors.value()};
-              if (!sectors.empty()) {
-                params.declarations.push_back(
-                    {declare_index, _part, std::move(sectors)});
-              }
-            } else {
-              return;
-            }
-            ++_part;
-          }
-          if (!params.declarations.empty()) {
-            std::ignore = pushMessage(
-                faults ? DeclareFaults::Number : DeclareFaultsRecovered::Number,
-                codec::cbor::encode(params).value());
-          }
-        }};
-        declare(false);
-        if (apply->height() <= vm::version::kUpgradeIgnitionHeight) {
-          declare(true);
-        }
-      }
+      boost::asio::post(*pool,
+                        [self{shared_from_this()}, declare_index, apply] {
+                          self->declareFaults(declare_index, apply);
+                        });
 
       if (auto _parts{
               api->StateMinerPartitions(miner, deadline.index, apply->key)}) {
@@ -105,85 +124,196 @@ namespace fc::mining {
                 api::DomainSeparationTag::WindowedPoStChallengeSeed,
                 deadline.challenge,
                 seed)}) {
-          auto prove{[&](auto _part, auto parts) -> outcome::result<void> {
-            SubmitWindowedPoSt::Params params;
-            params.deadline = deadline.index;
-            std::vector<SectorInfo> sectors;
-            RleBitset post_skip;
-            for (auto &part : parts) {
-              auto to_prove{part.live - part.faulty + part.recovering};
-              OUTCOME_TRY(good, checkSectors(to_prove, true));
-              good = good - post_skip;
-              auto skip{to_prove - good};
-              OUTCOME_TRY(_sectors,
-                          api->StateMinerSectors(miner, good, apply->key));
-              if (!_sectors.empty()) {
-                std::map<api::SectorNumber, SectorInfo> map;
-                for (auto &sector : _sectors) {
-                  map.emplace(sector.sector,
-                              SectorInfo{
-                                  sector.seal_proof,
-                                  sector.sector,
-                                  sector.sealed_cid,
+          auto &parts{_parts.value()};
+          auto batch_size{std::max<uint64_t>(1, part_size)};
+          for (uint64_t first{0}; first < parts.size(); first += batch_size) {
+            std::vector<Partition> batch{
+                parts.begin() + first,
+                parts.begin() + std::min<uint64_t>(parts.size(),
+                                                   first + batch_size)};
+            ++cached.proving;
+            boost::asio::post(*pool,
+                              [self{shared_from_this()},
+                               deadline,
+                               first,
+                               batch{std::move(batch)},
+                               rand{_rand.value()},
+                               apply]() mutable {
+                                self->prove(deadline,
+                                            first,
+                                            std::move(batch),
+                                            rand,
+                                            apply);
                               });
-                }
-                auto sub{map.at(_sectors[0].sector)};
-                for (auto id : part.all) {
-                  auto it{map.find(id)};
-                  if (it == map.end()) {
-                    sectors.push_back(sub);
-                  } else {
-                    sectors.push_back(std::move(it->second));
-                  }
-                }
-                params.partitions.push_back({_part, skip});
-              }
-              ++_part;
-            }
-            if (!params.partitions.empty()) {
-              // TODO: retry 5 times
-              if (auto _proof{prover->generateWindowPoSt(
-                      miner.getId(), sectors, _rand.value())}) {
-                auto &proof{_proof.value()};
-                params.proofs = std::move(proof.proof);
-                for (auto &sector : proof.skipped) {
-                  post_skip.insert(sector.sector);
-                }
-                cached.params.push_back(std::move(params));
-              }
+          }
+          spdlog::info("WindowPoStScheduler deadline {} proving {} partitions",
+                       deadline.index,
+                       parts.size());
+        }
+      }
+    }
+    submit();
+  }
+
+  void WindowPoStScheduler::declareFaults(uint64_t declare_index,
+                                          TipsetCPtr apply) {
+    auto _parts{api->StateMinerPartitions(miner, declare_index, apply->key)};
+    if (!_parts) {
+      return;
+    }
+    auto &parts{_parts.value()};
+    auto declare{[&](bool faults) {
+      auto checked{checkParallel(parts.size(), [&](size_t i) {
+        auto &part{parts[i]};
+        return checkSectors(
+            faults ? part.live - part.faulty : part.faulty - part.recovering,
+            !faults);
+      })};
+      DeclareFaults::Params params;
+      for (uint64_t _part{0}; _part < checked.size(); ++_part) {
+        if (!checked[_part]) {
+          return;
+        }
+        auto &sectors{checked[_part].value()};
+        if (!sectors.empty()) {
+          params.declarations.push_back(
+              {declare_index, _part, std::move(sectors)});
+        }
+      }
+      if (!params.declarations.empty()) {
+        std::ignore = pushMessage(
+            faults ? DeclareFaults::Number : DeclareFaultsRecovered::Number,
+            codec::cbor::encode(params).value());
+      }
+    }};
+    declare(false);
+    if (apply->height() <= vm::version::kUpgradeIgnitionHeight) {
+      declare(true);
+    }
+  }
+
+  void WindowPoStScheduler::prove(const DeadlineInfo &deadline,
+                                  uint64_t first_part,
+                                  std::vector<Partition> parts,
+                                  const Randomness &rand,
+                                  TipsetCPtr apply) {
+    auto start{std::chrono::steady_clock::now()};
+    auto _params{[&]() -> outcome::result<
+                           boost::optional<SubmitWindowedPoSt::Params>> {
+      SubmitWindowedPoSt::Params params;
+      params.deadline = deadline.index;
+      std::vector<SectorInfo> sectors;
+      auto checked{checkParallel(parts.size(), [&](size_t i) {
+        auto &part{parts[i]};
+        return checkSectors(part.live - part.faulty + part.recovering, true);
+      })};
+      for (size_t i{0}; i < parts.size(); ++i) {
+        auto &part{parts[i]};
+        auto to_prove{part.live - part.faulty + part.recovering};
+        OUTCOME_TRY(good, checked[i]);
+        auto skip{to_prove - good};
+        OUTCOME_TRY(_sectors, api->StateMinerSectors(miner, good, apply->key));
+        if (!_sectors.empty()) {
+          std::map<api::SectorNumber, SectorInfo> map;
+          for (auto &sector : _sectors) {
+            map.emplace(sector.sector,
+                        SectorInfo{
+                            sector.seal_proof,
+                            sector.sector,
+                            sector.sealed_cid,
+                        });
+          }
+          auto sub{map.at(_sectors[0].sector)};
+          for (auto id : part.all) {
+            auto it{map.find(id)};
+            if (it == map.end()) {
+              sectors.push_back(sub);
+            } else {
+              sectors.push_back(std::move(it->second));
             }
-            return outcome::success();
-          }};
-          auto parts{gsl::make_span(_parts.value())};
-          for (auto _part{0u}; _part < parts.size(); _part += part_size) {
-            std::ignore = prove(
-                _part,
-                parts.subspan(
-                    _part, std::min<size_t>(parts.size(), _part + part_size)));
           }
+          params.partitions.push_back({first_part + i, skip});
         }
       }
+      if (params.partitions.empty()) {
+        return boost::none;
+      }
+      // TODO: retry 5 times, skipping proof.skipped sectors
+      OUTCOME_TRY(proof,
+                  prover->generateWindowPoSt(miner.getId(), sectors, rand));
+      params.proofs = std::move(proof.proof);
+      return std::move(params);
+    }()};
+    auto duration{std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start)};
+    boost::asio::post(*io,
+                      [self{shared_from_this()},
+                       open{deadline.open},
+                       _params{std::move(_params)},
+                       duration]() mutable {
+                        self->onProved(open, std::move(_params), duration);
+                      });
+  }
+
+  void WindowPoStScheduler::onProved(
+      ChainEpoch open,
+      outcome::result<boost::optional<SubmitWindowedPoSt::Params>> _params,
+      std::chrono::milliseconds duration) {
+    auto it{cache.find(open)};
+    if (it == cache.end()) {
+      return;
+    }
+    auto &cached{it->second};
+    --cached.proving;
+    stats.last_prove = duration;
+    if (!_params) {
+      ++stats.failed;
+      spdlog::error("WindowPoStScheduler deadline {} prove error {}",
+                    cached.deadline.index,
+                    _params.error());
+      return;
+    }
+    if (!_params.value()) {
+      return;
+    }
+    ++stats.proved;
+    auto margin{cached.deadline.close - head->epoch()};
+    if (!stats.min_margin || margin < *stats.min_margin) {
+      stats.min_margin = margin;
     }
+    spdlog::info(
+        "WindowPoStScheduler deadline {} batch proved in {}ms, {}ms since "
+        "challenge, {} epochs before close",
+        cached.deadline.index,
+        duration.count(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - cached.started)
+            .count(),
+        margin);
+    cached.params.push_back(std::move(*_params.value()));
+    submit();
+  }
 
+  void WindowPoStScheduler::submit() {
+    if (!head) {
+      return;
+    }
     for (auto &[open, cached] : cache) {
-      if (revert && revert->epoch() < open) {
-        cached.submitted = 0;
-      }
       if (cached.submitted < cached.params.size()
-          && apply->epoch() < cached.deadline.close
-          && apply->epoch() >= open + kStartConfidence) {
+          && head->epoch() < cached.deadline.close
+          && head->epoch() >= open + kStartConfidence) {
         if (auto _rand{api->ChainGetRandomnessFromTickets(
-                apply->key,
+                head->key,
                 api::DomainSeparationTag::PoStChainCommit,
                 open,
                 {})}) {
-          for (auto &params : cached.params) {
+          for (; cached.submitted < cached.params.size(); ++cached.submitted) {
+            auto &params{cached.params[cached.submitted]};
             params.chain_commit_epoch = open;
             params.chain_commit_rand = _rand.value();
             std::ignore = pushMessage(SubmitWindowedPoSt::Number,
                                       codec::cbor::encode(params).value());
           }
-          ++cached.submitted;
         }
       }
     }
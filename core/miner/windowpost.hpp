@@ -5,6 +5,10 @@
 
 #pragma once
 
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <chrono>
+
 #include "api/api.hpp"
 #include "sector_storage/fault_tracker.hpp"
 #include "sector_storage/spec_interfaces/prover.hpp"
@@ -15,6 +19,8 @@ namespace fc::mining {
   using api::Api;
   using api::ChainEpoch;
   using api::DeadlineInfo;
+  using api::Partition;
+  using api::Randomness;
   using api::RleBitset;
   using api::TipsetCPtr;
   using sector_storage::FaultTracker;
@@ -22,7 +28,12 @@ namespace fc::mining {
   using vm::actor::builtin::v0::miner::SubmitWindowedPoSt;
   using vm::message::MethodNumber;
 
-  // synchronous WindowPoSt
+  /**
+   * WindowPoSt of deadline is proved on thread pool, batches of partitions
+   * in parallel, so head changes are not blocked by proving.
+   * Batch is submitted as soon as it is proved and chain commit epoch is
+   * reached. State is accessed only on io thread.
+   */
   struct WindowPoStScheduler
       : public std::enable_shared_from_this<WindowPoStScheduler> {
     static constexpr auto kStartConfidence{4};
@@ -30,15 +41,43 @@ namespace fc::mining {
     struct Cached {
       DeadlineInfo deadline;
       std::vector<SubmitWindowedPoSt::Params> params;
+      /// Params pushed since last revert
       size_t submitted;
+      /// Batches being proved
+      size_t proving;
+      std::chrono::steady_clock::time_point started;
+    };
+
+    struct Stats {
+      size_t proved{};
+      size_t failed{};
+      std::chrono::milliseconds last_prove{};
+      /// Least epochs left until deadline close when batch was proved
+      boost::optional<ChainEpoch> min_margin;
     };
 
     static outcome::result<std::shared_ptr<WindowPoStScheduler>> create(
         std::shared_ptr<Api> api,
         std::shared_ptr<Prover> prover,
         std::shared_ptr<FaultTracker> fault_tracker,
-        const Address &miner);
+        const Address &miner,
+        std::shared_ptr<boost::asio::io_context> io,
+        std::shared_ptr<boost::asio::thread_pool> pool);
     void onChange(TipsetCPtr revert, TipsetCPtr apply);
+    /// Runs on pool
+    void declareFaults(uint64_t declare_index, TipsetCPtr apply);
+    /// Runs on pool, result is handled by onProved
+    void prove(const DeadlineInfo &deadline,
+               uint64_t first_part,
+               std::vector<Partition> parts,
+               const Randomness &rand,
+               TipsetCPtr apply);
+    void onProved(ChainEpoch open,
+                  outcome::result<boost::optional<SubmitWindowedPoSt::Params>>
+                      _params,
+                  std::chrono::milliseconds duration);
+    /// Push proved params of deadlines in submission window
+    void submit();
     outcome::result<RleBitset> checkSectors(const RleBitset &sectors, bool ok);
     outcome::result<void> pushMessage(MethodNumber method, Buffer params);
 
@@ -46,9 +85,13 @@ namespace fc::mining {
     std::shared_ptr<Api> api;
     std::shared_ptr<Prover> prover;
     std::shared_ptr<FaultTracker> fault_tracker;
+    std::shared_ptr<boost::asio::io_context> io;
+    std::shared_ptr<boost::asio::thread_pool> pool;
     Address miner, worker;
     std::map<ChainEpoch, Cached> cache;
+    TipsetCPtr head;
     uint64_t part_size;
     RegisteredProof proof_type;
+    Stats stats;
   };
 }  // namespace fc::mining
@@ -0,0 +1,76 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/block_filter.hpp"
+
+#include "clock/chain_epoch_clock.hpp"
+#include "clock/utc_clock.hpp"
+#include "primitives/cid/cid_of_cbor.hpp"
+
+namespace fc::pubsub {
+  using primitives::block::BlockWithCids;
+  using primitives::cid::getCidOfCbor;
+
+  BlockFilter::BlockFilter(Config config,
+                           std::shared_ptr<UTCClock> utc_clock,
+                           std::shared_ptr<ChainEpochClock> epoch_clock,
+                           Check check)
+      : config{config},
+        utc_clock{std::move(utc_clock)},
+        epoch_clock{std::move(epoch_clock)},
+        check{std::move(check)},
+        seen{config.seen} {}
+
+  bool BlockFilter::validate(BytesIn from, BytesIn data) {
+    auto invalid{[&] {
+      ++stats.invalid;
+      return false;
+    }};
+    if (static_cast<size_t>(data.size()) > config.max_size) {
+      return invalid();
+    }
+    auto _block{codec::cbor::decode<BlockWithCids>(data)};
+    if (!_block) {
+      return invalid();
+    }
+    auto &block{_block.value().header};
+    auto _now{epoch_clock->epochAtTime(utc_clock->nowUTC())};
+    if (!_now) {
+      return invalid();
+    }
+    auto now{_now.value()};
+    auto height{static_cast<ChainEpoch>(block.height)};
+    if (height > now + config.max_future || height + config.max_past < now) {
+      return invalid();
+    }
+    auto _cid{getCidOfCbor(block)};
+    if (!_cid) {
+      return invalid();
+    }
+    auto &cid{_cid.value()};
+    if (seen.contains(cid)) {
+      ++stats.duplicate;
+      return false;
+    }
+    if (now != epoch) {
+      epoch = now;
+      peer_blocks.clear();
+    }
+    auto &count{peer_blocks[{from.begin(), from.end()}]};
+    if (count >= config.peer_blocks) {
+      ++stats.rate_limited;
+      return false;
+    }
+    ++count;
+    auto valid{!check || check(block)};
+    // invalid blocks are remembered too, so they are checked once
+    seen.put(cid, valid, 1);
+    if (!valid) {
+      return invalid();
+    }
+    ++stats.accepted;
+    return true;
+  }
+}  // namespace fc::pubsub
@@ -0,0 +1,67 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <map>
+
+#include "common/buffer.hpp"
+#include "common/lru_cache.hpp"
+#include "node/fwd.hpp"
+#include "primitives/block/block.hpp"
+
+namespace fc::pubsub {
+  using clock::ChainEpochClock;
+  using clock::UTCClock;
+  using primitives::ChainEpoch;
+  using primitives::block::BlockHeader;
+
+  /**
+   * Cheap checks of gossiped blocks, used as gossip topic validator, so
+   * invalid and duplicate blocks are neither forwarded nor synced.
+   * Runs on gossip thread, not thread-safe.
+   */
+  struct BlockFilter {
+    /// Consensus checks, e.g. known miner, ticket and election proof
+    using Check = std::function<bool(const BlockHeader &)>;
+
+    struct Config {
+      size_t max_size{1 << 20};
+      /// Blocks allowed from future, for clock drift
+      ChainEpoch max_future{1};
+      /// Blocks older than that are not gossiped
+      ChainEpoch max_past{900};
+      /// Blocks accepted from one peer per epoch
+      size_t peer_blocks{20};
+      /// Recent block cids remembered to drop duplicates
+      size_t seen{8192};
+    };
+
+    struct Stats {
+      size_t accepted{};
+      size_t duplicate{};
+      size_t invalid{};
+      size_t rate_limited{};
+    };
+
+    BlockFilter(Config config,
+                std::shared_ptr<UTCClock> utc_clock,
+                std::shared_ptr<ChainEpochClock> epoch_clock,
+                Check check = {});
+
+    /// Validate gossip message data from peer
+    bool validate(BytesIn from, BytesIn data);
+
+    Config config;
+    std::shared_ptr<UTCClock> utc_clock;
+    std::shared_ptr<ChainEpochClock> epoch_clock;
+    Check check;
+    common::LruCache<CID, bool> seen;
+    /// Epoch of peer_blocks counters
+    ChainEpoch epoch{-1};
+    std::map<std::vector<uint8_t>, size_t> peer_blocks;
+    Stats stats;
+  };
+}  // namespace fc::pubsub
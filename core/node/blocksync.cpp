@@ -6,8 +6,11 @@
 #include <libp2p/host/host.hpp>
 
 #include "common/libp2p/cbor_stream.hpp"
+#include "common/lru_cache.hpp"
+#include "common/metrics.hpp"
 #include "node/blocksync.hpp"
-#include "primitives/tipset/tipset.hpp"
+#include "primitives/tipset/tipset_cache.hpp"
+#include "storage/ipfs/impl/batch_datastore.hpp"
 
 #define MOVE(x)  \
   x {            \
@@ -24,6 +27,9 @@ namespace fc::blocksync {
   using primitives::block::MsgMeta;
   using primitives::block::SignedMessage;
   using primitives::block::UnsignedMessage;
+  using primitives::tipset::TipsetCache;
+  using primitives::tipset::TipsetKey;
+  using storage::ipfs::BatchDatastore;
 
   static constexpr auto kProtocolId{"/fil/sync/blk/0.0.1"};
   constexpr size_t kBlockSyncMaxRequestLength{800};
@@ -69,7 +75,7 @@ namespace fc::blocksync {
              secp_indices)
 
   outcome::result<std::shared_ptr<const Tipset>> unpack(
-      const IpldPtr &ipld, Response::Tipset packed) {
+      const IpldPtr &store, Response::Tipset packed) {
     auto safe{[&](auto &messages, auto &indices) {
       if (indices.size() != packed.blocks.size()) {
         return false;
@@ -90,11 +96,16 @@ namespace fc::blocksync {
         return Error::kInconsistent;
       }
     }
+    // write whole tipset at once, nothing is written if inconsistent
+    auto ipld{std::make_shared<BatchDatastore>(store)};
+    std::vector<CID> cids;
     std::vector<BlockHeader> blocks;
     for (auto &block : packed.blocks) {
-      OUTCOME_TRY(ipld->setCbor(block));
+      OUTCOME_TRY(cid, ipld->setCbor(block));
+      cids.push_back(std::move(cid));
       blocks.push_back(std::move(block));
     }
+    // headers only response doesn't have messages, they are fetched later
     std::vector<CID> bls_cids, secp_cids;
     if (_msgs) {
       for (auto &message : _msgs->bls_messages) {
@@ -105,26 +116,29 @@ namespace fc::blocksync {
         OUTCOME_TRY(cid, ipld->setCbor(message));
         secp_cids.push_back(std::move(cid));
       }
-    }
-    auto i{0};
-    for (auto &block : blocks) {
-      MsgMeta messages;
-      ipld->load(messages);
-      if (_msgs) {
+      auto i{0};
+      for (auto &block : blocks) {
+        std::vector<CID> block_bls, block_secp;
         for (auto &j : _msgs->bls_indices[i]) {
-          OUTCOME_TRY(messages.bls_messages.append(bls_cids[j]));
+          block_bls.push_back(bls_cids[j]);
         }
         for (auto &j : _msgs->secp_indices[i]) {
-          OUTCOME_TRY(messages.secp_messages.append(secp_cids[j]));
+          block_secp.push_back(secp_cids[j]);
         }
+        MsgMeta messages;
+        OUTCOME_TRYA(messages.bls_messages,
+                     adt::Array<CID>::fromValues(ipld, block_bls));
+        OUTCOME_TRYA(messages.secp_messages,
+                     adt::Array<CID>::fromValues(ipld, block_secp));
+        OUTCOME_TRY(cid, ipld->setCbor(messages));
+        if (cid != block.messages) {
+          return Error::kInconsistent;
+        }
+        ++i;
       }
-      OUTCOME_TRY(cid, ipld->setCbor(messages));
-      if (cid != block.messages) {
-        return Error::kInconsistent;
-      }
-      ++i;
     }
-    return Tipset::create(blocks);
+    OUTCOME_TRY(ipld->commit());
+    return Tipset::create(std::move(cids), std::move(blocks));
   }
 
   void fetch(std::shared_ptr<Host> host,
@@ -132,38 +146,142 @@ namespace fc::blocksync {
              IpldPtr ipld,
              std::vector<CID> blocks,
              Cb cb) {
+    fetchChain(std::move(host),
+               peer,
+               std::move(ipld),
+               std::move(blocks),
+               1,
+               true,
+               [MOVE(cb)](auto _chain) {
+                 if (!_chain) {
+                   return cb(_chain.error());
+                 }
+                 cb(std::move(_chain.value().front()));
+               });
+  }
+
+  /// Send request and read response with kOk or kPartial status
+  void request(std::shared_ptr<Host> host,
+               const PeerInfo &peer,
+               Request request,
+               std::function<void(outcome::result<Response>)> cb) {
+    static auto &latency{common::metrics::histogram(
+        "fc_blocksync_request_seconds", "Blocksync request round trip")};
+    static auto &failed{common::metrics::counter(
+        "fc_blocksync_request_failed_total",
+        "Blocksync requests without usable response")};
+    cb = [MOVE(cb), start{std::chrono::steady_clock::now()}](auto _response) {
+      latency.observeSince(start);
+      if (!_response) {
+        failed.inc();
+      }
+      cb(std::move(_response));
+    };
     host->newStream(
-        peer, kProtocolId, [MOVE(ipld), MOVE(blocks), MOVE(cb)](auto _stream) {
+        peer,
+        kProtocolId,
+        [MOVE(request), MOVE(cb)](auto _stream) {
           if (!_stream) {
             return cb(_stream.error());
           }
           auto stream{std::make_shared<CborStream>(_stream.value())};
-          stream->write(
-              Request{std::move(blocks)},
-              [stream, MOVE(ipld), MOVE(cb)](auto _n) {
-                if (!_n) {
+          stream->write(request, [stream, MOVE(cb)](auto _n) {
+            if (!_n) {
+              stream->close();
+              return cb(_n.error());
+            }
+            stream->template read<Response>(
+                [stream, MOVE(cb)](auto _response) {
                   stream->close();
-                  return cb(_n.error());
-                }
-                stream->template read<Response>(
-                    [stream, MOVE(ipld), MOVE(cb)](auto _response) {
-                      stream->close();
-                      if (!_response) {
-                        return cb(_response.error());
-                      }
-                      auto &response{_response.value()};
-                      if (response.status != Error::kOk) {
-                        return cb(response.status);
-                      }
-                      if (response.chain.empty()) {
-                        return cb(Error::kPartial);
-                      }
-                      cb(unpack(ipld, std::move(response.chain.front())));
-                    });
-              });
+                  if (!_response) {
+                    return cb(_response.error());
+                  }
+                  auto &response{_response.value()};
+                  if (response.status != Error::kOk
+                      && response.status != Error::kPartial) {
+                    return cb(response.status);
+                  }
+                  if (response.chain.empty()) {
+                    return cb(Error::kPartial);
+                  }
+                  cb(std::move(response));
+                });
+          });
+        });
+  }
+
+  void fetchChain(std::shared_ptr<Host> host,
+                  const PeerInfo &peer,
+                  IpldPtr ipld,
+                  std::vector<CID> blocks,
+                  size_t depth,
+                  bool messages,
+                  ChainCb cb) {
+    auto key{blocks};
+    request(
+        std::move(host),
+        peer,
+        {std::move(blocks),
+         std::min(depth, kBlockSyncMaxRequestLength),
+         messages ? Request::BLOCKS_AND_MESSAGES : Request::BLOCKS},
+        [MOVE(ipld), MOVE(key), MOVE(cb)](auto _response) {
+          if (!_response) {
+            return cb(_response.error());
+          }
+          std::vector<TipsetCPtr> chain;
+          for (auto &packed : _response.value().chain) {
+            auto _ts{unpack(ipld, std::move(packed))};
+            if (!_ts) {
+              return cb(_ts.error());
+            }
+            auto &ts{_ts.value()};
+            auto linked{chain.empty()
+                            ? ts->key.cids() == key
+                            : chain.back()->getParents() == ts->key};
+            if (!linked) {
+              return cb(Error::kInconsistent);
+            }
+            chain.push_back(std::move(ts));
+          }
+          cb(std::move(chain));
         });
   }
 
+  void fetchMessages(std::shared_ptr<Host> host,
+                     const PeerInfo &peer,
+                     IpldPtr ipld,
+                     std::vector<TipsetCPtr> chain,
+                     MessagesCb cb) {
+    auto blocks{chain.front()->key.cids()};
+    auto depth{std::min(chain.size(), kBlockSyncMaxRequestLength)};
+    request(std::move(host),
+            peer,
+            {std::move(blocks), depth, Request::MESSAGES},
+            [MOVE(ipld), MOVE(chain), MOVE(cb)](auto _response) {
+              if (!_response) {
+                return cb(_response.error());
+              }
+              auto &response{_response.value()};
+              if (response.chain.size() > chain.size()) {
+                return cb(Error::kInconsistent);
+              }
+              auto i{0u};
+              for (auto &packed : response.chain) {
+                if (!packed.messages) {
+                  return cb(Error::kInconsistent);
+                }
+                // headers are known, unpack checks messages against them
+                packed.blocks = chain[i]->blks;
+                auto _ts{unpack(ipld, std::move(packed))};
+                if (!_ts) {
+                  return cb(_ts.error());
+                }
+                ++i;
+              }
+              cb(response.chain.size());
+            });
+  }
+
   template <typename T>
   struct MessageVisitor {
     outcome::result<void> operator()(size_t, const CID &cid) {
@@ -183,43 +301,178 @@ namespace fc::blocksync {
     std::map<CID, size_t> visited{};
   };
 
-  outcome::result<std::vector<Response::Tipset>> getChain(
-      IpldPtr ipld, const Request &request) {
-    OUTCOME_TRY(ts, Tipset::load(*ipld, request.blocks));
-    std::vector<Response::Tipset> chain;
-    while (true) {
-      Response::Tipset packed;
-      if (request.options & Request::MESSAGES) {
-        Response::Messages msgs;
-        MessageVisitor<UnsignedMessage> bls_visitor{
-            ipld, msgs.bls_messages, msgs.bls_indices};
-        MessageVisitor<SignedMessage> secp_visitor{
-            ipld, msgs.secp_messages, msgs.secp_indices};
-        for (auto &block : ts->blks) {
-          OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(block.messages));
-          msgs.bls_indices.emplace_back();
-          OUTCOME_TRY(meta.bls_messages.visit(bls_visitor));
-          msgs.secp_indices.emplace_back();
-          OUTCOME_TRY(meta.secp_messages.visit(secp_visitor));
+  outcome::result<Response::Messages> getMessages(IpldPtr ipld,
+                                                  const Tipset &ts) {
+    Response::Messages msgs;
+    MessageVisitor<UnsignedMessage> bls_visitor{
+        ipld, msgs.bls_messages, msgs.bls_indices};
+    MessageVisitor<SignedMessage> secp_visitor{
+        ipld, msgs.secp_messages, msgs.secp_indices};
+    for (auto &block : ts.blks) {
+      OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(block.messages));
+      msgs.bls_indices.emplace_back();
+      OUTCOME_TRY(meta.bls_messages.visit(bls_visitor));
+      msgs.secp_indices.emplace_back();
+      OUTCOME_TRY(meta.secp_messages.visit(secp_visitor));
+    }
+    return msgs;
+  }
+
+  using BufferCPtr = std::shared_ptr<const Buffer>;
+
+  /**
+   * Encoded blocks and messages of response tipsets by tipset key, bounded by
+   * bytes. Recent chain requested by many peers is read and encoded once.
+   */
+  class ServeCache {
+   public:
+    static constexpr size_t kMaxBytes{64 << 20};
+
+    ServeCache() : blocks_{kMaxBytes / 4}, messages_{kMaxBytes / 4 * 3} {}
+
+    outcome::result<BufferCPtr> blocks(const Tipset &ts) {
+      return get(blocks_, ts.key, [&] { return codec::cbor::encode(ts.blks); });
+    }
+
+    outcome::result<BufferCPtr> messages(const IpldPtr &ipld,
+                                         const Tipset &ts) {
+      return get(messages_, ts.key, [&]() -> outcome::result<Buffer> {
+        OUTCOME_TRY(msgs, getMessages(ipld, ts));
+        return codec::cbor::encode(msgs);
+      });
+    }
+
+   private:
+    template <typename F>
+    outcome::result<BufferCPtr> get(
+        common::LruCache<TipsetKey, BufferCPtr> &cache,
+        const TipsetKey &key,
+        const F &encode) {
+      {
+        std::lock_guard lock{mutex_};
+        if (auto encoded{cache.get(key)}) {
+          return *encoded;
         }
-        packed.messages = std::move(msgs);
       }
+      OUTCOME_TRY(_encoded, encode());
+      auto encoded{std::make_shared<const Buffer>(std::move(_encoded))};
+      std::lock_guard lock{mutex_};
+      cache.put(key, encoded, encoded->size());
+      return encoded;
+    }
+
+    std::mutex mutex_;
+    common::LruCache<TipsetKey, BufferCPtr> blocks_, messages_;
+  };
+
+  /**
+   * Encoded response split in pieces, cached parts are referenced instead of
+   * copied, small parts between them are joined
+   */
+  struct ResponsePieces {
+    static constexpr size_t kMinShared{1 << 10};
+
+    void add(BufferCPtr part) {
+      if (part->size() < kMinShared) {
+        return add(*part);
+      }
+      flush();
+      pieces.push_back(std::move(part));
+    }
+
+    void add(gsl::span<const uint8_t> bytes) {
+      pending.put(bytes);
+    }
+
+    void flush() {
+      if (!pending.empty()) {
+        pieces.push_back(std::make_shared<const Buffer>(std::move(pending)));
+        pending = {};
+      }
+    }
+
+    std::vector<BufferCPtr> pieces;
+    Buffer pending;
+  };
+
+  /**
+   * Writes response with chain of tipsets, same bytes as cbor encoded
+   * Response
+   */
+  outcome::result<std::vector<BufferCPtr>> encodeChain(
+      const IpldPtr &ipld,
+      TipsetCache &tipset_cache,
+      ServeCache &cache,
+      const Request &request,
+      Error status) {
+    // nested tuple and optional heads, empty list and null
+    constexpr uint8_t kTuple2{0x82}, kEmptyList{0x80}, kNull{0xF6};
+    OUTCOME_TRY(ts, tipset_cache.load(*ipld, TipsetKey{request.blocks}));
+    std::vector<BufferCPtr> chain;
+    while (true) {
+      chain.push_back(nullptr);
       if (request.options & Request::BLOCKS) {
-        packed.blocks = ts->blks;
+        OUTCOME_TRYA(chain.back(), cache.blocks(*ts));
+      }
+      chain.push_back(nullptr);
+      if (request.options & Request::MESSAGES) {
+        OUTCOME_TRYA(chain.back(), cache.messages(ipld, *ts));
       }
-      chain.push_back(std::move(packed));
-      if (chain.size() >= request.depth || ts->height() == 0) {
+      if (chain.size() / 2 >= request.depth || ts->height() == 0) {
         break;
       }
-      OUTCOME_TRYA(ts, ts->loadParent(*ipld));
+      OUTCOME_TRYA(ts, tipset_cache.loadParent(*ipld, *ts));
+    }
+
+    codec::cbor::CborEncodeStream head;
+    head.beginList(3);
+    head << status << std::string{};
+    head.beginList(chain.size() / 2);
+    ResponsePieces pieces;
+    pieces.add(std::move(head).data());
+    for (size_t i{0}; i < chain.size(); i += 2) {
+      pieces.add(gsl::make_span(&kTuple2, 1));
+      if (chain[i]) {
+        pieces.add(chain[i]);
+      } else {
+        pieces.add(gsl::make_span(&kEmptyList, 1));
+      }
+      if (chain[i + 1]) {
+        pieces.add(chain[i + 1]);
+      } else {
+        pieces.add(gsl::make_span(&kNull, 1));
+      }
     }
-    return chain;
+    pieces.flush();
+    return std::move(pieces.pieces);
   }
 
-  void serve(std::shared_ptr<Host> host, IpldPtr ipld) {
-    host->setProtocolHandler(kProtocolId, [MOVE(ipld)](auto _stream) {
+  /// Writes pieces one after another and closes stream
+  void writePieces(std::shared_ptr<CborStream> stream,
+                   std::shared_ptr<std::vector<BufferCPtr>> pieces,
+                   size_t i = 0) {
+    if (i == pieces->size()) {
+      return stream->close();
+    }
+    auto &piece{*pieces->at(i)};
+    stream->writeRaw(piece, [stream, pieces, i](auto _n) {
+      if (!_n) {
+        return stream->close();
+      }
+      writePieces(stream, pieces, i + 1);
+    });
+  }
+
+  void serve(std::shared_ptr<Host> host,
+             IpldPtr ipld,
+             std::shared_ptr<TipsetCache> tipset_cache) {
+    if (!tipset_cache) {
+      tipset_cache = std::make_shared<TipsetCache>();
+    }
+    auto cache{std::make_shared<ServeCache>()};
+    host->setProtocolHandler(kProtocolId, [=](auto _stream) {
       auto stream{std::make_shared<CborStream>(_stream)};
-      stream->template read<Request>([stream, MOVE(ipld)](auto _request) {
+      stream->template read<Request>([=](auto _request) {
         Response response;
         if (_request) {
           auto &request{_request.value()};
@@ -231,14 +484,19 @@ namespace fc::blocksync {
             if (partial) {
               request.depth = kBlockSyncMaxRequestLength;
             }
-            auto _chain{getChain(ipld, request)};
-            if (_chain) {
-              response.chain = std::move(_chain.value());
-              response.status = partial ? Error::kPartial : Error::kOk;
-            } else {
-              response.status = Error::kInternalError;
-              response.message = _chain.error().message();
+            auto _pieces{encodeChain(ipld,
+                                     *tipset_cache,
+                                     *cache,
+                                     request,
+                                     partial ? Error::kPartial : Error::kOk)};
+            if (_pieces) {
+              return writePieces(
+                  stream,
+                  std::make_shared<std::vector<BufferCPtr>>(
+                      std::move(_pieces.value())));
             }
+            response.status = Error::kInternalError;
+            response.message = _pieces.error().message();
           }
         } else {
           response.status = Error::kBadRequest;
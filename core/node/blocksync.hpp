@@ -22,15 +22,51 @@ namespace fc::blocksync {
     kBadRequest = 204,
   };
 
-  // TODO: depth/count
-  using Cb = std::function<void(outcome::result<std::shared_ptr<const Tipset>>)>;
+  using TipsetCPtr = std::shared_ptr<const Tipset>;
+  using Cb = std::function<void(outcome::result<TipsetCPtr>)>;
+  /// Fetch one tipset with messages
   void fetch(std::shared_ptr<Host> host,
              const PeerInfo &peer,
              IpldPtr ipld,
              std::vector<CID> blocks,
              Cb cb);
 
-  void serve(std::shared_ptr<Host> host, IpldPtr ipld);
+  using ChainCb = std::function<void(outcome::result<std::vector<TipsetCPtr>>)>;
+  /**
+   * Fetch up to `depth` tipsets starting from `blocks` and going to parents.
+   * Received headers (and messages if requested) are written to ipld.
+   * Callback gets tipsets in order from requested one down, chain may be
+   * shorter than requested.
+   */
+  void fetchChain(std::shared_ptr<Host> host,
+                  const PeerInfo &peer,
+                  IpldPtr ipld,
+                  std::vector<CID> blocks,
+                  size_t depth,
+                  bool messages,
+                  ChainCb cb);
+
+  using MessagesCb = std::function<void(outcome::result<size_t>)>;
+  /**
+   * Fetch messages of `chain` (tipsets from top down to parents) which headers
+   * are already known, with messages only request.
+   * Callback gets number of tipsets from top which messages were written.
+   */
+  void fetchMessages(std::shared_ptr<Host> host,
+                     const PeerInfo &peer,
+                     IpldPtr ipld,
+                     std::vector<TipsetCPtr> chain,
+                     MessagesCb cb);
+
+  /**
+   * Serve blocksync requests from ipld.
+   * Tipsets are loaded through `tipset_cache` (own one if null), encoded
+   * blocks and messages of recent tipsets are cached and shared by requests.
+   */
+  void serve(std::shared_ptr<Host> host,
+             IpldPtr ipld,
+             std::shared_ptr<primitives::tipset::TipsetCache> tipset_cache =
+                 nullptr);
 }  // namespace fc::blocksync
 
 OUTCOME_HPP_DECLARE_ERROR(fc::blocksync, Error)
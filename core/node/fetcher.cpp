@@ -0,0 +1,152 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/fetcher.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <libp2p/peer/peer_info.hpp>
+
+#include "node/blocksync.hpp"
+#include "storage/ipfs/graphsync/graphsync.hpp"
+
+namespace fc::sync {
+  namespace gsns = storage::ipfs::graphsync;
+
+  Fetcher::Fetcher(std::shared_ptr<Host> host,
+                   IpldPtr ipld,
+                   std::shared_ptr<Graphsync> graphsync,
+                   std::shared_ptr<boost::asio::io_context> io)
+      : host{std::move(host)},
+        ipld{std::move(ipld)},
+        graphsync{std::move(graphsync)},
+        io{std::move(io)} {}
+
+  template <typename K, typename T>
+  bool Fetcher::join(common::Inflight<K, T> &inflight,
+                     common::NegativeCache<PeerKey<K>, PeerKeyHash<K>> &failed,
+                     const PeerId &peer,
+                     const K &key,
+                     CbT<T> cb) {
+    if (auto error{failed.find({peer, key})}) {
+      ++stats.negative;
+      // don't call back before caller returns
+      auto fail{[cb{std::move(cb)}, error{*error}] { cb(error); }};
+      if (io) {
+        boost::asio::post(*io, std::move(fail));
+      } else {
+        fail();
+      }
+      return false;
+    }
+    if (inflight.wait(key, std::move(cb))) {
+      ++stats.requests;
+      return true;
+    }
+    ++stats.coalesced;
+    return false;
+  }
+
+  template <typename T>
+  CbT<T> Fetcher::timed(CbT<T> cb) {
+    return io ? withTimeout(*io, kFetchTimeout, std::move(cb)) : std::move(cb);
+  }
+
+  template <typename K, typename T>
+  void Fetcher::done(common::Inflight<K, T> &inflight,
+                     common::NegativeCache<PeerKey<K>, PeerKeyHash<K>> &failed,
+                     const PeerId &peer,
+                     const K &key,
+                     const outcome::result<T> &result) {
+    if (!result) {
+      failed.insert({peer, key}, result.error());
+    }
+    inflight.done(key, result);
+  }
+
+  void Fetcher::chain(const PeerId &peer,
+                      const TipsetKey &key,
+                      size_t depth,
+                      CbT<std::vector<TipsetCPtr>> cb) {
+    if (!join(inflight_chains, failed_chains, peer, key, std::move(cb))) {
+      return;
+    }
+    blocksync::fetchChain(
+        host,
+        {peer, {}},
+        ipld,
+        key.cids(),
+        depth,
+        false,
+        timed<std::vector<TipsetCPtr>>(
+            [self{shared_from_this()}, peer, key](auto _chain) {
+              self->done(self->inflight_chains,
+                         self->failed_chains,
+                         peer,
+                         key,
+                         _chain);
+            }));
+  }
+
+  void Fetcher::messages(const PeerId &peer,
+                         std::vector<TipsetCPtr> chain,
+                         CbT<size_t> cb) {
+    auto key{chain.front()->key};
+    CbT<size_t> limited{[size{chain.size()}, cb{std::move(cb)}](auto _fetched) {
+      if (!_fetched) {
+        return cb(_fetched.error());
+      }
+      cb(std::min(_fetched.value(), size));
+    }};
+    if (!join(inflight_messages,
+              failed_messages,
+              peer,
+              key,
+              std::move(limited))) {
+      return;
+    }
+    blocksync::fetchMessages(
+        host,
+        {peer, {}},
+        ipld,
+        std::move(chain),
+        timed<size_t>([self{shared_from_this()}, peer, key](auto _fetched) {
+          self->done(self->inflight_messages,
+                     self->failed_messages,
+                     peer,
+                     key,
+                     _fetched);
+        }));
+  }
+
+  void Fetcher::dag(const PeerId &peer,
+                    const CID &root,
+                    const Selector &selector,
+                    CbT<void> cb) {
+    if (!join(inflight_dags, failed_dags, peer, root, std::move(cb))) {
+      return;
+    }
+    auto finish{timed<void>([self{shared_from_this()}, peer, root](auto _r) {
+      self->done(self->inflight_dags, self->failed_dags, peer, root, _r);
+    })};
+    auto sub{std::make_shared<gsns::Subscription>()};
+    *sub = graphsync->makeRequest(
+        peer,
+        {},
+        root,
+        selector.b,
+        {},
+        [finish{std::move(finish)}, sub](auto code, auto) {
+          if (gsns::isTerminal(code)) {
+            // blocks of response are stored before terminal status
+            if (gsns::isSuccess(code)) {
+              finish(outcome::success());
+            } else {
+              finish(std::errc::protocol_error);
+            }
+          }
+        });
+  }
+}  // namespace fc::sync
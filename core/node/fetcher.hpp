@@ -0,0 +1,126 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <boost/functional/hash.hpp>
+#include <libp2p/peer/peer_id.hpp>
+
+#include "common/inflight.hpp"
+#include "node/fwd.hpp"
+#include "primitives/tipset/tipset.hpp"
+#include "storage/ipld/selector.hpp"
+
+namespace fc::sync {
+  using libp2p::Host;
+  using libp2p::peer::PeerId;
+  using primitives::tipset::TipsetCPtr;
+  using storage::ipfs::graphsync::Graphsync;
+  using storage::ipld::Selector;
+
+  /// Failures are remembered per peer for this time
+  constexpr std::chrono::seconds kFetchNegativeTtl{5};
+  /// Shared request without response in time fails for all waiters
+  constexpr std::chrono::seconds kFetchTimeout{30};
+
+  template <typename K>
+  using PeerKey = std::pair<PeerId, K>;
+
+  template <typename K>
+  struct PeerKeyHash {
+    size_t operator()(const PeerKey<K> &key) const {
+      auto seed{std::hash<K>{}(key.second)};
+      boost::hash_combine(seed, std::hash<PeerId>{}(key.first));
+      return seed;
+    }
+  };
+
+  /**
+   * Shared front of blocksync and graphsync requests used by sync stages.
+   * Concurrent requests for same tipset key or root cid are coalesced into
+   * one network request to peer of first caller, all callers get its result.
+   * Failures are remembered per peer for kFetchNegativeTtl, repeated request
+   * to such peer fails without going to network.
+   * Methods are called on io thread, callbacks are called on it too.
+   */
+  struct Fetcher : public std::enable_shared_from_this<Fetcher> {
+    struct Stats {
+      /// Network requests
+      size_t requests{};
+      /// Requests joined to one in flight
+      size_t coalesced{};
+      /// Requests failed by negative cache
+      size_t negative{};
+    };
+
+    Fetcher(std::shared_ptr<Host> host,
+            IpldPtr ipld,
+            std::shared_ptr<Graphsync> graphsync = nullptr,
+            std::shared_ptr<boost::asio::io_context> io = nullptr);
+
+    /**
+     * Fetch headers of up to `depth` tipsets from `key` down with blocksync.
+     * Joined request gets chain of first one, which may be shorter.
+     */
+    void chain(const PeerId &peer,
+               const TipsetKey &key,
+               size_t depth,
+               CbT<std::vector<TipsetCPtr>> cb);
+
+    /**
+     * Fetch messages of `chain` (top down) with blocksync.
+     * Joined request with same top gets number of tipsets with messages
+     * limited by its chain size.
+     */
+    void messages(const PeerId &peer,
+                  std::vector<TipsetCPtr> chain,
+                  CbT<size_t> cb);
+
+    /**
+     * Fetch blocks below root with graphsync, blocks are stored by graphsync
+     * block sink. Requests for same root are expected to use same selector.
+     */
+    void dag(const PeerId &peer,
+             const CID &root,
+             const Selector &selector,
+             CbT<void> cb);
+
+    Stats stats;
+
+   private:
+    /// Fail from negative cache or join, returns true if request must start
+    template <typename K, typename T>
+    bool join(common::Inflight<K, T> &inflight,
+              common::NegativeCache<PeerKey<K>, PeerKeyHash<K>> &failed,
+              const PeerId &peer,
+              const K &key,
+              CbT<T> cb);
+    /// Wraps result handler of started request with timeout if io is set
+    template <typename T>
+    CbT<T> timed(CbT<T> cb);
+    /// Completes request, remembers failure of peer
+    template <typename K, typename T>
+    void done(common::Inflight<K, T> &inflight,
+              common::NegativeCache<PeerKey<K>, PeerKeyHash<K>> &failed,
+              const PeerId &peer,
+              const K &key,
+              const outcome::result<T> &result);
+
+    std::shared_ptr<Host> host;
+    IpldPtr ipld;
+    std::shared_ptr<Graphsync> graphsync;
+    std::shared_ptr<boost::asio::io_context> io;
+
+    common::Inflight<TipsetKey, std::vector<TipsetCPtr>> inflight_chains;
+    common::Inflight<TipsetKey, size_t> inflight_messages;
+    common::Inflight<CID, void> inflight_dags;
+    common::NegativeCache<PeerKey<TipsetKey>, PeerKeyHash<TipsetKey>>
+        failed_chains{kFetchNegativeTtl};
+    common::NegativeCache<PeerKey<TipsetKey>, PeerKeyHash<TipsetKey>>
+        failed_messages{kFetchNegativeTtl};
+    common::NegativeCache<PeerKey<CID>, PeerKeyHash<CID>> failed_dags{
+        kFetchNegativeTtl};
+  };
+}  // namespace fc::sync
@@ -10,6 +10,7 @@
 namespace boost {
   namespace asio {
     class io_context;
+    class thread_pool;
   }  // namespace asio
 }  // namespace boost
 
@@ -76,6 +77,10 @@ namespace fc {
     }    // namespace storage
   }      // namespace markets
 
+  namespace peermgr {
+    struct PeerScores;
+  }  // namespace peermgr
+
   namespace primitives {
     namespace address {
       struct Address;
@@ -87,6 +92,7 @@ namespace fc {
 
     namespace tipset {
       struct Tipset;
+      class TipsetCache;
     }  // namespace tipset
   }    // namespace primitives
 
@@ -99,6 +105,10 @@ namespace fc {
       class ChainStore;
     }  // namespace blockchain
 
+    namespace hamt {
+      class NodeCache;
+    }  // namespace hamt
+
     namespace ipfs {
       class IpfsDatastore;
 
@@ -123,6 +133,7 @@ namespace fc {
     }  // namespace message
 
     namespace runtime {
+      struct Env;
       struct Execution;
       struct MessageReceipt;
     }  // namespace runtime
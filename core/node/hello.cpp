@@ -7,6 +7,7 @@
 
 #include "common/libp2p/cbor_stream.hpp"
 #include "node/hello.hpp"
+#include "node/peer_scores.hpp"
 #include "storage/chain/chain_store.hpp"
 
 #define MOVE(x)  \
@@ -25,10 +26,13 @@ namespace fc::hello {
       : MOVE(host), chain_store{chain_store} {
     this->host->setProtocolHandler(
         kProtocolId,
-        [genesis{chain_store->genesisCID()}, MOVE(state_cb)](auto _stream) {
+        [this, genesis{chain_store->genesisCID()}, MOVE(state_cb)](
+            auto _stream) {
           auto stream{std::make_shared<CborStream>(_stream)};
-          stream->template read<State>([stream, MOVE(genesis), MOVE(state_cb)](
-                                           auto _state) {
+          stream->template read<State>([this,
+                                        stream,
+                                        MOVE(genesis),
+                                        MOVE(state_cb)](auto _state) {
             if (_state) {
               auto &state{_state.value()};
               if (auto _peer{stream->stream()->remotePeerId()}) {
@@ -40,6 +44,9 @@ namespace fc::hello {
                   return stream->stream()->reset();
                 }
                 stream->write(Latency{}, [stream](auto) { stream->close(); });
+                if (scores) {
+                  scores->onWeight(peer, state.weight);
+                }
                 state_cb(std::move(peer), std::move(state));
               } else {
                 stream->stream()->reset();
@@ -55,16 +62,28 @@ namespace fc::hello {
                 ts->height(),
                 chain_store->getHeaviestWeight(),
                 chain_store->genesisCID()};
-    host->newStream(peer, kProtocolId, [MOVE(hello)](auto _stream) {
-      if (_stream) {
-        auto stream{std::make_shared<CborStream>(_stream.value())};
-        stream->write(hello, [stream](auto _n) {
-          if (!_n) {
-            return stream->close();
+    host->newStream(
+        peer, kProtocolId, [MOVE(hello), id{peer.id}, scores{scores}](
+                               auto _stream) {
+          if (_stream) {
+            auto stream{std::make_shared<CborStream>(_stream.value())};
+            auto start{std::chrono::steady_clock::now()};
+            stream->write(hello, [stream, start, id, scores](auto _n) {
+              if (!_n) {
+                return stream->close();
+              }
+              stream->template read<Latency>(
+                  [stream, start, id, scores](auto _latency) {
+                    stream->close();
+                    if (_latency && scores) {
+                      scores->onRtt(id,
+                                    std::chrono::duration_cast<peermgr::Millis>(
+                                        std::chrono::steady_clock::now()
+                                        - start));
+                    }
+                  });
+            });
           }
-          stream->template read<Latency>([stream](auto) { stream->close(); });
         });
-      }
-    });
   }
 }  // namespace fc::hello
@@ -37,6 +37,8 @@ namespace fc::hello {
 
     std::shared_ptr<Host> host;
     std::shared_ptr<ChainStore> chain_store;
+    /// Gets peer weights and hello round trip times if set
+    std::shared_ptr<peermgr::PeerScores> scores;
   };
   CBOR_TUPLE(Hello::State, blocks, height, weight, genesis)
   CBOR_TUPLE(Hello::Latency, arrival, sent)
@@ -3,16 +3,24 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <boost/asio/steady_timer.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 
 #include "api/make.hpp"
 #include "clock/impl/utc_clock_impl.hpp"
+#include "common/logger.hpp"
+#include "common/memory_budget.hpp"
+#include "node/runtime.hpp"
+#include "node/startup.hpp"
 
 namespace fc {
   struct Config {
     boost::filesystem::path repo_path;
     int p2p_port, api_port;
+    /// Memory of caches in MiB, 0 means quarter of cgroup limit if any
+    size_t cache_mib;
+    node::RuntimeConfig runtime;
 
     auto join(const std::string &path) const {
       return (repo_path / path).string();
@@ -28,6 +36,23 @@ namespace fc {
     option("repo", po::value(&repo_path)->required());
     option("p2p_port", po::value(&config.p2p_port)->default_value(3020));
     option("api_port", po::value(&config.api_port)->default_value(3021));
+    option("cache_mib", po::value(&config.cache_mib)->default_value(0));
+    auto &runtime{config.runtime};
+    option("network_threads",
+           po::value(&runtime.network_threads)
+               ->default_value(runtime.network_threads));
+    option("vm_threads",
+           po::value(&runtime.vm_threads)->default_value(runtime.vm_threads));
+    option("rpc_threads",
+           po::value(&runtime.rpc_threads)->default_value(runtime.rpc_threads));
+    option(
+        "disk_threads",
+        po::value(&runtime.disk_threads)->default_value(runtime.disk_threads));
+    std::string network_cpus, vm_cpus, rpc_cpus, disk_cpus;
+    option("network_cpus", po::value(&network_cpus));
+    option("vm_cpus", po::value(&vm_cpus));
+    option("rpc_cpus", po::value(&rpc_cpus));
+    option("disk_cpus", po::value(&disk_cpus));
     po::variables_map vm;
     po::store(parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
@@ -38,21 +63,63 @@ namespace fc {
       po::store(po::parse_config_file(config_file, desc), vm);
       po::notify(vm);
     }
+    OUTCOME_TRYA(runtime.network_cpus, node::parseCpus(network_cpus));
+    OUTCOME_TRYA(runtime.vm_cpus, node::parseCpus(vm_cpus));
+    OUTCOME_TRYA(runtime.rpc_cpus, node::parseCpus(rpc_cpus));
+    OUTCOME_TRYA(runtime.disk_cpus, node::parseCpus(disk_cpus));
     return config;
   }
 
+  constexpr auto kMemoryCheckInterval{std::chrono::seconds{10}};
+
+  /// Checks memory pressure of caches periodically
+  void checkMemory(boost::asio::steady_timer &timer) {
+    common::MemoryBudget::instance().checkPressure();
+    timer.expires_after(kMemoryCheckInterval);
+    timer.async_wait([&timer](auto ec) {
+      if (!ec) {
+        checkMemory(timer);
+      }
+    });
+  }
+
   outcome::result<void> main(Config &config) {
+    node::Startup startup;
     auto clock{std::make_shared<clock::UTCClockImpl>()};
+    node::Runtime runtime{config.runtime};
+    OUTCOME_TRY(startup.run("runtime", [&]() -> outcome::result<void> {
+      runtime.start();
+      return outcome::success();
+    }));
+
+    auto &budget{common::MemoryBudget::instance()};
+    if (config.cache_mib != 0) {
+      budget.setLimit(config.cache_mib << 20);
+    } else if (auto limit{common::MemoryBudget::cgroupLimit()}) {
+      budget.setLimit(*limit / 4);
+    }
+    boost::asio::steady_timer memory_timer{*runtime.network};
+    checkMemory(memory_timer);
 
     OUTCOME_TRY(p2p_listen,
                 Multiaddress::create(
                     fmt::format("/ip4/127.0.0.1/tcp/{}", config.p2p_port)));
 
-    // TODO: hostname, listen 0.0.0.0
-    std::ofstream{config.join("api")}
-        << fmt::format("/ip4/127.0.0.1/tcp/{}/http", config.api_port);
-    std::ofstream{config.join("token")} << "token";
+    // independent subsystems are initialized concurrently
+    OUTCOME_TRY(startup.parallel(
+        *runtime.disk,
+        {{"api info",
+          [&]() -> outcome::result<void> {
+            // TODO: hostname, listen 0.0.0.0
+            std::ofstream{config.join("api")}
+                << fmt::format("/ip4/127.0.0.1/tcp/{}/http", config.api_port);
+            std::ofstream{config.join("token")} << "token";
+            return outcome::success();
+          }}}));
 
+    startup.log();
+    spdlog::info("fuhon node started");
+    runtime.wait();
     return outcome::success();
   }
 }  // namespace fc
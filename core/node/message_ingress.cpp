@@ -0,0 +1,213 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/message_ingress.hpp"
+
+#include <atomic>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include "crypto/blake2/blake2b160.hpp"
+
+namespace fc::pubsub {
+  using primitives::address::BLSPublicKeyHash;
+  using primitives::address::Protocol;
+  using BlsSignature = crypto::bls::Signature;
+  using SecpSignature = crypto::secp256k1::Signature;
+
+  /// Messages being verified, shared by pool tasks
+  struct Batch {
+    std::vector<EncodedMessage> messages;
+    std::vector<Address> keys;
+    /// Each element is written by one task only
+    std::vector<char> valid;
+    std::vector<size_t> bls, secp;
+    std::atomic<size_t> tasks{};
+  };
+
+  bool verifySecp(Secp256k1ProviderDefault &secp,
+                  const EncodedMessage &message,
+                  const Address &key) {
+    auto cid_bytes{message.unsigned_cid.toBytes()};
+    if (!cid_bytes) {
+      return false;
+    }
+    auto public_key{secp.recoverPublicKey(
+        crypto::blake2b::blake2b_256(cid_bytes.value()),
+        boost::get<SecpSignature>(message.message.signature))};
+    return public_key && key.verifySyntax(public_key.value());
+  }
+
+  bool verifyBls(BlsProvider &bls,
+                 const EncodedMessage &message,
+                 const Address &key) {
+    auto cid_bytes{message.unsigned_cid.toBytes()};
+    if (!cid_bytes) {
+      return false;
+    }
+    auto &hash{boost::get<BLSPublicKeyHash>(key.data)};
+    crypto::bls::PublicKey public_key;
+    std::copy_n(hash.begin(), public_key.size(), public_key.begin());
+    auto valid{bls.verifySignature(
+        cid_bytes.value(),
+        boost::get<BlsSignature>(message.message.signature),
+        public_key)};
+    return valid && valid.value();
+  }
+
+  MessageIngress::MessageIngress(Config config,
+                                 std::shared_ptr<boost::asio::io_context> io,
+                                 std::shared_ptr<boost::asio::thread_pool> pool,
+                                 std::shared_ptr<BlsProvider> bls,
+                                 std::shared_ptr<Secp256k1ProviderDefault> secp,
+                                 OnMessage on_message,
+                                 Resolve resolve)
+      : config{config},
+        io{std::move(io)},
+        pool{std::move(pool)},
+        bls{std::move(bls)},
+        secp{std::move(secp)},
+        on_message{std::move(on_message)},
+        resolve{std::move(resolve)},
+        seen{config.seen},
+        timer{*this->io} {}
+
+  void MessageIngress::push(SignedMessage &&message) {
+    auto encoded{EncodedMessage::make(std::move(message))};
+    if (!encoded) {
+      ++stats.received;
+      ++stats.invalid;
+      return;
+    }
+    push(std::move(encoded.value()));
+  }
+
+  void MessageIngress::push(EncodedMessage &&message) {
+    ++stats.received;
+    auto &cid{message.cid()};
+    if (seen.contains(cid)) {
+      ++stats.duplicate;
+      return;
+    }
+    seen.put(cid, true, 1);
+    queue.push_back(std::move(message));
+    if (queue.size() >= config.max_batch) {
+      flush();
+      return;
+    }
+    if (!timer_armed) {
+      timer_armed = true;
+      timer.expires_after(config.window);
+      timer.async_wait([weak{weak_from_this()}](auto ec) {
+        if (ec) {
+          return;
+        }
+        if (auto self{weak.lock()}) {
+          self->timer_armed = false;
+          self->flush();
+        }
+      });
+    }
+  }
+
+  void MessageIngress::flush() {
+    if (timer_armed) {
+      timer_armed = false;
+      timer.cancel();
+    }
+    if (queue.empty()) {
+      return;
+    }
+    ++stats.batches;
+    auto batch{std::make_shared<Batch>()};
+    batch->messages = std::move(queue);
+    queue.clear();
+    auto size{batch->messages.size()};
+    batch->keys.resize(size);
+    batch->valid.resize(size, false);
+    // resolved on io thread, state is not shared with pool
+    for (auto i{0u}; i < size; ++i) {
+      auto &message{batch->messages[i]};
+      auto &key{batch->keys[i]};
+      key = message.message.message.from;
+      if (!key.isKeyType()) {
+        if (!resolve) {
+          continue;
+        }
+        auto _key{resolve(key)};
+        if (!_key) {
+          continue;
+        }
+        key = std::move(_key.value());
+      }
+      if (message.message.signature.isBls()) {
+        if (key.getProtocol() == Protocol::BLS) {
+          batch->bls.push_back(i);
+        }
+      } else if (key.getProtocol() == Protocol::SECP256K1) {
+        batch->secp.push_back(i);
+      }
+    }
+
+    auto deliver{[weak{weak_from_this()}, batch] {
+      if (auto self{weak.lock()}) {
+        for (auto i{0u}; i < batch->messages.size(); ++i) {
+          if (batch->valid[i]) {
+            ++self->stats.valid;
+            self->on_message(std::move(batch->messages[i]));
+          } else {
+            ++self->stats.invalid;
+          }
+        }
+      }
+    }};
+    auto chunk{std::max<size_t>(1, config.chunk)};
+    auto verify_secp{[secp{secp}, batch](size_t begin, size_t end) {
+      for (auto j{begin}; j < end; ++j) {
+        auto i{batch->secp[j]};
+        batch->valid[i] =
+            verifySecp(*secp, batch->messages[i], batch->keys[i]);
+      }
+    }};
+    auto verify_bls{[bls{bls}, batch](size_t begin, size_t end) {
+      for (auto j{begin}; j < end; ++j) {
+        auto i{batch->bls[j]};
+        batch->valid[i] = verifyBls(*bls, batch->messages[i], batch->keys[i]);
+      }
+    }};
+    if (!pool) {
+      verify_bls(0, batch->bls.size());
+      verify_secp(0, batch->secp.size());
+      deliver();
+      return;
+    }
+    auto tasks{[&](size_t size) { return (size + chunk - 1) / chunk; }};
+    batch->tasks = tasks(batch->bls.size()) + tasks(batch->secp.size());
+    if (batch->tasks == 0) {
+      deliver();
+      return;
+    }
+    auto done{[io{io}, batch, deliver] {
+      if (--batch->tasks == 0) {
+        boost::asio::post(*io, deliver);
+      }
+    }};
+    for (size_t begin{0}; begin < batch->bls.size(); begin += chunk) {
+      auto end{std::min(begin + chunk, batch->bls.size())};
+      boost::asio::post(*pool, [verify_bls, done, begin, end] {
+        verify_bls(begin, end);
+        done();
+      });
+    }
+    for (size_t begin{0}; begin < batch->secp.size(); begin += chunk) {
+      auto end{std::min(begin + chunk, batch->secp.size())};
+      boost::asio::post(*pool, [verify_secp, done, begin, end] {
+        verify_secp(begin, end);
+        done();
+      });
+    }
+  }
+}  // namespace fc::pubsub
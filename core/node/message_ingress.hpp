@@ -0,0 +1,84 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+
+#include "common/lru_cache.hpp"
+#include "crypto/bls/bls_provider.hpp"
+#include "crypto/secp256k1/secp256k1_provider.hpp"
+#include "node/fwd.hpp"
+#include "vm/message/encoded_message.hpp"
+
+namespace fc::pubsub {
+  using crypto::bls::BlsProvider;
+  using crypto::secp256k1::Secp256k1ProviderDefault;
+  using primitives::address::Address;
+  using vm::message::EncodedMessage;
+  using vm::message::SignedMessage;
+
+  /**
+   * Collects gossiped messages for short window and verifies signatures of
+   * batch on thread pool in parallel chunks. Bls signatures are checked one
+   * by one, not as aggregate, because invalid signatures could cancel each
+   * other in sum. Duplicates are dropped by cid before verification.
+   * Valid messages are delivered on io thread in arrival order, with
+   * encodings and cids computed once on push.
+   * Methods must be called on io thread.
+   */
+  struct MessageIngress : std::enable_shared_from_this<MessageIngress> {
+    using OnMessage = std::function<void(EncodedMessage &&)>;
+    /// Resolves id address of sender to key address, e.g. from head state
+    using Resolve = std::function<outcome::result<Address>(const Address &)>;
+
+    struct Config {
+      std::chrono::milliseconds window{50};
+      /// Batch is verified without waiting for window end
+      size_t max_batch{1024};
+      /// Messages verified by one pool task
+      size_t chunk{64};
+      /// Recent message cids remembered to drop duplicates
+      size_t seen{16384};
+    };
+
+    struct Stats {
+      size_t received{};
+      size_t duplicate{};
+      size_t valid{};
+      size_t invalid{};
+      size_t batches{};
+    };
+
+    MessageIngress(Config config,
+                   std::shared_ptr<boost::asio::io_context> io,
+                   std::shared_ptr<boost::asio::thread_pool> pool,
+                   std::shared_ptr<BlsProvider> bls,
+                   std::shared_ptr<Secp256k1ProviderDefault> secp,
+                   OnMessage on_message,
+                   Resolve resolve = {});
+
+    /// Queue message for verification, used as PubSub on_message
+    void push(SignedMessage &&message);
+    /// Queue message decoded from gossip with its encoding
+    void push(EncodedMessage &&message);
+    /// Verify queued messages now
+    void flush();
+
+    Config config;
+    std::shared_ptr<boost::asio::io_context> io;
+    std::shared_ptr<boost::asio::thread_pool> pool;
+    std::shared_ptr<BlsProvider> bls;
+    std::shared_ptr<Secp256k1ProviderDefault> secp;
+    OnMessage on_message;
+    Resolve resolve;
+    common::LruCache<CID, bool> seen;
+    std::vector<EncodedMessage> queue;
+    boost::asio::steady_timer timer;
+    bool timer_armed{};
+    Stats stats;
+  };
+}  // namespace fc::pubsub
@@ -0,0 +1,73 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/peer_scores.hpp"
+
+namespace fc::peermgr {
+  void smooth(double &value, double sample) {
+    value = value == 0 ? sample
+                       : value + PeerScores::kAlpha * (sample - value);
+  }
+
+  void PeerScores::onRtt(const PeerId &peer, Millis rtt) {
+    smooth(scores[peer].rtt_ms, rtt.count());
+  }
+
+  void PeerScores::onWeight(const PeerId &peer, const BigInt &weight) {
+    scores[peer].weight = weight;
+  }
+
+  void PeerScores::onRequest(const PeerId &peer,
+                             Millis time,
+                             size_t tipsets,
+                             bool error,
+                             bool timeout) {
+    auto &score{scores[peer]};
+    ++score.requests;
+    if (timeout) {
+      ++score.timeouts;
+      return;
+    }
+    if (error) {
+      ++score.errors;
+      return;
+    }
+    smooth(score.tipsets_per_s,
+           1000.0 * tipsets / std::max<int64_t>(time.count(), 1));
+  }
+
+  void PeerScores::remove(const PeerId &peer) {
+    scores.erase(peer);
+  }
+
+  double PeerScores::cost(const PeerId &peer) const {
+    auto it{scores.find(peer)};
+    if (it == scores.end() || it->second.requests == 0) {
+      return 0;
+    }
+    auto &score{it->second};
+    // time per tipset, failed requests are retried elsewhere
+    auto time{score.rtt_ms
+              + (score.tipsets_per_s > 0 ? 1000 / score.tipsets_per_s : 1000)};
+    auto failures{static_cast<double>(score.errors + score.timeouts)
+                  / score.requests};
+    return time * (1 + 4 * failures);
+  }
+
+  std::vector<PeerId> PeerScores::rank(std::vector<PeerId> peers) const {
+    std::stable_sort(peers.begin(), peers.end(), [&](auto &l, auto &r) {
+      auto cost_l{cost(l)}, cost_r{cost(r)};
+      if (cost_l != cost_r) {
+        return cost_l < cost_r;
+      }
+      auto weight{[&](auto &peer) {
+        auto it{scores.find(peer)};
+        return it == scores.end() ? BigInt{} : it->second.weight;
+      }};
+      return weight(l) > weight(r);
+    });
+    return peers;
+  }
+}  // namespace fc::peermgr
@@ -0,0 +1,60 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <unordered_map>
+
+#include <libp2p/peer/peer_id.hpp>
+
+#include "primitives/big_int.hpp"
+
+namespace fc::peermgr {
+  using libp2p::peer::PeerId;
+  using primitives::BigInt;
+  using Millis = std::chrono::milliseconds;
+
+  /**
+   * Performance table of peers, updated by hello (rtt, weight) and by
+   * blocksync callers (throughput, errors), used to try fast peers first.
+   * Used from io thread only.
+   */
+  struct PeerScores {
+    struct Score {
+      /// Smoothed round trip time
+      double rtt_ms{};
+      /// Smoothed blocksync throughput
+      double tipsets_per_s{};
+      size_t requests{};
+      size_t errors{};
+      size_t timeouts{};
+      /// Heaviest weight advertised by hello
+      BigInt weight;
+    };
+
+    /// Weight of new sample in smoothed values
+    static constexpr double kAlpha{0.25};
+
+    void onRtt(const PeerId &peer, Millis rtt);
+    void onWeight(const PeerId &peer, const BigInt &weight);
+    /// Record finished request for tipsets
+    void onRequest(const PeerId &peer,
+                   Millis time,
+                   size_t tipsets,
+                   bool error,
+                   bool timeout = false);
+    void remove(const PeerId &peer);
+    /**
+     * Expected cost of request to peer, lower is better.
+     * Unknown peers have zero cost, so they are tried and get measured.
+     */
+    double cost(const PeerId &peer) const;
+    /// Order peers from best to worst
+    std::vector<PeerId> rank(std::vector<PeerId> peers) const;
+
+    std::unordered_map<PeerId, Score> scores;
+  };
+}  // namespace fc::peermgr
@@ -9,6 +9,7 @@
 #include <libp2p/protocol/identify/identify_push.hpp>
 
 #include "node/hello.hpp"
+#include "node/peer_scores.hpp"
 #include "node/peermgr.hpp"
 
 #define MOVE(x)  \
@@ -21,7 +22,9 @@ namespace fc::peermgr {
                    std::shared_ptr<Identify> identify,
                    std::shared_ptr<IdentifyPush> identify_push,
                    std::shared_ptr<IdentifyDelta> identify_delta,
-                   std::shared_ptr<Hello> hello) {
+                   std::shared_ptr<Hello> hello)
+      : scores{std::make_shared<PeerScores>()} {
+    hello->scores = scores;
     auto handle{[&](auto &protocol) {
       protocol->start();
       host->setProtocolHandler(
@@ -24,5 +24,7 @@ namespace fc::peermgr {
             std::shared_ptr<Hello> hello);
 
     boost::signals2::connection identify_sub;
+    /// Shared with hello, sync uses it to rank peers
+    std::shared_ptr<PeerScores> scores;
   };
 }  // namespace fc::peermgr
@@ -11,15 +11,25 @@
 #include "vm/message/message.hpp"
 
 namespace fc::pubsub {
-  std::shared_ptr<PubSub> PubSub::make(const std::string &network,
-                                       std::shared_ptr<Gossip> gossip,
-                                       OnBlock on_block,
-                                       OnMessage on_message) {
+  std::shared_ptr<PubSub> PubSub::make(
+      const std::string &network,
+      std::shared_ptr<Gossip> gossip,
+      OnBlock on_block,
+      OnMessage on_message,
+      std::shared_ptr<BlockFilter> block_filter) {
     auto self{std::make_shared<PubSub>()};
     self->on_block = std::move(on_block);
     self->on_message = std::move(on_message);
     self->blocks_topic = "/fil/blocks/" + network;
     self->messages_topic = "/fil/msgs/" + network;
+    if (block_filter) {
+      // rejected blocks are not forwarded and don't reach on_block
+      gossip->setValidator(self->blocks_topic,
+                           [block_filter](auto &from, auto &data) {
+                             return block_filter->validate(from, data);
+                           });
+    }
+    self->block_filter = std::move(block_filter);
     self->blocks_sub =
         gossip->subscribe({self->blocks_topic}, [self](auto message) {
           if (message) {
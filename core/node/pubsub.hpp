@@ -9,6 +9,7 @@
 #include <string>
 
 #include "common/outcome.hpp"
+#include "node/block_filter.hpp"
 #include "node/fwd.hpp"
 
 namespace fc::pubsub {
@@ -22,10 +23,13 @@ namespace fc::pubsub {
     using OnBlock = std::function<void(PeerId &&, BlockWithCids &&)>;
     using OnMessage = std::function<void(SignedMessage &&)>;
 
-    static std::shared_ptr<PubSub> make(const std::string &network,
-                                        std::shared_ptr<Gossip> gossip,
-                                        OnBlock on_block,
-                                        OnMessage on_message);
+    /// Blocks topic is validated with block_filter if set
+    static std::shared_ptr<PubSub> make(
+        const std::string &network,
+        std::shared_ptr<Gossip> gossip,
+        OnBlock on_block,
+        OnMessage on_message,
+        std::shared_ptr<BlockFilter> block_filter = nullptr);
     outcome::result<void> publish(const BlockWithCids &block);
     outcome::result<void> publish(const SignedMessage &message);
 
@@ -34,5 +38,6 @@ namespace fc::pubsub {
     std::string blocks_topic, messages_topic;
     Subscription blocks_sub, messages_sub;
     std::shared_ptr<Gossip> gossip;
+    std::shared_ptr<BlockFilter> block_filter;
   };
 }  // namespace fc::pubsub
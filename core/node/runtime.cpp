@@ -0,0 +1,152 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/runtime.hpp"
+
+#include <pthread.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <condition_variable>
+
+#include "common/profiler.hpp"
+
+namespace fc::node {
+  namespace {
+    size_t atLeastOne(size_t threads) {
+      return std::max<size_t>(threads, 1);
+    }
+
+    /// Name current thread and restrict it to cpus if cpus are not empty
+    void setupThread(const std::string &name, const std::vector<int> &cpus) {
+      common::profiler::setThreadName(name);
+#if __linux__
+      if (cpus.empty()) {
+        return;
+      }
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (auto cpu : cpus) {
+        CPU_SET(cpu, &set);
+      }
+      pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+    }
+
+    /**
+     * Pool threads are owned by pool, so each of them is set up by task
+     * which waits until all threads run such task.
+     */
+    void setupPool(thread_pool &pool,
+                   size_t threads,
+                   const std::string &name,
+                   const std::vector<int> &cpus) {
+      std::mutex mutex;
+      std::condition_variable cv;
+      size_t pinned{0};
+      for (size_t i{0}; i < threads; ++i) {
+        boost::asio::post(pool, [&] {
+          setupThread(name, cpus);
+          std::unique_lock lock{mutex};
+          ++pinned;
+          cv.notify_all();
+          cv.wait(lock, [&] { return pinned == threads; });
+        });
+      }
+      std::unique_lock lock{mutex};
+      cv.wait(lock, [&] { return pinned == threads; });
+    }
+  }  // namespace
+
+  outcome::result<std::vector<int>> parseCpus(const std::string &str) {
+    std::vector<int> cpus;
+    std::vector<std::string> items;
+    boost::split(items, str, boost::is_any_of(","));
+    try {
+      for (auto &item : items) {
+        boost::trim(item);
+        if (item.empty()) {
+          continue;
+        }
+        auto dash{item.find('-')};
+        auto first{std::stoi(item.substr(0, dash))};
+        auto last{dash == std::string::npos ? first
+                                            : std::stoi(item.substr(dash + 1))};
+        if (first < 0 || last < first) {
+          return std::errc::invalid_argument;
+        }
+        for (auto cpu{first}; cpu <= last; ++cpu) {
+          cpus.push_back(cpu);
+        }
+      }
+    } catch (std::logic_error &) {
+      return std::errc::invalid_argument;
+    }
+    return cpus;
+  }
+
+  Runtime::Runtime(RuntimeConfig config)
+      : network{std::make_shared<io_context>(config.network_threads)},
+        rpc{std::make_shared<io_context>(config.rpc_threads)},
+        vm{std::make_shared<thread_pool>(atLeastOne(config.vm_threads))},
+        disk{std::make_shared<thread_pool>(atLeastOne(config.disk_threads))},
+        config_{std::move(config)} {}
+
+  Runtime::~Runtime() {
+    stop();
+  }
+
+  void Runtime::start() {
+    runThreads(
+        network, config_.network_threads, "fc-net", config_.network_cpus);
+    runThreads(rpc, config_.rpc_threads, "fc-rpc", config_.rpc_cpus);
+    setupPool(*vm, atLeastOne(config_.vm_threads), "fc-vm", config_.vm_cpus);
+    setupPool(
+        *disk, atLeastOne(config_.disk_threads), "fc-disk", config_.disk_cpus);
+  }
+
+  void Runtime::wait() {
+    io_context signals_io;
+    boost::asio::signal_set signals{signals_io, SIGINT, SIGTERM};
+    signals.async_wait([](auto &&...) {});
+    signals_io.run();
+    stop();
+  }
+
+  void Runtime::stop() {
+    guards_.clear();
+    network->stop();
+    rpc->stop();
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+    threads_.clear();
+    vm->stop();
+    disk->stop();
+    vm->join();
+    disk->join();
+  }
+
+  Runtime::Strand Runtime::networkStrand() const {
+    return boost::asio::make_strand(*network);
+  }
+
+  Runtime::Strand Runtime::rpcStrand() const {
+    return boost::asio::make_strand(*rpc);
+  }
+
+  void Runtime::runThreads(const std::shared_ptr<io_context> &io,
+                           size_t threads,
+                           const std::string &name,
+                           const std::vector<int> &cpus) {
+    guards_.emplace_back(io->get_executor());
+    for (size_t i{0}; i < atLeastOne(threads); ++i) {
+      threads_.emplace_back([io, name, cpus] {
+        setupThread(name, cpus);
+        io->run();
+      });
+    }
+  }
+}  // namespace fc::node
@@ -0,0 +1,84 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <thread>
+#include <vector>
+
+#include "common/outcome.hpp"
+
+namespace fc::node {
+  using boost::asio::io_context;
+  using boost::asio::thread_pool;
+
+  /// Thread counts and cpu affinity of node subsystems
+  struct RuntimeConfig {
+    size_t network_threads{1};
+    size_t vm_threads{std::max(1u, std::thread::hardware_concurrency() / 2)};
+    size_t rpc_threads{2};
+    size_t disk_threads{2};
+    /// Cpus threads of subsystem are pinned to, empty means no pinning
+    std::vector<int> network_cpus, vm_cpus, rpc_cpus, disk_cpus;
+  };
+
+  /**
+   * Parse cpu list like "0-3,8,10-11"
+   */
+  outcome::result<std::vector<int>> parseCpus(const std::string &str);
+
+  /**
+   * Executors of node subsystems.
+   * Networking (libp2p host, pubsub, sync, graphsync) and rpc connections run
+   * on own io_context each, served by several threads. Components that are
+   * not thread-safe must be bound to strand of their io_context.
+   * Interpretation and disk work run on thread pools, so long jobs don't
+   * delay network and rpc handlers.
+   */
+  class Runtime {
+   public:
+    using Strand = boost::asio::strand<io_context::executor_type>;
+
+    explicit Runtime(RuntimeConfig config);
+    Runtime(const Runtime &) = delete;
+    Runtime &operator=(const Runtime &) = delete;
+    ~Runtime();
+
+    /// Run io_context threads, name and pin threads of executors
+    void start();
+
+    /// Block until SIGINT or SIGTERM, then stop
+    void wait();
+
+    /// Stop executors and join threads
+    void stop();
+
+    /// Serializes handlers of component which is not thread-safe
+    Strand networkStrand() const;
+    Strand rpcStrand() const;
+
+    const std::shared_ptr<io_context> network;
+    const std::shared_ptr<io_context> rpc;
+    const std::shared_ptr<thread_pool> vm;
+    const std::shared_ptr<thread_pool> disk;
+
+   private:
+    using WorkGuard =
+        boost::asio::executor_work_guard<io_context::executor_type>;
+
+    void runThreads(const std::shared_ptr<io_context> &io,
+                    size_t threads,
+                    const std::string &name,
+                    const std::vector<int> &cpus);
+
+    RuntimeConfig config_;
+    std::vector<WorkGuard> guards_;
+    std::vector<std::thread> threads_;
+  };
+}  // namespace fc::node
@@ -0,0 +1,67 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/startup.hpp"
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <future>
+
+#include "common/logger.hpp"
+
+namespace fc::node {
+  using Millis = std::chrono::duration<double, std::milli>;
+
+  outcome::result<void> Startup::parallel(
+      boost::asio::thread_pool &pool,
+      const std::vector<std::pair<std::string, Phase>> &phases) {
+    std::vector<std::promise<outcome::result<void>>> results(phases.size());
+    for (size_t i{0}; i < phases.size(); ++i) {
+      boost::asio::post(pool, [&, i] {
+        results[i].set_value(run(phases[i].first, phases[i].second));
+      });
+    }
+    outcome::result<void> first{outcome::success()};
+    for (auto &result : results) {
+      auto _result{result.get_future().get()};
+      if (!_result && first) {
+        first = _result.error();
+      }
+    }
+    return first;
+  }
+
+  void Startup::log() const {
+    for (auto &record : timeline()) {
+      spdlog::info("startup {}: {:.1f}ms +{:.1f}ms{}",
+                   record.name,
+                   Millis{record.start}.count(),
+                   Millis{record.duration}.count(),
+                   record.ok ? "" : " failed");
+    }
+    spdlog::info("startup took {:.1f}ms",
+                 Millis{Clock::now() - begin_}.count());
+  }
+
+  std::vector<Startup::Record> Startup::timeline() const {
+    std::lock_guard lock{mutex_};
+    auto records{records_};
+    std::sort(records.begin(), records.end(), [](auto &l, auto &r) {
+      return l.start < r.start;
+    });
+    return records;
+  }
+
+  outcome::result<void> Startup::run(const std::string &name,
+                                     const Phase &phase) {
+    auto start{Clock::now()};
+    auto result{phase()};
+    auto end{Clock::now()};
+    std::lock_guard lock{mutex_};
+    records_.push_back(
+        {name, start - begin_, end - start, !result.has_error()});
+    return result;
+  }
+}  // namespace fc::node
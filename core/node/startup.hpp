@@ -0,0 +1,56 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/outcome.hpp"
+#include "node/fwd.hpp"
+
+namespace fc::node {
+  /**
+   * Runs startup phases and records their timeline.
+   * Independent phases may run in parallel on pool, e.g. loading chain head,
+   * restoring mpool snapshot and starting libp2p host.
+   */
+  class Startup {
+   public:
+    using Clock = std::chrono::steady_clock;
+    using Phase = std::function<outcome::result<void>()>;
+
+    struct Record {
+      std::string name;
+      /// Since startup began
+      Clock::duration start, duration;
+      bool ok;
+    };
+
+    /// Run phase on current thread
+    outcome::result<void> run(const std::string &name, const Phase &phase);
+
+    /**
+     * Run phases on pool concurrently and wait for all of them.
+     * @return first error in order of phases
+     */
+    outcome::result<void> parallel(
+        boost::asio::thread_pool &pool,
+        const std::vector<std::pair<std::string, Phase>> &phases);
+
+    /// Log phases in order of start
+    void log() const;
+
+    std::vector<Record> timeline() const;
+
+   private:
+    Clock::time_point begin_{Clock::now()};
+    mutable std::mutex mutex_;
+    std::vector<Record> records_;
+  };
+}  // namespace fc::node
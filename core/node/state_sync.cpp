@@ -0,0 +1,185 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/state_sync.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <unordered_set>
+
+#include "common/logger.hpp"
+#include "node/fetcher.hpp"
+#include "storage/ipld/selector.hpp"
+#include "storage/ipld/traverser.hpp"
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::sync, StateSyncError, e) {
+  using fc::sync::StateSyncError;
+  switch (e) {
+    case StateSyncError::kNoPeers:
+      return "StateSyncError::kNoPeers";
+    case StateSyncError::kIncomplete:
+      return "StateSyncError::kIncomplete";
+  }
+  return "StateSyncError::unknown";
+}
+
+namespace fc::sync {
+  using libp2p::multi::HashType;
+  using storage::ipfs::IpfsDatastoreError;
+  using storage::ipld::kAllSelector;
+  using storage::ipld::Selector;
+
+  /// Subtree requests in flight
+  constexpr size_t kStateSyncWindow{32};
+  /// Attempts of subtree with different peers
+  constexpr size_t kStateSyncAttempts{4};
+
+  /**
+   * Selector of root and two levels below it, so there are enough subtrees to
+   * split between peers
+   * {"R": {"l": {"depth": 2}, ":>": {"a": {">": {"@": {}}}}}}
+   */
+  static const Selector kTopSelector{
+      Buffer::fromHex(
+          "a16152a2616ca16564657074680262"
+          "3a3ea16161a1613ea16140a0")
+          .value()};
+
+  outcome::result<std::vector<CID>> missingBlocks(Ipld &ipld,
+                                                  const CID &root) {
+    std::vector<CID> missing;
+    std::vector<CID> queue{root};
+    std::unordered_set<CID> visited;
+    while (!queue.empty()) {
+      auto cid{std::move(queue.back())};
+      queue.pop_back();
+      if (cid.content_address.getType() == HashType::identity
+          || !visited.insert(cid).second) {
+        continue;
+      }
+      auto bytes{ipld.get(cid)};
+      if (!bytes) {
+        if (bytes.error() != IpfsDatastoreError::kNotFound) {
+          return bytes.error();
+        }
+        missing.push_back(std::move(cid));
+        continue;
+      }
+      OUTCOME_TRY(links,
+                  storage::ipld::traverser::blockLinks(cid, bytes.value()));
+      for (auto &link : links) {
+        queue.push_back(std::move(link));
+      }
+    }
+    return missing;
+  }
+
+  StateSync::StateSync(std::shared_ptr<Fetcher> fetcher,
+                       IpldPtr ipld,
+                       std::shared_ptr<boost::asio::io_context> io,
+                       std::shared_ptr<boost::asio::thread_pool> pool)
+      : fetcher{std::move(fetcher)},
+        ipld{std::move(ipld)},
+        io{std::move(io)},
+        pool{std::move(pool)} {}
+
+  void StateSync::fetch(const CID &root,
+                        std::vector<PeerId> peers,
+                        Callback cb) {
+    assert(!callback);
+    callback = std::move(cb);
+    if (peers.empty()) {
+      return finish(StateSyncError::kNoPeers);
+    }
+    this->peers = std::move(peers);
+    queue.push_back({root, 0, true});
+    next();
+  }
+
+  void StateSync::next() {
+    while (callback && active < kStateSyncWindow && !queue.empty()) {
+      auto subtree{std::move(queue.front())};
+      queue.pop_front();
+      request(std::move(subtree));
+    }
+    if (callback && active == 0 && queue.empty()) {
+      finish(outcome::success());
+    }
+  }
+
+  void StateSync::request(Subtree subtree) {
+    ++active;
+    auto &peer{peers[(requests++ + subtree.attempts) % peers.size()]};
+    auto &selector{subtree.top ? kTopSelector : kAllSelector};
+    fetcher->dag(peer,
+                 subtree.root,
+                 selector,
+                 [self{shared_from_this()}, subtree](auto) {
+                   // blocks of response are stored before terminal status, so
+                   // walk finds what was received
+                   --self->active;
+                   if (self->callback) {
+                     self->check(subtree);
+                   }
+                 });
+  }
+
+  void StateSync::check(Subtree subtree) {
+    ++active;
+    auto walk{[self{shared_from_this()}, subtree{std::move(subtree)}] {
+      auto missing{missingBlocks(*self->ipld, subtree.root)};
+      auto done{[self, subtree, missing{std::move(missing)}]() mutable {
+        self->onChecked(subtree, std::move(missing));
+      }};
+      if (self->io) {
+        boost::asio::post(*self->io, std::move(done));
+      } else {
+        done();
+      }
+    }};
+    if (pool && io) {
+      boost::asio::post(*pool, std::move(walk));
+    } else {
+      walk();
+    }
+  }
+
+  void StateSync::onChecked(const Subtree &subtree,
+                            outcome::result<std::vector<CID>> missing) {
+    --active;
+    if (!callback) {
+      return;
+    }
+    if (!missing) {
+      return finish(missing.error());
+    }
+    if (missing.value().empty()) {
+      ++done;
+    }
+    for (auto &cid : missing.value()) {
+      if (subtree.top && cid != subtree.root) {
+        // frontier of top levels
+        queue.push_back({std::move(cid), 0, false});
+        continue;
+      }
+      if (subtree.attempts + 1 == kStateSyncAttempts) {
+        spdlog::warn("StateSync: block {} not received from {} peers",
+                     cid.toString().value(),
+                     kStateSyncAttempts);
+        return finish(StateSyncError::kIncomplete);
+      }
+      queue.push_back({std::move(cid), subtree.attempts + 1, subtree.top});
+    }
+    next();
+  }
+
+  void StateSync::finish(outcome::result<void> result) {
+    queue.clear();
+    auto cb{std::move(callback)};
+    callback = nullptr;
+    cb(std::move(result));
+  }
+}  // namespace fc::sync
@@ -0,0 +1,86 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <deque>
+
+#include "common/outcome.hpp"
+#include "node/fwd.hpp"
+#include "primitives/cid/cid.hpp"
+
+namespace fc::sync {
+  enum class StateSyncError {
+    kNoPeers = 1,
+    kIncomplete,
+  };
+}  // namespace fc::sync
+
+OUTCOME_HPP_DECLARE_ERROR(fc::sync, StateSyncError);
+
+namespace fc::sync {
+  struct Fetcher;
+
+  using libp2p::peer::PeerId;
+
+  /**
+   * Fetches whole dag below root (e.g. parent state of trusted tipset) with
+   * graphsync requests of fetcher.
+   * Top levels are fetched with depth limited selector, then subtrees below
+   * them are fetched with "explore all" selector from several peers at once.
+   * Received blocks are stored by block sink of graphsync, their cids are
+   * computed from received bytes. Each finished subtree is walked locally,
+   * missing blocks are requested again from other peer.
+   * Methods are called on io, local walks run on pool if given.
+   */
+  struct StateSync : public std::enable_shared_from_this<StateSync> {
+    using Callback = std::function<void(outcome::result<void>)>;
+
+    StateSync(std::shared_ptr<Fetcher> fetcher,
+              IpldPtr ipld,
+              std::shared_ptr<boost::asio::io_context> io = nullptr,
+              std::shared_ptr<boost::asio::thread_pool> pool = nullptr);
+
+    /// Fetch dag below root from peers, callback is called once
+    void fetch(const CID &root, std::vector<PeerId> peers, Callback cb);
+
+    /// Subtrees fetched and verified
+    size_t done{};
+
+   private:
+    struct Subtree {
+      CID root;
+      size_t attempts{};
+      /// Fetched with depth limited selector, missing links become subtrees
+      bool top{};
+    };
+
+    /// Start requests up to window
+    void next();
+    void request(Subtree subtree);
+    /// Walk fetched subtree locally and queue missing blocks
+    void check(Subtree subtree);
+    void onChecked(const Subtree &subtree,
+                   outcome::result<std::vector<CID>> missing);
+    void finish(outcome::result<void> result);
+
+    std::shared_ptr<Fetcher> fetcher;
+    IpldPtr ipld;
+    std::shared_ptr<boost::asio::io_context> io;
+    std::shared_ptr<boost::asio::thread_pool> pool;
+    std::vector<PeerId> peers;
+    Callback callback;
+    std::deque<Subtree> queue;
+    /// Requests in flight and subtrees being walked
+    size_t active{};
+    size_t requests{};
+  };
+
+  /**
+   * Cids linked from block below root which are not stored, except identity
+   * cids which carry their content
+   */
+  outcome::result<std::vector<CID>> missingBlocks(Ipld &ipld, const CID &root);
+}  // namespace fc::sync
@@ -3,10 +3,17 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <libp2p/peer/peer_info.hpp>
 
 #include "blockchain/impl/weight_calculator_impl.hpp"
+#include "common/async.hpp"
 #include "node/blocksync.hpp"
+#include "node/fetcher.hpp"
+#include "node/peer_scores.hpp"
+#include "node/state_sync.hpp"
 #include "node/sync.hpp"
 #include "storage/chain/chain_store.hpp"
 #include "vm/interpreter/interpreter.hpp"
@@ -18,12 +25,81 @@
 
 namespace fc::sync {
   using primitives::block::MsgMeta;
-  using primitives::tipset::Tipset;
+
+  /// Headers fetched by one backfill request
+  constexpr size_t kSyncHeaders{500};
+  /// Tipsets with messages fetched by one request
+  constexpr size_t kSyncMessagesDepth{20};
+  /// Message requests in flight during backfill
+  constexpr size_t kSyncWindow{8};
+  /// Attempts of message request with different peers
+  constexpr size_t kSyncAttempts{3};
+  /// Tipsets validated at once
+  constexpr size_t kSyncValidating{64};
+  /// Blocksync request without response in time is dropped and retried
+  constexpr std::chrono::seconds kSyncTimeout{30};
+
+  /// Limits request time when io is available to run timer
+  template <typename T>
+  CbT<T> timed(const std::shared_ptr<boost::asio::io_context> &io,
+               CbT<T> cb) {
+    return io ? withTimeout(*io, kSyncTimeout, std::move(cb)) : std::move(cb);
+  }
+
+  template <typename T>
+  bool timedOut(const outcome::result<T> &result) {
+    return !result && result.error() == std::errc::timed_out;
+  }
+
+  bool haveMessages(Ipld &ipld, const Tipset &ts) {
+    for (auto &block : ts.blks) {
+      auto _have{ipld.contains(block.messages)};
+      if (!_have || !_have.value()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void SyncStage::push(size_t n) {
+    queued += n;
+    peak = std::max(peak, queued);
+  }
+
+  void SyncStage::pop(bool ok, size_t n) {
+    queued -= n;
+    (ok ? done : failed) += n;
+  }
+
+  struct TsSync::Backfill {
+    TipsetKey key;
+    PeerId peer;
+    /// Tipsets without messages, top down, split into ranges
+    std::vector<std::vector<TipsetCPtr>> ranges{};
+    std::vector<size_t> attempts{};
+    size_t next{}, fetched{};
+    /// Fetched tipsets waiting for validation slot
+    std::vector<TipsetCPtr> pending{};
+    size_t validating{}, validated{}, total{};
+    bool failed{};
+  };
 
   TsSync::TsSync(std::shared_ptr<Host> host,
                  IpldPtr ipld,
-                 std::shared_ptr<Interpreter> interpreter)
-      : MOVE(host), MOVE(ipld), MOVE(interpreter) {}
+                 std::shared_ptr<Interpreter> interpreter,
+                 Validator validator,
+                 std::shared_ptr<boost::asio::io_context> io,
+                 std::shared_ptr<boost::asio::thread_pool> pool)
+      : MOVE(host),
+        MOVE(ipld),
+        MOVE(interpreter),
+        MOVE(validator),
+        MOVE(io),
+        MOVE(pool),
+        fetcher{std::make_shared<Fetcher>(
+            this->host, this->ipld, nullptr, this->io)},
+        weighter{std::make_shared<blockchain::weight::WeightCalculatorImpl>(
+            this->ipld)} {}
 
   void TsSync::sync(const TipsetKey &key,
                     const PeerId &peer,
@@ -33,25 +109,35 @@ namespace fc::sync {
       return callback(key, _valid->second);
     }
     callbacks[key].push_back(std::move(callback));
+    if (std::find(peers.begin(), peers.end(), peer) == peers.end()) {
+      peers.push_back(peer);
+    }
     walkDown(key, peer);
   }
 
   void TsSync::walkDown(TipsetKey key, const PeerId &peer) {
     while (true) {
-      auto _ts{Tipset::load(*ipld, key.cids())};
+      auto _ts{tipset_cache->load(*ipld, key)};
       if (_ts) {
         auto &ts{_ts.value()};
-        auto have_messages{true};
-        for (auto &block : ts->blks) {
-          auto _have{ipld->contains(block.messages)};
-          if (!_have || !_have.value()) {
-            have_messages = false;
-            break;
-          }
-        }
-        if (have_messages) {
+        if (haveMessages(*ipld, *ts)) {
           auto parent{ts->getParents()};
-          children[parent].push_back(std::move(key));
+          children[parent].push_back(key);
+          auto _checked{checked.find(key)};
+          auto ok{_checked != checked.end() ? _checked->second
+                                             : !validator || validator(*ts)};
+          if (_checked != checked.end()) {
+            checked.erase(_checked);
+          }
+          if (!ok) {
+            // invalid tipset invalidates its children, parents are not needed
+            children.at(parent).pop_back();
+            if (children.at(parent).empty()) {
+              children.erase(parent);
+            }
+            valid.emplace(key, false);
+            return walkUp(std::move(key));
+          }
           if (children.at(parent).size() != 1) {
             return;
           }
@@ -62,16 +148,169 @@ namespace fc::sync {
           continue;
         }
       }
-      return blocksync::fetch(host,
-                              {peer, {}},
-                              ipld,
-                              key.cids(),
-                              [self{shared_from_this()}, key, peer](auto _ts) {
-                                // TODO: bad block vs network failure
-                                if (_ts) {
-                                  self->walkDown(std::move(key), peer);
-                                }
-                              });
+      return backfill(std::move(key), peer);
+    }
+  }
+
+  void TsSync::backfill(TipsetKey key, const PeerId &peer) {
+    metrics.headers.push();
+    fetcher->chain(
+        peer,
+        key,
+        kSyncHeaders,
+        timed<std::vector<TipsetCPtr>>(
+            io,
+            [self{shared_from_this()},
+             key,
+             peer,
+             start{std::chrono::steady_clock::now()}](auto _chain) {
+              self->metrics.headers.pop(_chain.has_value());
+              self->score(peer,
+                          start,
+                          _chain ? _chain.value().size() : 0,
+                          !_chain && !timedOut(_chain),
+                          timedOut(_chain));
+              // TODO: bad block vs network failure
+              if (!_chain) {
+                return;
+              }
+              auto backfill{std::make_shared<Backfill>(Backfill{key, peer})};
+              // split tipsets without messages into ranges of consecutive
+              // ones
+              for (auto &ts : _chain.value()) {
+                if (haveMessages(*self->ipld, *ts)) {
+                  break;
+                }
+                auto &ranges{backfill->ranges};
+                if (ranges.empty()
+                    || ranges.back().size() == kSyncMessagesDepth) {
+                  ranges.emplace_back();
+                }
+                ranges.back().push_back(ts);
+                ++backfill->total;
+              }
+              if (backfill->ranges.empty()) {
+                return self->walkDown(std::move(key), peer);
+              }
+              backfill->attempts.resize(backfill->ranges.size());
+              self->metrics.messages.push(backfill->total);
+              while (backfill->next
+                     < std::min(kSyncWindow, backfill->ranges.size())) {
+                self->fetchRange(backfill, backfill->next++);
+              }
+            }));
+  }
+
+  void TsSync::fetchRange(const BackfillPtr &backfill, size_t i) {
+    auto &range{backfill->ranges[i]};
+    auto from{backfill->peer};
+    if (!peers.empty()) {
+      // spread ranges over fastest peers, retry goes to next one
+      auto ranked{scores ? scores->rank(peers) : peers};
+      from = ranked[(i + backfill->attempts[i])
+                    % std::min(ranked.size(), kSyncWindow)];
+    }
+    fetcher->messages(
+        from,
+        range,
+        timed<size_t>(
+            io,
+            [self{shared_from_this()},
+             backfill,
+             i,
+             from,
+             start{std::chrono::steady_clock::now()}](auto _fetched) {
+              auto fetched{_fetched ? _fetched.value() : 0};
+              self->score(from,
+                          start,
+                          fetched,
+                          !_fetched && !timedOut(_fetched),
+                          timedOut(_fetched));
+              if (backfill->failed) {
+                return;
+              }
+              auto &range{backfill->ranges[i]};
+              self->metrics.messages.pop(true, fetched);
+              for (auto j{0u}; j < fetched; ++j) {
+                self->validate(backfill, range[j]);
+              }
+              range.erase(range.begin(), range.begin() + fetched);
+              if (!range.empty()) {
+                // retry rest of range with next peer
+                if (++backfill->attempts[i] == kSyncAttempts) {
+                  backfill->failed = true;
+                  self->metrics.messages.pop(false, range.size());
+                  return;
+                }
+                return self->fetchRange(backfill, i);
+              }
+              ++backfill->fetched;
+              if (backfill->next < backfill->ranges.size()) {
+                self->fetchRange(backfill, backfill->next++);
+              }
+            }));
+  }
+
+  void TsSync::score(const PeerId &peer,
+                     std::chrono::steady_clock::time_point start,
+                     size_t tipsets,
+                     bool error,
+                     bool timeout) {
+    if (scores) {
+      scores->onRequest(
+          peer,
+          std::chrono::duration_cast<peermgr::Millis>(
+              std::chrono::steady_clock::now() - start),
+          tipsets,
+          error,
+          timeout);
+    }
+  }
+
+  void TsSync::validate(const BackfillPtr &backfill, TipsetCPtr ts) {
+    if (!validator) {
+      ++backfill->validated;
+      return onValidated(backfill, ts->key, true);
+    }
+    if (backfill->validating >= kSyncValidating) {
+      backfill->pending.push_back(std::move(ts));
+      return;
+    }
+    ++backfill->validating;
+    metrics.validation.push();
+    auto check{[self{shared_from_this()}, backfill, ts] {
+      auto ok{self->validator(*ts).has_value()};
+      auto done{[self, backfill, ts, ok] {
+        --backfill->validating;
+        ++backfill->validated;
+        self->metrics.validation.pop(ok);
+        self->onValidated(backfill, ts->key, ok);
+        if (!backfill->pending.empty() && !backfill->failed) {
+          auto next{std::move(backfill->pending.back())};
+          backfill->pending.pop_back();
+          self->validate(backfill, std::move(next));
+        }
+      }};
+      if (self->io) {
+        boost::asio::post(*self->io, std::move(done));
+      } else {
+        done();
+      }
+    }};
+    if (pool && io) {
+      boost::asio::post(*pool, std::move(check));
+    } else {
+      check();
+    }
+  }
+
+  void TsSync::onValidated(const BackfillPtr &backfill,
+                           const TipsetKey &key,
+                           bool ok) {
+    checked[key] = ok;
+    if (!backfill->failed && backfill->validated == backfill->total) {
+      // all ranges are fetched and validated, walk them down in order
+      walkDown(backfill->key, backfill->peer);
     }
   }
 
@@ -91,23 +330,27 @@ namespace fc::sync {
       auto _children{children.find(key)};
       if (_children != children.end()) {
         if (_valid) {
-          OUTCOME_EXCEPT(ts, Tipset::load(*ipld, key.cids()));
-          blockchain::weight::WeightCalculatorImpl weighter{ipld};
-          OUTCOME_EXCEPT(weight, weighter.calculateWeight(*ts));
+          OUTCOME_EXCEPT(ts, tipset_cache->load(*ipld, key));
+          OUTCOME_EXCEPT(weight, weighter->calculateWeight(*ts));
           OUTCOME_EXCEPT(vm, interpreter->interpret(ipld, ts));
           for (auto &_child : _children->second) {
-            OUTCOME_EXCEPT(child, Tipset::load(*ipld, _child.cids()));
+            metrics.interpretation.push();
+            OUTCOME_EXCEPT(child, tipset_cache->load(*ipld, _child));
             auto child_valid{child->getParentStateRoot() == vm.state_root
                              && child->getParentMessageReceipts()
                                     == vm.message_receipts
                              && child->getParentWeight() == weight};
+            if (child_valid && consensus) {
+              child_valid = consensus(*child).has_value();
+            }
             if (child_valid) {
               auto _vm{interpreter->interpret(ipld, child)};
-              auto _weight{weighter.calculateWeight(*child)};
+              auto _weight{weighter->calculateWeight(*child)};
               if (!_vm || !_weight) {
                 child_valid = false;
               }
             }
+            metrics.interpretation.pop(child_valid);
             valid.emplace(_child, child_valid);
           }
         } else {
@@ -130,6 +373,57 @@ namespace fc::sync {
     this->ts_sync->valid.emplace(TipsetKey{{this->chain_store->genesisCID()}}, true);
   }
 
+  void Sync::fromCheckpoint(const TipsetKey &key,
+                            std::vector<PeerId> peers,
+                            std::shared_ptr<StateSync> state_sync,
+                            CheckpointCb cb) {
+    if (peers.empty()) {
+      return cb(StateSyncError::kNoPeers);
+    }
+    auto peer{peers[0]};
+    ts_sync->fetcher->chain(
+        peer,
+        key,
+        kSyncHeaders,
+        [self{shared_from_this()},
+         key,
+         peer,
+         MOVE(peers),
+         MOVE(state_sync),
+         MOVE(cb)](auto _chain) mutable {
+          if (!_chain) {
+            return cb(_chain.error());
+          }
+          auto &chain{_chain.value()};
+          if (chain.empty() || chain[0]->key != key) {
+            return cb(blocksync::Error::kInconsistent);
+          }
+          auto ts{chain[0]};
+          self->ts_sync->fetcher->messages(
+              peer,
+              {ts},
+              [self, key, ts, MOVE(peers), MOVE(state_sync), MOVE(cb)](
+                  auto _fetched) mutable {
+                if (!_fetched) {
+                  return cb(_fetched.error());
+                }
+                if (_fetched.value() != 1) {
+                  return cb(blocksync::Error::kPartial);
+                }
+                state_sync->fetch(
+                    ts->getParentStateRoot(),
+                    std::move(peers),
+                    [self, key, MOVE(cb)](auto _state) {
+                      if (!_state) {
+                        return cb(_state.error());
+                      }
+                      self->ts_sync->valid.emplace(key, true);
+                      cb(outcome::success());
+                    });
+              });
+        });
+  }
+
   void Sync::onHello(const TipsetKey &key, const PeerId &peer) {
     ts_sync->sync(key, peer, [self{shared_from_this()}](auto &key, auto valid) {
       if (valid) {
@@ -143,6 +437,8 @@ namespace fc::sync {
                                        const PeerId &peer) {
     OUTCOME_TRY(have_messages, ipld->contains(block.header.messages));
     if (!have_messages) {
+      // messages seen in gossip are already stored by mpool, so usually block
+      // is reconstructed locally
       MsgMeta messages;
       ipld->load(messages);
       auto collect_messages{
@@ -166,17 +462,28 @@ namespace fc::sync {
         if (messages_cid != block.header.messages) {
           return blocksync::Error::kInconsistent;
         }
+        have_messages = true;
       }
     }
     OUTCOME_TRY(cid, ts_sync->ipld->setCbor(block.header));
-    ts_sync->sync(TipsetKey{{cid}},
-                  peer,
-                  [self{shared_from_this()}, block{std::move(block.header)}](
-                      auto &, auto valid) {
-                    if (valid) {
-                      std::ignore = self->chain_store->addBlock(block);
-                    }
-                  });
+    auto sync{[self{shared_from_this()},
+               key{TipsetKey{{cid}}},
+               peer,
+               header{block.header}] {
+      self->ts_sync->sync(key, peer, [self, header](auto &, auto valid) {
+        if (valid) {
+          std::ignore = self->chain_store->addBlock(header);
+        }
+      });
+    }};
+    if (!have_messages) {
+      // header is known, fetch only messages of block instead of walking
+      // down with headers
+      OUTCOME_TRY(ts, Tipset::create({cid}, {block.header}));
+      ts_sync->fetcher->messages(peer, {ts}, [sync](auto) { sync(); });
+      return outcome::success();
+    }
+    sync();
     return outcome::success();
   }
 }  // namespace fc::sync
@@ -5,12 +5,18 @@
 
 #pragma once
 
+#include <chrono>
 #include <unordered_map>
 
+#include "blockchain/weight_calculator.hpp"
+#include "common/outcome.hpp"
 #include "node/fwd.hpp"
-#include "primitives/tipset/tipset_key.hpp"
+#include "primitives/tipset/tipset_cache.hpp"
 
 namespace fc::sync {
+  struct Fetcher;
+  struct StateSync;
+
   using libp2p::Host;
   using libp2p::peer::PeerId;
   using primitives::block::BlockWithCids;
@@ -18,30 +24,117 @@ namespace fc::sync {
   using storage::blockchain::ChainStore;
   using vm::interpreter::Interpreter;
 
+  using primitives::tipset::Tipset;
+  using primitives::tipset::TipsetCache;
+  using primitives::tipset::TipsetCPtr;
+
+  /// Counters of one sync stage
+  struct SyncStage {
+    /// Tipsets waiting or in progress, bounded by stage limit
+    size_t queued{};
+    /// Max tipsets queued at once
+    size_t peak{};
+    size_t done{};
+    size_t failed{};
+
+    void push(size_t n = 1);
+    void pop(bool ok, size_t n = 1);
+  };
+
+  struct SyncMetrics {
+    SyncStage headers, messages, validation, interpretation;
+  };
+
+  /**
+   * Syncs tipsets in stages:
+   * 1. headers of chain are fetched with cheap linkage checks,
+   * 2. messages of headers are fetched in ranges from several peers,
+   * 3. fetched tipsets are validated (syntax and signatures) on thread pool,
+   * 4. validated tipsets are interpreted in order from known one up, after
+   *    consensus check (e.g. tickets and election proofs, which need
+   *    lookback state).
+   * Stages 1-3 of one backfill overlap, every stage has bounded queue.
+   */
   struct TsSync : public std::enable_shared_from_this<TsSync> {
     using Callback = std::function<void(const TipsetKey &, bool)>;
+    /// Checks tipset before interpretation, e.g. message signatures
+    using Validator = std::function<outcome::result<void>(const Tipset &)>;
+    struct Backfill;
+    using BackfillPtr = std::shared_ptr<Backfill>;
 
     TsSync(std::shared_ptr<Host> host,
            IpldPtr ipld,
-           std::shared_ptr<Interpreter> interpreter);
+           std::shared_ptr<Interpreter> interpreter,
+           Validator validator = {},
+           std::shared_ptr<boost::asio::io_context> io = nullptr,
+           std::shared_ptr<boost::asio::thread_pool> pool = nullptr);
     void sync(const TipsetKey &key, const PeerId &peer, Callback callback);
     void walkDown(TipsetKey key, const PeerId &peer);
     void walkUp(TipsetKey key);
+    /**
+     * Fetch headers of up to kSyncHeaders tipsets below key from peer, then
+     * fetch their messages in ranges from known peers and validate them.
+     * Continues walkDown when all ranges are validated.
+     */
+    void backfill(TipsetKey key, const PeerId &peer);
+    /// Request messages of range, keeps kSyncWindow requests in flight
+    void fetchRange(const BackfillPtr &backfill, size_t i);
+    /// Validate fetched tipset on pool, result is handled on io
+    void validate(const BackfillPtr &backfill, TipsetCPtr ts);
+    void onValidated(const BackfillPtr &backfill,
+                     const TipsetKey &key,
+                     bool ok);
+    /// Record blocksync request result in scores
+    void score(const PeerId &peer,
+               std::chrono::steady_clock::time_point start,
+               size_t tipsets,
+               bool error,
+               bool timeout = false);
 
     std::shared_ptr<Host> host;
     IpldPtr ipld;
     std::shared_ptr<Interpreter> interpreter;
+    Validator validator;
+    /// Checks tipset when its parent is interpreted, e.g.
+    /// BlockValidatorImpl::validateTipsetVRFs
+    Validator consensus;
+    std::shared_ptr<boost::asio::io_context> io;
+    std::shared_ptr<boost::asio::thread_pool> pool;
+    /// Coalesces blocksync requests of stages and gossip
+    std::shared_ptr<Fetcher> fetcher;
+    std::shared_ptr<TipsetCache> tipset_cache{std::make_shared<TipsetCache>()};
+    /// Shared between walks so cached weights and power outlive one walk
+    std::shared_ptr<blockchain::weight::WeightCalculator> weighter;
     std::unordered_map<TipsetKey, std::vector<Callback>> callbacks;
     std::unordered_map<TipsetKey, std::vector<TipsetKey>> children;
+    /// Peers which announced tipsets, backfill splits requests among them
+    std::vector<PeerId> peers;
+    /// If set, peers are ranked to request from fast ones first
+    std::shared_ptr<peermgr::PeerScores> scores;
+    /// Results of validation stage, consumed by walkDown
+    std::unordered_map<TipsetKey, bool> checked;
+    SyncMetrics metrics;
 
     // TODO: component, persistent/caching
     std::unordered_map<TipsetKey, bool> valid;
   };
 
   struct Sync : public std::enable_shared_from_this<Sync> {
+    using CheckpointCb = std::function<void(outcome::result<void>)>;
+
     Sync(IpldPtr ipld,
          std::shared_ptr<TsSync> ts_sync,
          std::shared_ptr<ChainStore> chain_store);
+    /**
+     * Start from trusted tipset instead of genesis.
+     * Fetches headers below it (for randomness lookback), its messages and
+     * its parent state with `state_sync`, then marks it valid, so later
+     * syncs walk down to it and interpret only tipsets above it.
+     */
+    void fromCheckpoint(const TipsetKey &key,
+                        std::vector<PeerId> peers,
+                        std::shared_ptr<StateSync> state_sync,
+                        CheckpointCb cb);
     void onHello(const TipsetKey &key, const PeerId &peer);
     outcome::result<void> onGossip(const BlockWithCids &block,
                                    const PeerId &peer);
@@ -89,9 +89,9 @@ namespace fc::payment_channel_manager {
 
   outcome::result<TokenAmount> PaymentChannelManagerImpl::savePaymentVoucher(
       const Address &channel_address, const SignedVoucher &voucher) {
-    OUTCOME_TRY(validateVoucher(channel_address, voucher));
-    OUTCOME_TRY(payment_channel_actor_state,
-                loadPaymentChannelActorState(channel_address));
+    OUTCOME_TRY(channel, loadPaymentChannelActorState(channel_address));
+    OUTCOME_TRY(validateVoucher(channel, voucher));
+    auto &payment_channel_actor_state{channel.state};
     std::unique_lock lock(channels_mutex_);
 
     // add channel to local storage if hasn't been added yet
@@ -104,9 +104,9 @@ namespace fc::payment_channel_manager {
     }
 
     // insert if no duplicates
-    auto lanes = channel_lookup->second.lanes[voucher.lane];
+    auto &lanes = channel_lookup->second.lanes[voucher.lane];
     if (find(lanes.begin(), lanes.end(), voucher) == lanes.end()) {
-      channel_lookup->second.lanes[voucher.lane].push_back(voucher);
+      lanes.push_back(voucher);
     }
 
     // get redeemed
@@ -121,8 +121,13 @@ namespace fc::payment_channel_manager {
 
   outcome::result<void> PaymentChannelManagerImpl::validateVoucher(
       const Address &channel_address, const SignedVoucher &voucher) const {
-    OUTCOME_TRY(payment_channel_actor_state,
-                loadPaymentChannelActorState(channel_address));
+    OUTCOME_TRY(channel, loadPaymentChannelActorState(channel_address));
+    return validateVoucher(channel, voucher);
+  }
+
+  outcome::result<void> PaymentChannelManagerImpl::validateVoucher(
+      const ChannelStateCache &channel, const SignedVoucher &voucher) const {
+    auto payment_channel_actor_state{channel.state};
 
     // check signature
     if (!voucher.signature.has_value()) {
@@ -132,7 +137,7 @@ namespace fc::payment_channel_manager {
     voucher_to_verify.signature = boost::none;
     OUTCOME_TRY(bytes_to_verify, codec::cbor::encode(voucher_to_verify));
     OUTCOME_TRY(verified,
-                api_->WalletVerify(payment_channel_actor_state.from,
+                api_->WalletVerify(channel.from_key,
                                    bytes_to_verify,
                                    voucher.signature.get()));
     if (!verified) {
@@ -155,9 +160,7 @@ namespace fc::payment_channel_manager {
     // check amount
     auto total_amoun =
         payment_channel_actor_state.to_send + voucher_send_amount;
-    OUTCOME_TRY(payment_channel_actor_balance,
-                api_->WalletBalance(channel_address));
-    if (payment_channel_actor_balance < total_amoun) {
+    if (channel.balance < total_amoun) {
       return PaymentChannelManagerError::kInsufficientFunds;
     }
 
@@ -285,13 +288,33 @@ namespace fc::payment_channel_manager {
     return AddChannelInfo{channel_actor_address, message_cid};
   }
 
-  outcome::result<PaymentChannelState>
+  outcome::result<ChannelStateCache>
   PaymentChannelManagerImpl::loadPaymentChannelActorState(
       const Address &channel_address) const {
     OUTCOME_TRY(tipset, api_->ChainHead());
-    auto state_tree =
-        std::make_shared<StateTreeImpl>(ipld_, tipset->getParentStateRoot());
-    return state_tree->state<PaymentChannelState>(channel_address);
+    auto &state_root{tipset->getParentStateRoot()};
+    boost::optional<Address> from_key;
+    {
+      std::lock_guard lock{state_cache_mutex_};
+      auto it{state_cache_.find(channel_address)};
+      if (it != state_cache_.end()) {
+        if (it->second.state_root == state_root) {
+          return it->second;
+        }
+        from_key = it->second.from_key;
+      }
+    }
+    auto state_tree = std::make_shared<StateTreeImpl>(ipld_, state_root);
+    OUTCOME_TRY(actor, state_tree->get(channel_address));
+    OUTCOME_TRY(state, state_tree->state<PaymentChannelState>(channel_address));
+    if (!from_key) {
+      // sender key doesn't change, resolved once per channel
+      OUTCOME_TRYA(from_key, api_->StateAccountKey(state.from, tipset->key));
+    }
+    ChannelStateCache channel{state_root, state, actor.balance, *from_key};
+    std::lock_guard lock{state_cache_mutex_};
+    state_cache_[channel_address] = channel;
+    return channel;
   }
 
   outcome::result<uint64_t> PaymentChannelManagerImpl::getNextNonce(
@@ -6,6 +6,7 @@
 #ifndef CPP_FILECOIN_PAYCHANNEL_MANAGER_PAYCHANNEL_MANAGER_IMPL_HPP
 #define CPP_FILECOIN_PAYCHANNEL_MANAGER_PAYCHANNEL_MANAGER_IMPL_HPP
 
+#include <mutex>
 #include <shared_mutex>
 #include "api/api.hpp"
 #include "common/buffer.hpp"
@@ -27,6 +28,18 @@ namespace fc::payment_channel_manager {
     LaneId next_lane;
   };
 
+  /**
+   * Channel actor state loaded at head parent state root, reused by vouchers
+   * while head doesn't change
+   */
+  struct ChannelStateCache {
+    CID state_root;
+    PaymentChannelState state;
+    TokenAmount balance;
+    /// Key address of channel sender, vouchers are verified against it
+    Address from_key;
+  };
+
   class PaymentChannelManagerImpl
       : public PaymentChannelManager,
         public std::enable_shared_from_this<PaymentChannelManagerImpl> {
@@ -91,13 +104,18 @@ namespace fc::payment_channel_manager {
         const Address &to, const Address &from, const TokenAmount &amount);
 
     /**
-     * Loads payment channel actor state
+     * Loads payment channel actor state or returns cached one if head parent
+     * state root didn't change
      * @param channel_address payment channel actor address
-     * @return payment channel actor state
+     * @return payment channel actor state with balance and sender key
      */
-    outcome::result<PaymentChannelState> loadPaymentChannelActorState(
+    outcome::result<ChannelStateCache> loadPaymentChannelActorState(
         const Address &channel_address) const;
 
+    /// Validates voucher against loaded channel state
+    outcome::result<void> validateVoucher(const ChannelStateCache &channel,
+                                          const SignedVoucher &voucher) const;
+
     /**
      * Get next nonce for lane in channel info
      * @param channel info
@@ -115,6 +133,9 @@ namespace fc::payment_channel_manager {
      */
     std::map<Address, ChannelInfo> channels_;
     mutable std::shared_mutex channels_mutex_;
+    /// Channel actor states by channel address
+    mutable std::map<Address, ChannelStateCache> state_cache_;
+    mutable std::mutex state_cache_mutex_;
   };
 
 }  // namespace fc::payment_channel_manager
@@ -0,0 +1,75 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "power/power_snapshot.hpp"
+
+#include <algorithm>
+
+#include "power/power_table_error.hpp"
+#include "vm/state/impl/state_tree_impl.hpp"
+
+namespace fc::power {
+  using vm::actor::kStoragePowerAddress;
+  using vm::state::StateTreeImpl;
+
+  outcome::result<PowerSnapshotPtr> PowerSnapshot::make(
+      const StoragePowerActorState &state) {
+    auto snapshot{std::make_shared<PowerSnapshot>()};
+    snapshot->total_ = {state.total_raw_power, state.total_qa_power};
+    snapshot->min_power_miners_ = state.num_miners_meeting_min_power;
+    OUTCOME_TRY(state.claims.visit([&](auto &miner, auto &claim) {
+      snapshot->entries_.push_back({miner, claim});
+      return outcome::success();
+    }));
+    // hamt order is by key hash
+    std::sort(snapshot->entries_.begin(),
+              snapshot->entries_.end(),
+              [](auto &l, auto &r) { return l.miner < r.miner; });
+    return snapshot;
+  }
+
+  outcome::result<Claim> PowerSnapshot::claim(const Address &miner) const {
+    auto it{std::lower_bound(
+        entries_.begin(), entries_.end(), miner, [](auto &entry, auto &key) {
+          return entry.miner < key;
+        })};
+    if (it == entries_.end() || it->miner != miner) {
+      return PowerTableError::kNoSuchMiner;
+    }
+    return it->claim;
+  }
+
+  const Claim &PowerSnapshot::total() const {
+    return total_;
+  }
+
+  size_t PowerSnapshot::minersMeetingMinPower() const {
+    return min_power_miners_;
+  }
+
+  const std::vector<PowerSnapshot::Entry> &PowerSnapshot::entries() const {
+    return entries_;
+  }
+
+  PowerSnapshotCache::PowerSnapshotCache(IpldPtr ipld, size_t cache_size)
+      : ipld_{std::move(ipld)}, snapshots_{cache_size} {}
+
+  outcome::result<PowerSnapshotPtr> PowerSnapshotCache::get(
+      const CID &state_root) {
+    {
+      std::lock_guard lock{mutex_};
+      if (auto snapshot{snapshots_.get(state_root)}) {
+        return std::move(*snapshot);
+      }
+    }
+    OUTCOME_TRY(state,
+                StateTreeImpl{ipld_, state_root}.state<StoragePowerActorState>(
+                    kStoragePowerAddress));
+    OUTCOME_TRY(snapshot, PowerSnapshot::make(state));
+    std::lock_guard lock{mutex_};
+    snapshots_.put(state_root, snapshot, 1);
+    return snapshot;
+  }
+}  // namespace fc::power
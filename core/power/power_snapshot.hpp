@@ -0,0 +1,69 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "common/lru_cache.hpp"
+#include "vm/actor/builtin/v0/storage_power/storage_power_actor_state.hpp"
+
+namespace fc::power {
+  using primitives::address::Address;
+  using vm::actor::builtin::v0::storage_power::Claim;
+  using vm::actor::builtin::v0::storage_power::StoragePowerActorState;
+
+  /**
+   * Immutable claims of power actor state sorted by miner, so lookups are
+   * binary searches instead of claims hamt reads and decoding.
+   * Built once per state and shared by readers.
+   */
+  class PowerSnapshot {
+   public:
+    struct Entry {
+      Address miner;
+      Claim claim;
+    };
+
+    /// Reads all claims of state
+    static outcome::result<std::shared_ptr<const PowerSnapshot>> make(
+        const StoragePowerActorState &state);
+
+    /// Claim of miner or kNoSuchMiner error
+    outcome::result<Claim> claim(const Address &miner) const;
+
+    /// Total raw and quality adjusted power
+    const Claim &total() const;
+
+    size_t minersMeetingMinPower() const;
+
+    /// Claims sorted by miner
+    const std::vector<Entry> &entries() const;
+
+   private:
+    std::vector<Entry> entries_;
+    Claim total_;
+    size_t min_power_miners_{};
+  };
+
+  using PowerSnapshotPtr = std::shared_ptr<const PowerSnapshot>;
+
+  /// Recent power snapshots by state root
+  class PowerSnapshotCache {
+   public:
+    static constexpr size_t kDefaultCacheSize{64};
+
+    explicit PowerSnapshotCache(IpldPtr ipld,
+                                size_t cache_size = kDefaultCacheSize);
+
+    /// Snapshot of power actor in state, built on first request
+    outcome::result<PowerSnapshotPtr> get(const CID &state_root);
+
+   private:
+    IpldPtr ipld_;
+    std::mutex mutex_;
+    common::LruCache<CID, PowerSnapshotPtr> snapshots_;
+  };
+}  // namespace fc::power
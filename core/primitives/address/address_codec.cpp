@@ -22,16 +22,51 @@ namespace fc::primitives::address {
   using base32 = cppcodec::base32_rfc4648;
   using libp2p::multi::UVarint;
 
+  namespace {
+    /// Appends unpadded lower case base32 of bytes
+    void appendBase32(std::string &out, gsl::span<const uint8_t> bytes) {
+      static const char kAlphabet[]{"abcdefghijklmnopqrstuvwxyz234567"};
+      uint32_t buffer{0};
+      int bits{0};
+      for (auto byte : bytes) {
+        buffer = (buffer << 8) | byte;
+        bits += 8;
+        while (bits >= 5) {
+          bits -= 5;
+          out.push_back(kAlphabet[(buffer >> bits) & 0x1f]);
+        }
+      }
+      if (bits != 0) {
+        out.push_back(kAlphabet[(buffer << (5 - bits)) & 0x1f]);
+      }
+    }
+
+    /// Checksum of protocol and payload bytes
+    std::array<uint8_t, 4> checksumOf(const AddressBytes &bytes) {
+      std::array<uint8_t, 4> res{};
+      crypto::blake2b::hashn(res, bytes);
+      return res;
+    }
+  }  // namespace
+
   std::vector<uint8_t> encode(const Address &address) noexcept {
-    std::vector<uint8_t> res{};
+    auto bytes{encodeBytes(address)};
+    return {bytes.begin(), bytes.end()};
+  }
+
+  AddressBytes encodeBytes(const Address &address) noexcept {
+    AddressBytes res;
     res.push_back(address.getProtocol());
-    std::vector<uint8_t> payload = visit_in_place(
+    visit_in_place(
         address.data,
-        [](uint64_t v) { return UVarint{v}.toVector(); },
-        [](const auto &v) { return std::vector<uint8_t>(v.begin(), v.end()); });
-    res.insert(res.end(),
-               std::make_move_iterator(payload.begin()),
-               std::make_move_iterator(payload.end()));
+        [&](uint64_t v) {
+          while (v >= 0x80) {
+            res.push_back(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+          }
+          res.push_back(static_cast<uint8_t>(v));
+        },
+        [&](const auto &v) { res.insert(res.end(), v.begin(), v.end()); });
     return res;
   }
 
@@ -39,7 +74,7 @@ namespace fc::primitives::address {
     if (v.size() < 2) return outcome::failure(AddressError::kInvalidPayload);
 
     auto p = static_cast<Protocol>(v[0]);
-    std::vector<uint8_t> payload(std::next(v.begin()), v.end());
+    auto payload{v.subspan(1)};
     switch (p) {
       case Protocol::ID: {
         boost::optional<UVarint> value = UVarint::create(payload);
@@ -53,7 +88,7 @@ namespace fc::primitives::address {
           return outcome::failure(AddressError::kInvalidPayload);
         }
         Secp256k1PublicKeyHash hash{};
-        std::copy_n(std::make_move_iterator(payload.begin()),
+        std::copy_n(payload.begin(),
                     fc::crypto::blake2b::BLAKE2B160_HASH_LENGTH,
                     hash.begin());
         return Address{hash};
@@ -63,7 +98,7 @@ namespace fc::primitives::address {
           return outcome::failure(AddressError::kInvalidPayload);
         }
         ActorExecHash hash{};
-        std::copy_n(std::make_move_iterator(payload.begin()),
+        std::copy_n(payload.begin(),
                     fc::crypto::blake2b::BLAKE2B160_HASH_LENGTH,
                     hash.begin());
         return Address{hash};
@@ -73,9 +108,7 @@ namespace fc::primitives::address {
           return outcome::failure(AddressError::kInvalidPayload);
         }
         BLSPublicKeyHash hash{};
-        std::copy_n(std::make_move_iterator(payload.begin()),
-                    kBlsPublicKeySize,
-                    hash.begin());
+        std::copy_n(payload.begin(), kBlsPublicKeySize, hash.begin());
         return Address{hash};
       }
       default:
@@ -98,30 +131,15 @@ namespace fc::primitives::address {
       return res;
     }
 
-    std::vector<uint8_t> payload = visit_in_place(
-        address.data,
-        [](uint64_t v) { return UVarint{v}.toVector(); },
-        [](const auto &v) { return std::vector<uint8_t>(v.begin(), v.end()); });
-
-    std::vector chksum = checksum(address);
-
-    payload.insert(payload.end(),
-                   std::make_move_iterator(chksum.begin()),
-                   std::make_move_iterator(chksum.end()));
-    auto encoded = base32::encode(payload);
-
-    // Convert to lower case, as the spec requires:
+    // payload and checksum, lower case and unpadded as the spec requires:
     // https://filecoin-project.github.io/specs/#payload
-    std::transform(
-        encoded.begin(), encoded.end(), encoded.begin(), [](unsigned char c) {
-          return std::tolower(c);
-        });
-    res.append(encoded);
-    // Remove padding '=' symbols
-    res.erase(
-        std::remove_if(
-            res.begin(), res.end(), [](unsigned char x) { return x == '='; }),
-        res.end());
+    auto bytes{encodeBytes(address)};
+    auto chksum{checksumOf(bytes)};
+    boost::container::static_vector<uint8_t, kMaxAddressBytes + 3> data(
+        std::next(bytes.begin()), bytes.end());
+    data.insert(data.end(), chksum.begin(), chksum.end());
+    res.reserve(res.size() + (data.size() * 8 + 4) / 5);
+    appendBase32(res, data);
     return res;
   }
 
@@ -179,29 +197,12 @@ namespace fc::primitives::address {
   }
 
   std::vector<uint8_t> checksum(const Address &address) {
-    std::vector<uint8_t> res{};
-
-    Protocol p = address.getProtocol();
-    if (p == Protocol::ID) {
+    if (address.getProtocol() == Protocol::ID) {
       // Checksum is not defined for an ID Address
-      return res;
+      return {};
     }
-
-    res.resize(4);
-
-    std::vector<uint8_t> ingest{};
-
-    ingest.push_back(p);
-
-    ingest = visit_in_place(
-        address.data,
-        [&ingest](uint64_t v) { return ingest; },
-        [&ingest](const auto &v) {
-          ingest.insert(ingest.end(), v.begin(), v.end());
-          return ingest;
-        });
-    crypto::blake2b::hashn(res, ingest);
-    return res;
+    auto res{checksumOf(encodeBytes(address))};
+    return {res.begin(), res.end()};
   }
 
   bool validateChecksum(const Address &address,
@@ -9,18 +9,29 @@
 #include <string>
 #include <vector>
 
+#include <boost/container/static_vector.hpp>
+
 #include "address.hpp"
 #include "codec/cbor/streams_annotation.hpp"
 #include "common/outcome.hpp"
 #include "common/outcome.hpp"
 
 namespace fc::primitives::address {
+  /// Protocol byte and BLS public key
+  constexpr size_t kMaxAddressBytes{49};
+
+  /// Address bytes stored inline
+  using AddressBytes =
+      boost::container::static_vector<uint8_t, kMaxAddressBytes>;
 
   /**
    * @brief Encodes an Address to an array of bytes
    */
   std::vector<uint8_t> encode(const Address &address) noexcept;
 
+  /// Encodes an Address to bytes without allocation
+  AddressBytes encodeBytes(const Address &address) noexcept;
+
   /**
    * @brief Decodes an Address from an array of bytes
    */
@@ -37,7 +48,8 @@ namespace fc::primitives::address {
   outcome::result<Address> decodeFromString(const std::string &s);
 
   CBOR_ENCODE(Address, address) {
-    return s << encode(address);
+    auto bytes{encodeBytes(address)};
+    return s << gsl::span<const uint8_t>(bytes.data(), bytes.size());
   }
 
   CBOR_DECODE(Address, address) {
@@ -0,0 +1,82 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "codec/cbor/cbor_view.hpp"
+#include "primitives/block/block.hpp"
+
+namespace fc::primitives::block {
+  using codec::cbor::CborView;
+
+  /// Lazy view of encoded block header, decodes only requested fields
+  class BlockHeaderView {
+   public:
+    using BytesIn = CborView::BytesIn;
+
+    static outcome::result<BlockHeaderView> make(BytesIn input) {
+      OUTCOME_TRY(header, CborView::make(input));
+      if (header.size() != kFields) {
+        return codec::cbor::CborDecodeError::kWrongSize;
+      }
+      return BlockHeaderView{std::move(header)};
+    }
+
+    /// Borrowed encoded miner address
+    outcome::result<BytesIn> miner() const {
+      OUTCOME_TRY(item, header_.at(0));
+      return item.asBytes();
+    }
+
+    outcome::result<std::vector<CID>> parents() const {
+      OUTCOME_TRY(item, header_.at(5));
+      std::vector<CID> parents;
+      parents.reserve(item.size());
+      for (size_t i{0}; i < item.size(); ++i) {
+        OUTCOME_TRY(parent, item.at(i));
+        OUTCOME_TRY(cid, parent.asCid());
+        parents.push_back(std::move(cid));
+      }
+      return parents;
+    }
+
+    outcome::result<uint64_t> height() const {
+      OUTCOME_TRY(item, header_.at(7));
+      return item.asUint();
+    }
+
+    outcome::result<CID> parentStateRoot() const {
+      OUTCOME_TRY(item, header_.at(8));
+      return item.asCid();
+    }
+
+    outcome::result<CID> parentMessageReceipts() const {
+      OUTCOME_TRY(item, header_.at(9));
+      return item.asCid();
+    }
+
+    outcome::result<CID> messages() const {
+      OUTCOME_TRY(item, header_.at(10));
+      return item.asCid();
+    }
+
+    outcome::result<uint64_t> timestamp() const {
+      OUTCOME_TRY(item, header_.at(12));
+      return item.asUint();
+    }
+
+    /// Decodes whole header
+    outcome::result<BlockHeader> decode() const {
+      return header_.decode<BlockHeader>();
+    }
+
+   private:
+    static constexpr size_t kFields{16};
+
+    explicit BlockHeaderView(CborView header) : header_{std::move(header)} {}
+
+    CborView header_;
+  };
+}  // namespace fc::primitives::block
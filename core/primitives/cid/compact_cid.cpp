@@ -0,0 +1,50 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/cid/compact_cid.hpp"
+
+namespace fc {
+  namespace {
+    template <typename Bytes>
+    void writeVarint(Bytes &bytes, uint64_t value) {
+      while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+      }
+      bytes.push_back(static_cast<uint8_t>(value));
+    }
+  }  // namespace
+
+  CompactCid::CompactCid(const CID &cid) {
+    auto &multihash{cid.content_address.toBuffer()};
+    if (cid.version != CID::Version::V0
+        || cid.content_type != CID::Multicodec::DAG_PB) {
+      writeVarint(bytes_, static_cast<uint64_t>(cid.version));
+      writeVarint(bytes_, static_cast<uint64_t>(cid.content_type));
+    }
+    bytes_.insert(bytes_.end(), multihash.begin(), multihash.end());
+    updateHash();
+  }
+
+  CompactCid CompactCid::fromBytes(gsl::span<const uint8_t> bytes) {
+    CompactCid cid;
+    cid.bytes_.assign(bytes.begin(), bytes.end());
+    cid.updateHash();
+    return cid;
+  }
+
+  outcome::result<CID> CompactCid::toCid() const {
+    return CID::fromBytes(bytes_);
+  }
+
+  void CompactCid::updateHash() {
+    // FNV-1a, digest bytes are already uniform
+    uint64_t hash{0xcbf29ce484222325};
+    for (auto byte : bytes_) {
+      hash = (hash ^ byte) * 0x100000001b3;
+    }
+    hash_ = hash;
+  }
+}  // namespace fc
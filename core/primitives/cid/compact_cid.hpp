@@ -0,0 +1,69 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <boost/container/small_vector.hpp>
+
+#include "primitives/cid/cid.hpp"
+
+namespace fc {
+  /**
+   * Binary form of CID for map keys. Common Filecoin CIDs (36-38 bytes) are
+   * stored inline without allocation, hash is computed once.
+   * Implicitly constructible from CID, so maps keyed by it accept CID.
+   */
+  class CompactCid {
+   public:
+    /// Size of inline storage, CIDv1 with 32 byte digest and 2 byte codec
+    static constexpr size_t kInlineSize{38};
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    CompactCid(const CID &cid);
+
+    /// Wraps CID bytes without validation
+    static CompactCid fromBytes(gsl::span<const uint8_t> bytes);
+
+    /// Same as CID::toBytes
+    inline gsl::span<const uint8_t> bytes() const {
+      return bytes_;
+    }
+
+    outcome::result<CID> toCid() const;
+
+    inline size_t hash() const {
+      return hash_;
+    }
+
+    inline bool operator==(const CompactCid &other) const {
+      return hash_ == other.hash_ && bytes_ == other.bytes_;
+    }
+
+    inline bool operator!=(const CompactCid &other) const {
+      return !(*this == other);
+    }
+
+    inline bool operator<(const CompactCid &other) const {
+      return bytes_ < other.bytes_;
+    }
+
+   private:
+    CompactCid() = default;
+
+    void updateHash();
+
+    boost::container::small_vector<uint8_t, kInlineSize> bytes_;
+    size_t hash_{};
+  };
+}  // namespace fc
+
+namespace std {
+  template <>
+  struct hash<fc::CompactCid> {
+    size_t operator()(const fc::CompactCid &cid) const {
+      return cid.hash();
+    }
+  };
+}  // namespace std
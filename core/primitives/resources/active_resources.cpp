@@ -5,7 +5,17 @@
 
 #include "primitives/resources/active_resources.hpp"
 
+#include <algorithm>
+
 namespace fc::primitives {
+  /// Devices left for window PoSt on multi-gpu worker
+  constexpr uint64_t kPoStReservedGpus{1};
+
+  uint64_t schedulableGpus(const WorkerResources &resources) {
+    auto gpus{resources.gpus.size()};
+    return gpus > kPoStReservedGpus ? gpus - kPoStReservedGpus : gpus;
+  }
+
   bool canHandleRequest(const Resources &need_resources,
                         const WorkerResources &resources,
                         const ActiveResources &active) {
@@ -38,7 +48,9 @@ namespace fc::primitives {
     }
 
     if (!resources.gpus.empty() && need_resources.can_gpu) {
-      if (active.gpu_used) {
+      auto used{std::count(
+          active.gpus_busy.begin(), active.gpus_busy.end(), true)};
+      if (static_cast<uint64_t>(used) >= schedulableGpus(resources)) {
         return false;
       }
     }
@@ -46,11 +58,18 @@ namespace fc::primitives {
     return true;
   }
 
-  void ActiveResources::add(const WorkerResources &worker_resources,
-                            const Resources &resources) {
+  boost::optional<size_t> ActiveResources::add(
+      const WorkerResources &worker_resources, const Resources &resources) {
     std::unique_lock lock(mutex_);
-    if (resources.can_gpu) {
-      gpu_used = true;
+    boost::optional<size_t> gpu;
+    if (resources.can_gpu && !worker_resources.gpus.empty()) {
+      gpus_busy.resize(worker_resources.gpus.size());
+      auto it{std::find(gpus_busy.begin(), gpus_busy.end(), false)};
+      if (it != gpus_busy.end()) {
+        *it = true;
+        gpu = it - gpus_busy.begin();
+        gpu_order_.push_back(*gpu);
+      }
     }
     if (resources.threads) {
       cpu_use += *resources.threads;
@@ -60,13 +79,31 @@ namespace fc::primitives {
 
     memory_used_min += resources.min_memory;
     memory_used_max += resources.max_memory;
+    return gpu;
   }
 
   void ActiveResources::free(const WorkerResources &worker_resources,
                              const Resources &resources) {
+    boost::optional<size_t> gpu;
+    {
+      std::shared_lock lock(mutex_);
+      if (resources.can_gpu && !gpu_order_.empty()) {
+        gpu = gpu_order_.front();
+      }
+    }
+    free(worker_resources, resources, gpu);
+  }
+
+  void ActiveResources::free(const WorkerResources &worker_resources,
+                             const Resources &resources,
+                             boost::optional<size_t> gpu) {
     std::unique_lock lock(mutex_);
-    if (resources.can_gpu) {
-      gpu_used = false;
+    if (gpu && *gpu < gpus_busy.size()) {
+      gpus_busy[*gpu] = false;
+      auto it{std::find(gpu_order_.begin(), gpu_order_.end(), *gpu)};
+      if (it != gpu_order_.end()) {
+        gpu_order_.erase(it);
+      }
     }
 
     if (resources.threads) {
@@ -90,11 +127,11 @@ namespace fc::primitives {
     }
     unlock_ = false;
 
-    add(worker_resources, resources);
+    auto gpu{add(worker_resources, resources)};
 
     auto res = callback();
 
-    free(worker_resources, resources);
+    free(worker_resources, resources, gpu);
 
     unlock_ = true;
     cv_.notify_all();
@@ -102,6 +139,11 @@ namespace fc::primitives {
     return res;
   }
 
+  uint64_t ActiveResources::gpusUsed() const {
+    std::shared_lock lock(mutex_);
+    return std::count(gpus_busy.begin(), gpus_busy.end(), true);
+  }
+
   double ActiveResources::utilization(const WorkerResources &worker_resources) {
     std::shared_lock lock(mutex_);
     double max = static_cast<double>(cpu_use) / worker_resources.cpus;
@@ -7,6 +7,7 @@
 #define CPP_FILECOIN_CORE_PRIMITIVES_RESOURCES_ACTIVE_RESOURCES_HPP
 
 #include <shared_mutex>
+#include <vector>
 #include "primitives/resources/resources.hpp"
 #include "primitives/types.hpp"
 
@@ -15,15 +16,28 @@ namespace fc::primitives {
   struct ActiveResources {
     uint64_t memory_used_min = 0;
     uint64_t memory_used_max = 0;
-    bool gpu_used = false;
+    /// Busy state by index of device in worker gpus
+    std::vector<bool> gpus_busy;
     uint64_t cpu_use = 0;
 
-    void add(const WorkerResources &worker_resources,
-             const Resources &resources);
+    /**
+     * Reserves resources, gpu task takes first free device.
+     * Returns index of device taken by task, if any
+     */
+    boost::optional<size_t> add(const WorkerResources &worker_resources,
+                                const Resources &resources);
 
+    /// Frees resources and least recently taken device of gpu task
     void free(const WorkerResources &worker_resources,
               const Resources &resources);
 
+    /// Frees resources and device returned by add
+    void free(const WorkerResources &worker_resources,
+              const Resources &resources,
+              boost::optional<size_t> gpu);
+
+    uint64_t gpusUsed() const;
+
     /**
      * @brief run @callback with @resources
      */
@@ -40,11 +54,20 @@ namespace fc::primitives {
                                  const ActiveResources &active);
 
    private:
+    /// Order in which devices were taken, for free without device index
+    std::vector<size_t> gpu_order_;
     mutable std::shared_mutex mutex_;
     bool unlock_;
     std::condition_variable cv_;
   };
 
+  /**
+   * Devices which gpu tasks may take. On multi-gpu worker one device is left
+   * for window PoSt, which doesn't go through scheduler and must not wait
+   * for long C2.
+   */
+  uint64_t schedulableGpus(const WorkerResources &resources);
+
   bool canHandleRequest(const Resources &need_resources,
                         const WorkerResources &resources,
                         const ActiveResources &active);
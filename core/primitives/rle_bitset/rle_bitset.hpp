@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_CORE_PRIMITIVES_RLE_BITSET_RLE_BITSET_HPP
 #define CPP_FILECOIN_CORE_PRIMITIVES_RLE_BITSET_RLE_BITSET_HPP
 
+#include <algorithm>
+#include <iterator>
 #include <set>
 
 #include "codec/cbor/streams_annotation.hpp"
@@ -13,17 +15,263 @@
 #include "common/outcome.hpp"
 
 namespace fc::primitives {
-  struct RleBitset : public std::set<uint64_t> {
-    using set::set;
+  /**
+   * Set of integers stored as sorted disjoint runs, so operations cost
+   * O(runs) instead of O(elements). Keeps std::set-like interface.
+   */
+  class RleBitset {
+   public:
+    using value_type = uint64_t;
+    using size_type = uint64_t;
 
-    inline RleBitset(set &&s) : set{s} {}
+    /// Values [from, to), runs are never empty nor adjacent
+    struct Run {
+      uint64_t from{};
+      uint64_t to{};
+
+      inline bool operator==(const Run &other) const {
+        return from == other.from && to == other.to;
+      }
+    };
+
+    /// Iterates values of runs
+    class const_iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = uint64_t;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const uint64_t *;
+      using reference = const uint64_t &;
+
+      const_iterator() = default;
+      const_iterator(const std::vector<Run> *runs, size_t run)
+          : runs_{runs}, run_{run} {
+        if (run_ < runs_->size()) {
+          value_ = (*runs_)[run_].from;
+        }
+      }
+
+      inline reference operator*() const {
+        return value_;
+      }
+
+      inline const_iterator &operator++() {
+        if (++value_ == (*runs_)[run_].to && ++run_ < runs_->size()) {
+          value_ = (*runs_)[run_].from;
+        }
+        return *this;
+      }
+
+      inline const_iterator operator++(int) {
+        auto it{*this};
+        ++*this;
+        return it;
+      }
+
+      inline bool operator==(const const_iterator &other) const {
+        return run_ == other.run_
+               && (run_ == runs_->size() || value_ == other.value_);
+      }
+
+      inline bool operator!=(const const_iterator &other) const {
+        return !(*this == other);
+      }
+
+     private:
+      const std::vector<Run> *runs_{};
+      size_t run_{};
+      uint64_t value_{};
+    };
+    using iterator = const_iterator;
+
+    RleBitset() = default;
+
+    inline RleBitset(std::initializer_list<uint64_t> values) {
+      insert(values.begin(), values.end());
+    }
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    inline RleBitset(const std::set<uint64_t> &values) {
+      insert(values.begin(), values.end());
+    }
+
+    template <typename It>
+    RleBitset(It begin, It end) {
+      insert(begin, end);
+    }
+
+    /// Builds from RLE+ run lengths, alternating unset and set
+    static inline RleBitset fromRuns(const codec::rle::Runs64 &runs) {
+      RleBitset set;
+      uint64_t value{};
+      bool include{false};
+      for (auto run : runs) {
+        if (include && run != 0) {
+          set.append(value, value + run);
+        }
+        value += run;
+        include = !include;
+      }
+      return set;
+    }
+
+    /// RLE+ run lengths, alternating unset and set, starting with unset
+    inline codec::rle::Runs64 toRuns() const {
+      codec::rle::Runs64 runs;
+      runs.reserve(2 * runs_.size());
+      uint64_t last{};
+      for (auto &run : runs_) {
+        runs.push_back(run.from - last);
+        runs.push_back(run.to - run.from);
+        last = run.to;
+      }
+      return runs;
+    }
+
+    /// Decodes RLE+ bytes run by run
+    static inline outcome::result<RleBitset> fromRle(
+        gsl::span<const uint8_t> rle) {
+      OUTCOME_TRY(reader, codec::rle::RunsReader::make(rle));
+      RleBitset set;
+      uint64_t value{};
+      bool include{false};
+      while (true) {
+        OUTCOME_TRY(run, reader.next());
+        if (!run) {
+          break;
+        }
+        if (include && *run != 0) {
+          set.append(value, value + *run);
+        }
+        value += *run;
+        include = !include;
+      }
+      return set;
+    }
+
+    /// Encodes RLE+ bytes run by run
+    inline std::vector<uint8_t> toRle() const {
+      codec::rle::RunsWriter writer;
+      uint64_t last{};
+      for (auto &run : runs_) {
+        writer.push(run.from - last);
+        writer.push(run.to - run.from);
+        last = run.to;
+      }
+      return std::move(writer).data();
+    }
+
+    inline const std::vector<Run> &runs() const {
+      return runs_;
+    }
+
+    inline const_iterator begin() const {
+      return {&runs_, 0};
+    }
+
+    inline const_iterator end() const {
+      return {&runs_, runs_.size()};
+    }
+
+    inline bool empty() const {
+      return runs_.empty();
+    }
+
+    /// Count of values, O(runs)
+    inline uint64_t size() const {
+      uint64_t size{};
+      for (auto &run : runs_) {
+        size += run.to - run.from;
+      }
+      return size;
+    }
 
     inline bool has(uint64_t v) const {
-      return find(v) != end();
+      auto it{upper(v)};
+      return it != runs_.begin() && std::prev(it)->to > v;
+    }
+
+    inline size_t count(uint64_t v) const {
+      return has(v) ? 1 : 0;
+    }
+
+    inline void clear() {
+      runs_.clear();
+    }
+
+    inline void insert(uint64_t v) {
+      if (runs_.empty() || runs_.back().to < v) {
+        return runs_.push_back({v, v + 1});
+      }
+      if (runs_.back().to == v) {
+        ++runs_.back().to;
+        return;
+      }
+      auto next{upper(v)};
+      if (next != runs_.begin()) {
+        auto prev{std::prev(next)};
+        if (prev->to > v) {
+          return;
+        }
+        if (prev->to == v) {
+          ++prev->to;
+          if (next != runs_.end() && next->from == prev->to) {
+            prev->to = next->to;
+            runs_.erase(next);
+          }
+          return;
+        }
+      }
+      if (next != runs_.end() && next->from == v + 1) {
+        next->from = v;
+        return;
+      }
+      runs_.insert(next, {v, v + 1});
+    }
+
+    template <typename It>
+    void insert(It begin, It end) {
+      for (; begin != end; ++begin) {
+        insert(*begin);
+      }
     }
 
-    inline void operator+=(const RleBitset &other) {
-      insert(other.begin(), other.end());
+    inline void erase(uint64_t v) {
+      auto it{upper(v)};
+      if (it == runs_.begin() || std::prev(it)->to <= v) {
+        return;
+      }
+      --it;
+      if (it->from == v) {
+        if (++it->from == it->to) {
+          runs_.erase(it);
+        }
+      } else if (it->to == v + 1) {
+        --it->to;
+      } else {
+        Run tail{v + 1, it->to};
+        it->to = v;
+        runs_.insert(std::next(it), tail);
+      }
+    }
+
+    inline RleBitset &operator+=(const RleBitset &other) {
+      if (other.empty()) {
+        return *this;
+      }
+      RleBitset result;
+      result.runs_.reserve(runs_.size() + other.runs_.size());
+      auto l{runs_.cbegin()};
+      auto r{other.runs_.cbegin()};
+      while (l != runs_.end() || r != other.runs_.end()) {
+        auto &run{r == other.runs_.end()
+                          || (l != runs_.end() && l->from < r->from)
+                      ? *l++
+                      : *r++};
+        result.append(run.from, run.to);
+      }
+      runs_ = std::move(result.runs_);
+      return *this;
     }
 
     inline RleBitset operator+(const RleBitset &other) const {
@@ -34,24 +282,111 @@ namespace fc::primitives {
 
     inline RleBitset operator-(const RleBitset &other) const {
       RleBitset result;
-      for (auto i : *this) {
-        if (!other.has(i)) {
-          result.insert(i);
+      auto r{other.runs_.begin()};
+      for (auto run : runs_) {
+        while (r != other.runs_.end() && r->to <= run.from) {
+          ++r;
+        }
+        for (auto it{r}; it != other.runs_.end() && it->from < run.to; ++it) {
+          if (it->from > run.from) {
+            result.append(run.from, it->from);
+          }
+          run.from = std::max(run.from, it->to);
+        }
+        if (run.from < run.to) {
+          result.append(run.from, run.to);
+        }
+      }
+      return result;
+    }
+
+    inline RleBitset &operator-=(const RleBitset &other) {
+      return *this = *this - other;
+    }
+
+    /// Values present in both sets
+    inline RleBitset intersect(const RleBitset &other) const {
+      RleBitset result;
+      auto l{runs_.begin()};
+      auto r{other.runs_.begin()};
+      while (l != runs_.end() && r != other.runs_.end()) {
+        auto from{std::max(l->from, r->from)};
+        auto to{std::min(l->to, r->to)};
+        if (from < to) {
+          result.append(from, to);
+        }
+        if (l->to < r->to) {
+          ++l;
+        } else {
+          ++r;
+        }
+      }
+      return result;
+    }
+
+    /// At most `count` values, skipping first `skip` values
+    inline RleBitset slice(uint64_t skip, uint64_t count) const {
+      RleBitset result;
+      for (auto &run : runs_) {
+        if (count == 0) {
+          break;
         }
+        auto size{run.to - run.from};
+        if (skip >= size) {
+          skip -= size;
+          continue;
+        }
+        auto from{run.from + skip};
+        auto to{from + std::min(count, size - skip)};
+        result.append(from, to);
+        count -= to - from;
+        skip = 0;
       }
       return result;
     }
+
+    inline bool operator==(const RleBitset &other) const {
+      return runs_ == other.runs_;
+    }
+
+    inline bool operator!=(const RleBitset &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    /// First run starting after value
+    inline std::vector<Run>::iterator upper(uint64_t v) {
+      return std::upper_bound(runs_.begin(),
+                              runs_.end(),
+                              v,
+                              [](auto v, auto &run) { return v < run.from; });
+    }
+
+    inline std::vector<Run>::const_iterator upper(uint64_t v) const {
+      return const_cast<RleBitset *>(this)->upper(v);
+    }
+
+    /// Appends run not before last run, merging if overlaps or adjacent
+    inline void append(uint64_t from, uint64_t to) {
+      if (!runs_.empty() && runs_.back().to >= from) {
+        runs_.back().to = std::max(runs_.back().to, to);
+      } else {
+        runs_.push_back({from, to});
+      }
+    }
+
+    std::vector<Run> runs_;
   };
 
   CBOR_ENCODE(RleBitset, set) {
-    return s << codec::rle::encode(set);
+    return s << set.toRle();
   }
 
   CBOR_DECODE(RleBitset, set) {
     std::vector<uint8_t> rle;
     s >> rle;
-    OUTCOME_EXCEPT(decoded, codec::rle::decode<RleBitset::value_type>(rle));
-    set = RleBitset{std::move(decoded)};
+    OUTCOME_EXCEPT(decoded, RleBitset::fromRle(rle));
+    set = std::move(decoded);
     return s;
   }
 }  // namespace fc::primitives
@@ -10,23 +10,31 @@
 
 namespace fc::primitives {
   StoredCounter::StoredCounter(std::shared_ptr<Datastore> datastore,
-                               std::string key)
-      : datastore_(std::move(datastore)), key_(fc::common::span::cbytes(key)) {}
+                               std::string key,
+                               uint64_t reserve)
+      : datastore_(std::move(datastore)),
+        key_(fc::common::span::cbytes(key)),
+        reserve_{std::max<uint64_t>(reserve, 1)} {}
 
   outcome::result<uint64_t> StoredCounter::next() {
     std::lock_guard lock(mutex_);
 
-    auto has = datastore_->contains(key_);
+    if (!loaded_) {
+      if (datastore_->contains(key_)) {
+        OUTCOME_TRY(value, datastore_->get(key_));
+        libp2p::multi::UVarint cur(value);
+        next_ = cur.toUInt64() + 1;
+      }
+      end_ = next_;
+      loaded_ = true;
+    }
 
-    uint64_t next = 0;
-    if (has) {
-      OUTCOME_TRY(value, datastore_->get(key_));
-      libp2p::multi::UVarint cur(value);
-      next = cur.toUInt64() + 1;
+    if (next_ == end_) {
+      libp2p::multi::UVarint new_value(next_ + reserve_ - 1);
+      OUTCOME_TRY(datastore_->put(key_, Buffer(new_value.toBytes())));
+      end_ = next_ + reserve_;
     }
-    libp2p::multi::UVarint new_value(next);
-    OUTCOME_TRY(datastore_->put(key_, Buffer(new_value.toBytes())));
 
-    return next;
+    return next_++;
   }
 }  // namespace fc::primitives
@@ -21,15 +21,34 @@ namespace fc::primitives {
     virtual outcome::result<uint64_t> next() = 0;
   };
 
+  /**
+   * Counter persisted in datastore.
+   * Numbers are reserved in blocks with one write, and handed out from memory
+   * until block is used. Stored value is last reserved number, so numbers
+   * reserved but not handed out before restart are skipped.
+   */
   class StoredCounter : public Counter {
    public:
-    StoredCounter(std::shared_ptr<Datastore> datastore, std::string key);
+    /**
+     * @param datastore - datastore to persist counter in
+     * @param key - key of counter
+     * @param reserve - numbers reserved with one write
+     */
+    StoredCounter(std::shared_ptr<Datastore> datastore,
+                  std::string key,
+                  uint64_t reserve = 1);
 
     outcome::result<uint64_t> next() override;
 
    private:
     std::shared_ptr<Datastore> datastore_;
     Buffer key_;
+    uint64_t reserve_;
+
+    /// Next number and end of reserved block, loaded on first call
+    bool loaded_{false};
+    uint64_t next_{};
+    uint64_t end_{};
 
     std::mutex mutex_;
   };
@@ -0,0 +1,157 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/tipset/chain_graph.hpp"
+
+namespace fc::primitives::tipset {
+  ChainGraph::ChainGraph(IpldPtr ipld,
+                         std::shared_ptr<TipsetCache> tipset_cache,
+                         size_t window)
+      : ipld_{std::move(ipld)},
+        tipset_cache_{tipset_cache ? std::move(tipset_cache)
+                                   : std::make_shared<TipsetCache>()},
+        window_{window} {}
+
+  outcome::result<void> ChainGraph::insert(const TipsetCPtr &ts) {
+    std::lock_guard lock{mutex_};
+    OUTCOME_TRY(node(ts));
+    prune();
+    return outcome::success();
+  }
+
+  outcome::result<TipsetCPtr> ChainGraph::commonAncestor(const TipsetCPtr &a,
+                                                         const TipsetCPtr &b) {
+    std::lock_guard lock{mutex_};
+    OUTCOME_TRY(node_a, node(a));
+    OUTCOME_TRY(node_b, node(b));
+    OUTCOME_TRY(common, ancestor(node_a, node_b));
+    return common->ts;
+  }
+
+  outcome::result<std::vector<HeadChange>> ChainGraph::headChanges(
+      const TipsetCPtr &from, const TipsetCPtr &to) {
+    std::lock_guard lock{mutex_};
+    OUTCOME_TRY(node_from, node(from));
+    OUTCOME_TRY(node_to, node(to));
+    OUTCOME_TRY(common, ancestor(node_from, node_to));
+    std::vector<HeadChange> changes;
+    for (auto node{node_from}; node != common;) {
+      changes.push_back({HeadChangeType::REVERT, node->ts});
+      OUTCOME_TRYA(node, parent(node));
+    }
+    auto reverts{changes.size()};
+    for (auto node{node_to}; node != common;) {
+      changes.push_back({HeadChangeType::APPLY, node->ts});
+      OUTCOME_TRYA(node, parent(node));
+    }
+    // applies go bottom up
+    std::reverse(changes.begin() + reverts, changes.end());
+    return changes;
+  }
+
+  size_t ChainGraph::size() const {
+    std::lock_guard lock{mutex_};
+    return nodes_.size();
+  }
+
+  outcome::result<ChainGraph::Node *> ChainGraph::node(const TipsetCPtr &ts) {
+    auto it{nodes_.find(ts->key)};
+    if (it != nodes_.end()) {
+      return &it->second;
+    }
+    top_ = std::max(top_, ts->height());
+    // parents are loaded lazily, only when path goes below known chain
+    auto &node{nodes_[ts->key]};
+    node.ts = ts;
+    auto parent{nodes_.find(ts->getParents())};
+    link(node, parent != nodes_.end() ? &parent->second : nullptr);
+    return &node;
+  }
+
+  outcome::result<ChainGraph::Node *> ChainGraph::parent(Node *node) {
+    if (!node->jumps.empty()) {
+      return node->jumps[0];
+    }
+    if (node->height() == 0) {
+      return TipsetError::kNoCommonAncestor;
+    }
+    OUTCOME_TRY(ts, tipset_cache_->loadParent(*ipld_, *node->ts));
+    OUTCOME_TRY(parent, this->node(ts));
+    link(*node, parent);
+    return parent;
+  }
+
+  outcome::result<ChainGraph::Node *> ChainGraph::ancestor(Node *a, Node *b) {
+    while (a != b) {
+      if (a->height() < b->height()) {
+        std::swap(a, b);
+      }
+      if (a->height() > b->height()) {
+        // farthest jump not below other side can't skip common ancestor
+        Node *next{};
+        for (auto i{a->jumps.size()}; i-- != 0;) {
+          if (a->jumps[i]->height() >= b->height()) {
+            next = a->jumps[i];
+            break;
+          }
+        }
+        if (!next) {
+          OUTCOME_TRYA(next, parent(a));
+        }
+        a = next;
+        continue;
+      }
+      // different tipsets at same height are both above common ancestor
+      Node *next_a{}, *next_b{};
+      for (auto i{std::min(a->jumps.size(), b->jumps.size())}; i-- != 0;) {
+        auto jump_a{a->jumps[i]}, jump_b{b->jumps[i]};
+        if (jump_a != jump_b && jump_a->height() == jump_b->height()) {
+          next_a = jump_a;
+          next_b = jump_b;
+          break;
+        }
+      }
+      if (!next_a) {
+        OUTCOME_TRYA(next_a, parent(a));
+        OUTCOME_TRYA(next_b, parent(b));
+      }
+      a = next_a;
+      b = next_b;
+    }
+    return a;
+  }
+
+  void ChainGraph::link(Node &node, Node *parent) {
+    node.jumps.clear();
+    if (!parent) {
+      return;
+    }
+    node.jumps.push_back(parent);
+    for (size_t i{0}; i < node.jumps[i]->jumps.size(); ++i) {
+      node.jumps.push_back(node.jumps[i]->jumps[i]);
+    }
+  }
+
+  void ChainGraph::prune() {
+    auto bottom{top_ > window_ ? top_ - window_ : 0};
+    if (bottom < bottom_ + std::max<size_t>(1, window_ / 8)) {
+      return;
+    }
+    // drop jumps first, so kept nodes don't point to removed ones
+    for (auto &[key, node] : nodes_) {
+      while (!node.jumps.empty() && node.jumps.back()->height() < bottom) {
+        node.jumps.pop_back();
+      }
+    }
+    for (auto it{nodes_.begin()}; it != nodes_.end();) {
+      if (it->second.height() < bottom) {
+        it = nodes_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    bottom_ = bottom;
+  }
+}  // namespace fc::primitives::tipset
@@ -0,0 +1,76 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+
+#include "primitives/tipset/tipset_cache.hpp"
+
+namespace fc::primitives::tipset {
+  /**
+   * Parent links of recent tipsets with skip pointers, so common ancestor of
+   * two heads is found with O(log depth) jumps instead of loading parents
+   * one by one.
+   * Node keeps decoded tipset, so head change paths come with loaded
+   * tipsets. Tipsets below `window` from highest one are pruned, missing
+   * parents are loaded through tipset cache.
+   * Thread-safe.
+   */
+  class ChainGraph {
+   public:
+    static constexpr size_t kDefaultWindow{2000};
+
+    explicit ChainGraph(IpldPtr ipld,
+                        std::shared_ptr<TipsetCache> tipset_cache = nullptr,
+                        size_t window = kDefaultWindow);
+
+    /// Remember tipset and ancestors down to known ones or window bottom
+    outcome::result<void> insert(const TipsetCPtr &ts);
+
+    outcome::result<TipsetCPtr> commonAncestor(const TipsetCPtr &a,
+                                               const TipsetCPtr &b);
+
+    /**
+     * Changes to move head from `from` to `to`: REVERT of tipsets from `from`
+     * down to common ancestor (exclusive), then APPLY of tipsets from common
+     * ancestor (exclusive) up to `to`
+     */
+    outcome::result<std::vector<HeadChange>> headChanges(const TipsetCPtr &from,
+                                                         const TipsetCPtr &to);
+
+    size_t size() const;
+
+   private:
+    struct Node {
+      TipsetCPtr ts;
+      /// jumps[i] is 2^i-th ancestor, shorter near window bottom
+      std::vector<Node *> jumps;
+
+      auto height() const {
+        return ts->height();
+      }
+    };
+
+    /// Find or insert node of tipset with unknown ancestors
+    outcome::result<Node *> node(const TipsetCPtr &ts);
+    /// Parent of node, loaded when node is bottom of known chain
+    outcome::result<Node *> parent(Node *node);
+    outcome::result<Node *> ancestor(Node *a, Node *b);
+    /// Set skip pointers of node which parent is known
+    static void link(Node &node, Node *parent);
+    /// Remove tipsets below window when bottom moved enough
+    void prune();
+
+    IpldPtr ipld_;
+    std::shared_ptr<TipsetCache> tipset_cache_;
+    size_t window_;
+    /// Highest inserted height and lowest kept height
+    uint64_t top_{}, bottom_{};
+    mutable std::mutex mutex_;
+    std::unordered_map<TipsetKey, Node> nodes_;
+  };
+}  // namespace fc::primitives::tipset
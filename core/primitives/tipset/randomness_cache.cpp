@@ -0,0 +1,64 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/tipset/randomness_cache.hpp"
+
+namespace fc::primitives::tipset {
+  RandomnessCache::RandomnessCache(size_t max_entries)
+      : tickets_{max_entries}, beacons_{max_entries} {}
+
+  outcome::result<Buffer> RandomnessCache::ticket(Ipld &ipld,
+                                                  const Tipset &tipset,
+                                                  ChainEpoch round) {
+    return lookup(
+        tickets_, ipld, tipset, round, [](const Tipset &ts) {
+          return outcome::result<Buffer>{ts.getMinTicketBlock().ticket->bytes};
+        });
+  }
+
+  outcome::result<BeaconEntry> RandomnessCache::beacon(Ipld &ipld,
+                                                       const Tipset &tipset,
+                                                       ChainEpoch round) {
+    return lookup(beacons_, ipld, tipset, round, [&](const Tipset &ts) {
+      return ts.latestBeacon(ipld);
+    });
+  }
+
+  template <typename V, typename F>
+  outcome::result<V> RandomnessCache::lookup(
+      common::LruCache<Key, V, KeyHash> &cache,
+      Ipld &ipld,
+      const Tipset &tipset,
+      ChainEpoch round,
+      const F &resolve) {
+    std::vector<Key> visited;
+    auto ts{&tipset};
+    TipsetCPtr parent;
+    boost::optional<V> value;
+    while (true) {
+      Key key{ts->key, round};
+      {
+        std::lock_guard lock{mutex_};
+        value = cache.get(key);
+      }
+      if (value) {
+        break;
+      }
+      visited.push_back(std::move(key));
+      if (ts->height() == 0 || ts->epoch() <= round) {
+        OUTCOME_TRY(resolved, resolve(*ts));
+        value = std::move(resolved);
+        break;
+      }
+      OUTCOME_TRYA(parent, ts->loadParent(ipld));
+      ts = parent.get();
+    }
+    std::lock_guard lock{mutex_};
+    for (auto &key : visited) {
+      cache.put(key, *value, 1);
+    }
+    return std::move(*value);
+  }
+}  // namespace fc::primitives::tipset
@@ -0,0 +1,59 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "common/lru_cache.hpp"
+#include "primitives/tipset/tipset.hpp"
+
+namespace fc::primitives::tipset {
+  /**
+   * Bounded cache of tickets and beacons which randomness is drawn from, by
+   * tipset and round. Lookup walking back from tipset remembers result for
+   * every tipset it visits, so lookups of same round from tipset and its
+   * descendants end at first cached ancestor. Tipsets are immutable, so
+   * cache may be shared by all chains of same ipld.
+   * Thread-safe.
+   */
+  class RandomnessCache {
+   public:
+    static constexpr size_t kDefaultMaxEntries{8192};
+
+    explicit RandomnessCache(size_t max_entries = kDefaultMaxEntries);
+
+    /// Ticket of last tipset not after round on chain of tipset
+    outcome::result<Buffer> ticket(Ipld &ipld,
+                                   const Tipset &tipset,
+                                   ChainEpoch round);
+
+    /// Latest beacon of last tipset not after round on chain of tipset
+    outcome::result<BeaconEntry> beacon(Ipld &ipld,
+                                        const Tipset &tipset,
+                                        ChainEpoch round);
+
+   private:
+    using Key = std::pair<TipsetKey, ChainEpoch>;
+
+    struct KeyHash {
+      size_t operator()(const Key &key) const {
+        return std::hash<TipsetKey>{}(key.first) ^ std::hash<ChainEpoch>{}(
+                   key.second);
+      }
+    };
+
+    template <typename V, typename F>
+    outcome::result<V> lookup(common::LruCache<Key, V, KeyHash> &cache,
+                              Ipld &ipld,
+                              const Tipset &tipset,
+                              ChainEpoch round,
+                              const F &resolve);
+
+    std::mutex mutex_;
+    common::LruCache<Key, Buffer, KeyHash> tickets_;
+    common::LruCache<Key, BeaconEntry, KeyHash> beacons_;
+  };
+}  // namespace fc::primitives::tipset
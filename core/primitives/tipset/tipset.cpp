@@ -10,7 +10,8 @@
 #include "crypto/blake2/blake2b160.hpp"
 #include "primitives/address/address_codec.hpp"
 #include "primitives/cid/cid_of_cbor.hpp"
-#include "vm/message/message.hpp"
+#include "primitives/tipset/randomness_cache.hpp"
+#include "vm/message/message_view.hpp"
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::primitives::tipset, TipsetError, e) {
   using fc::primitives::tipset::TipsetError;
@@ -31,6 +32,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::primitives::tipset, TipsetError, e) {
       return "Same miner already in tipset";
     case TipsetError::kNoBeacons:
       return "No beacons in chain";
+    case TipsetError::kNoCommonAncestor:
+      return "Chains have no common ancestor";
   }
   return "Unknown tipset error";
 }
@@ -215,6 +218,24 @@ namespace fc::primitives::tipset {
     return creator.getTipset(true);
   }
 
+  outcome::result<TipsetCPtr> Tipset::create(
+      std::vector<CID> cids, std::vector<block::BlockHeader> blocks) {
+    assert(cids.size() == blocks.size());
+    if (blocks.empty()) {
+      return TipsetError::kNoBlocks;
+    }
+
+    TipsetCreator creator;
+
+    for (size_t i{0}; i < blocks.size(); ++i) {
+      OUTCOME_TRY(creator.canExpandTipset(blocks[i]));
+      OUTCOME_TRY(
+          creator.expandTipset(std::move(cids[i]), std::move(blocks[i])));
+    }
+
+    return creator.getTipset(true);
+  }
+
   outcome::result<TipsetCPtr> Tipset::load(Ipld &ipld,
                                            const std::vector<CID> &cids) {
     std::vector<BlockHeader> blocks;
@@ -223,7 +244,8 @@ namespace fc::primitives::tipset {
       OUTCOME_TRY(block, ipld.getCbor<BlockHeader>(cid));
       blocks.emplace_back(std::move(block));
     }
-    return create(std::move(blocks));
+    // blocks are stored by cid, so it is not computed again
+    return create(cids, std::move(blocks));
   }
 
   outcome::result<TipsetCPtr> Tipset::loadParent(Ipld &ipld) const {
@@ -262,14 +284,11 @@ namespace fc::primitives::tipset {
   outcome::result<BigInt> Tipset::nextBaseFee(IpldPtr ipld) const {
     GasAmount gas_limit{};
     OUTCOME_TRY(visitMessages(
-        ipld, [&](auto, auto bls, auto &cid) -> outcome::result<void> {
-          if (bls) {
-            OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
-            gas_limit += message.gas_limit;
-          } else {
-            OUTCOME_TRY(message, ipld->getCbor<SignedMessage>(cid));
-            gas_limit += message.message.gas_limit;
-          }
+        ipld, [&](auto, auto, auto &cid) -> outcome::result<void> {
+          OUTCOME_TRY(bytes, ipld->get(cid));
+          OUTCOME_TRY(message, vm::message::MessageView::make(bytes));
+          OUTCOME_TRY(message_gas_limit, message.gasLimit());
+          gas_limit += message_gas_limit;
           return outcome::success();
         }));
     auto delta{std::max<GasAmount>(
@@ -290,7 +309,13 @@ namespace fc::primitives::tipset {
       Ipld &ipld,
       DomainSeparationTag tag,
       ChainEpoch round,
-      gsl::span<const uint8_t> entropy) const {
+      gsl::span<const uint8_t> entropy,
+      RandomnessCache *cache) const {
+    if (cache) {
+      OUTCOME_TRY(beacon, cache->beacon(ipld, *this, round));
+      return crypto::randomness::drawRandomness(
+          beacon.data, tag, round, entropy);
+    }
     auto ts{this};
     TipsetCPtr parent;
     while (ts->height() != 0 && ts->epoch() > round) {
@@ -305,7 +330,12 @@ namespace fc::primitives::tipset {
       Ipld &ipld,
       DomainSeparationTag tag,
       ChainEpoch round,
-      gsl::span<const uint8_t> entropy) const {
+      gsl::span<const uint8_t> entropy,
+      RandomnessCache *cache) const {
+    if (cache) {
+      OUTCOME_TRY(ticket, cache->ticket(ipld, *this, round));
+      return crypto::randomness::drawRandomness(ticket, tag, round, entropy);
+    }
     auto ts{this};
     TipsetCPtr parent;
     while (ts->height() != 0 && ts->epoch() > round) {
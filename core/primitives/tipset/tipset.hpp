@@ -20,6 +20,7 @@ namespace fc::primitives::tipset {
     kBlockOrderFailure,   // wrong order of blocks
     kMinerAlreadyExists,  // miner already in tipset
     kNoBeacons,
+    kNoCommonAncestor,  // chains don't have common tipset
   };
 }
 
@@ -44,6 +45,7 @@ namespace fc::primitives::tipset {
     std::set<CID> visited{};
   };
 
+  class RandomnessCache;
   struct Tipset;
   using TipsetCPtr = std::shared_ptr<const Tipset>;
 
@@ -59,6 +61,10 @@ namespace fc::primitives::tipset {
     static outcome::result<TipsetCPtr> create(
         std::vector<block::BlockHeader> blocks);
 
+    /// Creates tipset from blocks with known cids, without hashing them again
+    static outcome::result<TipsetCPtr> create(
+        std::vector<CID> cids, std::vector<block::BlockHeader> blocks);
+
     static outcome::result<TipsetCPtr> load(Ipld &ipld,
                                             const std::vector<CID> &cids);
 
@@ -71,17 +77,21 @@ namespace fc::primitives::tipset {
 
     outcome::result<BigInt> nextBaseFee(IpldPtr ipld) const;
 
+    /// Cache, if given, remembers beacon of round for tipset and ancestors
     outcome::result<Randomness> beaconRandomness(
         Ipld &ipld,
         DomainSeparationTag tag,
         ChainEpoch round,
-        gsl::span<const uint8_t> entropy) const;
+        gsl::span<const uint8_t> entropy,
+        RandomnessCache *cache = nullptr) const;
 
+    /// Cache, if given, remembers ticket of round for tipset and ancestors
     outcome::result<Randomness> ticketRandomness(
         Ipld &ipld,
         DomainSeparationTag tag,
         ChainEpoch round,
-        gsl::span<const uint8_t> entropy) const;
+        gsl::span<const uint8_t> entropy,
+        RandomnessCache *cache = nullptr) const;
 
     /**
      * @return key made of parents
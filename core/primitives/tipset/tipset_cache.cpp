@@ -0,0 +1,65 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/tipset/tipset_cache.hpp"
+
+namespace fc::primitives::tipset {
+  TipsetCache::TipsetCache(size_t max_tipsets) : cache_{max_tipsets} {
+    budget_ = common::MemoryBudget::instance().add(
+        {"tipsets",
+         1,
+         max_tipsets * kTipsetBytes,
+         [this] {
+           std::lock_guard lock{mutex_};
+           return cache_.weight() * kTipsetBytes;
+         },
+         [this](size_t limit) {
+           std::lock_guard lock{mutex_};
+           cache_.setMaxWeight(limit / kTipsetBytes);
+         }});
+  }
+
+  TipsetCPtr TipsetCache::get(const TipsetKey &key) {
+    std::lock_guard lock{mutex_};
+    if (auto tipset{cache_.get(key)}) {
+      ++hits_;
+      return *tipset;
+    }
+    ++misses_;
+    return nullptr;
+  }
+
+  void TipsetCache::put(const TipsetCPtr &tipset) {
+    std::lock_guard lock{mutex_};
+    cache_.put(tipset->key, tipset, 1);
+  }
+
+  outcome::result<TipsetCPtr> TipsetCache::load(Ipld &ipld,
+                                                const TipsetKey &key) {
+    if (auto tipset{get(key)}) {
+      return std::move(tipset);
+    }
+    OUTCOME_TRY(tipset, Tipset::load(ipld, key.cids()));
+    put(tipset);
+    return std::move(tipset);
+  }
+
+  outcome::result<TipsetCPtr> TipsetCache::loadParent(Ipld &ipld,
+                                                      const Tipset &tipset) {
+    return load(ipld, tipset.getParents());
+  }
+
+  TipsetCache::Stats TipsetCache::stats() const {
+    std::lock_guard lock{mutex_};
+    return {hits_, misses_, cache_.size()};
+  }
+
+  void TipsetCache::clear() {
+    std::lock_guard lock{mutex_};
+    cache_.clear();
+    hits_ = 0;
+    misses_ = 0;
+  }
+}  // namespace fc::primitives::tipset
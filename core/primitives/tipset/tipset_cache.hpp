@@ -0,0 +1,59 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "common/lru_cache.hpp"
+#include "common/memory_budget.hpp"
+#include "primitives/tipset/tipset.hpp"
+
+namespace fc::primitives::tipset {
+  /**
+   * Bounded cache of decoded tipsets by key.
+   * Tipsets are immutable, so cache may be shared by components loading
+   * recent tipsets from same ipld (sync, api, chain indices).
+   * Cache is limited by memory budget, tipset is assumed to take
+   * kTipsetBytes.
+   * Thread-safe.
+   */
+  class TipsetCache {
+   public:
+    struct Stats {
+      size_t hits{};
+      size_t misses{};
+      size_t size{};
+    };
+
+    static constexpr size_t kDefaultMaxTipsets{2048};
+    /// Estimated memory of decoded tipset with several blocks
+    static constexpr size_t kTipsetBytes{8 << 10};
+
+    explicit TipsetCache(size_t max_tipsets = kDefaultMaxTipsets);
+
+    /// Get cached tipset, counts hit or miss
+    TipsetCPtr get(const TipsetKey &key);
+
+    void put(const TipsetCPtr &tipset);
+
+    /// Get cached tipset or load it from ipld
+    outcome::result<TipsetCPtr> load(Ipld &ipld, const TipsetKey &key);
+
+    outcome::result<TipsetCPtr> loadParent(Ipld &ipld, const Tipset &tipset);
+
+    Stats stats() const;
+
+    void clear();
+
+   private:
+    mutable std::mutex mutex_;
+    common::LruCache<TipsetKey, TipsetCPtr> cache_;
+    size_t hits_{};
+    size_t misses_{};
+    /// Last member, unregistered before cache is destroyed
+    std::unique_ptr<common::MemoryBudget::Registration> budget_;
+  };
+}  // namespace fc::primitives::tipset
@@ -8,6 +8,7 @@
 #include "primitives/tipset/tipset_key.hpp"
 
 #include "crypto/blake2/blake2b160.hpp"
+#include "primitives/cid/compact_cid.hpp"
 
 namespace fc::primitives::tipset {
 
@@ -22,6 +23,12 @@ namespace fc::primitives::tipset {
       return ones;
     }
 
+    size_t hashPrefix(const TipsetHash &hash) {
+      size_t h;
+      memcpy(&h, hash.data(), sizeof(size_t));
+      return h;
+    }
+
   }  // namespace
 
   TipsetHash TipsetKey::hash(const std::vector<CID> &cids) {
@@ -44,11 +51,8 @@ namespace fc::primitives::tipset {
       });
     }
 
-    std::vector<uint8_t> bytes;
     for (size_t i = 0; i < sz; ++i) {
-      // TODO: may manually hash cid parts to avoid exceptions
-      bytes = cids[indices[i]].toBytes().value();
-      ctx.update(bytes);
+      ctx.update(CompactCid{cids[indices[i]]}.bytes());
     }
 
     TipsetHash hash;
@@ -58,17 +62,18 @@ namespace fc::primitives::tipset {
     return hash;
   }
 
-  TipsetKey::TipsetKey() : hash_(emptyTipsetHash()) {}
+  TipsetKey::TipsetKey()
+      : hash_(emptyTipsetHash()), short_hash_{hashPrefix(hash_)} {}
 
   TipsetKey::TipsetKey(std::vector<CID> c)
-      : hash_{hash(c)}, cids_{std::move(c)} {}
+      : hash_{hash(c)}, short_hash_{hashPrefix(hash_)}, cids_{std::move(c)} {}
 
   bool TipsetKey::operator==(const TipsetKey &rhs) const {
-    return hash_ == rhs.hash_;
+    return short_hash_ == rhs.short_hash_ && hash_ == rhs.hash_;
   }
 
   bool TipsetKey::operator!=(const TipsetKey &rhs) const {
-    return hash_ != rhs.hash_;
+    return !(*this == rhs);
   }
 
   bool TipsetKey::operator<(const TipsetKey &rhs) const {
@@ -91,12 +96,3 @@ namespace fc::primitives::tipset {
     return fmt::format("{{{}}}", fmt::join(cids_, ","));
   }
 }  // namespace fc::primitives::tipset
-
-namespace std {
-  size_t hash<fc::TipsetKey>::operator()(
-      const fc::TipsetKey &x) const {
-    size_t h;
-    memcpy(&h, x.hash().data(), sizeof(size_t));
-    return h;
-  }
-}  // namespace std
@@ -27,6 +27,11 @@ namespace fc::primitives::tipset {
 
     const TipsetHash &hash() const;
 
+    /// Prefix of hash, compared first and used by std::hash
+    inline size_t shortHash() const {
+      return short_hash_;
+    }
+
     /// Returns hash string representaion
     std::string toString() const;
 
@@ -35,6 +40,7 @@ namespace fc::primitives::tipset {
 
    private:
     TipsetHash hash_;
+    size_t short_hash_{};
     std::vector<CID> cids_;
   };
 
@@ -47,7 +53,9 @@ namespace fc {
 namespace std {
   template <>
   struct hash<fc::TipsetKey> {
-    size_t operator()(const fc::TipsetKey &x) const;
+    size_t operator()(const fc::TipsetKey &x) const {
+      return x.shortHash();
+    }
   };
 }  // namespace std
 
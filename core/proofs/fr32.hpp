@@ -0,0 +1,27 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <gsl/span>
+
+namespace fc::proofs::fr32 {
+  /// Unpadded bytes in one fr32 block
+  constexpr size_t kUnpaddedBlock{127};
+  /// Padded bytes in one fr32 block, four 254 bit field elements
+  constexpr size_t kPaddedBlock{128};
+
+  /**
+   * Inserts two zero bits after each 254 bits of input.
+   * Processes out.size() / 128 blocks, in must have 127 bytes per block.
+   */
+  void pad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out);
+
+  /**
+   * Removes two high bits of each 256 bit field element.
+   * Processes in.size() / 128 blocks, out must have 127 bytes per block.
+   */
+  void unpad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out);
+}  // namespace fc::proofs::fr32
@@ -0,0 +1,96 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "proofs/fr32.hpp"
+
+#include <boost/endian/conversion.hpp>
+#include <cstring>
+
+#include <boost/assert.hpp>
+
+namespace fc::proofs::fr32 {
+  /*
+   * Block is handled as 16 little-endian 64 bit words.
+   * Field element q occupies bits [254 * q, 254 * q + 254) of unpadded block,
+   * i.e. starts at word 254 * q / 64 with shift 254 * q % 64, and 4 words
+   * (256 bits with 2 high bits zero) of padded block.
+   * Word shifts replace per byte shuffling and let compiler vectorize
+   * loops over words.
+   */
+  constexpr size_t kWords{kPaddedBlock / 8};
+  constexpr uint64_t kHighMask{~uint64_t{0} >> 2};
+  using Words = uint64_t[kWords];
+
+  inline void load(Words &words, const uint8_t *bytes, size_t size) {
+    words[kWords - 1] = 0;
+    std::memcpy(words, bytes, size);
+    for (auto &word : words) {
+      word = boost::endian::little_to_native(word);
+    }
+  }
+
+  inline void store(uint8_t *bytes, Words &words, size_t size) {
+    for (auto &word : words) {
+      word = boost::endian::native_to_little(word);
+    }
+    std::memcpy(bytes, words, size);
+  }
+
+  inline void padBlock(const uint8_t *in, uint8_t *out) {
+    Words w, p;
+    load(w, in, kUnpaddedBlock);
+    for (size_t i{0}; i < 4; ++i) {
+      p[i] = w[i];
+    }
+    p[3] &= kHighMask;
+    for (size_t q{1}; q < 4; ++q) {
+      auto bit{254 * q}, k{bit / 64}, r{bit % 64};
+      for (size_t i{0}; i < 4; ++i) {
+        p[4 * q + i] = (w[k + i] >> r) | (w[k + i + 1] << (64 - r));
+      }
+      p[4 * q + 3] &= kHighMask;
+    }
+    store(out, p, kPaddedBlock);
+  }
+
+  inline void unpadBlock(const uint8_t *in, uint8_t *out) {
+    Words p, w{};
+    load(p, in, kPaddedBlock);
+    for (size_t i{0}; i < 4; ++i) {
+      w[i] = p[i];
+    }
+    w[3] &= kHighMask;
+    for (size_t q{1}; q < 4; ++q) {
+      auto bit{254 * q}, k{bit / 64}, r{bit % 64};
+      for (size_t i{0}; i < 4; ++i) {
+        auto word{p[4 * q + i]};
+        if (i == 3) {
+          word &= kHighMask;
+        }
+        w[k + i] |= word << r;
+        if (k + i + 1 < kWords) {
+          w[k + i + 1] |= word >> (64 - r);
+        }
+      }
+    }
+    store(out, w, kUnpaddedBlock);
+  }
+
+  void pad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out) {
+    auto blocks{static_cast<size_t>(out.size()) / kPaddedBlock};
+    BOOST_ASSERT(static_cast<size_t>(in.size()) >= blocks * kUnpaddedBlock);
+    for (size_t i{0}; i < blocks; ++i) {
+      padBlock(in.data() + i * kUnpaddedBlock, out.data() + i * kPaddedBlock);
+    }
+  }
+
+  void unpad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out) {
+    auto blocks{static_cast<size_t>(in.size()) / kPaddedBlock};
+    BOOST_ASSERT(static_cast<size_t>(out.size()) >= blocks * kUnpaddedBlock);
+    for (size_t i{0}; i < blocks; ++i) {
+      unpadBlock(in.data() + i * kPaddedBlock, out.data() + i * kUnpaddedBlock);
+    }
+  }
+}  // namespace fc::proofs::fr32
@@ -6,8 +6,10 @@
 #include "proofs/proof_param_provider.hpp"
 
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <regex>
+#include <sstream>
 #include <string>
 #include <thread>
 
@@ -16,6 +18,7 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
+#include "common/hexutil.hpp"
 #include "common/outcome.hpp"
 #include "crypto/blake2/blake2b160.hpp"
 #include "proofs/proof_param_provider_error.hpp"
@@ -25,81 +28,206 @@ namespace fc::proofs {
   common::Logger ProofParamProvider::logger_ =
       common::createLogger("proofs params");
 
-  bool ProofParamProvider::errors_ = false;
-
-  auto write_data(void *ptr, size_t size, size_t nmemb, void *stream) {
-    return fwrite(ptr, size, nmemb, (FILE *)stream);
-  }
+  std::atomic_bool ProofParamProvider::errors_{false};
 
   auto const default_gateway = "https://ipfs.io/ipfs/";
   auto const param_dir = "/var/tmp/filecoin-proof-parameters";
   auto const dir_env = "FIL_PROOFS_PARAMETER_CACHE";
 
-  outcome::result<void> ProofParamProvider::doFetch(const std::string &out,
-                                                    const ParamFile &info) {
-    try {
-      /* init the curl session */
-      auto curl_handle = curl_easy_init();
-
-      std::string gateway = default_gateway;
-      if (auto custom_gateway = std::getenv("IPFS_GATEWAY")) {
-        gateway = custom_gateway;
+  /// Bytes requested by one range request
+  constexpr uint64_t kChunkSize{uint64_t{256} << 20};
+  /// Attempts of each gateway per chunk
+  constexpr int kChunkRetries{3};
+  /// Digest length kept in parameters.json
+  constexpr size_t kDigestBytes{16};
+
+  namespace fs = boost::filesystem;
+  using crypto::blake2b::BLAKE2B512_HASH_LENGTH;
+
+  /// Gateways from comma-separated IPFS_GATEWAY, tried in order
+  std::vector<std::string> gateways() {
+    std::vector<std::string> result;
+    std::string list = default_gateway;
+    if (auto custom_gateway = std::getenv("IPFS_GATEWAY")) {
+      list = custom_gateway;
+    }
+    std::stringstream stream{list};
+    std::string gateway;
+    while (std::getline(stream, gateway, ',')) {
+      if (gateway.empty()) {
+        continue;
       }
-
       if (gateway[gateway.size() - 1] != '/') {
         gateway += "/";
       }
+      result.push_back(gateway);
+    }
+    return result;
+  }
 
-      gateway += info.cid;
-
-      /* set URL to get here */
-      curl_easy_setopt(curl_handle, CURLOPT_URL, gateway.c_str());
-
-      /* Switch off full protocol/debug output while testing, set to 1L to
-       * enable it */
-      curl_easy_setopt(curl_handle, CURLOPT_VERBOSE, 0L);
-
-      /* enable progress meter, set to 1L to disable it */
-      curl_easy_setopt(curl_handle, CURLOPT_NOPROGRESS, 0L);
-
-      /* send all data to this function  */
-      curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, write_data);
-
-      boost::uintmax_t f_size = boost::filesystem::exists(out)
-                                    ? boost::filesystem::file_size(out)
-                                    : 0;
+  std::string hexDigest(crypto::blake2b::Ctx &ctx) {
+    crypto::blake2b::Blake2b512Hash sum;
+    ctx.final(sum);
+    return common::hex_lower(gsl::make_span(sum).subspan(0, kDigestBytes));
+  }
 
-      struct curl_slist *chunk = NULL;
+  /// Hashes whole file in big blocks
+  bool hashFile(const std::string &path, crypto::blake2b::Ctx &ctx) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+      return false;
+    }
+    std::vector<char> block(4 << 20);
+    while (ifs.read(block.data(), block.size()) || ifs.gcount() > 0) {
+      ctx.update({reinterpret_cast<const uint8_t *>(block.data()),
+                  static_cast<ptrdiff_t>(ifs.gcount())});
+    }
+    return true;
+  }
 
-      std::string header = "Range: bytes=" + std::to_string(f_size) + "-";
+  /**
+   * Sidecar with digest of verified file, "<size> <mtime> <digest>".
+   * Valid while size and modification time of file are same.
+   */
+  std::string digestPath(const std::string &path) {
+    return path + ".digest";
+  }
 
-      chunk = curl_slist_append(chunk, header.c_str());
+  std::string sidecarLine(const std::string &path, const std::string &digest) {
+    boost::system::error_code ec;
+    auto size = fs::file_size(path, ec);
+    auto mtime = fs::last_write_time(path, ec);
+    return std::to_string(size) + " " + std::to_string(mtime) + " " + digest;
+  }
 
-      curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, chunk);
+  void writeDigest(const std::string &path, const std::string &digest) {
+    std::ofstream ofs(digestPath(path), std::ios::trunc);
+    ofs << sidecarLine(path, digest);
+  }
 
-      /* open the file */
-      auto pagefile = fopen(out.c_str(), "ab");
-      if (pagefile) {
-        /* write the page body to this file handle */
-        curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, pagefile);
+  bool cachedDigest(const std::string &path, const std::string &digest) {
+    std::ifstream ifs(digestPath(path));
+    std::string line;
+    if (!ifs.is_open() || !std::getline(ifs, line)) {
+      return false;
+    }
+    return line == sidecarLine(path, digest);
+  }
 
-        /* get it! */
-        curl_easy_perform(curl_handle);
+  struct Sink {
+    CURL *curl;
+    FILE *file;
+    crypto::blake2b::Ctx *ctx;
+    uint64_t offset;
+    uint64_t written{};
+  };
+
+  size_t writeSink(char *ptr, size_t size, size_t nmemb, void *arg) {
+    auto &sink = *static_cast<Sink *>(arg);
+    long code{};
+    curl_easy_getinfo(sink.curl, CURLINFO_RESPONSE_CODE, &code);
+    if (sink.offset != 0 && code != 206) {
+      // server ignored range, data doesn't continue file
+      return 0;
+    }
+    auto n = size * nmemb;
+    if (fwrite(ptr, 1, n, sink.file) != n) {
+      return 0;
+    }
+    sink.ctx->update({reinterpret_cast<const uint8_t *>(ptr),
+                      static_cast<ptrdiff_t>(n)});
+    sink.written += n;
+    return n;
+  }
 
-        /* close the header file */
-        fclose(pagefile);
+  outcome::result<std::string> ProofParamProvider::doFetch(
+      const std::string &out, const ParamFile &info) {
+    auto urls = gateways();
+    if (urls.empty()) {
+      return ProofParamProviderError::kInvalidURL;
+    }
+    auto part = out + ".part";
+
+    // resume: hash data downloaded before
+    crypto::blake2b::Ctx ctx{BLAKE2B512_HASH_LENGTH};
+    uint64_t offset = 0;
+    boost::system::error_code ec;
+    if (fs::exists(part, ec)) {
+      if (!hashFile(part, ctx)) {
+        return ProofParamProviderError::kFileDoesNotOpen;
       }
+      offset = fs::file_size(part, ec);
+      logger_->info(info.name + " resumed at " + std::to_string(offset));
+    }
 
-      /* cleanup curl stuff */
-      curl_easy_cleanup(curl_handle);
+    auto file = fopen(part.c_str(), "ab");
+    if (!file) {
+      return ProofParamProviderError::kFileDoesNotOpen;
+    }
+    auto curl = curl_easy_init();
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeSink);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L);
+
+    bool done = false;
+    while (!done) {
+      bool progress = false;
+      for (int attempt = 0; attempt < kChunkRetries && !progress && !done;
+           ++attempt) {
+        for (const auto &gateway : urls) {
+          auto url = gateway + info.cid;
+          auto range = std::to_string(offset) + "-"
+                       + std::to_string(offset + kChunkSize - 1);
+          Sink sink{curl, file, &ctx, offset};
+          curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+          curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+          curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
+          auto code = curl_easy_perform(curl);
+          long status{};
+          curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+          offset += sink.written;
+          if (code == CURLE_OK) {
+            // short or whole-file response is the end of file
+            done = status != 206 || sink.written < kChunkSize;
+            progress = true;
+            break;
+          }
+          if (status == 416 && offset != 0) {
+            // previous chunk ended exactly at the end of file
+            done = true;
+            break;
+          }
+          if (sink.written != 0) {
+            // rest of chunk is requested from same offset again
+            progress = true;
+            break;
+          }
+          logger_->warn(info.name + ": " + url + ": "
+                        + curl_easy_strerror(code));
+        }
+      }
+      if (!progress && !done) {
+        break;
+      }
+    }
 
-      curl_slist_free_all(chunk);
+    curl_easy_cleanup(curl);
+    if (fclose(file) != 0 || !done) {
+      return ProofParamProviderError::kFailedDownloadingFile;
+    }
 
-    } catch (std::exception const &e) {
-      logger_->error("Error: " + std::string(e.what()));
-      return ProofParamProviderError::kFailedDownloading;
+    auto digest = hexDigest(ctx);
+    if (digest != info.digest) {
+      fs::remove(part, ec);
+      return ProofParamProviderError::kChecksumMismatch;
     }
-    return outcome::success();
+    fs::rename(part, out, ec);
+    if (ec.failed()) {
+      return ProofParamProviderError::kFailedDownloadingFile;
+    }
+    writeDigest(out, digest);
+    return digest;
   }
 
   std::string getParamDir() {
@@ -138,6 +266,7 @@ namespace fc::proofs {
     return ProofParamProviderError::kFailedDownloading;
   }
 
+  /// Verifies file, using digest sidecar if file didn't change since last check
   outcome::result<void> checkFile(const std::string &path,
                                   const ParamFile &info) {
     char *res = std::getenv("TRUST_PARAMS");
@@ -146,16 +275,25 @@ namespace fc::proofs {
       return outcome::success();
     }
 
-    std::ifstream ifs(path, std::ios::binary);
+    boost::system::error_code ec;
+    if (!fs::exists(path, ec)) {
+      return ProofParamProviderError::kFileDoesNotOpen;
+    }
 
-    if (!ifs.is_open()) return ProofParamProviderError::kFileDoesNotOpen;
+    if (cachedDigest(path, info.digest)) {
+      return outcome::success();
+    }
 
-    auto sum = crypto::blake2b::blake2b_512_from_file(ifs);
+    crypto::blake2b::Ctx ctx{BLAKE2B512_HASH_LENGTH};
+    if (!hashFile(path, ctx)) {
+      return ProofParamProviderError::kFileDoesNotOpen;
+    }
 
-    auto our_some = common::hex_lower(gsl::make_span(sum).subspan(0, 16));
-    if (our_some != info.digest) {
+    auto digest = hexDigest(ctx);
+    if (digest != info.digest) {
       return ProofParamProviderError::kChecksumMismatch;
     }
+    writeDigest(path, digest);
 
     return outcome::success();
   }
@@ -172,26 +310,15 @@ namespace fc::proofs {
     }
     if (boost::filesystem::exists(path)) {
       logger_->warn(res.error().message());
+      boost::system::error_code ec;
+      boost::filesystem::remove(path, ec);
     }
 
-    static std::mutex mutex;
-    std::lock_guard<std::mutex> lock(mutex);
-
     auto fetch_res = doFetch(path.string(), info);
 
     if (fetch_res.has_error()) {
       errors_ = true;
-      logger_->error(res.error().message());
-
-      return;
-    }
-
-    res = checkFile(path.string(), info);
-
-    if (res.has_error()) {
-      errors_ = true;
-      logger_->error(res.error().message());
-      boost::filesystem::remove(path);
+      logger_->error(info.name + ": " + fetch_res.error().message());
 
       return;
     }
@@ -11,104 +11,14 @@
 #include <boost/filesystem.hpp>
 #include "common/bitsutil.hpp"
 #include "common/ffi.hpp"
+#include "common/tracing.hpp"
 #include "primitives/address/address.hpp"
 #include "primitives/address/address_codec.hpp"
 #include "primitives/cid/comm_cid.hpp"
+#include "proofs/fr32.hpp"
 #include "proofs/proofs_error.hpp"
 #include "sector_storage/zerocomm/zerocomm.hpp"
 
-namespace {
-  void unpad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out) {
-    auto chunks = in.size() / 128;
-    for (auto chunk = 0; chunk < chunks; chunk++) {
-      auto input_offset_next = chunk * 128 + 1;
-      auto output_offset = chunk * 127;
-
-      auto current = in[chunk * 128];
-
-      for (size_t i = 0; i < 32; i++) {
-        out[output_offset + i] = current;
-
-        current = in[i + input_offset_next];
-      }
-
-      out[output_offset + 31] |= current << 6;
-
-      for (size_t i = 32; i < 64; i++) {
-        auto next = in[i + input_offset_next];
-
-        out[output_offset + i] = current >> 2;
-        out[output_offset + i] |= next << 6;
-
-        current = next;
-      }
-
-      out[output_offset + 63] ^= (current << 6) ^ (current << 4);
-
-      for (size_t i = 64; i < 96; i++) {
-        auto next = in[i + input_offset_next];
-
-        out[output_offset + i] = current >> 4;
-        out[output_offset + i] |= next << 4;
-
-        current = next;
-      }
-
-      out[output_offset + 95] ^= (current << 4) ^ (current << 2);
-
-      for (size_t i = 96; i < 127; i++) {
-        auto next = in[i + input_offset_next];
-
-        out[output_offset + i] = current >> 6;
-        out[output_offset + i] |= next << 2;
-
-        current = next;
-      }
-    }
-  }
-
-  void pad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out) {
-    auto chunks = out.size() / 128;
-    for (auto chunk = 0; chunk < chunks; chunk++) {
-      size_t input_offset = chunk * 127;
-      size_t output_offset = chunk * 128;
-
-      std::copy(in.begin() + input_offset,
-                in.begin() + input_offset + 31,
-                out.begin() + output_offset);
-
-      auto t = in[input_offset + 31] >> 6;
-      out[output_offset + 31] = in[input_offset + 31] & 0x3f;
-      uint8_t v;
-
-      for (int i = 32; i < 64; i++) {
-        v = in[input_offset + i];
-        out[output_offset + i] = (v << 2) | t;
-        t = v >> 6;
-      }
-
-      t = v >> 4;
-      out[output_offset + 63] &= 0x3f;
-
-      for (size_t i = 64; i < 96; i++) {
-        v = in[input_offset + i];
-        out[output_offset + i] = (v << 4) | t;
-        t = v >> 4;
-      }
-
-      t = v >> 2;
-      out[output_offset + 95] &= 0x3f;
-
-      for (size_t i = 96; i < 127; i++) {
-        v = in[input_offset + i];
-        out[output_offset + i] = (v << 6) | t;
-        t = v >> 2;
-      }
-
-      out[output_offset + 127] = t & 0x3f;
-    }
-  }
-}  // namespace
 
 namespace fc::proofs {
   namespace ffi = common::ffi;
@@ -131,7 +41,9 @@ namespace fc::proofs {
   using primitives::sector::getRegisteredWinningPoStProof;
   using primitives::sector::RegisteredSealProof;
   using primitives::sector::SectorId;
+  using sector_storage::zerocomm::getZeroCommitment;
   using sector_storage::zerocomm::getZeroPieceCommitment;
+  using sector_storage::zerocomm::isZeroPiece;
 
   // ******************
   // TO CPP CASTED FUNCTIONS
@@ -513,6 +425,8 @@ namespace fc::proofs {
   }
 
   outcome::result<bool> Proofs::verifySeal(const SealVerifyInfo &info) {
+    common::tracing::Span span{"proofs.verifySeal"};
+    span.attribute("sector", std::to_string(info.sector.sector));
     OUTCOME_TRY(c_proof_type, cRegisteredSealProof(info.seal_proof));
 
     OUTCOME_TRY(comm_r, CIDToReplicaCommitmentV1(info.sealed_cid));
@@ -550,6 +464,7 @@ namespace fc::proofs {
       ActorId miner_id,
       const SortedPrivateSectorInfo &private_replica_info,
       const PoStRandomness &randomness) {
+    common::tracing::Span span{"proofs.generateWinningPoSt"};
     OUTCOME_TRY(
         c_sorted_private_sector_info,
         cPrivateReplicasInfo(private_replica_info.values, PoStType::Winning));
@@ -575,6 +490,7 @@ namespace fc::proofs {
       ActorId miner_id,
       const SortedPrivateSectorInfo &private_replica_info,
       const PoStRandomness &randomness) {
+    common::tracing::Span span{"proofs.generateWindowPoSt"};
     OUTCOME_TRY(
         c_sorted_private_sector_info,
         cPrivateReplicasInfo(private_replica_info.values, PoStType::Window));
@@ -724,6 +640,8 @@ namespace fc::proofs {
       ActorId miner_id,
       const SealRandomness &ticket,
       gsl::span<const PieceInfo> pieces) {
+    common::tracing::Span span{"proofs.sealPreCommitPhase1"};
+    span.attribute("sector", std::to_string(sector_num));
     OUTCOME_TRY(c_proof_type, cRegisteredSealProof(proof_type));
 
     OUTCOME_TRY(c_pieces, cPublicPieceInfos(pieces));
@@ -758,6 +676,7 @@ namespace fc::proofs {
       gsl::span<const uint8_t> phase1_output,
       const std::string &cache_dir_path,
       const std::string &sealed_sector_path) {
+    common::tracing::Span span{"proofs.sealPreCommitPhase2"};
     auto res_ptr =
         ffi::wrap(fil_seal_pre_commit_phase2(phase1_output.data(),
                                              phase1_output.size(),
@@ -795,6 +714,8 @@ namespace fc::proofs {
       const Ticket &ticket,
       const Seed &seed,
       gsl::span<const PieceInfo> pieces) {
+    common::tracing::Span span{"proofs.sealCommitPhase1"};
+    span.attribute("sector", std::to_string(sector_num));
     OUTCOME_TRY(c_proof_type, cRegisteredSealProof(proof_type));
 
     OUTCOME_TRY(c_pieces, cPublicPieceInfos(pieces));
@@ -833,6 +754,8 @@ namespace fc::proofs {
       gsl::span<const uint8_t> phase1_output,
       SectorNumber sector_id,
       ActorId miner_id) {
+    common::tracing::Span span{"proofs.sealCommitPhase2"};
+    span.attribute("sector", std::to_string(sector_id));
     auto prover_id = toProverID(miner_id);
     auto res_ptr = ffi::wrap(
         fil_seal_commit_phase2(
@@ -855,6 +778,8 @@ namespace fc::proofs {
                                        ActorId miner_id,
                                        const Ticket &ticket,
                                        const UnsealedCID &unsealed_cid) {
+    common::tracing::Span span{"proofs.unseal"};
+    span.attribute("sector", std::to_string(sector_num));
     OUTCOME_TRY(size, primitives::sector::getSectorSize(proof_type));
     return unsealRange(proof_type,
                        cache_dir_path,
@@ -879,6 +804,8 @@ namespace fc::proofs {
       const UnsealedCID &unsealed_cid,
       uint64_t offset,
       uint64_t length) {
+    common::tracing::Span span{"proofs.unsealRange"};
+    span.attribute("sector", std::to_string(sector_num));
     OUTCOME_TRY(c_proof_type, cRegisteredSealProof(proof_type));
 
     OUTCOME_TRY(comm_d, CIDToDataCommitmentV1(unsealed_cid));
@@ -973,31 +900,32 @@ namespace fc::proofs {
 
   outcome::result<CID> Proofs::generateUnsealedCID(
       RegisteredProof proof_type, gsl::span<const PieceInfo> pieces, bool pad) {
+    common::tracing::Span span{"proofs.generateUnsealedCID"};
     std::vector<PieceInfo> padded;
     if (pad) {
       OUTCOME_TRY(_sector, primitives::sector::getSectorSize(proof_type));
       PaddedPieceSize sector{_sector};
-      if (pieces.empty()) {
-        OUTCOME_TRY(zero, getZeroPieceCommitment(sector.unpadded()));
-        padded.push_back({sector, zero});
-      } else {
-        PaddedPieceSize sum;
-        auto pad{[&](auto size) -> outcome::result<void> {
-          auto padding{GetRequiredPadding(sum, size)};
-          for (auto pad : padding.pads) {
-            OUTCOME_TRY(zero, getZeroPieceCommitment(pad.unpadded()));
-            padded.push_back({pad, zero});
-          }
-          sum += padding.size;
-          return outcome::success();
-        }};
-        for (auto &piece : pieces) {
-          OUTCOME_TRY(pad(piece.size));
-          padded.push_back(piece);
-          sum += piece.size;
+      if (std::all_of(pieces.begin(), pieces.end(), isZeroPiece)) {
+        // pledged sector is all zeros, no tree hashing needed
+        OUTCOME_TRY(zero, getZeroCommitment(sector));
+        return dataCommitmentV1ToCID(zero);
+      }
+      PaddedPieceSize sum;
+      auto pad{[&](auto size) -> outcome::result<void> {
+        auto padding{GetRequiredPadding(sum, size)};
+        for (auto pad : padding.pads) {
+          OUTCOME_TRY(zero, getZeroPieceCommitment(pad.unpadded()));
+          padded.push_back({pad, zero});
         }
-        OUTCOME_TRY(pad(sector));
+        sum += padding.size;
+        return outcome::success();
+      }};
+      for (auto &piece : pieces) {
+        OUTCOME_TRY(pad(piece.size));
+        padded.push_back(piece);
+        sum += piece.size;
       }
+      OUTCOME_TRY(pad(sector));
       pieces = padded;
     }
 
@@ -1108,31 +1036,24 @@ namespace fc::proofs {
     }
 
     uint64_t left = piece_size;
-    constexpr auto kDefaultBufferSize = uint64_t(32 * 1024);
+    constexpr auto kDefaultBufferSize = uint64_t(1 << 20);
     std::vector<uint8_t> buffer(kDefaultBufferSize);
-    auto chunks = kDefaultBufferSize / 127;
+    auto chunks = kDefaultBufferSize / 128;
     PaddedPieceSize outTwoPow =
-        primitives::piece::paddedSize(chunks * 128).padded();
+        primitives::piece::paddedSize(chunks * 127).padded();
+    std::vector<uint8_t> read(outTwoPow);
 
     while (left > 0) {
       if (left < outTwoPow.unpadded()) {
         outTwoPow = primitives::piece::paddedSize(left).padded();
       }
-      std::vector<uint8_t> read(outTwoPow);
-
-      size_t j;
-      char ch;
-      for (j = 0; j < outTwoPow && input; j++) {
-        input.get(ch);
-        read[j] = ch;
-      }
 
-      if (j != outTwoPow) {
+      if (!input.read(reinterpret_cast<char *>(read.data()), outTwoPow)) {
         return ProofsError::kNotReadEnough;
       }
 
-      unpad(gsl::make_span(read.data(), outTwoPow),
-            gsl::make_span(buffer.data(), outTwoPow.unpadded()));
+      fr32::unpad(gsl::make_span(read.data(), outTwoPow),
+                  gsl::make_span(buffer.data(), outTwoPow.unpadded()));
 
       uint64_t write_size =
           write(output.getFd(), buffer.data(), outTwoPow.unpadded());
@@ -1168,13 +1089,10 @@ namespace fc::proofs {
 
       OUTCOME_TRY(size, getSectorSize(seal_proof_type));
 
-      char ch = 0;
-      size_t i;
-      for (i = 0; i < size && ofs; i++) {
-        ofs.write(&ch, 1);
-      }
-
-      if (i != size) {
+      ofs.close();
+      boost::system::error_code ec;
+      fs::resize_file(staged_sector_file_path, size, ec);
+      if (ec) {
         return ProofsError::kNotWriteEnough;
       }
     }
@@ -1196,29 +1114,30 @@ namespace fc::proofs {
       return ProofsError::kUnableMoveCursor;
     }
 
-    std::vector<uint8_t> in(127);
-    std::vector<uint8_t> out(128);
+    // whole blocks per batch, so each read and write is one call
+    constexpr uint64_t kBatchBlocks{8 * 1024};
+    std::vector<uint8_t> in(kBatchBlocks * fr32::kUnpaddedBlock);
+    std::vector<uint8_t> out(kBatchBlocks * fr32::kPaddedBlock);
 
-    for (size_t read = 0; read < piece_size; read += 127) {
-      char ch;
-      size_t i;
-      for (i = 0; i < 127 && input; i++) {
-        input.get(ch);
-        in[i] = ch;
+    for (uint64_t left = piece_size; left > 0;) {
+      auto blocks = std::min(kBatchBlocks, left / fr32::kUnpaddedBlock);
+      auto in_size = blocks * fr32::kUnpaddedBlock;
+      auto out_size = blocks * fr32::kPaddedBlock;
+      if (blocks == 0) {
+        return ProofsError::kNotReadEnough;
       }
 
-      if (i != 127) {
+      if (!input.read(reinterpret_cast<char *>(in.data()), in_size)) {
         return ProofsError::kNotReadEnough;
       }
 
-      pad(in, out);
-      for (i = 0; i < 128 && unsealed_file; i++) {
-        ch = out[i];
-        unsealed_file.write(&ch, 1);
-      }
-      if (i != 128) {
+      fr32::pad(gsl::make_span(in.data(), in_size),
+                gsl::make_span(out.data(), out_size));
+      if (!unsealed_file.write(reinterpret_cast<const char *>(out.data()),
+                               out_size)) {
         return ProofsError::kNotWriteEnough;
       }
+      left -= in_size;
     }
 
     return outcome::success();
@@ -0,0 +1,104 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "proofs/seal_verifier.hpp"
+
+#include <boost/asio/post.hpp>
+#include <future>
+#include <thread>
+#include <unordered_map>
+
+#include "proofs/proofs.hpp"
+
+namespace fc::proofs {
+  SealVerifier::SealVerifier(size_t threads, VerifyCache &cache)
+      : pool_{std::max<size_t>(1, threads)}, cache_{cache} {}
+
+  SealVerifier::~SealVerifier() {
+    pool_.join();
+  }
+
+  std::vector<bool> SealVerifier::verifySeals(
+      gsl::span<const SealVerifyInfo> infos) {
+    std::vector<bool> results(infos.size(), false);
+    std::vector<Buffer> keys(infos.size());
+    // first index of each unverified key
+    std::unordered_map<Buffer, size_t> todo;
+    size_t cached{};
+    for (auto i{0u}; i < infos.size(); ++i) {
+      keys[i] = VerifyCache::key(VerifyKind::kSeal, infos[i]);
+      if (keys[i].empty()) {
+        continue;
+      }
+      if (auto valid{cache_.get(keys[i])}) {
+        ++cached;
+        results[i] = *valid;
+      } else {
+        todo.emplace(keys[i], i);
+      }
+    }
+    {
+      std::lock_guard lock{mutex_};
+      stats_.cached += cached;
+    }
+    if (todo.empty()) {
+      return results;
+    }
+
+    using Result = outcome::result<bool>;
+    auto verify{[&](size_t i) { return Proofs::verifySeal(infos[i]); }};
+    std::unordered_map<Buffer, bool> verified;
+    auto done{[&](const Buffer &key, const Result &valid) {
+      // errors are not cached
+      if (valid) {
+        cache_.put(key, valid.value());
+      }
+      verified.emplace(key, valid && valid.value());
+    }};
+    if (todo.size() == 1) {
+      auto &[key, i]{*todo.begin()};
+      done(key, verify(i));
+    } else {
+      std::vector<std::pair<Buffer, std::future<Result>>> futures;
+      for (auto &[key, i] : todo) {
+        std::packaged_task<Result()> task{[&verify, i{i}] {
+          return verify(i);
+        }};
+        futures.emplace_back(key, task.get_future());
+        boost::asio::post(pool_, std::move(task));
+      }
+      for (auto &[key, future] : futures) {
+        done(key, future.get());
+      }
+    }
+
+    {
+      std::lock_guard lock{mutex_};
+      stats_.verified += verified.size();
+    }
+    for (auto i{0u}; i < infos.size(); ++i) {
+      auto it{verified.find(keys[i])};
+      if (it != verified.end()) {
+        results[i] = it->second;
+      }
+    }
+    return results;
+  }
+
+  bool SealVerifier::verifySeal(const SealVerifyInfo &info) {
+    return verifySeals(gsl::make_span(&info, 1))[0];
+  }
+
+  SealVerifier::Stats SealVerifier::stats() const {
+    std::lock_guard lock{mutex_};
+    return stats_;
+  }
+
+  SealVerifier &SealVerifier::instance() {
+    static SealVerifier verifier{std::thread::hardware_concurrency(),
+                                 VerifyCache::instance()};
+    return verifier;
+  }
+}  // namespace fc::proofs
@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_PROOF_PARAM_PROVIDER_HPP
 #define CPP_FILECOIN_PROOF_PARAM_PROVIDER_HPP
 
+#include <atomic>
+
 #include "common/logger.hpp"
 #include "common/outcome.hpp"
 #include "gsl/span"
@@ -31,10 +33,16 @@ namespace fc::proofs {
 
    private:
     static void fetch(const ParamFile &info);
-    static outcome::result<void> doFetch(const std::string &out,
-                                         const ParamFile &info);
 
-    static bool errors_;
+    /**
+     * Downloads file by ranged chunks, trying gateways in order.
+     * Partial download is kept in ".part" file and resumed by next call.
+     * Data is hashed while being written, returns digest of file
+     */
+    static outcome::result<std::string> doFetch(const std::string &out,
+                                                const ParamFile &info);
+
+    static std::atomic_bool errors_;
 
     static common::Logger logger_;
   };
@@ -0,0 +1,49 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <boost/asio/thread_pool.hpp>
+#include <mutex>
+
+#include "primitives/sector/sector.hpp"
+#include "proofs/verify_cache.hpp"
+
+namespace fc::proofs {
+  using primitives::sector::SealVerifyInfo;
+
+  /**
+   * Verifies seal proofs on dedicated thread pool.
+   * Results are memoized in shared VerifyCache, so ProveCommit verified
+   * again (e.g. by other tipset or cron batch) is not recomputed.
+   */
+  class SealVerifier {
+   public:
+    struct Stats {
+      size_t verified{};
+      size_t cached{};
+    };
+
+    SealVerifier(size_t threads, VerifyCache &cache);
+
+    ~SealVerifier();
+
+    /// Verifies seals in parallel, failed verification is false
+    std::vector<bool> verifySeals(gsl::span<const SealVerifyInfo> infos);
+
+    bool verifySeal(const SealVerifyInfo &info);
+
+    Stats stats() const;
+
+    /// Shared verifier with thread per core
+    static SealVerifier &instance();
+
+   private:
+    boost::asio::thread_pool pool_;
+    VerifyCache &cache_;
+    mutable std::mutex mutex_;
+    Stats stats_;
+  };
+}  // namespace fc::proofs
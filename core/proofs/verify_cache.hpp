@@ -0,0 +1,85 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "codec/cbor/cbor.hpp"
+#include "common/buffer.hpp"
+#include "common/lru_cache.hpp"
+#include "crypto/blake2/blake2b160.hpp"
+
+namespace fc::proofs {
+  using common::Buffer;
+
+  /// Kind of verified proof, part of cache key
+  enum class VerifyKind : uint8_t {
+    kSeal,
+    kWindowPoSt,
+  };
+
+  /**
+   * Bounded cache of proof verification results, shared by mpool, block
+   * validation and execution. Key is hash of encoded verify info, which
+   * includes proof bytes. Errors are not cached.
+   */
+  class VerifyCache {
+   public:
+    explicit VerifyCache(size_t max_entries) : cache_{max_entries} {}
+
+    /// Returns empty key if info can't be encoded
+    template <typename T>
+    static Buffer key(VerifyKind kind, const T &info) {
+      auto encoded{codec::cbor::encode(info)};
+      if (!encoded) {
+        return {};
+      }
+      auto &bytes{encoded.value()};
+      bytes.putUint8(static_cast<uint8_t>(kind));
+      return Buffer{crypto::blake2b::blake2b_256(bytes)};
+    }
+
+    boost::optional<bool> get(const Buffer &key) {
+      if (key.empty()) {
+        return boost::none;
+      }
+      std::lock_guard lock{mutex_};
+      return cache_.get(key);
+    }
+
+    void put(const Buffer &key, bool valid) {
+      if (key.empty()) {
+        return;
+      }
+      std::lock_guard lock{mutex_};
+      cache_.put(key, valid, 1);
+    }
+
+    /// Get cached result or verify with f
+    template <typename T, typename F>
+    outcome::result<bool> verify(VerifyKind kind, const T &info, const F &f) {
+      auto _key{key(kind, info)};
+      if (auto cached{get(_key)}) {
+        return *cached;
+      }
+      OUTCOME_TRY(valid, f(info));
+      put(_key, valid);
+      return valid;
+    }
+
+    /// Shared by all proof verification callers
+    static VerifyCache &instance() {
+      static VerifyCache cache{kMaxEntries};
+      return cache;
+    }
+
+    static constexpr size_t kMaxEntries{16384};
+
+   private:
+    std::mutex mutex_;
+    common::LruCache<Buffer, bool> cache_;
+  };
+}  // namespace fc::proofs
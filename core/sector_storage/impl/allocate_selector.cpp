@@ -43,6 +43,12 @@ namespace fc::sector_storage {
       const TaskType &task,
       const std::shared_ptr<WorkerHandle> &challenger,
       const std::shared_ptr<WorkerHandle> &current_best) {
+    if (locality_) {
+      OUTCOME_TRY(local, locality_->isPreferred(challenger, current_best));
+      if (local) {
+        return *local;
+      }
+    }
     return challenger->active.utilization(challenger->info.resources)
            < current_best->active.utilization(current_best->info.resources);
   }
@@ -54,4 +60,13 @@ namespace fc::sector_storage {
         allocate_(allocate),
         path_type_(path_type) {}
 
+  AllocateSelector::AllocateSelector(std::shared_ptr<stores::SectorIndex> index,
+                                     SectorFileType allocate,
+                                     PathType path_type,
+                                     SectorId sector,
+                                     SectorFileType existing)
+      : AllocateSelector(index, allocate, path_type) {
+    locality_.emplace(sector_index_, sector, existing);
+  }
+
 }  // namespace fc::sector_storage
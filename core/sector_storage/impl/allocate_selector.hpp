@@ -8,6 +8,7 @@
 
 #include "sector_storage/selector.hpp"
 
+#include "sector_storage/impl/sector_locality.hpp"
 #include "sector_storage/stores/index.hpp"
 
 namespace fc::sector_storage {
@@ -17,6 +18,13 @@ namespace fc::sector_storage {
                      SectorFileType allocate,
                      PathType path_type);
 
+    /// Prefers workers which have existing files of sector locally
+    AllocateSelector(std::shared_ptr<stores::SectorIndex> index,
+                     SectorFileType allocate,
+                     PathType path_type,
+                     SectorId sector,
+                     SectorFileType existing);
+
     outcome::result<bool> is_satisfying(
         const TaskType &task,
         RegisteredProof seal_proof_type,
@@ -31,6 +39,7 @@ namespace fc::sector_storage {
     std::shared_ptr<stores::SectorIndex> sector_index_;
     SectorFileType allocate_;
     PathType path_type_;
+    boost::optional<SectorLocality> locality_;
   };
 }  // namespace fc::sector_storage
 
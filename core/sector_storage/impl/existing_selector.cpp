@@ -45,6 +45,10 @@ namespace fc::sector_storage {
       const TaskType &task,
       const std::shared_ptr<WorkerHandle> &challenger,
       const std::shared_ptr<WorkerHandle> &current_best) {
+    OUTCOME_TRY(local, locality_.isPreferred(challenger, current_best));
+    if (local) {
+      return *local;
+    }
     return challenger->active.utilization(challenger->info.resources)
            < current_best->active.utilization(current_best->info.resources);
   }
@@ -56,5 +60,6 @@ namespace fc::sector_storage {
       : index_(std::move(index)),
         sector_(sector),
         allocate_(allocate),
-        allow_fetch_(allow_fetch) {}
+        allow_fetch_(allow_fetch),
+        locality_(index_, sector, allocate) {}
 }  // namespace fc::sector_storage
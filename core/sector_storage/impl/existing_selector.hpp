@@ -8,9 +8,12 @@
 
 #include "sector_storage/selector.hpp"
 
+#include "sector_storage/impl/sector_locality.hpp"
 #include "sector_storage/stores/index.hpp"
 
 namespace fc::sector_storage {
+  /// Workers which have or can fetch sector files, ones with more local
+  /// files are preferred
   class ExistingSelector : public WorkerSelector {
    public:
     ExistingSelector(std::shared_ptr<stores::SectorIndex> index,
@@ -33,6 +36,7 @@ namespace fc::sector_storage {
     SectorId sector_;
     SectorFileType allocate_;
     bool allow_fetch_;
+    SectorLocality locality_;
   };
 }  // namespace fc::sector_storage
 
@@ -11,16 +11,31 @@
 #include <sys/sysctl.h>
 #endif
 
+#include <sys/stat.h>
 #include <boost/asio.hpp>
 #include <boost/filesystem.hpp>
 #include <thread>
 #include "proofs/proofs.hpp"
 #include "sector_storage/stores/store_error.hpp"
+#include "sector_storage/zerocomm/zerocomm.hpp"
 
 namespace fc::sector_storage {
 
   using primitives::piece::PaddedPieceSize;
   using proofs::PieceData;
+  using zerocomm::getZeroPieceCommitment;
+
+  namespace {
+    /// Piece data is read from /dev/zero, e.g. pledge piece
+    bool isZeroData(const PieceData &data) {
+      struct stat data_stat {};
+      struct stat zero_stat {};
+      return fstat(data.getFd(), &data_stat) == 0
+             && S_ISCHR(data_stat.st_mode)
+             && stat("/dev/zero", &zero_stat) == 0
+             && data_stat.st_rdev == zero_stat.st_rdev;
+    }
+  }  // namespace
 
   outcome::result<LocalWorker::Response> LocalWorker::acquireSector(
       SectorId sector_id,
@@ -215,7 +230,26 @@ namespace fc::sector_storage {
                                 PathType::kSealing));
       auto _ = gsl::finally([&]() { response.release_function(); });
 
-      OUTCOME_TRY(proofs::Proofs::clearCache(size, response.paths.cache));
+      // same files as clearCache removes, but in background
+      std::vector<std::string> remove;
+      boost::system::error_code ec;
+      for (boost::filesystem::directory_iterator it{response.paths.cache, ec},
+           end;
+           !ec && it != end;
+           it.increment(ec)) {
+        auto name{it->path().filename().string()};
+        if (name != "p_aux" && name != "t_aux"
+            && name.find("tree-r-last") == std::string::npos) {
+          remove.push_back(it->path().string());
+        }
+      }
+      auto local{remote_store_->getLocalStore()};
+      for (const auto &path : remove) {
+        if (!local->trash(path)) {
+          OUTCOME_TRY(proofs::Proofs::clearCache(size, response.paths.cache));
+          break;
+        }
+      }
     }
 
     // TODO(artyom-yurin): [FIL-245] if keep unsealed empty
@@ -532,6 +566,10 @@ namespace fc::sector_storage {
       return WorkerErrors::kOutOfBound;
     }
 
+    if (isZeroData(piece_data)) {
+      return addZeroPiece(sector, offset, new_piece_size);
+    }
+
     if (piece_sizes.empty()) {
       OUTCOME_TRY(response,
                   acquireSector(sector,
@@ -569,4 +607,37 @@ namespace fc::sector_storage {
     return PieceInfo{.size = new_piece_size.padded(),
                      .cid = write_response.piece_cid};
   }
+
+  outcome::result<PieceInfo> sector_storage::LocalWorker::addZeroPiece(
+      const SectorId &sector,
+      const UnpaddedPieceSize &offset,
+      const UnpaddedPieceSize &new_piece_size) {
+    auto first = offset == 0;
+    OUTCOME_TRY(response,
+                acquireSector(
+                    sector,
+                    first ? SectorFileType::FTNone : SectorFileType::FTUnsealed,
+                    first ? SectorFileType::FTUnsealed : SectorFileType::FTNone,
+                    PathType::kSealing));
+    auto _ = gsl::final_action([&]() { response.release_function(); });
+
+    // zeros and zero padding are holes of sparse unsealed file
+    auto padding = proofs::Proofs::GetRequiredPadding(offset.padded(),
+                                                      new_piece_size.padded());
+    uint64_t end = offset.padded() + padding.size + new_piece_size.padded();
+    boost::system::error_code ec;
+    auto &path = response.paths.unsealed;
+    if (first || boost::filesystem::file_size(path, ec) < end) {
+      if (first) {
+        std::ofstream{path, std::ios::binary | std::ios::trunc};
+      }
+      boost::filesystem::resize_file(path, end, ec);
+      if (ec.failed()) {
+        return WorkerErrors::kCannotCreateTempFile;
+      }
+    }
+
+    OUTCOME_TRY(cid, getZeroPieceCommitment(new_piece_size));
+    return PieceInfo{.size = new_piece_size.padded(), .cid = cid};
+  }
 }  // namespace fc::sector_storage
@@ -81,6 +81,12 @@ namespace fc::sector_storage {
         const proofs::PieceData &piece_data) override;
 
    private:
+    /// Pledge piece is sparse region of unsealed file, data isn't hashed
+    outcome::result<PieceInfo> addZeroPiece(
+        const SectorId &sector,
+        const UnpaddedPieceSize &offset,
+        const UnpaddedPieceSize &new_piece_size);
+
     struct Response {
       stores::SectorPaths paths;
       std::function<void()> release_function;
@@ -6,7 +6,12 @@
 #include "sector_storage/impl/manager_impl.hpp"
 
 #include <pwd.h>
+#include <atomic>
 #include <boost/filesystem.hpp>
+#include <fstream>
+#include <future>
+#include <gsl/gsl_util>
+#include <random>
 #include <unordered_set>
 #include "sector_storage/impl/allocate_selector.hpp"
 #include "sector_storage/impl/existing_selector.hpp"
@@ -19,6 +24,10 @@ namespace fc::sector_storage {
   using fc::primitives::sector_file::sectorName;
   namespace fs = boost::filesystem;
 
+  /// Nodes of sealed file read by sector check
+  constexpr auto kSampleNodes{4};
+  constexpr size_t kNodeSize{32};
+
   fc::sector_storage::WorkerAction schedFetch(const SectorId &sector,
                                               SectorFileType file_type,
                                               PathType path_type,
@@ -88,88 +97,169 @@ namespace fc::sector_storage {
 
   outcome::result<std::vector<SectorId>> ManagerImpl::checkProvable(
       RegisteredProof seal_proof_type, gsl::span<const SectorId> sectors) {
+    OUTCOME_TRY(ssize, primitives::sector::getSectorSize(seal_proof_type));
+
+    auto now{std::chrono::steady_clock::now()};
+    std::vector<size_t> to_check;
+    {
+      std::lock_guard lock{healthy_mutex_};
+      for (size_t i{0}; i < static_cast<size_t>(sectors.size()); ++i) {
+        auto it{healthy_.find(sectors[i])};
+        if (it == healthy_.end() || now - it->second > kHealthyTtl) {
+          to_check.push_back(i);
+        }
+      }
+    }
+
+    std::vector<char> bad_flags(sectors.size(), false);
+    std::atomic<size_t> next{0};
+    std::mutex error_mutex;
+    boost::optional<std::error_code> error;
+    auto work{[&] {
+      while (true) {
+        auto j{next++};
+        if (j >= to_check.size()) {
+          return;
+        }
+        auto &sector{sectors[to_check[j]]};
+        auto ok{checkSector(seal_proof_type, ssize, sector)};
+        if (!ok) {
+          std::lock_guard lock{error_mutex};
+          error = ok.error();
+          return;
+        }
+        bad_flags[to_check[j]] = !ok.value();
+        std::lock_guard lock{healthy_mutex_};
+        if (ok.value()) {
+          healthy_[sector] = std::chrono::steady_clock::now();
+        } else {
+          healthy_.erase(sector);
+        }
+      }
+    }};
+    std::vector<std::future<void>> threads;
+    for (size_t t{1}; t < std::min(kCheckThreads, to_check.size()); ++t) {
+      threads.push_back(std::async(std::launch::async, work));
+    }
+    work();
+    for (auto &thread : threads) {
+      thread.get();
+    }
+    if (error) {
+      return *error;
+    }
+
     std::vector<SectorId> bad{};
+    for (size_t i{0}; i < bad_flags.size(); ++i) {
+      if (bad_flags[i]) {
+        bad.push_back(sectors[i]);
+      }
+    }
+    return std::move(bad);
+  }
 
-    OUTCOME_TRY(ssize, primitives::sector::getSectorSize(seal_proof_type));
+  outcome::result<bool> ManagerImpl::checkSector(
+      RegisteredProof seal_proof_type,
+      SectorSize ssize,
+      const SectorId &sector) {
+    auto locked = index_->storageTryLock(
+        sector,
+        static_cast<SectorFileType>(SectorFileType::FTSealed
+                                    | SectorFileType::FTCache),
+        SectorFileType::FTNone);
 
-    for (const auto &sector : sectors) {
-      auto locked = index_->storageTryLock(
-          sector,
-          static_cast<SectorFileType>(SectorFileType::FTSealed
-                                      | SectorFileType::FTCache),
-          SectorFileType::FTNone);
+    if (!locked) {
+      logger_->warn("can't acquire read lock for {} sector",
+                    sectorName(sector));
+      return false;
+    }
+
+    auto maybe_response = local_store_->acquireSector(
+        sector,
+        seal_proof_type,
+        static_cast<SectorFileType>(SectorFileType::FTSealed
+                                    | SectorFileType::FTCache),
+        SectorFileType::FTNone,
+        PathType::kStorage,
+        AcquireMode::kMove);
 
-      if (!locked) {
-        logger_->warn("can't acquire read lock for {} sector",
+    if (maybe_response.has_error()) {
+      if (maybe_response
+          == outcome::failure(stores::StoreErrors::kNotFoundSector)) {
+        logger_->warn("cache an/or sealed paths not found for {} sector",
                       sectorName(sector));
-        bad.push_back(sector);
-        continue;
+        return false;
       }
+      return maybe_response.error();
+    }
+    auto &paths{maybe_response.value().paths};
 
-      auto maybe_response = local_store_->acquireSector(
-          sector,
-          seal_proof_type,
-          static_cast<SectorFileType>(SectorFileType::FTSealed
-                                      | SectorFileType::FTCache),
-          SectorFileType::FTNone,
-          PathType::kStorage,
-          AcquireMode::kMove);
-
-      if (maybe_response.has_error()) {
-        if (maybe_response
-            == outcome::failure(stores::StoreErrors::kNotFoundSector)) {
-          logger_->warn("cache an/or sealed paths not found for {} sector",
-                        sectorName(sector));
-          bad.push_back(sector);
-          continue;
-        }
-        return maybe_response.error();
+    // limit concurrent checks on same storage, e.g. one hdd
+    auto &storage{maybe_response.value().storages.sealed};
+    {
+      std::unique_lock lock{storage_mutex_};
+      storage_cv_.wait(lock, [&] {
+        return storage_checks_[storage] < kStorageCheckConcurrency;
+      });
+      ++storage_checks_[storage];
+    }
+    auto release{gsl::finally([&] {
+      {
+        std::lock_guard lock{storage_mutex_};
+        --storage_checks_[storage];
       }
+      storage_cv_.notify_all();
+    })};
 
-      std::unordered_map<std::string, uint64_t> to_check = {
-          {maybe_response.value().paths.sealed, 1},
-          {(fs::path(maybe_response.value().paths.cache) / "t_aux").string(),
-           0},
-          {(fs::path(maybe_response.value().paths.cache) / "p_aux").string(),
-           0},
-      };
+    std::unordered_map<std::string, uint64_t> to_check = {
+        {paths.sealed, 1},
+        {(fs::path(paths.cache) / "t_aux").string(), 0},
+        {(fs::path(paths.cache) / "p_aux").string(), 0},
+    };
 
-      addCachePathsForSectorSize(
-          to_check, maybe_response.value().paths.cache, ssize, logger_);
+    addCachePathsForSectorSize(to_check, paths.cache, ssize, logger_);
 
-      for (const auto &[path, size] : to_check) {
-        if (!fs::exists(path)) {
-          logger_->warn(
-              "{} doesnt exist for {} sector", path, sectorName(sector));
-          bad.push_back(sector);
-          break;
+    for (const auto &[path, size] : to_check) {
+      if (!fs::exists(path)) {
+        logger_->warn("{} doesnt exist for {} sector", path, sectorName(sector));
+        return false;
+      }
+
+      if (size != 0) {
+        boost::system::error_code ec;
+        size_t actual_size = fs::file_size(path, ec);
+        if (ec.failed()) {
+          logger_->warn("sector {}. Can't get size for {}: {}",
+                        sectorName(sector),
+                        path,
+                        ec.message());
+          return false;
         }
 
-        if (size != 0) {
-          boost::system::error_code ec;
-          size_t actual_size = fs::file_size(path, ec);
-          if (ec.failed()) {
-            logger_->warn("sector {}. Can't get size for {}: {}",
-                          sectorName(sector),
-                          path,
-                          ec.message());
-            bad.push_back(sector);
-            break;
-          }
-
-          if (actual_size != ssize * size) {
-            logger_->warn(
-                "sector {}. Actual and declared sizes do not match for {}",
-                sectorName(sector),
-                path);
-            bad.push_back(sector);
-            break;
-          }
+        if (actual_size != ssize * size) {
+          logger_->warn(
+              "sector {}. Actual and declared sizes do not match for {}",
+              sectorName(sector),
+              path);
+          return false;
         }
       }
     }
 
-    return std::move(bad);
+    // read sampled nodes, size alone doesn't detect unreadable disk
+    std::ifstream sealed{paths.sealed, std::ios::binary};
+    std::array<char, kNodeSize> node{};
+    std::minstd_rand rng{static_cast<uint32_t>(sector.sector)};
+    for (auto i{0}; i < kSampleNodes; ++i) {
+      sealed.seekg((rng() % (ssize / kNodeSize)) * kNodeSize);
+      if (!sealed.read(node.data(), node.size())) {
+        logger_->warn("sector {}. Can't read {}",
+                      sectorName(sector),
+                      paths.sealed);
+        return false;
+      }
+    }
+    return true;
   }
 
   SectorSize ManagerImpl::getSectorSize() {
@@ -180,6 +270,10 @@ namespace fc::sector_storage {
     return 0;
   }
 
+  uint64_t ManagerImpl::queuedTasks(const primitives::TaskType &task_type) {
+    return scheduler_->queuedTasks(task_type);
+  }
+
   outcome::result<void> ManagerImpl::readPiece(proofs::PieceData output,
                                                const SectorId &sector,
                                                UnpaddedByteIndex offset,
@@ -192,11 +286,15 @@ namespace fc::sector_storage {
                                     | SectorFileType::FTCache),
         SectorFileType::FTUnsealed));
 
-    {
-      OUTCOME_TRY(best,
-                  index_->storageFindSector(
-                      sector, SectorFileType::FTUnsealed, boost::none));
+    OUTCOME_TRY(best,
+                index_->storageFindSector(
+                    sector, SectorFileType::FTUnsealed, boost::none));
+    if (best.empty()) {
+      // unsealed file was removed
+      unsealed_ranges_.remove(sector);
+    }
 
+    if (!unsealed_ranges_.has(sector, offset, size)) {
       std::shared_ptr<WorkerSelector> selector;
       if (best.empty()) {
         selector = std::make_unique<AllocateSelector>(
@@ -206,9 +304,6 @@ namespace fc::sector_storage {
             index_, sector, SectorFileType::FTUnsealed, false);
       }
 
-      // TODO: Optimization: don't send unseal to a worker if the requested
-      // range is already unsealed
-
       WorkerAction unseal_fetch =
           [&](const std::shared_ptr<Worker> &worker) -> outcome::result<void> {
         SectorFileType unsealed =
@@ -232,6 +327,16 @@ namespace fc::sector_storage {
           [&](const std::shared_ptr<Worker> &worker) -> outcome::result<void> {
             return worker->unsealPiece(sector, offset, size, randomness, cid);
           }));
+
+      for (const auto &evicted :
+           unsealed_ranges_.add(sector, offset, size, best.empty())) {
+        auto removed = remote_store_->remove(evicted, SectorFileType::FTUnsealed);
+        if (removed.has_error()) {
+          logger_->warn("cannot evict unsealed {}: {}",
+                        sectorName(evicted),
+                        removed.error().message());
+        }
+      }
     }
 
     std::shared_ptr<WorkerSelector> selector;
@@ -277,6 +382,28 @@ namespace fc::sector_storage {
         miner_id, res.private_info, randomness);
   }
 
+  outcome::result<void> ManagerImpl::prewarmWinningPoSt(
+      ActorId miner_id, gsl::span<const SectorInfo> sector_info) {
+    for (const auto &sector : sector_info) {
+      SectorId sector_id{
+          .miner = miner_id,
+          .sector = sector.sector,
+      };
+      // sectors which are not local are fetched by generateWinningPoSt
+      auto bytes{local_store_->prewarm(
+          sector_id,
+          sector.registered_proof,
+          static_cast<SectorFileType>(SectorFileType::FTCache
+                                      | SectorFileType::FTSealed))};
+      if (bytes) {
+        logger_->debug("prewarm sector {}: {} bytes",
+                       sectorName(sector_id),
+                       bytes.value());
+      }
+    }
+    return outcome::success();
+  }
+
   outcome::result<Prover::WindowPoStResponse> ManagerImpl::generateWindowPoSt(
       ActorId miner_id,
       gsl::span<const SectorInfo> sector_info,
@@ -312,13 +439,14 @@ namespace fc::sector_storage {
         static_cast<SectorFileType>(SectorFileType::FTSealed
                                     | SectorFileType::FTCache)));
 
-    // TODO: also consider where the unsealed data sits
-
+    // prefer worker where the unsealed data sits
     auto selector = std::make_unique<AllocateSelector>(
         index_,
         static_cast<SectorFileType>(SectorFileType::FTSealed
                                     | SectorFileType::FTCache),
-        PathType::kSealing);
+        PathType::kSealing,
+        sector,
+        SectorFileType::FTUnsealed);
 
     PreCommit1Output out;
 
@@ -589,6 +717,8 @@ namespace fc::sector_storage {
 
     auto worker_handler = std::make_unique<WorkerHandle>();
 
+    worker_handler->in_process =
+        dynamic_cast<LocalWorker *>(worker.get()) != nullptr;
     worker_handler->worker = std::move(worker);
     worker_handler->info = std::move(info);
 
@@ -678,13 +808,15 @@ namespace fc::sector_storage {
                           std::shared_ptr<stores::LocalStorage> local_storage,
                           std::shared_ptr<stores::LocalStore> local_store,
                           std::shared_ptr<stores::RemoteStore> store,
-                          std::shared_ptr<Scheduler> scheduler)
+                          std::shared_ptr<Scheduler> scheduler,
+                          uint64_t unsealed_cache_bytes)
           : ManagerImpl{std::move(sector_index),
                         seal_proof_type,
                         std::move(local_storage),
                         std::move(local_store),
                         std::move(store),
-                        std::move(scheduler)} {};
+                        std::move(scheduler),
+                        unsealed_cache_bytes} {};
     };
 
     auto proof_type = scheduler->getSealProofType();
@@ -697,7 +829,8 @@ namespace fc::sector_storage {
                                               local_storage,
                                               local_store,
                                               remote,
-                                              scheduler);
+                                              scheduler,
+                                              config.unsealed_cache_bytes);
 
     std::set<TaskType> local_tasks{
         primitives::kTTAddPiece,
@@ -741,14 +874,16 @@ namespace fc::sector_storage {
                            std::shared_ptr<stores::LocalStorage> local_storage,
                            std::shared_ptr<stores::LocalStore> local_store,
                            std::shared_ptr<stores::RemoteStore> store,
-                           std::shared_ptr<Scheduler> scheduler)
+                           std::shared_ptr<Scheduler> scheduler,
+                           uint64_t unsealed_cache_bytes)
       : index_(std::move(sector_index)),
         seal_proof_type_(seal_proof_type),
         local_storage_(std::move(local_storage)),
         local_store_(std::move(local_store)),
         remote_store_(std::move(store)),
         scheduler_(std::move(scheduler)),
-        logger_(common::createLogger("manager")) {}
+        logger_(common::createLogger("manager")),
+        unsealed_ranges_{unsealed_cache_bytes} {}
 
   outcome::result<ManagerImpl::Response> ManagerImpl::acquireSector(
       SectorId sector_id,
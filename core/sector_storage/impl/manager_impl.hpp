@@ -8,6 +8,11 @@
 
 #include "sector_storage/manager.hpp"
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "sector_storage/impl/unsealed_ranges.hpp"
 #include "sector_storage/scheduler.hpp"
 #include "sector_storage/stores/impl/local_store.hpp"
 #include "sector_storage/stores/impl/remote_store.hpp"
@@ -22,6 +27,8 @@ namespace fc::sector_storage {
     bool allow_precommit_2;
     bool allow_commit;
     bool allow_unseal;
+    /// Disk budget of unsealed ranges kept for retrieval, zero is unlimited
+    uint64_t unsealed_cache_bytes = 0;
   };
 
   class ManagerImpl : public Manager {
@@ -37,6 +44,8 @@ namespace fc::sector_storage {
 
     SectorSize getSectorSize() override;
 
+    uint64_t queuedTasks(const primitives::TaskType &task_type) override;
+
     outcome::result<void> readPiece(proofs::PieceData output,
                                     const SectorId &sector,
                                     UnpaddedByteIndex offset,
@@ -49,6 +58,9 @@ namespace fc::sector_storage {
         gsl::span<const SectorInfo> sector_info,
         PoStRandomness randomness) override;
 
+    outcome::result<void> prewarmWinningPoSt(
+        ActorId miner_id, gsl::span<const SectorInfo> sector_info) override;
+
     outcome::result<WindowPoStResponse> generateWindowPoSt(
         ActorId miner_id,
         gsl::span<const SectorInfo> sector_info,
@@ -100,13 +112,21 @@ namespace fc::sector_storage {
 
     outcome::result<FsStat> getFsStat(StorageID storage_id) override;
 
+    /// Threads checking sectors in checkProvable
+    static constexpr size_t kCheckThreads{16};
+    /// Sectors checked at once on one storage
+    static constexpr size_t kStorageCheckConcurrency{4};
+    /// Healthy sector is not checked again during this time
+    static constexpr std::chrono::minutes kHealthyTtl{10};
+
    private:
     ManagerImpl(std::shared_ptr<stores::SectorIndex> sector_index,
                 RegisteredProof seal_proof_type,
                 std::shared_ptr<stores::LocalStorage> local_storage,
                 std::shared_ptr<stores::LocalStore> local_store,
                 std::shared_ptr<stores::RemoteStore> store,
-                std::shared_ptr<Scheduler> scheduler);
+                std::shared_ptr<Scheduler> scheduler,
+                uint64_t unsealed_cache_bytes);
 
     struct Response {
       stores::SectorPaths paths;
@@ -131,6 +151,11 @@ namespace fc::sector_storage {
         const std::function<outcome::result<RegisteredProof>(RegisteredProof)>
             &to_post_transform);
 
+    /// Returns whether sector files are present and readable
+    outcome::result<bool> checkSector(RegisteredProof seal_proof_type,
+                                      SectorSize ssize,
+                                      const SectorId &sector);
+
     std::shared_ptr<stores::SectorIndex> index_;
 
     RegisteredProof seal_proof_type_;  // TODO: maybe add config
@@ -142,6 +167,17 @@ namespace fc::sector_storage {
     std::shared_ptr<Scheduler> scheduler_;
 
     common::Logger logger_;
+
+    std::mutex healthy_mutex_;
+    /// Last successful check of sector
+    std::map<SectorId, std::chrono::steady_clock::time_point> healthy_;
+    std::mutex storage_mutex_;
+    std::condition_variable storage_cv_;
+    /// Checks running on storage by id
+    std::map<std::string, size_t> storage_checks_;
+
+    /// Ranges unsealed by readPiece, repeated reads skip unseal
+    UnsealedRanges unsealed_ranges_;
   };
 
 }  // namespace fc::sector_storage
@@ -4,22 +4,30 @@
  */
 
 #include "sector_storage/impl/scheduler_impl.hpp"
+#include <algorithm>
 #include <boost/asio/post.hpp>
 #include <boost/thread.hpp>
+#include <future>
 #include <thread>
+#include "common/metrics.hpp"
 #include "primitives/resources/active_resources.hpp"
 
 namespace fc::sector_storage {
   using primitives::Resources;
   using primitives::WorkerResources;
 
-  SchedulerImpl::SchedulerImpl(RegisteredProof seal_proof_type)
+  SchedulerImpl::SchedulerImpl(RegisteredProof seal_proof_type,
+                               std::shared_ptr<TaskCalibration> calibration,
+                               size_t threads)
       : seal_proof_type_(seal_proof_type),
         current_worker_id_(0),
+        calibration_(std::move(calibration)),
         logger_(common::createLogger("scheduler")) {
     unsigned int nthreads = 0;
-    if ((nthreads = std::thread::hardware_concurrency())
-        || (nthreads = boost::thread::hardware_concurrency())) {
+    if (threads != 0) {
+      pool_ = std::make_unique<boost::asio::thread_pool>(threads);
+    } else if ((nthreads = std::thread::hardware_concurrency())
+               || (nthreads = boost::thread::hardware_concurrency())) {
       pool_ = std::make_unique<boost::asio::thread_pool>(nthreads);
     } else {
       pool_ = std::make_unique<boost::asio::thread_pool>(
@@ -35,59 +43,124 @@ namespace fc::sector_storage {
       const WorkerAction &prepare,
       const WorkerAction &work,
       uint64_t priority) {
+    std::promise<outcome::result<void>> promise;
+    auto future{promise.get_future()};
+    scheduleAsync(
+        sector,
+        task_type,
+        selector,
+        prepare,
+        work,
+        [&promise](outcome::result<void> res) {
+          promise.set_value(std::move(res));
+        },
+        priority);
+    return future.get();
+  }
+
+  void SchedulerImpl::scheduleAsync(
+      const primitives::sector::SectorId &sector,
+      const primitives::TaskType &task_type,
+      const std::shared_ptr<WorkerSelector> &selector,
+      const WorkerAction &prepare,
+      const WorkerAction &work,
+      ReturnCb cb,
+      uint64_t priority) {
     std::shared_ptr<TaskRequest> request = std::make_shared<TaskRequest>(
-        sector, task_type, priority, selector, prepare, work);
+        sector, task_type, priority, selector, prepare, work, std::move(cb));
 
+    outcome::result<bool> scheduled{false};
     {
-      std::lock_guard<std::mutex> lock(request_lock_);
+      std::lock_guard<std::mutex> lock(workers_lock_);
+      request->seq = next_seq_++;
 
-      OUTCOME_TRY(scheduled, maybeScheduleRequest(request));
+      scheduled = maybeScheduleRequest(request);
 
-      if (!scheduled) {
-        request_queue_.insert(request);
+      if (scheduled && !scheduled.value()) {
+        request_queues_[task_type].insert(request);
       }
     }
 
-    while (true) {
-      if (request->response) {
-        break;
-      }
-
-      std::unique_lock<std::mutex> lock(request->mutex_);
-      request->cv_.wait(lock, [&] { return request->response; });
+    if (!scheduled) {
+      request->respond(scheduled.error());
     }
-
-    return *request->response;
   }
 
   void SchedulerImpl::newWorker(std::unique_ptr<WorkerHandle> worker) {
+    std::shared_ptr<WorkerHandle> handle{std::move(worker)};
+    // may be remote call, so before lock
+    boost::optional<std::set<TaskType>> tasks;
+    if (handle->worker) {
+      auto maybe_tasks = handle->worker->getSupportedTask();
+      if (maybe_tasks) {
+        tasks = std::move(maybe_tasks.value());
+      } else {
+        logger_->warn("worker supported tasks: "
+                      + maybe_tasks.error().message());
+      }
+    }
+
     std::unique_lock<std::mutex> lock(workers_lock_);
     if (current_worker_id_ == std::numeric_limits<uint64_t>::max()) {
       current_worker_id_ = 0;
     }
     WorkerID wid = current_worker_id_++;
-    workers_.insert({wid, std::move(worker)});
+    workers_.insert({wid, handle});
+    if (tasks) {
+      for (const auto &task : *tasks) {
+        workers_by_task_[task].insert(wid);
+      }
+    } else {
+      any_task_workers_.insert(wid);
+    }
     lock.unlock();
 
     freeWorker(wid);
   }
 
-  outcome::result<bool> SchedulerImpl::maybeScheduleRequest(
-      const std::shared_ptr<TaskRequest> &request) {
-    std::lock_guard<std::mutex> lock(workers_lock_);
-
-    std::vector<WorkerID> acceptable;
-    uint64_t tried = 0;
+  std::vector<WorkerID> SchedulerImpl::candidateWorkers(
+      const TaskType &task_type) const {
+    std::vector<WorkerID> wids{any_task_workers_.begin(),
+                               any_task_workers_.end()};
+    auto it = workers_by_task_.find(task_type);
+    if (it != workers_by_task_.end()) {
+      wids.insert(wids.end(), it->second.begin(), it->second.end());
+    }
+    return wids;
+  }
 
+  Resources SchedulerImpl::needResources(
+      const TaskType &task_type,
+      const std::shared_ptr<WorkerHandle> &worker) const {
+    Resources resources{};
     auto resource_iter =
-        primitives::kResourceTable.find({request->task_type, seal_proof_type_});
+        primitives::kResourceTable.find({task_type, seal_proof_type_});
 
-    Resources need_resources{};
     if (resource_iter != primitives::kResourceTable.end()) {
-      need_resources = resource_iter->second;
+      resources = resource_iter->second;
+    }
+    if (calibration_) {
+      return calibration_->resources(
+          worker->info.hostname, task_type, seal_proof_type_, resources);
     }
+    return resources;
+  }
+
+  outcome::result<bool> SchedulerImpl::maybeScheduleRequest(
+      const std::shared_ptr<TaskRequest> &request) {
+    std::vector<WorkerID> acceptable;
+    std::vector<WorkerID> busy;
+    bool found = false;
+
+    // resources are checked first, selector may do remote calls
+    for (auto wid : candidateWorkers(request->task_type)) {
+      const auto &worker = workers_[wid];
+      if (!canPrepare(
+              wid, worker, needResources(request->task_type, worker))) {
+        busy.push_back(wid);
+        continue;
+      }
 
-    for (const auto &[wid, worker] : workers_) {
       OUTCOME_TRY(satisfies,
                   request->sel->is_satisfying(
                       request->task_type, seal_proof_type_, worker));
@@ -95,12 +168,7 @@ namespace fc::sector_storage {
       if (!satisfies) {
         continue;
       }
-      tried++;
-
-      if (!primitives::canHandleRequest(
-              need_resources, worker->info.resources, worker->preparing)) {
-        continue;
-      }
+      found = true;
 
       acceptable.push_back(wid);
     }
@@ -129,12 +197,41 @@ namespace fc::sector_storage {
 
       WorkerID wid = acceptable[0];
 
+      auto affinity = sector_workers_.find(request->sector);
+      if (affinity != sector_workers_.end() && affinity->second != wid
+          && std::find(acceptable.begin(), acceptable.end(), affinity->second)
+                 != acceptable.end()) {
+        OUTCOME_TRY(better,
+                    request->sel->is_preferred(request->task_type,
+                                               workers_[wid],
+                                               workers_[affinity->second]));
+        if (!better) {
+          wid = affinity->second;
+        }
+      }
+      if (request->task_type == primitives::kTTFinalize) {
+        sector_workers_.erase(request->sector);
+      } else {
+        sector_workers_[request->sector] = wid;
+      }
+
       assignWorker(wid, workers_[wid], request);
 
       return true;
     }
 
-    if (tried == 0) {
+    // request waits only if some busy worker can do it later
+    for (auto wid : busy) {
+      OUTCOME_TRY(satisfies,
+                  request->sel->is_satisfying(
+                      request->task_type, seal_proof_type_, workers_[wid]));
+      if (satisfies) {
+        found = true;
+        break;
+      }
+    }
+
+    if (!found) {
       return SchedulerErrors::kNotFoundWorker;
     }
 
@@ -145,58 +242,229 @@ namespace fc::sector_storage {
       WorkerID wid,
       const std::shared_ptr<WorkerHandle> &worker,
       const std::shared_ptr<TaskRequest> &request) {
-    auto resource_iter =
-        primitives::kResourceTable.find({request->task_type, seal_proof_type_});
-
-    Resources need_resources{};
-    if (resource_iter != primitives::kResourceTable.end()) {
-      need_resources = resource_iter->second;
-    }
+    Resources need_resources = needResources(request->task_type, worker);
 
     worker->preparing.add(worker->info.resources, need_resources);
+    request->prepare_resources = need_resources;
+    request->assigned = wid;
+    collectBatch(wid, worker, request, need_resources);
+    not_started_[wid].insert(request);
 
     boost::asio::post(*pool_, [this, wid, worker, request, need_resources]() {
       {
-        auto maybe_err = request->prepare(worker->worker);
-        std::unique_lock<std::mutex> lock(workers_lock_);
+        std::lock_guard<std::mutex> lock(workers_lock_);
+        if (request->assigned != wid) {
+          return;  // taken by other worker
+        }
+        not_started_[wid].erase(request);
+      }
+      std::vector<std::shared_ptr<TaskRequest>> requests{request};
+      requests.insert(
+          requests.end(), request->batch.begin(), request->batch.end());
+      request->batch.clear();
+      std::vector<std::pair<std::shared_ptr<TaskRequest>, std::error_code>>
+          failed;
+      std::shared_ptr<TaskRequest> leader;
+      for (auto &req : requests) {
+        auto maybe_err = req->prepare(worker->worker);
         if (maybe_err.has_error()) {
+          failed.emplace_back(req, maybe_err.error());
+        } else if (!leader) {
+          leader = req;
+        } else {
+          leader->batch.push_back(req);
+        }
+      }
+      {
+        std::lock_guard<std::mutex> lock(workers_lock_);
+        for (size_t i{0}; i < requests.size(); ++i) {
           worker->preparing.free(worker->info.resources, need_resources);
-          request->respond(maybe_err.error());
-          lock.unlock();
-          freeWorker(wid);
-          return;
         }
+        if (leader) {
+          prepared_[wid].push_back(leader);
+          startWork(wid, worker);
+        }
+      }
+      for (auto &[req, error] : failed) {
+        req->respond(error);
+      }
 
-        maybe_err = worker->active.withResources(
-            worker->info.resources,
-            need_resources,
-            workers_lock_,
-            [&]() -> outcome::result<void> {
-              worker->preparing.free(worker->info.resources, need_resources);
-              lock.unlock();
+      freeWorker(wid);
+    });
+  }
 
-              auto res = request->work(worker->worker);
+  void SchedulerImpl::collectBatch(WorkerID wid,
+                                   const std::shared_ptr<WorkerHandle> &worker,
+                                   const std::shared_ptr<TaskRequest> &request,
+                                   const Resources &need_resources) {
+    auto max_batch{batch_sizes_.find(request->task_type)};
+    if (max_batch == batch_sizes_.end()) {
+      return;
+    }
+    auto queue{request_queues_.find(request->task_type)};
+    if (queue == request_queues_.end()) {
+      return;
+    }
+    for (auto it = queue->second.begin(); it != queue->second.end();) {
+      if (request->batch.size() + 1 >= max_batch->second
+          || !primitives::canHandleRequest(
+              need_resources, worker->info.resources, worker->preparing)) {
+        break;
+      }
+      auto req = *it;
+      if (req == request) {
+        ++it;
+        continue;
+      }
+      auto maybe_satisfying =
+          req->sel->is_satisfying(req->task_type, seal_proof_type_, worker);
+      if (!maybe_satisfying || !maybe_satisfying.value()) {
+        ++it;
+        continue;
+      }
+      worker->preparing.add(worker->info.resources, need_resources);
+      req->prepare_resources = need_resources;
+      req->assigned = wid;
+      sector_workers_[req->sector] = wid;
+      request->batch.push_back(req);
+      it = queue->second.erase(it);
+    }
+  }
 
-              if (res.has_error()) {
-                request->respond(res.error());
-              } else {
-                request->respond(std::error_code());
-              }
+  outcome::result<void> SchedulerImpl::doWork(
+      const std::shared_ptr<WorkerHandle> &worker,
+      const std::shared_ptr<TaskRequest> &request) {
+    auto labels{"task=\"" + request->task_type + "\""};
+    common::metrics::histogram("fc_scheduler_wait_seconds",
+                               "Time from schedule to work start",
+                               labels)
+        .observeSince(request->created);
+    common::tracing::Attributes attributes{
+        {"task", request->task_type},
+        {"sector", std::to_string(request->sector.sector)},
+        {"worker", worker->info.hostname}};
+    if (request->trace.valid()) {
+      common::tracing::record("scheduler.wait",
+                              common::tracing::child(request->trace),
+                              request->trace,
+                              request->created,
+                              std::chrono::steady_clock::now(),
+                              attributes);
+    }
+    common::tracing::Span span{"scheduler.work", request->trace};
+    for (auto &[key, value] : attributes) {
+      span.attribute(key, value);
+    }
+    // memory growth of process includes other in-process tasks,
+    // so concurrent runs overestimate
+    boost::optional<MemorySampler> sampler;
+    if (calibration_ && worker->in_process) {
+      sampler.emplace();
+    }
+    auto start{std::chrono::steady_clock::now()};
+    auto res = [&] {
+      common::metrics::Timer timer{common::metrics::histogram(
+          "fc_scheduler_work_seconds", "Task work time", labels)};
+      return request->work(worker->worker);
+    }();
+    if (!res) {
+      span.error();
+    }
+    if (calibration_ && res) {
+      calibration_->record(
+          worker->info.hostname,
+          request->task_type,
+          seal_proof_type_,
+          sampler ? sampler->peak() : boost::none,
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::steady_clock::now() - start));
+    }
+    return res;
+  }
 
-              lock.lock();
-              return outcome::success();
-            });
-        if (maybe_err.has_error()) {
-          logger_->error("worker's execution: " + maybe_err.error().message());
+  void SchedulerImpl::startWork(WorkerID wid,
+                                const std::shared_ptr<WorkerHandle> &worker) {
+    auto &prepared = prepared_[wid];
+    while (!prepared.empty()) {
+      auto request = prepared.front();
+      Resources need_resources = needResources(request->task_type, worker);
+      // batch starts when whole batch fits
+      std::vector<boost::optional<size_t>> gpus;
+      for (size_t i{0}; i < 1 + request->batch.size(); ++i) {
+        if (!primitives::canHandleRequest(
+                need_resources, worker->info.resources, worker->active)) {
+          break;
         }
+        gpus.push_back(
+            worker->active.add(worker->info.resources, need_resources));
       }
+      if (gpus.size() != 1 + request->batch.size()) {
+        for (auto &gpu : gpus) {
+          worker->active.free(worker->info.resources, need_resources, gpu);
+        }
+        break;
+      }
+      prepared.pop_front();
+
+      boost::asio::post(
+          *pool_, [this, wid, worker, request, need_resources, gpus]() {
+            // batch runs together, so shared inputs are read once
+            std::vector<std::future<outcome::result<void>>> batch;
+            for (auto &req : request->batch) {
+              batch.push_back(std::async(std::launch::async, [&, req] {
+                return doWork(worker, req);
+              }));
+            }
+            std::vector<outcome::result<void>> results;
+            results.push_back(doWork(worker, request));
+            for (auto &res : batch) {
+              results.push_back(res.get());
+            }
+            {
+              std::lock_guard<std::mutex> lock(workers_lock_);
+              for (auto &gpu : gpus) {
+                worker->active.free(
+                    worker->info.resources, need_resources, gpu);
+              }
+            }
+            request->respond(std::move(results[0]));
+            for (size_t i{0}; i < request->batch.size(); ++i) {
+              request->batch[i]->respond(std::move(results[i + 1]));
+            }
+            {
+              std::lock_guard<std::mutex> lock(workers_lock_);
+              startWork(wid, worker);
+            }
+            freeWorker(wid);
+          });
+    }
+  }
 
-      freeWorker(wid);
-    });
+  void SchedulerImpl::setTaskBatch(const TaskType &task_type,
+                                   size_t max_batch) {
+    std::lock_guard lock(workers_lock_);
+    if (max_batch > 1) {
+      batch_sizes_[task_type] = max_batch;
+    } else {
+      batch_sizes_.erase(task_type);
+    }
+  }
+
+  bool SchedulerImpl::canPrepare(WorkerID wid,
+                                 const std::shared_ptr<WorkerHandle> &worker,
+                                 const Resources &need_resources) {
+    // one prepared request may wait for work while other works
+    auto prepared = prepared_.find(wid);
+    if (prepared != prepared_.end() && !prepared->second.empty()) {
+      return false;
+    }
+    return primitives::canHandleRequest(
+        need_resources, worker->info.resources, worker->preparing);
   }
 
   void SchedulerImpl::freeWorker(WorkerID wid) {
-    std::shared_ptr<WorkerHandle> worker;
+    std::vector<std::pair<std::shared_ptr<TaskRequest>, std::error_code>>
+        failed;
     {
       std::lock_guard<std::mutex> lock(workers_lock_);
       auto iter = workers_.find(wid);
@@ -204,43 +472,119 @@ namespace fc::sector_storage {
         logger_->warn("free worker: wid {} is invalid", wid);
         return;
       }
-      worker = iter->second;
-    }
-
-    std::lock_guard<std::mutex> lock(request_lock_);
-    for (auto it = request_queue_.begin(); it != request_queue_.cend(); ++it) {
-      auto req = *it;
-      auto maybe_satisfying =
-          req->sel->is_satisfying(req->task_type, seal_proof_type_, worker);
-      if (maybe_satisfying.has_error()) {
-        logger_->error("free worker satisfactory check: "
-                       + maybe_satisfying.error().message());
-        continue;
+      auto worker = iter->second;
+      for (auto &[task_type, queue] : request_queues_) {
+        if (queue.empty() || !supports(wid, task_type)) {
+          continue;
+        }
+        // all requests of queue need same resources
+        Resources need_resources =
+            needResources(TaskType{task_type}, worker);
+        for (auto it = queue.begin(); it != queue.end();) {
+          if (!canPrepare(wid, worker, need_resources)) {
+            break;
+          }
+          auto req = *it;
+          auto maybe_satisfying =
+              req->sel->is_satisfying(req->task_type, seal_proof_type_, worker);
+          if (maybe_satisfying.has_error()) {
+            logger_->error("free worker satisfactory check: "
+                           + maybe_satisfying.error().message());
+            ++it;
+            continue;
+          }
+
+          if (!maybe_satisfying.value()) {
+            ++it;
+            continue;
+          }
+
+          auto maybe_result = maybeScheduleRequest(req);
+
+          if (maybe_result.has_error()) {
+            failed.emplace_back(req, maybe_result.error());
+          } else if (!maybe_result.value()) {
+            ++it;
+            continue;
+          }
+
+          it = queue.erase(it);
+        }
       }
 
-      if (!maybe_satisfying.value()) {
-        continue;
-      }
+      stealRequests(wid, worker);
+    }
 
-      auto maybe_result = maybeScheduleRequest(req);
+    for (auto &[req, error] : failed) {
+      req->respond(error);
+    }
+  }
 
-      if (maybe_result.has_error()) {
-        req->respond(maybe_result.error());
-      } else if (!maybe_result.value()) {
-        continue;
+  bool SchedulerImpl::supports(WorkerID wid,
+                               const std::string &task_type) const {
+    if (any_task_workers_.count(wid) != 0) {
+      return true;
+    }
+    auto by_task = workers_by_task_.find(task_type);
+    return by_task != workers_by_task_.end()
+           && by_task->second.count(wid) != 0;
+  }
+
+  void SchedulerImpl::stealRequests(
+      WorkerID wid, const std::shared_ptr<WorkerHandle> &worker) {
+    // most loaded workers first
+    std::vector<std::pair<size_t, WorkerID>> victims;
+    for (const auto &[victim, requests] : not_started_) {
+      if (victim != wid && !requests.empty()) {
+        victims.emplace_back(requests.size(), victim);
       }
+    }
+    std::sort(victims.rbegin(), victims.rend());
+
+    for (const auto &[_, victim] : victims) {
+      auto &requests = not_started_[victim];
+      auto &victim_worker = workers_[victim];
+      for (auto it = requests.begin(); it != requests.end();) {
+        auto req = *it;
+        // batch stays on worker which prepares it
+        if (!req->batch.empty() || !supports(wid, req->task_type)
+            || !canPrepare(
+                wid, worker, needResources(req->task_type, worker))) {
+          ++it;
+          continue;
+        }
+        auto maybe_satisfying =
+            req->sel->is_satisfying(req->task_type, seal_proof_type_, worker);
+        if (!maybe_satisfying || !maybe_satisfying.value()) {
+          ++it;
+          continue;
+        }
 
-      it = request_queue_.erase(it);
-      if (it == request_queue_.cend()) {
-        break;
+        victim_worker->preparing.free(victim_worker->info.resources,
+                                      req->prepare_resources);
+        it = requests.erase(it);
+        logger_->info("worker {} takes {} of sector {} from worker {}",
+                      wid,
+                      req->task_type,
+                      req->sector.sector,
+                      victim);
+        if (req->task_type != primitives::kTTFinalize) {
+          sector_workers_[req->sector] = wid;
+        }
+        assignWorker(wid, worker, req);
       }
-      --it;
     }
   }
 
   RegisteredProof SchedulerImpl::getSealProofType() const {
     return seal_proof_type_;
   }
+
+  uint64_t SchedulerImpl::queuedTasks(const TaskType &task_type) {
+    std::lock_guard lock(workers_lock_);
+    auto it = request_queues_.find(task_type);
+    return it == request_queues_.end() ? 0 : it->second.size();
+  }
 }  // namespace fc::sector_storage
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::sector_storage, SchedulerErrors, e) {
@@ -8,8 +8,15 @@
 
 #include "sector_storage/scheduler.hpp"
 
+#include "common/tracing.hpp"
+#include "sector_storage/impl/task_calibration.hpp"
+
 #include <boost/asio/thread_pool.hpp>
+#include <chrono>
+#include <deque>
+#include <map>
 #include <mutex>
+#include <set>
 #include <unordered_map>
 #include <utility>
 
@@ -22,14 +29,15 @@ namespace fc::sector_storage {
                        uint64_t priority,
                        std::shared_ptr<WorkerSelector> sel,
                        WorkerAction prepare,
-                       WorkerAction work)
+                       WorkerAction work,
+                       ReturnCb cb)
         : sector(sector),
           task_type(std::move(task_type)),
           priority(priority),
           sel(std::move(sel)),
           prepare(std::move(prepare)),
           work(std::move(work)),
-          response(boost::none){};
+          cb(std::move(cb)){};
 
     SectorId sector;
     TaskType task_type;
@@ -39,18 +47,30 @@ namespace fc::sector_storage {
     WorkerAction prepare;
     WorkerAction work;
 
-    inline void respond(const std::error_code &resp) {
-      if (resp) {
-        response = resp;
-      } else {
-        response = outcome::success();
+    /// Calls callback once, must be called without scheduler locks
+    inline void respond(outcome::result<void> res) {
+      if (cb) {
+        auto _cb{std::move(cb)};
+        cb = nullptr;
+        _cb(std::move(res));
       }
-      cv_.notify_one();
     }
 
-    boost::optional<outcome::result<void>> response;
-    std::mutex mutex_;
-    std::condition_variable cv_;
+    ReturnCb cb;
+    /// Order of arrival, requests with same priority are handled FIFO
+    uint64_t seq{};
+    /// Worker which will do request, may change until pool starts it
+    boost::optional<uint64_t> assigned;
+    /// For queue wait metrics
+    std::chrono::steady_clock::time_point created{
+        std::chrono::steady_clock::now()};
+    /// Trace context of caller, wait and work spans are its children
+    common::tracing::SpanContext trace{common::tracing::current()};
+    /// Preparing resources reserved on assigned worker
+    primitives::Resources prepare_resources{};
+    /// Requests of same task type done together with this one, on same
+    /// worker
+    std::vector<std::shared_ptr<TaskRequest>> batch;
   };
 
   inline bool operator<(const TaskRequest &lhs, const TaskRequest &rhs) {
@@ -62,9 +82,43 @@ namespace fc::sector_storage {
                 rhs.sector.sector);
   }
 
+  struct TaskRequestOrder {
+    bool operator()(const std::shared_ptr<TaskRequest> &lhs,
+                    const std::shared_ptr<TaskRequest> &rhs) const {
+      if (*lhs < *rhs) {
+        return true;
+      }
+      if (*rhs < *lhs) {
+        return false;
+      }
+      return lhs->seq < rhs->seq;
+    }
+  };
+
+  /**
+   * Queues requests by task type in priority order.
+   * Workers are indexed by supported task types, so request is matched only
+   * against workers which can do it, and worker which freed resources
+   * rescans only queues of its task types.
+   * Free worker also takes requests which were assigned to other workers but
+   * not started yet, so new and idle workers get work immediately.
+   * Worker is two-stage pipeline: next request is prepared (fetched) while
+   * previous one works, prepared request waits for active resources without
+   * holding pool thread.
+   * Work is done on thread pool, callers are not blocked by scheduleAsync.
+   * With calibration, resources needed by task on worker are learned from
+   * its previous runs there, static table is used until then.
+   */
   class SchedulerImpl : public Scheduler {
    public:
-    explicit SchedulerImpl(RegisteredProof seal_proof_type);
+    /**
+     * @param threads - size of pool doing prepare and work, defaults to
+     * hardware concurrency
+     */
+    explicit SchedulerImpl(
+        RegisteredProof seal_proof_type,
+        std::shared_ptr<TaskCalibration> calibration = nullptr,
+        size_t threads = 0);
 
     outcome::result<void> schedule(
         const SectorId &sector,
@@ -74,33 +128,115 @@ namespace fc::sector_storage {
         const WorkerAction &work,
         uint64_t priority) override;
 
+    void scheduleAsync(const SectorId &sector,
+                       const TaskType &task_type,
+                       const std::shared_ptr<WorkerSelector> &selector,
+                       const WorkerAction &prepare,
+                       const WorkerAction &work,
+                       ReturnCb cb,
+                       uint64_t priority) override;
+
     void newWorker(std::unique_ptr<WorkerHandle> worker) override;
 
     RegisteredProof getSealProofType() const override;
 
+    uint64_t queuedTasks(const TaskType &task_type) override;
+
+    /**
+     * Requests of task type are grouped up to max_batch, when worker
+     * resources allow. Batch is prepared and started on one worker
+     * together, so concurrent runs share inputs, e.g. PreCommit1 parent
+     * cache. Disabled for max_batch below 2
+     */
+    void setTaskBatch(const TaskType &task_type, size_t max_batch);
+
    private:
+    using RequestQueue =
+        std::set<std::shared_ptr<TaskRequest>, TaskRequestOrder>;
+
+    /// Must be called with workers_lock_
     outcome::result<bool> maybeScheduleRequest(
         const std::shared_ptr<TaskRequest> &request);
 
+    /// Workers which may support task type, must be called with workers_lock_
+    std::vector<WorkerID> candidateWorkers(const TaskType &task_type) const;
+
+    primitives::Resources needResources(
+        const TaskType &task_type,
+        const std::shared_ptr<WorkerHandle> &worker) const;
+
     void assignWorker(WorkerID wid,
                       const std::shared_ptr<WorkerHandle> &worker,
                       const std::shared_ptr<TaskRequest> &request);
 
     void freeWorker(WorkerID wid);
 
+    /**
+     * Moves queued requests of same task type, which worker can also do,
+     * into batch of request. Must be called with workers_lock_
+     */
+    void collectBatch(WorkerID wid,
+                      const std::shared_ptr<WorkerHandle> &worker,
+                      const std::shared_ptr<TaskRequest> &request,
+                      const primitives::Resources &need_resources);
+
+    /// Does work of request and records its measures
+    outcome::result<void> doWork(const std::shared_ptr<WorkerHandle> &worker,
+                                 const std::shared_ptr<TaskRequest> &request);
+
+    /**
+     * Starts work of prepared requests while worker has free active
+     * resources. Must be called with workers_lock_
+     */
+    void startWork(WorkerID wid, const std::shared_ptr<WorkerHandle> &worker);
+
+    /**
+     * Worker may prepare request: it has free preparing resources and no
+     * prepared request waits for work. Must be called with workers_lock_
+     */
+    bool canPrepare(WorkerID wid,
+                    const std::shared_ptr<WorkerHandle> &worker,
+                    const primitives::Resources &need_resources);
+
+    /// Worker may do task type, must be called with workers_lock_
+    bool supports(WorkerID wid, const std::string &task_type) const;
+
+    /**
+     * Moves requests assigned to other workers, but not started by pool yet,
+     * to worker while it has free resources. Must be called with
+     * workers_lock_
+     */
+    void stealRequests(WorkerID wid,
+                       const std::shared_ptr<WorkerHandle> &worker);
+
     RegisteredProof seal_proof_type_;
 
+    /// Guards workers and request queues
     std::mutex workers_lock_;
     WorkerID current_worker_id_;
     std::unordered_map<WorkerID, std::shared_ptr<WorkerHandle>> workers_;
-
-    std::mutex request_lock_;
-    std::multiset<std::shared_ptr<TaskRequest>,
-                  std::owner_less<std::shared_ptr<TaskRequest>>>
-        request_queue_;
+    /// Workers by supported task type, filled when worker is added
+    std::map<std::string, std::set<WorkerID>> workers_by_task_;
+    /// Workers which didn't tell supported tasks, tried for any task
+    std::set<WorkerID> any_task_workers_;
+
+    /// Worker which did last task of sector, next stage goes there if
+    /// selector doesn't prefer other worker
+    std::map<SectorId, WorkerID> sector_workers_;
+
+    std::map<std::string, RequestQueue> request_queues_;
+    uint64_t next_seq_{};
+    /// Assigned requests not started by pool yet, by worker
+    std::map<WorkerID, RequestQueue> not_started_;
+    /// Prepared requests waiting for active resources, by worker
+    std::map<WorkerID, std::deque<std::shared_ptr<TaskRequest>>> prepared_;
+    /// Max batch size by task type
+    std::map<TaskType, size_t> batch_sizes_;
 
     std::unique_ptr<boost::asio::thread_pool> pool_;
 
+    std::shared_ptr<TaskCalibration> calibration_;
+
     common::Logger logger_;
   };
 
@@ -0,0 +1,64 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/impl/sector_locality.hpp"
+
+#include <algorithm>
+
+namespace fc::sector_storage {
+  using primitives::sector_file::kOverheadSeal;
+  using primitives::sector_file::kSectorFileTypes;
+
+  SectorLocality::SectorLocality(std::shared_ptr<stores::SectorIndex> index,
+                                 SectorId sector,
+                                 SectorFileType file_types)
+      : index_(std::move(index)), sector_(sector), file_types_(file_types) {}
+
+  outcome::result<uint64_t> SectorLocality::fetchCost(
+      const std::shared_ptr<WorkerHandle> &worker) {
+    auto cached{costs_.find(worker.get())};
+    if (cached != costs_.end()) {
+      return cached->second;
+    }
+
+    if (!found_) {
+      found_.emplace();
+      for (const auto &type : kSectorFileTypes) {
+        if ((file_types_ & type) == 0) {
+          continue;
+        }
+        OUTCOME_TRY(infos, index_->storageFindSector(sector_, type, boost::none));
+        auto &storages{(*found_)[type]};
+        for (const auto &info : infos) {
+          storages.insert(info.id);
+        }
+      }
+    }
+
+    OUTCOME_TRY(paths, worker->worker->getAccessiblePaths());
+    uint64_t cost{0};
+    for (const auto &[type, storages] : *found_) {
+      auto local{std::any_of(paths.begin(), paths.end(), [&](auto &path) {
+        return storages.find(path.id) != storages.end();
+      })};
+      if (!local) {
+        cost += kOverheadSeal.at(type);
+      }
+    }
+    costs_.emplace(worker.get(), cost);
+    return cost;
+  }
+
+  outcome::result<boost::optional<bool>> SectorLocality::isPreferred(
+      const std::shared_ptr<WorkerHandle> &challenger,
+      const std::shared_ptr<WorkerHandle> &current_best) {
+    OUTCOME_TRY(challenger_cost, fetchCost(challenger));
+    OUTCOME_TRY(best_cost, fetchCost(current_best));
+    if (challenger_cost == best_cost) {
+      return boost::none;
+    }
+    return challenger_cost < best_cost;
+  }
+}  // namespace fc::sector_storage
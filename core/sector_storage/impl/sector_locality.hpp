@@ -0,0 +1,47 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <map>
+#include <set>
+
+#include "sector_storage/selector.hpp"
+#include "sector_storage/stores/index.hpp"
+
+namespace fc::sector_storage {
+  using primitives::StorageID;
+
+  /**
+   * Estimates cost of fetching sector files to worker, as sum of file sizes
+   * (from seal overheads) missing in worker storages.
+   * Lookups are cached, object is used for one request.
+   */
+  class SectorLocality {
+   public:
+    SectorLocality(std::shared_ptr<stores::SectorIndex> index,
+                   SectorId sector,
+                   SectorFileType file_types);
+
+    outcome::result<uint64_t> fetchCost(
+        const std::shared_ptr<WorkerHandle> &worker);
+
+    /**
+     * Compares fetch costs of workers
+     * @return none if costs are equal
+     */
+    outcome::result<boost::optional<bool>> isPreferred(
+        const std::shared_ptr<WorkerHandle> &challenger,
+        const std::shared_ptr<WorkerHandle> &current_best);
+
+   private:
+    std::shared_ptr<stores::SectorIndex> index_;
+    SectorId sector_;
+    SectorFileType file_types_;
+    /// Storages having sector file, by file type
+    boost::optional<std::map<SectorFileType, std::set<StorageID>>> found_;
+    std::map<const WorkerHandle *, uint64_t> costs_;
+  };
+}  // namespace fc::sector_storage
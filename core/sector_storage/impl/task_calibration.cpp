@@ -0,0 +1,159 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/impl/task_calibration.hpp"
+
+#include <unistd.h>
+#include <condition_variable>
+#include <fstream>
+#include <thread>
+
+#include "codec/cbor/cbor.hpp"
+#include "common/span.hpp"
+
+namespace fc::sector_storage {
+  constexpr std::chrono::milliseconds kSampleInterval{100};
+
+  TaskCalibration::TaskCalibration(std::shared_ptr<PersistentBufferMap> kv)
+      : kv_{std::move(kv)} {}
+
+  Buffer TaskCalibration::kvKey(const Key &key) {
+    auto &[host, task_type, proof]{key};
+    return Buffer{common::span::cbytes(
+        host + "/" + task_type + "/"
+        + std::to_string(static_cast<int64_t>(proof)))};
+  }
+
+  TaskMeasure *TaskCalibration::find(const Key &key) {
+    auto it{measures_.find(key)};
+    if (it == measures_.end()) {
+      boost::optional<TaskMeasure> loaded;
+      if (kv_) {
+        auto kv_key{kvKey(key)};
+        if (kv_->contains(kv_key)) {
+          if (auto raw{kv_->get(kv_key)}) {
+            if (auto measure{codec::cbor::decode<TaskMeasure>(raw.value())}) {
+              loaded = measure.value();
+            }
+          }
+        }
+      }
+      it = measures_.emplace(key, loaded).first;
+    }
+    return it->second ? &*it->second : nullptr;
+  }
+
+  void TaskCalibration::record(const std::string &host,
+                               const TaskType &task_type,
+                               RegisteredProof seal_proof_type,
+                               boost::optional<uint64_t> peak_memory,
+                               std::chrono::milliseconds duration) {
+    std::lock_guard lock{mutex_};
+    Key key{host, task_type, seal_proof_type};
+    auto measure{find(key)};
+    if (!measure) {
+      auto &slot{measures_[key]};
+      slot = TaskMeasure{};
+      measure = &*slot;
+    }
+    ++measure->runs;
+    if (peak_memory) {
+      ++measure->memory_runs;
+      measure->peak_memory = std::max(measure->peak_memory, *peak_memory);
+    }
+    uint64_t ms = duration.count();
+    measure->total_ms += ms;
+    measure->max_ms = std::max(measure->max_ms, ms);
+    if (kv_) {
+      // measure is kept in memory if put fails, and is put on next run
+      if (auto encoded{codec::cbor::encode(*measure)}) {
+        std::ignore = kv_->put(kvKey(key), encoded.value());
+      }
+    }
+  }
+
+  boost::optional<TaskMeasure> TaskCalibration::measure(
+      const std::string &host,
+      const TaskType &task_type,
+      RegisteredProof seal_proof_type) {
+    std::lock_guard lock{mutex_};
+    if (auto measure{find({host, task_type, seal_proof_type})}) {
+      return *measure;
+    }
+    return boost::none;
+  }
+
+  Resources TaskCalibration::resources(const std::string &host,
+                                       const TaskType &task_type,
+                                       RegisteredProof seal_proof_type,
+                                       const Resources &fallback) {
+    auto measure{this->measure(host, task_type, seal_proof_type)};
+    if (!measure || measure->memory_runs < kMinMemoryRuns) {
+      return fallback;
+    }
+    auto memory{measure->peak_memory * (100 + kMarginPercent) / 100};
+    auto resources{fallback};
+    resources.min_memory = memory;
+    resources.max_memory = memory;
+    return resources;
+  }
+
+  boost::optional<uint64_t> residentMemory() {
+    std::ifstream statm{"/proc/self/statm"};
+    uint64_t size, resident;
+    if (statm >> size >> resident) {
+      return resident * sysconf(_SC_PAGESIZE);
+    }
+    return boost::none;
+  }
+
+  struct MemorySampler::Shared {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stop{false};
+    boost::optional<uint64_t> start;
+    uint64_t peak{};
+  };
+
+  MemorySampler::MemorySampler() : shared_{std::make_shared<Shared>()} {
+    shared_->start = residentMemory();
+    if (!shared_->start) {
+      return;
+    }
+    shared_->peak = *shared_->start;
+    std::thread{[shared{shared_}] {
+      std::unique_lock lock{shared->mutex};
+      while (!shared->cv.wait_for(
+          lock, kSampleInterval, [&] { return shared->stop; })) {
+        lock.unlock();
+        auto resident{residentMemory()};
+        lock.lock();
+        if (resident) {
+          shared->peak = std::max(shared->peak, *resident);
+        }
+      }
+    }}.detach();
+  }
+
+  MemorySampler::~MemorySampler() {
+    {
+      std::lock_guard lock{shared_->mutex};
+      shared_->stop = true;
+    }
+    shared_->cv.notify_one();
+  }
+
+  boost::optional<uint64_t> MemorySampler::peak() const {
+    std::lock_guard lock{shared_->mutex};
+    if (!shared_->start) {
+      return boost::none;
+    }
+    auto peak{shared_->peak};
+    if (auto resident{residentMemory()}) {
+      peak = std::max(peak, *resident);
+    }
+    return peak - *shared_->start;
+  }
+}  // namespace fc::sector_storage
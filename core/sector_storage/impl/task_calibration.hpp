@@ -0,0 +1,98 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+
+#include "codec/cbor/streams_annotation.hpp"
+#include "primitives/resources/resources.hpp"
+#include "storage/buffer_map.hpp"
+
+namespace fc::sector_storage {
+  using primitives::Resources;
+  using primitives::TaskType;
+  using primitives::sector::RegisteredProof;
+  using storage::PersistentBufferMap;
+
+  /// Measured runs of task type on worker
+  struct TaskMeasure {
+    uint64_t runs{};
+    /// Runs with measured memory
+    uint64_t memory_runs{};
+    /// Highest resident memory growth during run
+    uint64_t peak_memory{};
+    /// Total and longest run durations
+    uint64_t total_ms{};
+    uint64_t max_ms{};
+  };
+  CBOR_TUPLE(TaskMeasure, runs, memory_runs, peak_memory, total_ms, max_ms)
+
+  /**
+   * Resource needs of tasks learned from runs on each worker host.
+   * Once task ran enough times with measured memory, its memory need is
+   * measured peak with margin instead of static kResourceTable value, which
+   * is sized for worst case. Measures are persisted, so calibration
+   * survives restarts.
+   */
+  class TaskCalibration {
+   public:
+    /// Runs with measured memory before measure replaces static table
+    static constexpr uint64_t kMinMemoryRuns{3};
+    /// Percent added to measured peak memory
+    static constexpr uint64_t kMarginPercent{15};
+
+    explicit TaskCalibration(std::shared_ptr<PersistentBufferMap> kv = nullptr);
+
+    void record(const std::string &host,
+                const TaskType &task_type,
+                RegisteredProof seal_proof_type,
+                boost::optional<uint64_t> peak_memory,
+                std::chrono::milliseconds duration);
+
+    boost::optional<TaskMeasure> measure(const std::string &host,
+                                         const TaskType &task_type,
+                                         RegisteredProof seal_proof_type);
+
+    /// Calibrated resources, static table resources if not measured enough
+    Resources resources(const std::string &host,
+                        const TaskType &task_type,
+                        RegisteredProof seal_proof_type,
+                        const Resources &fallback);
+
+   private:
+    using Key = std::tuple<std::string, TaskType, RegisteredProof>;
+
+    static Buffer kvKey(const Key &key);
+    /// Must be called with mutex_
+    TaskMeasure *find(const Key &key);
+
+    std::shared_ptr<PersistentBufferMap> kv_;
+    std::mutex mutex_;
+    /// Measures by key, boost::none for keys missing in kv
+    std::map<Key, boost::optional<TaskMeasure>> measures_;
+  };
+
+  /**
+   * Samples resident memory of this process while alive.
+   * Measures memory of tasks done by in-process worker.
+   */
+  class MemorySampler {
+   public:
+    MemorySampler();
+    ~MemorySampler();
+
+    /// Highest growth of resident memory since construction
+    boost::optional<uint64_t> peak() const;
+
+   private:
+    struct Shared;
+    std::shared_ptr<Shared> shared_;
+  };
+
+  /// Resident memory of this process, none if unknown
+  boost::optional<uint64_t> residentMemory();
+}  // namespace fc::sector_storage
@@ -0,0 +1,95 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/impl/unsealed_ranges.hpp"
+
+namespace fc::sector_storage {
+  UnsealedRanges::UnsealedRanges(uint64_t budget) : budget_{budget} {}
+
+  bool UnsealedRanges::has(const SectorId &sector,
+                           uint64_t offset,
+                           uint64_t size) {
+    std::lock_guard lock{mutex_};
+    auto it = sectors_.find(sector);
+    if (it == sectors_.end()) {
+      return false;
+    }
+    auto &entry = it->second;
+    auto range = entry.ranges.upper_bound(offset);
+    if (range == entry.ranges.begin()) {
+      return false;
+    }
+    --range;
+    if (range->second < offset + size) {
+      return false;
+    }
+    lru_.splice(lru_.begin(), lru_, entry.lru);
+    return true;
+  }
+
+  std::vector<SectorId> UnsealedRanges::add(const SectorId &sector,
+                                            uint64_t offset,
+                                            uint64_t size,
+                                            bool created) {
+    std::lock_guard lock{mutex_};
+    auto it = sectors_.find(sector);
+    if (it == sectors_.end()) {
+      lru_.push_front(sector);
+      it = sectors_.emplace(sector, Entry{}).first;
+      it->second.lru = lru_.begin();
+    } else {
+      lru_.splice(lru_.begin(), lru_, it->second.lru);
+    }
+    auto &entry = it->second;
+    entry.created = entry.created || created;
+
+    // merge with overlapping and adjacent ranges
+    auto begin = offset;
+    auto end = offset + size;
+    auto range = entry.ranges.upper_bound(begin);
+    if (range != entry.ranges.begin() && std::prev(range)->second >= begin) {
+      --range;
+    }
+    while (range != entry.ranges.end() && range->first <= end) {
+      begin = std::min(begin, range->first);
+      end = std::max(end, range->second);
+      entry.bytes -= range->second - range->first;
+      bytes_ -= range->second - range->first;
+      range = entry.ranges.erase(range);
+    }
+    entry.ranges.emplace(begin, end);
+    entry.bytes += end - begin;
+    bytes_ += end - begin;
+
+    std::vector<SectorId> evicted;
+    while (budget_ != 0 && bytes_ > budget_ && lru_.size() > 1) {
+      auto victim = sectors_.find(lru_.back());
+      if (victim->second.created) {
+        evicted.push_back(victim->first);
+      }
+      erase(victim);
+    }
+    return evicted;
+  }
+
+  void UnsealedRanges::remove(const SectorId &sector) {
+    std::lock_guard lock{mutex_};
+    auto it = sectors_.find(sector);
+    if (it != sectors_.end()) {
+      erase(it);
+    }
+  }
+
+  uint64_t UnsealedRanges::bytes() const {
+    std::lock_guard lock{mutex_};
+    return bytes_;
+  }
+
+  void UnsealedRanges::erase(std::map<SectorId, Entry>::iterator it) {
+    bytes_ -= it->second.bytes;
+    lru_.erase(it->second.lru);
+    sectors_.erase(it);
+  }
+}  // namespace fc::sector_storage
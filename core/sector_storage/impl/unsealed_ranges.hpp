@@ -0,0 +1,66 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "primitives/sector/sector.hpp"
+
+namespace fc::sector_storage {
+  using primitives::sector::SectorId;
+
+  /**
+   * Index of unpadded piece ranges already unsealed into unsealed files.
+   * Sectors are evicted in least recently used order when unsealed bytes
+   * exceed budget.
+   */
+  class UnsealedRanges {
+   public:
+    /// Zero budget means no eviction
+    explicit UnsealedRanges(uint64_t budget);
+
+    /// Range is unsealed, marks sector as recently used
+    bool has(const SectorId &sector, uint64_t offset, uint64_t size);
+
+    /**
+     * Adds unsealed range.
+     * @param created - unsealed file was created by unseal and may be removed
+     * on eviction
+     * @return evicted sectors with created unsealed files
+     */
+    std::vector<SectorId> add(const SectorId &sector,
+                              uint64_t offset,
+                              uint64_t size,
+                              bool created);
+
+    /// Forget unsealed ranges of sector, e.g. when unsealed file is removed
+    void remove(const SectorId &sector);
+
+    uint64_t bytes() const;
+
+   private:
+    struct Entry {
+      /// Disjoint ranges, begin to end
+      std::map<uint64_t, uint64_t> ranges;
+      uint64_t bytes{};
+      bool created{};
+      std::list<SectorId>::iterator lru;
+    };
+
+    /// Must be called with mutex_
+    void erase(std::map<SectorId, Entry>::iterator it);
+
+    uint64_t budget_;
+    uint64_t bytes_{};
+    std::map<SectorId, Entry> sectors_;
+    /// Most recently used first
+    std::list<SectorId> lru_;
+    mutable std::mutex mutex_;
+  };
+}  // namespace fc::sector_storage
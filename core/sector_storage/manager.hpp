@@ -22,6 +22,9 @@ namespace fc::sector_storage {
    public:
     virtual SectorSize getSectorSize() = 0;
 
+    /// Number of tasks of given type waiting for worker resources
+    virtual uint64_t queuedTasks(const primitives::TaskType &task_type) = 0;
+
     virtual outcome::result<void> readPiece(PieceData output,
                                             const SectorId &sector,
                                             UnpaddedByteIndex offset,
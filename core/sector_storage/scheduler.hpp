@@ -18,6 +18,8 @@ namespace fc::sector_storage {
   using WorkerAction =
       std::function<outcome::result<void>(const std::shared_ptr<Worker> &)>;
 
+  using ReturnCb = std::function<void(outcome::result<void>)>;
+
   constexpr uint64_t kDefaultTaskPriority = 0;
 
   class Scheduler {
@@ -32,9 +34,25 @@ namespace fc::sector_storage {
         const WorkerAction &work,
         uint64_t priority = kDefaultTaskPriority) = 0;
 
+    /**
+     * Queues task without blocking caller.
+     * @param cb - called once with result of work, on thread which did the
+     * work or on caller thread if task cannot be scheduled
+     */
+    virtual void scheduleAsync(const SectorId &sector,
+                               const TaskType &task_type,
+                               const std::shared_ptr<WorkerSelector> &selector,
+                               const WorkerAction &prepare,
+                               const WorkerAction &work,
+                               ReturnCb cb,
+                               uint64_t priority = kDefaultTaskPriority) = 0;
+
     virtual void newWorker(std::unique_ptr<WorkerHandle> worker) = 0;
 
     virtual RegisteredProof getSealProofType() const = 0;
+
+    /// Number of tasks of given type waiting for worker resources
+    virtual uint64_t queuedTasks(const TaskType &task_type) = 0;
   };
 
   enum class SchedulerErrors {
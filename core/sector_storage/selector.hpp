@@ -23,6 +23,9 @@ namespace fc::sector_storage {
 
     ActiveResources preparing;
     ActiveResources active;
+
+    /// Worker runs in this process, so its memory use can be measured
+    bool in_process{false};
   };
 
   class WorkerSelector {
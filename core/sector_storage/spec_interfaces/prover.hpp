@@ -31,6 +31,13 @@ namespace fc::sector_storage {
         gsl::span<const SectorInfo> sector_info,
         PoStRandomness randomness) = 0;
 
+    /**
+     * Start reading files of challenged sectors into page cache before
+     * winning PoSt is generated for them
+     */
+    virtual outcome::result<void> prewarmWinningPoSt(
+        ActorId miner_id, gsl::span<const SectorInfo> sector_info) = 0;
+
     virtual outcome::result<WindowPoStResponse> generateWindowPoSt(
         ActorId miner_id,
         gsl::span<const SectorInfo> sector_info,
@@ -0,0 +1,246 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/stores/impl/fetch_handler.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/http/status.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <boost/filesystem.hpp>
+#include <gsl/gsl_util>
+#include <thread>
+
+#include "api/rpc/json.hpp"
+#include "codec/json/json.hpp"
+#include "common/file.hpp"
+#include "common/logger.hpp"
+#include "common/span.hpp"
+#include "common/tarutil.hpp"
+#include "sector_storage/stores/impl/local_store.hpp"
+
+namespace fc::sector_storage::stores {
+  namespace fs = boost::filesystem;
+  namespace http = boost::beast::http;
+  using primitives::sector_file::kSectorFileTypes;
+
+  namespace {
+    const std::string kRoutePrefix{"/remote/"};
+
+    common::Logger logger() {
+      static common::Logger logger{common::createLogger("fetch handler")};
+      return logger;
+    }
+
+    /// Writes status line and headers, body of content length follows
+    bool writeHead(FetchHandler::Socket &socket,
+                   http::status status,
+                   const std::string &headers,
+                   uint64_t content_length) {
+      auto head{"HTTP/1.1 " + std::to_string(static_cast<unsigned>(status))
+                + " " + std::string{http::obsolete_reason(status)} + "\r\n"
+                + headers + "Content-Length: "
+                + std::to_string(content_length)
+                + "\r\nConnection: close\r\n\r\n"};
+      boost::system::error_code ec;
+      boost::asio::write(socket, boost::asio::buffer(head), ec);
+      return !ec;
+    }
+
+    void respond(FetchHandler::Socket &socket,
+                 http::status status,
+                 const std::string &body = {},
+                 const std::string &headers = {}) {
+      if (writeHead(socket, status, headers, body.size()) && !body.empty()) {
+        boost::system::error_code ec;
+        boost::asio::write(socket, boost::asio::buffer(body), ec);
+      }
+    }
+
+    boost::optional<SectorFileType> parseFileType(const std::string &str) {
+      for (const auto &type : kSectorFileTypes) {
+        if (toString(type) == str) {
+          return type;
+        }
+      }
+      return boost::none;
+    }
+
+    void sendStat(LocalStore &local,
+                  FetchHandler::Socket &socket,
+                  const std::string &id) {
+      auto stat{local.getFsStat(id)};
+      if (!stat) {
+        return respond(socket,
+                       stat.error() == StoreErrors::kNotFoundStorage
+                           ? http::status::not_found
+                           : http::status::internal_server_error,
+                       stat.error().message());
+      }
+      auto json{codec::json::format(api::encode(stat.value()))};
+      if (!json) {
+        return respond(socket, http::status::internal_server_error);
+      }
+      respond(socket,
+              http::status::ok,
+              std::string{common::span::bytestr(*json)},
+              "Content-Type: application/json\r\n");
+    }
+
+    /// Sends tar of directory, generated while sending
+    void sendTar(FetchHandler::Socket &socket, const std::string &path) {
+      auto entries{common::tarEntries(path)};
+      if (!entries) {
+        return respond(socket, http::status::internal_server_error);
+      }
+      if (!writeHead(socket,
+                     http::status::ok,
+                     "Content-Type: application/x-tar\r\n",
+                     common::tarSize(entries.value()))) {
+        return;
+      }
+      auto written{common::writeTar(entries.value(), socket.native_handle())};
+      if (!written) {
+        logger()->warn("send tar {}: {}", path, written.error().message());
+      }
+    }
+
+    /// Sends sector file, or its range if requested
+    void sendFile(FetchHandler::Socket &socket,
+                  const FetchHandler::Request &req,
+                  const std::string &path) {
+      auto fd{::open(path.c_str(), O_RDONLY)};
+      if (fd < 0) {
+        return respond(socket, http::status::not_found);
+      }
+      auto _close{gsl::finally([&] { ::close(fd); })};
+      boost::system::error_code ec;
+      auto size{fs::file_size(path, ec)};
+      if (ec) {
+        return respond(socket, http::status::internal_server_error);
+      }
+      auto status{http::status::ok};
+      std::string headers{"Content-Type: application/octet-stream\r\n"};
+      uint64_t begin{0}, end{size};
+      auto range{req.find(http::field::range)};
+      if (range != req.end()) {
+        // single range "bytes=<begin>-[<end>]", as sent by fetchRanges
+        std::string value{range->value()};
+        uint64_t last{size - 1};
+        auto dash{value.find('-')};
+        auto valid{boost::starts_with(value, "bytes=")
+                   && dash != std::string::npos && dash > 6};
+        if (valid) {
+          try {
+            begin = std::stoull(value.substr(6, dash - 6));
+            if (dash + 1 < value.size()) {
+              last = std::min<uint64_t>(last,
+                                      std::stoull(value.substr(dash + 1)));
+            }
+          } catch (const std::logic_error &) {
+            valid = false;
+          }
+        }
+        if (!valid || begin >= size || begin > last) {
+          return respond(socket,
+                         http::status::range_not_satisfiable,
+                         {},
+                         "Content-Range: bytes */" + std::to_string(size)
+                             + "\r\n");
+        }
+        end = last + 1;
+        status = http::status::partial_content;
+        headers += "Content-Range: bytes " + std::to_string(begin) + "-"
+                   + std::to_string(last) + "/" + std::to_string(size)
+                   + "\r\n";
+      }
+      if (!writeHead(socket, status, headers, end - begin)) {
+        return;
+      }
+      if (!common::sendFile(socket.native_handle(), fd, begin, end - begin)) {
+        logger()->warn("send file {}: interrupted", path);
+      }
+    }
+
+    void handle(LocalStore &local,
+                const FetchHandler::Request &req,
+                FetchHandler::Socket &socket) {
+      std::string target{req.target()};
+      target = target.substr(0, target.find('?'));
+      if (!boost::starts_with(target, kRoutePrefix)) {
+        return respond(socket, http::status::not_found);
+      }
+      std::vector<std::string> parts;
+      boost::split(parts, target.substr(kRoutePrefix.size()), [](auto c) {
+        return c == '/';
+      });
+      if (parts.size() != 2) {
+        return respond(socket, http::status::not_found);
+      }
+      if (parts[0] == "stat") {
+        if (req.method() != http::verb::get) {
+          return respond(socket, http::status::method_not_allowed);
+        }
+        return sendStat(local, socket, parts[1]);
+      }
+      auto type{parseFileType(parts[0])};
+      auto sector{parseSectorId(parts[1])};
+      if (!type || !sector) {
+        return respond(socket, http::status::bad_request);
+      }
+
+      if (req.method() == http::verb::delete_) {
+        auto removed{local.remove(sector.value(), *type)};
+        if (!removed) {
+          return respond(socket,
+                         http::status::internal_server_error,
+                         removed.error().message());
+        }
+        return respond(socket, http::status::ok);
+      }
+      if (req.method() != http::verb::get) {
+        return respond(socket, http::status::method_not_allowed);
+      }
+
+      // seal proof type is used only to allocate
+      auto response{local.acquireSector(sector.value(),
+                                        RegisteredProof::StackedDRG2KiBSeal,
+                                        *type,
+                                        SectorFileType::FTNone,
+                                        PathType::kStorage,
+                                        AcquireMode::kMove)};
+      if (!response) {
+        return respond(socket,
+                       http::status::internal_server_error,
+                       response.error().message());
+      }
+      auto path{response.value().paths.getPathByType(*type)};
+      if (!path || path.value().empty()) {
+        return respond(socket, http::status::not_found);
+      }
+      if (fs::is_directory(path.value())) {
+        return sendTar(socket, path.value());
+      }
+      sendFile(socket, req, path.value());
+    }
+  }  // namespace
+
+  FetchHandler::FetchHandler(std::shared_ptr<LocalStore> local)
+      : local_{std::move(local)} {}
+
+  void FetchHandler::operator()(Request &&req, Socket &&socket) const {
+    std::thread{[local{local_},
+                 req{std::move(req)},
+                 socket{std::move(socket)}]() mutable {
+      // socket was used asynchronously, sendfile needs blocking fd
+      boost::system::error_code ec;
+      socket.native_non_blocking(false, ec);
+      handle(*local, req, socket);
+      socket.shutdown(Socket::shutdown_send, ec);
+    }}.detach();
+  }
+}  // namespace fc::sector_storage::stores
@@ -0,0 +1,38 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/string_body.hpp>
+
+#include "sector_storage/stores/store.hpp"
+
+namespace fc::sector_storage::stores {
+  /**
+   * Serves local store files to remote stores over http:
+   *   GET /remote/stat/<storage id> - fs stat json
+   *   GET /remote/<type>/<sector name> - sector file, or tar of directory
+   *   DELETE /remote/<type>/<sector name> - removes sector file
+   * Sector files support single "Range", so they can be fetched in parallel
+   * chunks. Directory tar is generated while sending, without temporary
+   * archive. File bodies are sent with sendfile on own thread per request,
+   * so transfers don't block io thread.
+   */
+  class FetchHandler {
+   public:
+    using Request =
+        boost::beast::http::request<boost::beast::http::string_body>;
+    using Socket = boost::asio::ip::tcp::socket;
+
+    explicit FetchHandler(std::shared_ptr<LocalStore> local);
+
+    void operator()(Request &&req, Socket &&socket) const;
+
+   private:
+    std::shared_ptr<LocalStore> local_;
+  };
+}  // namespace fc::sector_storage::stores
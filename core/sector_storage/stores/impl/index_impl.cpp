@@ -5,6 +5,7 @@
 
 #include "sector_storage/stores/impl/index_impl.hpp"
 
+#include <algorithm>
 #include <boost/filesystem/path.hpp>
 #include <chrono>
 #include <regex>
@@ -30,59 +31,105 @@ namespace fc::sector_storage::stores {
     }
   }
 
+  /// Sets urls of storage to sector file paths
+  outcome::result<void> sectorUrls(StorageInfo &store,
+                                   const SectorId &sector,
+                                   const SectorFileType &file_type) {
+    for (auto &url : store.urls) {
+      HttpUri uri;
+      try {
+        uri.parse(url);
+      } catch (const std::runtime_error &err) {
+        return IndexErrors::kInvalidUrl;
+      }
+      boost::filesystem::path path = uri.path();
+      path = path / toString(file_type) / sectorName(sector);
+      uri.setPath(path.string());
+      url = uri.str();
+    }
+    return outcome::success();
+  }
+
+  SectorIndexImpl::Shard &SectorIndexImpl::shard(const SectorId &sector) {
+    return shards_[(sector.sector ^ (sector.miner * 0x9E3779B97F4A7C15ull))
+                   % kIndexShards];
+  }
+
+  std::shared_ptr<StorageEntry> SectorIndexImpl::findStorage(
+      const StorageID &storage_id) const {
+    std::shared_lock lock(stores_mutex_);
+    auto it = stores_.find(storage_id);
+    if (it == stores_.end()) {
+      return nullptr;
+    }
+    return it->second;
+  }
+
+  void SectorIndexImpl::updateStorageSectors(const StorageID &storage_id,
+                                             const Decl &decl,
+                                             bool declared) {
+    auto storage = findStorage(storage_id);
+    if (!storage) {
+      return;
+    }
+    std::lock_guard lock(storage->mutex);
+    if (declared) {
+      storage->sectors.insert(decl);
+    } else {
+      storage->sectors.erase(decl);
+    }
+  }
+
   outcome::result<void> SectorIndexImpl::storageAttach(
       const StorageInfo &storage_info, const FsStat &stat) {
-    std::unique_lock lock(mutex_);
     for (const auto &new_url : storage_info.urls) {
       if (!isValidUrl(new_url)) {
         return IndexErrors::kInvalidUrl;
       }
     }
 
+    std::unique_lock lock(stores_mutex_);
     auto stores_iter = stores_.find(storage_info.id);
     if (stores_iter != stores_.end()) {
-      bool is_duplicate;
+      auto &storage = *stores_iter->second;
+      std::lock_guard storage_lock(storage.mutex);
       for (const auto &new_url : storage_info.urls) {
-        is_duplicate = false;
-        for (const auto &old_url : stores_iter->second.info.urls) {
-          if (new_url == old_url) {
-            is_duplicate = true;
-            break;
-          }
-        }
-        if (!is_duplicate) {
-          stores_iter->second.info.urls.push_back(new_url);
+        if (std::find(storage.info.urls.begin(),
+                      storage.info.urls.end(),
+                      new_url)
+            == storage.info.urls.end()) {
+          storage.info.urls.push_back(new_url);
         }
       }
       return outcome::success();
     }
 
-    stores_[storage_info.id] = StorageEntry{
-        .info = storage_info,
-        .fs_stat = stat,
-        .last_heartbeat = system_clock::now(),
-        .error = {},
-    };
+    auto storage = std::make_shared<StorageEntry>();
+    storage->info = storage_info;
+    storage->fs_stat = stat;
+    storage->last_heartbeat = system_clock::now();
+    stores_.emplace(storage_info.id, std::move(storage));
     return outcome::success();
   }
 
   outcome::result<StorageInfo> SectorIndexImpl::getStorageInfo(
       const StorageID &storage_id) const {
-    std::shared_lock lock(mutex_);
-    auto maybe_storage = stores_.find(storage_id);
-    if (maybe_storage == stores_.end()) return IndexErrors::kStorageNotFound;
-    return maybe_storage->second.info;
+    auto storage = findStorage(storage_id);
+    if (!storage) return IndexErrors::kStorageNotFound;
+    std::lock_guard lock(storage->mutex);
+    return storage->info;
   }
 
   outcome::result<void> SectorIndexImpl::storageReportHealth(
       const StorageID &storage_id, const HealthReport &report) {
-    std::unique_lock lock(mutex_);
-    auto storage_iter = stores_.find(storage_id);
-    if (storage_iter == stores_.end()) return IndexErrors::kStorageNotFound;
+    // only reported storage is locked
+    auto storage = findStorage(storage_id);
+    if (!storage) return IndexErrors::kStorageNotFound;
 
-    storage_iter->second.fs_stat = report.stat;
-    storage_iter->second.error = report.error;
-    storage_iter->second.last_heartbeat = system_clock::now();
+    std::lock_guard lock(storage->mutex);
+    storage->fs_stat = report.stat;
+    storage->error = report.error;
+    storage->last_heartbeat = system_clock::now();
 
     return outcome::success();
   }
@@ -92,48 +139,52 @@ namespace fc::sector_storage::stores {
       const SectorId &sector,
       const SectorFileType &file_type,
       bool primary) {
-    std::unique_lock lock(mutex_);
+    std::vector<Decl> declared;
+    {
+      auto &_shard = shard(sector);
+      std::unique_lock lock(_shard.mutex);
 
-    for (const auto &type : primitives::sector_file::kSectorFileTypes) {
-      if ((file_type & type) == 0) {
-        continue;
-      }
-
-      Decl index{
-          .sector_id = sector,
-          .type = type,
-      };
-
-      auto sector_iter = sectors_.find(index);
-      if (sector_iter == sectors_.end()) {
-        sectors_[index] = {};
-        sector_iter = sectors_.find(index);
-      }
+      for (const auto &type : primitives::sector_file::kSectorFileTypes) {
+        if ((file_type & type) == 0) {
+          continue;
+        }
 
-      bool is_duplicate = false;
-      for (auto &sid : sector_iter->second) {
-        if (storage_id == sid.id) {
-          if (!sid.is_primary && primary) {
-            sid.is_primary = true;
-          } else {
-            logger_->warn(
-                "sector {} redeclared in {}", sectorName(sector), storage_id);
+        Decl index{
+            .sector_id = sector,
+            .type = type,
+        };
+
+        auto &metas = _shard.sectors[index];
+
+        bool is_duplicate = false;
+        for (auto &sid : metas) {
+          if (storage_id == sid.id) {
+            if (!sid.is_primary && primary) {
+              sid.is_primary = true;
+            } else {
+              logger_->warn(
+                  "sector {} redeclared in {}", sectorName(sector), storage_id);
+            }
+            is_duplicate = true;
+            break;
           }
-          is_duplicate = true;
-          break;
         }
-      }
 
-      if (is_duplicate) {
-        continue;
-      }
+        if (is_duplicate) {
+          continue;
+        }
 
-      sector_iter->second.push_back(DeclMeta{
-          .id = storage_id,
-          .is_primary = primary,
-      });
+        metas.push_back(DeclMeta{
+            .id = storage_id,
+            .is_primary = primary,
+        });
+        declared.push_back(index);
+      }
     }
 
+    for (const auto &decl : declared) {
+      updateStorageSectors(storage_id, decl, true);
+    }
     return outcome::success();
   }
 
@@ -141,95 +192,106 @@ namespace fc::sector_storage::stores {
       const StorageID &storage_id,
       const SectorId &sector,
       const fc::primitives::sector_file::SectorFileType &file_type) {
-    std::unique_lock lock(mutex_);
+    std::vector<Decl> dropped;
+    {
+      auto &_shard = shard(sector);
+      std::unique_lock lock(_shard.mutex);
 
-    for (const auto &type : primitives::sector_file::kSectorFileTypes) {
-      if ((file_type & type) == 0) {
-        continue;
-      }
+      for (const auto &type : primitives::sector_file::kSectorFileTypes) {
+        if ((file_type & type) == 0) {
+          continue;
+        }
 
-      Decl index{
-          .sector_id = sector,
-          .type = type,
-      };
+        Decl index{
+            .sector_id = sector,
+            .type = type,
+        };
 
-      auto sector_iter = sectors_.find(index);
-      if (sector_iter == sectors_.end()) {
-        return outcome::success();
-      }
-      std::vector<DeclMeta> sectors;
-      for (const auto &sid : sector_iter->second) {
-        if (storage_id == sid.id) {
+        auto sector_iter = _shard.sectors.find(index);
+        if (sector_iter == _shard.sectors.end()) {
           continue;
         }
-        sectors.push_back(sid);
-      }
-      if (sectors.empty()) {
-        sectors_.erase(sector_iter);
-        return outcome::success();
+        auto &metas = sector_iter->second;
+        auto it = std::remove_if(metas.begin(), metas.end(), [&](auto &sid) {
+          return sid.id == storage_id;
+        });
+        if (it == metas.end()) {
+          continue;
+        }
+        metas.erase(it, metas.end());
+        if (metas.empty()) {
+          _shard.sectors.erase(sector_iter);
+        }
+        dropped.push_back(index);
       }
-
-      sector_iter->second = sectors;
     }
 
+    for (const auto &decl : dropped) {
+      updateStorageSectors(storage_id, decl, false);
+    }
     return outcome::success();
   }
 
+  std::vector<Decl> SectorIndexImpl::storageSectors(
+      const StorageID &storage_id) const {
+    auto storage = findStorage(storage_id);
+    if (!storage) {
+      return {};
+    }
+    std::lock_guard lock(storage->mutex);
+    return {storage->sectors.begin(), storage->sectors.end()};
+  }
+
   outcome::result<std::vector<StorageInfo>> SectorIndexImpl::storageFindSector(
       const SectorId &sector,
       const fc::primitives::sector_file::SectorFileType &file_type,
       boost::optional<RegisteredProof> fetch_seal_proof_type) {
-    std::shared_lock lock(mutex_);
     struct StorageMeta {
       uint64_t storage_count;
       bool is_primary;
     };
     std::unordered_map<StorageID, StorageMeta> storages;
 
-    for (const auto &type : primitives::sector_file::kSectorFileTypes) {
-      if ((file_type & type) == 0) {
-        continue;
-      }
+    {
+      auto &_shard = shard(sector);
+      std::shared_lock lock(_shard.mutex);
+      for (const auto &type : primitives::sector_file::kSectorFileTypes) {
+        if ((file_type & type) == 0) {
+          continue;
+        }
 
-      Decl index{
-          .sector_id = sector,
-          .type = type,
-      };
-      auto sector_iter = sectors_.find(index);
-      if (sector_iter == sectors_.end()) {
-        continue;
-      }
-      for (const auto &storage : sector_iter->second) {
-        ++(storages[storage.id].storage_count);
-        storages[storage.id].is_primary =
-            storages[storage.id].is_primary || storage.is_primary;
+        Decl index{
+            .sector_id = sector,
+            .type = type,
+        };
+        auto sector_iter = _shard.sectors.find(index);
+        if (sector_iter == _shard.sectors.end()) {
+          continue;
+        }
+        for (const auto &storage : sector_iter->second) {
+          auto &meta = storages[storage.id];
+          ++meta.storage_count;
+          meta.is_primary = meta.is_primary || storage.is_primary;
+        }
       }
     }
 
     std::vector<StorageInfo> result;
     for (const auto &[id, meta] : storages) {
-      if (stores_.find(id) == stores_.end()) {
-        // logger
+      auto storage = findStorage(id);
+      if (!storage) {
         continue;
       }
 
-      auto store = stores_[id].info;
-
-      for (uint64_t i = 0; i < store.urls.size(); i++) {
-        HttpUri uri;
-        try {
-          uri.parse(store.urls[i]);
-        } catch (const std::runtime_error &err) {
-          return IndexErrors::kInvalidUrl;
-        }
-        boost::filesystem::path path = uri.path();
-        path = path / toString(file_type) / sectorName(sector);
-        uri.setPath(path.string());
-        store.urls[i] = uri.str();
+      StorageInfo store;
+      {
+        std::lock_guard lock(storage->mutex);
+        store = storage->info;
       }
+      OUTCOME_TRY(sectorUrls(store, sector, file_type));
 
       store.weight = store.weight * meta.storage_count;
-      store.is_primary = storages[id].is_primary;
+      store.is_primary = meta.is_primary;
       result.push_back(store);
     }
 
@@ -237,58 +299,57 @@ namespace fc::sector_storage::stores {
       OUTCOME_TRY(required_space,
                   primitives::sector_file::sealSpaceUse(
                       file_type, fetch_seal_proof_type.get()));
-      for (const auto &[id, storage_info] : stores_) {
-        if (!storage_info.info.can_seal) {
-          continue;
-        }
-
-        if (required_space
-            > static_cast<uint64_t>(storage_info.fs_stat.available)) {
-          logger_->debug(
-              "not selecting on {}, out of space (available: {}, need: {})",
-              storage_info.info.id,
-              storage_info.fs_stat.available,
-              required_space);
-          continue;
+      std::vector<std::shared_ptr<StorageEntry>> entries;
+      {
+        std::shared_lock lock(stores_mutex_);
+        for (const auto &[id, storage] : stores_) {
+          if (storages.find(id) == storages.end()) {
+            entries.push_back(storage);
+          }
         }
+      }
+      for (const auto &storage : entries) {
+        StorageInfo store;
+        {
+          std::lock_guard lock(storage->mutex);
+          if (!storage->info.can_seal) {
+            continue;
+          }
 
-        if (duration_cast<std::chrono::seconds>(
-                high_resolution_clock::now().time_since_epoch()
-                - storage_info.last_heartbeat.time_since_epoch())
-            > kSkippedHeartbeatThreshold) {
-          logger_->debug("not selecting on {}, didn't receive heartbeats for {}",
-                        storage_info.info.id,
-                        duration_cast<std::chrono::seconds>(
-                            high_resolution_clock::now().time_since_epoch()
-                            - storage_info.last_heartbeat.time_since_epoch())
-                            .count());
-        }
+          if (required_space
+              > static_cast<uint64_t>(storage->fs_stat.available)) {
+            logger_->debug(
+                "not selecting on {}, out of space (available: {}, need: {})",
+                storage->info.id,
+                storage->fs_stat.available,
+                required_space);
+            continue;
+          }
 
-        if (storage_info.error.has_value()) {
-          logger_->debug("not selecting on {}, heartbeat_interval_ error: {}",
-                         storage_info.info.id,
-                         storage_info.error.get());
-          continue;
-        }
+          if (duration_cast<std::chrono::seconds>(
+                  high_resolution_clock::now().time_since_epoch()
+                  - storage->last_heartbeat.time_since_epoch())
+              > kSkippedHeartbeatThreshold) {
+            logger_->debug(
+                "not selecting on {}, didn't receive heartbeats for {}",
+                storage->info.id,
+                duration_cast<std::chrono::seconds>(
+                    high_resolution_clock::now().time_since_epoch()
+                    - storage->last_heartbeat.time_since_epoch())
+                    .count());
+          }
 
-        if (storages.find(id) != storages.end()) {
-          continue;
-        }
-        auto store = storage_info.info;
-
-        for (uint64_t i = 0; i < store.urls.size(); i++) {
-          HttpUri uri;
-          try {
-            uri.parse(store.urls[i]);
-          } catch (const std::runtime_error &err) {
-            return IndexErrors::kInvalidUrl;
+          if (storage->error.has_value()) {
+            logger_->debug("not selecting on {}, heartbeat_interval_ error: {}",
+                           storage->info.id,
+                           storage->error.get());
+            continue;
           }
-          boost::filesystem::path path = uri.path();
-          path = path / toString(file_type) / sectorName(sector);
-          uri.setPath(path.string());
-          store.urls[i] = uri.str();
+          store = storage->info;
         }
 
+        OUTCOME_TRY(sectorUrls(store, sector, file_type));
+
         store.weight = 0;
         store.is_primary = false;
         result.push_back(store);
@@ -302,36 +363,50 @@ namespace fc::sector_storage::stores {
       const fc::primitives::sector_file::SectorFileType &allocate,
       fc::primitives::sector::RegisteredProof seal_proof_type,
       bool sealing_mode) {
-    std::shared_lock lock(mutex_);
-
     OUTCOME_TRY(
         req_space,
         fc::primitives::sector_file::sealSpaceUse(allocate, seal_proof_type));
 
-    std::vector<StorageEntry> candidates;
+    struct Candidate {
+      StorageInfo info;
+      TokenAmount weight;
+    };
+    std::vector<Candidate> candidates;
+
+    std::vector<std::shared_ptr<StorageEntry>> entries;
+    {
+      std::shared_lock lock(stores_mutex_);
+      entries.reserve(stores_.size());
+      for (const auto &[id, storage] : stores_) {
+        entries.push_back(storage);
+      }
+    }
 
-    for (const auto &[id, storage] : stores_) {
-      if (sealing_mode && !storage.info.can_seal) {
+    auto now = system_clock::now();
+    for (const auto &storage : entries) {
+      std::lock_guard lock(storage->mutex);
+      if (sealing_mode && !storage->info.can_seal) {
         continue;
       }
-      if (!sealing_mode && !storage.info.can_store) {
+      if (!sealing_mode && !storage->info.can_store) {
         continue;
       }
 
-      if (req_space > storage.fs_stat.available) {
+      if (req_space > storage->fs_stat.available) {
         continue;
       }
 
-      if (system_clock::now() - storage.last_heartbeat
-          > kSkippedHeartbeatThreshold) {
+      if (now - storage->last_heartbeat > kSkippedHeartbeatThreshold) {
         continue;
       }
 
-      if (storage.error) {
+      if (storage->error) {
         continue;
       }
 
-      candidates.push_back(storage);
+      candidates.push_back(Candidate{
+          storage->info,
+          TokenAmount(storage->fs_stat.available) * storage->info.weight});
     }
 
     if (candidates.empty()) {
@@ -340,16 +415,14 @@ namespace fc::sector_storage::stores {
 
     std::sort(candidates.begin(),
               candidates.end(),
-              [](const StorageEntry &lhs, const StorageEntry &rhs) {
-                auto lw = TokenAmount(lhs.fs_stat.available) * lhs.info.weight;
-                auto rw = TokenAmount(rhs.fs_stat.available) * rhs.info.weight;
-                return lw < rw;
+              [](const Candidate &lhs, const Candidate &rhs) {
+                return lhs.weight < rhs.weight;
               });
 
     std::vector<StorageInfo> result;
 
-    for (const auto &candidate : candidates) {
-      result.emplace_back(candidate.info);
+    for (auto &candidate : candidates) {
+      result.emplace_back(std::move(candidate.info));
     }
 
     return result;
@@ -385,6 +458,21 @@ namespace fc::sector_storage::stores {
     return nullptr;
   }
 
+  void SectorIndexImpl::storageLockAsync(
+      const SectorId &sector,
+      SectorFileType read,
+      SectorFileType write,
+      bool priority,
+      std::function<void(outcome::result<std::unique_ptr<Lock>>)> cb) {
+    auto lock{std::make_shared<std::unique_ptr<IndexLock::Lock>>(
+        std::make_unique<IndexLock::Lock>(sector, read, write))};
+    if (!index_lock_->lockAsync(**lock, priority, [lock, cb] {
+          cb(std::unique_ptr<Lock>{std::move(*lock)});
+        })) {
+      cb(IndexErrors::kCannotLockStorage);
+    }
+  }
+
   SectorIndexImpl::SectorIndexImpl() {
     index_lock_ = std::make_shared<IndexLock>();
     logger_ = common::createLogger("sector index");
@@ -8,6 +8,9 @@
 
 #include "sector_storage/stores/index.hpp"
 
+#include <array>
+#include <mutex>
+#include <set>
 #include <shared_mutex>
 #include <unordered_map>
 #include "common/logger.hpp"
@@ -15,23 +18,37 @@
 
 namespace fc::sector_storage::stores {
 
+  struct Decl {
+    SectorId sector_id;
+    SectorFileType type;
+  };
+
+  inline bool operator<(const Decl &lhs, const Decl &rhs) {
+    return less(lhs.sector_id, rhs.sector_id, lhs.type, rhs.type);
+  }
+
   struct StorageEntry {
     StorageInfo info;
     FsStat fs_stat;
 
     system_clock::time_point last_heartbeat;
     boost::optional<std::string> error;
-  };
 
-  struct Decl {
-    SectorId sector_id;
-    SectorFileType type;
+    /// Sectors declared in storage
+    std::set<Decl> sectors;
+    /// Guards fields above except info.id, so health reports and
+    /// declarations don't lock whole index
+    mutable std::mutex mutex;
   };
 
-  inline bool operator<(const Decl &lhs, const Decl &rhs) {
-    return less(lhs.sector_id, rhs.sector_id, lhs.type, rhs.type);
-  }
+  /// Number of sector declaration shards
+  constexpr size_t kIndexShards = 64;
 
+  /**
+   * Sector declarations are sharded by sector id, each shard has own lock,
+   * so tasks of different sectors don't contend. Storages keep reverse index
+   * of their sectors. Lock order is shard, set of storages, storage entry.
+   */
   class SectorIndexImpl : public SectorIndex {
    public:
     SectorIndexImpl();
@@ -74,15 +91,43 @@ namespace fc::sector_storage::stores {
                                          SectorFileType read,
                                          SectorFileType write) override;
 
+    void storageLockAsync(
+        const SectorId &sector,
+        SectorFileType read,
+        SectorFileType write,
+        bool priority,
+        std::function<void(outcome::result<std::unique_ptr<Lock>>)> cb)
+        override;
+
+    /// Sectors declared in storage
+    std::vector<Decl> storageSectors(const StorageID &storage_id) const;
+
    private:
     struct DeclMeta {
       StorageID id;
       bool is_primary;
     };
 
-    mutable std::shared_mutex mutex_;
-    std::unordered_map<StorageID, StorageEntry> stores_;
-    std::map<Decl, std::vector<DeclMeta>> sectors_;
+    /// Declarations of sectors with same shard index
+    struct Shard {
+      mutable std::shared_mutex mutex;
+      std::map<Decl, std::vector<DeclMeta>> sectors;
+    };
+
+    Shard &shard(const SectorId &sector);
+
+    std::shared_ptr<StorageEntry> findStorage(
+        const StorageID &storage_id) const;
+
+    /// Declaration changed in shard, must be called without shard lock
+    void updateStorageSectors(const StorageID &storage_id,
+                              const Decl &decl,
+                              bool declared);
+
+    /// Guards only set of storages, entries have own locks
+    mutable std::shared_mutex stores_mutex_;
+    std::unordered_map<StorageID, std::shared_ptr<StorageEntry>> stores_;
+    std::array<Shard, kIndexShards> shards_;
     std::shared_ptr<IndexLock> index_lock_;
     common::Logger logger_;
   };
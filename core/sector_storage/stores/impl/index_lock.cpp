@@ -5,6 +5,8 @@
 
 #include "index_lock.hpp"
 
+#include <future>
+
 namespace fc::sector_storage::stores {
   IndexLock::Lock::~Lock() {
     if (index) {
@@ -25,32 +27,81 @@ namespace fc::sector_storage::stores {
     return true;
   }
 
+  void IndexLock::acquire(Sector &sector, Lock &lock) {
+    for (auto i{0u}; i < kSectorFileTypeBits; ++i) {
+      if (lock.read & (1 << i)) {
+        ++sector.read[i];
+      }
+    }
+    sector.write = static_cast<SectorFileType>(sector.write | lock.write);
+    lock.index = shared_from_this();
+  }
+
+  std::vector<std::function<void()>> IndexLock::grant(Sector &sector) {
+    std::vector<std::function<void()>> granted;
+    while (!sector.waiting.empty()) {
+      auto &waiter{sector.waiting.front()};
+      if (!sector.canLock(waiter.lock->read, waiter.lock->write)) {
+        break;
+      }
+      acquire(sector, *waiter.lock);
+      granted.push_back(std::move(waiter.cb));
+      sector.waiting.pop_front();
+      if (sector.priority_waiting) {
+        --sector.priority_waiting;
+      }
+    }
+    return granted;
+  }
+
   bool IndexLock::lock(IndexLock::Lock &lock, bool wait) {
     assert(!lock.index);
-    if (lock.read || lock.write) {
-      std::unique_lock index_lock{mutex};
-      auto &sector{sectors[lock.sector]};
-      ++sector.refs;
-      index_lock.unlock();
-      std::unique_lock sector_lock{sector.mutex};
-      while (true) {
-        if (sector.canLock(lock.read, lock.write)) {
-          for (auto i{0u}; i < kSectorFileTypeBits; ++i) {
-            if (lock.read & (1 << i)) {
-              ++sector.read[i];
-            }
-          }
-          sector.write = static_cast<SectorFileType>(sector.write | lock.write);
-          lock.index = shared_from_this();
-          return true;
-        } else if (wait) {
-          sector.cv.wait(sector_lock);
-        } else {
-          break;
-        }
+    if (!lock.read && !lock.write) {
+      return false;
+    }
+    if (wait) {
+      std::promise<void> locked;
+      lockAsync(lock, false, [&] { locked.set_value(); });
+      locked.get_future().wait();
+      return true;
+    }
+    std::lock_guard index_lock{mutex};
+    auto &sector{sectors[lock.sector]};
+    if (!sector.canLock(lock.read, lock.write)) {
+      if (!sector.refs) {
+        sectors.erase(lock.sector);
       }
+      return false;
     }
-    return false;
+    ++sector.refs;
+    acquire(sector, lock);
+    return true;
+  }
+
+  bool IndexLock::lockAsync(Lock &lock,
+                            bool priority,
+                            std::function<void()> cb) {
+    assert(!lock.index);
+    if (!lock.read && !lock.write) {
+      return false;
+    }
+    std::unique_lock index_lock{mutex};
+    auto &sector{sectors[lock.sector]};
+    ++sector.refs;
+    if (priority) {
+      sector.waiting.insert(
+          sector.waiting.begin() + sector.priority_waiting,
+          Waiter{&lock, std::move(cb)});
+      ++sector.priority_waiting;
+    } else {
+      sector.waiting.push_back(Waiter{&lock, std::move(cb)});
+    }
+    auto granted{grant(sector)};
+    index_lock.unlock();
+    for (auto &granted_cb : granted) {
+      granted_cb();
+    }
+    return true;
   }
 
   void IndexLock::unlock(Lock &lock) {
@@ -58,7 +109,6 @@ namespace fc::sector_storage::stores {
     lock.index.reset();
     std::unique_lock index_lock{mutex};
     auto &sector{sectors.at(lock.sector)};
-    std::unique_lock sector_lock{sector.mutex};
     for (auto i{0u}; i < kSectorFileTypeBits; ++i) {
       if (lock.read & (1 << i)) {
         --sector.read[i];
@@ -66,9 +116,13 @@ namespace fc::sector_storage::stores {
     }
     sector.write = static_cast<SectorFileType>(sector.write & ~lock.write);
     --sector.refs;
+    auto granted{grant(sector)};
     if (!sector.refs) {
       sectors.erase(lock.sector);
     }
-    sector.cv.notify_all();
+    index_lock.unlock();
+    for (auto &cb : granted) {
+      cb();
+    }
   }
 }  // namespace fc::sector_storage::stores
@@ -6,7 +6,8 @@
 #ifndef CPP_FILECOIN_CORE_SECTOR_STORAGE_STORES_INDEX_LOCK_HPP
 #define CPP_FILECOIN_CORE_SECTOR_STORAGE_STORES_INDEX_LOCK_HPP
 
-#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <mutex>
 
 #include "primitives/sector_file/sector_file.hpp"
@@ -31,21 +32,50 @@ namespace fc::sector_storage::stores {
       ~Lock() override;
     };
 
+    /// Queued lock request, granted in queue order
+    struct Waiter {
+      Lock *lock;
+      std::function<void()> cb;
+    };
+
     struct Sector {
       bool canLock(SectorFileType read, SectorFileType write) const;
 
-      std::mutex mutex;
-      std::condition_variable cv;
-      std::array<size_t, kSectorFileTypeBits> read;
-      SectorFileType write;
-      size_t refs;
+      std::array<size_t, kSectorFileTypeBits> read{};
+      SectorFileType write{};
+      /// Priority waiters first, then others in arrival order
+      std::deque<Waiter> waiting;
+      size_t priority_waiting{};
+      /// Holders and waiters
+      size_t refs{};
     };
 
+    /**
+     * Acquires lock.
+     * Waiting lock is queued behind earlier waiters, so writers are not
+     * starved by readers. Not waiting lock is granted when compatible with
+     * held locks, regardless of waiters.
+     * @return false if there is nothing to lock or not waiting lock failed
+     */
     bool lock(Lock &lock, bool wait);
+    /**
+     * Queues lock and calls cb when it is acquired, possibly in this call
+     * or on thread releasing conflicting lock. Consecutive compatible
+     * waiters are granted together. Priority waiters (e.g. PoSt readers)
+     * are queued before other waiters.
+     * Lock must outlive the call of cb.
+     * @return false if there is nothing to lock, cb is not called
+     */
+    bool lockAsync(Lock &lock, bool priority, std::function<void()> cb);
     void unlock(Lock &lock);
 
     std::mutex mutex;
     std::map<SectorId, Sector> sectors;
+
+   private:
+    void acquire(Sector &sector, Lock &lock);
+    /// Pops granted waiters, callbacks must be called without mutex
+    std::vector<std::function<void()>> grant(Sector &sector);
   };
 }  // namespace fc::sector_storage::stores
 
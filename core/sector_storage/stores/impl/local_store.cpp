@@ -12,12 +12,14 @@
 #include <map>
 #include <random>
 #include <regex>
+#include <thread>
 #include <utility>
 
 #include "api/rpc/json.hpp"
 #include "codec/json/json.hpp"
 #include "common/file.hpp"
 #include "primitives/sector_file/sector_file.hpp"
+#include "sector_storage/stores/impl/move_file.hpp"
 #include "sector_storage/stores/impl/util.hpp"
 #include "sector_storage/stores/storage_error.hpp"
 #include "sector_storage/stores/store_error.hpp"
@@ -230,14 +232,69 @@ namespace fc::sector_storage::stores {
 
     logger_->info("Remove " + sector_path.string());
 
-    boost::system::error_code ec;
-    boost::filesystem::remove_all(sector_path, ec);
-    if (ec.failed()) {
-      logger_->error(ec.message());
+    if (!trash_.put(path_iter->second->local_path, sector_path.string())) {
+      boost::system::error_code ec;
+      boost::filesystem::remove_all(sector_path, ec);
+      if (ec.failed()) {
+        logger_->error(ec.message());
+      }
     }
     return outcome::success();
   }
 
+  outcome::result<void> LocalStoreImpl::trash(const std::string &path) {
+    std::shared_lock lock(mutex_);
+    for (const auto &[id, root] : paths_) {
+      if (root->local_path.empty()) {
+        continue;
+      }
+      auto relative{boost::filesystem::path{path}.lexically_relative(
+          root->local_path)};
+      if (!relative.empty() && relative != "."
+          && *relative.begin() != "..") {
+        return trash_.put(root->local_path, path);
+      }
+    }
+    return StoreErrors::kNotFoundStorage;
+  }
+
+  outcome::result<uint64_t> LocalStoreImpl::prewarm(
+      SectorId sector, RegisteredProof seal_proof_type, SectorFileType types) {
+    OUTCOME_TRY(response,
+                acquireSector(sector,
+                              seal_proof_type,
+                              types,
+                              SectorFileType::FTNone,
+                              PathType::kStorage,
+                              AcquireMode::kCopy));
+    uint64_t bytes{};
+    auto warm{[&](const fs::path &path) {
+      auto _bytes{common::prewarmFile(path.string(), kPrewarmMaxFileSize)};
+      if (_bytes) {
+        bytes += _bytes.value();
+      }
+    }};
+    for (const auto &type : primitives::sector_file::kSectorFileTypes) {
+      if ((type & types) == 0) {
+        continue;
+      }
+      OUTCOME_TRY(path, response.paths.getPathByType(type));
+      if (path.empty()) {
+        return StoreErrors::kNotFoundSector;
+      }
+      boost::system::error_code ec;
+      if (fs::is_directory(path, ec)) {
+        for (fs::directory_iterator it{path, ec}, end; !ec && it != end;
+             it.increment(ec)) {
+          warm(it->path());
+        }
+      } else {
+        warm(path);
+      }
+    }
+    return bytes;
+  }
+
   outcome::result<void> LocalStoreImpl::moveStorage(
       SectorId sector, RegisteredProof seal_proof_type, SectorFileType types) {
     OUTCOME_TRY(dest,
@@ -279,10 +336,24 @@ namespace fc::sector_storage::stores {
       OUTCOME_TRY(source_path, src.paths.getPathByType(type));
       OUTCOME_TRY(dest_path, dest.paths.getPathByType(type));
 
-      boost::system::error_code ec;
-      boost::filesystem::rename(source_path, dest_path, ec);
-      if (ec.failed()) {
-        return StoreErrors::kCannotMoveSector;
+      auto start = std::chrono::steady_clock::now();
+      OUTCOME_TRY(moved, moveSectorFile(source_path, dest_path));
+      auto seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+      logger_->info("moved {} to {} by {} ({} bytes, {:.1f}s)",
+                    source_path,
+                    dest_path,
+                    moveMethodName(moved.method),
+                    moved.bytes,
+                    seconds);
+      {
+        std::lock_guard lock(move_stats_mutex_);
+        auto &stat = move_stats_[dest_storage_id];
+        ++stat.moves;
+        stat.bytes += moved.bytes;
+        stat.seconds += seconds;
+        ++stat.by_method[moved.method];
       }
 
       OUTCOME_TRY(
@@ -292,6 +363,12 @@ namespace fc::sector_storage::stores {
     return outcome::success();
   }
 
+  std::map<StorageID, LocalStoreImpl::MoveStat> LocalStoreImpl::moveStats()
+      const {
+    std::lock_guard lock(move_stats_mutex_);
+    return move_stats_;
+  }
+
   outcome::result<FsStat> LocalStoreImpl::getFsStat(
       fc::primitives::StorageID id) {
     std::shared_lock lock(mutex_);
@@ -301,7 +378,7 @@ namespace fc::sector_storage::stores {
       return StoreErrors::kNotFoundStorage;
     }
 
-    return storage_->getStat(path_iter->second->local_path);
+    return path_iter->second->getStat();
   }
 
   outcome::result<void> LocalStoreImpl::openPath(const std::string &path) {
@@ -318,7 +395,8 @@ namespace fc::sector_storage::stores {
 
     std::shared_ptr<Path> out = Path::newPath(path);
 
-    OUTCOME_TRY(stat, out->getStat(storage_));
+    out->sample(storage_);
+    OUTCOME_TRY(stat, out->getStat());
 
     OUTCOME_TRY(index_->storageAttach(
         StorageInfo{
@@ -360,6 +438,7 @@ namespace fc::sector_storage::stores {
       }
     }));
     paths_[meta.id] = out;
+    trash_.sweep(path);
 
     return outcome::success();
   }
@@ -469,7 +548,7 @@ namespace fc::sector_storage::stores {
         return StoreErrors::kNotFoundPath;
       }
 
-      OUTCOME_TRY(stat, path_iter->second->getStat(storage_));
+      OUTCOME_TRY(stat, path_iter->second->getStat());
 
       uint64_t overhead =
           (path_type == PathType::kStorage
@@ -491,12 +570,47 @@ namespace fc::sector_storage::stores {
     };
   }
 
+  void LocalStoreImpl::sampleStats() {
+    std::shared_lock lock(mutex_);
+    for (const auto &[id, path] : paths_) {
+      {
+        std::lock_guard stat_lock{path->stat_mutex};
+        if (path->sampling) {
+          continue;
+        }
+        path->sampling = true;
+        path->sampling_since = std::chrono::steady_clock::now();
+      }
+      // own thread, so hung mount blocks only its sampler
+      std::thread{[path = path, storage = storage_] {
+        path->sample(storage);
+      }}.detach();
+    }
+  }
+
   void LocalStoreImpl::reportHealth() {
+    sampleStats();
+
     std::map<StorageID, HealthReport> toReport;
     {
       std::shared_lock lock(mutex_);
+      auto now{std::chrono::steady_clock::now()};
       for (auto path : paths_) {
-        auto stat = path.second->getStat(storage_);
+        {
+          std::lock_guard stat_lock{path.second->stat_mutex};
+          if (path.second->sampling
+              && now - path.second->sampling_since
+                     > kSkippedHeartbeatThreshold) {
+            toReport.emplace(
+                path.first,
+                HealthReport{
+                    .stat = {},
+                    .error = std::string{"filesystem stat is not responding"},
+                });
+            continue;
+          }
+        }
+        auto stat = path.second->getStat();
         std::pair<StorageID, HealthReport> report;
         if (stat.has_error()) {
           report = std::make_pair(path.first,
@@ -533,45 +647,59 @@ namespace fc::sector_storage::stores {
         .string();
   }
 
-  outcome::result<FsStat> LocalStoreImpl::Path::getStat(
-      const std::shared_ptr<LocalStorage> &local_storage) const {
-    OUTCOME_TRY(stat, local_storage->getStat(local_path));
+  void LocalStoreImpl::Path::sample(
+      const std::shared_ptr<LocalStorage> &local_storage) {
+    auto sampleUsed{[&]() -> outcome::result<int64_t> {
+      int64_t used{0};
+      for (const auto &[id, file_type] : reservations) {
+        for (const auto &type : kSectorFileTypes) {
+          if ((type & file_type) == 0) {
+            continue;
+          }
 
-    stat.reserved = reserved;
+          auto sector_path = sectorPath(id, type);
 
-    for (const auto &[id, file_type] : reservations) {
-      for (const auto &type : kSectorFileTypes) {
-        if ((type & file_type) == 0) {
-          continue;
-        }
+          auto maybe_used = local_storage->getDiskUsage(sector_path);
+          if (maybe_used.has_error()) {
+            if (maybe_used != outcome::failure(StorageError::kFileNotExist)) {
+              return maybe_used.error();
+            }
 
-        auto sector_path = sectorPath(id, file_type);
+            OUTCOME_TRY(path, tempFetchDest(sector_path, false));
 
-        auto maybe_used = local_storage->getDiskUsage(sector_path);
-        if (maybe_used.has_error()) {
-          if (maybe_used != outcome::failure(StorageError::kFileNotExist)) {
-            return maybe_used.error();
+            maybe_used = local_storage->getDiskUsage(path);
+            if (maybe_used.has_error()) {
+              return maybe_used.error();
+            }
           }
+          used += maybe_used.value();
+        }
+      }
+      return used;
+    }};
 
-          OUTCOME_TRY(path, tempFetchDest(sector_path, false));
+    auto stat{local_storage->getStat(local_path)};
+    auto used{stat ? sampleUsed() : outcome::result<int64_t>{0}};
 
-          maybe_used = local_storage->getDiskUsage(path);
-          if (maybe_used.has_error()) {
-            return maybe_used.error();
-          }
-        }
+    std::lock_guard lock{stat_mutex};
+    if (used) {
+      sampled = std::move(stat);
+      reserved_used = used.value();
+    } else {
+      sampled = used.error();
+    }
+    sampling = false;
+  }
 
-        if (stat.reserved < maybe_used.value()) {
-          stat.reserved = 0;
-          break;
-        } else {
-          stat.reserved -= maybe_used.value();
-        }
-      }
-      if (stat.reserved == 0) {
-        break;
-      }
+  outcome::result<FsStat> LocalStoreImpl::Path::getStat() const {
+    std::unique_lock lock{stat_mutex};
+    if (!sampled) {
+      return sampled.error();
     }
+    auto stat{sampled.value()};
+    lock.unlock();
+
+    stat.reserved = reserved > reserved_used ? reserved - reserved_used : 0;
 
     if (stat.available < stat.reserved) {
       stat.available = 0;
@@ -10,13 +10,21 @@
 
 #include <boost/asio/io_context.hpp>
 #include <libp2p/protocol/common/scheduler.hpp>
+#include <map>
+#include <mutex>
 #include <shared_mutex>
 #include "common/logger.hpp"
+#include "sector_storage/stores/impl/move_file.hpp"
+#include "sector_storage/stores/impl/trash.hpp"
 #include "sector_storage/stores/index.hpp"
+#include "sector_storage/stores/store_error.hpp"
 
 namespace fc::sector_storage::stores {
   using libp2p::protocol::Scheduler;
 
+  /// Parses sector id from sector file name, e.g. "s-t01000-1"
+  outcome::result<SectorId> parseSectorId(const std::string &filename);
+
   class LocalStoreImpl : public LocalStore {
    public:
     static outcome::result<std::shared_ptr<LocalStore>> newLocalStore(
@@ -46,6 +54,18 @@ namespace fc::sector_storage::stores {
 
     outcome::result<FsStat> getFsStat(StorageID id) override;
 
+    /// Sector moves into storage path
+    struct MoveStat {
+      uint64_t moves{};
+      uint64_t bytes{};
+      /// Time spent moving, bytes / seconds is throughput of path
+      double seconds{};
+      std::map<MoveMethod, uint64_t> by_method;
+    };
+
+    /// Move statistics by destination storage
+    std::map<StorageID, MoveStat> moveStats() const;
+
     outcome::result<std::vector<primitives::StoragePath>> getAccessiblePaths()
         override;
 
@@ -59,6 +79,12 @@ namespace fc::sector_storage::stores {
         const SectorPaths &storages,
         PathType path_type) override;
 
+    outcome::result<uint64_t> prewarm(SectorId sector,
+                                      RegisteredProof seal_proof_type,
+                                      SectorFileType types) override;
+
+    outcome::result<void> trash(const std::string &path) override;
+
    private:
     LocalStoreImpl(std::shared_ptr<LocalStorage> storage,
                    std::shared_ptr<SectorIndex> index,
@@ -68,6 +94,8 @@ namespace fc::sector_storage::stores {
                                        SectorFileType type,
                                        const StorageID &storage);
     void reportHealth();
+    /// Starts background stat sampling of paths which are not sampling
+    void sampleStats();
     struct Path {
       static std::shared_ptr<Path> newPath(std::string path);
 
@@ -76,8 +104,18 @@ namespace fc::sector_storage::stores {
       int64_t reserved = 0;
       std::map<SectorId, SectorFileType> reservations = {};
 
-      outcome::result<FsStat> getStat(
-          const std::shared_ptr<LocalStorage> &local_storage) const;
+      /// Reads filesystem stat and usage of reserved sectors, may block
+      void sample(const std::shared_ptr<LocalStorage> &local_storage);
+
+      /// Last sampled stat with current reservations, doesn't block on io
+      outcome::result<FsStat> getStat() const;
+
+      mutable std::mutex stat_mutex;
+      outcome::result<FsStat> sampled{StoreErrors::kNotFoundStorage};
+      /// Disk usage of reserved sectors at sampling
+      int64_t reserved_used = 0;
+      bool sampling = false;
+      std::chrono::steady_clock::time_point sampling_since;
 
       std::string sectorPath(const SectorId &sid, SectorFileType type) const;
 
@@ -93,6 +131,9 @@ namespace fc::sector_storage::stores {
     Scheduler::Handle handler_;
     int64_t heartbeat_interval_;
     mutable std::shared_mutex mutex_;
+    std::map<StorageID, MoveStat> move_stats_;
+    mutable std::mutex move_stats_mutex_;
+    Trash trash_;
   };
 
 }  // namespace fc::sector_storage::stores
@@ -0,0 +1,190 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/stores/impl/move_file.hpp"
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include <cerrno>
+
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+#include "sector_storage/stores/store_error.hpp"
+
+namespace fc::sector_storage::stores {
+  namespace fs = boost::filesystem;
+
+  namespace {
+    /// Bytes copied by one syscall
+    constexpr size_t kCopyChunk = size_t{1} << 30;
+
+    struct Fd {
+      explicit Fd(int fd) : fd{fd} {}
+      Fd(const Fd &) = delete;
+      ~Fd() {
+        if (fd >= 0) {
+          close(fd);
+        }
+      }
+      int fd;
+    };
+
+    /// Copies data left after offset in kernel, without userspace buffers
+    bool copyRange(int in, int out, uint64_t offset, uint64_t size) {
+      auto _offset = static_cast<off_t>(offset);
+      bool copy_range = true;
+      while (static_cast<uint64_t>(_offset) < size) {
+        auto left = std::min<uint64_t>(size - _offset, kCopyChunk);
+        ssize_t copied = -1;
+#ifdef __linux__
+        if (copy_range) {
+          off_t out_offset = _offset;
+          copied = copy_file_range(in, &_offset, out, &out_offset, left, 0);
+          if (copied < 0 && (errno == ENOSYS || errno == EXDEV
+                             || errno == EINVAL || errno == EOPNOTSUPP)) {
+            copy_range = false;
+          } else if (copied < 0 && errno == EINTR) {
+            continue;
+          }
+        }
+#endif
+        if (!copy_range) {
+          if (lseek(out, _offset, SEEK_SET) < 0) {
+            return false;
+          }
+          copied = sendfile(out, in, &_offset, left);
+        }
+        if (copied < 0 && errno == EINTR) {
+          continue;
+        }
+        if (copied <= 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    outcome::result<MoveMethod> copyRegularFile(const std::string &from,
+                                                const std::string &to,
+                                                uint64_t &bytes) {
+      Fd in{open(from.c_str(), O_RDONLY)};
+      if (in.fd < 0) {
+        return StoreErrors::kCannotMoveFile;
+      }
+      struct stat st {};
+      if (fstat(in.fd, &st) != 0) {
+        return StoreErrors::kCannotMoveFile;
+      }
+      Fd out{open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, st.st_mode)};
+      if (out.fd < 0) {
+        return StoreErrors::kCannotMoveFile;
+      }
+      auto size = static_cast<uint64_t>(st.st_size);
+      bytes += size;
+      auto method = MoveMethod::kCopy;
+#ifdef FICLONE
+      if (ioctl(out.fd, FICLONE, in.fd) == 0) {
+        method = MoveMethod::kReflink;
+      }
+#endif
+      if (method == MoveMethod::kCopy && !copyRange(in.fd, out.fd, 0, size)) {
+        return StoreErrors::kCannotMoveFile;
+      }
+      if (fsync(out.fd) != 0) {
+        return StoreErrors::kCannotMoveFile;
+      }
+      return method;
+    }
+
+    void merge(MoveResult &result, MoveMethod method) {
+      if (method > result.method) {
+        result.method = method;
+      }
+    }
+  }  // namespace
+
+  std::string moveMethodName(MoveMethod method) {
+    switch (method) {
+      case MoveMethod::kRename:
+        return "rename";
+      case MoveMethod::kReflink:
+        return "reflink";
+      case MoveMethod::kCopy:
+        return "copy";
+    }
+    return "unknown";
+  }
+
+  outcome::result<MoveResult> copySectorFile(const std::string &from,
+                                             const std::string &to) {
+    MoveResult result{MoveMethod::kReflink};
+    boost::system::error_code ec;
+    if (!fs::is_directory(from, ec)) {
+      OUTCOME_TRY(method, copyRegularFile(from, to, result.bytes));
+      merge(result, method);
+      return result;
+    }
+    fs::create_directories(to, ec);
+    if (ec.failed()) {
+      return StoreErrors::kCannotCreateDir;
+    }
+    for (fs::recursive_directory_iterator it{from, ec}, end; it != end;
+         it.increment(ec)) {
+      if (ec.failed()) {
+        return StoreErrors::kCannotMoveFile;
+      }
+      auto dest = fs::path{to} / fs::relative(it->path(), from, ec);
+      if (ec.failed()) {
+        return StoreErrors::kCannotMoveFile;
+      }
+      if (fs::is_directory(it->status())) {
+        fs::create_directories(dest, ec);
+        if (ec.failed()) {
+          return StoreErrors::kCannotCreateDir;
+        }
+        continue;
+      }
+      OUTCOME_TRY(method,
+                  copyRegularFile(
+                      it->path().string(), dest.string(), result.bytes));
+      merge(result, method);
+    }
+    return result;
+  }
+
+  outcome::result<MoveResult> moveSectorFile(const std::string &from,
+                                             const std::string &to) {
+    boost::system::error_code ec;
+    fs::rename(from, to, ec);
+    if (!ec.failed()) {
+      return MoveResult{};
+    }
+    if (ec.value() != EXDEV) {
+      return StoreErrors::kCannotMoveSector;
+    }
+
+    // other filesystem, destination appears only when complete
+    auto temp = to + ".moving";
+    fs::remove_all(temp, ec);
+    auto copied = copySectorFile(from, temp);
+    if (!copied) {
+      fs::remove_all(temp, ec);
+      return copied.error();
+    }
+    fs::rename(temp, to, ec);
+    if (ec.failed()) {
+      fs::remove_all(temp, ec);
+      return StoreErrors::kCannotMoveSector;
+    }
+    fs::remove_all(from, ec);
+    return copied;
+  }
+}  // namespace fc::sector_storage::stores
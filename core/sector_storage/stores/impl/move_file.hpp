@@ -0,0 +1,42 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+
+#include "common/outcome.hpp"
+
+namespace fc::sector_storage::stores {
+  /// How sector file data got to destination
+  enum class MoveMethod {
+    /// Same filesystem, no data copied
+    kRename,
+    /// Extents shared with source (FICLONE on CoW filesystem)
+    kReflink,
+    /// Data copied in kernel (copy_file_range or sendfile)
+    kCopy,
+  };
+
+  std::string moveMethodName(MoveMethod method);
+
+  struct MoveResult {
+    /// Slowest method used for any file
+    MoveMethod method{MoveMethod::kRename};
+    uint64_t bytes{};
+  };
+
+  /**
+   * Moves sector file or directory. Uses rename if possible, otherwise files
+   * are reflinked or copied to temporary path near destination, which is
+   * renamed to destination before source is removed.
+   */
+  outcome::result<MoveResult> moveSectorFile(const std::string &from,
+                                             const std::string &to);
+
+  /// Copies file or directory tree, reflinking files if possible
+  outcome::result<MoveResult> copySectorFile(const std::string &from,
+                                             const std::string &to);
+}  // namespace fc::sector_storage::stores
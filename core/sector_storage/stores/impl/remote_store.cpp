@@ -6,12 +6,21 @@
 #include "sector_storage/stores/impl/remote_store.hpp"
 
 #include <curl/curl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <thread>
 #include <utility>
 
 #include "api/rpc/json.hpp"
 #include "codec/json/json.hpp"
 #include "common/tarutil.hpp"
+#include "common/tracing.hpp"
 #include "common/uri_parser/uri_parser.hpp"
 #include "sector_storage/stores/impl/util.hpp"
 #include "sector_storage/stores/store_error.hpp"
@@ -28,12 +37,94 @@ namespace {
     return totalBytes;
   }
 
-  std::size_t callbackFile(const char *ptr,
+  /// Parallel connections of one ranged fetch
+  constexpr size_t kFetchConnections = 4;
+  constexpr uint64_t kFetchChunkSize = uint64_t{64} << 20;
+  /// Many small files of sector cache are fetched one by one
+  constexpr auto kFetchLogInterval{std::chrono::seconds(1)};
+  /// Failed chunk is retried, then fetch fails and can be resumed later
+  constexpr size_t kFetchChunkRetries = 3;
+
+  struct ChunkWrite {
+    int fd;
+    uint64_t begin;
+    uint64_t written;
+    uint64_t index{};
+    /// Total size from content range header
+    uint64_t total{};
+  };
+
+  std::size_t callbackChunk(const char *ptr,
+                            std::size_t size,
+                            std::size_t nmemb,
+                            ChunkWrite *chunk) {
+    const std::size_t totalBytes(size * nmemb);
+    std::size_t offset = 0;
+    while (offset < totalBytes) {
+      auto written = pwrite(chunk->fd,
+                            ptr + offset,
+                            totalBytes - offset,
+                            chunk->begin + chunk->written);
+      if (written <= 0) {
+        return 0;
+      }
+      offset += written;
+      chunk->written += written;
+    }
+    return totalBytes;
+  }
+
+  /// Parses total size from "Content-Range: bytes <begin>-<end>/<total>"
+  std::size_t callbackHeader(const char *ptr,
+                             std::size_t size,
+                             std::size_t nmemb,
+                             ChunkWrite *chunk) {
+    const std::size_t totalBytes(size * nmemb);
+    std::string header{ptr, totalBytes};
+    std::string prefix{"content-range:"};
+    if (header.size() > prefix.size()
+        && boost::algorithm::iequals(header.substr(0, prefix.size()),
+                                     prefix)) {
+      auto slash = header.rfind('/');
+      if (slash != std::string::npos) {
+        chunk->total = std::strtoull(header.c_str() + slash + 1, nullptr, 10);
+      }
+    }
+    return totalBytes;
+  }
+
+  struct PipeWrite {
+    int fd;
+    CURL *curl;
+    std::atomic_bool abort{false};
+    bool checked{false};
+    bool is_tar{false};
+  };
+
+  std::size_t callbackPipe(const char *ptr,
                            std::size_t size,
                            std::size_t nmemb,
-                           std::ofstream *stream) {
+                           PipeWrite *pipe_write) {
     const std::size_t totalBytes(size * nmemb);
-    stream->write(ptr, size);
+    if (!pipe_write->checked) {
+      pipe_write->checked = true;
+      char *content_type = nullptr;
+      curl_easy_getinfo(
+          pipe_write->curl, CURLINFO_CONTENT_TYPE, &content_type);
+      pipe_write->is_tar =
+          content_type && std::string{content_type} == "application/x-tar";
+    }
+    if (pipe_write->abort || !pipe_write->is_tar) {
+      return 0;
+    }
+    std::size_t offset = 0;
+    while (offset < totalBytes) {
+      auto written = write(pipe_write->fd, ptr + offset, totalBytes - offset);
+      if (written <= 0) {
+        return 0;
+      }
+      offset += written;
+    }
     return totalBytes;
   }
 }  // namespace
@@ -283,14 +374,8 @@ namespace fc::sector_storage::stores {
     for (const auto &info : infos) {
       OUTCOME_TRY(temp_dest, tempFetchDest(dest, true));
       for (const auto &url : info.urls) {
-        boost::system::error_code ec;
-        fs::remove_all(temp_dest, ec);
-        if (ec.failed()) {
-          logger_->error("cannot remove temp path: {}", ec.message());
-          return StoreErrors::kCannotRemovePath;
-        }
-
-        auto maybe_error = fetch(url, temp_dest);
+        // partial download of previous attempt is resumed by fetch
+        auto maybe_error = fetch(url, temp_dest, file_type);
         if (maybe_error.has_error()) {
           logger_->warn("acquireFromRemote: failed to acqiure from {} - {}",
                         url,
@@ -298,6 +383,7 @@ namespace fc::sector_storage::stores {
           continue;
         }
 
+        boost::system::error_code ec;
         fs::rename(temp_dest, dest, ec);
         if (ec.failed()) {
           logger_->error("cannot move from temp to dest: {}", ec.message());
@@ -311,94 +397,310 @@ namespace fc::sector_storage::stores {
     return StoreErrors::kUnableRemoteAcquireSector;
   }
 
+  curl_slist *RemoteStoreImpl::authHeaders() const {
+    struct curl_slist *headers = nullptr;
+    for (const auto &header : auth_headers_) {
+      headers = curl_slist_append(
+          headers, (header.first + ": " + header.second).c_str());
+    }
+    return headers;
+  }
+
   outcome::result<void> RemoteStoreImpl::fetch(const std::string &url,
-                                               const std::string &output_path) {
-    logger_->info("fetch: {} -> {}", url, output_path);
+                                               const std::string &output_path,
+                                               SectorFileType file_type) {
+    FC_LOG_INFO_EVERY(
+        kFetchLogInterval, logger_, "fetch: {} -> {}", url, output_path);
+    common::tracing::Span span{"store.fetch"};
+    span.attribute("url", url);
 
-    CURL *curl = curl_easy_init();
+    boost::system::error_code ec;
+    if (file_type == SectorFileType::FTCache) {
+      fs::remove_all(output_path, ec);
+      if (ec.failed()) {
+        logger_->error("Cannot remove output path: {}", ec.message());
+        return StoreErrors::kCannotRemovePath;
+      }
+      return fetchTar(url, output_path);
+    }
 
+    OUTCOME_TRY(fetchRanges(url, output_path));
+    return outcome::success();
+  }
+
+  outcome::result<void> RemoteStoreImpl::fetchTar(
+      const std::string &url, const std::string &output_path) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+      return StoreErrors::kCannotOpenTempFile;
+    }
+
+    CURL *curl = curl_easy_init();
     if (!curl) {
+      close(fds[0]);
+      close(fds[1]);
       return StoreErrors::kUnableCreateRequest;
     }
     curl_easy_setopt(curl, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4);
-
-    // Follow HTTP redirects if necessary
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-
-    fs::path temp_file_path =
-        fs::temp_directory_path() / (fs::unique_path().string() + ".tar");
-
-    std::ofstream temp_file(temp_file_path.string(),
-                            std::ios_base::out | std::ios_base::binary);
-
-    if (!temp_file.good()) {
-      curl_easy_cleanup(curl);
-      return StoreErrors::kCannotOpenTempFile;
-    }
-
-    struct curl_slist *headers = nullptr;
-
-    for (const auto &header : auth_headers_) {
-      headers = curl_slist_append(
-          headers, (header.first + ": " + header.second).c_str());
+    auto headers = authHeaders();
+    if (headers) {
+      curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
     }
 
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, callbackFile);
-
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &temp_file);
+    PipeWrite pipe_write{fds[1], curl};
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, callbackPipe);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &pipe_write);
 
-    if (headers) {
-      curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    // download on other thread, extract while downloading
+    std::thread download([&] {
+      curl_easy_perform(curl);
+      close(fds[1]);
+    });
+    auto extracted = common::extractTar(fds[0], output_path);
+    // unblock download if extraction stopped early
+    pipe_write.abort = true;
+    char drain[4096];
+    while (read(fds[0], drain, sizeof(drain)) > 0) {
     }
+    download.join();
+    close(fds[0]);
 
-    long status_code;
-    std::string content_type;
-    curl_easy_perform(curl);
+    long status_code = 0;
     curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
-    curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &content_type);
     curl_easy_cleanup(curl);
     if (headers) {
       curl_slist_free_all(headers);
     }
 
-    temp_file.close();
-
+    auto remove_output = [&] {
+      boost::system::error_code ec;
+      fs::remove_all(output_path, ec);
+    };
     if (status_code != 200) {
       logger_->error("non-200 code - {}", status_code);
+      remove_output();
       return StoreErrors::kNotOkStatusCode;
     }
+    if (!pipe_write.is_tar) {
+      remove_output();
+      return StoreErrors::kUnknownContentType;
+    }
+    if (extracted.has_error()) {
+      remove_output();
+      return extracted.error();
+    }
+    return outcome::success();
+  }
 
-    boost::system::error_code ec;
-    fs::remove_all(output_path, ec);
+  outcome::result<void> RemoteStoreImpl::fetchRanges(
+      const std::string &url, const std::string &output_path) {
+    auto part_path = output_path + ".part";
+    auto done_path = output_path + ".done";
 
-    if (ec.failed()) {
-      logger_->error("Cannot remove output path: {}", ec.message());
-      return StoreErrors::kCannotRemovePath;
+    int fd = open(part_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+      return StoreErrors::kCannotOpenTempFile;
     }
-    ec.clear();
+    auto _close = gsl::finally([&] { close(fd); });
+
+    // resume state: total size, then indices of downloaded chunks
+    uint64_t size = 0;
+    std::set<uint64_t> done;
+    {
+      std::ifstream done_file(done_path);
+      if (done_file >> size) {
+        uint64_t index;
+        while (done_file >> index) {
+          done.insert(index);
+        }
+      }
+    }
+    std::ofstream done_file(done_path, std::ios::app);
 
-    if (content_type == "application/x-tar") {
-      auto result =
-          fc::common::extractTar(temp_file_path.string(), output_path);
-      fs::remove_all(temp_file_path, ec);
-      if (ec.failed()) {
-        logger_->warn("fetch: failed to remove archive - {}", ec.message());
+    auto headers = authHeaders();
+    auto _headers = gsl::finally([&] {
+      if (headers) {
+        curl_slist_free_all(headers);
+      }
+    });
+    auto makeRequest = [&](ChunkWrite &chunk) -> CURL * {
+      CURL *curl = curl_easy_init();
+      if (!curl) {
+        return nullptr;
+      }
+      curl_easy_setopt(curl, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4);
+      curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+      curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+      if (headers) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+      }
+      auto range = std::to_string(chunk.begin) + "-"
+                   + std::to_string(chunk.begin + kFetchChunkSize - 1);
+      curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+      curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, callbackChunk);
+      curl_easy_setopt(curl, CURLOPT_WRITEDATA, &chunk);
+      curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, callbackHeader);
+      curl_easy_setopt(curl, CURLOPT_HEADERDATA, &chunk);
+      curl_easy_setopt(curl, CURLOPT_PRIVATE, &chunk);
+      return curl;
+    };
+
+    if (size == 0) {
+      // first chunk tells total size, or whole file if ranges are not
+      // supported
+      ChunkWrite chunk{fd, 0, 0};
+      CURL *curl = makeRequest(chunk);
+      if (!curl) {
+        return StoreErrors::kUnableCreateRequest;
+      }
+      curl_easy_perform(curl);
+      long status_code = 0;
+      char *content_type = nullptr;
+      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
+      curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &content_type);
+      auto octet = content_type
+                   && std::string{content_type} == "application/octet-stream";
+      curl_easy_cleanup(curl);
+
+      if (status_code != 200 && status_code != 206) {
+        logger_->error("non-200 code - {}", status_code);
+        return StoreErrors::kNotOkStatusCode;
+      }
+      if (!octet) {
+        return StoreErrors::kUnknownContentType;
+      }
+      if (status_code == 200) {
+        size = chunk.written;
+      } else {
+        size = chunk.total;
+        if (size == 0) {
+          return StoreErrors::kNotOkStatusCode;
+        }
+        if (chunk.written != std::min<uint64_t>(size, kFetchChunkSize)) {
+          return StoreErrors::kNotOkStatusCode;
+        }
+      }
+      done_file << size << std::endl << 0 << std::endl;
+      done.insert(0);
+      if (status_code == 200) {
+        done.clear();
+        for (uint64_t i = 0; i * kFetchChunkSize < size; ++i) {
+          done.insert(i);
+        }
       }
-      return result;
     }
 
-    if (content_type == "application/octet-stream") {
-      fs::rename(temp_file_path, output_path, ec);
-      if (ec.failed()) {
-        logger_->error("Cannot move file: {}", ec.message());
-        return StoreErrors::kCannotMoveFile;
+    std::deque<uint64_t> missing;
+    for (uint64_t i = 0; i * kFetchChunkSize < size; ++i) {
+      if (done.count(i) == 0) {
+        missing.push_back(i);
       }
-      return outcome::success();
     }
 
-    return StoreErrors::kUnknownContentType;
+    if (!missing.empty()) {
+      logger_->info("fetch: {} chunks of {} with {} connections",
+                    missing.size(),
+                    url,
+                    kFetchConnections);
+      CURLM *multi = curl_multi_init();
+      if (!multi) {
+        return StoreErrors::kUnableCreateRequest;
+      }
+      auto _multi = gsl::finally([&] { curl_multi_cleanup(multi); });
+      std::list<ChunkWrite> chunks;
+      std::map<uint64_t, size_t> retries;
+      bool failed = false;
+
+      auto start = [&](uint64_t index) -> bool {
+        auto &chunk = chunks.emplace_back(
+            ChunkWrite{fd, index * kFetchChunkSize, 0});
+        chunk.index = index;
+        CURL *curl = makeRequest(chunk);
+        if (!curl) {
+          return false;
+        }
+        curl_multi_add_handle(multi, curl);
+        return true;
+      };
+      size_t running = 0;
+      while (running < kFetchConnections && !missing.empty()) {
+        if (!start(missing.front())) {
+          return StoreErrors::kUnableCreateRequest;
+        }
+        missing.pop_front();
+        ++running;
+      }
+
+      while (running != 0) {
+        int still_running = 0;
+        curl_multi_perform(multi, &still_running);
+        int messages = 0;
+        while (auto message = curl_multi_info_read(multi, &messages)) {
+          if (message->msg != CURLMSG_DONE) {
+            continue;
+          }
+          CURL *curl = message->easy_handle;
+          ChunkWrite *chunk = nullptr;
+          long status_code = 0;
+          curl_easy_getinfo(curl, CURLINFO_PRIVATE, &chunk);
+          curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
+          auto expected =
+              std::min<uint64_t>(size - chunk->begin, kFetchChunkSize);
+          auto ok = message->data.result == CURLE_OK && status_code == 206
+                    && chunk->written == expected;
+          auto index = chunk->index;
+          curl_multi_remove_handle(multi, curl);
+          curl_easy_cleanup(curl);
+          chunks.remove_if([&](auto &c) { return &c == chunk; });
+          --running;
+
+          if (ok) {
+            done_file << index << std::endl;
+          } else if (++retries[index] <= kFetchChunkRetries && !failed) {
+            logger_->warn("fetch: retry chunk {} of {}", index, url);
+            missing.push_front(index);
+          } else {
+            failed = true;
+          }
+          if (!failed && !missing.empty()) {
+            if (!start(missing.front())) {
+              failed = true;
+              continue;
+            }
+            missing.pop_front();
+            ++running;
+          }
+        }
+        if (running != 0) {
+          curl_multi_wait(multi, nullptr, 0, 1000, nullptr);
+        }
+      }
+      if (failed) {
+        // downloaded chunks are kept to resume
+        return StoreErrors::kNotOkStatusCode;
+      }
+    }
+
+    if (ftruncate(fd, size) != 0) {
+      return StoreErrors::kCannotMoveFile;
+    }
+    done_file.close();
+
+    boost::system::error_code ec;
+    fs::remove_all(output_path, ec);
+    if (ec.failed()) {
+      logger_->error("Cannot remove output path: {}", ec.message());
+      return StoreErrors::kCannotRemovePath;
+    }
+    fs::rename(part_path, output_path, ec);
+    if (ec.failed()) {
+      logger_->error("Cannot move file: {}", ec.message());
+      return StoreErrors::kCannotMoveFile;
+    }
+    fs::remove(done_path, ec);
+    return outcome::success();
   }
 
   outcome::result<void> RemoteStoreImpl::deleteFromRemote(
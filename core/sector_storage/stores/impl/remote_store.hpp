@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_REMOTE_STORE_HPP
 #define CPP_FILECOIN_REMOTE_STORE_HPP
 
+#include <curl/curl.h>
+
 #include "sector_storage/stores/store.hpp"
 
 #include "sector_storage/stores/impl/local_store.hpp"
@@ -48,8 +50,25 @@ namespace fc::sector_storage::stores {
                                                    SectorFileType file_type,
                                                    const std::string &dest);
 
+    /**
+     * Fetches file of sector. Cache directory is extracted while tar is
+     * downloaded, sealed and unsealed files are downloaded by ranges over
+     * several connections and resumed from output_path.part
+     */
     outcome::result<void> fetch(const std::string &url,
-                                const std::string &output_path);
+                                const std::string &output_path,
+                                SectorFileType file_type);
+
+    /// Streams tar from url to extraction to output_path
+    outcome::result<void> fetchTar(const std::string &url,
+                                   const std::string &output_path);
+
+    /// Downloads file by resumable parallel ranged requests
+    outcome::result<void> fetchRanges(const std::string &url,
+                                      const std::string &output_path);
+
+    /// Auth headers for request, must be freed by caller
+    curl_slist *authHeaders() const;
 
     outcome::result<void> deleteFromRemote(const std::string &url);
 
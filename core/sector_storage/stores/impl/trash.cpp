@@ -0,0 +1,127 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/stores/impl/trash.hpp"
+
+#include <boost/filesystem.hpp>
+#include <chrono>
+
+#include "sector_storage/stores/store_error.hpp"
+
+namespace fc::sector_storage::stores {
+  namespace fs = boost::filesystem;
+
+  Trash::Trash(uint64_t bytes_per_second)
+      : bytes_per_second_{bytes_per_second}, thread_{[this] { run(); }} {}
+
+  Trash::~Trash() {
+    {
+      std::lock_guard lock{mutex_};
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  outcome::result<void> Trash::put(const std::string &root,
+                                   const std::string &path) {
+    boost::system::error_code ec;
+    auto trash{fs::path{root} / kTrashDir};
+    fs::create_directories(trash, ec);
+    if (ec) {
+      return StoreErrors::kCannotCreateDir;
+    }
+    std::unique_lock lock{mutex_};
+    auto id{next_id_++};
+    lock.unlock();
+    auto to{trash
+            / (fs::path{path}.filename().string() + "."
+               + std::to_string(std::chrono::system_clock::now()
+                                    .time_since_epoch()
+                                    .count())
+               + "." + std::to_string(id))};
+    fs::rename(path, to, ec);
+    if (ec) {
+      return StoreErrors::kCannotRemovePath;
+    }
+    lock.lock();
+    queue_.push_back(to.string());
+    lock.unlock();
+    cv_.notify_all();
+    return outcome::success();
+  }
+
+  void Trash::sweep(const std::string &root) {
+    boost::system::error_code ec;
+    auto trash{fs::path{root} / kTrashDir};
+    if (!fs::is_directory(trash, ec)) {
+      return;
+    }
+    std::unique_lock lock{mutex_};
+    for (fs::directory_iterator it{trash, ec}, end; !ec && it != end;
+         it.increment(ec)) {
+      queue_.push_back(it->path().string());
+    }
+    lock.unlock();
+    cv_.notify_all();
+  }
+
+  void Trash::flush() {
+    std::unique_lock lock{mutex_};
+    cv_.wait(lock, [&] { return queue_.empty() && !removing_; });
+  }
+
+  void Trash::run() {
+    std::unique_lock lock{mutex_};
+    while (true) {
+      cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+      if (stop_) {
+        // rest is removed after sweep on next start
+        return;
+      }
+      auto path{std::move(queue_.front())};
+      queue_.pop_front();
+      removing_ = true;
+      lock.unlock();
+      removeLimited(path);
+      lock.lock();
+      removing_ = false;
+      cv_.notify_all();
+    }
+  }
+
+  void Trash::removeLimited(const std::string &path) {
+    using std::chrono::steady_clock;
+    boost::system::error_code ec;
+    auto start{steady_clock::now()};
+    uint64_t removed{0};
+    if (fs::is_directory(path, ec)) {
+      std::vector<fs::path> files;
+      for (fs::recursive_directory_iterator it{path, ec}, end;
+           !ec && it != end;
+           it.increment(ec)) {
+        if (fs::is_regular_file(it->status())) {
+          files.push_back(it->path());
+        }
+      }
+      for (auto &file : files) {
+        auto size{fs::file_size(file, ec)};
+        fs::remove(file, ec);
+        if (!ec && bytes_per_second_ != 0) {
+          removed += size;
+          auto due{start
+                   + std::chrono::duration_cast<steady_clock::duration>(
+                       std::chrono::duration<double>(
+                           static_cast<double>(removed) / bytes_per_second_))};
+          std::unique_lock lock{mutex_};
+          if (cv_.wait_until(lock, due, [&] { return stop_; })) {
+            return;
+          }
+        }
+      }
+    }
+    fs::remove_all(path, ec);
+  }
+}  // namespace fc::sector_storage::stores
@@ -0,0 +1,59 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "common/outcome.hpp"
+
+namespace fc::sector_storage::stores {
+  /// Trash directory name in storage path
+  const std::string kTrashDir{".trash"};
+
+  /// Default removal rate, bytes per second
+  constexpr uint64_t kDefaultTrashRate{uint64_t{2} << 30};
+
+  /**
+   * Removes files in background, so callers don't wait for removal of large
+   * sector files and cache directories.
+   * Path is renamed into trash directory of its storage path, which is
+   * instant on same filesystem, and removed file by file on own thread at
+   * limited rate, so removal doesn't starve sealing and PoSt disk io.
+   * Leftovers of previous runs are removed after sweep.
+   */
+  class Trash {
+   public:
+    explicit Trash(uint64_t bytes_per_second = kDefaultTrashRate);
+    ~Trash();
+
+    /// Moves path inside storage root to trash and queues its removal
+    outcome::result<void> put(const std::string &root,
+                              const std::string &path);
+
+    /// Queues removal of leftovers in trash of storage root
+    void sweep(const std::string &root);
+
+    /// Waits until queued paths are removed
+    void flush();
+
+   private:
+    void run();
+    void removeLimited(const std::string &path);
+
+    uint64_t bytes_per_second_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::string> queue_;
+    bool removing_{false};
+    bool stop_{false};
+    uint64_t next_id_{};
+    std::thread thread_;
+  };
+}  // namespace fc::sector_storage::stores
@@ -7,6 +7,7 @@
 #define CPP_FILECOIN_CORE_SECTOR_INDEX_HPP
 
 #include <chrono>
+#include <functional>
 #include "common/outcome.hpp"
 #include "primitives/sector/sector.hpp"
 #include "primitives/sector_file/sector_file.hpp"
@@ -95,6 +96,19 @@ namespace fc::sector_storage::stores {
     virtual std::unique_ptr<Lock> storageTryLock(const SectorId &sector,
                                                  SectorFileType read,
                                                  SectorFileType write) = 0;
+
+    /**
+     * Waits for lock without blocking thread.
+     * Waiters are served in order, priority waiters (e.g. PoSt readers)
+     * before others.
+     * cb may be called in this call or on thread releasing conflicting lock.
+     */
+    virtual void storageLockAsync(
+        const SectorId &sector,
+        SectorFileType read,
+        SectorFileType write,
+        bool priority,
+        std::function<void(outcome::result<std::unique_ptr<Lock>>)> cb) = 0;
   };
 
   enum class IndexErrors {
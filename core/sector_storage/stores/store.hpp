@@ -68,6 +68,9 @@ namespace fc::sector_storage::stores {
 
   const std::string kMetaFileName = "sectorstore.json";
 
+  /// Sealed files of large sectors are only read sparsely by PoSt
+  constexpr uint64_t kPrewarmMaxFileSize{uint64_t{1} << 30};
+
   class LocalStore : public Store {
    public:
     virtual outcome::result<void> openPath(const std::string &path) = 0;
@@ -82,6 +85,19 @@ namespace fc::sector_storage::stores {
         SectorFileType file_type,
         const SectorPaths &storages,
         PathType path_type) = 0;
+
+    /// Removes file or directory inside storage path in background
+    virtual outcome::result<void> trash(const std::string &path) = 0;
+
+    /**
+     * Starts reading local sector files of types (files of cache directory)
+     * into page cache, so proving reads don't wait for disk.
+     * Files larger than kPrewarmMaxFileSize are skipped.
+     * @return bytes requested to be read
+     */
+    virtual outcome::result<uint64_t> prewarm(SectorId sector,
+                                              RegisteredProof seal_proof_type,
+                                              SectorFileType types) = 0;
   };
 
   class RemoteStore : public Store {
@@ -7,12 +7,31 @@
 #define CPP_FILECOIN_CORE_SECTOR_STORAGE_ZEROCOMM_ZEROCOMM_HPP
 
 #include "primitives/cid/cid.hpp"
+#include "primitives/cid/comm_cid.hpp"
 #include "primitives/piece/piece.hpp"
 
 namespace fc::sector_storage::zerocomm {
+  using primitives::cid::Comm;
+  using primitives::piece::PaddedPieceSize;
+  using primitives::piece::PieceInfo;
   using primitives::piece::UnpaddedPieceSize;
 
+  enum class ZerocommError {
+    kInvalidSize = 1,
+  };
+
+  /**
+   * Merkle root of zero data, from precomputed table.
+   * Size must be power of two from 128 bytes to 2^41 bytes.
+   */
+  outcome::result<Comm> getZeroCommitment(PaddedPieceSize size);
+
   outcome::result<CID> getZeroPieceCommitment(const UnpaddedPieceSize &size);
+
+  /// Piece contains only zeros
+  bool isZeroPiece(const PieceInfo &piece);
 }  // namespace fc::sector_storage::zerocomm
 
+OUTCOME_HPP_DECLARE_ERROR(fc::sector_storage::zerocomm, ZerocommError);
+
 #endif  // CPP_FILECOIN_CORE_SECTOR_STORAGE_ZEROCOMM_ZEROCOMM_HPP
@@ -16,6 +16,7 @@ namespace fc::sectorblocks {
   using miner::Miner;
   using mining::types::PieceAttributes;
   using primitives::DealId;
+  using primitives::piece::PieceData;
   using primitives::piece::UnpaddedPieceSize;
 
   class SectorBlocks {
@@ -27,6 +28,10 @@ namespace fc::sectorblocks {
         const std::string &piece_data,
         DealInfo deal) = 0;
 
+    /// Adds piece read from data, e.g. pipe, without staging file
+    virtual outcome::result<PieceAttributes> addPiece(
+        UnpaddedPieceSize size, const PieceData &piece_data, DealInfo deal) = 0;
+
     virtual outcome::result<std::vector<PieceLocation>> getRefs(
         DealId deal_id) const = 0;
 
@@ -11,9 +11,13 @@ namespace fc::sectorblocks {
 
   outcome::result<PieceAttributes> SectorBlocksImpl::addPiece(
       UnpaddedPieceSize size, const std::string &piece_data, DealInfo deal) {
-    OUTCOME_TRY(
-        piece_info,
-        miner_->addPieceToAnySector(size, miner::PieceData(piece_data), deal));
+    return addPiece(size, PieceData{piece_data}, deal);
+  }
+
+  outcome::result<PieceAttributes> SectorBlocksImpl::addPiece(
+      UnpaddedPieceSize size, const PieceData &piece_data, DealInfo deal) {
+    OUTCOME_TRY(piece_info,
+                miner_->addPieceToAnySector(size, piece_data, deal));
 
     OUTCOME_TRY(writeRef(
         deal.deal_id, piece_info.sector, piece_info.offset, piece_info.size));
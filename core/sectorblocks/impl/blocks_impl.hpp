@@ -20,6 +20,10 @@ namespace fc::sectorblocks {
                                               const std::string &piece_data,
                                               DealInfo deal) override;
 
+    outcome::result<PieceAttributes> addPiece(UnpaddedPieceSize size,
+                                              const PieceData &piece_data,
+                                              DealInfo deal) override;
+
     outcome::result<std::vector<PieceLocation>> getRefs(
         DealId deal_id) const override;
 
@@ -5,6 +5,9 @@
 
 #include "storage/amt/amt.hpp"
 
+#include <deque>
+
+#include "common/thread_pool.hpp"
 #include "common/which.hpp"
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::amt, AmtError, e) {
@@ -50,25 +53,100 @@ namespace fc::storage::amt {
   Amt::Amt(std::shared_ptr<ipfs::IpfsDatastore> store, const CID &root)
       : ipld(std::move(store)), root_(root) {}
 
+  outcome::result<Amt> Amt::fromValues(
+      std::shared_ptr<ipfs::IpfsDatastore> store, std::vector<Value> values) {
+    Root root;
+    root.count = values.size();
+    while (root.count > maxAt(root.height)) {
+      ++root.height;
+    }
+    std::vector<Node> nodes;
+    for (size_t i{0}; i < values.size(); i += kWidth) {
+      Node::Values leaf;
+      for (size_t j{0}; j < kWidth && i + j < values.size(); ++j) {
+        leaf.emplace(j, std::move(values[i + j]));
+      }
+      nodes.push_back({std::move(leaf)});
+    }
+    Ipld::Batch batch;
+    // each level is hashed at once and linked by nodes of next level
+    for (uint64_t height{0}; height < root.height; ++height) {
+      std::vector<Buffer> encoded;
+      encoded.reserve(nodes.size());
+      for (auto &node : nodes) {
+        OUTCOME_TRY(bytes, Ipld::encode(node));
+        encoded.push_back(std::move(bytes));
+      }
+      std::vector<gsl::span<const uint8_t>> inputs{encoded.begin(),
+                                                   encoded.end()};
+      OUTCOME_TRY(cids, common::getCidsOf(inputs));
+      std::vector<Node> parents;
+      for (size_t i{0}; i < cids.size(); i += kWidth) {
+        Node::Links links;
+        for (size_t j{0}; j < kWidth && i + j < cids.size(); ++j) {
+          links.emplace(j, cids[i + j]);
+        }
+        parents.push_back({std::move(links)});
+      }
+      for (size_t i{0}; i < encoded.size(); ++i) {
+        batch.emplace_back(std::move(cids[i]), std::move(encoded[i]));
+      }
+      nodes = std::move(parents);
+    }
+    if (!nodes.empty()) {
+      root.node = std::move(nodes[0]);
+    }
+    OUTCOME_TRY(bytes, Ipld::encode(root));
+    OUTCOME_TRY(root_cid, common::getCidOf(bytes));
+    batch.emplace_back(root_cid, std::move(bytes));
+    OUTCOME_TRY(store->setMany(std::move(batch)));
+    root.cid = root_cid;
+    Amt amt{std::move(store)};
+    amt.root_ = std::move(root);
+    return amt;
+  }
+
   outcome::result<uint64_t> Amt::count() const {
     OUTCOME_TRY(loadRoot());
     return boost::get<Root>(root_).count;
   }
 
-  outcome::result<void> Amt::set(uint64_t key, gsl::span<const uint8_t> value) {
-    if (key >= kMaxIndex) {
-      return AmtError::kIndexTooBig;
-    }
-    OUTCOME_TRY(loadRoot());
-    auto &root = boost::get<Root>(root_);
+  /// Increase height until key fits
+  void grow(Root &root, uint64_t key) {
     while (key >= maxAt(root.height)) {
       if (!visit_in_place(root.node.items,
                           [](auto &xs) { return xs.empty(); })) {
-        root.node = {
-            Node::Links{{0, std::make_shared<Node>(std::move(root.node))}}};
+        auto child{std::make_shared<Node>(std::move(root.node))};
+        root.node = {};
+        root.node.items = Node::Links{{0, std::move(child)}};
       }
       ++root.height;
     }
+  }
+
+  /// Take leading keys with same child index
+  auto consumeGroup(gsl::span<const std::pair<uint64_t, size_t>> &keys,
+                    uint64_t offset,
+                    uint64_t mask) {
+    auto index{(keys[0].first - offset) / mask};
+    size_t n{1};
+    while (n < static_cast<size_t>(keys.size())
+           && (keys[n].first - offset) / mask == index) {
+      ++n;
+    }
+    auto group{keys.first(n)};
+    keys = keys.subspan(n);
+    return std::make_pair(index, group);
+  }
+
+  outcome::result<void> Amt::set(uint64_t key, gsl::span<const uint8_t> value) {
+    if (key >= kMaxIndex) {
+      return AmtError::kIndexTooBig;
+    }
+    OUTCOME_TRY(loadRoot());
+    auto &root = boost::get<Root>(root_);
+    root.cid = boost::none;
+    grow(root, key);
     OUTCOME_TRY(add, set(root.node, root.height, key, value));
     if (add) {
       ++root.count;
@@ -100,6 +178,49 @@ namespace fc::storage::amt {
     return it->second;
   }
 
+  outcome::result<std::vector<boost::optional<Value>>> Amt::getMany(
+      const std::vector<uint64_t> &keys) const {
+    std::vector<boost::optional<Value>> values(keys.size());
+    OUTCOME_TRY(loadRoot());
+    auto &root = boost::get<Root>(root_);
+    std::vector<KeyPos> sorted;
+    sorted.reserve(keys.size());
+    for (size_t i{0}; i < keys.size(); ++i) {
+      if (keys[i] >= kMaxIndex) {
+        return AmtError::kIndexTooBig;
+      }
+      if (keys[i] < maxAt(root.height)) {
+        sorted.emplace_back(keys[i], i);
+      }
+    }
+    std::sort(sorted.begin(), sorted.end());
+    OUTCOME_TRY(getMany(root.node, root.height, 0, sorted, values));
+    return std::move(values);
+  }
+
+  outcome::result<void> Amt::setMany(
+      const std::vector<std::pair<uint64_t, Value>> &pairs) {
+    if (pairs.empty()) {
+      return outcome::success();
+    }
+    std::vector<KeyPos> sorted;
+    sorted.reserve(pairs.size());
+    for (size_t i{0}; i < pairs.size(); ++i) {
+      if (pairs[i].first >= kMaxIndex) {
+        return AmtError::kIndexTooBig;
+      }
+      sorted.emplace_back(pairs[i].first, i);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    OUTCOME_TRY(loadRoot());
+    auto &root = boost::get<Root>(root_);
+    root.cid = boost::none;
+    grow(root, sorted.back().first);
+    OUTCOME_TRY(added, setMany(root.node, root.height, 0, sorted, pairs));
+    root.count += added;
+    return outcome::success();
+  }
+
   outcome::result<void> Amt::remove(uint64_t key) {
     if (key >= kMaxIndex) {
       return AmtError::kIndexTooBig;
@@ -110,6 +231,7 @@ namespace fc::storage::amt {
       return AmtError::kNotFound;
     }
     OUTCOME_TRY(remove(root.node, root.height, key));
+    root.cid = boost::none;
     --root.count;
     while (root.height > 0) {
       auto &links = boost::get<Node::Links>(root.node.items);
@@ -127,14 +249,26 @@ namespace fc::storage::amt {
   outcome::result<CID> Amt::flush() {
     if (which<Root>(root_)) {
       auto &root = boost::get<Root>(root_);
-      OUTCOME_TRY(flush(root.node));
-      OUTCOME_TRY(root_cid, ipld->setCbor(root));
-      root_ = root_cid;
+      if (!root.cid) {
+        Ipld::Batch batch;
+        OUTCOME_TRY(flush(root.node, batch));
+        OUTCOME_TRY(bytes, Ipld::encode(root));
+        OUTCOME_TRY(root_cid, common::getCidOf(bytes));
+        batch.emplace_back(root_cid, std::move(bytes));
+        OUTCOME_TRY(ipld->setMany(std::move(batch)));
+        root.cid = root_cid;
+      }
     }
     return cid();
   }
 
   const CID &Amt::cid() const {
+    if (which<Root>(root_)) {
+      auto &root{boost::get<Root>(root_)};
+      if (root.cid) {
+        return *root.cid;
+      }
+    }
     return boost::get<CID>(root_);
   }
 
@@ -148,6 +282,7 @@ namespace fc::storage::amt {
                                  uint64_t height,
                                  uint64_t key,
                                  gsl::span<const uint8_t> value) {
+    node.cid = boost::none;
     if (height == 0) {
       auto &values = boost::get<Node::Values>(node.items);
       if (values.insert(std::make_pair(key, value)).second) {
@@ -161,12 +296,81 @@ namespace fc::storage::amt {
     return set(*child, height - 1, key % mask, value);
   }
 
+  outcome::result<void> Amt::getMany(
+      Node &node,
+      uint64_t height,
+      uint64_t offset,
+      gsl::span<const KeyPos> keys,
+      std::vector<boost::optional<Value>> &values) const {
+    if (height == 0) {
+      auto &node_values = boost::get<Node::Values>(node.items);
+      for (auto &key : keys) {
+        auto it = node_values.find(key.first - offset);
+        if (it != node_values.end()) {
+          values[key.second] = it->second;
+        }
+      }
+      return outcome::success();
+    }
+    if (!which<Node::Links>(node.items)) {
+      // empty node
+      return outcome::success();
+    }
+    auto mask = maskAt(height);
+    auto &links = boost::get<Node::Links>(node.items);
+    while (!keys.empty()) {
+      auto [index, group]{consumeGroup(keys, offset, mask)};
+      if (links.find(index) == links.end()) {
+        continue;
+      }
+      OUTCOME_TRY(child, loadLink(node, index, false));
+      OUTCOME_TRY(
+          getMany(*child, height - 1, offset + index * mask, group, values));
+    }
+    return outcome::success();
+  }
+
+  outcome::result<uint64_t> Amt::setMany(
+      Node &node,
+      uint64_t height,
+      uint64_t offset,
+      gsl::span<const KeyPos> keys,
+      const std::vector<std::pair<uint64_t, Value>> &pairs) {
+    uint64_t added{0};
+    node.cid = boost::none;
+    if (height == 0) {
+      auto &values = boost::get<Node::Values>(node.items);
+      for (auto &key : keys) {
+        auto &value{pairs[key.second].second};
+        auto it = values.find(key.first - offset);
+        if (it == values.end()) {
+          values.emplace(key.first - offset, value);
+          ++added;
+        } else {
+          it->second = value;
+        }
+      }
+      return added;
+    }
+    auto mask = maskAt(height);
+    while (!keys.empty()) {
+      auto [index, group]{consumeGroup(keys, offset, mask)};
+      OUTCOME_TRY(child, loadLink(node, index, true));
+      OUTCOME_TRY(
+          child_added,
+          setMany(*child, height - 1, offset + index * mask, group, pairs));
+      added += child_added;
+    }
+    return added;
+  }
+
   outcome::result<bool> Amt::remove(Node &node, uint64_t height, uint64_t key) {
     if (height == 0) {
       auto &values = boost::get<Node::Values>(node.items);
       if (values.erase(key) == 0) {
         return AmtError::kNotFound;
       }
+      node.cid = boost::none;
       return outcome::success();
     }
     auto mask = maskAt(height);
@@ -181,6 +385,7 @@ namespace fc::storage::amt {
     if (empty) {
       boost::get<Node::Links>(node.items).erase(index);
     }
+    node.cid = boost::none;
     return outcome::success();
   }
 
@@ -195,17 +400,45 @@ namespace fc::storage::amt {
     return res.error();
   }
 
-  outcome::result<void> Amt::flush(Node &node) {
-    if (which<Node::Links>(node.items)) {
-      auto &links = boost::get<Node::Links>(node.items);
-      for (auto &pair : links) {
-        if (which<Node::Ptr>(pair.second)) {
-          auto &child = *boost::get<Node::Ptr>(pair.second);
-          OUTCOME_TRY(flush(child));
-          OUTCOME_TRY(cid, ipld->setCbor(child));
-          pair.second = cid;
+  outcome::result<void> Amt::flush(Node &node, Ipld::Batch &batch) {
+    // modified children by depth, nodes of one depth don't reference each
+    // other
+    std::vector<std::vector<Node *>> levels;
+    std::vector<Node *> parents{&node};
+    while (!parents.empty()) {
+      std::vector<Node *> next;
+      for (auto parent : parents) {
+        if (which<Node::Links>(parent->items)) {
+          for (auto &pair : boost::get<Node::Links>(parent->items)) {
+            if (which<Node::Ptr>(pair.second)) {
+              auto &child{*boost::get<Node::Ptr>(pair.second)};
+              if (!child.cid) {
+                next.push_back(&child);
+              }
+            }
+          }
         }
       }
+      if (!next.empty()) {
+        levels.push_back(next);
+      }
+      parents = std::move(next);
+    }
+    // children are encoded before parents, each level is hashed at once
+    for (auto level{levels.rbegin()}; level != levels.rend(); ++level) {
+      std::vector<Buffer> encoded;
+      encoded.reserve(level->size());
+      for (auto child : *level) {
+        OUTCOME_TRY(bytes, Ipld::encode(*child));
+        encoded.push_back(std::move(bytes));
+      }
+      std::vector<gsl::span<const uint8_t>> inputs{encoded.begin(),
+                                                   encoded.end()};
+      OUTCOME_TRY(cids, common::getCidsOf(inputs));
+      for (size_t i{0}; i < encoded.size(); ++i) {
+        (*level)[i]->cid = cids[i];
+        batch.emplace_back(std::move(cids[i]), std::move(encoded[i]));
+      }
     }
     return outcome::success();
   }
@@ -231,10 +464,271 @@ namespace fc::storage::amt {
     return outcome::success();
   }
 
+  outcome::result<void> Amt::visitPrefetch(const Visitor &visitor,
+                                           boost::asio::thread_pool &pool,
+                                           size_t lookahead) const {
+    OUTCOME_TRY(loadRoot());
+    auto &root = boost::get<Root>(root_);
+    return visitPrefetch(root.node,
+                         root.height,
+                         0,
+                         visitor,
+                         pool,
+                         std::max<size_t>(lookahead, 1));
+  }
+
+  outcome::result<void> Amt::visitPrefetch(Node &node,
+                                           uint64_t height,
+                                           uint64_t offset,
+                                           const Visitor &visitor,
+                                           boost::asio::thread_pool &pool,
+                                           size_t lookahead) const {
+    if (height == 0) {
+      return visit(node, height, offset, visitor);
+    }
+    if (which<Node::Values>(node.items)) {
+      // empty node
+      return outcome::success();
+    }
+    auto mask = maskAt(height);
+    auto &links = boost::get<Node::Links>(node.items);
+    std::deque<std::pair<size_t, std::future<outcome::result<Node>>>> pending;
+    auto next{links.begin()};
+    for (auto &it : links) {
+      for (; next != links.end() && pending.size() < lookahead; ++next) {
+        if (which<CID>(next->second)) {
+          pending.emplace_back(
+              next->first,
+              postFuture(pool,
+                         [ipld{ipld}, cid{boost::get<CID>(next->second)}]()
+                             -> outcome::result<Node> {
+                           OUTCOME_TRY(node, ipld->getCbor<Node>(cid));
+                           node.cid = cid;
+                           return std::move(node);
+                         }));
+        }
+      }
+      if (!pending.empty() && pending.front().first == it.first) {
+        OUTCOME_TRY(child, pending.front().second.get());
+        pending.pop_front();
+        it.second = std::make_shared<Node>(std::move(child));
+      }
+      OUTCOME_TRY(child, loadLink(node, it.first, false));
+      OUTCOME_TRY(visitPrefetch(*child,
+                                height - 1,
+                                offset + it.first * mask,
+                                visitor,
+                                pool,
+                                lookahead));
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Amt::visitParallel(
+      const Visitor &visitor, boost::asio::thread_pool &pool) const {
+    OUTCOME_TRY(loadRoot());
+    auto &root = boost::get<Root>(root_);
+    if (root.height == 0) {
+      return visit(visitor);
+    }
+    if (which<Node::Values>(root.node.items)) {
+      // empty node
+      return outcome::success();
+    }
+    auto mask = maskAt(root.height);
+    std::vector<std::future<outcome::result<void>>> futures;
+    for (auto &it : boost::get<Node::Links>(root.node.items)) {
+      futures.push_back(postFuture(
+          pool, [this, &it, &visitor, &root, mask]() -> outcome::result<void> {
+            auto &link{it.second};
+            if (which<CID>(link)) {
+              auto &cid{boost::get<CID>(link)};
+              OUTCOME_TRY(child, ipld->getCbor<Node>(cid));
+              child.cid = cid;
+              link = std::make_shared<Node>(std::move(child));
+            }
+            return visit(*boost::get<Node::Ptr>(link),
+                         root.height - 1,
+                         it.first * mask,
+                         visitor);
+          }));
+    }
+    // tasks reference visitor, wait all before result or exception
+    for (auto &future : futures) {
+      future.wait();
+    }
+    outcome::result<void> result{outcome::success()};
+    for (auto &future : futures) {
+      auto visited{future.get()};
+      if (!visited && result) {
+        result = visited.error();
+      }
+    }
+    return result;
+  }
+
+  outcome::result<void> Amt::diff(const Amt &to,
+                                  const DiffVisitor &visitor) const {
+    auto root_cid{[](auto &root) -> const CID * {
+      if (which<CID>(root)) {
+        return &boost::get<CID>(root);
+      }
+      auto &cid{boost::get<Root>(root).cid};
+      return cid ? &*cid : nullptr;
+    }};
+    auto cid1{root_cid(root_)}, cid2{root_cid(to.root_)};
+    if (cid1 && cid2 && *cid1 == *cid2) {
+      return outcome::success();
+    }
+    OUTCOME_TRY(loadRoot());
+    OUTCOME_TRY(to.loadRoot());
+    auto &from_root{boost::get<Root>(root_)};
+    auto &to_root{boost::get<Root>(to.root_)};
+    return diff(from_root.node,
+                from_root.height,
+                to,
+                to_root.node,
+                to_root.height,
+                0,
+                visitor);
+  }
+
+  /// Empty node of any height decodes as values
+  Node::Links &linksOf(Node &node) {
+    if (which<Node::Values>(node.items)) {
+      node.items = Node::Links{};
+    }
+    return boost::get<Node::Links>(node.items);
+  }
+
+  /// Cid of link if known without loading
+  const CID *linkCid(const Node::Link &link) {
+    if (which<CID>(link)) {
+      return &boost::get<CID>(link);
+    }
+    auto &ptr{boost::get<Node::Ptr>(link)};
+    return ptr->cid ? &*ptr->cid : nullptr;
+  }
+
+  outcome::result<void> Amt::diff(Node &from,
+                                  uint64_t from_height,
+                                  const Amt &to_amt,
+                                  Node &to,
+                                  uint64_t to_height,
+                                  uint64_t offset,
+                                  const DiffVisitor &visitor) const {
+    auto removed{[&](auto key, auto &value) {
+      return visitor(key, &value, nullptr);
+    }};
+    auto added{[&](auto key, auto &value) {
+      return visitor(key, nullptr, &value);
+    }};
+    // lower tree is same as first child of grown tree
+    if (from_height != to_height) {
+      auto grown_from{from_height > to_height};
+      auto &node{grown_from ? from : to};
+      auto height{std::max(from_height, to_height)};
+      auto mask{maskAt(height)};
+      auto &amt{grown_from ? *this : to_amt};
+      if (linksOf(node).count(0) == 0) {
+        OUTCOME_TRY(grown_from
+                        ? to_amt.visit(to, to_height, offset, added)
+                        : visit(from, from_height, offset, removed));
+      }
+      for (auto &it : linksOf(node)) {
+        OUTCOME_TRY(child, amt.loadLink(node, it.first, false));
+        if (it.first == 0) {
+          OUTCOME_TRY(grown_from ? diff(*child,
+                                        height - 1,
+                                        to_amt,
+                                        to,
+                                        to_height,
+                                        offset,
+                                        visitor)
+                                 : diff(from,
+                                        from_height,
+                                        to_amt,
+                                        *child,
+                                        height - 1,
+                                        offset,
+                                        visitor));
+        } else {
+          OUTCOME_TRY(amt.visit(*child,
+                                height - 1,
+                                offset + it.first * mask,
+                                grown_from ? Visitor{removed}
+                                           : Visitor{added}));
+        }
+      }
+      return outcome::success();
+    }
+    if (from_height == 0) {
+      auto &from_values{boost::get<Node::Values>(from.items)};
+      auto &to_values{boost::get<Node::Values>(to.items)};
+      auto it1{from_values.begin()};
+      auto it2{to_values.begin()};
+      while (it1 != from_values.end() || it2 != to_values.end()) {
+        if (it2 == to_values.end()
+            || (it1 != from_values.end() && it1->first < it2->first)) {
+          OUTCOME_TRY(removed(offset + it1->first, it1->second));
+          ++it1;
+        } else if (it1 == from_values.end() || it2->first < it1->first) {
+          OUTCOME_TRY(added(offset + it2->first, it2->second));
+          ++it2;
+        } else {
+          if (it1->second != it2->second) {
+            OUTCOME_TRY(
+                visitor(offset + it1->first, &it1->second, &it2->second));
+          }
+          ++it1;
+          ++it2;
+        }
+      }
+      return outcome::success();
+    }
+    auto mask{maskAt(from_height)};
+    auto &from_links{linksOf(from)};
+    auto &to_links{linksOf(to)};
+    for (uint64_t index{0}; index < kWidth; ++index) {
+      auto it1{from_links.find(index)};
+      auto it2{to_links.find(index)};
+      auto has1{it1 != from_links.end()}, has2{it2 != to_links.end()};
+      if (!has1 && !has2) {
+        continue;
+      }
+      auto child_offset{offset + index * mask};
+      if (has1 && has2) {
+        auto cid1{linkCid(it1->second)}, cid2{linkCid(it2->second)};
+        if (cid1 && cid2 && *cid1 == *cid2) {
+          continue;
+        }
+        OUTCOME_TRY(child1, loadLink(from, index, false));
+        OUTCOME_TRY(child2, to_amt.loadLink(to, index, false));
+        OUTCOME_TRY(diff(*child1,
+                         from_height - 1,
+                         to_amt,
+                         *child2,
+                         from_height - 1,
+                         child_offset,
+                         visitor));
+      } else if (has1) {
+        OUTCOME_TRY(child, loadLink(from, index, false));
+        OUTCOME_TRY(visit(*child, from_height - 1, child_offset, removed));
+      } else {
+        OUTCOME_TRY(child, to_amt.loadLink(to, index, false));
+        OUTCOME_TRY(
+            to_amt.visit(*child, from_height - 1, child_offset, added));
+      }
+    }
+    return outcome::success();
+  }
+
   outcome::result<void> Amt::loadRoot() const {
     if (which<CID>(root_)) {
-      OUTCOME_TRY(root, ipld->getCbor<Root>(boost::get<CID>(root_)));
-      root_ = root;
+      auto &cid{boost::get<CID>(root_)};
+      OUTCOME_TRY(root, ipld->getCbor<Root>(cid));
+      root.cid = cid;
+      root_ = std::move(root);
     }
     return outcome::success();
   }
@@ -258,7 +752,9 @@ namespace fc::storage::amt {
     }
     auto &link = it->second;
     if (which<CID>(link)) {
-      OUTCOME_TRY(node, ipld->getCbor<Node>(boost::get<CID>(link)));
+      auto &cid{boost::get<CID>(link)};
+      OUTCOME_TRY(node, ipld->getCbor<Node>(cid));
+      node.cid = cid;
       link = std::make_shared<Node>(std::move(node));
     }
     return boost::get<Node::Ptr>(link);
@@ -15,6 +15,10 @@
 #include "primitives/cid/cid.hpp"
 #include "storage/ipfs/datastore.hpp"
 
+namespace boost::asio {
+  class thread_pool;
+}  // namespace boost::asio
+
 namespace fc::storage::amt {
   enum class AmtError {
     kExpectedCID = 1,
@@ -41,6 +45,8 @@ namespace fc::storage::amt {
     using Items = boost::variant<Values, Links>;
 
     Items items;
+    /// CID of node if not modified since load or flush, not encoded
+    boost::optional<CID> cid;
   };
 
   CBOR_ENCODE(Node, node) {
@@ -54,9 +60,14 @@ namespace fc::storage::amt {
           for (auto &item : links) {
             bits[0] |= 1 << item.first;
             if (which<Node::Ptr>(item.second)) {
-              outcome::raise(AmtError::kExpectedCID);
+              auto &ptr{boost::get<Node::Ptr>(item.second)};
+              if (!ptr || !ptr->cid) {
+                outcome::raise(AmtError::kExpectedCID);
+              }
+              l_links << *ptr->cid;
+            } else {
+              l_links << boost::get<CID>(item.second);
             }
-            l_links << boost::get<CID>(item.second);
           }
         },
         [&bits, &l_values](const Node::Values &values) {
@@ -117,6 +128,8 @@ namespace fc::storage::amt {
     uint64_t height{};
     uint64_t count{};
     Node node;
+    /// CID of root if not modified since load or flush, not encoded
+    boost::optional<CID> cid;
   };
 
   CBOR_TUPLE(Root, height, count, node)
@@ -125,25 +138,73 @@ namespace fc::storage::amt {
    public:
     using Visitor =
         std::function<outcome::result<void>(uint64_t, const Value &)>;
+    /// Receives changed key with old value, null if added, and new value,
+    /// null if removed
+    using DiffVisitor = std::function<outcome::result<void>(
+        uint64_t, const Value *, const Value *)>;
 
     explicit Amt(std::shared_ptr<ipfs::IpfsDatastore> store);
     Amt(std::shared_ptr<ipfs::IpfsDatastore> store, const CID &root);
+    /**
+     * Build amt with values at keys from 0 bottom-up, packing full nodes
+     * directly. Each node is encoded and written once, in one setMany.
+     */
+    static outcome::result<Amt> fromValues(
+        std::shared_ptr<ipfs::IpfsDatastore> store, std::vector<Value> values);
     /// Get values quantity
     outcome::result<uint64_t> count() const;
     /// Set value by key, does not write to storage
     outcome::result<void> set(uint64_t key, gsl::span<const uint8_t> value);
     /// Get value by key
     outcome::result<Value> get(uint64_t key) const;
+    /**
+     * Get values by keys, walking shared path prefixes once.
+     * Result is in order of keys, missing keys are none.
+     */
+    outcome::result<std::vector<boost::optional<Value>>> getMany(
+        const std::vector<uint64_t> &keys) const;
+    /**
+     * Set values by keys, walking shared path prefixes once, does not write
+     * to storage. Later pair wins for duplicate keys.
+     */
+    outcome::result<void> setMany(
+        const std::vector<std::pair<uint64_t, Value>> &pairs);
     /// Remove value by key, does not write to storage
     outcome::result<void> remove(uint64_t key);
     /// Checks if key is present
     outcome::result<bool> contains(uint64_t key) const;
-    /// Write changes made by set and remove to storage
+    /**
+     * Write changes made by set and remove to storage.
+     * Only modified nodes are encoded and written in one setMany, loaded
+     * nodes stay in memory.
+     */
     outcome::result<CID> flush();
     /// Get root CID if flushed, throw otherwise
     const CID &cid() const;
     /// Apply visitor for key value pairs
     outcome::result<void> visit(const Visitor &visitor) const;
+    /**
+     * Apply visitor for key value pairs in same order as visit, while up to
+     * lookahead next child nodes of each node are loaded on pool.
+     * Ipld must support concurrent get.
+     */
+    outcome::result<void> visitPrefetch(const Visitor &visitor,
+                                        boost::asio::thread_pool &pool,
+                                        size_t lookahead) const;
+    /**
+     * Apply visitor for key value pairs, subtrees of root are visited
+     * concurrently on pool, so order is unspecified.
+     * Visitor and ipld must be thread-safe.
+     */
+    outcome::result<void> visitParallel(const Visitor &visitor,
+                                        boost::asio::thread_pool &pool) const;
+    /**
+     * Apply visitor for keys changed from this amt to other, in key order.
+     * Subtrees with equal cid are skipped, so cost depends on changes rather
+     * than size.
+     */
+    outcome::result<void> diff(const Amt &to,
+                               const DiffVisitor &visitor) const;
 
     /// Store CBOR encoded value by key
     template <typename T>
@@ -162,16 +223,44 @@ namespace fc::storage::amt {
     IpldPtr ipld;
 
    private:
+    /// Key and position of key in batch
+    using KeyPos = std::pair<uint64_t, size_t>;
+
+    outcome::result<void> getMany(
+        Node &node,
+        uint64_t height,
+        uint64_t offset,
+        gsl::span<const KeyPos> keys,
+        std::vector<boost::optional<Value>> &values) const;
+    outcome::result<uint64_t> setMany(
+        Node &node,
+        uint64_t height,
+        uint64_t offset,
+        gsl::span<const KeyPos> keys,
+        const std::vector<std::pair<uint64_t, Value>> &pairs);
     outcome::result<bool> set(Node &node,
                               uint64_t height,
                               uint64_t key,
                               gsl::span<const uint8_t> value);
     outcome::result<bool> remove(Node &node, uint64_t height, uint64_t key);
-    outcome::result<void> flush(Node &node);
+    outcome::result<void> flush(Node &node, Ipld::Batch &batch);
     outcome::result<void> visit(Node &node,
                                 uint64_t height,
                                 uint64_t offset,
                                 const Visitor &visitor) const;
+    outcome::result<void> visitPrefetch(Node &node,
+                                        uint64_t height,
+                                        uint64_t offset,
+                                        const Visitor &visitor,
+                                        boost::asio::thread_pool &pool,
+                                        size_t lookahead) const;
+    outcome::result<void> diff(Node &from,
+                               uint64_t from_height,
+                               const Amt &to_amt,
+                               Node &to,
+                               uint64_t to_height,
+                               uint64_t offset,
+                               const DiffVisitor &visitor) const;
     outcome::result<void> loadRoot() const;
     outcome::result<Node::Ptr> loadLink(Node &node,
                                         uint64_t index,
@@ -5,9 +5,13 @@
 
 #include "storage/car/car.hpp"
 #include <boost/iostreams/device/mapped_file.hpp>
+#include <deque>
 #include <fstream>
 #include "codec/uvarint.hpp"
 #include "common/span.hpp"
+#include "common/thread_pool.hpp"
+#include "crypto/blake2/blake2b160.hpp"
+#include "crypto/hasher/hasher.hpp"
 #include "storage/ipld/traverser.hpp"
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::car, CarError, e) {
@@ -17,6 +21,10 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::car, CarError, e) {
       return "Decode error";
     case E::kCannotOpenFileError:
       return "Cannot open file";
+    case E::kHashMismatch:
+      return "Block hash does not match CID";
+    case E::kReadOnly:
+      return "Car is read-only";
   }
 }
 
@@ -25,32 +33,148 @@ namespace fc::storage::car {
   using ipld::kAllSelector;
   using ipld::traverser::Traverser;
 
-  outcome::result<std::vector<CID>> loadCar(Ipld &store, Input input) {
+  using crypto::Hasher;
+  using libp2p::multi::HashType;
+
+  /// Blocks of car not yet verified
+  using Blocks = std::vector<std::pair<CID, Input>>;
+
+  outcome::result<void> verifyBlock(const CID &cid, Input bytes) {
+    auto &hash{cid.content_address};
+    auto type{hash.getType()};
+    if (type == HashType::identity) {
+      if (hash.getHash() != bytes) {
+        return CarError::kHashMismatch;
+      }
+    } else if (type == HashType::sha256 || type == HashType::blake2b_256) {
+      if (Hasher::calculate(type, bytes) != hash) {
+        return CarError::kHashMismatch;
+      }
+    }
+    return outcome::success();
+  }
+
+  /// Verify blocks and copy them to batch
+  outcome::result<Ipld::Batch> verifyBlocks(const Blocks &blocks) {
+    Ipld::Batch batch;
+    batch.reserve(blocks.size());
+    // blake2b blocks are hashed together
+    std::vector<Input> blake_inputs;
+    std::vector<const CID *> blake_cids;
+    for (auto &block : blocks) {
+      auto &hash{block.first.content_address};
+      if (hash.getType() == HashType::blake2b_256
+          && hash.getHash().size() == crypto::blake2b::BLAKE2B256_HASH_LENGTH) {
+        blake_inputs.push_back(block.second);
+        blake_cids.push_back(&block.first);
+      } else {
+        OUTCOME_TRY(verifyBlock(block.first, block.second));
+      }
+      batch.emplace_back(block.first, common::Buffer{block.second});
+    }
+    auto digests{crypto::blake2b::blake2b_256_many(blake_inputs)};
+    for (size_t i{0}; i < digests.size(); ++i) {
+      auto expected{blake_cids[i]->content_address.getHash()};
+      if (!std::equal(
+              digests[i].begin(), digests[i].end(), expected.begin())) {
+        return CarError::kHashMismatch;
+      }
+    }
+    return std::move(batch);
+  }
+
+  /// Read header and call cb for each batch of up to kLoadBatchBytes
+  template <typename Cb>
+  outcome::result<std::vector<CID>> readCar(Input input, const Cb &cb) {
     OUTCOME_TRY(header_bytes,
                 codec::uvarint::readBytes<CarError::kDecodeError,
                                           CarError::kDecodeError>(input));
     OUTCOME_TRY(header, codec::cbor::decode<CarHeader>(header_bytes));
+    Blocks blocks;
+    size_t blocks_bytes{0};
     while (!input.empty()) {
       OUTCOME_TRY(node,
                   codec::uvarint::readBytes<CarError::kDecodeError,
                                             CarError::kDecodeError>(input));
       OUTCOME_TRY(cid, CID::read(node));
-      OUTCOME_TRY(store.set(cid, common::Buffer{node}));
+      blocks_bytes += node.size();
+      blocks.emplace_back(std::move(cid), node);
+      if (blocks_bytes >= kLoadBatchBytes) {
+        OUTCOME_TRY(cb(std::move(blocks)));
+        blocks.clear();
+        blocks_bytes = 0;
+      }
+    }
+    if (!blocks.empty()) {
+      OUTCOME_TRY(cb(std::move(blocks)));
     }
     return std::move(header.roots);
   }
 
+  Input mappedInput(const mapped_file &car_file) {
+    return common::span::cbytes(
+        {car_file.data(),
+         static_cast<gsl::span<const char>::index_type>(car_file.size())});
+  }
+
+  outcome::result<std::vector<CID>> loadCar(Ipld &store, Input input) {
+    return readCar(input, [&](const Blocks &blocks) -> outcome::result<void> {
+      OUTCOME_TRY(batch, verifyBlocks(blocks));
+      return store.setMany(std::move(batch));
+    });
+  }
+
+  outcome::result<std::vector<CID>> loadCar(Ipld &store,
+                                            Input input,
+                                            boost::asio::thread_pool &pool) {
+    std::deque<std::future<outcome::result<Ipld::Batch>>> pending;
+    auto write{[&]() -> outcome::result<void> {
+      auto batch{pending.front().get()};
+      pending.pop_front();
+      if (!batch) {
+        return batch.error();
+      }
+      return store.setMany(std::move(batch.value()));
+    }};
+    auto roots{readCar(input, [&](Blocks blocks) -> outcome::result<void> {
+      pending.push_back(postFuture(
+          pool, [blocks{std::move(blocks)}] { return verifyBlocks(blocks); }));
+      if (pending.size() >= kLoadPendingBatches) {
+        return write();
+      }
+      return outcome::success();
+    })};
+    outcome::result<void> written{outcome::success()};
+    while (!pending.empty()) {
+      if (!roots || !written) {
+        // tasks reference input, wait them before return
+        pending.front().wait();
+        pending.pop_front();
+      } else {
+        written = write();
+      }
+    }
+    OUTCOME_TRY(written);
+    return roots;
+  }
+
   outcome::result<std::vector<CID>> loadCar(Ipld &store,
                                             const std::string &car_path) {
     mapped_file car_file(car_path);
     if (!car_file.is_open()) {
       return CarError::kCannotOpenFileError;
     }
-    return loadCar(
-        store,
-        common::span::cbytes(
-            {car_file.data(),
-             static_cast<gsl::span<const char>::index_type>(car_file.size())}));
+    return loadCar(store, mappedInput(car_file));
+  }
+
+  outcome::result<std::vector<CID>> loadCar(Ipld &store,
+                                            const std::string &car_path,
+                                            boost::asio::thread_pool &pool) {
+    mapped_file car_file(car_path);
+    if (!car_file.is_open()) {
+      return CarError::kCannotOpenFileError;
+    }
+    return loadCar(store, mappedInput(car_file), pool);
   }
 
   void writeUvarint(Buffer &output, uint64_t value) {
@@ -135,20 +259,8 @@ namespace fc::storage::car {
   outcome::result<void> writeItem(std::ostream &output,
                                   Ipld &store,
                                   const CID &cid) {
-    OUTCOME_TRY(bytes, store.get(cid));
-    writeItem(output, cid, bytes);
-    return outcome::success();
-  }
-
-  outcome::result<void> makeCar(std::ostream &output,
-                                Ipld &store,
-                                const std::vector<CID> &roots,
-                                const std::vector<CID> &cids) {
-    writeHeader(output, roots);
-    for (auto &cid : cids) {
-      OUTCOME_TRY(writeItem(output, store, cid));
-    }
-
+    OUTCOME_TRY(bytes, store.getShared(cid));
+    writeItem(output, cid, *bytes);
     return outcome::success();
   }
 
@@ -161,19 +273,28 @@ namespace fc::storage::car {
     if (!output.good()) {
       return CarError::kCannotOpenFileError;
     }
+    return makeSelectiveCar(store, dags, output);
+  }
+
+  outcome::result<void> makeSelectiveCar(
+      Ipld &store,
+      const std::vector<std::pair<CID, Selector>> &dags,
+      std::ostream &output) {
     std::vector<CID> roots;
-    std::vector<CID> cid_order;
+    for (auto &dag : dags) {
+      roots.push_back(dag.first);
+    }
+    writeHeader(output, roots);
     std::set<CID> cids;
     for (auto &dag : dags) {
       Traverser traverser{store, dag.first, dag.second};
-      OUTCOME_TRY(visited, traverser.traverseAll());
-      roots.push_back(dag.first);
-      for (auto &cid : visited) {
+      while (!traverser.isCompleted()) {
+        OUTCOME_TRY(cid, traverser.advance());
         if (cids.insert(cid).second) {
-          cid_order.push_back(cid);
+          OUTCOME_TRY(writeItem(output, store, cid));
         }
       }
     }
-    return makeCar(output, store, roots, cid_order);
+    return outcome::success();
   }
 }  // namespace fc::storage::car
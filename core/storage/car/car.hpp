@@ -6,9 +6,15 @@
 #ifndef CPP_FILECOIN_CORE_STORAGE_CAR_CAR_HPP
 #define CPP_FILECOIN_CORE_STORAGE_CAR_CAR_HPP
 
+#include <iosfwd>
+
 #include "storage/ipfs/datastore.hpp"
 #include "storage/ipld/selector.hpp"
 
+namespace boost::asio {
+  class thread_pool;
+}  // namespace boost::asio
+
 namespace fc::storage::car {
   using Ipld = ipfs::IpfsDatastore;
   using Input = gsl::span<const uint8_t>;
@@ -18,6 +24,8 @@ namespace fc::storage::car {
   enum class CarError {
     kDecodeError = 1,
     kCannotOpenFileError,
+    kHashMismatch,
+    kReadOnly,
   };
 
   struct CarHeader {
@@ -39,13 +47,56 @@ namespace fc::storage::car {
     return s;
   }
 
+  /// Bytes of blocks written to store with one setMany while loading car
+  constexpr size_t kLoadBatchBytes{16 << 20};
+  /// Batches verified on pool ahead of writer while loading car
+  constexpr size_t kLoadPendingBatches{8};
+
+  /**
+   * Check block bytes hash matches CID, blocks with hash types other than
+   * sha2-256, blake2b-256 and identity are not checked
+   */
+  outcome::result<void> verifyBlock(const CID &cid, Input bytes);
+
+  /// Load car from memory mapped file, see loadCar(Ipld &, Input)
   outcome::result<std::vector<CID>> loadCar(Ipld &store,
                                             const std::string &car_path);
 
+  /**
+   * Load car blocks to store in batches of kLoadBatchBytes, so only one
+   * batch is kept in memory
+   * @return car roots
+   */
   outcome::result<std::vector<CID>> loadCar(Ipld &store, Input input);
 
+  /// Load car from memory mapped file, see loadCar(Ipld &, Input, pool)
+  outcome::result<std::vector<CID>> loadCar(Ipld &store,
+                                            const std::string &car_path,
+                                            boost::asio::thread_pool &pool);
+
+  /**
+   * Load car blocks to store, blocks are verified in batches on pool, while
+   * calling thread writes verified batches in order
+   * @return car roots
+   */
+  outcome::result<std::vector<CID>> loadCar(Ipld &store,
+                                            Input input,
+                                            boost::asio::thread_pool &pool);
+
   outcome::result<Buffer> makeCar(Ipld &store, const std::vector<CID> &roots);
 
+  /// Append car header with roots to output
+  void writeHeader(Buffer &output, const std::vector<CID> &roots);
+
+  /// Append block item to output
+  void writeItem(Buffer &output, const CID &cid, Input bytes);
+
+  /// Write car header with roots to stream
+  void writeHeader(std::ostream &output, const std::vector<CID> &roots);
+
+  /// Write block item to stream
+  void writeItem(std::ostream &output, const CID &cid, Input bytes);
+
   outcome::result<Buffer> makeSelectiveCar(
       Ipld &store, const std::vector<std::pair<CID, Selector>> &dags);
 
@@ -53,6 +104,12 @@ namespace fc::storage::car {
       Ipld &store,
       const std::vector<std::pair<CID, Selector>> &dags,
       const std::string &output_path);
+
+  /// Write car to stream, blocks are written as traversal visits them
+  outcome::result<void> makeSelectiveCar(
+      Ipld &store,
+      const std::vector<std::pair<CID, Selector>> &dags,
+      std::ostream &output);
 }  // namespace fc::storage::car
 
 OUTCOME_HPP_DECLARE_ERROR(fc::storage::car, CarError);
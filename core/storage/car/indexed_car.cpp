@@ -0,0 +1,211 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/car/indexed_car.hpp"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "codec/uvarint.hpp"
+#include "common/span.hpp"
+
+namespace fc::storage::car {
+  using mapped_file = boost::iostreams::mapped_file_source;
+
+  struct IndexedCar::Entry {
+    /// Offset of cid bytes in car, block data follows them
+    uint64_t cid_offset;
+    uint32_t cid_size;
+    uint32_t data_size;
+  };
+
+  struct IndexHeader {
+    static constexpr uint64_t kMagic{0x3178646972616366};  // "fcaridx1"
+
+    uint64_t magic;
+    uint64_t car_size;
+    uint64_t count;
+  };
+
+  using Entry = IndexedCar::Entry;
+
+  Input mappedBytes(const mapped_file &file) {
+    return common::span::cbytes(
+        {file.data(),
+         static_cast<gsl::span<const char>::index_type>(file.size())});
+  }
+
+  Input cidBytes(Input car, const Entry &entry) {
+    return car.subspan(entry.cid_offset, entry.cid_size);
+  }
+
+  bool cidLess(Input l, Input r) {
+    return std::lexicographical_compare(l.begin(), l.end(), r.begin(), r.end());
+  }
+
+  /// Read car header, input is advanced to first block
+  outcome::result<CarHeader> readHeader(Input &input) {
+    OUTCOME_TRY(header_bytes,
+                codec::uvarint::readBytes<CarError::kDecodeError,
+                                          CarError::kDecodeError>(input));
+    return codec::cbor::decode<CarHeader>(header_bytes);
+  }
+
+  /// Read roots and entries of car, entries are sorted by cid
+  outcome::result<std::vector<CID>> readEntries(Input car,
+                                                std::vector<Entry> &entries) {
+    auto input{car};
+    OUTCOME_TRY(header, readHeader(input));
+    while (!input.empty()) {
+      OUTCOME_TRY(node,
+                  codec::uvarint::readBytes<CarError::kDecodeError,
+                                            CarError::kDecodeError>(input));
+      if (node.empty()) {
+        break;
+      }
+      auto data{node};
+      OUTCOME_TRY(CID::read(data));
+      entries.push_back({static_cast<uint64_t>(node.data() - car.data()),
+                         static_cast<uint32_t>(node.size() - data.size()),
+                         static_cast<uint32_t>(data.size())});
+    }
+    std::sort(entries.begin(), entries.end(), [&](auto &l, auto &r) {
+      return cidLess(cidBytes(car, l), cidBytes(car, r));
+    });
+    return std::move(header.roots);
+  }
+
+  std::string indexPath(const std::string &car_path) {
+    return car_path + ".idx";
+  }
+
+  outcome::result<void> writeIndex(const std::string &car_path) {
+    mapped_file car_file(car_path);
+    if (!car_file.is_open()) {
+      return CarError::kCannotOpenFileError;
+    }
+    std::vector<Entry> entries;
+    OUTCOME_TRY(readEntries(mappedBytes(car_file), entries));
+    IndexHeader header{IndexHeader::kMagic, car_file.size(), entries.size()};
+    // written next to car and renamed, so reader never sees partial index
+    auto tmp_path{indexPath(car_path) + ".tmp"};
+    {
+      std::ofstream file{tmp_path, std::ios::binary | std::ios::trunc};
+      file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      file.write(reinterpret_cast<const char *>(entries.data()),
+                 entries.size() * sizeof(Entry));
+      if (!file.good()) {
+        return CarError::kCannotOpenFileError;
+      }
+    }
+    boost::system::error_code ec;
+    boost::filesystem::rename(tmp_path, indexPath(car_path), ec);
+    if (ec) {
+      return CarError::kCannotOpenFileError;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<std::shared_ptr<IndexedCar>> IndexedCar::open(
+      const std::string &car_path) {
+    auto car{std::make_shared<IndexedCar>()};
+    car->car_.open(car_path);
+    if (!car->car_.is_open()) {
+      return CarError::kCannotOpenFileError;
+    }
+    auto car_bytes{mappedBytes(car->car_)};
+    OUTCOME_TRY(car_header, readHeader(car_bytes));
+    car->roots_ = std::move(car_header.roots);
+
+    auto valid{[&] {
+      auto &index{car->index_};
+      if (!index.is_open() || index.size() < sizeof(IndexHeader)) {
+        return false;
+      }
+      auto &header{*reinterpret_cast<const IndexHeader *>(index.data())};
+      return header.magic == IndexHeader::kMagic
+             && header.car_size == car->car_.size()
+             && index.size()
+                    == sizeof(IndexHeader) + header.count * sizeof(Entry);
+    }};
+    auto path{indexPath(car_path)};
+    boost::system::error_code ec;
+    if (boost::filesystem::exists(path, ec)) {
+      car->index_.open(path);
+    }
+    if (!valid()) {
+      car->index_.close();
+      OUTCOME_TRY(writeIndex(car_path));
+      car->index_.open(path);
+      if (!valid()) {
+        return CarError::kDecodeError;
+      }
+    }
+    auto &header{*reinterpret_cast<const IndexHeader *>(car->index_.data())};
+    car->entries_ = gsl::make_span(
+        reinterpret_cast<const Entry *>(car->index_.data() + sizeof(header)),
+        static_cast<ptrdiff_t>(header.count));
+    for (auto &entry : car->entries_) {
+      if (entry.cid_offset + entry.cid_size + entry.data_size
+          > car->car_.size()) {
+        return CarError::kDecodeError;
+      }
+    }
+    return car;
+  }
+
+  const std::vector<CID> &IndexedCar::roots() const {
+    return roots_;
+  }
+
+  size_t IndexedCar::size() const {
+    return entries_.size();
+  }
+
+  boost::optional<Input> IndexedCar::find(const CID &key) const {
+    auto _key{key.toBytes()};
+    if (!_key) {
+      return boost::none;
+    }
+    Input key_bytes{_key.value()};
+    auto car{mappedBytes(car_)};
+    auto less{[&](auto &entry, auto key) {
+      return cidLess(cidBytes(car, entry), key);
+    }};
+    auto it{std::lower_bound(entries_.begin(), entries_.end(), key_bytes, less)};
+    if (it == entries_.end()) {
+      return boost::none;
+    }
+    auto cid{cidBytes(car, *it)};
+    if (!std::equal(
+            cid.begin(), cid.end(), key_bytes.begin(), key_bytes.end())) {
+      return boost::none;
+    }
+    return car.subspan(it->cid_offset + it->cid_size, it->data_size);
+  }
+
+  outcome::result<bool> IndexedCar::contains(const CID &key) const {
+    return find(key).has_value();
+  }
+
+  outcome::result<void> IndexedCar::set(const CID &key, Value value) {
+    return CarError::kReadOnly;
+  }
+
+  outcome::result<IndexedCar::Value> IndexedCar::get(const CID &key) const {
+    if (auto data{find(key)}) {
+      return Value{*data};
+    }
+    return ipfs::IpfsDatastoreError::kNotFound;
+  }
+
+  outcome::result<void> IndexedCar::remove(const CID &key) {
+    return CarError::kReadOnly;
+  }
+
+  IpldPtr IndexedCar::shared() {
+    return shared_from_this();
+  }
+}  // namespace fc::storage::car
@@ -0,0 +1,60 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "storage/car/car.hpp"
+
+namespace fc::storage::car {
+  /// Path of sidecar index of car
+  std::string indexPath(const std::string &car_path);
+
+  /**
+   * Write sidecar index of car: car size and cid position and data size of
+   * each block, sorted by cid bytes, so block is found by binary search
+   * without scanning car. Zero length item ends car, e.g. padding of
+   * unsealed piece. Index is in native byte order, it is not meant to be
+   * transferred.
+   */
+  outcome::result<void> writeIndex(const std::string &car_path);
+
+  /**
+   * Read-only datastore over memory mapped car and its sidecar index.
+   * Blocks are not verified on read, car is expected to be written or
+   * verified by node.
+   * Thread-safe, calls only read mapped files.
+   */
+  class IndexedCar : public Ipld,
+                     public std::enable_shared_from_this<IndexedCar> {
+   public:
+    /// Open car, index is written if it is missing or made for other car
+    static outcome::result<std::shared_ptr<IndexedCar>> open(
+        const std::string &car_path);
+
+    const std::vector<CID> &roots() const;
+    /// Number of blocks
+    size_t size() const;
+
+    outcome::result<bool> contains(const CID &key) const override;
+    /// Fails, car is read-only
+    outcome::result<void> set(const CID &key, Value value) override;
+    outcome::result<Value> get(const CID &key) const override;
+    /// Fails, car is read-only
+    outcome::result<void> remove(const CID &key) override;
+    IpldPtr shared() override;
+
+    struct Entry;
+
+   private:
+    /// Block data of cid, empty if not found
+    boost::optional<Input> find(const CID &key) const;
+
+    boost::iostreams::mapped_file_source car_, index_;
+    std::vector<CID> roots_;
+    gsl::span<const Entry> entries_;
+  };
+}  // namespace fc::storage::car
@@ -0,0 +1,185 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/chain/address_index.hpp"
+
+#include <boost/endian/conversion.hpp>
+
+#include "common/logger.hpp"
+#include "primitives/address/address_codec.hpp"
+#include "vm/message/message.hpp"
+
+namespace fc::storage::blockchain {
+  using primitives::address::encode;
+  using vm::message::SignedMessage;
+  using vm::message::UnsignedMessage;
+
+  Buffer messageKey(const Address &address, uint64_t i) {
+    Buffer key{encode(address)};
+    key.resize(key.size() + sizeof(i));
+    boost::endian::store_big_u64(key.data() + key.size() - sizeof(i), i);
+    return key;
+  }
+
+  outcome::result<uint64_t> getCount(const MapPrefix &counts,
+                                     const Buffer &key) {
+    if (!counts.contains(key)) {
+      return 0;
+    }
+    OUTCOME_TRY(raw, counts.get(key));
+    return codec::cbor::decode<uint64_t>(raw);
+  }
+
+  outcome::result<UnsignedMessage> loadMessage(Ipld &ipld,
+                                              bool bls,
+                                              const CID &cid) {
+    if (bls) {
+      return ipld.getCbor<UnsignedMessage>(cid);
+    }
+    OUTCOME_TRY(message, ipld.getCbor<SignedMessage>(cid));
+    return std::move(message.message);
+  }
+
+  AddressIndex::AddressIndex(IpldPtr ipld,
+                             std::shared_ptr<PersistentBufferMap> store,
+                             std::shared_ptr<TipsetCache> tipset_cache)
+      : ipld{std::move(ipld)},
+        tipset_cache{std::move(tipset_cache)},
+        counts{"n", store},
+        messages{"a", store},
+        tipsets{"t", store} {}
+
+  std::shared_ptr<AddressIndex> AddressIndex::create(
+      IpldPtr ipld,
+      std::shared_ptr<ChainStore> chain_store,
+      std::shared_ptr<PersistentBufferMap> store,
+      std::shared_ptr<TipsetCache> tipset_cache) {
+    auto index{std::make_shared<AddressIndex>(ipld, store, tipset_cache)};
+    index->head_sub = chain_store->subscribeHeadChanges([=](auto &change) {
+      auto res{index->onHeadChange(change)};
+      if (!res) {
+        spdlog::error("AddressIndex.onHeadChange: error {} \"{}\"",
+                      res.error(),
+                      res.error().message());
+      }
+    });
+    return index;
+  }
+
+  outcome::result<void> AddressIndex::onHeadChange(const HeadChange &change) {
+    if (change.type == HeadChangeType::REVERT) {
+      return revert(change.value);
+    }
+    if (change.type == HeadChangeType::APPLY) {
+      return apply(change.value);
+    }
+    // messages are appended in chain order, collect not indexed part first
+    std::vector<TipsetCPtr> chain;
+    auto ts{change.value};
+    while (!indexed(ts->key)) {
+      chain.push_back(ts);
+      if (ts->height() == 0) {
+        break;
+      }
+      OUTCOME_TRYA(ts, tipset_cache->loadParent(*ipld, *ts));
+    }
+    for (auto it{chain.rbegin()}; it != chain.rend(); ++it) {
+      OUTCOME_TRY(apply(*it));
+    }
+    return outcome::success();
+  }
+
+  bool AddressIndex::indexed(const TipsetKey &key) const {
+    return tipsets.contains(Buffer{key.hash()});
+  }
+
+  outcome::result<std::vector<AddressMessage>> AddressIndex::list(
+      const Address &address, ChainEpoch min, ChainEpoch max) const {
+    OUTCOME_TRY(count, getCount(counts, Buffer{encode(address)}));
+    auto get{[&](uint64_t i) -> outcome::result<AddressMessage> {
+      OUTCOME_TRY(raw, messages.get(messageKey(address, i)));
+      return codec::cbor::decode<AddressMessage>(raw);
+    }};
+    // first message with epoch >= min
+    uint64_t begin{0}, end{count};
+    while (begin < end) {
+      auto mid{begin + (end - begin) / 2};
+      OUTCOME_TRY(message, get(mid));
+      if (message.epoch < min) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    std::vector<AddressMessage> result;
+    for (auto i{begin}; i < count; ++i) {
+      OUTCOME_TRY(message, get(i));
+      if (message.epoch > max) {
+        break;
+      }
+      result.push_back(std::move(message));
+    }
+    return result;
+  }
+
+  outcome::result<void> AddressIndex::apply(const TipsetCPtr &ts) {
+    Buffer ts_key{ts->key.hash()};
+    if (tipsets.contains(ts_key)) {
+      return outcome::success();
+    }
+    auto epoch{static_cast<ChainEpoch>(ts->height())};
+    auto push{[&](const Address &address,
+                  AddressMessage message) -> outcome::result<void> {
+      Buffer count_key{encode(address)};
+      OUTCOME_TRY(count, getCount(counts, count_key));
+      OUTCOME_TRY(raw, codec::cbor::encode(message));
+      OUTCOME_TRY(messages.put(messageKey(address, count), raw));
+      OUTCOME_TRY(raw_count, codec::cbor::encode(count + 1));
+      return counts.put(count_key, raw_count);
+    }};
+    OUTCOME_TRY(ts->visitMessages(
+        ipld, [&](auto, auto bls, auto &cid) -> outcome::result<void> {
+          OUTCOME_TRY(message, loadMessage(*ipld, bls, cid));
+          OUTCOME_TRY(push(message.from, {epoch, cid, message.to, true}));
+          if (message.to != message.from) {
+            OUTCOME_TRY(push(message.to, {epoch, cid, message.from, false}));
+          }
+          return outcome::success();
+        }));
+    return tipsets.put(ts_key, Buffer{});
+  }
+
+  outcome::result<void> AddressIndex::revert(const TipsetCPtr &ts) {
+    Buffer ts_key{ts->key.hash()};
+    if (!tipsets.contains(ts_key)) {
+      return outcome::success();
+    }
+    auto epoch{static_cast<ChainEpoch>(ts->height())};
+    // reverts go top down, so messages of tipset are at tail
+    auto pop{[&](const Address &address) -> outcome::result<void> {
+      Buffer count_key{encode(address)};
+      OUTCOME_TRY(count, getCount(counts, count_key));
+      while (count != 0) {
+        auto key{messageKey(address, count - 1)};
+        OUTCOME_TRY(raw, messages.get(key));
+        OUTCOME_TRY(message, codec::cbor::decode<AddressMessage>(raw));
+        if (message.epoch < epoch) {
+          break;
+        }
+        OUTCOME_TRY(messages.remove(key));
+        --count;
+      }
+      OUTCOME_TRY(raw_count, codec::cbor::encode(count));
+      return counts.put(count_key, raw_count);
+    }};
+    OUTCOME_TRY(ts->visitMessages(
+        ipld, [&](auto, auto bls, auto &cid) -> outcome::result<void> {
+          OUTCOME_TRY(message, loadMessage(*ipld, bls, cid));
+          OUTCOME_TRY(pop(message.from));
+          return pop(message.to);
+        }));
+    return tipsets.remove(ts_key);
+  }
+}  // namespace fc::storage::blockchain
@@ -0,0 +1,71 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "primitives/tipset/tipset_cache.hpp"
+#include "storage/chain/chain_store.hpp"
+#include "storage/in_memory/in_memory_storage.hpp"
+#include "storage/leveldb/prefix.hpp"
+
+namespace fc::storage::blockchain {
+  using primitives::ChainEpoch;
+  using primitives::address::Address;
+  using primitives::tipset::TipsetCache;
+
+  /// Message sent from or to indexed address
+  struct AddressMessage {
+    ChainEpoch epoch{};
+    CID cid;
+    /// Receiver if `from` is set, sender otherwise
+    Address other;
+    bool from{};
+  };
+  CBOR_TUPLE(AddressMessage, epoch, cid, other, from)
+
+  /**
+   * Optional persistent index of messages by sender and receiver on
+   * canonical chain.
+   * Messages of every address are appended in chain order, so messages in
+   * epoch range are found with binary search, and reverts only pop tail.
+   */
+  struct AddressIndex : public std::enable_shared_from_this<AddressIndex> {
+    explicit AddressIndex(IpldPtr ipld,
+                          std::shared_ptr<PersistentBufferMap> store =
+                              std::make_shared<InMemoryStorage>(),
+                          std::shared_ptr<TipsetCache> tipset_cache =
+                              std::make_shared<TipsetCache>());
+    static std::shared_ptr<AddressIndex> create(
+        IpldPtr ipld,
+        std::shared_ptr<ChainStore> chain_store,
+        std::shared_ptr<PersistentBufferMap> store =
+            std::make_shared<InMemoryStorage>(),
+        std::shared_ptr<TipsetCache> tipset_cache =
+            std::make_shared<TipsetCache>());
+    outcome::result<void> onHeadChange(const HeadChange &change);
+    /// True if messages of tipset are indexed, i.e. it is on canonical chain
+    bool indexed(const TipsetKey &key) const;
+    /**
+     * Messages of address included in tipsets with epoch in [min, max],
+     * in chain order.
+     */
+    outcome::result<std::vector<AddressMessage>> list(const Address &address,
+                                                      ChainEpoch min,
+                                                      ChainEpoch max) const;
+
+    outcome::result<void> apply(const TipsetCPtr &ts);
+    outcome::result<void> revert(const TipsetCPtr &ts);
+
+    IpldPtr ipld;
+    std::shared_ptr<TipsetCache> tipset_cache;
+    /// Address to number of its messages
+    MapPrefix counts;
+    /// Address and sequence number to AddressMessage
+    MapPrefix messages;
+    /// Tipsets which messages are indexed
+    MapPrefix tipsets;
+    ChainStore::connection_t head_sub;
+  };
+}  // namespace fc::storage::blockchain
@@ -0,0 +1,63 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/chain/gc_roots.hpp"
+
+namespace fc::storage::blockchain {
+  outcome::result<GcDatastore::Roots> chainGcRoots(Ipld &ipld,
+                                                   TipsetCPtr head,
+                                                   size_t state_depth) {
+    GcDatastore::Roots roots;
+    auto ts{std::move(head)};
+    for (size_t depth{0}; ts; ++depth) {
+      for (auto &cid : ts->key.cids()) {
+        roots.shallow.push_back(cid);
+      }
+      for (auto &block : ts->blks) {
+        roots.deep.push_back(block.messages);
+        if (depth < state_depth) {
+          roots.deep.push_back(block.parent_state_root);
+          roots.deep.push_back(block.parent_message_receipts);
+        }
+      }
+      if (ts->height() == 0) {
+        break;
+      }
+      OUTCOME_TRYA(ts, ts->loadParent(ipld));
+    }
+    return roots;
+  }
+
+  outcome::result<SplitDatastore::Roots> chainColdRoots(
+      SplitDatastore &split, TipsetCPtr head, size_t finality) {
+    SplitDatastore::Roots roots;
+    if (head->height() < finality) {
+      return roots;
+    }
+    auto ts{std::move(head)};
+    auto max_height{ts->height() - finality};
+    while (true) {
+      if (ts->height() <= max_height) {
+        OUTCOME_TRY(hot, split.containsHot(ts->key.cids()[0]));
+        if (!hot) {
+          // older tipsets were migrated before
+          break;
+        }
+        for (auto &cid : ts->key.cids()) {
+          roots.shallow.push_back(cid);
+        }
+        for (auto &block : ts->blks) {
+          roots.deep.push_back(block.messages);
+          roots.deep.push_back(block.parent_message_receipts);
+        }
+      }
+      if (ts->height() == 0) {
+        break;
+      }
+      OUTCOME_TRYA(ts, ts->loadParent(split));
+    }
+    return roots;
+  }
+}  // namespace fc::storage::blockchain
@@ -0,0 +1,34 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "primitives/tipset/tipset.hpp"
+#include "storage/ipfs/impl/gc_datastore.hpp"
+#include "storage/ipfs/impl/split_datastore.hpp"
+
+namespace fc::storage::blockchain {
+  using ipfs::GcDatastore;
+  using ipfs::SplitDatastore;
+  using primitives::tipset::TipsetCPtr;
+
+  /**
+   * Roots of chain data kept by collection: headers of all tipsets down to
+   * genesis with their messages, parent states and receipts of last
+   * state_depth tipsets from head. Caller adds states computed by
+   * interpreter for head.
+   */
+  outcome::result<GcDatastore::Roots> chainGcRoots(Ipld &ipld,
+                                                   TipsetCPtr head,
+                                                   size_t state_depth);
+
+  /**
+   * Chain data to move to cold store: headers, messages and receipts of
+   * tipsets at least finality below head, down to tipset already in cold.
+   * States are not migrated, old states are removed by collection.
+   */
+  outcome::result<SplitDatastore::Roots> chainColdRoots(
+      SplitDatastore &split, TipsetCPtr head, size_t finality);
+}  // namespace fc::storage::blockchain
@@ -0,0 +1,138 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/chain/height_index.hpp"
+
+#include <boost/endian/conversion.hpp>
+
+#include "common/logger.hpp"
+
+namespace fc::storage::blockchain {
+  /// Big endian key keeps heights ordered
+  Buffer heightKey(uint64_t height) {
+    Buffer key(sizeof(height), 0);
+    boost::endian::store_big_u64(key.data(), height);
+    return key;
+  }
+
+  outcome::result<boost::optional<TipsetKey>> getKey(const MapPrefix &map,
+                                                     const Buffer &key) {
+    if (!map.contains(key)) {
+      return boost::none;
+    }
+    OUTCOME_TRY(raw, map.get(key));
+    OUTCOME_TRY(cids, codec::cbor::decode<std::vector<CID>>(raw));
+    return TipsetKey{std::move(cids)};
+  }
+
+  outcome::result<void> putKey(MapPrefix &map,
+                               const Buffer &key,
+                               const TipsetKey &value) {
+    OUTCOME_TRY(raw, codec::cbor::encode(value.cids()));
+    return map.put(key, std::move(raw));
+  }
+
+  HeightIndex::HeightIndex(IpldPtr ipld,
+                           std::shared_ptr<PersistentBufferMap> store,
+                           std::shared_ptr<TipsetCache> tipset_cache)
+      : ipld{std::move(ipld)},
+        tipset_cache{std::move(tipset_cache)},
+        heights{"h", store},
+        forks{"f", store} {}
+
+  std::shared_ptr<HeightIndex> HeightIndex::create(
+      IpldPtr ipld,
+      std::shared_ptr<PersistentBufferMap> store,
+      std::shared_ptr<ChainStore> chain_store,
+      std::shared_ptr<TipsetCache> tipset_cache) {
+    auto index{std::make_shared<HeightIndex>(ipld, store, tipset_cache)};
+    index->head_sub = chain_store->subscribeHeadChanges([=](auto &change) {
+      auto res{index->onHeadChange(change)};
+      if (!res) {
+        spdlog::error("HeightIndex.onHeadChange: error {} \"{}\"",
+                      res.error(),
+                      res.error().message());
+      }
+    });
+    return index;
+  }
+
+  outcome::result<void> HeightIndex::onHeadChange(const HeadChange &change) {
+    auto &ts{change.value};
+    if (change.type == HeadChangeType::REVERT) {
+      reverted.push_back(ts);
+      return heights.remove(heightKey(ts->height()));
+    }
+    if (!reverted.empty()) {
+      // reverts go top down, parent of last one is still canonical
+      auto fork{reverted.back()->getParents()};
+      for (auto &old : reverted) {
+        OUTCOME_TRY(putKey(forks, Buffer{old->key.hash()}, fork));
+      }
+      reverted.clear();
+    }
+    if (change.type == HeadChangeType::APPLY) {
+      return putKey(heights, heightKey(ts->height()), ts->key);
+    }
+    // index chain of current head until already indexed part
+    auto current{ts};
+    while (true) {
+      OUTCOME_TRY(key, canonical(current->height()));
+      if (key == current->key) {
+        break;
+      }
+      OUTCOME_TRY(putKey(heights, heightKey(current->height()), current->key));
+      if (current->height() == 0) {
+        break;
+      }
+      OUTCOME_TRYA(current, tipset_cache->loadParent(*ipld, *current));
+    }
+    return outcome::success();
+  }
+
+  outcome::result<TipsetCPtr> HeightIndex::get(TipsetCPtr head,
+                                               uint64_t height) const {
+    if (head->height() < height) {
+      return ChainStoreError::kNoTipsetAtHeight;
+    }
+    while (head->height() > height) {
+      OUTCOME_TRY(key, canonical(head->height()));
+      if (key == head->key) {
+        // canonical chain, lowest indexed tipset from height
+        for (auto h{height}; h < head->height(); ++h) {
+          OUTCOME_TRY(found, canonical(h));
+          if (found) {
+            return tipset_cache->load(*ipld, *found);
+          }
+        }
+        return std::move(head);
+      }
+      OUTCOME_TRY(fork, forkPoint(head->key));
+      if (fork) {
+        OUTCOME_TRY(point, tipset_cache->load(*ipld, *fork));
+        if (point->height() >= height) {
+          head = std::move(point);
+          continue;
+        }
+      }
+      OUTCOME_TRY(parent, tipset_cache->loadParent(*ipld, *head));
+      if (parent->height() < height) {
+        break;
+      }
+      head = std::move(parent);
+    }
+    return std::move(head);
+  }
+
+  outcome::result<boost::optional<TipsetKey>> HeightIndex::canonical(
+      uint64_t height) const {
+    return getKey(heights, heightKey(height));
+  }
+
+  outcome::result<boost::optional<TipsetKey>> HeightIndex::forkPoint(
+      const TipsetKey &key) const {
+    return getKey(forks, Buffer{key.hash()});
+  }
+}  // namespace fc::storage::blockchain
@@ -0,0 +1,53 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "primitives/tipset/tipset_cache.hpp"
+#include "storage/chain/chain_store.hpp"
+#include "storage/leveldb/prefix.hpp"
+
+namespace fc::storage::blockchain {
+  using primitives::tipset::Tipset;
+  using primitives::tipset::TipsetCache;
+
+  /**
+   * Persistent height to tipset key index of canonical chain.
+   * Tipsets reverted from canonical chain remember fork point (their
+   * canonical ancestor), so lookups from fork head skip to indexed part of
+   * chain instead of walking all parents down to requested height.
+   */
+  struct HeightIndex : public std::enable_shared_from_this<HeightIndex> {
+    HeightIndex(IpldPtr ipld,
+                std::shared_ptr<PersistentBufferMap> store,
+                std::shared_ptr<TipsetCache> tipset_cache =
+                    std::make_shared<TipsetCache>());
+    static std::shared_ptr<HeightIndex> create(
+        IpldPtr ipld,
+        std::shared_ptr<PersistentBufferMap> store,
+        std::shared_ptr<ChainStore> chain_store,
+        std::shared_ptr<TipsetCache> tipset_cache =
+            std::make_shared<TipsetCache>());
+    outcome::result<void> onHeadChange(const HeadChange &change);
+    /**
+     * Find tipset at height on chain of head.
+     * Returns lowest tipset above height, if height is null round.
+     */
+    outcome::result<TipsetCPtr> get(TipsetCPtr head, uint64_t height) const;
+    /// Canonical tipset key at height
+    outcome::result<boost::optional<TipsetKey>> canonical(
+        uint64_t height) const;
+    /// Canonical ancestor of tipset reverted from canonical chain
+    outcome::result<boost::optional<TipsetKey>> forkPoint(
+        const TipsetKey &key) const;
+
+    IpldPtr ipld;
+    std::shared_ptr<TipsetCache> tipset_cache;
+    MapPrefix heights, forks;
+    /// Tipsets reverted by current head change, top down
+    std::vector<TipsetCPtr> reverted;
+    ChainStore::connection_t head_sub;
+  };
+}  // namespace fc::storage::blockchain
@@ -10,11 +10,20 @@
 namespace fc::storage::blockchain {
   using primitives::tipset::MessageVisitor;
 
-  MsgWaiter::MsgWaiter(IpldPtr ipld) : ipld{ipld} {}
+  MsgWaiter::MsgWaiter(IpldPtr ipld,
+                       std::shared_ptr<PersistentBufferMap> store,
+                       std::shared_ptr<TipsetCache> tipset_cache)
+      : ipld{ipld},
+        tipset_cache{std::move(tipset_cache)},
+        messages{"m", store},
+        tipsets{"t", store} {}
 
   std::shared_ptr<MsgWaiter> MsgWaiter::create(
-      IpldPtr ipld, std::shared_ptr<ChainStore> chain_store) {
-    auto waiter{std::make_shared<MsgWaiter>(ipld)};
+      IpldPtr ipld,
+      std::shared_ptr<ChainStore> chain_store,
+      std::shared_ptr<PersistentBufferMap> store,
+      std::shared_ptr<TipsetCache> tipset_cache) {
+    auto waiter{std::make_shared<MsgWaiter>(ipld, store, tipset_cache)};
     waiter->head_sub = chain_store->subscribeHeadChanges([=](auto &change) {
       auto res{waiter->onHeadChange(change)};
       if (!res) {
@@ -28,31 +37,45 @@ namespace fc::storage::blockchain {
 
   outcome::result<void> MsgWaiter::onHeadChange(const HeadChange &change) {
     auto onTipset = [&](auto &ts, auto apply) -> outcome::result<TipsetCPtr> {
-      OUTCOME_TRY(parent, ts->loadParent(*ipld));
+      OUTCOME_TRY(parent, tipset_cache->loadParent(*ipld, *ts));
       adt::Array<MessageReceipt> receipts{ts->getParentMessageReceipts(), ipld};
       OUTCOME_TRY(parent->visitMessages(
           ipld, [&](auto i, auto, auto &cid) -> outcome::result<void> {
+            CompactCid compact{cid};
+            Buffer key{compact.bytes()};
             if (apply) {
               OUTCOME_TRY(receipt, receipts.get(i));
-              auto result{
-                  results.emplace(cid, std::make_pair(receipt, ts->key))};
-              auto callbacks{waiting.find(cid)};
-              if (callbacks != waiting.end()) {
-                for (auto &callback : callbacks->second) {
-                  callback(result.first->second);
+              OUTCOME_TRY(raw,
+                          codec::cbor::encode(
+                              MsgInclusion{receipt, ts->key.cids()}));
+              OUTCOME_TRY(messages.put(std::move(key), raw));
+              auto it{waiting.find(compact)};
+              if (it != waiting.end()) {
+                // callbacks may wait again and rehash
+                auto callbacks{std::move(it->second)};
+                waiting.erase(it);
+                Result result{receipt, ts->key};
+                for (auto &callback : callbacks) {
+                  callback(result);
                 }
-                waiting.erase(cid);
               }
             } else {
-              results.erase(cid);
+              OUTCOME_TRY(messages.remove(std::move(key)));
             }
             return outcome::success();
           }));
+      Buffer ts_key{ts->key.hash()};
+      if (apply) {
+        OUTCOME_TRY(tipsets.put(ts_key, Buffer{}));
+      } else {
+        OUTCOME_TRY(tipsets.remove(ts_key));
+      }
       return std::move(parent);
     };
     if (change.type == HeadChangeType::CURRENT) {
+      // index chain down to already indexed part
       auto ts{change.value};
-      while (ts->height() > 0) {
+      while (ts->height() > 0 && !tipsets.contains(Buffer{ts->key.hash()})) {
         OUTCOME_TRYA(ts, onTipset(ts, true));
       }
     } else {
@@ -61,10 +84,23 @@ namespace fc::storage::blockchain {
     return outcome::success();
   }
 
+  outcome::result<boost::optional<MsgWaiter::Result>> MsgWaiter::search(
+      const CID &cid) const {
+    OUTCOME_TRY(key, cid.toBytes());
+    Buffer _key{std::move(key)};
+    if (!messages.contains(_key)) {
+      return boost::none;
+    }
+    OUTCOME_TRY(raw, messages.get(_key));
+    OUTCOME_TRY(inclusion, codec::cbor::decode<MsgInclusion>(raw));
+    return Result{std::move(inclusion.receipt),
+                  TipsetKey{std::move(inclusion.tipset)}};
+  }
+
   void MsgWaiter::wait(const CID &cid, const Callback &callback) {
-    auto result{results.find(cid)};
-    if (result != results.end()) {
-      callback(result->second);
+    auto _result{search(cid)};
+    if (_result && _result.value()) {
+      callback(*_result.value());
     } else {
       waiting[cid].push_back(callback);
     }
@@ -6,26 +6,59 @@
 #ifndef CPP_FILECOIN_CORE_STORAGE_CHAIN_MSG_WAITER_HPP
 #define CPP_FILECOIN_CORE_STORAGE_CHAIN_MSG_WAITER_HPP
 
+#include "primitives/cid/compact_cid.hpp"
+#include "primitives/tipset/tipset_cache.hpp"
 #include "storage/chain/chain_store.hpp"
+#include "storage/in_memory/in_memory_storage.hpp"
+#include "storage/leveldb/prefix.hpp"
 #include "vm/runtime/runtime_types.hpp"
 
 namespace fc::storage::blockchain {
+  using primitives::tipset::TipsetCache;
   using vm::runtime::MessageReceipt;
 
+  /// Receipt of message and key of tipset with that receipt
+  struct MsgInclusion {
+    MessageReceipt receipt;
+    std::vector<CID> tipset;
+  };
+  CBOR_TUPLE(MsgInclusion, receipt, tipset)
+
+  /**
+   * Waits for messages execution on canonical chain.
+   * Keeps persistent index of message cid to receipt and tipset, updated on
+   * head changes (reverted messages are removed), so lookup of old messages
+   * doesn't scan chain and memory doesn't grow with chain.
+   */
   struct MsgWaiter : public std::enable_shared_from_this<MsgWaiter> {
     using Result = std::pair<MessageReceipt, TipsetKey>;
     using Callback = std::function<void(const Result &)>;
 
-    explicit MsgWaiter(IpldPtr ipld);
+    explicit MsgWaiter(IpldPtr ipld,
+                       std::shared_ptr<PersistentBufferMap> store =
+                           std::make_shared<InMemoryStorage>(),
+                       std::shared_ptr<TipsetCache> tipset_cache =
+                           std::make_shared<TipsetCache>());
     static std::shared_ptr<MsgWaiter> create(
-        IpldPtr ipld, std::shared_ptr<ChainStore> chain_store);
+        IpldPtr ipld,
+        std::shared_ptr<ChainStore> chain_store,
+        std::shared_ptr<PersistentBufferMap> store =
+            std::make_shared<InMemoryStorage>(),
+        std::shared_ptr<TipsetCache> tipset_cache =
+            std::make_shared<TipsetCache>());
     outcome::result<void> onHeadChange(const HeadChange &change);
+    /// Find receipt and tipset of executed message
+    outcome::result<boost::optional<Result>> search(const CID &cid) const;
     void wait(const CID &cid, const Callback &callback);
 
     IpldPtr ipld;
+    std::shared_ptr<TipsetCache> tipset_cache;
+    /// Message cid to MsgInclusion
+    MapPrefix messages;
+    /// Tipsets which messages are indexed
+    MapPrefix tipsets;
     ChainStore::connection_t head_sub;
-    std::map<CID, Result> results;
-    std::map<CID, std::vector<Callback>> waiting;
+    std::unordered_map<CompactCid, std::vector<Callback>> waiting;
   };
 }  // namespace fc::storage::blockchain
 
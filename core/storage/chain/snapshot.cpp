@@ -0,0 +1,75 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/chain/snapshot.hpp"
+
+#include <unordered_set>
+
+#include "primitives/cid/compact_cid.hpp"
+#include "storage/car/car.hpp"
+#include "storage/ipld/traverser.hpp"
+
+namespace fc::storage::blockchain {
+  outcome::result<void> exportSnapshot(Ipld &ipld,
+                                       TipsetCPtr head,
+                                       size_t state_depth,
+                                       std::ostream &output) {
+    car::writeHeader(output, head->key.cids());
+    std::unordered_set<CompactCid> written;
+    std::vector<CID> queue;
+    auto ts{std::move(head)};
+    for (size_t depth{0}; ts; ++depth) {
+      for (auto &cid : ts->key.cids()) {
+        if (written.insert(cid).second) {
+          OUTCOME_TRY(bytes, ipld.getShared(cid));
+          car::writeItem(output, cid, *bytes);
+        }
+      }
+      if (depth < state_depth) {
+        for (auto &block : ts->blks) {
+          queue.push_back(block.messages);
+          queue.push_back(block.parent_state_root);
+          queue.push_back(block.parent_message_receipts);
+        }
+        while (!queue.empty()) {
+          auto cid{std::move(queue.back())};
+          queue.pop_back();
+          if (!written.insert(cid).second) {
+            // links of written block are written or queued already
+            continue;
+          }
+          OUTCOME_TRY(bytes, ipld.getShared(cid));
+          car::writeItem(output, cid, *bytes);
+          OUTCOME_TRY(links, ipld::traverser::blockLinks(cid, *bytes));
+          for (auto &link : links) {
+            queue.push_back(std::move(link));
+          }
+        }
+      }
+      if (ts->height() == 0) {
+        break;
+      }
+      OUTCOME_TRYA(ts, ts->loadParent(ipld));
+    }
+    return outcome::success();
+  }
+
+  outcome::result<TipsetCPtr> importSnapshot(Ipld &ipld,
+                                             const std::string &car_path,
+                                             HeightIndex &index) {
+    OUTCOME_TRY(roots, car::loadCar(ipld, car_path));
+    if (roots.empty()) {
+      return car::CarError::kDecodeError;
+    }
+    OUTCOME_TRY(head, Tipset::load(ipld, roots));
+    OUTCOME_TRY(has_state, ipld.contains(head->getParentStateRoot()));
+    if (!has_state) {
+      return ipfs::IpfsDatastoreError::kNotFound;
+    }
+    // loads all headers down to genesis
+    OUTCOME_TRY(index.onHeadChange({HeadChangeType::CURRENT, head}));
+    return head;
+  }
+}  // namespace fc::storage::blockchain
@@ -0,0 +1,32 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <iosfwd>
+
+#include "storage/chain/height_index.hpp"
+
+namespace fc::storage::blockchain {
+  /**
+   * Write chain snapshot car with head as roots: headers of all tipsets
+   * down to genesis, and messages, parent states and receipts of last
+   * state_depth tipsets. Blocks are streamed as they are visited, each block
+   * is written once, shared subtrees of states are not visited again.
+   */
+  outcome::result<void> exportSnapshot(Ipld &ipld,
+                                       TipsetCPtr head,
+                                       size_t state_depth,
+                                       std::ostream &output);
+
+  /**
+   * Load snapshot car and index heights of its chain, so node starts from
+   * snapshot head without applying history.
+   * @return snapshot head, to be set as chain store head
+   */
+  outcome::result<TipsetCPtr> importSnapshot(Ipld &ipld,
+                                             const std::string &car_path,
+                                             HeightIndex &index);
+}  // namespace fc::storage::blockchain
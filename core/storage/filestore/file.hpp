@@ -60,6 +60,13 @@ namespace fc::storage::filestore {
     virtual fc::outcome::result<size_t> write(
         size_t offset, gsl::span<const uint8_t> buffer) noexcept = 0;
 
+    /**
+     * @brief reserve disk space for file without changing its size, so
+     * following writes up to size don't fragment it
+     * @param size bytes to reserve from file start
+     */
+    virtual fc::outcome::result<void> preallocate(size_t size) noexcept = 0;
+
     /**
      * @brief Whether the file is open
      * @return true if file is open, false otherwise
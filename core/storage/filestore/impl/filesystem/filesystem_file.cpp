@@ -5,6 +5,10 @@
 
 #include "storage/filestore/impl/filesystem/filesystem_file.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+
 #include "boost/filesystem.hpp"
 #include "storage/filestore/filestore_error.hpp"
 
@@ -12,7 +16,68 @@ using fc::storage::filestore::FileStoreError;
 using fc::storage::filestore::FileSystemFile;
 using fc::storage::filestore::Path;
 
-FileSystemFile::FileSystemFile(Path path) : path_(std::move(path)) {}
+namespace {
+  /// Block size satisfying O_DIRECT alignment on common filesystems
+  constexpr size_t kAlign{4096};
+
+  size_t alignDown(size_t value) {
+    return value & ~(kAlign - 1);
+  }
+
+  size_t alignUp(size_t value) {
+    return alignDown(value + kAlign - 1);
+  }
+
+  fc::outcome::result<void> pwriteAll(int fd,
+                                      const uint8_t *data,
+                                      size_t size,
+                                      size_t offset) {
+    while (size != 0) {
+      auto n{::pwrite(fd, data, size, offset)};
+      if (n == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return FileStoreError::kUnknown;
+      }
+      data += n;
+      size -= n;
+      offset += n;
+    }
+    return fc::outcome::success();
+  }
+
+  /// Write back range and evict it from page cache
+  void dropCache(int fd, size_t offset, size_t size) {
+#if __linux__
+    sync_file_range(fd,
+                    offset,
+                    size,
+                    SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE
+                        | SYNC_FILE_RANGE_WAIT_AFTER);
+    posix_fadvise(fd, offset, size, POSIX_FADV_DONTNEED);
+#else
+    fsync(fd);
+#endif
+  }
+}  // namespace
+
+FileSystemFile::FileSystemFile(Path path)
+    : FileSystemFile(std::move(path), Options{}) {}
+
+FileSystemFile::FileSystemFile(Path path, Options options)
+    : path_(std::move(path)), options_(options) {
+  options_.buffer_size = std::max(alignDown(options_.buffer_size), kAlign);
+}
+
+FileSystemFile::~FileSystemFile() {
+  if (fd_ != -1) {
+    ::close(fd_);
+  }
+  if (direct_fd_ != -1) {
+    ::close(direct_fd_);
+  }
+}
 
 Path FileSystemFile::path() const noexcept {
   return path_;
@@ -28,62 +93,96 @@ fc::outcome::result<size_t> FileSystemFile::size() const noexcept {
 fc::outcome::result<void> FileSystemFile::open() noexcept {
   OUTCOME_TRY(file_exists, exists());
   if (!file_exists) return FileStoreError::kFileNotFound;
-
-  fstream_.open(path_);
-
-  if (fstream_.fail()) return FileStoreError::kCannotOpen;
+  if (is_open()) return FileStoreError::kCannotOpen;
+
+  fd_ = ::open(path_.c_str(), O_RDWR | O_CLOEXEC);
+  if (fd_ == -1) return FileStoreError::kCannotOpen;
+
+#if __linux__
+  if (options_.direct_io) {
+    direct_fd_ = ::open(path_.c_str(), O_RDWR | O_CLOEXEC | O_DIRECT);
+    void *aligned{};
+    if (direct_fd_ != -1
+        && posix_memalign(&aligned, kAlign, options_.buffer_size) == 0) {
+      aligned_.reset(static_cast<uint8_t *>(aligned));
+    } else if (direct_fd_ != -1) {
+      ::close(direct_fd_);
+      direct_fd_ = -1;
+    }
+  }
+#endif
   return fc::outcome::success();
 }
 
 fc::outcome::result<void> FileSystemFile::close() noexcept {
   OUTCOME_TRY(file_exists, exists());
-  try {
-    if (!file_exists) return FileStoreError::kFileNotFound;
-    if (!fstream_.is_open()) return FileStoreError::kFileClosed;
-
-    fstream_.close();
+  if (!file_exists) return FileStoreError::kFileNotFound;
+  if (!is_open()) return FileStoreError::kFileClosed;
 
-    if (fstream_.fail()) return FileStoreError::kUnknown;
-    return fc::outcome::success();
-  } catch (std::exception &) {
-    return FileStoreError::kUnknown;
+  auto closed{::close(fd_) == 0};
+  fd_ = -1;
+  if (direct_fd_ != -1) {
+    closed = ::close(direct_fd_) == 0 && closed;
+    direct_fd_ = -1;
   }
+  aligned_.reset();
+
+  if (!closed) return FileStoreError::kUnknown;
+  return fc::outcome::success();
 }
 
 fc::outcome::result<size_t> FileSystemFile::read(
     size_t offset, gsl::span<uint8_t> buffer) noexcept {
   OUTCOME_TRY(file_exists, exists());
   if (!file_exists) return FileStoreError::kFileNotFound;
-  if (!fstream_.is_open()) return FileStoreError::kFileClosed;
-  if (fstream_.fail()) return FileStoreError::kUnknown;
-
-  fstream_.seekg(offset, std::ios_base::beg);
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  fstream_.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
-  auto res = fstream_.gcount();
-
-  return res;
+  if (!is_open()) return FileStoreError::kFileClosed;
+
+  size_t read{0};
+  while (read < static_cast<size_t>(buffer.size())) {
+    auto n{::pread(
+        fd_, buffer.data() + read, buffer.size() - read, offset + read)};
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return FileStoreError::kUnknown;
+    }
+    if (n == 0) {
+      break;
+    }
+    read += n;
+  }
+  return read;
 }
 
 fc::outcome::result<size_t> FileSystemFile::write(
     size_t offset, gsl::span<const uint8_t> buffer) noexcept {
   OUTCOME_TRY(file_exists, exists());
   if (!file_exists) return FileStoreError::kFileNotFound;
-  if (!fstream_.is_open()) return FileStoreError::kFileClosed;
-  if (fstream_.fail()) return FileStoreError::kUnknown;
+  if (!is_open()) return FileStoreError::kFileClosed;
+
+  if (direct_fd_ != -1) {
+    OUTCOME_TRY(writeDirect(offset, buffer));
+  } else {
+    OUTCOME_TRY(writeBuffered(offset, buffer));
+  }
+  return buffer.size();
+}
 
-  fstream_.seekp(offset, std::ios_base::beg);
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  fstream_.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
-  fstream_.flush();
-  auto pos = fstream_.tellp();
-  if (pos == -1) return FileStoreError::kUnknown;
+fc::outcome::result<void> FileSystemFile::preallocate(size_t size) noexcept {
+  if (!is_open()) return FileStoreError::kFileClosed;
 
-  return static_cast<size_t>(pos) - offset;
+#if __linux__
+  if (fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0, size) == -1
+      && errno != EOPNOTSUPP) {
+    return FileStoreError::kUnknown;
+  }
+#endif
+  return fc::outcome::success();
 }
 
 bool FileSystemFile::is_open() const noexcept {
-  return fstream_.is_open();
+  return fd_ != -1;
 }
 
 fc::outcome::result<bool> FileSystemFile::exists() const noexcept {
@@ -96,3 +195,34 @@ fc::outcome::result<bool> FileSystemFile::exists() const noexcept {
 
   return res;
 }
+
+fc::outcome::result<void> FileSystemFile::writeBuffered(
+    size_t offset, gsl::span<const uint8_t> buffer) {
+  if (buffer.empty()) {
+    return fc::outcome::success();
+  }
+  OUTCOME_TRY(pwriteAll(fd_, buffer.data(), buffer.size(), offset));
+  if (options_.drop_cache) {
+    dropCache(fd_, offset, buffer.size());
+  }
+  return fc::outcome::success();
+}
+
+fc::outcome::result<void> FileSystemFile::writeDirect(
+    size_t offset, gsl::span<const uint8_t> buffer) {
+  // only whole blocks go through O_DIRECT, unaligned head and tail are
+  // written through page cache
+  auto begin{alignUp(offset)};
+  auto end{alignDown(offset + buffer.size())};
+  if (begin >= end) {
+    return writeBuffered(offset, buffer);
+  }
+  OUTCOME_TRY(writeBuffered(offset, buffer.subspan(0, begin - offset)));
+  for (auto pos{begin}; pos < end;) {
+    auto chunk{std::min(options_.buffer_size, end - pos)};
+    std::memcpy(aligned_.get(), buffer.data() + (pos - offset), chunk);
+    OUTCOME_TRY(pwriteAll(direct_fd_, aligned_.get(), chunk, pos));
+    pos += chunk;
+  }
+  return writeBuffered(end, buffer.subspan(end - offset));
+}
@@ -14,13 +14,31 @@
 namespace fc::storage::filestore {
 
   /**
-   * Boost filesystem implementation of File
+   * Posix implementation of File.
+   * Reads and writes go directly to file descriptor without user space
+   * buffering.
    */
   class FileSystemFile : public virtual File {
    public:
+    /** I/O modes for large sequential writes */
+    struct Options {
+      /**
+       * Write block aligned parts of data with O_DIRECT through aligned
+       * buffer, bypassing page cache. Ignored if filesystem doesn't support
+       * it.
+       */
+      bool direct_io{false};
+      /** Flush written ranges and evict them from page cache */
+      bool drop_cache{false};
+      /** Size of aligned buffer used for direct writes */
+      size_t buffer_size{size_t{1} << 20};
+    };
+
     explicit FileSystemFile(Path path);
 
-    ~FileSystemFile() override = default;
+    FileSystemFile(Path path, Options options);
+
+    ~FileSystemFile() override;
 
     /** \copydoc File::path() */
     Path path() const noexcept override;
@@ -42,6 +60,9 @@ namespace fc::storage::filestore {
     fc::outcome::result<size_t> write(
         size_t offset, gsl::span<const uint8_t> buffer) noexcept override;
 
+    /** \copydoc File::preallocate() */
+    fc::outcome::result<void> preallocate(size_t size) noexcept override;
+
     /** \copydoc File::is_open() */
     bool is_open() const noexcept override;
 
@@ -49,8 +70,17 @@ namespace fc::storage::filestore {
     fc::outcome::result<bool> exists() const noexcept override;
 
    private:
+    outcome::result<void> writeBuffered(size_t offset,
+                                        gsl::span<const uint8_t> buffer);
+    outcome::result<void> writeDirect(size_t offset,
+                                      gsl::span<const uint8_t> buffer);
+
     Path path_;
-    boost::filesystem::fstream fstream_;
+    Options options_;
+    int fd_{-1};
+    /** Second descriptor opened with O_DIRECT, -1 if unavailable */
+    int direct_fd_{-1};
+    std::unique_ptr<uint8_t, void (*)(void *)> aligned_{nullptr, free};
   };
 
 }  // namespace fc::storage::filestore
@@ -16,6 +16,9 @@ using fc::storage::filestore::Path;
 
 namespace fc::storage::filestore {
 
+  FileSystemFileStore::FileSystemFileStore(FileSystemFile::Options options)
+      : options_{options} {}
+
   outcome::result<bool> FileSystemFileStore::exists(
       const Path &path) const noexcept {
     return boost::filesystem::exists(path);
@@ -24,7 +27,7 @@ namespace fc::storage::filestore {
   outcome::result<std::shared_ptr<File>> FileSystemFileStore::open(
       const Path &path) noexcept {
     try {
-      auto file = std::make_shared<FileSystemFile>(path);
+      auto file = std::make_shared<FileSystemFile>(path, options_);
       OUTCOME_TRY(file->open());
       return file;
     } catch (std::exception &) {
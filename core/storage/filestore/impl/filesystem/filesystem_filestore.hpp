@@ -7,6 +7,7 @@
 #define FILECOIN_CORE_STORAGE_FILESTORE_FILESYSTEM_FILESTORE_HPP
 
 #include "storage/filestore/filestore.hpp"
+#include "storage/filestore/impl/filesystem/filesystem_file.hpp"
 
 namespace fc::storage::filestore {
 
@@ -15,6 +16,9 @@ namespace fc::storage::filestore {
    */
   class FileSystemFileStore : public virtual FileStore {
    public:
+    /** @param options - I/O options for opened files */
+    explicit FileSystemFileStore(FileSystemFile::Options options = {});
+
     ~FileSystemFileStore() override = default;
 
     /** @copydoc FileStore::exists() */
@@ -37,6 +41,9 @@ namespace fc::storage::filestore {
     /** @copydoc FileStore::list() */
     outcome::result<std::vector<Path>> list(
         const Path &directory) noexcept override;
+
+   private:
+    FileSystemFile::Options options_;
   };
 
 }  // namespace fc::storage::filestore
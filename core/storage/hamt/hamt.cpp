@@ -5,9 +5,15 @@
 
 #include "storage/hamt/hamt.hpp"
 
+#include <deque>
+#include <map>
+
+#include <boost/assert.hpp>
 #include <libp2p/crypto/sha/sha256.hpp>
 
+#include "common/thread_pool.hpp"
 #include "common/which.hpp"
+#include "storage/hamt/node_cache.hpp"
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::hamt, HamtError, e) {
   using fc::storage::hamt::HamtError;
@@ -32,17 +38,26 @@ namespace fc::storage::hamt {
   Hamt::Hamt(std::shared_ptr<ipfs::IpfsDatastore> store, size_t bit_width)
       : ipld{std::move(store)},
         root_{std::make_shared<Node>()},
-        bit_width_{bit_width} {}
+        bit_width_{bit_width} {
+    BOOST_ASSERT_MSG(bit_width_ >= 1 && bit_width_ <= kMaxBitWidth,
+                     "bit width is out of range");
+  }
 
   Hamt::Hamt(std::shared_ptr<ipfs::IpfsDatastore> store,
              Node::Ptr root,
              size_t bit_width)
-      : ipld{std::move(store)}, root_{std::move(root)}, bit_width_{bit_width} {}
+      : ipld{std::move(store)}, root_{std::move(root)}, bit_width_{bit_width} {
+    BOOST_ASSERT_MSG(bit_width_ >= 1 && bit_width_ <= kMaxBitWidth,
+                     "bit width is out of range");
+  }
 
   Hamt::Hamt(std::shared_ptr<ipfs::IpfsDatastore> store,
              const CID &root,
              size_t bit_width)
-      : ipld{std::move(store)}, root_{root}, bit_width_{bit_width} {}
+      : ipld{std::move(store)}, root_{root}, bit_width_{bit_width} {
+    BOOST_ASSERT_MSG(bit_width_ >= 1 && bit_width_ <= kMaxBitWidth,
+                     "bit width is out of range");
+  }
 
   outcome::result<void> Hamt::set(const std::string &key,
                                   gsl::span<const uint8_t> value) {
@@ -54,25 +69,43 @@ namespace fc::storage::hamt {
     OUTCOME_TRY(loadItem(root_));
     auto node = boost::get<Node::Ptr>(root_);
     for (auto index : keyToIndices(key)) {
-      auto it = node->items.find(index);
-      if (it == node->items.end()) {
+      auto item = node->find(index);
+      if (!item) {
         return HamtError::kNotFound;
       }
-      auto &item = it->second;
-      OUTCOME_TRY(loadItem(item));
-      if (which<Node::Ptr>(item)) {
-        node = boost::get<Node::Ptr>(item);
+      OUTCOME_TRY(loadItem(*item));
+      if (which<Node::Ptr>(*item)) {
+        node = boost::get<Node::Ptr>(*item);
       } else {
-        auto &leaf = boost::get<Node::Leaf>(item);
-        if (leaf.find(key) == leaf.end()) {
+        auto value = boost::get<Node::Leaf>(*item).find(key);
+        if (!value) {
           return HamtError::kNotFound;
         }
-        return leaf[key];
+        return *value;
       }
     }
     return HamtError::kMaxDepth;
   }
 
+  outcome::result<std::vector<boost::optional<Value>>> Hamt::getMany(
+      const std::vector<std::string> &keys) const {
+    std::vector<boost::optional<Value>> values(keys.size());
+    auto paths{sortedPaths(keys.size(),
+                           [&](auto i) -> const std::string & { return keys[i]; })};
+    OUTCOME_TRY(loadItem(root_));
+    OUTCOME_TRY(getMany(*boost::get<Node::Ptr>(root_), 0, paths, keys, values));
+    return std::move(values);
+  }
+
+  outcome::result<void> Hamt::setMany(
+      const std::vector<std::pair<std::string, Value>> &pairs) {
+    auto paths{sortedPaths(
+        pairs.size(),
+        [&](auto i) -> const std::string & { return pairs[i].first; })};
+    OUTCOME_TRY(loadItem(root_));
+    return setMany(*boost::get<Node::Ptr>(root_), 0, paths, pairs);
+  }
+
   outcome::result<void> Hamt::remove(const std::string &key) {
     OUTCOME_TRY(loadItem(root_));
     return remove(*boost::get<Node::Ptr>(root_), keyToIndices(key), key);
@@ -88,11 +121,19 @@ namespace fc::storage::hamt {
   }
 
   outcome::result<CID> Hamt::flush() {
-    OUTCOME_TRY(flush(root_));
+    Ipld::Batch batch;
+    OUTCOME_TRY(flush(root_, batch));
+    OUTCOME_TRY(ipld->setMany(std::move(batch)));
     return cid();
   }
 
   const CID &Hamt::cid() const {
+    if (which<Node::Ptr>(root_)) {
+      auto &root{*boost::get<Node::Ptr>(root_)};
+      if (root.cid) {
+        return *root.cid;
+      }
+    }
     return boost::get<CID>(root_);
   }
 
@@ -120,6 +161,134 @@ namespace fc::storage::hamt {
     return indices;
   }
 
+  std::vector<Hamt::Path> Hamt::sortedPaths(
+      size_t n, const std::function<const std::string &(size_t)> &key) const {
+    std::vector<Path> paths;
+    paths.reserve(n);
+    for (size_t i{0}; i < n; ++i) {
+      paths.emplace_back(keyToIndices(key(i)), i);
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+  }
+
+  /// Take leading paths with same index at depth
+  auto consumeGroup(gsl::span<const std::pair<std::vector<size_t>, size_t>> &paths,
+                    size_t depth) {
+    auto index{paths[0].first[depth]};
+    size_t n{1};
+    while (n < static_cast<size_t>(paths.size()) && paths[n].first[depth] == index) {
+      ++n;
+    }
+    auto group{paths.first(n)};
+    paths = paths.subspan(n);
+    return std::make_pair(index, group);
+  }
+
+  outcome::result<void> Hamt::getMany(
+      Node &node,
+      size_t depth,
+      gsl::span<const Path> paths,
+      const std::vector<std::string> &keys,
+      std::vector<boost::optional<Value>> &values) const {
+    while (!paths.empty()) {
+      if (depth >= paths[0].first.size()) {
+        return HamtError::kMaxDepth;
+      }
+      auto [index, group]{consumeGroup(paths, depth)};
+      auto item = node.find(index);
+      if (!item) {
+        continue;
+      }
+      OUTCOME_TRY(loadItem(*item));
+      if (which<Node::Ptr>(*item)) {
+        OUTCOME_TRY(getMany(
+            *boost::get<Node::Ptr>(*item), depth + 1, group, keys, values));
+      } else {
+        auto &leaf = boost::get<Node::Leaf>(*item);
+        for (auto &path : group) {
+          if (auto value = leaf.find(keys[path.second])) {
+            values[path.second] = *value;
+          }
+        }
+      }
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Hamt::setMany(
+      Node &node,
+      size_t depth,
+      gsl::span<const Path> paths,
+      const std::vector<std::pair<std::string, Value>> &pairs) {
+    while (!paths.empty()) {
+      if (depth >= paths[0].first.size()) {
+        return HamtError::kMaxDepth;
+      }
+      auto [index, group]{consumeGroup(paths, depth)};
+      node.cid = boost::none;
+      auto item = node.find(index);
+      if (item) {
+        OUTCOME_TRY(loadItem(*item));
+        if (which<Node::Ptr>(*item)) {
+          OUTCOME_TRY(
+              setMany(*boost::get<Node::Ptr>(*item), depth + 1, group, pairs));
+          continue;
+        }
+      }
+      // empty slot or leaf, may turn into shard while setting
+      for (auto &path : group) {
+        auto &pair{pairs[path.second]};
+        OUTCOME_TRY(set(node,
+                        gsl::make_span(path.first).subspan(depth),
+                        pair.first,
+                        pair.second));
+      }
+    }
+    return outcome::success();
+  }
+
+  outcome::result<Hamt> Hamt::fromPairs(
+      std::shared_ptr<ipfs::IpfsDatastore> store,
+      std::vector<std::pair<std::string, Value>> pairs,
+      size_t bit_width) {
+    Hamt hamt{std::move(store), bit_width};
+    auto paths{hamt.sortedPaths(
+        pairs.size(),
+        [&](auto i) -> const std::string & { return pairs[i].first; })};
+    OUTCOME_TRY(build(*boost::get<Node::Ptr>(hamt.root_), 0, paths, pairs));
+    OUTCOME_TRY(hamt.flush());
+    return std::move(hamt);
+  }
+
+  outcome::result<void> Hamt::build(
+      Node &node,
+      size_t depth,
+      gsl::span<const Path> paths,
+      std::vector<std::pair<std::string, Value>> &pairs) {
+    while (!paths.empty()) {
+      if (depth >= paths[0].first.size()) {
+        return HamtError::kMaxDepth;
+      }
+      // groups are consumed in slot order, so items are appended
+      auto [index, group]{consumeGroup(paths, depth)};
+      node.bits.set(index);
+      if (static_cast<size_t>(group.size()) <= kLeafMax) {
+        Node::Leaf leaf;
+        for (auto &path : group) {
+          auto &pair{pairs[path.second]};
+          leaf.set(pair.first, std::move(pair.second));
+        }
+        node.items.emplace_back(std::move(leaf));
+      } else {
+        auto child{std::make_shared<Node>()};
+        OUTCOME_TRY(build(*child, depth + 1, group, pairs));
+        node.items.emplace_back(std::move(child));
+      }
+    }
+    return outcome::success();
+  }
+
   outcome::result<void> Hamt::set(Node &node,
                                   gsl::span<const size_t> indices,
                                   const std::string &key,
@@ -127,23 +296,24 @@ namespace fc::storage::hamt {
     if (indices.empty()) {
       return HamtError::kMaxDepth;
     }
+    node.cid = boost::none;
     auto index = indices[0];
-    auto it = node.items.find(index);
-    if (it == node.items.end()) {
+    auto maybe_item = node.find(index);
+    if (!maybe_item) {
       Node::Leaf leaf;
-      leaf.emplace(key, std::vector<uint8_t>(value.begin(), value.end()));
-      node.items[index] = leaf;
+      leaf.set(key, Value{value});
+      node.set(index, std::move(leaf));
       return outcome::success();
     }
-    auto &item = it->second;
+    auto &item = *maybe_item;
     OUTCOME_TRY(loadItem(item));
     if (which<Node::Ptr>(item)) {
       return set(
           *boost::get<Node::Ptr>(item), consumeIndex(indices), key, value);
     }
     auto &leaf = boost::get<Node::Leaf>(item);
-    if (leaf.find(key) != leaf.end() || leaf.size() < kLeafMax) {
-      leaf[key] = Value(value);
+    if (leaf.find(key) || leaf.size() < kLeafMax) {
+      leaf.set(key, Value{value});
     } else {
       auto child = std::make_shared<Node>();
       OUTCOME_TRY(set(*child, consumeIndex(indices), key, value));
@@ -163,11 +333,11 @@ namespace fc::storage::hamt {
       return HamtError::kMaxDepth;
     }
     auto index = indices[0];
-    auto it = node.items.find(index);
-    if (it == node.items.end()) {
+    auto maybe_item = node.find(index);
+    if (!maybe_item) {
       return HamtError::kNotFound;
     }
-    auto &item = it->second;
+    auto &item = *maybe_item;
     OUTCOME_TRY(loadItem(item));
     if (which<Node::Ptr>(item)) {
       OUTCOME_TRY(
@@ -175,33 +345,35 @@ namespace fc::storage::hamt {
       OUTCOME_TRY(cleanShard(item));
     } else {
       auto &leaf = boost::get<Node::Leaf>(item);
-      if (leaf.find(key) == leaf.end()) {
+      if (!leaf.find(key)) {
         return HamtError::kNotFound;
       }
       if (leaf.size() == 1) {
-        node.items.erase(index);
+        node.erase(index);
       } else {
         leaf.erase(key);
       }
     }
+    node.cid = boost::none;
     return outcome::success();
   }
 
   outcome::result<void> Hamt::cleanShard(Node::Item &item) {
     auto &node = *boost::get<Node::Ptr>(item);
     if (node.items.size() == 1) {
-      auto &single_item = node.items.begin()->second;
+      auto &single_item = node.items.front();
       if (which<Node::Leaf>(single_item)) {
-        item = single_item;
+        Node::Item leaf{std::move(single_item)};
+        item = std::move(leaf);
       }
     } else if (node.items.size() <= kLeafMax) {
       Node::Leaf leaf;
       for (auto &item2 : node.items) {
-        if (!which<Node::Leaf>(item2.second)) {
+        if (!which<Node::Leaf>(item2)) {
           return outcome::success();
         }
-        for (auto &pair : boost::get<Node::Leaf>(item2.second)) {
-          leaf.emplace(pair);
+        for (auto &pair : boost::get<Node::Leaf>(item2)) {
+          leaf.set(pair.first, pair.second);
           if (leaf.size() > kLeafMax) {
             return outcome::success();
           }
@@ -212,22 +384,174 @@ namespace fc::storage::hamt {
     return outcome::success();
   }
 
-  outcome::result<void> Hamt::flush(Node::Item &item) {
-    if (which<Node::Ptr>(item)) {
-      auto &node = *boost::get<Node::Ptr>(item);
-      for (auto &item2 : node.items) {
-        OUTCOME_TRY(flush(item2.second));
+  /// Copy of flushed node referencing children by CID only
+  auto flushedCopy(const Node &node) {
+    auto copy{std::make_shared<Node>()};
+    copy->bits = node.bits;
+    copy->items.reserve(node.items.size());
+    for (auto &item : node.items) {
+      if (which<Node::Ptr>(item)) {
+        copy->items.emplace_back(*boost::get<Node::Ptr>(item)->cid);
+      } else {
+        copy->items.push_back(item);
+      }
+    }
+    copy->cid = node.cid;
+    return copy;
+  }
+
+  outcome::result<void> Hamt::flush(Node::Item &item, Ipld::Batch &batch) {
+    if (!which<Node::Ptr>(item) || boost::get<Node::Ptr>(item)->cid) {
+      // not modified, children are not modified too
+      return outcome::success();
+    }
+    // modified nodes by depth, nodes of one depth don't reference each other
+    std::vector<std::vector<Node *>> levels{
+        {boost::get<Node::Ptr>(item).get()}};
+    while (true) {
+      std::vector<Node *> next;
+      for (auto node : levels.back()) {
+        for (auto &item2 : node->items) {
+          if (which<Node::Ptr>(item2)) {
+            auto &child{*boost::get<Node::Ptr>(item2)};
+            if (!child.cid) {
+              next.push_back(&child);
+            }
+          }
+        }
+      }
+      if (next.empty()) {
+        break;
+      }
+      levels.push_back(std::move(next));
+    }
+    // children are encoded before parents, each level is hashed at once
+    for (auto level{levels.rbegin()}; level != levels.rend(); ++level) {
+      std::vector<Buffer> encoded;
+      encoded.reserve(level->size());
+      for (auto node : *level) {
+        OUTCOME_TRY(bytes, Ipld::encode(*node));
+        encoded.push_back(std::move(bytes));
+      }
+      std::vector<gsl::span<const uint8_t>> inputs{encoded.begin(),
+                                                   encoded.end()};
+      OUTCOME_TRY(cids, common::getCidsOf(inputs));
+      for (size_t i{0}; i < encoded.size(); ++i) {
+        auto &node{*(*level)[i]};
+        node.cid = cids[i];
+        if (cache) {
+          cache->put(cids[i], flushedCopy(node), encoded[i].size());
+        }
+        batch.emplace_back(std::move(cids[i]), std::move(encoded[i]));
       }
-      OUTCOME_TRY(cid, ipld->setCbor(node));
-      item = cid;
     }
     return outcome::success();
   }
 
+  /// Load node through cache, safe to call concurrently
+  outcome::result<Node::Ptr> loadNode(const IpldPtr &ipld,
+                                      const std::shared_ptr<NodeCache> &cache,
+                                      const CID &cid) {
+    if (cache) {
+      if (auto cached{cache->get(cid)}) {
+        auto node{std::make_shared<Node>(*cached)};
+        node->cid = cid;
+        return node;
+      }
+    }
+    OUTCOME_TRY(bytes, ipld->getShared(cid));
+    OUTCOME_TRY(child, ipld->decode<Node>(*bytes));
+    child.cid = cid;
+    if (cache) {
+      cache->put(cid, std::make_shared<const Node>(child), bytes->size());
+    }
+    return std::make_shared<Node>(std::move(child));
+  }
+
   outcome::result<void> Hamt::loadItem(Node::Item &item) const {
     if (which<CID>(item)) {
-      OUTCOME_TRY(child, ipld->getCbor<Node>(boost::get<CID>(item)));
-      item = std::make_shared<Node>(std::move(child));
+      OUTCOME_TRY(node, loadNode(ipld, cache, boost::get<CID>(item)));
+      item = std::move(node);
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Hamt::diff(const Hamt &to,
+                                   const DiffVisitor &visitor) const {
+    return diff(root_, to, to.root_, visitor);
+  }
+
+  /// Cid of item if known without loading
+  const CID *itemCid(const Node::Item &item) {
+    if (which<CID>(item)) {
+      return &boost::get<CID>(item);
+    }
+    if (which<Node::Ptr>(item)) {
+      auto &cid{boost::get<Node::Ptr>(item)->cid};
+      return cid ? &*cid : nullptr;
+    }
+    return nullptr;
+  }
+
+  outcome::result<void> Hamt::diff(Node::Item &from,
+                                   const Hamt &to_hamt,
+                                   Node::Item &to,
+                                   const DiffVisitor &visitor) const {
+    auto cid1{itemCid(from)}, cid2{itemCid(to)};
+    if (cid1 && cid2 && *cid1 == *cid2) {
+      return outcome::success();
+    }
+    OUTCOME_TRY(loadItem(from));
+    OUTCOME_TRY(to_hamt.loadItem(to));
+    auto removed{[&](auto &key, auto &value) {
+      return visitor(key, &value, nullptr);
+    }};
+    auto added{[&](auto &key, auto &value) {
+      return visitor(key, nullptr, &value);
+    }};
+    if (which<Node::Ptr>(from) && which<Node::Ptr>(to)) {
+      auto &node1{*boost::get<Node::Ptr>(from)};
+      auto &node2{*boost::get<Node::Ptr>(to)};
+      for (size_t index{0}; index < (size_t{1} << bit_width_); ++index) {
+        auto item1{node1.find(index)};
+        auto item2{node2.find(index)};
+        if (item1 && item2) {
+          OUTCOME_TRY(diff(*item1, to_hamt, *item2, visitor));
+        } else if (item1) {
+          OUTCOME_TRY(visit(*item1, removed));
+        } else if (item2) {
+          OUTCOME_TRY(to_hamt.visit(*item2, added));
+        }
+      }
+      return outcome::success();
+    }
+    // leaf has few keys, and shard on other side has few more
+    std::map<std::string, const Value *> values1, values2;
+    OUTCOME_TRY(visit(from, [&](auto &key, auto &value) {
+      values1.emplace(key, &value);
+      return outcome::success();
+    }));
+    OUTCOME_TRY(to_hamt.visit(to, [&](auto &key, auto &value) {
+      values2.emplace(key, &value);
+      return outcome::success();
+    }));
+    auto it1{values1.begin()};
+    auto it2{values2.begin()};
+    while (it1 != values1.end() || it2 != values2.end()) {
+      if (it2 == values2.end()
+          || (it1 != values1.end() && it1->first < it2->first)) {
+        OUTCOME_TRY(visitor(it1->first, it1->second, nullptr));
+        ++it1;
+      } else if (it1 == values1.end() || it2->first < it1->first) {
+        OUTCOME_TRY(visitor(it2->first, nullptr, it2->second));
+        ++it2;
+      } else {
+        if (*it1->second != *it2->second) {
+          OUTCOME_TRY(visitor(it1->first, it1->second, it2->second));
+        }
+        ++it1;
+        ++it2;
+      }
     }
     return outcome::success();
   }
@@ -236,11 +560,79 @@ namespace fc::storage::hamt {
     return visit(root_, visitor);
   }
 
+  outcome::result<void> Hamt::visitPrefetch(const Visitor &visitor,
+                                            boost::asio::thread_pool &pool,
+                                            size_t lookahead) const {
+    OUTCOME_TRY(loadItem(root_));
+    return visitPrefetch(root_, visitor, pool, std::max<size_t>(lookahead, 1));
+  }
+
+  outcome::result<void> Hamt::visitPrefetch(Node::Item &item,
+                                            const Visitor &visitor,
+                                            boost::asio::thread_pool &pool,
+                                            size_t lookahead) const {
+    if (which<Node::Leaf>(item)) {
+      for (auto &pair : boost::get<Node::Leaf>(item)) {
+        OUTCOME_TRY(visitor(pair.first, pair.second));
+      }
+      return outcome::success();
+    }
+    auto &items{boost::get<Node::Ptr>(item)->items};
+    std::deque<std::pair<size_t, std::future<outcome::result<Node::Ptr>>>>
+        pending;
+    size_t next{0};
+    for (size_t i{0}; i < items.size(); ++i) {
+      for (; next < items.size() && pending.size() < lookahead; ++next) {
+        if (which<CID>(items[next])) {
+          pending.emplace_back(
+              next,
+              postFuture(pool,
+                         [ipld{ipld},
+                          cache{cache},
+                          cid{boost::get<CID>(items[next])}] {
+                           return loadNode(ipld, cache, cid);
+                         }));
+        }
+      }
+      auto &child{items[i]};
+      if (!pending.empty() && pending.front().first == i) {
+        OUTCOME_TRY(node, pending.front().second.get());
+        pending.pop_front();
+        child = std::move(node);
+      }
+      OUTCOME_TRY(loadItem(child));
+      OUTCOME_TRY(visitPrefetch(child, visitor, pool, lookahead));
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Hamt::visitParallel(
+      const Visitor &visitor, boost::asio::thread_pool &pool) const {
+    OUTCOME_TRY(loadItem(root_));
+    std::vector<std::future<outcome::result<void>>> futures;
+    for (auto &item : boost::get<Node::Ptr>(root_)->items) {
+      futures.push_back(postFuture(
+          pool, [this, &item, &visitor] { return visit(item, visitor); }));
+    }
+    // tasks reference visitor, wait all before result or exception
+    for (auto &future : futures) {
+      future.wait();
+    }
+    outcome::result<void> result{outcome::success()};
+    for (auto &future : futures) {
+      auto visited{future.get()};
+      if (!visited && result) {
+        result = visited.error();
+      }
+    }
+    return result;
+  }
+
   outcome::result<void> Hamt::visit(Node::Item &item, const Visitor &visitor) const {
     OUTCOME_TRY(loadItem(item));
     if (which<Node::Ptr>(item)) {
       for (auto &item2 : boost::get<Node::Ptr>(item)->items) {
-        OUTCOME_TRY(visit(item2.second, visitor));
+        OUTCOME_TRY(visit(item2, visitor));
       }
     } else {
       for (auto &pair : boost::get<Node::Leaf>(item)) {
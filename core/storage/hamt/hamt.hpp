@@ -9,17 +9,22 @@
 #include <string>
 #include <vector>
 
-#include <boost/multiprecision/cpp_int.hpp>
+#include <boost/container/small_vector.hpp>
 #include <boost/variant.hpp>
 
 #include "codec/cbor/cbor.hpp"
 #include "codec/cbor/streams_annotation.hpp"
+#include "common/bitsutil.hpp"
 #include "common/outcome.hpp"
 #include "common/span.hpp"
 #include "common/visitor.hpp"
 #include "primitives/cid/cid.hpp"
 #include "storage/ipfs/datastore.hpp"
 
+namespace boost::asio {
+  class thread_pool;
+}  // namespace boost::asio
+
 namespace fc::storage::hamt {
   enum class HamtError { kExpectedCID = 1, kNotFound, kMaxDepth };
 }  // namespace fc::storage::hamt
@@ -27,19 +32,53 @@ namespace fc::storage::hamt {
 OUTCOME_HPP_DECLARE_ERROR(fc::storage::hamt, HamtError);
 
 namespace fc::storage::hamt {
-  using boost::multiprecision::cpp_int;
   using common::Buffer;
   using Value = ipfs::IpfsDatastore::Value;
 
   constexpr size_t kLeafMax = 3;
   constexpr size_t kDefaultBitWidth = 5;
+  /// Node slots bitmap is fixed-width, so bit width is limited
+  constexpr size_t kMaxBitWidth = 8;
+
+  class NodeCache;
+
+  /// Fixed width bitmap of occupied node slots
+  struct Bits {
+    static constexpr size_t kWords{(1 << kMaxBitWidth) / 64};
+    static constexpr size_t kBytes{kWords * 8};
+
+    bool test(size_t i) const {
+      return (words[i / 64] >> (i % 64)) & 1;
+    }
 
-  struct Bits : cpp_int {};
+    void set(size_t i) {
+      words[i / 64] |= 1ull << (i % 64);
+    }
+
+    void reset(size_t i) {
+      words[i / 64] &= ~(1ull << (i % 64));
+    }
 
+    /// Number of set bits before i, i.e. position of slot i in dense items
+    size_t rank(size_t i) const {
+      size_t n{0};
+      for (size_t w{0}; w < i / 64; ++w) {
+        n += common::countSetBits(words[w]);
+      }
+      return n + common::countSetBits(words[i / 64] & ((1ull << (i % 64)) - 1));
+    }
+
+    std::array<uint64_t, kWords> words{};
+  };
+
+  /// Big-endian bytes without leading zeros, same as go big.Int
   CBOR_ENCODE(Bits, bits) {
     std::vector<uint8_t> bytes;
-    if (bits != 0) {
-      export_bits(bits, std::back_inserter(bytes), 8);
+    for (auto i{Bits::kBytes}; i != 0; --i) {
+      uint8_t byte = bits.words[(i - 1) / 8] >> (8 * ((i - 1) % 8));
+      if (byte != 0 || !bytes.empty()) {
+        bytes.push_back(byte);
+      }
     }
     return s << bytes;
   }
@@ -47,10 +86,13 @@ namespace fc::storage::hamt {
   CBOR_DECODE(Bits, bits) {
     std::vector<uint8_t> bytes;
     s >> bytes;
-    if (bytes.empty()) {
-      bits = {0};
-    } else {
-      import_bits(bits, bytes.begin(), bytes.end());
+    if (bytes.size() > Bits::kBytes) {
+      outcome::raise(codec::cbor::CborDecodeError::kWrongSize);
+    }
+    bits = {};
+    for (size_t i{0}; i < bytes.size(); ++i) {
+      auto k{bytes.size() - 1 - i};
+      bits.words[k / 8] |= uint64_t{bytes[i]} << (8 * (k % 8));
     }
     return s;
   }
@@ -58,22 +100,117 @@ namespace fc::storage::hamt {
   /** Hamt node representation */
   struct Node {
     using Ptr = std::shared_ptr<Node>;
-    using Leaf = std::map<std::string, Value>;
+
+    /// Key value pairs sorted by key, at most kLeafMax stored inline
+    struct Leaf {
+      using Entry = std::pair<std::string, Value>;
+      using Entries = boost::container::small_vector<Entry, kLeafMax>;
+
+      Leaf() = default;
+      Leaf(std::initializer_list<Entry> list) {
+        for (auto &entry : list) {
+          set(entry.first, entry.second);
+        }
+      }
+
+      auto lowerBound(const std::string &key) const {
+        return std::lower_bound(
+            entries.begin(), entries.end(), key, [](auto &entry, auto &key) {
+              return entry.first < key;
+            });
+      }
+
+      const Value *find(const std::string &key) const {
+        auto it{lowerBound(key)};
+        if (it != entries.end() && it->first == key) {
+          return &it->second;
+        }
+        return nullptr;
+      }
+
+      /// Insert or replace value, keeping keys sorted
+      void set(const std::string &key, Value value) {
+        auto it{entries.begin() + (lowerBound(key) - entries.cbegin())};
+        if (it != entries.end() && it->first == key) {
+          it->second = std::move(value);
+        } else {
+          entries.emplace(it, key, std::move(value));
+        }
+      }
+
+      bool erase(const std::string &key) {
+        auto it{lowerBound(key)};
+        if (it != entries.end() && it->first == key) {
+          entries.erase(it);
+          return true;
+        }
+        return false;
+      }
+
+      size_t size() const {
+        return entries.size();
+      }
+
+      auto begin() const {
+        return entries.begin();
+      }
+
+      auto end() const {
+        return entries.end();
+      }
+
+      Entries entries;
+    };
+
     using Item = boost::variant<CID, Ptr, Leaf>;
 
-    std::map<size_t, Item> items;
+    /// Item at slot index, or nullptr
+    Item *find(size_t index) {
+      return bits.test(index) ? &items[bits.rank(index)] : nullptr;
+    }
+
+    const Item *find(size_t index) const {
+      return bits.test(index) ? &items[bits.rank(index)] : nullptr;
+    }
+
+    /// Insert or replace item at slot index
+    Item &set(size_t index, Item item) {
+      auto pos{bits.rank(index)};
+      if (bits.test(index)) {
+        return items[pos] = std::move(item);
+      }
+      bits.set(index);
+      return *items.insert(items.begin() + pos, std::move(item));
+    }
+
+    void erase(size_t index) {
+      if (bits.test(index)) {
+        items.erase(items.begin() + bits.rank(index));
+        bits.reset(index);
+      }
+    }
+
+    /// Occupied slots
+    Bits bits;
+    /// Items of occupied slots, ordered by slot index
+    std::vector<Item> items;
+    /// CID of node if not modified since load or flush, not encoded
+    boost::optional<CID> cid;
   };
 
   CBOR_ENCODE(Node, node) {
     auto l_items = s.list();
-    Bits bits;
     for (auto &item : node.items) {
-      bit_set(bits, item.first);
       auto m_item = s.map();
       visit_in_place(
-          item.second,
+          item,
           [&m_item](const CID &cid) { m_item["0"] << cid; },
-          [](const Node::Ptr &ptr) { outcome::raise(HamtError::kExpectedCID); },
+          [&m_item](const Node::Ptr &ptr) {
+            if (!ptr || !ptr->cid) {
+              outcome::raise(HamtError::kExpectedCID);
+            }
+            m_item["0"] << *ptr->cid;
+          },
           [&m_item](const Node::Leaf &leaf) {
             auto &s_leaf = m_item["1"];
             auto l_pairs = s_leaf.list();
@@ -85,26 +222,29 @@ namespace fc::storage::hamt {
           });
       l_items << m_item;
     }
-    return s << (s.list() << bits << l_items);
+    return s << (s.list() << node.bits << l_items);
   }
 
   CBOR_DECODE(Node, node) {
-    node.items.clear();
     auto l_node = s.list();
-    Bits bits;
-    l_node >> bits;
+    l_node >> node.bits;
     auto n_items = l_node.listLength();
+    size_t n_bits{0};
+    for (auto word : node.bits.words) {
+      n_bits += common::countSetBits(word);
+    }
+    if (n_items != n_bits) {
+      outcome::raise(codec::cbor::CborDecodeError::kWrongSize);
+    }
     auto l_items = l_node.list();
-    size_t j = 0;
+    node.items.clear();
+    node.items.reserve(n_items);
     for (size_t i = 0; i < n_items; ++i) {
-      while (!bit_test(bits, j)) {
-        ++j;
-      }
       auto m_item = l_items.map();
       if (m_item.find("0") != m_item.end()) {
         CID cid;
         m_item.at("0") >> cid;
-        node.items[j] = std::move(cid);
+        node.items.emplace_back(std::move(cid));
       } else {
         auto s_leaf = m_item.at("1");
         auto n_leaf = s_leaf.listLength();
@@ -114,11 +254,10 @@ namespace fc::storage::hamt {
           auto l_pair = l_leaf.list();
           Buffer key;
           l_pair >> key;
-          leaf.emplace(std::string{key.begin(), key.end()}, l_pair.raw());
+          leaf.set(std::string{key.begin(), key.end()}, l_pair.raw());
         }
-        node.items[j] = std::move(leaf);
+        node.items.emplace_back(std::move(leaf));
       }
-      ++j;
     }
     return s;
   }
@@ -131,6 +270,10 @@ namespace fc::storage::hamt {
    public:
     using Visitor = std::function<outcome::result<void>(const std::string &,
                                                         const Value &)>;
+    /// Receives changed key with old value, null if added, and new value,
+    /// null if removed
+    using DiffVisitor = std::function<outcome::result<void>(
+        const std::string &, const Value *, const Value *)>;
 
     Hamt(std::shared_ptr<ipfs::IpfsDatastore> store,
          size_t bit_width = kDefaultBitWidth);
@@ -140,6 +283,15 @@ namespace fc::storage::hamt {
     Hamt(std::shared_ptr<ipfs::IpfsDatastore> store,
          const CID &root,
          size_t bit_width = kDefaultBitWidth);
+    /**
+     * Build hamt from pairs with unique keys bottom-up, each slot gets its
+     * final leaf or shard at once. Each node is encoded and written once, in
+     * one setMany.
+     */
+    static outcome::result<Hamt> fromPairs(
+        std::shared_ptr<ipfs::IpfsDatastore> store,
+        std::vector<std::pair<std::string, Value>> pairs,
+        size_t bit_width = kDefaultBitWidth);
     /** Set value by key, does not write to storage */
     outcome::result<void> set(const std::string &key,
                               gsl::span<const uint8_t> value);
@@ -147,6 +299,21 @@ namespace fc::storage::hamt {
     /** Get value by key */
     outcome::result<Value> get(const std::string &key) const;
 
+    /**
+     * Get values by keys, walking shared path prefixes once.
+     * Keys are sorted by hash path, result is in order of keys, missing
+     * keys are none.
+     */
+    outcome::result<std::vector<boost::optional<Value>>> getMany(
+        const std::vector<std::string> &keys) const;
+
+    /**
+     * Set values by keys, walking shared path prefixes once, does not write
+     * to storage. Later pair wins for duplicate keys.
+     */
+    outcome::result<void> setMany(
+        const std::vector<std::pair<std::string, Value>> &pairs);
+
     /**
      * Remove value by key, does not write to storage.
      * Returns kNotFound if element doesn't exist.
@@ -159,7 +326,9 @@ namespace fc::storage::hamt {
     outcome::result<bool> contains(const std::string &key) const;
 
     /**
-     * Write changes made by set and remove to storage
+     * Write changes made by set and remove to storage.
+     * Only modified nodes are encoded and written in one setMany, loaded
+     * nodes stay in memory.
      * @return new root
      */
     outcome::result<CID> flush();
@@ -170,6 +339,31 @@ namespace fc::storage::hamt {
     /** Apply visitor for key value pairs */
     outcome::result<void> visit(const Visitor &visitor) const;
 
+    /**
+     * Apply visitor for key value pairs in same order as visit, while up to
+     * lookahead next child nodes of each node are loaded on pool.
+     * Ipld must support concurrent get.
+     */
+    outcome::result<void> visitPrefetch(const Visitor &visitor,
+                                        boost::asio::thread_pool &pool,
+                                        size_t lookahead) const;
+
+    /**
+     * Apply visitor for key value pairs, subtrees of root are visited
+     * concurrently on pool, so order is unspecified.
+     * Visitor and ipld must be thread-safe.
+     */
+    outcome::result<void> visitParallel(const Visitor &visitor,
+                                        boost::asio::thread_pool &pool) const;
+
+    /**
+     * Apply visitor for keys changed from this hamt to other of same bit
+     * width, in hash order. Subtrees with equal cid are skipped, so cost
+     * depends on changes rather than size.
+     */
+    outcome::result<void> diff(const Hamt &to,
+                               const DiffVisitor &visitor) const;
+
     /// Store CBOR encoded value by key
     template <typename T>
     outcome::result<void> setCbor(const std::string &key, const T &value) {
@@ -199,9 +393,33 @@ namespace fc::storage::hamt {
     }
 
     IpldPtr ipld;
+    /// Optional decoded node cache consulted before ipld
+    std::shared_ptr<NodeCache> cache;
 
    private:
+    /// Hash path of key and position of key in batch
+    using Path = std::pair<std::vector<size_t>, size_t>;
+
     std::vector<size_t> keyToIndices(const std::string &key, int n = -1) const;
+    std::vector<Path> sortedPaths(size_t n,
+                                  const std::function<const std::string &(
+                                      size_t)> &key) const;
+    outcome::result<void> getMany(
+        Node &node,
+        size_t depth,
+        gsl::span<const Path> paths,
+        const std::vector<std::string> &keys,
+        std::vector<boost::optional<Value>> &values) const;
+    outcome::result<void> setMany(
+        Node &node,
+        size_t depth,
+        gsl::span<const Path> paths,
+        const std::vector<std::pair<std::string, Value>> &pairs);
+    static outcome::result<void> build(
+        Node &node,
+        size_t depth,
+        gsl::span<const Path> paths,
+        std::vector<std::pair<std::string, Value>> &pairs);
     outcome::result<void> set(Node &node,
                               gsl::span<const size_t> indices,
                               const std::string &key,
@@ -210,9 +428,17 @@ namespace fc::storage::hamt {
                                  gsl::span<const size_t> indices,
                                  const std::string &key);
     static outcome::result<void> cleanShard(Node::Item &item);
-    outcome::result<void> flush(Node::Item &item);
+    outcome::result<void> flush(Node::Item &item, Ipld::Batch &batch);
     outcome::result<void> loadItem(Node::Item &item) const;
+    outcome::result<void> diff(Node::Item &from,
+                               const Hamt &to_hamt,
+                               Node::Item &to,
+                               const DiffVisitor &visitor) const;
     outcome::result<void> visit(Node::Item &item, const Visitor &visitor) const;
+    outcome::result<void> visitPrefetch(Node::Item &item,
+                                        const Visitor &visitor,
+                                        boost::asio::thread_pool &pool,
+                                        size_t lookahead) const;
 
     mutable Node::Item root_;
     size_t bit_width_;
@@ -0,0 +1,50 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/hamt/node_cache.hpp"
+
+namespace fc::storage::hamt {
+  NodeCache::NodeCache(size_t max_bytes) : cache_{max_bytes} {
+    budget_ = common::MemoryBudget::instance().add(
+        {"hamt_nodes",
+         1,
+         max_bytes,
+         [this] {
+           std::lock_guard lock{mutex_};
+           return cache_.weight();
+         },
+         [this](size_t limit) {
+           std::lock_guard lock{mutex_};
+           cache_.setMaxWeight(limit);
+         }});
+  }
+
+  NodeCache::NodeCPtr NodeCache::get(const CID &cid) {
+    std::lock_guard lock{mutex_};
+    if (auto node{cache_.get(cid)}) {
+      ++hits_;
+      return *node;
+    }
+    ++misses_;
+    return nullptr;
+  }
+
+  void NodeCache::put(const CID &cid, NodeCPtr node, size_t bytes) {
+    std::lock_guard lock{mutex_};
+    cache_.put(cid, std::move(node), bytes);
+  }
+
+  NodeCache::Stats NodeCache::stats() const {
+    std::lock_guard lock{mutex_};
+    return {hits_, misses_, cache_.size(), cache_.weight(), cache_.maxWeight()};
+  }
+
+  void NodeCache::clear() {
+    std::lock_guard lock{mutex_};
+    cache_.clear();
+    hits_ = 0;
+    misses_ = 0;
+  }
+}  // namespace fc::storage::hamt
@@ -0,0 +1,56 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "common/lru_cache.hpp"
+#include "common/memory_budget.hpp"
+#include "storage/hamt/hamt.hpp"
+
+namespace fc::storage::hamt {
+  /**
+   * Bounded cache of decoded hamt nodes by CID.
+   * Nodes are immutable once flushed, so cache may be shared by different
+   * hamts (e.g. state trees of consecutive tipsets) using same datastore.
+   * Weight of node is its encoded size in bytes.
+   * Cache is limited by memory budget, max bytes is its upper bound.
+   */
+  class NodeCache {
+   public:
+    using NodeCPtr = std::shared_ptr<const Node>;
+
+    struct Stats {
+      size_t hits{};
+      size_t misses{};
+      size_t size{};
+      size_t bytes{};
+      size_t max_bytes{};
+    };
+
+    static constexpr size_t kDefaultMaxBytes{64 << 20};
+
+    explicit NodeCache(size_t max_bytes = kDefaultMaxBytes);
+
+    /// Get decoded node, counts hit or miss
+    NodeCPtr get(const CID &cid);
+
+    /// Remember decoded node with its encoded size
+    void put(const CID &cid, NodeCPtr node, size_t bytes);
+
+    Stats stats() const;
+
+    void clear();
+
+   private:
+    mutable std::mutex mutex_;
+    common::LruCache<CID, NodeCPtr> cache_;
+    size_t hits_{};
+    size_t misses_{};
+    /// Last member, unregistered before cache is destroyed
+    std::unique_ptr<common::MemoryBudget::Registration> budget_;
+  };
+}  // namespace fc::storage::hamt
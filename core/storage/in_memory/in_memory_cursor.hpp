@@ -0,0 +1,60 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <map>
+
+#include "common/buffer.hpp"
+#include "storage/face/map_cursor.hpp"
+
+namespace fc::storage {
+  using fc::common::Buffer;
+
+  /// Cursor over entries of InMemoryStorage, keys are stored as hex
+  class InMemoryCursor : public fc::storage::face::MapCursor<Buffer, Buffer> {
+   public:
+    using Entries = std::map<std::string, Buffer>;
+
+    explicit InMemoryCursor(const Entries &entries)
+        : entries{entries}, it{entries.end()} {}
+
+    void seekToFirst() override {
+      it = entries.begin();
+    }
+
+    void seek(const Buffer &key) override {
+      it = entries.lower_bound(key.toHex());
+    }
+
+    void seekToLast() override {
+      it = entries.empty() ? entries.end() : std::prev(entries.end());
+    }
+
+    bool isValid() const override {
+      return it != entries.end();
+    }
+
+    void next() override {
+      ++it;
+    }
+
+    void prev() override {
+      it = it == entries.begin() ? entries.end() : std::prev(it);
+    }
+
+    Buffer key() const override {
+      return Buffer::fromHex(it->first).value();
+    }
+
+    Buffer value() const override {
+      return it->second;
+    }
+
+   private:
+    const Entries &entries;
+    Entries::const_iterator it;
+  };
+}  // namespace fc::storage
@@ -6,6 +6,7 @@
 #include "storage/in_memory/in_memory_storage.hpp"
 
 #include "storage/in_memory/in_memory_batch.hpp"
+#include "storage/in_memory/in_memory_cursor.hpp"
 
 using fc::common::Buffer;
 
@@ -46,6 +47,6 @@ namespace fc::storage {
 
   std::unique_ptr<fc::storage::face::MapCursor<Buffer, Buffer>>
   InMemoryStorage::cursor() {
-    return nullptr;
+    return std::make_unique<InMemoryCursor>(storage);
   }
 }
@@ -4,13 +4,86 @@
  */
 
 #include "storage/ipfs/api_ipfs_datastore/api_ipfs_datastore.hpp"
+#include "codec/cbor/cbor_decode_stream.hpp"
 #include "storage/ipfs/api_ipfs_datastore/api_ipfs_datastore_error.hpp"
 
 namespace fc::storage::ipfs {
+  using codec::cbor::CborDecodeStream;
 
-  ApiIpfsDatastore::ApiIpfsDatastore(std::shared_ptr<Api> api) : api_{api} {}
+  /**
+   * Links of HAMT node [bits, [{"0": cid} | {"1": leaf}]],
+   * AMT node [bits, [cid], [value]] or AMT root [height, count, node].
+   * Other objects have no links.
+   */
+  std::vector<CID> nodeLinks(const Buffer &bytes) {
+    std::vector<CID> links;
+    try {
+      CborDecodeStream s{bytes};
+      if (!s.isList()) {
+        return {};
+      }
+      auto n{s.listLength()};
+      auto l{s.list()};
+      if (n == 3 && l.isInt()) {
+        l.next();
+        if (!l.isInt()) {
+          return {};
+        }
+        l.next();
+        if (!l.isList() || l.listLength() != 3) {
+          return {};
+        }
+        n = 3;
+        l = l.list();
+      }
+      if ((n != 2 && n != 3) || !l.isBytes()) {
+        return {};
+      }
+      l.next();
+      if (!l.isList()) {
+        return {};
+      }
+      auto n_items{l.listLength()};
+      auto l_items{l.list()};
+      for (; n_items != 0; --n_items) {
+        if (n == 2) {
+          if (!l_items.isMap()) {
+            return {};
+          }
+          auto m_item{l_items.map()};
+          auto it{m_item.find("0")};
+          if (it != m_item.end() && it->second.isCid()) {
+            it->second >> links.emplace_back();
+          }
+        } else {
+          if (!l_items.isCid()) {
+            return {};
+          }
+          l_items >> links.emplace_back();
+        }
+      }
+    } catch (std::system_error &) {
+      return {};
+    }
+    return links;
+  }
+
+  ApiIpfsDatastore::ApiIpfsDatastore(std::shared_ptr<Api> api,
+                                     size_t cache_bytes,
+                                     bool prefetch)
+      : api_{api}, prefetch_{prefetch}, cache_{cache_bytes} {}
 
   outcome::result<bool> ApiIpfsDatastore::contains(const CID &key) const {
+    {
+      std::lock_guard lock{mutex_};
+      if (cache_.contains(key)) {
+        return true;
+      }
+    }
+    if (auto has{api_->ChainHasObj(key)}) {
+      return has.value();
+    }
+    // node without ChainHasObj
     return api_->ChainReadObj(key).has_value();
   }
 
@@ -20,7 +93,41 @@ namespace fc::storage::ipfs {
 
   outcome::result<IpfsDatastore::Value> ApiIpfsDatastore::get(
       const CID &key) const {
-    return api_->ChainReadObj(key);
+    std::promise<outcome::result<Value>> promise;
+    std::shared_future<outcome::result<Value>> other;
+    {
+      std::lock_guard lock{mutex_};
+      if (auto value{cache_.get(key)}) {
+        return std::move(*value);
+      }
+      auto it{inflight_.find(key)};
+      if (it != inflight_.end()) {
+        other = it->second;
+      } else {
+        inflight_.emplace(key, promise.get_future().share());
+      }
+    }
+    if (other.valid()) {
+      return other.get();
+    }
+    auto _value{api_->ChainReadObj(key)};
+    {
+      std::lock_guard lock{mutex_};
+      if (_value) {
+        cache_.put(key, _value.value(), _value.value().size());
+      }
+      inflight_.erase(key);
+    }
+    promise.set_value(_value);
+    OUTCOME_TRY(value, _value);
+    if (prefetch_) {
+      auto links{nodeLinks(value)};
+      if (!links.empty()) {
+        // best effort, children are fetched one by one on failure
+        std::ignore = prefetch(links);
+      }
+    }
+    return std::move(value);
   }
 
   outcome::result<void> ApiIpfsDatastore::remove(const CID &key) {
@@ -31,4 +138,33 @@ namespace fc::storage::ipfs {
     return shared_from_this();
   }
 
+  outcome::result<void> ApiIpfsDatastore::prefetch(
+      const std::vector<CID> &keys) const {
+    std::vector<CID> missing;
+    {
+      std::lock_guard lock{mutex_};
+      for (auto &key : keys) {
+        if (!cache_.contains(key)) {
+          missing.push_back(key);
+        }
+      }
+    }
+    if (missing.empty()) {
+      return outcome::success();
+    }
+    OUTCOME_TRY(values, api_->ChainReadObjs(missing));
+    if (values.size() != missing.size()) {
+      return ApiIpfsDatastoreError::kWrongResponse;
+    }
+    for (auto i{0u}; i < missing.size(); ++i) {
+      cache(missing[i], values[i]);
+    }
+    return outcome::success();
+  }
+
+  void ApiIpfsDatastore::cache(const CID &key, const Value &value) const {
+    std::lock_guard lock{mutex_};
+    cache_.put(key, value, value.size());
+  }
+
 }  // namespace fc::storage::ipfs
@@ -6,24 +6,40 @@
 #ifndef CPP_FILECOIN_STORAGE_IPFS_API_IPFS_DATASTORE_API_IPFS_DATASTORE_HPP
 #define CPP_FILECOIN_STORAGE_IPFS_API_IPFS_DATASTORE_API_IPFS_DATASTORE_HPP
 
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
 #include "api/api.hpp"
+#include "common/lru_cache.hpp"
 #include "storage/ipfs/datastore.hpp"
 
 namespace fc::storage::ipfs {
   using api::Api;
 
   /**
-   * Read-only implementation of IPFS over node API
+   * Read-only implementation of IPFS over node API.
+   * Objects are content-addressed and immutable, so fetched objects are kept
+   * in local cache without invalidation. Children of fetched HAMT and AMT
+   * nodes are prefetched with one batched call, so tree walks don't make
+   * round trip per node.
+   * Concurrent gets of same missing object share one API call.
    */
   class ApiIpfsDatastore
       : public IpfsDatastore,
         public std::enable_shared_from_this<ApiIpfsDatastore> {
    public:
+    static constexpr size_t kDefaultCacheBytes{64 << 20};
+
     /**
      * Construct ApiIpfsDatastore
      * @param api - node API
+     * @param cache_bytes - total size of cached objects
+     * @param prefetch - prefetch children of HAMT and AMT nodes
      */
-    explicit ApiIpfsDatastore(std::shared_ptr<Api> api);
+    explicit ApiIpfsDatastore(std::shared_ptr<Api> api,
+                              size_t cache_bytes = kDefaultCacheBytes,
+                              bool prefetch = true);
 
     outcome::result<bool> contains(const CID &key) const override;
 
@@ -46,8 +62,19 @@ namespace fc::storage::ipfs {
 
     std::shared_ptr<IpfsDatastore> shared() override;
 
+    /// Fetch objects missing in cache with one call
+    outcome::result<void> prefetch(const std::vector<CID> &keys) const;
+
    private:
+    void cache(const CID &key, const Value &value) const;
+
     std::shared_ptr<Api> api_;
+    bool prefetch_;
+    mutable std::mutex mutex_;
+    mutable common::LruCache<CID, Value> cache_;
+    /// Results of API calls in flight, awaited by concurrent gets
+    mutable std::unordered_map<CID, std::shared_future<outcome::result<Value>>>
+        inflight_;
   };
 
 }  // namespace fc::storage::ipfs
@@ -10,6 +10,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::ipfs, ApiIpfsDatastoreError, e) {
   switch (e) {
     case E::kNotSupproted:
       return "ApiIpfsDatastoreError: operation is not supported";
+    case E::kWrongResponse:
+      return "ApiIpfsDatastoreError: wrong number of objects in response";
     default:
       return "ApiIpfsDatastoreError: unknown error";
   }
@@ -12,6 +12,7 @@ namespace fc::storage::ipfs {
 
   enum class ApiIpfsDatastoreError {
     kNotSupproted = 1,
+    kWrongResponse,
   };
 
 }
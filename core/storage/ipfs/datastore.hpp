@@ -16,6 +16,8 @@ namespace fc::storage::ipfs {
   class IpfsDatastore {
    public:
     using Value = common::Buffer;
+    using ValuePtr = std::shared_ptr<const Value>;
+    using Batch = std::vector<std::pair<CID, Value>>;
 
     virtual ~IpfsDatastore() = default;
 
@@ -34,6 +36,19 @@ namespace fc::storage::ipfs {
      */
     virtual outcome::result<void> set(const CID &key, Value value) = 0;
 
+    /**
+     * @brief associates keys with values in one write, atomically if data
+     * store supports it
+     * @param batch keys and values to associate
+     * @return success if operation succeeded, error otherwise
+     */
+    virtual outcome::result<void> setMany(Batch batch) {
+      for (auto &pair : batch) {
+        OUTCOME_TRY(set(pair.first, std::move(pair.second)));
+      }
+      return outcome::success();
+    }
+
     /**
      * @brief searches for a key in data store
      * @param key key to find
@@ -41,6 +56,17 @@ namespace fc::storage::ipfs {
      */
     virtual outcome::result<Value> get(const CID &key) const = 0;
 
+    /**
+     * @brief searches for a key in data store, value may be shared with data
+     * store cache instead of copied
+     * @param key key to find
+     * @return immutable value associated with key or error
+     */
+    virtual outcome::result<ValuePtr> getShared(const CID &key) const {
+      OUTCOME_TRY(value, get(key));
+      return std::make_shared<const Value>(std::move(value));
+    }
+
     /**
      * @brief removes key from data store
      * @param key key to remove
@@ -66,8 +92,8 @@ namespace fc::storage::ipfs {
     /// Get CBOR decoded value by CID
     template <typename T>
     outcome::result<T> getCbor(const CID &key) const {
-      OUTCOME_TRY(bytes, get(key));
-      return decode<T>(bytes);
+      OUTCOME_TRY(bytes, getShared(key));
+      return decode<T>(*bytes);
     }
 
     template <typename T>
@@ -0,0 +1,58 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+
+#include "common/logger.hpp"
+#include "storage/ipfs/datastore.hpp"
+#include "storage/ipfs/graphsync/graphsync.hpp"
+
+namespace fc::storage::ipfs::graphsync {
+  using libp2p::peer::PeerId;
+
+  /**
+   * Stores blocks received by graphsync. All blocks of one message are
+   * written with one setMany, before responses of that message are handled,
+   * so response callbacks can read them. Blocks are moved into batch, not
+   * copied. Block cids are already computed from data by message parser.
+   */
+  class BlockSink {
+   public:
+    struct Progress {
+      uint64_t blocks{};
+      uint64_t bytes{};
+    };
+
+    /// Called after each stored message with progress of peer
+    using OnProgress =
+        std::function<void(const PeerId &peer, const Progress &progress)>;
+
+    explicit BlockSink(IpldPtr ipld, OnProgress on_progress = {});
+
+    /// Sets this sink as blocks handler of graphsync
+    void attach(Graphsync &graphsync);
+
+    /// Writes blocks of one message
+    outcome::result<void> put(const PeerId &from, std::vector<Data> blocks);
+
+    Progress progress(const PeerId &peer) const;
+
+    Progress total() const;
+
+    /// Drops progress of peer, e.g. when transfer is finished
+    void forget(const PeerId &peer);
+
+   private:
+    IpldPtr ipld_;
+    OnProgress on_progress_;
+    mutable std::mutex mutex_;
+    std::unordered_map<PeerId, Progress> progress_;
+    Progress total_;
+    common::Logger logger_;
+  };
+}  // namespace fc::storage::ipfs::graphsync
@@ -114,6 +114,14 @@ namespace fc::storage::ipfs::graphsync {
     /// Subscribes to data
     virtual DataConnection subscribe(std::function<OnDataReceived> handler) = 0;
 
+    /// All blocks of one received message, handler takes ownership
+    using OnBlocksReceived = void(const libp2p::peer::PeerId &from,
+                                  std::vector<Data> blocks);
+
+    /// Sets handler called with blocks of each message after data
+    /// subscribers, before responses of same message are handled
+    virtual void setBlocksHandler(std::function<OnBlocksReceived> handler) = 0;
+
     using RequestHandler = void(FullRequestId id, Request request);
 
     virtual void setDefaultRequestHandler(
@@ -0,0 +1,68 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/graphsync/block_sink.hpp"
+
+namespace fc::storage::ipfs::graphsync {
+  BlockSink::BlockSink(IpldPtr ipld, OnProgress on_progress)
+      : ipld_{std::move(ipld)},
+        on_progress_{std::move(on_progress)},
+        logger_{common::createLogger("graphsync_sink")} {}
+
+  void BlockSink::attach(Graphsync &graphsync) {
+    graphsync.setBlocksHandler([this](auto &from, auto blocks) {
+      auto res{put(from, std::move(blocks))};
+      if (!res) {
+        logger_->error("put blocks from {}: {}",
+                       from.toBase58(),
+                       res.error().message());
+      }
+    });
+  }
+
+  outcome::result<void> BlockSink::put(const PeerId &from,
+                                       std::vector<Data> blocks) {
+    Progress added;
+    IpfsDatastore::Batch batch;
+    batch.reserve(blocks.size());
+    for (auto &block : blocks) {
+      ++added.blocks;
+      added.bytes += block.content.size();
+      batch.emplace_back(std::move(block.cid), std::move(block.content));
+    }
+    OUTCOME_TRY(ipld_->setMany(std::move(batch)));
+
+    Progress progress;
+    {
+      std::lock_guard lock{mutex_};
+      total_.blocks += added.blocks;
+      total_.bytes += added.bytes;
+      auto &peer{progress_[from]};
+      peer.blocks += added.blocks;
+      peer.bytes += added.bytes;
+      progress = peer;
+    }
+    if (on_progress_) {
+      on_progress_(from, progress);
+    }
+    return outcome::success();
+  }
+
+  BlockSink::Progress BlockSink::progress(const PeerId &peer) const {
+    std::lock_guard lock{mutex_};
+    auto it{progress_.find(peer)};
+    return it == progress_.end() ? Progress{} : it->second;
+  }
+
+  BlockSink::Progress BlockSink::total() const {
+    std::lock_guard lock{mutex_};
+    return total_;
+  }
+
+  void BlockSink::forget(const PeerId &peer) {
+    std::lock_guard lock{mutex_};
+    progress_.erase(peer);
+  }
+}  // namespace fc::storage::ipfs::graphsync
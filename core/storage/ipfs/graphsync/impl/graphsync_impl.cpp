@@ -34,6 +34,11 @@ namespace fc::storage::ipfs::graphsync {
     return data_signal_.connect(handler);
   }
 
+  void GraphsyncImpl::setBlocksHandler(
+      std::function<OnBlocksReceived> handler) {
+    blocks_handler_ = std::move(handler);
+  }
+
   void GraphsyncImpl::setDefaultRequestHandler(
       std::function<RequestHandler> handler) {
     assert(handler);
@@ -135,12 +140,20 @@ namespace fc::storage::ipfs::graphsync {
     local_requests_->onResponse(request_id, status, std::move(extensions));
   }
 
-  void GraphsyncImpl::onDataBlock(const PeerId &from, Data data) {
+  void GraphsyncImpl::onDataBlocks(const PeerId &from,
+                                   std::vector<Data> blocks) {
     if (!started_) {
       return;
     }
 
-    data_signal_(from, std::move(data));
+    if (!data_signal_.empty()) {
+      for (const auto &data : blocks) {
+        data_signal_(from, data);
+      }
+    }
+    if (blocks_handler_) {
+      blocks_handler_(from, std::move(blocks));
+    }
   }
 
   void GraphsyncImpl::onRemoteRequest(const PeerId &from,
@@ -38,6 +38,7 @@ namespace fc::storage::ipfs::graphsync {
 
     // Graphsync interface overrides
     DataConnection subscribe(std::function<OnDataReceived> handler) override;
+    void setBlocksHandler(std::function<OnBlocksReceived> handler) override;
     void setDefaultRequestHandler(
         std::function<RequestHandler> handler) override;
     void setRequestHandler(std::function<RequestHandler> handler,
@@ -59,7 +60,7 @@ namespace fc::storage::ipfs::graphsync {
                     RequestId request_id,
                     ResponseStatusCode status,
                     std::vector<Extension> extensions) override;
-    void onDataBlock(const PeerId &from, Data data) override;
+    void onDataBlocks(const PeerId &from, std::vector<Data> blocks) override;
     void onRemoteRequest(const PeerId &from, Message::Request request) override;
 
     /// NVI for stop()
@@ -80,6 +81,9 @@ namespace fc::storage::ipfs::graphsync {
     /// Subscriptions to data to blocks
     boost::signals2::signal<OnDataReceived> data_signal_;
 
+    /// Owner of received blocks, e.g. BlockSink
+    std::function<OnBlocksReceived> blocks_handler_;
+
     /// Flag, indicates that instance is started
     bool started_ = false;
   };
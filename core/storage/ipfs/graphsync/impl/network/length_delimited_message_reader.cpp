@@ -107,7 +107,7 @@ namespace fc::storage::ipfs::graphsync {
       return feedback_(stream_, Error::kMessageReadError);
     }
 
-    feedback_(stream_, std::move(*buffer_));
+    feedback_(stream_, gsl::make_span(*buffer_));
 
     // if owner called close() during feedback then the stream is now reset
     // and no further reading is needed
@@ -25,9 +25,12 @@ namespace fc::storage::ipfs::graphsync {
     LengthDelimitedMessageReader &operator=(
         const LengthDelimitedMessageReader &) = delete;
 
-    /// Feedback interface from reader to its owning object
-    using Feedback = std::function<void(const StreamPtr &stream,
-                                        outcome::result<ByteArray>)>;
+    /// Feedback interface from reader to its owning object.
+    /// Message bytes are valid only during the call, buffer is reused for
+    /// next message
+    using Feedback =
+        std::function<void(const StreamPtr &stream,
+                           outcome::result<gsl::span<const uint8_t>>)>;
 
     /// Ctor.
     /// \param feedback Owner's callback
@@ -64,7 +67,7 @@ namespace fc::storage::ipfs::graphsync {
     /// Max message size in bytes
     const size_t max_message_size_;
 
-    /// Internal buffer for async reads
+    /// Internal buffer for async reads, reused by messages of stream
     std::shared_ptr<ByteArray> buffer_;
 
     /// Internal flag, decouples shared ptr from dependent objects
@@ -5,6 +5,12 @@
 
 #include "message_parser.hpp"
 
+#include <boost/asio/post.hpp>
+#include <atomic>
+#include <boost/asio/thread_pool.hpp>
+#include <future>
+#include <thread>
+
 #include "codec/cbor/cbor_decode_stream.hpp"
 #include "common/span.hpp"
 #include "crypto/hasher/hasher.hpp"
@@ -65,7 +71,7 @@ namespace fc::storage::ipfs::graphsync {
 
             for (const auto &[k, v] : src.extensions()) {
               std::vector<uint8_t> data(v.begin(), v.end());
-              dst.extensions.emplace_back(Extension{k, data});
+              dst.extensions.emplace_back(Extension{k, std::move(data)});
             }
           }
         }
@@ -87,13 +93,57 @@ namespace fc::storage::ipfs::graphsync {
 
           for (const auto &[k, v] : src.extensions()) {
             std::vector<uint8_t> data(v.begin(), v.end());
-            dst.extensions.emplace_back(Extension{k, data});
+            dst.extensions.emplace_back(Extension{k, std::move(data)});
           }
         }
       }
       return outcome::success();
     }
 
+    // Blocks of message are hashed in parallel from this total size
+    constexpr size_t kParallelHashBytes = 1 << 20;
+
+    void hashBlock(std::pair<CID, common::Buffer> &block) {
+      block.first.content_address = crypto::Hasher::calculate(
+          block.first.content_address.getType(), block.second);
+    }
+
+    // Computes cids of blocks, big messages on shared thread pool
+    void hashBlocks(std::vector<std::pair<CID, common::Buffer>> &blocks) {
+      size_t bytes = 0;
+      for (auto &block : blocks) {
+        bytes += block.second.size();
+      }
+      static const size_t threads =
+          std::max(1u, std::thread::hardware_concurrency());
+      if (bytes < kParallelHashBytes || blocks.size() < 2 || threads < 2) {
+        for (auto &block : blocks) {
+          hashBlock(block);
+        }
+        return;
+      }
+
+      static boost::asio::thread_pool pool{threads};
+      std::atomic_size_t next{0};
+      auto work = [&] {
+        for (size_t i; (i = next++) < blocks.size();) {
+          hashBlock(blocks[i]);
+        }
+      };
+      auto helpers = std::min(threads, blocks.size()) - 1;
+      std::vector<std::future<void>> done;
+      done.reserve(helpers);
+      for (size_t i = 0; i < helpers; ++i) {
+        auto task = std::make_shared<std::packaged_task<void()>>(work);
+        done.push_back(task->get_future());
+        boost::asio::post(pool, [task] { (*task)(); });
+      }
+      work();
+      for (auto &future : done) {
+        future.wait();
+      }
+    }
+
     // Extracts data blocks from protobuf message
     outcome::result<void> parseBlocks(pb::Message &pb_msg, Message &msg) {
       size_t sz = pb_msg.data_size();
@@ -101,16 +151,14 @@ namespace fc::storage::ipfs::graphsync {
         msg.data.reserve(sz);
 
         for (auto &src : pb_msg.data()) {
-          auto data = fromString(src.data());
           auto prefix_reader = common::span::cbytes(src.prefix());
           OUTCOME_TRY(cid, CID::read(prefix_reader, true));
           if (!prefix_reader.empty()) {
             return Error::kMessageParseError;
           }
-          cid.content_address =
-              crypto::Hasher::calculate(cid.content_address.getType(), data);
-          msg.data.emplace_back(std::move(cid), data);
+          msg.data.emplace_back(std::move(cid), fromString(src.data()));
         }
+        hashBlocks(msg.data);
       }
       return outcome::success();
     }
@@ -118,7 +166,9 @@ namespace fc::storage::ipfs::graphsync {
   }  // namespace
 
   outcome::result<Message> parseMessage(gsl::span<const uint8_t> bytes) {
-    pb::Message pb_msg;
+    // parsing clears message, but keeps its strings and repeated fields
+    // allocated for next messages parsed by thread
+    thread_local pb::Message pb_msg;
 
     if (!pb_msg.ParseFromArray(bytes.data(), bytes.size())) {
       logger()->warn("{}: cannot parse protobuf message, size={}",
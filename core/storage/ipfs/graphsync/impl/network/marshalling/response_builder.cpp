@@ -34,6 +34,9 @@ namespace fc::storage::ipfs::graphsync {
       insertExtension(extension.name, extension.data);
     }
 
+    // metadata describes blocks added for this response only
+    meta_.clear();
+
     empty_ = false;
   }
 
@@ -15,7 +15,8 @@ namespace fc::storage::ipfs::graphsync {
   /// Collects response entries and serializes them to wire protocol
   class ResponseBuilder : public MessageBuilder {
    public:
-    /// Adds response to protobuf message
+    /// Adds response to protobuf message, with metadata of blocks added since
+    /// previous response
     /// \param request_id id of request
     /// \param status status code
     /// \param extensions - data for protocol extensions
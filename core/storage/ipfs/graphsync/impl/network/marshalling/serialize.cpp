@@ -9,6 +9,8 @@
 
 #include "serialize.hpp"
 
+#include "common/buffer_pool.hpp"
+
 namespace fc::storage::ipfs::graphsync {
 
   boost::optional<std::shared_ptr<const libp2p::common::ByteArray>>
@@ -19,19 +21,18 @@ namespace fc::storage::ipfs::graphsync {
     const auto &varint_vec = varint_len.toVector();
     size_t prefix_sz = varint_vec.size();
 
-    auto buffer =
-        std::make_shared<const libp2p::common::ByteArray>(prefix_sz + msg_sz);
-
-    // NOLINTNEXTLINE
-    uint8_t *data = const_cast<uint8_t *>(buffer->data());
+    // frames are released to pool after they are written
+    auto &pool{common::BufferPool::instance()};
+    auto buffer{pool.acquire(prefix_sz + msg_sz)};
 
-    memcpy(data, varint_vec.data(), prefix_sz);
+    memcpy(buffer.data(), varint_vec.data(), prefix_sz);
 
     // NOLINTNEXTLINE
-    if (!msg.SerializeToArray(data + prefix_sz, msg_sz)) {
+    if (!msg.SerializeToArray(buffer.data() + prefix_sz, msg_sz)) {
+      pool.release(std::move(buffer));
       return boost::none;
     }
-    return buffer;
+    return pool.share(std::move(buffer));
   }
 
 }  // namespace fc::storage::ipfs::graphsync
@@ -9,6 +9,8 @@
 
 #include <cassert>
 
+#include "common/metrics.hpp"
+
 namespace fc::storage::ipfs::graphsync {
 
   MessageQueue::MessageQueue(StreamPtr stream, FeedbackFn feedback)
@@ -106,6 +108,12 @@ namespace fc::storage::ipfs::graphsync {
     }
 
     state_.total_bytes_written += n;
+    static auto &messages{common::metrics::counter(
+        "fc_graphsync_sent_messages_total", "Graphsync messages written")};
+    static auto &bytes{common::metrics::counter(
+        "fc_graphsync_sent_bytes_total", "Graphsync message bytes written")};
+    messages.inc();
+    bytes.inc(n);
 
     dequeue();
 
@@ -22,8 +22,9 @@ namespace fc::storage::ipfs::graphsync {
 
     if (!stream_reader_) {
       stream_reader_ = std::make_shared<LengthDelimitedMessageReader>(
-          [this](const StreamPtr &stream, outcome::result<ByteArray> res) {
-            onMessageRead(stream, std::move(res));
+          [this](const StreamPtr &stream,
+                 outcome::result<gsl::span<const uint8_t>> res) {
+            onMessageRead(stream, res);
           },
           kMaxMessageSize);
     }
@@ -36,8 +37,8 @@ namespace fc::storage::ipfs::graphsync {
     stream_reader_->close();
   }
 
-  void MessageReader::onMessageRead(const StreamPtr &stream,
-                                    outcome::result<ByteArray> res) {
+  void MessageReader::onMessageRead(
+      const StreamPtr &stream, outcome::result<gsl::span<const uint8_t>> res) {
     if (!res) {
       return feedback_.onReaderEvent(stream, res.error());
     }
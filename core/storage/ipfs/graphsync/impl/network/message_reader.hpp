@@ -29,7 +29,8 @@ namespace fc::storage::ipfs::graphsync {
     /// Callback for async length delimited read operations
     /// \param stream
     /// \param res
-    void onMessageRead(const StreamPtr &stream, outcome::result<ByteArray> res);
+    void onMessageRead(const StreamPtr &stream,
+                       outcome::result<gsl::span<const uint8_t>> res);
 
     /// Owner's feedback interface
     EndpointToPeerFeedback &feedback_;
@@ -38,10 +38,10 @@ namespace fc::storage::ipfs::graphsync {
    public:
     virtual ~PeerToGraphsyncFeedback() = default;
 
-    /// Called on new block from the network
+    /// Called on blocks of new message from the network
     /// \param from originating peer ID
-    /// \param data block data, raw bytes
-    virtual void onDataBlock(const PeerId &from, Data data) = 0;
+    /// \param blocks blocks of message
+    virtual void onDataBlocks(const PeerId &from, std::vector<Data> blocks) = 0;
 
     /// Called on new request from the network
     /// \param from originating peer ID
@@ -103,6 +103,9 @@ namespace fc::storage::ipfs::graphsync {
   /// Max byte size of pending message queue
   constexpr size_t kMaxPendingBytes = 64 * 1024 * 1024;
 
+  /// Byte size up to which queued response blocks are batched into message
+  constexpr size_t kResponseBatchBytes = 1024 * 1024;
+
   /// Cleanup delay for PeerContext, msec
   constexpr unsigned kPeerCloseDelayMsec = 30000;
 
@@ -5,13 +5,35 @@
 
 #include "outbound_endpoint.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 #include "message_queue.hpp"
 
 namespace fc::storage::ipfs::graphsync {
 
-  OutboundEndpoint::OutboundEndpoint() : max_pending_bytes_(kMaxPendingBytes) {}
+  namespace {
+    size_t responseBytes(const Response &response) {
+      size_t bytes = 0;
+      for (const auto &block : response.data) {
+        bytes += block.content.size();
+      }
+      for (const auto &extension : response.extensions) {
+        bytes += extension.data.size();
+      }
+      return bytes;
+    }
+
+    /// Next part may be merged into same response entry of message
+    bool canMerge(const Response &merged) {
+      return merged.status == RS_PARTIAL_RESPONSE
+             && merged.extensions.empty();
+    }
+  }  // namespace
+
+  OutboundEndpoint::OutboundEndpoint(size_t batch_bytes, size_t window_bytes)
+      : batch_bytes_(std::min(batch_bytes, kMaxMessageSize / 4)),
+        max_pending_bytes_(window_bytes) {}
 
   void OutboundEndpoint::onConnected(std::shared_ptr<MessageQueue> queue) {
     queue_ = std::move(queue);
@@ -26,6 +48,11 @@ namespace fc::storage::ipfs::graphsync {
 
     pending_bytes_ = 0;
     pending_buffers_.clear();
+
+    auto res = flushResponses();
+    if (!res) {
+      logger()->error("flushResponses: {}", res.error().message());
+    }
   }
 
   StreamPtr OutboundEndpoint::getStream() const {
@@ -63,36 +90,112 @@ namespace fc::storage::ipfs::graphsync {
 
   outcome::result<void> OutboundEndpoint::sendResponse(
       const FullRequestId &id, const Response &response) {
-    for (const auto &block : response.data) {
-      OUTCOME_TRY(addBlockToResponse(id, block.cid, block.content));
+    size_t pending_bytes =
+        queue_ ? queue_->getState().pending_bytes : pending_bytes_;
+    auto bytes = responseBytes(response);
+    if (pending_bytes + response_bytes_ + bytes > max_pending_bytes_) {
+      return Error::kWriteQueueOverflow;
+    }
+    queueResponse(id.id, response);
+    return flushResponses();
+  }
+
+  void OutboundEndpoint::queueResponse(RequestId request_id,
+                                       Response response) {
+    auto &queue = responses_[request_id];
+    if (queue.empty()) {
+      response_order_.push_back(request_id);
+    }
+    response_bytes_ += responseBytes(response);
+
+    // big responses are split, so they don't delay other requests
+    size_t bytes = 0;
+    Response part{RS_PARTIAL_RESPONSE, {}, {}};
+    for (auto &block : response.data) {
+      if (!part.data.empty()
+          && bytes + block.content.size() > batch_bytes_) {
+        queue.push_back(std::move(part));
+        part = Response{RS_PARTIAL_RESPONSE, {}, {}};
+        bytes = 0;
+      }
+      bytes += block.content.size();
+      part.data.push_back(std::move(block));
+    }
+    part.status = response.status;
+    part.extensions = std::move(response.extensions);
+    queue.push_back(std::move(part));
+  }
+
+  outcome::result<void> OutboundEndpoint::flushResponses() {
+    if (!queue_ || queue_->getState().writing_bytes != 0
+        || response_order_.empty()) {
+      return outcome::success();
+    }
+
+    // each request with queued responses gets share of message, one part at
+    // least, and goes to the back of order when its turn ends
+    auto quantum = std::max<size_t>(batch_bytes_ / response_order_.size(), 1);
+    size_t message_bytes = 0;
+    size_t turns = response_order_.size();
+    for (size_t turn = 0; turn < turns && message_bytes < batch_bytes_;
+         ++turn) {
+      auto request_id = response_order_.front();
+      response_order_.pop_front();
+      auto &queue = responses_[request_id];
+
+      size_t turn_bytes = 0;
+      Response merged{RS_PARTIAL_RESPONSE, {}, {}};
+      while (!queue.empty() && canMerge(merged) && turn_bytes < quantum) {
+        auto &part = queue.front();
+        auto bytes = responseBytes(part);
+        turn_bytes += bytes;
+        response_bytes_ -= bytes;
+        for (const auto &block : part.data) {
+          response_builder_.addDataBlock(block.cid, block.content);
+        }
+        merged.status = part.status;
+        merged.extensions = std::move(part.extensions);
+        queue.pop_front();
+      }
+      response_builder_.addResponse(
+          request_id, merged.status, merged.extensions);
+      message_bytes += turn_bytes;
+
+      if (queue.empty()) {
+        responses_.erase(request_id);
+      } else {
+        response_order_.push_back(request_id);
+      }
     }
 
-    response_builder_.addResponse(id.id, response.status, response.extensions);
     auto res = response_builder_.serialize();
     response_builder_.clear();
     if (!res) {
       return res.error();
     }
-
-    return enqueue(std::move(res.value()));
+    queue_->enqueue(std::move(res.value()));
+    return outcome::success();
   }
 
-  outcome::result<void> OutboundEndpoint::addBlockToResponse(
-      const FullRequestId &request_id,
-      const CID &cid,
-      const common::Buffer &data) {
-    auto serialized_size = response_builder_.getSerializedSize();
-
-    if (serialized_size + data.size() > kMaxMessageSize) {
-      static const Response partial{RS_PARTIAL_CONTENT, {}, {}};
-      OUTCOME_TRY(sendResponse(request_id, partial));
+  void OutboundEndpoint::cancelResponses(RequestId request_id) {
+    auto it = responses_.find(request_id);
+    if (it == responses_.end()) {
+      return;
     }
-
-    response_builder_.addDataBlock(cid, data);
-    return outcome::success();
+    for (const auto &part : it->second) {
+      response_bytes_ -= responseBytes(part);
+    }
+    responses_.erase(it);
+    response_order_.erase(std::remove(response_order_.begin(),
+                                      response_order_.end(),
+                                      request_id),
+                          response_order_.end());
   }
 
   void OutboundEndpoint::clearPendingMessages() {
+    responses_.clear();
+    response_order_.clear();
+    response_bytes_ = 0;
     if (queue_) {
       queue_->clear();
     } else {
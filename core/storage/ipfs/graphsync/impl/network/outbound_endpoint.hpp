@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_GRAPHSYNC_OUTBOUND_ENDPOINT_HPP
 #define CPP_FILECOIN_GRAPHSYNC_OUTBOUND_ENDPOINT_HPP
 
+#include <map>
+
 #include "marshalling/response_builder.hpp"
 #include "network_fwd.hpp"
 
@@ -20,7 +22,10 @@ namespace fc::storage::ipfs::graphsync {
     OutboundEndpoint &operator=(const OutboundEndpoint &) = delete;
 
     /// Ctor.
-    OutboundEndpoint();
+    /// \param batch_bytes size to which response blocks are batched
+    /// \param window_bytes max bytes of queued messages and responses
+    explicit OutboundEndpoint(size_t batch_bytes = kResponseBatchBytes,
+                              size_t window_bytes = kMaxPendingBytes);
 
     /// Called by owner (PeerContext) when stream connected
     /// \param queue Message queue, a dependency
@@ -37,21 +42,36 @@ namespace fc::storage::ipfs::graphsync {
     /// \return Enqueue result (the queue can be overflown)
     outcome::result<void> enqueue(SharedData msg);
 
-    /// Sends response via message queue
+    /// Queues response. Responses are sent when previous message is written,
+    /// blocks of queued responses are batched into messages
     outcome::result<void> sendResponse(
         const FullRequestId &id, const Response &response);
 
+    /// Sends next batch of queued responses if no message is being written.
+    /// Called by owner when write completes
+    outcome::result<void> flushResponses();
+
+    /// Drops queued responses of cancelled request
+    void cancelResponses(RequestId request_id);
+
     /// Clears all pending messages
     void clearPendingMessages();
 
    private:
-    /// Adds data block to response. Doesn't send unless sending partial
-    /// response is needed
-    /// \param cid CID of data block
-    /// \param data Raw data
-    outcome::result<void> addBlockToResponse(const FullRequestId &request_id,
-                                             const CID &cid,
-                                             const common::Buffer &data);
+    /// Queues response split into parts not larger than batch
+    void queueResponse(RequestId request_id, Response response);
+
+    /// Response parts queued by request
+    std::map<RequestId, std::deque<Response>> responses_;
+
+    /// Requests with queued responses, served round-robin
+    std::deque<RequestId> response_order_;
+
+    /// Total bytes of queued responses
+    size_t response_bytes_ = 0;
+
+    /// Max bytes of blocks in one message
+    const size_t batch_bytes_;
 
     /// Temporary queue for not yet connected endpoint
     std::deque<SharedData> pending_buffers_;
@@ -42,7 +42,7 @@ namespace fc::storage::ipfs::graphsync {
 
   // Need to define it here due to unique_ptrs to incomplete types in the header
   PeerContext::~PeerContext() {
-    logger()->trace("~PeerContext, {}", str);
+    FC_LOG_TRACE(logger(), "~PeerContext, {}", str);
     // must be closed
     if (!closed_) {
       close(RS_INTERNAL_ERROR);
@@ -79,10 +79,11 @@ namespace fc::storage::ipfs::graphsync {
     if (!outbound_endpoint_) {
       outbound_endpoint_ = std::make_unique<OutboundEndpoint>();
 
-      logger()->trace("connecting to {}, {}",
-                      str,
-                      connect_to_ ? connect_to_->getStringAddress()
-                                  : "existing connection");
+      FC_LOG_TRACE(logger(),
+                   "connecting to {}, {}",
+                   str,
+                   connect_to_ ? connect_to_->getStringAddress()
+                               : "existing connection");
 
       libp2p::peer::PeerInfo pi{peer, {}};
       if (connect_to_) {
@@ -111,7 +112,7 @@ namespace fc::storage::ipfs::graphsync {
       return;
     }
     if (rstream) {
-      logger()->debug("connected to peer={}", str);
+      FC_LOG_DEBUG(logger(), "connected to peer={}", str);
       onNewStream(std::move(rstream.value()), true);
     } else {
       logger()->info(
@@ -224,7 +225,10 @@ namespace fc::storage::ipfs::graphsync {
       return;
     }
 
-    logger()->debug("close peer={} status={}", str, statusCodeToString(status));
+    FC_LOG_DEBUG(logger(),
+                 "close peer={} status={}",
+                 str,
+                 statusCodeToString(status));
 
     close_status_ = status;
     closed_ = true;
@@ -252,7 +256,7 @@ namespace fc::storage::ipfs::graphsync {
       return;
     }
 
-    logger()->trace("closeStream: peer={}", str);
+    FC_LOG_TRACE(logger(), "closeStream: peer={}", str);
 
     streams_.erase(it);
 
@@ -262,7 +266,9 @@ namespace fc::storage::ipfs::graphsync {
     }
 
     stream->close(
-        [stream](outcome::result<void>) { logger()->trace("stream closed"); });
+        [stream](outcome::result<void>) {
+          FC_LOG_TRACE(logger(), "stream closed");
+        });
   }
 
   void PeerContext::closeLocalRequests(ResponseStatusCode status) {
@@ -299,16 +305,23 @@ namespace fc::storage::ipfs::graphsync {
 
     if (request.cancel) {
       remote_request_ids_.erase(request.id);
-      logger()->debug(
-          "onRequest: peer {} cancelled request {}", str, request.id);
+      if (outbound_endpoint_) {
+        outbound_endpoint_->cancelResponses(request.id);
+      }
+      FC_LOG_DEBUG(logger(),
+                   "onRequest: peer {} cancelled request {}",
+                   str,
+                   request.id);
     } else {
       if (remote_request_ids_.count(request.id)) {
         sendResponse(FullRequestId{peer, request.id},
                      Response{RS_REJECTED, {}, {}});
       } else {
         remote_request_ids_.emplace(request.id);
-        logger()->debug(
-            "onRequest: peer {} created request {}", str, request.id);
+        FC_LOG_DEBUG(logger(),
+                     "onRequest: peer {} created request {}",
+                     str,
+                     request.id);
         graphsync_feedback_.onRemoteRequest(peer, std::move(request));
       }
     }
@@ -329,12 +342,12 @@ namespace fc::storage::ipfs::graphsync {
 
     Message &msg = msg_res.value();
 
-    logger()->trace(
-        "message from peer={}, {} blocks, {} requests, {} responses",
-        str,
-        msg.data.size(),
-        msg.requests.size(),
-        msg.responses.size());
+    FC_LOG_TRACE(logger(),
+                 "message from peer={}, {} blocks, {} requests, {} responses",
+                 str,
+                 msg.data.size(),
+                 msg.requests.size(),
+                 msg.responses.size());
 
     if (msg.complete_request_list) {
       // this cancels previous requests
@@ -345,9 +358,13 @@ namespace fc::storage::ipfs::graphsync {
       onRequest(stream, item);
     }
 
-    for (auto &item : msg.data) {
-      graphsync_feedback_.onDataBlock(
-          peer, {std::move(item.first), std::move(item.second)});
+    if (!msg.data.empty()) {
+      std::vector<Data> blocks;
+      blocks.reserve(msg.data.size());
+      for (auto &item : msg.data) {
+        blocks.push_back({std::move(item.first), std::move(item.second)});
+      }
+      graphsync_feedback_.onDataBlocks(peer, std::move(blocks));
     }
 
     for (auto &item : msg.responses) {
@@ -371,6 +388,15 @@ namespace fc::storage::ipfs::graphsync {
     }
 
     shiftExpireTime(stream);
+
+    if (outbound_endpoint_ && outbound_endpoint_->getStream() == stream) {
+      auto res = outbound_endpoint_->flushResponses();
+      if (!res) {
+        logger()->error(
+            "flushResponses: {}, peer={}", res.error().message(), str);
+        close(RS_INTERNAL_ERROR);
+      }
+    }
   }
 
   void PeerContext::shiftExpireTime(const StreamPtr &stream) {
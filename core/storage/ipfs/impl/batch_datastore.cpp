@@ -0,0 +1,60 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/batch_datastore.hpp"
+
+namespace fc::storage::ipfs {
+  BatchDatastore::BatchDatastore(IpldPtr ipld) : ipld_{std::move(ipld)} {}
+
+  outcome::result<bool> BatchDatastore::contains(const CID &key) const {
+    if (pending_.find(key) != pending_.end()) {
+      return true;
+    }
+    return ipld_->contains(key);
+  }
+
+  outcome::result<void> BatchDatastore::set(const CID &key, Value value) {
+    pending_[key] = std::move(value);
+    return outcome::success();
+  }
+
+  outcome::result<void> BatchDatastore::setMany(Batch batch) {
+    for (auto &pair : batch) {
+      pending_[pair.first] = std::move(pair.second);
+    }
+    return outcome::success();
+  }
+
+  outcome::result<BatchDatastore::Value> BatchDatastore::get(
+      const CID &key) const {
+    auto it{pending_.find(key)};
+    if (it != pending_.end()) {
+      return it->second;
+    }
+    return ipld_->get(key);
+  }
+
+  outcome::result<void> BatchDatastore::remove(const CID &key) {
+    pending_.erase(key);
+    return ipld_->remove(key);
+  }
+
+  outcome::result<void> BatchDatastore::commit() {
+    if (pending_.empty()) {
+      return outcome::success();
+    }
+    Batch batch;
+    batch.reserve(pending_.size());
+    for (auto &pair : pending_) {
+      batch.emplace_back(pair.first, std::move(pair.second));
+    }
+    pending_.clear();
+    return ipld_->setMany(std::move(batch));
+  }
+
+  void BatchDatastore::discard() {
+    pending_.clear();
+  }
+}  // namespace fc::storage::ipfs
@@ -0,0 +1,49 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <map>
+
+#include "storage/ipfs/datastore.hpp"
+
+namespace fc::storage::ipfs {
+  /**
+   * Buffers writes in memory and commits them to underlying datastore with
+   * one setMany. Buffered values are visible through this datastore before
+   * commit, uncommitted values are dropped on destruction.
+   * Not thread-safe.
+   */
+  class BatchDatastore : public IpfsDatastore,
+                         public std::enable_shared_from_this<BatchDatastore> {
+   public:
+    explicit BatchDatastore(IpldPtr ipld);
+
+    outcome::result<bool> contains(const CID &key) const override;
+
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    outcome::result<void> setMany(Batch batch) override;
+
+    outcome::result<Value> get(const CID &key) const override;
+
+    /// Drops buffered value and removes key from underlying datastore
+    outcome::result<void> remove(const CID &key) override;
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+    /// Write buffered values to underlying datastore
+    outcome::result<void> commit();
+
+    /// Drop buffered values without writing them
+    void discard();
+
+   private:
+    IpldPtr ipld_;
+    std::map<CID, Value> pending_;
+  };
+}  // namespace fc::storage::ipfs
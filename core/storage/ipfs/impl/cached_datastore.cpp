@@ -0,0 +1,102 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/cached_datastore.hpp"
+
+namespace fc::storage::ipfs {
+  CachedDatastore::CachedDatastore(IpldPtr ipld, size_t max_bytes)
+      : ipld_{std::move(ipld)},
+        probation_{max_bytes * kProbationPercent / 100},
+        protected_{max_bytes - max_bytes * kProbationPercent / 100} {
+    budget_ = common::MemoryBudget::instance().add(
+        {"ipld_blocks",
+         2,
+         max_bytes,
+         [this] {
+           std::lock_guard lock{mutex_};
+           return probation_.weight() + protected_.weight();
+         },
+         [this](size_t limit) {
+           std::lock_guard lock{mutex_};
+           probation_.setMaxWeight(limit * kProbationPercent / 100);
+           protected_.setMaxWeight(limit - limit * kProbationPercent / 100);
+         }});
+  }
+
+  outcome::result<bool> CachedDatastore::contains(const CID &key) const {
+    {
+      std::lock_guard lock{mutex_};
+      if (protected_.contains(key) || probation_.contains(key)) {
+        return true;
+      }
+    }
+    return ipld_->contains(key);
+  }
+
+  outcome::result<void> CachedDatastore::set(const CID &key, Value value) {
+    put(key, std::make_shared<const Value>(value));
+    return ipld_->set(key, std::move(value));
+  }
+
+  outcome::result<void> CachedDatastore::setMany(Batch batch) {
+    for (auto &pair : batch) {
+      put(pair.first, std::make_shared<const Value>(pair.second));
+    }
+    return ipld_->setMany(std::move(batch));
+  }
+
+  outcome::result<CachedDatastore::Value> CachedDatastore::get(
+      const CID &key) const {
+    OUTCOME_TRY(value, getShared(key));
+    return *value;
+  }
+
+  outcome::result<CachedDatastore::ValuePtr> CachedDatastore::getShared(
+      const CID &key) const {
+    {
+      std::lock_guard lock{mutex_};
+      if (auto value{protected_.get(key)}) {
+        ++hits_;
+        return std::move(*value);
+      }
+      if (auto value{probation_.get(key)}) {
+        ++hits_;
+        probation_.erase(key);
+        protected_.put(key, *value, (*value)->size());
+        return std::move(*value);
+      }
+      ++misses_;
+    }
+    OUTCOME_TRY(value, ipld_->getShared(key));
+    put(key, value);
+    return std::move(value);
+  }
+
+  outcome::result<void> CachedDatastore::remove(const CID &key) {
+    {
+      std::lock_guard lock{mutex_};
+      probation_.erase(key);
+      protected_.erase(key);
+    }
+    return ipld_->remove(key);
+  }
+
+  CachedDatastore::Stats CachedDatastore::stats() const {
+    std::lock_guard lock{mutex_};
+    return {hits_,
+            misses_,
+            probation_.size() + protected_.size(),
+            probation_.weight() + protected_.weight(),
+            probation_.maxWeight() + protected_.maxWeight()};
+  }
+
+  void CachedDatastore::put(const CID &key, ValuePtr value) const {
+    std::lock_guard lock{mutex_};
+    if (!protected_.contains(key)) {
+      auto size{value->size()};
+      probation_.put(key, std::move(value), size);
+    }
+  }
+}  // namespace fc::storage::ipfs
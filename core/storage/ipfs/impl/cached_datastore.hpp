@@ -0,0 +1,74 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "common/lru_cache.hpp"
+#include "common/memory_budget.hpp"
+#include "storage/ipfs/datastore.hpp"
+
+namespace fc::storage::ipfs {
+  /**
+   * Datastore with bounded in-memory tier of recently read and written
+   * blocks in front of underlying (e.g. leveldb) datastore.
+   * Writes go through to underlying datastore.
+   * Eviction is 2Q: new blocks enter probation tier, blocks read again are
+   * promoted to protected tier, so one-time scans do not evict hot blocks.
+   * Memory tier is limited by memory budget, max bytes is its upper bound.
+   */
+  class CachedDatastore
+      : public IpfsDatastore,
+        public std::enable_shared_from_this<CachedDatastore> {
+   public:
+    struct Stats {
+      size_t hits{};
+      size_t misses{};
+      size_t size{};
+      size_t bytes{};
+      size_t max_bytes{};
+    };
+
+    static constexpr size_t kDefaultMaxBytes{256 << 20};
+    /// Part of bytes limit used by probation tier, in percents
+    static constexpr size_t kProbationPercent{25};
+
+    explicit CachedDatastore(IpldPtr ipld,
+                             size_t max_bytes = kDefaultMaxBytes);
+
+    outcome::result<bool> contains(const CID &key) const override;
+
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    outcome::result<void> setMany(Batch batch) override;
+
+    outcome::result<Value> get(const CID &key) const override;
+
+    /// Shares value with memory tier without copy
+    outcome::result<ValuePtr> getShared(const CID &key) const override;
+
+    outcome::result<void> remove(const CID &key) override;
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+    /// Get hits and misses of get, and memory tier size
+    Stats stats() const;
+
+   private:
+    void put(const CID &key, ValuePtr value) const;
+
+    IpldPtr ipld_;
+    mutable std::mutex mutex_;
+    mutable common::LruCache<CID, ValuePtr> probation_;
+    mutable common::LruCache<CID, ValuePtr> protected_;
+    mutable size_t hits_{};
+    mutable size_t misses_{};
+    /// Last member, unregistered before cache is destroyed
+    std::unique_ptr<common::MemoryBudget::Registration> budget_;
+  };
+}  // namespace fc::storage::ipfs
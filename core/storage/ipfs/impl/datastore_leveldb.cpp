@@ -20,7 +20,8 @@ namespace fc::storage::ipfs {
     }
   }  // namespace
 
-  LeveldbDatastore::LeveldbDatastore(std::shared_ptr<BufferMap> leveldb)
+  LeveldbDatastore::LeveldbDatastore(
+      std::shared_ptr<PersistentBufferMap> leveldb)
       : leveldb_{std::move(leveldb)} {
     BOOST_ASSERT_MSG(leveldb_ != nullptr, "leveldb argument is nullptr");
   }
@@ -32,6 +33,15 @@ namespace fc::storage::ipfs {
     return std::make_shared<LeveldbDatastore>(std::move(leveldb));
   }
 
+  outcome::result<std::shared_ptr<LeveldbDatastore>> LeveldbDatastore::create(
+      std::string_view leveldb_directory,
+      leveldb::Options options,
+      const LevelDB::Tuning &tuning) {
+    OUTCOME_TRY(leveldb, LevelDB::create(leveldb_directory, options, tuning));
+
+    return std::make_shared<LeveldbDatastore>(std::move(leveldb));
+  }
+
   outcome::result<bool> LeveldbDatastore::contains(const CID &key) const {
     OUTCOME_TRY(encoded_key, encodeKey(key));
     return leveldb_->contains(encoded_key);
@@ -43,6 +53,15 @@ namespace fc::storage::ipfs {
     return leveldb_->put(encoded_key, common::Buffer(std::move(value)));
   }
 
+  outcome::result<void> LeveldbDatastore::setMany(Batch batch) {
+    auto write_batch = leveldb_->batch();
+    for (auto &pair : batch) {
+      OUTCOME_TRY(encoded_key, encodeKey(pair.first));
+      OUTCOME_TRY(write_batch->put(encoded_key, std::move(pair.second)));
+    }
+    return write_batch->commit();
+  }
+
   outcome::result<LeveldbDatastore::Value> LeveldbDatastore::get(
       const CID &key) const {
     OUTCOME_TRY(encoded_key, encodeKey(key));
@@ -57,4 +76,8 @@ namespace fc::storage::ipfs {
     return leveldb_->remove(encoded_key);
   }
 
+  std::unique_ptr<BufferMapCursor> LeveldbDatastore::cursor() {
+    return leveldb_->cursor();
+  }
+
 }  // namespace fc::storage::ipfs
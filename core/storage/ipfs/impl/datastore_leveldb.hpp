@@ -26,7 +26,7 @@ namespace fc::storage::ipfs {
      * @brief constructor
      * @param leveldb shared pointer to leveldb instance
      */
-    explicit LeveldbDatastore(std::shared_ptr<BufferMap> leveldb);
+    explicit LeveldbDatastore(std::shared_ptr<PersistentBufferMap> leveldb);
 
     ~LeveldbDatastore() override = default;
 
@@ -39,20 +39,38 @@ namespace fc::storage::ipfs {
     static outcome::result<std::shared_ptr<LeveldbDatastore>> create(
         std::string_view leveldb_directory, leveldb::Options options);
 
+    /**
+     * @brief creates LeveldbDatastore instance with tuned leveldb
+     * @param leveldb_directory path to leveldb directory
+     * @param options leveldb database options
+     * @param tuning leveldb cache, filter and write buffer settings
+     * @return shared pointer to instance
+     */
+    static outcome::result<std::shared_ptr<LeveldbDatastore>> create(
+        std::string_view leveldb_directory,
+        leveldb::Options options,
+        const LevelDB::Tuning &tuning);
+
     outcome::result<bool> contains(const CID &key) const override;
 
     outcome::result<void> set(const CID &key, Value value) override;
 
+    /// Writes all values in one leveldb write batch
+    outcome::result<void> setMany(Batch batch) override;
+
     outcome::result<Value> get(const CID &key) const override;
 
     outcome::result<void> remove(const CID &key) override;
 
+    /// Cursor over stored blocks, keys are cid bytes
+    std::unique_ptr<BufferMapCursor> cursor();
+
     IpldPtr shared() override {
       return shared_from_this();
     }
 
    private:
-    std::shared_ptr<BufferMap> leveldb_;  ///< underlying db wrapper
+    std::shared_ptr<PersistentBufferMap> leveldb_;  ///< underlying db wrapper
   };
 
 }  // namespace fc::storage::ipfs
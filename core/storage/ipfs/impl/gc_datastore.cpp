@@ -0,0 +1,232 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/gc_datastore.hpp"
+
+#include "common/logger.hpp"
+#include "storage/ipfs/ipfs_datastore_error.hpp"
+#include "storage/ipld/traverser.hpp"
+
+namespace fc::storage::ipfs {
+  GcDatastore::GcDatastore(std::shared_ptr<LeveldbDatastore> store)
+      : store_{std::move(store)} {}
+
+  GcDatastore::~GcDatastore() {
+    stop();
+  }
+
+  outcome::result<bool> GcDatastore::contains(const CID &key) const {
+    OUTCOME_TRY(found, store_->contains(key));
+    if (found) {
+      // caller may reference block instead of writing it
+      written(key);
+    }
+    return found;
+  }
+
+  outcome::result<void> GcDatastore::set(const CID &key, Value value) {
+    written(key);
+    return store_->set(key, std::move(value));
+  }
+
+  outcome::result<void> GcDatastore::setMany(Batch batch) {
+    for (auto &pair : batch) {
+      written(pair.first);
+    }
+    return store_->setMany(std::move(batch));
+  }
+
+  outcome::result<GcDatastore::Value> GcDatastore::get(const CID &key) const {
+    return store_->get(key);
+  }
+
+  outcome::result<void> GcDatastore::remove(const CID &key) {
+    return store_->remove(key);
+  }
+
+  void GcDatastore::startCycle(const Roots &roots) {
+    std::lock_guard lock{mutex_};
+    if (phase_ != Phase::kIdle) {
+      return;
+    }
+    // stack, deep roots and their links are marked before shallow roots,
+    // so shallow mark doesn't prevent following links
+    to_mark_.clear();
+    for (auto &cid : roots.shallow) {
+      to_mark_.emplace_back(cid, false);
+    }
+    for (auto &cid : roots.deep) {
+      to_mark_.emplace_back(cid, true);
+    }
+    phase_ = Phase::kMark;
+  }
+
+  outcome::result<bool> GcDatastore::step(size_t step_size) {
+    Phase phase;
+    {
+      std::lock_guard lock{mutex_};
+      phase = phase_;
+    }
+    if (phase == Phase::kMark) {
+      OUTCOME_TRY(markStep(step_size));
+    } else if (phase == Phase::kSweep) {
+      OUTCOME_TRY(sweepStep(step_size));
+    }
+    std::lock_guard lock{mutex_};
+    return phase_ == Phase::kIdle;
+  }
+
+  void GcDatastore::start(RootsFn roots,
+                          std::chrono::milliseconds interval,
+                          size_t step_size) {
+    stop();
+    stopped_ = false;
+    thread_ = std::thread{[this, roots{std::move(roots)}, interval, step_size] {
+      loop(roots, interval, step_size);
+    }};
+  }
+
+  void GcDatastore::stop() {
+    {
+      std::lock_guard lock{mutex_};
+      stopped_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  GcDatastore::Stats GcDatastore::stats() const {
+    std::lock_guard lock{mutex_};
+    return stats_;
+  }
+
+  void GcDatastore::written(const CID &key) const {
+    std::lock_guard lock{mutex_};
+    if (phase_ != Phase::kIdle) {
+      written_.insert(key);
+    }
+  }
+
+  void GcDatastore::abortCycle() {
+    phase_ = Phase::kIdle;
+    to_mark_.clear();
+    marked_.clear();
+    written_.clear();
+    swept_.reset();
+  }
+
+  outcome::result<void> GcDatastore::markStep(size_t step_size) {
+    for (size_t i{0}; i < step_size; ++i) {
+      std::pair<CID, bool> item;
+      {
+        std::lock_guard lock{mutex_};
+        if (to_mark_.empty()) {
+          phase_ = Phase::kSweep;
+          swept_.reset();
+          return outcome::success();
+        }
+        item = std::move(to_mark_.back());
+        to_mark_.pop_back();
+        if (!marked_.insert(item.first).second) {
+          continue;
+        }
+        ++stats_.marked;
+      }
+      if (!item.second) {
+        continue;
+      }
+      auto bytes{store_->get(item.first)};
+      if (!bytes) {
+        // e.g. state of tipset which wasn't synced
+        if (bytes.error() == IpfsDatastoreError::kNotFound) {
+          continue;
+        }
+        return bytes.error();
+      }
+      OUTCOME_TRY(links,
+                  ipld::traverser::blockLinks(item.first, bytes.value()));
+      std::lock_guard lock{mutex_};
+      for (auto &link : links) {
+        to_mark_.emplace_back(std::move(link), true);
+      }
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> GcDatastore::sweepStep(size_t step_size) {
+    // new cursor for each step, so it doesn't pin old leveldb files
+    auto cursor{store_->cursor()};
+    if (swept_) {
+      cursor->seek(*swept_);
+      if (cursor->isValid() && cursor->key() == *swept_) {
+        cursor->next();
+      }
+    } else {
+      cursor->seekToFirst();
+    }
+    for (size_t i{0}; i < step_size; ++i, cursor->next()) {
+      std::lock_guard lock{mutex_};
+      if (!cursor->isValid()) {
+        abortCycle();
+        ++stats_.cycles;
+        return outcome::success();
+      }
+      swept_ = cursor->key();
+      ++stats_.swept;
+      auto cid{CID::fromBytes(*swept_)};
+      if (!cid) {
+        continue;
+      }
+      auto &key{cid.value()};
+      if (marked_.count(key) != 0 || written_.count(key) != 0) {
+        continue;
+      }
+      // under lock, so concurrent write either marks block before check or
+      // writes it again after removal
+      OUTCOME_TRY(store_->remove(key));
+      ++stats_.removed;
+    }
+    return outcome::success();
+  }
+
+  void GcDatastore::loop(const RootsFn &roots,
+                         std::chrono::milliseconds interval,
+                         size_t step_size) {
+    auto log{common::createLogger("gc")};
+    std::unique_lock lock{mutex_};
+    while (!stopped_) {
+      lock.unlock();
+      auto _roots{roots()};
+      if (!_roots) {
+        log->warn("roots error: {}", _roots.error().message());
+      } else {
+        startCycle(_roots.value());
+        while (true) {
+          auto done{step(step_size)};
+          std::lock_guard step_lock{mutex_};
+          if (!done) {
+            log->warn("cycle error: {}", done.error().message());
+            abortCycle();
+            break;
+          }
+          if (done.value()) {
+            log->info("cycle done, total removed {} of {} swept",
+                      stats_.removed,
+                      stats_.swept);
+            break;
+          }
+          if (stopped_) {
+            abortCycle();
+            return;
+          }
+        }
+      }
+      lock.lock();
+      cv_.wait_for(lock, interval, [&] { return stopped_; });
+    }
+  }
+}  // namespace fc::storage::ipfs
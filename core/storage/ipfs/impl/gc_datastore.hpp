@@ -0,0 +1,119 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include "primitives/cid/compact_cid.hpp"
+#include "storage/ipfs/impl/datastore_leveldb.hpp"
+
+namespace fc::storage::ipfs {
+  /**
+   * Leveldb datastore with incremental mark and sweep removal of blocks not
+   * reachable from roots. Cycle runs in small steps, reads and writes
+   * proceed between and during steps. Blocks written or found by contains
+   * while cycle runs are kept until next cycle, so blocks written after
+   * roots were taken are never removed.
+   */
+  class GcDatastore : public IpfsDatastore,
+                      public std::enable_shared_from_this<GcDatastore> {
+   public:
+    struct Roots {
+      /// Kept with all blocks reachable from them
+      std::vector<CID> deep;
+      /// Kept without following links, e.g. chain headers
+      std::vector<CID> shallow;
+    };
+    using RootsFn = std::function<outcome::result<Roots>()>;
+
+    struct Stats {
+      size_t cycles{};
+      size_t marked{};
+      size_t swept{};
+      size_t removed{};
+    };
+
+    /// Blocks marked or keys swept by one step
+    static constexpr size_t kDefaultStepSize{1000};
+
+    explicit GcDatastore(std::shared_ptr<LeveldbDatastore> store);
+
+    /// Stops background collection
+    ~GcDatastore() override;
+
+    outcome::result<bool> contains(const CID &key) const override;
+
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    outcome::result<void> setMany(Batch batch) override;
+
+    outcome::result<Value> get(const CID &key) const override;
+
+    outcome::result<void> remove(const CID &key) override;
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+    /// Begins cycle with roots, ignored while cycle is running
+    void startCycle(const Roots &roots);
+
+    /**
+     * Marks or sweeps up to step size blocks
+     * @return true when no cycle is running
+     */
+    outcome::result<bool> step(size_t step_size = kDefaultStepSize);
+
+    /// Runs cycle every interval on own thread, roots are taken at its start
+    void start(RootsFn roots,
+               std::chrono::milliseconds interval,
+               size_t step_size = kDefaultStepSize);
+
+    void stop();
+
+    Stats stats() const;
+
+   private:
+    enum class Phase { kIdle, kMark, kSweep };
+
+    /// Keep block written during cycle
+    void written(const CID &key) const;
+
+    /// Drops cycle state, mutex must be locked
+    void abortCycle();
+
+    outcome::result<void> markStep(size_t step_size);
+
+    outcome::result<void> sweepStep(size_t step_size);
+
+    void loop(const RootsFn &roots,
+              std::chrono::milliseconds interval,
+              size_t step_size);
+
+    std::shared_ptr<LeveldbDatastore> store_;
+
+    mutable std::mutex mutex_;
+    Phase phase_{Phase::kIdle};
+    /// Blocks reached from roots
+    std::unordered_set<CompactCid> marked_;
+    /// Blocks written during cycle
+    mutable std::unordered_set<CompactCid> written_;
+    /// Blocks to mark, with whether their links are followed
+    std::vector<std::pair<CID, bool>> to_mark_;
+    /// Last swept key, sweep continues after it
+    boost::optional<Buffer> swept_;
+    Stats stats_;
+
+    std::condition_variable cv_;
+    bool stopped_{false};
+    std::thread thread_;
+  };
+}  // namespace fc::storage::ipfs
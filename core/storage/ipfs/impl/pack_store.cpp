@@ -0,0 +1,343 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/pack_store.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/endian/conversion.hpp>
+#include <boost/filesystem.hpp>
+
+namespace fc::storage::ipfs {
+  namespace fs = boost::filesystem;
+
+  namespace {
+    constexpr std::string_view kMagic{"FCIDX001"};
+    constexpr size_t kFanoutOffset{kMagic.size()};
+    constexpr size_t kEntriesOffset{kFanoutOffset + 256 * 8};
+    constexpr size_t kEntrySize{20};
+
+    uint64_t cidHash(BytesIn cid) {
+      // FNV-1a
+      uint64_t h{0xcbf29ce484222325};
+      for (auto byte : cid) {
+        h = (h ^ byte) * 0x100000001b3;
+      }
+      return h;
+    }
+
+    template <typename T>
+    void putLe(Buffer &out, T value) {
+      boost::endian::native_to_little_inplace(value);
+      auto bytes{reinterpret_cast<const uint8_t *>(&value)};
+      out.put(gsl::make_span(bytes, sizeof(T)));
+    }
+
+    template <typename T>
+    T getLe(const uint8_t *in) {
+      T value;
+      memcpy(&value, in, sizeof(T));
+      return boost::endian::little_to_native(value);
+    }
+
+    bool writeAll(int fd, BytesIn bytes) {
+      while (!bytes.empty()) {
+        auto n{::write(fd, bytes.data(), bytes.size())};
+        if (n < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return false;
+        }
+        bytes = bytes.subspan(n);
+      }
+      return true;
+    }
+
+    bool readAll(int fd, uint64_t offset, gsl::span<uint8_t> bytes) {
+      while (!bytes.empty()) {
+        auto n{::pread(fd, bytes.data(), bytes.size(), offset)};
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n <= 0) {
+          return false;
+        }
+        bytes = bytes.subspan(n);
+        offset += n;
+      }
+      return true;
+    }
+  }  // namespace
+
+  PackStore::Pack::~Pack() {
+    if (pack_fd != -1) {
+      ::close(pack_fd);
+    }
+    if (idx_fd != -1) {
+      ::close(idx_fd);
+    }
+  }
+
+  PackStore::Writer::Writer(PackStore &store, uint64_t number, int fd)
+      : store_{store}, number_{number}, fd_{fd} {}
+
+  PackStore::Writer::~Writer() {
+    if (!committed_) {
+      ::close(fd_);
+      fs::remove(store_.path(number_, ".pack.tmp"));
+      fs::remove(store_.path(number_, ".idx.tmp"));
+    }
+  }
+
+  outcome::result<void> PackStore::Writer::add(const CID &cid,
+                                               BytesIn value) {
+    if (committed_) {
+      return PackStoreError::kCannotWrite;
+    }
+    OUTCOME_TRY(key, cid.toBytes());
+    Buffer record;
+    record.reserve(8 + key.size() + value.size());
+    putLe<uint32_t>(record, key.size());
+    record.put(key);
+    putLe<uint32_t>(record, value.size());
+    record.put(value);
+    if (!writeAll(fd_, record)) {
+      return PackStoreError::kCannotWrite;
+    }
+    entries_.push_back({cidHash(key), offset_, (uint32_t)record.size()});
+    offset_ += record.size();
+    return outcome::success();
+  }
+
+  outcome::result<void> PackStore::Writer::commit() {
+    if (committed_) {
+      return PackStoreError::kCannotWrite;
+    }
+    std::sort(entries_.begin(), entries_.end(), [](auto &l, auto &r) {
+      return l.hash < r.hash;
+    });
+    Buffer idx;
+    idx.reserve(kEntriesOffset + entries_.size() * kEntrySize);
+    idx.put(kMagic);
+    std::array<uint64_t, 256> fanout{};
+    for (auto &entry : entries_) {
+      ++fanout[entry.hash >> 56];
+    }
+    uint64_t count{};
+    for (auto n : fanout) {
+      count += n;
+      putLe(idx, count);
+    }
+    for (auto &entry : entries_) {
+      putLe(idx, entry.hash);
+      putLe(idx, entry.offset);
+      putLe(idx, entry.size);
+    }
+
+    // pack is durable before index, index makes pack visible
+    auto ok{::fsync(fd_) == 0};
+    ::close(fd_);
+    committed_ = true;
+    auto pack_tmp{store_.path(number_, ".pack.tmp")};
+    auto idx_tmp{store_.path(number_, ".idx.tmp")};
+    if (ok) {
+      ok = ::rename(pack_tmp.c_str(), store_.path(number_, ".pack").c_str())
+           == 0;
+    }
+    if (ok) {
+      auto fd{::open(idx_tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+      ok = fd != -1 && writeAll(fd, idx) && ::fsync(fd) == 0;
+      if (fd != -1) {
+        ::close(fd);
+      }
+    }
+    if (ok) {
+      ok = ::rename(idx_tmp.c_str(), store_.path(number_, ".idx").c_str())
+           == 0;
+    }
+    if (!ok) {
+      fs::remove(pack_tmp);
+      fs::remove(idx_tmp);
+      fs::remove(store_.path(number_, ".pack"));
+      return PackStoreError::kCannotWrite;
+    }
+    return store_.load(number_);
+  }
+
+  size_t PackStore::Writer::count() const {
+    return entries_.size();
+  }
+
+  PackStore::PackStore(std::string dir) : dir_{std::move(dir)} {}
+
+  outcome::result<std::shared_ptr<PackStore>> PackStore::open(
+      const std::string &dir) {
+    boost::system::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+      return PackStoreError::kCannotOpen;
+    }
+    std::shared_ptr<PackStore> store{new PackStore{dir}};
+    std::vector<uint64_t> numbers;
+    for (auto &entry : fs::directory_iterator{dir}) {
+      auto &path{entry.path()};
+      if (path.extension() == ".tmp") {
+        // interrupted writer
+        fs::remove(path);
+        continue;
+      }
+      if (path.extension() != ".idx") {
+        continue;
+      }
+      try {
+        numbers.push_back(std::stoull(path.stem().string()));
+      } catch (std::logic_error &) {
+        continue;
+      }
+    }
+    std::sort(numbers.begin(), numbers.end());
+    for (auto number : numbers) {
+      OUTCOME_TRY(store->load(number));
+      store->next_number_ = number + 1;
+    }
+    return store;
+  }
+
+  outcome::result<bool> PackStore::contains(const CID &cid) const {
+    OUTCOME_TRY(value, get(cid));
+    return value.has_value();
+  }
+
+  outcome::result<boost::optional<Buffer>> PackStore::get(
+      const CID &cid) const {
+    OUTCOME_TRY(key, cid.toBytes());
+    std::shared_lock lock{mutex_};
+    for (auto &pack : packs_) {
+      OUTCOME_TRY(value, find(*pack, key));
+      if (value) {
+        return std::move(value);
+      }
+    }
+    return boost::none;
+  }
+
+  outcome::result<std::unique_ptr<PackStore::Writer>> PackStore::writer() {
+    uint64_t number;
+    {
+      std::unique_lock lock{mutex_};
+      number = next_number_++;
+    }
+    auto fd{::open(path(number, ".pack.tmp").c_str(),
+                   O_WRONLY | O_CREAT | O_TRUNC,
+                   0644)};
+    if (fd == -1) {
+      return PackStoreError::kCannotWrite;
+    }
+    return std::unique_ptr<Writer>{new Writer{*this, number, fd}};
+  }
+
+  std::string PackStore::path(uint64_t number, const char *ext) const {
+    return (fs::path{dir_} / (std::to_string(number) + ext)).string();
+  }
+
+  outcome::result<void> PackStore::load(uint64_t number) {
+    auto pack{std::make_unique<Pack>()};
+    pack->pack_fd = ::open(path(number, ".pack").c_str(), O_RDONLY);
+    pack->idx_fd = ::open(path(number, ".idx").c_str(), O_RDONLY);
+    if (pack->pack_fd == -1 || pack->idx_fd == -1) {
+      return PackStoreError::kCannotOpen;
+    }
+    std::vector<uint8_t> header(kEntriesOffset);
+    if (!readAll(pack->idx_fd, 0, header)) {
+      return PackStoreError::kCorrupted;
+    }
+    if (!std::equal(kMagic.begin(), kMagic.end(), header.begin())) {
+      return PackStoreError::kCorrupted;
+    }
+    for (size_t i{0}; i < 256; ++i) {
+      pack->fanout[i] = getLe<uint64_t>(&header[kFanoutOffset + i * 8]);
+    }
+    auto size{::lseek(pack->idx_fd, 0, SEEK_END)};
+    if (size < 0
+        || (uint64_t)size != kEntriesOffset + pack->fanout[255] * kEntrySize) {
+      return PackStoreError::kCorrupted;
+    }
+    std::unique_lock lock{mutex_};
+    packs_.insert(packs_.begin(), std::move(pack));
+    return outcome::success();
+  }
+
+  outcome::result<boost::optional<Buffer>> PackStore::find(
+      const Pack &pack, BytesIn cid) const {
+    auto hash{cidHash(cid)};
+    auto top{hash >> 56};
+    uint64_t begin{top == 0 ? 0 : pack.fanout[top - 1]};
+    uint64_t end{pack.fanout[top]};
+    std::array<uint8_t, kEntrySize> entry{};
+    auto readEntry{[&](uint64_t i) {
+      return readAll(pack.idx_fd, kEntriesOffset + i * kEntrySize, entry);
+    }};
+    // lower bound of hash
+    while (begin < end) {
+      auto middle{begin + (end - begin) / 2};
+      if (!readEntry(middle)) {
+        return PackStoreError::kCannotRead;
+      }
+      if (getLe<uint64_t>(&entry[0]) < hash) {
+        begin = middle + 1;
+      } else {
+        end = middle;
+      }
+    }
+    // same hash may belong to several cids
+    for (auto i{begin}; i < pack.fanout[top]; ++i) {
+      if (!readEntry(i)) {
+        return PackStoreError::kCannotRead;
+      }
+      if (getLe<uint64_t>(&entry[0]) != hash) {
+        break;
+      }
+      auto offset{getLe<uint64_t>(&entry[8])};
+      auto size{getLe<uint32_t>(&entry[16])};
+      Buffer record(size, 0);
+      if (!readAll(pack.pack_fd, offset, record)) {
+        return PackStoreError::kCannotRead;
+      }
+      if (size < 8) {
+        return PackStoreError::kCorrupted;
+      }
+      auto key_size{getLe<uint32_t>(record.data())};
+      if (key_size > size - 8) {
+        return PackStoreError::kCorrupted;
+      }
+      auto key{gsl::make_span(record).subspan(4, key_size)};
+      if (!std::equal(key.begin(), key.end(), cid.begin(), cid.end())) {
+        continue;
+      }
+      auto value_size{getLe<uint32_t>(&record[4 + key_size])};
+      if (value_size != size - 8 - key_size) {
+        return PackStoreError::kCorrupted;
+      }
+      return Buffer{gsl::make_span(record).subspan(8 + key_size)};
+    }
+    return boost::none;
+  }
+}  // namespace fc::storage::ipfs
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::ipfs, PackStoreError, e) {
+  using E = fc::storage::ipfs::PackStoreError;
+  switch (e) {
+    case E::kCannotOpen:
+      return "PackStoreError: cannot open pack";
+    case E::kCannotWrite:
+      return "PackStoreError: cannot write pack";
+    case E::kCannotRead:
+      return "PackStoreError: cannot read pack";
+    case E::kCorrupted:
+      return "PackStoreError: pack is corrupted";
+  }
+  return "PackStoreError: unknown error";
+}
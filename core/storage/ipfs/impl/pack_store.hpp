@@ -0,0 +1,109 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <shared_mutex>
+
+#include <boost/optional.hpp>
+
+#include "common/buffer.hpp"
+#include "primitives/cid/cid.hpp"
+
+namespace fc::storage::ipfs {
+  using common::Buffer;
+
+  enum class PackStoreError {
+    kCannotOpen = 1,
+    kCannotWrite,
+    kCannotRead,
+    kCorrupted,
+  };
+
+  /**
+   * Immutable store of blocks in append-only pack files, for history which
+   * is rarely read and never changed.
+   * Pack "<n>.pack" is sequence of records (cid size, cid, value size, value
+   * as 32 bit little endian sizes). Index "<n>.idx" has magic, fanout table
+   * of 256 cumulative counts by top byte of cid hash, and entries (hash,
+   * offset, size) sorted by hash. Only fanout is kept in memory, lookup is
+   * binary search in index file and cid comparison in pack record.
+   * Pack without index is incomplete and ignored.
+   */
+  class PackStore {
+    struct Pack {
+      ~Pack();
+
+      int pack_fd{-1};
+      int idx_fd{-1};
+      std::array<uint64_t, 256> fanout{};
+    };
+
+   public:
+    /// New pack, blocks become visible on commit
+    class Writer {
+     public:
+      /// Removes files of pack which wasn't committed
+      ~Writer();
+
+      outcome::result<void> add(const CID &cid, BytesIn value);
+
+      /// Writes index and adds pack to store
+      outcome::result<void> commit();
+
+      /// Blocks added
+      size_t count() const;
+
+     private:
+      friend class PackStore;
+
+      Writer(PackStore &store, uint64_t number, int fd);
+
+      struct Entry {
+        uint64_t hash, offset;
+        uint32_t size;
+      };
+
+      PackStore &store_;
+      uint64_t number_;
+      int fd_;
+      uint64_t offset_{};
+      std::vector<Entry> entries_;
+      bool committed_{false};
+    };
+
+    /// Opens packs in directory, creates directory if missing
+    static outcome::result<std::shared_ptr<PackStore>> open(
+        const std::string &dir);
+
+    outcome::result<bool> contains(const CID &cid) const;
+
+    /// Value of block, none if not found
+    outcome::result<boost::optional<Buffer>> get(const CID &cid) const;
+
+    /// Starts new pack, one writer at a time is expected
+    outcome::result<std::unique_ptr<Writer>> writer();
+
+   private:
+    explicit PackStore(std::string dir);
+
+    std::string path(uint64_t number, const char *ext) const;
+
+    outcome::result<void> load(uint64_t number);
+
+    /// Value of block from pack, none if pack doesn't have it
+    outcome::result<boost::optional<Buffer>> find(const Pack &pack,
+                                                  BytesIn cid) const;
+
+    std::string dir_;
+    mutable std::shared_mutex mutex_;
+    /// Newest first
+    std::vector<std::unique_ptr<Pack>> packs_;
+    uint64_t next_number_{};
+  };
+}  // namespace fc::storage::ipfs
+
+OUTCOME_HPP_DECLARE_ERROR(fc::storage::ipfs, PackStoreError);
@@ -0,0 +1,142 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/split_datastore.hpp"
+
+#include "common/logger.hpp"
+#include "storage/ipld/traverser.hpp"
+
+namespace fc::storage::ipfs {
+  SplitDatastore::SplitDatastore(IpldPtr hot, std::shared_ptr<PackStore> cold)
+      : hot_{std::move(hot)}, cold_{std::move(cold)} {}
+
+  SplitDatastore::~SplitDatastore() {
+    stop();
+  }
+
+  outcome::result<bool> SplitDatastore::contains(const CID &key) const {
+    OUTCOME_TRY(hot, hot_->contains(key));
+    if (hot) {
+      return true;
+    }
+    return cold_->contains(key);
+  }
+
+  outcome::result<void> SplitDatastore::set(const CID &key, Value value) {
+    return hot_->set(key, std::move(value));
+  }
+
+  outcome::result<void> SplitDatastore::setMany(Batch batch) {
+    return hot_->setMany(std::move(batch));
+  }
+
+  outcome::result<SplitDatastore::Value> SplitDatastore::get(
+      const CID &key) const {
+    auto hot{hot_->get(key)};
+    if (hot || hot.error() != IpfsDatastoreError::kNotFound) {
+      return hot;
+    }
+    OUTCOME_TRY(cold, cold_->get(key));
+    if (!cold) {
+      return IpfsDatastoreError::kNotFound;
+    }
+    return std::move(*cold);
+  }
+
+  outcome::result<void> SplitDatastore::remove(const CID &key) {
+    return hot_->remove(key);
+  }
+
+  outcome::result<bool> SplitDatastore::containsHot(const CID &key) const {
+    return hot_->contains(key);
+  }
+
+  outcome::result<size_t> SplitDatastore::migrate(const Roots &roots) {
+    std::lock_guard lock{migrate_mutex_};
+    std::vector<std::pair<CID, bool>> queue;
+    for (auto &cid : roots.shallow) {
+      queue.emplace_back(cid, false);
+    }
+    for (auto &cid : roots.deep) {
+      queue.emplace_back(cid, true);
+    }
+    OUTCOME_TRY(writer, cold_->writer());
+    std::vector<CID> moved;
+    std::unordered_set<CompactCid> visited;
+    while (!queue.empty()) {
+      auto [cid, deep]{std::move(queue.back())};
+      queue.pop_back();
+      if (!visited.insert(cid).second) {
+        continue;
+      }
+      auto bytes{hot_->get(cid)};
+      if (!bytes) {
+        if (bytes.error() == IpfsDatastoreError::kNotFound) {
+          continue;
+        }
+        return bytes.error();
+      }
+      if (deep) {
+        OUTCOME_TRY(links, ipld::traverser::blockLinks(cid, bytes.value()));
+        for (auto &link : links) {
+          queue.emplace_back(std::move(link), true);
+        }
+      }
+      OUTCOME_TRY(writer->add(cid, bytes.value()));
+      moved.push_back(std::move(cid));
+    }
+    if (moved.empty()) {
+      return 0;
+    }
+    OUTCOME_TRY(writer->commit());
+    // blocks are readable from cold before they leave hot
+    for (auto &cid : moved) {
+      OUTCOME_TRY(hot_->remove(cid));
+    }
+    return moved.size();
+  }
+
+  void SplitDatastore::start(RootsFn roots,
+                             std::chrono::milliseconds interval) {
+    stop();
+    stopped_ = false;
+    thread_ = std::thread{[this, roots{std::move(roots)}, interval] {
+      loop(roots, interval);
+    }};
+  }
+
+  void SplitDatastore::stop() {
+    {
+      std::lock_guard lock{mutex_};
+      stopped_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  void SplitDatastore::loop(const RootsFn &roots,
+                            std::chrono::milliseconds interval) {
+    auto log{common::createLogger("split")};
+    std::unique_lock lock{mutex_};
+    while (!stopped_) {
+      lock.unlock();
+      auto _roots{roots()};
+      if (!_roots) {
+        log->warn("roots error: {}", _roots.error().message());
+      } else {
+        auto moved{migrate(_roots.value())};
+        if (!moved) {
+          log->warn("migrate error: {}", moved.error().message());
+        } else if (moved.value() != 0) {
+          log->info("migrated {} blocks to cold", moved.value());
+        }
+      }
+      lock.lock();
+      cv_.wait_for(lock, interval, [&] { return stopped_; });
+    }
+  }
+}  // namespace fc::storage::ipfs
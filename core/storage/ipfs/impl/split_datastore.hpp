@@ -0,0 +1,76 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <thread>
+
+#include "storage/ipfs/impl/gc_datastore.hpp"
+#include "storage/ipfs/impl/pack_store.hpp"
+
+namespace fc::storage::ipfs {
+  /**
+   * Datastore of recent blocks in hot (e.g. leveldb) datastore and history
+   * in cold pack store. Reads check hot, then cold. Writes go to hot, blocks
+   * are moved to cold by migration, e.g. when they are older than finality.
+   */
+  class SplitDatastore
+      : public IpfsDatastore,
+        public std::enable_shared_from_this<SplitDatastore> {
+   public:
+    /// Blocks to migrate, deep are migrated with links found in hot
+    using Roots = GcDatastore::Roots;
+    using RootsFn = std::function<outcome::result<Roots>()>;
+
+    SplitDatastore(IpldPtr hot, std::shared_ptr<PackStore> cold);
+
+    /// Stops background migration
+    ~SplitDatastore() override;
+
+    outcome::result<bool> contains(const CID &key) const override;
+
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    outcome::result<void> setMany(Batch batch) override;
+
+    outcome::result<Value> get(const CID &key) const override;
+
+    /// Removes from hot only, cold is immutable
+    outcome::result<void> remove(const CID &key) override;
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+    outcome::result<bool> containsHot(const CID &key) const;
+
+    /**
+     * Moves roots and their hot links to new cold pack, and removes them
+     * from hot after pack is committed. Links not in hot are not followed,
+     * they are cold already or never were synced.
+     * @return blocks moved
+     */
+    outcome::result<size_t> migrate(const Roots &roots);
+
+    /// Migrates every interval (e.g. epoch) on own thread
+    void start(RootsFn roots, std::chrono::milliseconds interval);
+
+    void stop();
+
+   private:
+    void loop(const RootsFn &roots, std::chrono::milliseconds interval);
+
+    IpldPtr hot_;
+    std::shared_ptr<PackStore> cold_;
+    /// One migration at a time
+    std::mutex migrate_mutex_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopped_{false};
+    std::thread thread_;
+  };
+}  // namespace fc::storage::ipfs
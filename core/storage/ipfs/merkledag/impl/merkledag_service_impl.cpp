@@ -5,20 +5,29 @@
 
 #include "storage/ipfs/merkledag/impl/merkledag_service_impl.hpp"
 
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/assert.hpp>
+#include <future>
 
 #include "storage/ipld/impl/ipld_node_impl.hpp"
 
 namespace fc::storage::ipfs::merkledag {
   using ipld::IPLDNodeImpl;
+  using NodeResult = outcome::result<std::shared_ptr<IPLDNode>>;
 
   MerkleDagServiceImpl::MerkleDagServiceImpl(
-      std::shared_ptr<IpfsDatastore> service)
-      : block_service_{std::move(service)} {
+      std::shared_ptr<IpfsDatastore> service, size_t threads, size_t prefetch)
+      : block_service_{std::move(service)}, prefetch_{prefetch} {
     BOOST_ASSERT_MSG(block_service_ != nullptr,
                      "MerkleDAG service: Block service not connected");
+    if (threads != 0 && prefetch != 0) {
+      pool_ = std::make_unique<boost::asio::thread_pool>(threads);
+    }
   }
 
+  MerkleDagServiceImpl::~MerkleDagServiceImpl() = default;
+
   outcome::result<void> MerkleDagServiceImpl::addNode(
       std::shared_ptr<const IPLDNode> node) {
     const common::Buffer &raw_bytes = node->getRawBytes();
@@ -41,72 +50,123 @@ namespace fc::storage::ipfs::merkledag {
       std::function<bool(std::shared_ptr<const IPLDNode>)> handler) const {
     std::ignore = selector;
     OUTCOME_TRY(cid, CID::fromBytes(root_cid));
-    OUTCOME_TRY(root_node, getNode(cid));
-    std::vector<std::shared_ptr<const IPLDNode>> node_set{};
-    node_set.emplace_back(std::move(root_node));
-    const auto &links = node_set.front()->getLinks();
-    for (const auto &link : links) {
-      auto request = getNode(link.get().getCID());
-      if (request.has_error()) return ServiceError::kUnresolvedLink;
-      node_set.emplace_back(std::move(request.value()));
-    }
     size_t sent_count{};
-    for (const auto &node : node_set) {
+    OUTCOME_TRY(walkGraph(cid, 1, [&](auto &, auto node, auto) {
       ++sent_count;
-      if (!handler(node)) break;
-    }
+      return handler(std::move(node));
+    }));
     return sent_count;
   }
 
   outcome::result<std::shared_ptr<Leaf>> MerkleDagServiceImpl::fetchGraph(
       const CID &cid) const {
-    OUTCOME_TRY(node, getNode(cid));
-    auto root_leaf = std::make_shared<LeafImpl>(node->content());
-    auto result = buildGraph(root_leaf, node->getLinks(), false, 0, 0);
-    if (result.has_error()) return result.error();
-    return root_leaf;
+    return buildGraph(cid, boost::none);
   }
 
   outcome::result<std::shared_ptr<Leaf>>
   MerkleDagServiceImpl::fetchGraphOnDepth(const CID &cid,
                                           uint64_t depth) const {
-    OUTCOME_TRY(node, getNode(cid));
-    auto leaf = std::make_shared<LeafImpl>(node->content());
-    auto result = buildGraph(leaf, node->getLinks(), true, depth, 0);
-    if (result.has_error()) return result.error();
-    return leaf;
+    return buildGraph(cid, depth);
   }
 
-  outcome::result<void> MerkleDagServiceImpl::buildGraph(
-      const std::shared_ptr<LeafImpl> &root,
-      const std::vector<std::reference_wrapper<const IPLDLink>> &links,
-      bool depth_limit,
-      const size_t max_depth,
-      size_t current_depth) const {
-    if (depth_limit && current_depth == max_depth) {
+  outcome::result<void> MerkleDagServiceImpl::walkGraph(
+      const CID &cid,
+      boost::optional<uint64_t> max_depth,
+      const Visitor &visitor) const {
+    struct Entry {
+      std::string name;
+      CID cid;
+      size_t depth;
+      /// Valid if load was started
+      std::future<NodeResult> node;
+    };
+    OUTCOME_TRY(root, getNode(cid));
+    // next node to visit is at back
+    std::vector<Entry> stack;
+    size_t loading{0};
+    // loads nodes nearest to top of stack, scans at most 2 * prefetch_
+    // entries, because started ones are counted by loading
+    auto prefetch{[&] {
+      for (auto it{stack.rbegin()};
+           it != stack.rend() && loading < prefetch_;
+           ++it) {
+        if (it->node.valid()) {
+          continue;
+        }
+        auto task{std::make_shared<std::packaged_task<NodeResult()>>(
+            [this, cid{it->cid}] { return getNode(cid); })};
+        it->node = task->get_future();
+        boost::asio::post(*pool_, [task] { (*task)(); });
+        ++loading;
+      }
+    }};
+    auto push{[&](const IPLDNode &node, size_t depth) {
+      if (max_depth && depth >= *max_depth) {
+        return;
+      }
+      auto links{node.getLinks()};
+      for (auto it{links.rbegin()}; it != links.rend(); ++it) {
+        stack.push_back(
+            {it->get().getName(), it->get().getCID(), depth + 1, {}});
+      }
+    }};
+
+    if (!visitor({}, root, 0)) {
       return outcome::success();
     }
-    for (const auto &link : links) {
-      auto request = getNode(link.get().getCID());
-      if (request.has_error()) return ServiceError::kUnresolvedLink;
-      std::shared_ptr<IPLDNode> node = request.value();
-      auto child_leaf = std::make_shared<LeafImpl>(node->content());
-      auto build_result = buildGraph(child_leaf,
-                                     node->getLinks(),
-                                     depth_limit,
-                                     max_depth,
-                                     ++current_depth);
-      if (build_result.has_error()) {
-        return build_result;
+    push(*root, 0);
+    while (!stack.empty()) {
+      if (pool_) {
+        prefetch();
+      }
+      auto entry{std::move(stack.back())};
+      stack.pop_back();
+      auto node{[&] {
+        if (entry.node.valid()) {
+          --loading;
+          return entry.node.get();
+        }
+        return getNode(entry.cid);
+      }()};
+      if (!node) {
+        return ServiceError::kUnresolvedLink;
       }
-      auto insert_result =
-          root->insertSubLeaf(link.get().getName(), std::move(*child_leaf));
-      if (insert_result.has_error()) {
-        return insert_result;
+      if (!visitor(entry.name, node.value(), entry.depth)) {
+        return outcome::success();
       }
+      push(*node.value(), entry.depth);
     }
     return outcome::success();
   }
+
+  outcome::result<std::shared_ptr<Leaf>> MerkleDagServiceImpl::buildGraph(
+      const CID &cid, boost::optional<uint64_t> max_depth) const {
+    // leaves of walked path, complete leaf is moved to its parent
+    std::vector<std::pair<std::string, LeafImpl>> path;
+    auto pop{[&]() -> outcome::result<void> {
+      auto child{std::move(path.back())};
+      path.pop_back();
+      return path.back().second.insertSubLeaf(std::move(child.first),
+                                              std::move(child.second));
+    }};
+    outcome::result<void> inserted{outcome::success()};
+    auto visit{[&](auto &name, auto node, auto depth) {
+      while (path.size() > depth) {
+        inserted = pop();
+        if (!inserted) {
+          return false;
+        }
+      }
+      path.emplace_back(name, LeafImpl{node->content()});
+      return true;
+    }};
+    OUTCOME_TRY(walkGraph(cid, max_depth, visit));
+    OUTCOME_TRY(inserted);
+    while (path.size() > 1) {
+      OUTCOME_TRY(pop());
+    }
+    return std::make_shared<LeafImpl>(std::move(path.front().second));
+  }
 }  // namespace fc::storage::ipfs::merkledag
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::ipfs::merkledag, ServiceError, e) {
@@ -13,16 +13,31 @@
 #include "storage/ipfs/merkledag/merkledag_service.hpp"
 #include "storage/ipld/ipld_link.hpp"
 
+namespace boost::asio {
+  class thread_pool;
+}  // namespace boost::asio
+
 namespace fc::storage::ipfs::merkledag {
   using ipld::IPLDLink;
 
   class MerkleDagServiceImpl : public MerkleDagService {
    public:
+    /// Nodes loaded ahead of walk by default
+    static constexpr size_t kDefaultPrefetch{64};
+
     /**
      * @brief Construct service
      * @param service - underlying block service
+     * @param threads - if non-zero, walked nodes are loaded on own pool of
+     * threads, block service must support concurrent get then
+     * @param prefetch - max nodes loaded ahead of walk
      */
-    explicit MerkleDagServiceImpl(std::shared_ptr<IpfsDatastore> service);
+    explicit MerkleDagServiceImpl(std::shared_ptr<IpfsDatastore> service,
+                                  size_t threads = 0,
+                                  size_t prefetch = kDefaultPrefetch);
+
+    /// Waits for prefetched nodes
+    ~MerkleDagServiceImpl() override;
 
     outcome::result<void> addNode(
         std::shared_ptr<const IPLDNode> node) override;
@@ -44,25 +59,25 @@ namespace fc::storage::ipfs::merkledag {
     outcome::result<std::shared_ptr<Leaf>> fetchGraphOnDepth(
         const CID &cid, uint64_t depth) const override;
 
-   private:
-    std::shared_ptr<IpfsDatastore> block_service_;
+    outcome::result<void> walkGraph(const CID &cid,
+                                    boost::optional<uint64_t> max_depth,
+                                    const Visitor &visitor) const override;
 
+   private:
     /**
-     * @brief Fetch graph internal recursive implementation
-     * @param root - leaf, for which we should extract child nodes
-     * @param links - links to the child nodes of this leaf
-     * @param depth_limit - status of the depth control
+     * @brief Build leaf tree from walked nodes
+     * @param cid - identifier of the root node
      * @param max_depth - e.g. "1" means "Fetch only root node with all
      * children, but without children of their children"
-     * @param current_depth - value of the depth during current operation
      * @return operation result
      */
-    outcome::result<void> buildGraph(
-        const std::shared_ptr<LeafImpl> &root,
-        const std::vector<std::reference_wrapper<const IPLDLink>> &links,
-        bool depth_limit,
-        size_t max_depth,
-        size_t current_depth = 0) const;
+    outcome::result<std::shared_ptr<Leaf>> buildGraph(
+        const CID &cid, boost::optional<uint64_t> max_depth) const;
+
+    std::shared_ptr<IpfsDatastore> block_service_;
+    /// Destroyed first, so running loads finish while service is alive
+    std::unique_ptr<boost::asio::thread_pool> pool_;
+    size_t prefetch_;
   };
 }  // namespace fc::storage::ipfs::merkledag
 
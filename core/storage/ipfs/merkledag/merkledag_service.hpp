@@ -6,6 +6,7 @@
 #ifndef FILECOIN_STORAGE_IPFS_MERKLEDAG_SERVICE_HPP
 #define FILECOIN_STORAGE_IPFS_MERKLEDAG_SERVICE_HPP
 
+#include <boost/optional.hpp>
 #include <memory>
 
 #include "common/outcome.hpp"
@@ -17,6 +18,15 @@ namespace fc::storage::ipfs::merkledag {
 
   class MerkleDagService {
    public:
+    /**
+     * @brief Receiver of walked nodes, should return false to stop walk
+     * @param name - name of link to node, empty for root
+     * @param depth - 0 for root
+     */
+    using Visitor = std::function<bool(const std::string &name,
+                                       std::shared_ptr<const IPLDNode> node,
+                                       size_t depth)>;
+
     /**
      * @brief Destructor
      */
@@ -75,6 +85,20 @@ namespace fc::storage::ipfs::merkledag {
      */
     virtual outcome::result<std::shared_ptr<Leaf>> fetchGraphOnDepth(
         const CID &cid, uint64_t depth) const = 0;
+
+    /**
+     * @brief Visit nodes depth-first, children follow parent in link order,
+     * so visitor receives graph without keeping it in memory
+     * @param cid - identifier of the root node
+     * @param max_depth - children of nodes at this depth are not visited,
+     * none to visit whole graph
+     * @param visitor - receiver of nodes
+     * @return operation result
+     */
+    virtual outcome::result<void> walkGraph(
+        const CID &cid,
+        boost::optional<uint64_t> max_depth,
+        const Visitor &visitor) const = 0;
   };
 
   /**
@@ -5,6 +5,7 @@
 
 #include "storage/ipld/traverser.hpp"
 
+#include <boost/asio/post.hpp>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 
@@ -63,51 +64,109 @@ namespace fc::storage::ipld::traverser {
   }
 
   outcome::result<CID> Traverser::advance() {
+    OUTCOME_TRY(block, next(false));
+    return std::move(block.cid);
+  }
+
+  outcome::result<VisitedBlock> Traverser::advanceBlock() {
+    return next(true);
+  }
+
+  outcome::result<VisitedBlock> Traverser::next(bool with_bytes) {
     if (isCompleted()) {
       return TraverserError::kTraverseCompleted;
     }
-    CID cid = to_visit_.front();
-    to_visit_.pop();
-    if (visited_.insert(cid).second) {
-      OUTCOME_TRY(bytes, store.get(cid));
+    VisitedBlock block{to_visit_.front(), {}};
+    to_visit_.pop_front();
+    if (prefetched_ != 0) {
+      --prefetched_;
+    }
+    auto &cid{block.cid};
+    auto is_new{visited_.insert(cid).second};
+    if (is_new || with_bytes) {
+      OUTCOME_TRYA(block.bytes, load(cid));
+    }
+    if (is_new) {
       visit_order_.push_back(cid);
 
-      // TODO(turuslan): what about other types?
-      if (cid.content_type == libp2p::multi::MulticodecType::DAG_CBOR) {
-        CborDecodeStream s{bytes};
-        OUTCOME_TRY(parseCbor(s));
-      } else if (cid.content_type == libp2p::multi::MulticodecType::DAG_PB) {
-        OUTCOME_TRY(cids, PbNodeDecoder::links(bytes));
-        for (auto &&c : cids) {
-          to_visit_.push(c);
-        }
+      OUTCOME_TRY(cids, blockLinks(cid, block.bytes));
+      for (auto &&c : cids) {
+        to_visit_.push_back(c);
       }
     }
-    return cid;
+    prefetch();
+    return std::move(block);
+  }
+
+  outcome::result<common::Buffer> Traverser::load(const CID &cid) {
+    auto it{loading_.find(cid)};
+    if (it == loading_.end()) {
+      return store.get(cid);
+    }
+    auto future{std::move(it->second)};
+    loading_.erase(it);
+    return future.get();
+  }
+
+  void Traverser::prefetch() {
+    if (!pool_) {
+      return;
+    }
+    while (loading_.size() < prefetch_ && prefetched_ < to_visit_.size()) {
+      const auto &cid{to_visit_[prefetched_++]};
+      if (visited_.count(cid) != 0 || loading_.count(cid) != 0) {
+        continue;
+      }
+      auto task{std::make_shared<
+          std::packaged_task<outcome::result<common::Buffer>()>>(
+          [&ipld = store, cid] { return ipld.get(cid); })};
+      loading_.emplace(cid, task->get_future().share());
+      boost::asio::post(*pool_, [task] { (*task)(); });
+    }
   }
 
   bool Traverser::isCompleted() const {
     return to_visit_.empty();
   }
 
-  outcome::result<void> Traverser::parseCbor(CborDecodeStream &s) {
-    if (s.isCid()) {
-      CID cid;
-      s >> cid;
-      to_visit_.push(cid);
-    } else if (s.isList()) {
-      auto n = s.listLength();
-      for (auto l = s.list(); n != 0; --n) {
-        OUTCOME_TRY(parseCbor(l));
+  namespace {
+    void parseCbor(CborDecodeStream &s, std::vector<CID> &cids) {
+      if (s.isCid()) {
+        CID cid;
+        s >> cid;
+        cids.push_back(std::move(cid));
+      } else if (s.isList()) {
+        auto n = s.listLength();
+        for (auto l = s.list(); n != 0; --n) {
+          parseCbor(l, cids);
+        }
+      } else if (s.isMap()) {
+        for (auto &p : s.map()) {
+          parseCbor(p.second, cids);
+        }
+      } else {
+        s.next();
       }
-    } else if (s.isMap()) {
-      for (auto &p : s.map()) {
-        OUTCOME_TRY(parseCbor(p.second));
+    }
+  }  // namespace
+
+  outcome::result<std::vector<CID>> blockLinks(
+      const CID &cid, gsl::span<const uint8_t> bytes) {
+    // TODO(turuslan): what about other types?
+    if (cid.content_type == libp2p::multi::MulticodecType::DAG_CBOR) {
+      std::vector<CID> cids;
+      try {
+        CborDecodeStream s{bytes};
+        parseCbor(s, cids);
+      } catch (std::system_error &e) {
+        return outcome::failure(e.code());
       }
-    } else {
-      s.next();
+      return std::move(cids);
+    }
+    if (cid.content_type == libp2p::multi::MulticodecType::DAG_PB) {
+      return PbNodeDecoder::links(bytes);
     }
-    return outcome::success();
+    return std::vector<CID>{};
   }
 
 }  // namespace fc::storage::ipld::traverser
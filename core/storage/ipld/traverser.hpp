@@ -6,7 +6,10 @@
 #ifndef CPP_FILECOIN_CORE_STORAGE_IPLD_TRAVERSER_HPP
 #define CPP_FILECOIN_CORE_STORAGE_IPLD_TRAVERSER_HPP
 
-#include <queue>
+#include <boost/asio/thread_pool.hpp>
+#include <deque>
+#include <future>
+#include <map>
 #include "storage/ipfs/datastore.hpp"
 #include "storage/ipld/selector.hpp"
 
@@ -21,7 +24,24 @@ namespace fc::storage::ipld::traverser {
   };
 
   /**
-   * IPLD traverser, stores current traverse state
+   * Links of dag-cbor or dag-pb block, other blocks have no links
+   * @param cid - cid of block, selects codec
+   * @param bytes - block bytes
+   */
+  outcome::result<std::vector<CID>> blockLinks(
+      const CID &cid, gsl::span<const uint8_t> bytes);
+
+  /// Block visited by traverser
+  struct VisitedBlock {
+    CID cid;
+    common::Buffer bytes;
+  };
+
+  /**
+   * IPLD traverser, stores current traverse state.
+   * With prefetch, blocks queued to visit are loaded ahead on own thread pool
+   * while visited blocks are returned in traversal order. Store must allow
+   * concurrent get then.
    */
   class Traverser {
    public:
@@ -30,10 +50,18 @@ namespace fc::storage::ipld::traverser {
      * @param store - ipld store
      * @param root - root cid
      * @param selector - selector
+     * @param prefetch - max blocks loaded ahead, 0 disables prefetch
      */
-    Traverser(Ipld &store, const CID &root, const Selector &selector)
-        : store{store} {
-      to_visit_.push(root);
+    Traverser(Ipld &store,
+              const CID &root,
+              const Selector &selector,
+              size_t prefetch = 0)
+        : store{store}, prefetch_{prefetch} {
+      to_visit_.push_back(root);
+      if (prefetch_ != 0) {
+        pool_ = std::make_unique<boost::asio::thread_pool>(
+            std::min<size_t>(prefetch_, kMaxPrefetchThreads));
+      }
     }
 
     /**
@@ -49,6 +77,12 @@ namespace fc::storage::ipld::traverser {
      */
     outcome::result<CID> advance();
 
+    /**
+     * Visit next element and return its bytes, so caller doesn't load it again
+     * @return cid and bytes of traversed block
+     */
+    outcome::result<VisitedBlock> advanceBlock();
+
     /**
      * Checks if traversal completed
      * @return true if all cids are visited
@@ -56,12 +90,28 @@ namespace fc::storage::ipld::traverser {
     bool isCompleted() const;
 
    private:
-    outcome::result<void> parseCbor(CborDecodeStream &s);
+    static constexpr size_t kMaxPrefetchThreads{8};
+
+    outcome::result<VisitedBlock> next(bool with_bytes);
+
+    /// Returns prefetched bytes or loads them
+    outcome::result<common::Buffer> load(const CID &cid);
+
+    /// Starts loading of cids queued to visit, up to prefetch limit
+    void prefetch();
 
     Ipld &store;
-    std::queue<CID> to_visit_;      // set of cids to visit
+    std::deque<CID> to_visit_;      // set of cids to visit
     std::vector<CID> visit_order_;  // visited cids in visit order
     std::set<CID> visited_;         // set of visited cids
+
+    size_t prefetch_;
+    /// Number of cids at front of to_visit_ checked by prefetch
+    size_t prefetched_{};
+    std::map<CID, std::shared_future<outcome::result<common::Buffer>>>
+        loading_;
+    /// Destroyed first, so no load outlives traverser
+    std::unique_ptr<boost::asio::thread_pool> pool_;
   };
 
 }  // namespace fc::storage::ipld::traverser
@@ -8,6 +8,7 @@
 #include "primitives/address/address_codec.hpp"
 #include "storage/filestore/filestore_error.hpp"
 #include "storage/filestore/impl/filesystem/filesystem_filestore.hpp"
+#include "storage/keystore/impl/filesystem/key_cache.hpp"
 
 using fc::primitives::address::Address;
 using fc::primitives::address::Protocol;
@@ -15,19 +16,24 @@ using fc::storage::filestore::FileStoreError;
 using fc::storage::filestore::FileSystemFileStore;
 using fc::storage::filestore::Path;
 using fc::storage::keystore::FileSystemKeyStore;
+using fc::storage::keystore::KeyCache;
 using fc::storage::keystore::KeyStore;
 using fc::storage::keystore::KeyStoreError;
 
 FileSystemKeyStore::FileSystemKeyStore(
     Path path,
     std::shared_ptr<BlsProvider> blsProvider,
-    std::shared_ptr<Secp256k1ProviderDefault> secp256K1Provider)
+    std::shared_ptr<Secp256k1ProviderDefault> secp256K1Provider,
+    std::chrono::seconds key_ttl)
     : KeyStore(std::move(blsProvider), std::move(secp256K1Provider)),
       keystore_path_(std::move(path)),
-      filestore_(std::make_shared<FileSystemFileStore>()) {
+      filestore_(std::make_shared<FileSystemFileStore>()),
+      cache_(std::make_unique<KeyCache>(key_ttl)) {
   OUTCOME_EXCEPT(filestore_->createDirectories(keystore_path_));
 }
 
+FileSystemKeyStore::~FileSystemKeyStore() = default;
+
 fc::outcome::result<bool> FileSystemKeyStore::has(const Address &address) const
     noexcept {
   OUTCOME_TRY(path, addressToPath(address));
@@ -68,6 +74,7 @@ fc::outcome::result<void> FileSystemKeyStore::remove(
     const Address &address) noexcept {
   OUTCOME_TRY(found, has(address));
   if (!found) return KeyStoreError::kNotFound;
+  cache_->remove(address);
   OUTCOME_TRY(path, addressToPath(address));
   OUTCOME_TRY(filestore_->remove(path));
   return fc::outcome::success();
@@ -119,6 +126,16 @@ fc::outcome::result<typename KeyStore::TPrivateKey> FileSystemKeyStore::get(
   return KeyStoreError::kWrongAddress;
 }
 
+fc::outcome::result<typename KeyStore::TPrivateKey>
+FileSystemKeyStore::getChecked(const Address &address) const noexcept {
+  if (auto cached{cache_->get(address)}) {
+    return std::move(*cached);
+  }
+  OUTCOME_TRY(private_key, KeyStore::getChecked(address));
+  cache_->put(address, private_key);
+  return std::move(private_key);
+}
+
 fc::outcome::result<Path> FileSystemKeyStore::addressToPath(
     const Address &address) const noexcept {
   std::stringstream ss;
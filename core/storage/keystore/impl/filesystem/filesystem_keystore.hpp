@@ -6,6 +6,8 @@
 #ifndef FILECOIN_CORE_STORAGE_FILESYSTEM_KEYSTORE_HPP
 #define FILECOIN_CORE_STORAGE_FILESYSTEM_KEYSTORE_HPP
 
+#include <chrono>
+
 #include "storage/filestore/filestore.hpp"
 #include "storage/filestore/path.hpp"
 #include "storage/keystore/keystore.hpp"
@@ -15,19 +17,25 @@ namespace fc::storage::keystore {
   using filestore::FileStore;
   using filestore::Path;
 
+  class KeyCache;
+
   /**
-   * @brief FileSystem KeyStore implementation
+   * @brief FileSystem KeyStore implementation.
+   * Keys read for signing are cached in locked memory for key_ttl, so
+   * repeated signatures don't read key files.
    */
   class FileSystemKeyStore : public KeyStore {
     /** @brief Extention of private key file */
     const std::string kPrivateKeyExtension = ".pri";
 
    public:
-    FileSystemKeyStore(Path path,
-                       std::shared_ptr<BlsProvider> blsProvider,
-                       std::shared_ptr<Secp256k1ProviderDefault> secp256K1Provider);
+    FileSystemKeyStore(
+        Path path,
+        std::shared_ptr<BlsProvider> blsProvider,
+        std::shared_ptr<Secp256k1ProviderDefault> secp256K1Provider,
+        std::chrono::seconds key_ttl = std::chrono::minutes{10});
 
-    ~FileSystemKeyStore() override = default;
+    ~FileSystemKeyStore() override;
 
     /** @copydoc KeyStore::has() */
     outcome::result<bool> has(const Address &address) const noexcept override;
@@ -47,6 +55,10 @@ namespace fc::storage::keystore {
     outcome::result<typename KeyStore::TPrivateKey> get(
         const Address &address) const noexcept override;
 
+    /** @copydoc KeyStore::getChecked() */
+    outcome::result<typename KeyStore::TPrivateKey> getChecked(
+        const Address &address) const noexcept override;
+
    private:
     /**
      * @brief Get path to private key file from address
@@ -59,6 +71,8 @@ namespace fc::storage::keystore {
     Path keystore_path_;
 
     std::shared_ptr<FileStore> filestore_;
+
+    std::unique_ptr<KeyCache> cache_;
   };
 
 }  // namespace fc::storage::keystore
@@ -0,0 +1,127 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <sys/mman.h>
+#include <boost/functional/hash.hpp>
+#include <boost/optional.hpp>
+#include <chrono>
+#include <map>
+#include <mutex>
+
+#include "primitives/address/address_codec.hpp"
+#include "storage/keystore/keystore.hpp"
+
+namespace fc::storage::keystore {
+
+  /**
+   * Allocator which keeps memory out of swap and wipes it before release.
+   * Locking is best effort, allocation doesn't fail when memlock limit is
+   * reached.
+   */
+  template <typename T>
+  struct LockedAllocator {
+    using value_type = T;
+
+    LockedAllocator() = default;
+    template <typename U>
+    LockedAllocator(const LockedAllocator<U> &) {}
+
+    T *allocate(size_t n) {
+      auto ptr{std::allocator<T>{}.allocate(n)};
+      mlock(ptr, n * sizeof(T));
+      return ptr;
+    }
+
+    void deallocate(T *ptr, size_t n) {
+      auto bytes{reinterpret_cast<volatile uint8_t *>(ptr)};
+      for (size_t i{0}; i < n * sizeof(T); ++i) {
+        bytes[i] = 0;
+      }
+      munlock(ptr, n * sizeof(T));
+      std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+    template <typename U>
+    bool operator==(const LockedAllocator<U> &) const {
+      return true;
+    }
+    template <typename U>
+    bool operator!=(const LockedAllocator<U> &) const {
+      return false;
+    }
+  };
+
+  /**
+   * Validated private keys kept in locked memory for limited time.
+   * Entries are split between shards by address, each shard has own lock,
+   * so lookups for different keys don't contend.
+   */
+  class KeyCache {
+   public:
+    using Clock = std::chrono::steady_clock;
+    using TPrivateKey = KeyStore::TPrivateKey;
+
+    /// Zero ttl disables cache
+    explicit KeyCache(std::chrono::seconds ttl, size_t shards = 16)
+        : ttl_{ttl}, shards_(std::max<size_t>(shards, 1)) {}
+
+    boost::optional<TPrivateKey> get(const Address &address) {
+      if (ttl_.count() == 0) {
+        return boost::none;
+      }
+      auto &shard{shardOf(address)};
+      std::lock_guard lock{shard.mutex};
+      auto it{shard.keys.find(address)};
+      if (it == shard.keys.end()) {
+        return boost::none;
+      }
+      if (it->second.expires <= Clock::now()) {
+        shard.keys.erase(it);
+        return boost::none;
+      }
+      return it->second.key;
+    }
+
+    void put(const Address &address, const TPrivateKey &key) {
+      if (ttl_.count() == 0) {
+        return;
+      }
+      auto &shard{shardOf(address)};
+      std::lock_guard lock{shard.mutex};
+      shard.keys.insert_or_assign(address, Entry{key, Clock::now() + ttl_});
+    }
+
+    void remove(const Address &address) {
+      auto &shard{shardOf(address)};
+      std::lock_guard lock{shard.mutex};
+      shard.keys.erase(address);
+    }
+
+   private:
+    struct Entry {
+      TPrivateKey key;
+      Clock::time_point expires;
+    };
+    using Map = std::map<Address,
+                         Entry,
+                         std::less<>,
+                         LockedAllocator<std::pair<const Address, Entry>>>;
+    struct Shard {
+      std::mutex mutex;
+      Map keys;
+    };
+
+    Shard &shardOf(const Address &address) {
+      auto bytes{primitives::address::encode(address)};
+      return shards_[boost::hash_range(bytes.begin(), bytes.end())
+                     % shards_.size()];
+    }
+
+    std::chrono::seconds ttl_;
+    std::vector<Shard> shards_;
+  };
+}  // namespace fc::storage::keystore
@@ -43,12 +43,37 @@ namespace fc::storage::keystore {
     return KeyStoreError::kWrongAddress;
   }
 
-  fc::outcome::result<Signature> KeyStore::sign(
-      const Address &address, gsl::span<const uint8_t> data) noexcept {
+  fc::outcome::result<KeyStore::TPrivateKey> KeyStore::getChecked(
+      const Address &address) const noexcept {
     OUTCOME_TRY(private_key, get(address));
     OUTCOME_TRY(valid, checkAddress(address, private_key));
     if (!valid) return KeyStoreError::kWrongAddress;
+    return std::move(private_key);
+  }
+
+  fc::outcome::result<Signature> KeyStore::sign(
+      const Address &address, gsl::span<const uint8_t> data) noexcept {
+    OUTCOME_TRY(private_key, getChecked(address));
+    return signWith(address, private_key, data);
+  }
+
+  fc::outcome::result<std::vector<Signature>> KeyStore::signMany(
+      const Address &address,
+      const std::vector<gsl::span<const uint8_t>> &messages) noexcept {
+    OUTCOME_TRY(private_key, getChecked(address));
+    std::vector<Signature> signatures;
+    signatures.reserve(messages.size());
+    for (auto &message : messages) {
+      OUTCOME_TRY(signature, signWith(address, private_key, message));
+      signatures.push_back(std::move(signature));
+    }
+    return std::move(signatures);
+  }
 
+  fc::outcome::result<Signature> KeyStore::signWith(
+      const Address &address,
+      const TPrivateKey &private_key,
+      gsl::span<const uint8_t> data) const noexcept {
     if (address.getProtocol() == Protocol::BLS) {
       OUTCOME_TRY(
           signature,
@@ -80,6 +80,17 @@ namespace fc::storage::keystore {
     virtual outcome::result<Signature> sign(
         const Address &address, gsl::span<const uint8_t> data) noexcept;
 
+    /**
+     * @brief Sign several messages with one private key, key is loaded and
+     * checked once
+     * @param address of private key stored
+     * @param messages to sign
+     * @return signatures in order of messages
+     */
+    virtual outcome::result<std::vector<Signature>> signMany(
+        const Address &address,
+        const std::vector<gsl::span<const uint8_t>> &messages) noexcept;
+
     /**
      * @brief verify signature
      * @param address - pubkey address
@@ -111,7 +122,21 @@ namespace fc::storage::keystore {
     virtual outcome::result<TPrivateKey> get(const Address &address) const
         noexcept = 0;
 
+    /**
+     * @brief Get private key by address and check it matches address
+     * @param address
+     * @return private key
+     */
+    virtual outcome::result<TPrivateKey> getChecked(
+        const Address &address) const noexcept;
+
    private:
+    outcome::result<Signature> signWith(const Address &address,
+                                        const TPrivateKey &private_key,
+                                        gsl::span<const uint8_t> data) const
+        noexcept;
+
+
     std::shared_ptr<BlsProvider> bls_provider_;
     std::shared_ptr<Secp256k1ProviderDefault> secp256k1_provider_;
   };
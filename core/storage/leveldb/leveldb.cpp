@@ -7,6 +7,7 @@
 
 #include <utility>
 
+#include "common/metrics.hpp"
 #include "storage/leveldb/leveldb_batch.hpp"
 #include "storage/leveldb/leveldb_cursor.hpp"
 #include "storage/leveldb/leveldb_util.hpp"
@@ -26,6 +27,28 @@ namespace fc::storage {
     return error_as_result<std::shared_ptr<LevelDB>>(status);
   }
 
+  outcome::result<std::shared_ptr<LevelDB>> LevelDB::create(
+      std::string_view path, leveldb::Options options, const Tuning &tuning) {
+    std::unique_ptr<leveldb::Cache> block_cache;
+    if (tuning.block_cache_bytes != 0) {
+      block_cache.reset(leveldb::NewLRUCache(tuning.block_cache_bytes));
+    }
+    std::unique_ptr<const leveldb::FilterPolicy> filter_policy;
+    if (tuning.bloom_bits_per_key != 0) {
+      filter_policy.reset(
+          leveldb::NewBloomFilterPolicy(tuning.bloom_bits_per_key));
+    }
+    options.block_cache = block_cache.get();
+    options.filter_policy = filter_policy.get();
+    options.write_buffer_size = tuning.write_buffer_bytes;
+    options.compression = tuning.compression ? leveldb::kSnappyCompression
+                                             : leveldb::kNoCompression;
+    OUTCOME_TRY(db, create(path, options));
+    db->block_cache_ = std::move(block_cache);
+    db->filter_policy_ = std::move(filter_policy);
+    return std::move(db);
+  }
+
   outcome::result<std::shared_ptr<LevelDB>> LevelDB::create(
       std::string_view path) {
     leveldb::Options options;
@@ -33,11 +56,61 @@ namespace fc::storage {
     return create(path, options);
   }
 
+  boost::optional<std::string> LevelDB::getProperty(
+      std::string_view name) const {
+    std::string value;
+    if (db_->GetProperty(leveldb::Slice{name.data(), name.size()}, &value)) {
+      return value;
+    }
+    return boost::none;
+  }
+
   std::unique_ptr<BufferMapCursor> LevelDB::cursor() {
     auto it = std::unique_ptr<leveldb::Iterator>(db_->NewIterator(ro_));
     return std::make_unique<Cursor>(std::move(it));
   }
 
+  LevelDB::SnapshotPtr LevelDB::snapshot() const {
+    return std::make_shared<Snapshot>(*db_, db_->GetSnapshot());
+  }
+
+  std::unique_ptr<BufferMapCursor> LevelDB::cursor(const SnapshotPtr &snapshot,
+                                                   bool fill_cache) const {
+    auto ro{readOptions(snapshot)};
+    ro.fill_cache = fill_cache;
+    return std::make_unique<Cursor>(
+        std::unique_ptr<leveldb::Iterator>(db_->NewIterator(ro)));
+  }
+
+  outcome::result<LevelDB::Entries> LevelDB::scan(
+      BytesIn prefix,
+      BytesIn from,
+      size_t limit,
+      const SnapshotPtr &snapshot) const {
+    auto ro{readOptions(snapshot)};
+    ro.fill_cache = false;
+    std::unique_ptr<leveldb::Iterator> it{db_->NewIterator(ro)};
+    Buffer prefix_key{prefix};
+    auto start{prefix_key};
+    start.put(from);
+    Entries entries;
+    for (it->Seek(make_slice(start)); it->Valid(); it->Next()) {
+      auto key{it->key()};
+      if (!key.starts_with(make_slice(prefix_key))) {
+        break;
+      }
+      key.remove_prefix(prefix.size());
+      entries.emplace_back(make_buffer(key), make_buffer(it->value()));
+      if (entries.size() == limit) {
+        break;
+      }
+    }
+    if (!it->status().ok()) {
+      return error_as_result<Entries>(it->status(), logger_);
+    }
+    return entries;
+  }
+
   std::unique_ptr<BufferBatch> LevelDB::batch() {
     return std::make_unique<Batch>(*this);
   }
@@ -51,6 +124,9 @@ namespace fc::storage {
   }
 
   outcome::result<Buffer> LevelDB::get(const Buffer &key) const {
+    static auto &latency{common::metrics::histogram(
+        "fc_leveldb_get_seconds", "Leveldb get latency")};
+    common::metrics::Timer timer{latency};
     std::string value;
     auto status = db_->Get(ro_, make_slice(key), &value);
     if (status.ok()) {
@@ -61,6 +137,22 @@ namespace fc::storage {
     return error_as_result<Buffer>(status, logger_);
   }
 
+  outcome::result<Buffer> LevelDB::get(const Buffer &key,
+                                       const SnapshotPtr &snapshot) const {
+    std::string value;
+    auto status = db_->Get(readOptions(snapshot), make_slice(key), &value);
+    if (status.ok()) {
+      return Buffer{}.put(value);
+    }
+    return error_as_result<Buffer>(status, logger_);
+  }
+
+  bool LevelDB::contains(const Buffer &key,
+                         const SnapshotPtr &snapshot) const {
+    std::string value;
+    return db_->Get(readOptions(snapshot), make_slice(key), &value).ok();
+  }
+
   bool LevelDB::contains(const Buffer &key) const {
     // here we interpret all kinds of errors as "not found".
     // is there a better way?
@@ -69,6 +161,9 @@ namespace fc::storage {
   }
 
   outcome::result<void> LevelDB::put(const Buffer &key, const Buffer &value) {
+    static auto &latency{common::metrics::histogram(
+        "fc_leveldb_put_seconds", "Leveldb put latency")};
+    common::metrics::Timer timer{latency};
     auto status = db_->Put(wo_, make_slice(key), make_slice(value));
     if (status.ok()) {
       return outcome::success();
@@ -82,6 +177,15 @@ namespace fc::storage {
     return put(key, copy);
   }
 
+  leveldb::ReadOptions LevelDB::readOptions(
+      const SnapshotPtr &snapshot) const {
+    auto ro{ro_};
+    if (snapshot) {
+      ro.snapshot = snapshot->snapshot_;
+    }
+    return ro;
+  }
+
   outcome::result<void> LevelDB::remove(const Buffer &key) {
     auto status = db_->Delete(wo_, make_slice(key));
     if (status.ok()) {
@@ -6,7 +6,10 @@
 #ifndef CPP_FILECOIN_LEVELDB_HPP
 #define CPP_FILECOIN_LEVELDB_HPP
 
+#include <boost/optional.hpp>
+#include <leveldb/cache.h>
 #include <leveldb/db.h>
+#include <leveldb/filter_policy.h>
 #include <leveldb/write_batch.h>
 #include "common/logger.hpp"
 #include "storage/buffer_map.hpp"
@@ -22,6 +25,45 @@ namespace fc::storage {
     class Batch;
     class Cursor;
 
+    /**
+     * Consistent read view of database at time of creation.
+     * Must not outlive database.
+     */
+    class Snapshot {
+     public:
+      Snapshot(leveldb::DB &db, const leveldb::Snapshot *snapshot)
+          : db_{db}, snapshot_{snapshot} {}
+      Snapshot(const Snapshot &) = delete;
+      Snapshot &operator=(const Snapshot &) = delete;
+      ~Snapshot() {
+        db_.ReleaseSnapshot(snapshot_);
+      }
+
+     private:
+      friend class LevelDB;
+
+      leveldb::DB &db_;
+      const leveldb::Snapshot *snapshot_;
+    };
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+    using Entries = std::vector<std::pair<Buffer, Buffer>>;
+
+    /**
+     * @brief Tuning applied on top of leveldb options.
+     * Keys are random CIDs, so bloom filter makes negative lookups nearly
+     * free, and block cache keeps hot SST blocks resident.
+     */
+    struct Tuning {
+      /// LRU block cache size, 0 for leveldb default
+      size_t block_cache_bytes{64 << 20};
+      /// Bloom filter bits per key, 0 disables filter
+      int bloom_bits_per_key{10};
+      /// Memtable size before it is written to SST
+      size_t write_buffer_bytes{16 << 20};
+      /// Use snappy compression
+      bool compression{true};
+    };
+
     ~LevelDB() override = default;
 
     /**
@@ -32,9 +74,28 @@ namespace fc::storage {
      */
     static outcome::result<std::shared_ptr<LevelDB>> create(
         std::string_view path, leveldb::Options options);
+    /**
+     * @brief Factory method to create an instance of LevelDB class with
+     * block cache and filter policy owned by instance.
+     * @param path filesystem path where database is going to be
+     * @param options leveldb options, tuned fields are overwritten
+     * @param tuning cache, filter, write buffer and compression settings
+     * @return instance of LevelDB
+     */
+    static outcome::result<std::shared_ptr<LevelDB>> create(
+        std::string_view path, leveldb::Options options, const Tuning &tuning);
+    /// Create if missing with leveldb default options, without tuning
     static outcome::result<std::shared_ptr<LevelDB>> create(
         std::string_view path);
 
+    /**
+     * @brief Get leveldb property, e.g. "leveldb.stats" or
+     * "leveldb.approximate-memory-usage"
+     * @param name property name
+     * @return property value or none if property is unknown
+     */
+    boost::optional<std::string> getProperty(std::string_view name) const;
+
     /**
      * @brief Set read options, which are used in @see LevelDB#get
      * @param ro options
@@ -49,12 +110,41 @@ namespace fc::storage {
 
     std::unique_ptr<BufferMapCursor> cursor() override;
 
+    /// Take consistent read view, passed to get, contains, cursor and scan
+    SnapshotPtr snapshot() const;
+
+    /**
+     * Cursor reading snapshot, or latest state if snapshot is null.
+     * Bulk iteration should disable fill_cache, so it doesn't evict hot
+     * blocks from block cache.
+     */
+    std::unique_ptr<BufferMapCursor> cursor(const SnapshotPtr &snapshot,
+                                            bool fill_cache = true) const;
+
+    /**
+     * Read keys with prefix in order, without filling block cache.
+     * @param prefix of keys, stripped from returned keys
+     * @param from first key suffix after prefix, inclusive
+     * @param limit max entries, 0 for no limit
+     * @param snapshot view to read, latest state if null
+     * @return keys without prefix and values
+     */
+    outcome::result<Entries> scan(BytesIn prefix,
+                                  BytesIn from = {},
+                                  size_t limit = 0,
+                                  const SnapshotPtr &snapshot = nullptr) const;
+
     std::unique_ptr<BufferBatch> batch() override;
 
     outcome::result<Buffer> get(const Buffer &key) const override;
 
     bool contains(const Buffer &key) const override;
 
+    outcome::result<Buffer> get(const Buffer &key,
+                                const SnapshotPtr &snapshot) const;
+
+    bool contains(const Buffer &key, const SnapshotPtr &snapshot) const;
+
     outcome::result<void> put(const Buffer &key, const Buffer &value) override;
 
     // value will be copied, not moved, due to internal structure of LevelDB
@@ -63,6 +153,11 @@ namespace fc::storage {
     outcome::result<void> remove(const Buffer &key) override;
 
    private:
+    leveldb::ReadOptions readOptions(const SnapshotPtr &snapshot) const;
+
+    // must outlive db
+    std::unique_ptr<leveldb::Cache> block_cache_;
+    std::unique_ptr<const leveldb::FilterPolicy> filter_policy_;
     std::unique_ptr<leveldb::DB> db_;
     leveldb::ReadOptions ro_;
     leveldb::WriteOptions wo_;
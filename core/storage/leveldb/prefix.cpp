@@ -51,6 +51,54 @@ namespace fc::storage {
     return cursor->value();
   }
 
+  MapPrefix::Batch::Batch(MapPrefix &map) : map{map} {}
+
+  outcome::result<void> MapPrefix::Batch::put(const Buffer &key,
+                                              const Buffer &value) {
+    ops.emplace_back(map._key(key), value);
+    return outcome::success();
+  }
+
+  outcome::result<void> MapPrefix::Batch::put(const Buffer &key,
+                                              Buffer &&value) {
+    ops.emplace_back(map._key(key), std::move(value));
+    return outcome::success();
+  }
+
+  outcome::result<void> MapPrefix::Batch::remove(const Buffer &key) {
+    ops.emplace_back(map._key(key), boost::none);
+    return outcome::success();
+  }
+
+  outcome::result<void> MapPrefix::Batch::commit() {
+    auto persistent{std::dynamic_pointer_cast<PersistentBufferMap>(map.map)};
+    if (persistent) {
+      auto batch{persistent->batch()};
+      for (auto &[key, value] : ops) {
+        if (value) {
+          OUTCOME_TRY(batch->put(key, std::move(*value)));
+        } else {
+          OUTCOME_TRY(batch->remove(key));
+        }
+      }
+      OUTCOME_TRY(batch->commit());
+    } else {
+      for (auto &[key, value] : ops) {
+        if (value) {
+          OUTCOME_TRY(map.map->put(key, std::move(*value)));
+        } else {
+          OUTCOME_TRY(map.map->remove(key));
+        }
+      }
+    }
+    ops.clear();
+    return outcome::success();
+  }
+
+  void MapPrefix::Batch::clear() {
+    ops.clear();
+  }
+
   MapPrefix::MapPrefix(BytesIn prefix, std::shared_ptr<BufferMap> map)
       : prefix{prefix}, map{map} {}
 
@@ -82,7 +130,7 @@ namespace fc::storage {
   }
 
   std::unique_ptr<BufferBatch> MapPrefix::batch() {
-    throw "not implemented";
+    return std::make_unique<Batch>(*this);
   }
 
   std::unique_ptr<BufferMapCursor> MapPrefix::cursor() {
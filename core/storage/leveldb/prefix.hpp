@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+
 #include "storage/buffer_map.hpp"
 
 namespace fc::storage {
@@ -25,6 +27,25 @@ namespace fc::storage {
       std::unique_ptr<BufferMapCursor> cursor;
     };
 
+    /**
+     * Writes prefixed keys with batch of underlying map if it is persistent,
+     * otherwise one by one on commit.
+     */
+    struct Batch : BufferBatch {
+      explicit Batch(MapPrefix &map);
+
+      outcome::result<void> put(const Buffer &key,
+                                const Buffer &value) override;
+      outcome::result<void> put(const Buffer &key, Buffer &&value) override;
+      outcome::result<void> remove(const Buffer &key) override;
+      outcome::result<void> commit() override;
+      void clear() override;
+
+      MapPrefix &map;
+      /// none value means removal
+      std::vector<std::pair<Buffer, boost::optional<Buffer>>> ops;
+    };
+
     MapPrefix(BytesIn prefix, std::shared_ptr<BufferMap> map);
     MapPrefix(std::string_view prefix, std::shared_ptr<BufferMap> map);
     Buffer _key(BytesIn key) const;
@@ -0,0 +1,47 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/mpool/gas_estimation.hpp"
+
+#include <algorithm>
+
+namespace fc::storage::mpool {
+  TokenAmount medianPremium(std::vector<PremiumSample> samples,
+                            size_t blocks) {
+    std::sort(samples.begin(), samples.end(), [](auto &l, auto &r) {
+      return l.premium > r.premium;
+    });
+    auto at{static_cast<BigInt>(kBlockGasTarget) * blocks / 2};
+    TokenAmount premium;
+    for (auto &sample : samples) {
+      at -= sample.gas_limit;
+      premium = sample.premium;
+      if (at < 0) {
+        break;
+      }
+    }
+    return std::max<TokenAmount>(premium, kMinGasPremium);
+  }
+
+  TokenAmount estimateFeeCap(const TokenAmount &base_fee,
+                             const TokenAmount &premium) {
+    auto fee_cap{base_fee};
+    for (auto i{0}; i < kFeeCapBlocks; ++i) {
+      fee_cap += fee_cap / kBaseFeeMaxChangeDenom;
+    }
+    return fee_cap + premium;
+  }
+
+  void capGasFee(UnsignedMessage &message, const TokenAmount &max_fee) {
+    if (message.gas_limit <= 0) {
+      return;
+    }
+    if (message.gas_fee_cap * message.gas_limit > max_fee) {
+      message.gas_fee_cap = max_fee / message.gas_limit;
+      message.gas_premium =
+          std::min(message.gas_premium, message.gas_fee_cap);
+    }
+  }
+}  // namespace fc::storage::mpool
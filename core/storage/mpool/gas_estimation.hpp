@@ -0,0 +1,42 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "const.hpp"
+#include "vm/message/message.hpp"
+
+namespace fc::storage::mpool {
+  using primitives::GasAmount;
+  using primitives::TokenAmount;
+  using vm::message::UnsignedMessage;
+
+  /// Premium doesn't go below, so message is still accepted by other nodes
+  constexpr auto kMinGasPremium{100000};
+  /// Fee cap covers base fee growth for that many full blocks
+  constexpr auto kFeeCapBlocks{20};
+  /// Premium is estimated on that many recent tipsets
+  constexpr size_t kPremiumTipsets{20};
+
+  /// Premium and gas limit of included message
+  struct PremiumSample {
+    TokenAmount premium;
+    GasAmount gas_limit{};
+  };
+
+  /**
+   * Premium of message at half of target gas of given blocks, when samples
+   * are ordered by decreasing premium, so estimated message would be in top
+   * half of recent blocks.
+   */
+  TokenAmount medianPremium(std::vector<PremiumSample> samples, size_t blocks);
+
+  /// Fee cap which covers base fee after `kFeeCapBlocks` full blocks
+  TokenAmount estimateFeeCap(const TokenAmount &base_fee,
+                             const TokenAmount &premium);
+
+  /// Lower fee cap and premium, so message doesn't spend more than max fee
+  void capGasFee(UnsignedMessage &message, const TokenAmount &max_fee);
+}  // namespace fc::storage::mpool
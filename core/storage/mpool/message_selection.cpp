@@ -0,0 +1,118 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/mpool/message_selection.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace fc::storage::mpool {
+  /// Higher perf first, chains of one sender in nonce order
+  inline bool before(const MessageChain &lhs, const MessageChain &rhs) {
+    if (lhs.perf != rhs.perf) {
+      return lhs.perf > rhs.perf;
+    }
+    if (lhs.sender != rhs.sender) {
+      return lhs.sender < rhs.sender;
+    }
+    return lhs.begin < rhs.begin;
+  }
+
+  inline void updatePerf(MessageChain &chain) {
+    chain.perf =
+        chain.gas > 0 ? chain.reward.convert_to<double>() / chain.gas : 0;
+  }
+
+  BigInt gasReward(const SignedMessage &message, const BigInt &base_fee) {
+    auto &msg{message.message};
+    auto premium{std::min<BigInt>(msg.gas_premium, msg.gas_fee_cap - base_fee)};
+    return premium * msg.gas_limit;
+  }
+
+  std::vector<MessageChain> messageChains(
+      const std::vector<SenderMessages> &senders, const BigInt &base_fee) {
+    std::vector<MessageChain> chains;
+    for (auto sender{0u}; sender < senders.size(); ++sender) {
+      auto &messages{senders[sender]};
+      auto first{chains.size()};
+      for (auto i{0u}; i < messages.size(); ++i) {
+        auto &msg{messages[i]->message};
+        if (msg.gas_limit <= 0 || msg.gas_limit > kBlockGasLimit) {
+          break;
+        }
+        MessageChain chain{
+            sender, i, i + 1, msg.gas_limit, gasReward(*messages[i], base_fee)};
+        updatePerf(chain);
+        while (chains.size() > first && chains.back().perf < chain.perf) {
+          auto &prev{chains.back()};
+          chain.begin = prev.begin;
+          chain.gas += prev.gas;
+          chain.reward += prev.reward;
+          updatePerf(chain);
+          chains.pop_back();
+        }
+        chains.push_back(std::move(chain));
+      }
+    }
+    return chains;
+  }
+
+  std::vector<SignedMessage> selectMessages(
+      const std::vector<SenderMessages> &senders,
+      const BigInt &base_fee,
+      GasAmount gas_limit,
+      size_t message_limit) {
+    auto chains{messageChains(senders, base_fee)};
+    std::sort(chains.begin(), chains.end(), before);
+    // messages of sender after cut were dropped with trimmed chain
+    std::vector<size_t> cut(senders.size(), SIZE_MAX);
+    std::vector<MessageChain> selected;
+    for (size_t i{0}; i < chains.size() && message_limit != 0;) {
+      auto &chain{chains[i]};
+      if (chain.perf < 0) {
+        break;
+      }
+      if (chain.end > cut[chain.sender]) {
+        ++i;
+        continue;
+      }
+      auto count{chain.end - chain.begin};
+      if (chain.gas <= gas_limit && count <= message_limit) {
+        gas_limit -= chain.gas;
+        message_limit -= count;
+        selected.push_back(chain);
+        ++i;
+        continue;
+      }
+      auto &messages{senders[chain.sender]};
+      while (chain.end != chain.begin
+             && (chain.gas > gas_limit
+                 || chain.end - chain.begin > message_limit)) {
+        --chain.end;
+        auto &message{*messages[chain.end]};
+        chain.gas -= message.message.gas_limit;
+        chain.reward -= gasReward(message, base_fee);
+      }
+      cut[chain.sender] = chain.end;
+      if (chain.end == chain.begin) {
+        ++i;
+        continue;
+      }
+      updatePerf(chain);
+      auto next{chains.begin() + i + 1};
+      std::rotate(chains.begin() + i,
+                  next,
+                  std::upper_bound(next, chains.end(), chain, before));
+    }
+    std::vector<SignedMessage> result;
+    for (auto &chain : selected) {
+      auto &messages{senders[chain.sender]};
+      for (auto i{chain.begin}; i < chain.end; ++i) {
+        result.push_back(*messages[i]);
+      }
+    }
+    return result;
+  }
+}  // namespace fc::storage::mpool
@@ -0,0 +1,53 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "const.hpp"
+#include "vm/message/message.hpp"
+
+namespace fc::storage::mpool {
+  using primitives::GasAmount;
+  using vm::message::SignedMessage;
+
+  /// Messages of one sender with consecutive nonces, starting at state nonce
+  using SenderMessages = std::vector<const SignedMessage *>;
+
+  /**
+   * Part of sender messages which is included as whole.
+   * Tail with better premium is merged into previous chain, because it can't
+   * be included without it, so chains of one sender have decreasing perf.
+   */
+  struct MessageChain {
+    size_t sender{};
+    size_t begin{}, end{};
+    GasAmount gas{};
+    BigInt reward;
+    double perf{};
+  };
+
+  /// Miner reward for including message with given base fee
+  BigInt gasReward(const SignedMessage &message, const BigInt &base_fee);
+
+  /**
+   * Split sender messages into chains ordered by decreasing gas perf
+   * (reward per gas unit)
+   */
+  std::vector<MessageChain> messageChains(
+      const std::vector<SenderMessages> &senders, const BigInt &base_fee);
+
+  /**
+   * Select messages for block.
+   * Chains are taken greedily by gas perf. Chain which doesn't fit is trimmed
+   * to remaining gas, later chains of its sender are dropped, and trimmed
+   * chain is queued again by its new perf.
+   * Messages of each sender are returned in nonce order.
+   */
+  std::vector<SignedMessage> selectMessages(
+      const std::vector<SenderMessages> &senders,
+      const BigInt &base_fee,
+      GasAmount gas_limit = kBlockGasLimit,
+      size_t message_limit = kBlockMessageLimit);
+}  // namespace fc::storage::mpool
@@ -4,26 +4,61 @@
  */
 
 #include "storage/mpool/mpool.hpp"
+
+#include <queue>
+
 #include "common/logger.hpp"
 #include "const.hpp"
+#include "primitives/address/address_codec.hpp"
+#include "storage/mpool/message_selection.hpp"
 #include "vm/interpreter/interpreter.hpp"
+#include "vm/message/message_view.hpp"
 #include "vm/runtime/env.hpp"
 #include "vm/runtime/impl/tipset_randomness.hpp"
-#include "vm/state/impl/state_tree_impl.hpp"
+#include "storage/hamt/node_cache.hpp"
+#include "vm/state/impl/overlay_state_tree.hpp"
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::mpool, MpoolError, e) {
+  using fc::storage::mpool::MpoolError;
+  switch (e) {
+    case MpoolError::kTooManyPending:
+      return "Too many pending messages from sender";
+  }
+  return "Unknown error";
+}
 
 namespace fc::storage::mpool {
   using primitives::block::MsgMeta;
   using primitives::tipset::HeadChangeType;
   using vm::message::UnsignedMessage;
   using vm::runtime::TipsetRandomness;
+  using vm::state::OverlayStateTree;
+
+  /// Sender and big endian nonce, so replaced message overwrites old one
+  Buffer persistKey(const Address &from, uint64_t nonce) {
+    Buffer key{primitives::address::encode(from)};
+    key.putUint64(nonce);
+    return key;
+  }
 
   std::shared_ptr<Mpool> Mpool::create(
       IpldPtr ipld,
       std::shared_ptr<Interpreter> interpreter,
-      std::shared_ptr<ChainStore> chain_store) {
+      std::shared_ptr<ChainStore> chain_store,
+      std::shared_ptr<NodeCache> hamt_cache,
+      std::shared_ptr<TipsetCache> tipset_cache,
+      MpoolConfig config,
+      std::shared_ptr<PersistentBufferMap> store) {
     auto mpool{std::make_shared<Mpool>()};
+    mpool->config = config;
+    mpool->bls_cache.setMaxWeight(config.bls_cache);
+    mpool->store = std::move(store);
     mpool->ipld = std::move(ipld);
     mpool->interpreter = std::move(interpreter);
+    mpool->hamt_cache =
+        hamt_cache ? std::move(hamt_cache) : std::make_shared<NodeCache>();
+    mpool->tipset_cache = tipset_cache ? std::move(tipset_cache)
+                                       : std::make_shared<TipsetCache>();
     mpool->head_sub = chain_store->subscribeHeadChanges([=](auto &change) {
       auto res{mpool->onHeadChange(change)};
       if (!res) {
@@ -35,20 +70,82 @@ namespace fc::storage::mpool {
     return mpool;
   }
 
+  outcome::result<std::vector<SignedMessage>> Mpool::loadPersisted(
+      PersistentBufferMap &store) {
+    std::vector<SignedMessage> messages;
+    auto cursor{store.cursor()};
+    for (cursor->seekToFirst(); cursor->isValid(); cursor->next()) {
+      OUTCOME_TRY(message,
+                  codec::cbor::decode<SignedMessage>(cursor->value()));
+      messages.push_back(std::move(message));
+    }
+    return messages;
+  }
+
   std::vector<SignedMessage> Mpool::pending() const {
     std::vector<SignedMessage> messages;
     for (auto &[addr, pending] : by_from) {
       for (auto &[nonce, message] : pending.by_nonce) {
-        messages.push_back(message);
+        messages.push_back(message.message);
       }
     }
     return messages;
   }
 
+  outcome::result<std::vector<SignedMessage>> Mpool::select(
+      const TipsetCPtr &ts) const {
+    auto is_head{head && ts->key == head->key};
+    boost::optional<vm::state::StateTreeImpl> tree;
+    if (!is_head) {
+      OUTCOME_TRY(interpeted, interpreter->interpret(ipld, ts));
+      tree.emplace(ipld, interpeted.state_root, hamt_cache);
+    }
+    OUTCOME_TRY(base_fee, ts->nextBaseFee(ipld));
+    std::vector<SenderMessages> senders;
+    for (auto &[from, pending] : by_from) {
+      auto _actor{is_head ? actor(from) : tree->get(from)};
+      if (!_actor) {
+        continue;
+      }
+      SenderMessages messages;
+      auto nonce{_actor.value().nonce};
+      for (auto it{pending.by_nonce.find(nonce)};
+           it != pending.by_nonce.end() && it->first == nonce;
+           ++it, ++nonce) {
+        messages.push_back(&it->second.message);
+      }
+      if (!messages.empty()) {
+        senders.push_back(std::move(messages));
+      }
+    }
+    return selectMessages(senders, base_fee);
+  }
+
+  outcome::result<std::reference_wrapper<Mpool::HeadState>> Mpool::headState()
+      const {
+    if (!head_state) {
+      OUTCOME_TRY(interpeted, interpreter->interpret(ipld, head));
+      head_state = HeadState{interpeted.state_root, {}};
+    }
+    return *head_state;
+  }
+
+  outcome::result<Actor> Mpool::actor(const Address &address) const {
+    OUTCOME_TRY(state, headState());
+    auto &actors{state.get().actors};
+    auto it{actors.find(address)};
+    if (it == actors.end()) {
+      OUTCOME_TRY(
+          actor,
+          vm::state::StateTreeImpl{ipld, state.get().state_root, hamt_cache}
+              .get(address));
+      it = actors.emplace(address, actor).first;
+    }
+    return it->second;
+  }
+
   outcome::result<uint64_t> Mpool::nonce(const Address &from) const {
-    OUTCOME_TRY(interpeted, interpreter->interpret(ipld, head));
-    OUTCOME_TRY(
-        actor, vm::state::StateTreeImpl{ipld, interpeted.state_root}.get(from));
+    OUTCOME_TRY(actor, this->actor(from));
     auto by_from_it{by_from.find(from)};
     if (by_from_it != by_from.end() && by_from_it->second.nonce > actor.nonce) {
       return by_from_it->second.nonce;
@@ -56,27 +153,85 @@ namespace fc::storage::mpool {
     return actor.nonce;
   }
 
-  outcome::result<void> Mpool::estimate(UnsignedMessage &message) const {
+  outcome::result<Mpool::HeadState::Prefix> Mpool::prefix(
+      const Address &from) const {
+    OUTCOME_TRY(state, headState());
+    auto &prefixes{state.get().prefixes};
+    auto it{prefixes.find(from)};
+    if (it == prefixes.end()) {
+      HeadState::Prefix prefix{ipld, state.get().state_root};
+      auto _pending{by_from.find(from)};
+      if (_pending != by_from.end()) {
+        auto env{estimateEnv(ipld, prefix.state_root)};
+        for (auto &_msg : _pending->second.by_nonce) {
+          auto &msg{_msg.second};
+          OUTCOME_TRY(
+              env->applyMessage(msg.message.message, msg.chainSize()));
+        }
+        OUTCOME_TRYA(prefix.state_root, env->state_tree->flush());
+        prefix.ipld = env->ipld;
+      }
+      it = prefixes.emplace(from, std::move(prefix)).first;
+    }
+    return it->second;
+  }
+
+  std::shared_ptr<vm::runtime::Env> Mpool::estimateEnv(IpldPtr base,
+                                                       const CID &root) const {
+    auto randomness = std::make_shared<TipsetRandomness>(ipld, head);
+    auto state_tree{
+        std::make_shared<OverlayStateTree>(std::move(base), root, hamt_cache)};
+    auto env{std::make_shared<vm::runtime::Env>(
+        nullptr, randomness, state_tree->getStore(), head, hamt_cache)};
+    env->state_tree = state_tree;
+    ++env->epoch;
+    return env;
+  }
+
+  outcome::result<TokenAmount> Mpool::baseFee() const {
+    if (!base_fee) {
+      OUTCOME_TRYA(base_fee, head->nextBaseFee(ipld));
+    }
+    return *base_fee;
+  }
+
+  outcome::result<TokenAmount> Mpool::gasPremium() const {
+    if (!premium) {
+      std::vector<PremiumSample> samples;
+      size_t blocks{};
+      for (auto &entry : fee_history) {
+        if (!entry.samples) {
+          std::vector<PremiumSample> loaded;
+          OUTCOME_TRY(entry.tipset->visitMessages(
+              ipld, [&](auto, auto, auto &cid) -> outcome::result<void> {
+                OUTCOME_TRY(bytes, ipld->get(cid));
+                OUTCOME_TRY(view, vm::message::MessageView::make(bytes));
+                OUTCOME_TRY(message, view.decode());
+                loaded.push_back({message.gas_premium, message.gas_limit});
+                return outcome::success();
+              }));
+          entry.samples = std::move(loaded);
+        }
+        samples.insert(
+            samples.end(), entry.samples->begin(), entry.samples->end());
+        blocks += entry.tipset->blks.size();
+      }
+      premium = medianPremium(std::move(samples), blocks);
+    }
+    return *premium;
+  }
+
+  outcome::result<void> Mpool::estimate(UnsignedMessage &message,
+                                        const TokenAmount &max_fee) const {
     assert(message.from.isKeyType());
     if (message.gas_limit == 0) {
       auto msg{message};
       msg.gas_limit = kBlockGasLimit;
       msg.gas_fee_cap = kMinimumBaseFee + 1;
       msg.gas_premium = 1;
-      OUTCOME_TRY(interpeted, interpreter->interpret(ipld, head));
-      auto randomness = std::make_shared<TipsetRandomness>(ipld, head);
-      auto env{
-          std::make_shared<vm::runtime::Env>(nullptr, randomness, ipld, head)};
-      env->state_tree = std::make_shared<vm::state::StateTreeImpl>(
-          ipld, interpeted.state_root);
-      ++env->epoch;
-      auto _pending{by_from.find(msg.from)};
-      if (_pending != by_from.end()) {
-        for (auto &_msg : _pending->second.by_nonce) {
-          auto &msg{_msg.second};
-          OUTCOME_TRY(env->applyMessage(msg.message, msg.chainSize()));
-        }
-      }
+      OUTCOME_TRY(prefix, this->prefix(msg.from));
+      // pending messages are already applied to prefix state
+      auto env{estimateEnv(prefix.ipld, prefix.state_root)};
       OUTCOME_TRY(actor, env->state_tree->get(msg.from));
       msg.nonce = actor.nonce;
       OUTCOME_TRY(
@@ -93,34 +248,114 @@ namespace fc::storage::mpool {
       // TODO: paych.collect
       message.gas_limit = apply.receipt.gas_used * kGasLimitOverestimation;
     }
-    // TODO: premium
-    // TODO: fee cap
+    if (message.gas_premium == 0) {
+      OUTCOME_TRYA(message.gas_premium, gasPremium());
+    }
+    if (message.gas_fee_cap == 0) {
+      OUTCOME_TRY(base_fee, baseFee());
+      message.gas_fee_cap = estimateFeeCap(base_fee, message.gas_premium);
+    }
+    capGasFee(message, max_fee);
     return outcome::success();
   }
 
   outcome::result<void> Mpool::add(const SignedMessage &message) {
+    OUTCOME_TRY(encoded, EncodedMessage::make(message));
+    return add(std::move(encoded));
+  }
+
+  outcome::result<void> Mpool::addLocal(const SignedMessage &message) {
+    local.insert(message.message.from);
+    return add(message);
+  }
+
+  outcome::result<void> Mpool::add(EncodedMessage encoded) {
+    auto &message{encoded.message};
+    auto by_from_it{by_from.find(message.message.from)};
+    if (by_from_it != by_from.end()
+        && by_from_it->second.by_nonce.count(message.message.nonce) == 0
+        && by_from_it->second.by_nonce.size() >= config.max_per_sender) {
+      return MpoolError::kTooManyPending;
+    }
+    OUTCOME_TRY(ipld->set(encoded.cid(), Buffer{encoded.bytes()}));
+    if (encoded.signed_cid) {
+      OUTCOME_TRY(ipld->set(encoded.unsigned_cid, encoded.unsigned_bytes));
+    }
+    return insert(std::move(encoded));
+  }
+
+  outcome::result<void> Mpool::insert(EncodedMessage encoded) {
+    auto &message{encoded.message};
+    auto &msg{message.message};
+    auto &pending{by_from[msg.from]};
+    auto old{pending.by_nonce.find(msg.nonce)};
+    if (old == pending.by_nonce.end()) {
+      if (pending.by_nonce.size() >= config.max_per_sender) {
+        return MpoolError::kTooManyPending;
+      }
+      ++size;
+    } else {
+      by_cid.erase(old->second.cid());
+    }
+    auto cid{encoded.cid()};
     if (message.signature.isBls()) {
-      bls_cache.emplace(message.getCid(), message.signature);
+      bls_cache.put(cid, message.signature, 1);
+    }
+    by_cid[cid] = {msg.from, msg.nonce};
+    if (head_state) {
+      head_state->prefixes.erase(msg.from);
     }
-    OUTCOME_TRY(ipld->setCbor(message));
-    OUTCOME_TRY(ipld->setCbor(message.message));
-    auto &pending{by_from[message.message.from]};
-    if (pending.by_nonce.empty() || message.message.nonce >= pending.nonce) {
-      pending.nonce = message.message.nonce + 1;
+    if (pending.by_nonce.empty() || msg.nonce >= pending.nonce) {
+      pending.nonce = msg.nonce + 1;
+    }
+    notify({MpoolUpdate::Type::ADD, message});
+    pending.by_nonce[msg.nonce] = std::move(encoded);
+    if (!batching && size > config.max_messages) {
+      evict(&cid);
     }
-    pending.by_nonce[message.message.nonce] = message;
-    signal({MpoolUpdate::Type::ADD, message});
     return outcome::success();
   }
 
+  outcome::result<Buffer> Mpool::snapshot() const {
+    return codec::cbor::encode(pending());
+  }
+
+  outcome::result<void> Mpool::restore(BytesIn snapshot) {
+    OUTCOME_TRY(messages,
+                codec::cbor::decode<std::vector<SignedMessage>>(snapshot));
+    for (auto &message : messages) {
+      auto added{addRestored(message)};
+      if (!added && added.error() != MpoolError::kTooManyPending) {
+        return added.error();
+      }
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Mpool::addRestored(const SignedMessage &message) {
+    auto &msg{message.message};
+    if (head) {
+      auto _actor{actor(msg.from)};
+      if (_actor && msg.nonce < _actor.value().nonce) {
+        return outcome::success();
+      }
+    }
+    return add(message);
+  }
+
   void Mpool::remove(const Address &from, uint64_t nonce) {
     auto by_from_it{by_from.find(from)};
     if (by_from_it != by_from.end()) {
       auto &pending{by_from_it->second};
       auto message{pending.by_nonce.find(nonce)};
       if (message != pending.by_nonce.end()) {
-        signal({MpoolUpdate::Type::REMOVE, message->second});
+        by_cid.erase(message->second.cid());
+        if (head_state) {
+          head_state->prefixes.erase(from);
+        }
+        notify({MpoolUpdate::Type::REMOVE, std::move(message->second.message)});
         pending.by_nonce.erase(message);
+        --size;
         if (pending.by_nonce.empty()) {
           by_from.erase(by_from_it);
         } else {
@@ -130,39 +365,137 @@ namespace fc::storage::mpool {
     }
   }
 
+  void Mpool::notify(MpoolUpdate update) {
+    updates.push_back(std::move(update));
+    if (!batching) {
+      flushUpdates();
+    }
+  }
+
+  void Mpool::flushUpdates() {
+    if (store) {
+      auto batch{store->batch()};
+      auto persist{[&]() -> outcome::result<void> {
+        for (auto &update : updates) {
+          auto &msg{update.message.message};
+          auto key{persistKey(msg.from, msg.nonce)};
+          if (update.type == MpoolUpdate::Type::ADD) {
+            OUTCOME_TRY(value, codec::cbor::encode(update.message));
+            OUTCOME_TRY(batch->put(key, std::move(value)));
+          } else {
+            OUTCOME_TRY(batch->remove(key));
+          }
+        }
+        return batch->commit();
+      }};
+      auto persisted{persist()};
+      if (!persisted) {
+        spdlog::error("Mpool: persist error {} \"{}\"",
+                      persisted.error(),
+                      persisted.error().message());
+      }
+    }
+    signal(updates);
+    updates.clear();
+  }
+
+  void Mpool::evict(const CID *keep) {
+    // min heap of last messages by premium
+    using Tail = std::pair<BigInt, Address>;
+    std::priority_queue<Tail, std::vector<Tail>, std::greater<>> tails;
+    auto push{[&](const Address &from, const EncodedMessage &last) {
+      if (keep == nullptr || last.cid() != *keep) {
+        tails.emplace(last.message.message.gas_premium, from);
+      }
+    }};
+    for (auto &[from, pending] : by_from) {
+      if (local.count(from) == 0) {
+        push(from, pending.by_nonce.rbegin()->second);
+      }
+    }
+    while (size > config.low_watermark && !tails.empty()) {
+      auto from{tails.top().second};
+      tails.pop();
+      auto &by_nonce{by_from.at(from).by_nonce};
+      auto more{by_nonce.size() > 1};
+      remove(from, by_nonce.rbegin()->first);
+      if (more) {
+        push(from, by_nonce.rbegin()->second);
+      }
+    }
+  }
+
   outcome::result<void> Mpool::onHeadChange(const HeadChange &change) {
+    head_state.reset();
+    base_fee.reset();
+    premium.reset();
+    batching = true;
+    auto result{applyHeadChange(change)};
+    batching = false;
+    if (size > config.max_messages) {
+      evict();
+    }
+    if (!updates.empty()) {
+      flushUpdates();
+    }
+    return result;
+  }
+
+  outcome::result<void> Mpool::applyHeadChange(const HeadChange &change) {
     if (change.type == HeadChangeType::CURRENT) {
+      fee_history.clear();
+      fee_history.push_back({change.value, {}});
       head = change.value;
-    } else {
-      auto apply{change.type == HeadChangeType::APPLY};
+      return outcome::success();
+    }
+    if (change.type == HeadChangeType::APPLY) {
+      // only cids are needed, messages not in pool are skipped
       OUTCOME_TRY(change.value->visitMessages(
-          ipld, [&](auto, auto bls, auto &cid) -> outcome::result<void> {
-            if (bls) {
-              OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
-              if (apply) {
-                remove(message.from, message.nonce);
-              } else {
-                auto sig{bls_cache.find(cid)};
-                if (sig != bls_cache.end()) {
-                  OUTCOME_TRY(add({message, sig->second}));
-                }
-              }
-            } else {
-              OUTCOME_TRY(message, ipld->getCbor<SignedMessage>(cid));
-              if (apply) {
-                remove(message.message.from, message.message.nonce);
-              } else {
-                OUTCOME_TRY(add(message));
-              }
+          ipld, [&](auto, auto, auto &cid) -> outcome::result<void> {
+            auto it{by_cid.find(cid)};
+            if (it != by_cid.end()) {
+              auto [from, nonce]{it->second};
+              remove(from, nonce);
             }
             return outcome::success();
           }));
-      if (apply) {
-        head = change.value;
-      } else {
-        OUTCOME_TRYA(head, change.value->loadParent(*ipld));
+      fee_history.push_back({change.value, {}});
+      if (fee_history.size() > kPremiumTipsets) {
+        fee_history.pop_front();
       }
+      head = change.value;
+      return outcome::success();
+    }
+    OUTCOME_TRY(change.value->visitMessages(
+        ipld, [&](auto, auto bls, auto &cid) -> outcome::result<void> {
+          if (by_cid.count(cid) != 0) {
+            return outcome::success();
+          }
+          // messages of reverted blocks are already stored
+          if (bls) {
+            if (auto sig{bls_cache.get(cid)}) {
+              EncodedMessage encoded;
+              OUTCOME_TRYA(encoded.unsigned_bytes, ipld->get(cid));
+              OUTCOME_TRYA(encoded.message.message,
+                           codec::cbor::decode<UnsignedMessage>(
+                               encoded.unsigned_bytes));
+              encoded.message.signature = *sig;
+              encoded.unsigned_cid = cid;
+              std::ignore = insert(std::move(encoded));
+            }
+          } else {
+            OUTCOME_TRY(bytes, ipld->get(cid));
+            OUTCOME_TRY(encoded, EncodedMessage::decode(bytes));
+            // sender over limit drops message instead of failing head change
+            std::ignore = insert(std::move(encoded));
+          }
+          return outcome::success();
+        }));
+    if (!fee_history.empty()
+        && fee_history.back().tipset->key == change.value->key) {
+      fee_history.pop_back();
     }
+    OUTCOME_TRYA(head, tipset_cache->loadParent(*ipld, *change.value));
     return outcome::success();
   }
 }  // namespace fc::storage::mpool
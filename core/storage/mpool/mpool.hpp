@@ -6,9 +6,24 @@
 #ifndef CPP_FILECOIN_CORE_STORAGE_MPOOL_MPOOL_HPP
 #define CPP_FILECOIN_CORE_STORAGE_MPOOL_MPOOL_HPP
 
+#include <deque>
+#include <set>
+
+#include "common/lru_cache.hpp"
 #include "node/fwd.hpp"
+#include "primitives/cid/compact_cid.hpp"
+#include "primitives/tipset/tipset_cache.hpp"
+#include "storage/mpool/gas_estimation.hpp"
 #include "storage/chain/chain_store.hpp"
-#include "vm/message/message.hpp"
+#include "storage/buffer_map.hpp"
+#include "vm/actor/actor.hpp"
+#include "vm/message/encoded_message.hpp"
+
+namespace fc::storage::mpool {
+  enum class MpoolError { kTooManyPending = 1 };
+}  // namespace fc::storage::mpool
+
+OUTCOME_HPP_DECLARE_ERROR(fc::storage::mpool, MpoolError);
 
 namespace fc::storage::mpool {
   using crypto::signature::Signature;
@@ -17,10 +32,14 @@ namespace fc::storage::mpool {
   using primitives::tipset::Tipset;
   using storage::blockchain::ChainStore;
   using vm::interpreter::Interpreter;
+  using vm::message::EncodedMessage;
   using vm::message::SignedMessage;
   using vm::message::UnsignedMessage;
   using connection_t = boost::signals2::connection;
+  using hamt::NodeCache;
+  using primitives::tipset::TipsetCache;
   using primitives::tipset::TipsetCPtr;
+  using vm::actor::Actor;
 
   struct MpoolUpdate {
     enum class Type : int64_t { ADD, REMOVE };
@@ -29,34 +48,142 @@ namespace fc::storage::mpool {
     SignedMessage message;
   };
 
+  struct MpoolConfig {
+    /// When exceeded, messages are evicted down to low watermark
+    size_t max_messages{30000};
+    size_t low_watermark{20000};
+    /// New nonces of sender are rejected above limit
+    size_t max_per_sender{1000};
+    /// Signatures of recent bls messages, kept after inclusion for revert
+    size_t bls_cache{40000};
+  };
+
   struct Mpool : public std::enable_shared_from_this<Mpool> {
     struct Pending {
-      std::map<uint64_t, SignedMessage> by_nonce;
+      std::map<uint64_t, EncodedMessage> by_nonce;
       uint64_t nonce;
     };
-    using Subscriber = void(const MpoolUpdate &);
+    /// Updates of one head change are notified together
+    using Subscriber = void(const std::vector<MpoolUpdate> &);
 
     static std::shared_ptr<Mpool> create(
         IpldPtr ipld,
         std::shared_ptr<Interpreter> interpreter,
-        std::shared_ptr<ChainStore> chain_store);
+        std::shared_ptr<ChainStore> chain_store,
+        std::shared_ptr<NodeCache> hamt_cache = nullptr,
+        std::shared_ptr<TipsetCache> tipset_cache = nullptr,
+        MpoolConfig config = {},
+        std::shared_ptr<PersistentBufferMap> store = nullptr);
+    /**
+     * Read messages persisted by mpool with same store, so they can be
+     * revalidated (e.g. by MessageIngress on thread pool) and passed to
+     * addRestored
+     */
+    static outcome::result<std::vector<SignedMessage>> loadPersisted(
+        PersistentBufferMap &store);
     std::vector<SignedMessage> pending() const;
+    /// Select pending messages by gas premium for block on top of tipset
+    outcome::result<std::vector<SignedMessage>> select(
+        const TipsetCPtr &ts) const;
     outcome::result<uint64_t> nonce(const Address &from) const;
-    outcome::result<void> estimate(UnsignedMessage &message) const;
+    /**
+     * Fill zero gas limit, premium and fee cap of message, so it doesn't
+     * spend more than max fee. Gas limit is estimated on state after pending
+     * messages of sender, premium and fee cap on recent tipsets.
+     */
+    outcome::result<void> estimate(UnsignedMessage &message,
+                                   const TokenAmount &max_fee) const;
     outcome::result<void> add(const SignedMessage &message);
+    /// Add message pushed by node, its sender is never evicted
+    outcome::result<void> addLocal(const SignedMessage &message);
+    /// Add message encoded on receive, without encoding it again
+    outcome::result<void> add(EncodedMessage message);
     void remove(const Address &from, uint64_t nonce);
+    /// Encode pending messages, so restart doesn't wait for gossip
+    outcome::result<Buffer> snapshot() const;
+    /**
+     * Insert messages of snapshot, messages below nonce of sender at current
+     * head are skipped
+     */
+    outcome::result<void> restore(BytesIn snapshot);
+    /// Add restored message unless it is below nonce of sender at head
+    outcome::result<void> addRestored(const SignedMessage &message);
     outcome::result<void> onHeadChange(const HeadChange &change);
     connection_t subscribe(const std::function<Subscriber> &subscriber) {
       return signal.connect(subscriber);
     }
 
    private:
+    /// Interpreted state of head, shared by calls until head changes
+    struct HeadState {
+      /// State after pending messages of sender, kept in memory overlay
+      struct Prefix {
+        IpldPtr ipld;
+        CID state_root;
+      };
+
+      CID state_root;
+      std::map<Address, Actor> actors;
+      /// Dropped when pending messages of sender change
+      std::map<Address, Prefix> prefixes;
+    };
+    /// Applied tipset, with premiums of its messages loaded on first use
+    struct FeeHistory {
+      TipsetCPtr tipset;
+      boost::optional<std::vector<PremiumSample>> samples;
+    };
+
+    outcome::result<std::reference_wrapper<HeadState>> headState() const;
+    /// Actor from head state, cached
+    outcome::result<Actor> actor(const Address &address) const;
+    /// State for gas estimation of sender, cached
+    outcome::result<HeadState::Prefix> prefix(const Address &from) const;
+    /// Env on memory overlay of state, for gas estimation on top of head
+    std::shared_ptr<vm::runtime::Env> estimateEnv(IpldPtr base,
+                                                  const CID &root) const;
+    /// Base fee of next block on head, cached
+    outcome::result<TokenAmount> baseFee() const;
+    /// Median premium of recent tipsets, cached
+    outcome::result<TokenAmount> gasPremium() const;
+    /**
+     * Remove lowest premium last nonces of senders down to low watermark.
+     * Local senders and message with `keep` cid are not removed.
+     */
+    void evict(const CID *keep = nullptr);
+    /// Insert already stored message
+    outcome::result<void> insert(EncodedMessage message);
+    outcome::result<void> applyHeadChange(const HeadChange &change);
+    void notify(MpoolUpdate update);
+    /// Persist and notify collected updates
+    void flushUpdates();
+
+    MpoolConfig config;
+    /// Pending messages by sender and nonce, updated with batch per flush
+    std::shared_ptr<PersistentBufferMap> store;
     IpldPtr ipld;
     std::shared_ptr<Interpreter> interpreter;
+    /// Shared by state overlays of gas estimation
+    std::shared_ptr<NodeCache> hamt_cache;
+    std::shared_ptr<TipsetCache> tipset_cache;
     ChainStore::connection_t head_sub;
     TipsetCPtr head;
+    mutable boost::optional<HeadState> head_state;
+    mutable boost::optional<TokenAmount> base_fee, premium;
+    /// Last `kPremiumTipsets` applied tipsets
+    mutable std::deque<FeeHistory> fee_history;
     std::map<Address, Pending> by_from;
-    std::map<CID, Signature> bls_cache;
+    /// Pending message cid to sender and nonce, so included messages are
+    /// removed without loading them
+    std::unordered_map<CompactCid, std::pair<Address, uint64_t>> by_cid;
+    size_t size{};
+    /// Senders of local messages
+    std::set<Address> local;
+    /// Signatures of bls messages, to restore them on revert
+    common::LruCache<CompactCid, Signature> bls_cache{
+        MpoolConfig{}.bls_cache};
+    /// Updates are collected during head change
+    std::vector<MpoolUpdate> updates;
+    bool batching{};
     boost::signals2::signal<Subscriber> signal;
   };
 }  // namespace fc::storage::mpool
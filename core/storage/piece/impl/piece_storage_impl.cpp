@@ -86,8 +86,75 @@ namespace fc::storage::piece {
     return outcome::success();
   }
 
+  outcome::result<void> PieceStorageImpl::addPieceDeal(
+      const CID &piece_cid,
+      const std::map<CID, PayloadLocation> &locations,
+      const DealInfo &deal_info) {
+    auto batch{storage_->batch()};
+
+    OUTCOME_TRY(piece_key, makeKey(kPiecePrefix, piece_cid));
+    PieceInfo piece_info{.piece_cid = piece_cid, .deals = {}};
+    if (storage_->contains(piece_key)) {
+      OUTCOME_TRYA(piece_info, getPieceInfo(piece_cid));
+    }
+    piece_info.deals.push_back(deal_info);
+    OUTCOME_TRY(piece_value, codec::cbor::encode(piece_info));
+    OUTCOME_TRY(batch->put(piece_key, piece_value));
+
+    for (const auto &[payload_cid, location] : locations) {
+      OUTCOME_TRY(location_key, makeKey(kLocationPrefix, payload_cid));
+      PayloadInfo payload_info{.cid = payload_cid, .piece_block_locations = {}};
+      if (storage_->contains(location_key)) {
+        OUTCOME_TRYA(payload_info, getPayloadInfo(payload_cid));
+      }
+      auto known{std::find_if(payload_info.piece_block_locations.begin(),
+                              payload_info.piece_block_locations.end(),
+                              [&](auto &block) {
+                                return block.parent_piece == piece_cid;
+                              })};
+      if (known == payload_info.piece_block_locations.end()) {
+        payload_info.piece_block_locations.push_back(
+            {.parent_piece = piece_cid, .block_location = location});
+        OUTCOME_TRY(location_value, codec::cbor::encode(payload_info));
+        OUTCOME_TRY(batch->put(location_key, location_value));
+      }
+
+      OUTCOME_TRY(pieces_key, makeKey(kPayloadPiecesPrefix, payload_cid));
+      std::vector<PieceInfo> pieces;
+      if (storage_->contains(pieces_key)) {
+        OUTCOME_TRY(pieces_value, storage_->get(pieces_key));
+        OUTCOME_TRYA(pieces,
+                     codec::cbor::decode<std::vector<PieceInfo>>(pieces_value));
+      }
+      auto piece{std::find_if(pieces.begin(), pieces.end(), [&](auto &info) {
+        return info.piece_cid == piece_cid;
+      })};
+      if (piece != pieces.end()) {
+        *piece = piece_info;
+      } else {
+        pieces.push_back(piece_info);
+      }
+      OUTCOME_TRY(pieces_value, codec::cbor::encode(pieces));
+      OUTCOME_TRY(batch->put(pieces_key, pieces_value));
+    }
+    return batch->commit();
+  }
+
   outcome::result<PieceInfo> PieceStorageImpl::getPieceInfoFromCid(
       const CID &payload_cid, const boost::optional<CID> &piece_cid) const {
+    OUTCOME_TRY(pieces_key, makeKey(kPayloadPiecesPrefix, payload_cid));
+    if (storage_->contains(pieces_key)) {
+      OUTCOME_TRY(pieces_value, storage_->get(pieces_key));
+      OUTCOME_TRY(pieces,
+                  codec::cbor::decode<std::vector<PieceInfo>>(pieces_value));
+      for (auto &piece_info : pieces) {
+        if (!piece_cid || piece_info.piece_cid == *piece_cid) {
+          return std::move(piece_info);
+        }
+      }
+      return PieceStorageError::kPieceNotFound;
+    }
+
     OUTCOME_TRY(cid_info, getPayloadInfo(payload_cid));
     for (auto &&block_location : cid_info.piece_block_locations) {
       OUTCOME_TRY(piece_info, getPieceInfo(block_location.parent_piece));
@@ -101,9 +168,12 @@ namespace fc::storage::piece {
   outcome::result<bool> PieceStorageImpl::hasPieceInfo(
       CID payload_cid, const boost::optional<CID> &piece_cid) const {
     auto piece_info_res = getPieceInfoFromCid(payload_cid, piece_cid);
-    if (piece_info_res.has_error()
-        && piece_info_res.error() == PieceStorageError::kPieceNotFound) {
-      return false;
+    if (piece_info_res.has_error()) {
+      if (piece_info_res.error() == PieceStorageError::kPieceNotFound
+          || piece_info_res.error() == PieceStorageError::kPayloadNotFound) {
+        return false;
+      }
+      return piece_info_res.error();
     }
     return !piece_info_res.value().deals.empty();
   }
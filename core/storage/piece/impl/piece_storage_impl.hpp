@@ -19,6 +19,8 @@ namespace fc::storage::piece {
   using common::Buffer;
   const std::string kPiecePrefix = "/storagemarket/pieces/";
   const std::string kLocationPrefix = "/storagemarket/cid-infos/";
+  /// Payload block cid to pieces with deals, written by addPieceDeal
+  const std::string kPayloadPiecesPrefix = "/storagemarket/payload-pieces/";
 
   class PieceStorageImpl : public PieceStorage {
    protected:
@@ -40,6 +42,15 @@ namespace fc::storage::piece {
     outcome::result<PayloadInfo> getPayloadInfo(
         const CID &piece_cid) const override;
 
+    outcome::result<void> addPieceDeal(
+        const CID &piece_cid,
+        const std::map<CID, PayloadLocation> &locations,
+        const DealInfo &deal_info) override;
+
+    /**
+     * Reads payload index if payload was added by addPieceDeal, otherwise
+     * resolves pieces through payload locations
+     */
     outcome::result<PieceInfo> getPieceInfoFromCid(
         const CID &payload_cid,
         const boost::optional<CID> &piece_cid) const override;
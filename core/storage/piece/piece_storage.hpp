@@ -122,6 +122,19 @@ namespace fc::storage::piece {
     virtual outcome::result<void> addPayloadLocations(
         const CID &parent_piece, std::map<CID, PayloadLocation> locations) = 0;
 
+    /**
+     * @brief Add deal info for piece and locations of its payload blocks in
+     * one write batch. Pieces with deals are also indexed by payload block
+     * cid, so piece lookups by payload cid need one read.
+     * @param piece_cid - id of the Piece
+     * @param locations - { Payload block CID => PayloadLocation }
+     * @param deal_info - sector, offset and length of the Piece
+     */
+    virtual outcome::result<void> addPieceDeal(
+        const CID &piece_cid,
+        const std::map<CID, PayloadLocation> &locations,
+        const DealInfo &deal_info) = 0;
+
     virtual outcome::result<PieceInfo> getPieceInfoFromCid(
         const CID &payload_cid,
         const boost::optional<CID> &piece_cid) const = 0;
@@ -12,12 +12,15 @@
 #include "crypto/bls/impl/bls_provider_impl.hpp"
 #include "crypto/secp256k1/impl/secp256k1_sha256_provider_impl.hpp"
 #include "crypto/secp256k1/secp256k1_provider.hpp"
+#include "storage/ipfs/impl/cached_datastore.hpp"
 #include "storage/ipfs/impl/datastore_leveldb.hpp"
 #include "storage/keystore/impl/filesystem/filesystem_keystore.hpp"
 #include "storage/repository/repository_error.hpp"
 
 using fc::crypto::bls::BlsProviderImpl;
 using fc::crypto::secp256k1::Secp256k1Sha256ProviderImpl;
+using fc::storage::LevelDB;
+using fc::storage::ipfs::CachedDatastore;
 using fc::storage::ipfs::LeveldbDatastore;
 using fc::storage::keystore::FileSystemKeyStore;
 using fc::storage::repository::FileSystemRepository;
@@ -88,8 +91,30 @@ fc::outcome::result<std::shared_ptr<Repository>> FileSystemRepository::create(
   // create datastore
   auto datastore_path =
       repo_path + fc::storage::filestore::DELIMITER + kDatastore;
-  OUTCOME_TRY(ipfs_datastore,
-              LeveldbDatastore::create(datastore_path, leveldb_options));
+  // main store opts into large block cache, other databases keep defaults
+  LevelDB::Tuning tuning;
+  auto configure{[&](auto &key, auto &value) {
+    using T = std::remove_reference_t<decltype(value)>;
+    if (auto configured{config->get<T>(key)}) {
+      value = configured.value();
+    }
+  }};
+  configure(kConfigLeveldbBlockCacheBytes, tuning.block_cache_bytes);
+  configure(kConfigLeveldbBloomBitsPerKey, tuning.bloom_bits_per_key);
+  configure(kConfigLeveldbWriteBufferBytes, tuning.write_buffer_bytes);
+  configure(kConfigLeveldbCompression, tuning.compression);
+  OUTCOME_TRY(
+      leveldb_datastore,
+      LeveldbDatastore::create(datastore_path, leveldb_options, tuning));
+  std::shared_ptr<IpfsDatastore> ipfs_datastore{leveldb_datastore};
+  size_t cache_bytes{CachedDatastore::kDefaultMaxBytes};
+  if (auto configured{config->get<size_t>(kConfigIpldCacheBytes)}) {
+    cache_bytes = configured.value();
+  }
+  if (cache_bytes != 0) {
+    ipfs_datastore = std::make_shared<CachedDatastore>(
+        std::move(leveldb_datastore), cache_bytes);
+  }
 
   // create keystore
   auto keystore_path =
@@ -49,6 +49,17 @@ namespace fc::storage::repository {
     inline static const std::string kRepositoryLock = "repo.lock";
     inline static const std::string kVersionFilename = "version";
     inline static const std::string kStorageConfig = "storage.json";
+    /// Config key of datastore memory tier size in bytes, 0 disables it
+    inline static const std::string kConfigIpldCacheBytes = "ipld.cache_bytes";
+    /// Config keys of datastore leveldb tuning, see LevelDB::Tuning
+    inline static const std::string kConfigLeveldbBlockCacheBytes =
+        "leveldb.block_cache_bytes";
+    inline static const std::string kConfigLeveldbBloomBitsPerKey =
+        "leveldb.bloom_bits_per_key";
+    inline static const std::string kConfigLeveldbWriteBufferBytes =
+        "leveldb.write_buffer_bytes";
+    inline static const std::string kConfigLeveldbCompression =
+        "leveldb.compression";
     inline static const Version kFileSystemRepositoryVersion = 1;
 
     FileSystemRepository(std::shared_ptr<IpfsDatastore> ipld_store,
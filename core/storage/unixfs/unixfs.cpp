@@ -5,20 +5,42 @@
 
 #include "storage/unixfs/unixfs.hpp"
 
+#include <fcntl.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <unistd.h>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <cerrno>
+#include <deque>
+#include <future>
 
 #include "common/span.hpp"
 #include "crypto/hasher/hasher.hpp"
 
+OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::unixfs, UnixfsError, e) {
+  using E = fc::storage::unixfs::UnixfsError;
+  switch (e) {
+    case E::kCannotOpenFile:
+      return "Cannot open file";
+    case E::kCannotReadFile:
+      return "Cannot read file";
+  }
+  return "UnixfsError: unknown error";
+}
+
 namespace fc::storage::unixfs {
   using common::Buffer;
   using crypto::Hasher;
   using google::protobuf::io::CodedOutputStream;
   using google::protobuf::io::StringOutputStream;
 
+  CID leafCid(gsl::span<const uint8_t> data) {
+    return {CID::Version::V1, CID::Multicodec::RAW, Hasher::sha2_256(data)};
+  }
+
   outcome::result<CID> makeLeaf(Ipld &ipld, gsl::span<const uint8_t> data) {
-    CID cid{CID::Version::V1, CID::Multicodec::RAW, Hasher::sha2_256(data)};
+    auto cid{leafCid(data)};
     OUTCOME_TRY(ipld.set(cid, Ipld::Value{data}));
     return cid;
   }
@@ -140,4 +162,267 @@ namespace fc::storage::unixfs {
     OUTCOME_TRY(tree, makeTree(ipld, height, data, chunk_size, max_links));
     return std::move(tree.cid);
   }
+
+  namespace {
+    /// Buzhash window, multiple of 32 so rotated out byte hash is unchanged
+    constexpr size_t kBuzWindow{32};
+
+    const std::array<uint32_t, 256> &buzTable() {
+      static const auto table{[] {
+        std::array<uint32_t, 256> table{};
+        // splitmix64
+        uint64_t x{0};
+        for (auto &v : table) {
+          x += 0x9e3779b97f4a7c15;
+          auto z{x};
+          z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+          z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+          v = static_cast<uint32_t>(z ^ (z >> 31));
+        }
+        return table;
+      }()};
+      return table;
+    }
+
+    uint32_t rotl(uint32_t x) {
+      return (x << 1) | (x >> 31);
+    }
+
+    /// Reads until size bytes or end of file
+    outcome::result<size_t> readFull(int fd, uint8_t *data, size_t size) {
+      size_t total{0};
+      while (total < size) {
+        auto n{::read(fd, data + total, size - total)};
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n < 0) {
+          return UnixfsError::kCannotReadFile;
+        }
+        if (n == 0) {
+          break;
+        }
+        total += n;
+      }
+      return total;
+    }
+
+    class ChunkReader {
+     public:
+      ChunkReader(int fd, const ImportOptions &options)
+          : fd_{fd}, chunker_{options.chunker}, max_{options.chunk_size} {
+        min_ = std::max(max_ / 4, kBuzWindow);
+        // expected boundary is min_ bytes after min_
+        size_t bits{1};
+        while (bits <= min_ / 2) {
+          bits <<= 1;
+        }
+        mask_ = bits - 1;
+      }
+
+      /// Next chunk, empty at end of file
+      outcome::result<Buffer> next() {
+        if (chunker_ == Chunker::kFixed) {
+          Buffer chunk;
+          chunk.resize(max_);
+          OUTCOME_TRY(size, readFull(fd_, chunk.data(), max_));
+          chunk.resize(size);
+          return std::move(chunk);
+        }
+        if (!eof_ && buffer_.size() < max_) {
+          auto have{buffer_.size()};
+          buffer_.resize(max_);
+          OUTCOME_TRY(size, readFull(fd_, buffer_.data() + have, max_ - have));
+          buffer_.resize(have + size);
+          eof_ = buffer_.size() < max_;
+        }
+        auto cut{boundary()};
+        Buffer chunk{buffer_.data(), buffer_.data() + cut};
+        buffer_.erase(buffer_.begin(), buffer_.begin() + cut);
+        return std::move(chunk);
+      }
+
+     private:
+      size_t boundary() const {
+        if (buffer_.size() <= min_) {
+          return buffer_.size();
+        }
+        auto &table{buzTable()};
+        uint32_t hash{0};
+        for (auto i{min_ - kBuzWindow}; i < min_; ++i) {
+          hash = rotl(hash) ^ table[buffer_[i]];
+        }
+        for (auto i{min_}; i < buffer_.size(); ++i) {
+          if ((hash & mask_) == 0) {
+            return i;
+          }
+          hash = rotl(hash) ^ table[buffer_[i - kBuzWindow]]
+                 ^ table[buffer_[i]];
+        }
+        return buffer_.size();
+      }
+
+      int fd_;
+      Chunker chunker_;
+      size_t max_, min_, mask_;
+      /// Read bytes not returned as chunks yet
+      std::vector<uint8_t> buffer_;
+      bool eof_{false};
+    };
+
+    /**
+     * Builds balanced dag bottom-up, each level keeps links of node not
+     * written yet, so trees are same as made by makeTree.
+     */
+    class Importer {
+     public:
+      Importer(Ipld &ipld, const ImportOptions &options)
+          : ipld_{ipld}, options_{options} {}
+
+      outcome::result<void> leaf(Tree tree, Buffer bytes) {
+        OUTCOME_TRY(put(tree.cid, std::move(bytes)));
+        return add(0, std::move(tree));
+      }
+
+      outcome::result<CID> finish() {
+        for (size_t level{0}; level + 1 < levels_.size(); ++level) {
+          if (!levels_[level].empty()) {
+            OUTCOME_TRY(tree, node(level));
+            OUTCOME_TRY(add(level + 1, std::move(tree)));
+          }
+        }
+        auto &top{levels_.back()};
+        auto root{top.front()};
+        if (top.size() != 1) {
+          OUTCOME_TRYA(root, node(levels_.size() - 1));
+        }
+        OUTCOME_TRY(flush());
+        return std::move(root.cid);
+      }
+
+     private:
+      outcome::result<void> add(size_t level, Tree tree) {
+        if (levels_.size() == level) {
+          levels_.emplace_back();
+        }
+        if (levels_[level].size() == options_.max_links) {
+          OUTCOME_TRY(full, node(level));
+          OUTCOME_TRY(add(level + 1, std::move(full)));
+        }
+        levels_[level].push_back(std::move(tree));
+        return outcome::success();
+      }
+
+      /// Writes node with links of level and clears level
+      outcome::result<Tree> node(size_t level) {
+        Tree root;
+        PbFileBuilder pb_file;
+        PbNodeBuilder pb_node;
+        for (auto &tree : levels_[level]) {
+          root.size += tree.size;
+          root.file_size += tree.file_size;
+          pb_file.block(tree.file_size);
+          pb_node.link(std::move(tree.cid), tree.size);
+        }
+        levels_[level].clear();
+        pb_node.content(pb_file.toString());
+        auto bytes{pb_node.toBytes()};
+        root.size += bytes.size();
+        root.cid = CID{
+            CID::Version::V0, CID::Multicodec::DAG_PB, Hasher::sha2_256(bytes)};
+        OUTCOME_TRY(put(root.cid, std::move(bytes)));
+        return root;
+      }
+
+      outcome::result<void> put(const CID &cid, Buffer bytes) {
+        batch_size_ += bytes.size();
+        batch_.emplace_back(cid, std::move(bytes));
+        if (batch_size_ >= options_.batch_bytes) {
+          return flush();
+        }
+        return outcome::success();
+      }
+
+      outcome::result<void> flush() {
+        auto batch{std::move(batch_)};
+        batch_.clear();
+        batch_size_ = 0;
+        return ipld_.setMany(std::move(batch));
+      }
+
+      Ipld &ipld_;
+      const ImportOptions &options_;
+      std::vector<std::vector<Tree>> levels_;
+      Ipld::Batch batch_;
+      size_t batch_size_{};
+    };
+  }  // namespace
+
+  outcome::result<CID> importFile(Ipld &ipld,
+                                  int fd,
+                                  const ImportOptions &options) {
+    struct Pending {
+      Buffer bytes;
+      std::future<CID> cid;
+    };
+    ChunkReader reader{fd, options};
+    Importer importer{ipld, options};
+    std::deque<Pending> pending;
+    // declared after pending, so joined before hashed chunks are freed
+    std::unique_ptr<boost::asio::thread_pool> pool;
+    if (options.threads != 0) {
+      pool = std::make_unique<boost::asio::thread_pool>(options.threads);
+    }
+    auto window{std::max<size_t>(options.threads, 1) * 2};
+
+    auto pop{[&]() -> outcome::result<void> {
+      auto bytes{std::move(pending.front().bytes)};
+      Tree tree;
+      tree.size = tree.file_size = bytes.size();
+      tree.cid = pending.front().cid.get();
+      pending.pop_front();
+      return importer.leaf(std::move(tree), std::move(bytes));
+    }};
+    // empty file is one empty leaf
+    for (auto first{true};; first = false) {
+      OUTCOME_TRY(chunk, reader.next());
+      auto end{chunk.empty()};
+      if (end && !first) {
+        break;
+      }
+      // moving buffer keeps its data, so task can hash it in place
+      auto task{std::make_shared<std::packaged_task<CID()>>(
+          [data{chunk.data()}, size{chunk.size()}] {
+            return leafCid(gsl::make_span(data, size));
+          })};
+      pending.push_back({std::move(chunk), task->get_future()});
+      if (pool) {
+        boost::asio::post(*pool, [task] { (*task)(); });
+      } else {
+        (*task)();
+      }
+      if (pending.size() >= window) {
+        OUTCOME_TRY(pop());
+      }
+      if (end) {
+        break;
+      }
+    }
+    while (!pending.empty()) {
+      OUTCOME_TRY(pop());
+    }
+    return importer.finish();
+  }
+
+  outcome::result<CID> importFile(Ipld &ipld,
+                                  const std::string &path,
+                                  const ImportOptions &options) {
+    auto fd{open(path.c_str(), O_RDONLY)};
+    if (fd < 0) {
+      return UnixfsError::kCannotOpenFile;
+    }
+    auto cid{importFile(ipld, fd, options)};
+    close(fd);
+    return cid;
+  }
 }  // namespace fc::storage::unixfs
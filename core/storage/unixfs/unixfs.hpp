@@ -18,6 +18,47 @@ namespace fc::storage::unixfs {
                                 gsl::span<const uint8_t> data,
                                 size_t chunk_size = kChunkSize,
                                 size_t max_links = kMaxLinks);
+
+  enum class UnixfsError {
+    kCannotOpenFile = 1,
+    kCannotReadFile,
+  };
+
+  /// How imported file is split to leaves
+  enum class Chunker {
+    /// Leaves of chunk_size, same as wrapFile
+    kFixed,
+    /**
+     * Content-defined boundaries found by rolling buzhash, leaves are from
+     * chunk_size / 4 to chunk_size bytes, so insertions shift few leaves
+     */
+    kBuzhash,
+  };
+
+  struct ImportOptions {
+    size_t chunk_size{size_t{1} << 20};
+    size_t max_links{kMaxLinks};
+    Chunker chunker{Chunker::kFixed};
+    /// Threads hashing leaves, zero hashes on caller thread
+    size_t threads{4};
+    /// Blocks are written with one setMany when they reach this size
+    size_t batch_bytes{size_t{16} << 20};
+  };
+
+  /**
+   * Builds same dag as wrapFile from data read from fd until end of file.
+   * Memory is bounded by few leaves per thread and one batch, regardless of
+   * file size.
+   */
+  outcome::result<CID> importFile(Ipld &ipld,
+                                  int fd,
+                                  const ImportOptions &options = {});
+
+  outcome::result<CID> importFile(Ipld &ipld,
+                                  const std::string &path,
+                                  const ImportOptions &options = {});
 }  // namespace fc::storage::unixfs
 
+OUTCOME_HPP_DECLARE_ERROR(fc::storage::unixfs, UnixfsError);
+
 #endif  // CPP_FILECOIN_CORE_STORAGE_UNIXFS_UNIXFS_HPP
@@ -5,10 +5,15 @@
 
 #include "vm/actor/cgo/actors.hpp"
 
+#include <array>
+#include <mutex>
+
 #include "crypto/blake2/blake2b160.hpp"
 #include "crypto/bls/impl/bls_provider_impl.hpp"
 #include "crypto/secp256k1/impl/secp256k1_provider_impl.hpp"
 #include "proofs/proofs.hpp"
+#include "proofs/seal_verifier.hpp"
+#include "proofs/verify_cache.hpp"
 #include "storage/keystore/impl/in_memory/in_memory_keystore.hpp"
 #include "vm/actor/builtin/v0/account/account_actor.hpp"
 #include "vm/actor/cgo/c_actors.h"
@@ -20,7 +25,7 @@
 #define RUNTIME_METHOD(name)                                         \
   void rt_##name(Runtime &, CborDecodeStream &, CborEncodeStream &); \
   CBOR_METHOD(name) {                                                \
-    rt_##name(runtimes.at(arg.get<size_t>()), arg, ret);             \
+    rt_##name(getRuntime(arg.get<size_t>()), arg, ret);              \
   }                                                                  \
   void rt_##name(Runtime &rt, CborDecodeStream &arg, CborEncodeStream &ret)
 
@@ -56,8 +61,72 @@ namespace fc::vm::actor::cgo {
   constexpr auto kFatal{VMExitCode::kFatal};
   constexpr auto kOk{VMExitCode::kOk};
 
-  static std::map<size_t, RuntimeImpl> runtimes;
-  static size_t next_runtime{0};
+  /**
+   * Runtimes of invocations in progress, invocations may run concurrently.
+   * Slots are allocated in chunks which are never moved or freed, so runtime
+   * is accessed by id without lock, only allocation of slot is locked.
+   */
+  class RuntimeSlots {
+   public:
+    RuntimeSlots() {
+      std::lock_guard lock{mutex_};
+      grow();
+    }
+
+    size_t acquire(RuntimeImpl runtime) {
+      std::lock_guard lock{mutex_};
+      if (free_.empty()) {
+        grow();
+      }
+      auto id{free_.back()};
+      free_.pop_back();
+      slot(id).emplace(std::move(runtime));
+      return id;
+    }
+
+    void release(size_t id) {
+      std::lock_guard lock{mutex_};
+      slot(id).reset();
+      free_.push_back(id);
+    }
+
+    RuntimeImpl &get(size_t id) {
+      return slot(id).value();
+    }
+
+   private:
+    static constexpr size_t kChunk{256};
+    static constexpr size_t kMaxChunks{256};
+    using Slot = boost::optional<RuntimeImpl>;
+
+    Slot &slot(size_t id) {
+      auto &chunk{chunks_.at(id / kChunk)};
+      assert(chunk);
+      return (*chunk)[id % kChunk];
+    }
+
+    void grow() {
+      if (size_ == kMaxChunks) {
+        throw std::runtime_error{"RuntimeSlots: too many invocations"};
+      }
+      chunks_[size_] = std::make_unique<std::array<Slot, kChunk>>();
+      for (auto i{kChunk}; i != 0; --i) {
+        free_.push_back(size_ * kChunk + i - 1);
+      }
+      ++size_;
+    }
+
+    std::mutex mutex_;
+    std::array<std::unique_ptr<std::array<Slot, kChunk>>, kMaxChunks> chunks_;
+    size_t size_{};
+    std::vector<size_t> free_;
+  };
+
+  static RuntimeSlots runtimes;
+
+  RuntimeImpl &getRuntime(size_t id) {
+    return runtimes.get(id);
+  }
 
   static storage::keystore::InMemoryKeyStore keystore{
       std::make_shared<crypto::bls::BlsProviderImpl>(),
@@ -68,16 +137,14 @@ namespace fc::vm::actor::cgo {
                                  const CID &code,
                                  size_t method,
                                  BytesIn params) {
+    auto id{runtimes.acquire(
+        RuntimeImpl(exec, exec->env->randomness, message, message.from))};
+    auto version{getRuntime(id).getNetworkVersion()};
     CborEncodeStream arg;
-    auto id{next_runtime++};  // TODO: mod
-    auto runtime =
-        RuntimeImpl(exec, exec->env->randomness, message, message.from);
-    auto version{runtime.getNetworkVersion()};
     arg << id << version << message.from << message.to << exec->env->epoch
         << message.value << code << method << params;
-    runtimes.emplace(id, runtime);
     auto ret{cgoCall<cgoActorsInvoke>(arg)};
-    runtimes.erase(id);
+    runtimes.release(id);
     auto exit{ret.get<VMExitCode>()};
     if (exit != kOk) {
       return exit;
@@ -138,6 +205,18 @@ namespace fc::vm::actor::cgo {
     }
   }
 
+  /// Puts consecutive blocks, charging each one in order as single puts do
+  RUNTIME_METHOD(gocRtIpldPutMany) {
+    auto n{arg.get<size_t>()};
+    for (auto i{0u}; i < n; ++i) {
+      auto buf{arg.get<Buffer>()};
+      if (!ipldPut(ret, rt, buf)) {
+        return;
+      }
+    }
+    ret << kOk;
+  }
+
   RUNTIME_METHOD(gocRtCharge) {
     if (charge(ret, rt, arg.get<GasAmount>())) {
       ret << kOk;
@@ -178,17 +257,24 @@ namespace fc::vm::actor::cgo {
     auto info{arg.get<WindowPoStVerifyInfo>()};
     if (charge(ret, rt, rt.execution()->env->pricelist.onVerifyPost(info))) {
       info.randomness[31] &= 0x3f;
-      auto r{proofs::Proofs::verifyWindowPoSt(info)};
+      auto r{proofs::VerifyCache::instance().verify(
+          proofs::VerifyKind::kWindowPoSt,
+          info,
+          proofs::Proofs::verifyWindowPoSt)};
       ret << kOk << (r && r.value());
     }
   }
 
   RUNTIME_METHOD(gocRtVerifySeals) {
     auto n{arg.get<size_t>()};
-    ret << kOk;
+    std::vector<SealVerifyInfo> infos;
+    infos.reserve(n);
     for (auto i{0u}; i < n; ++i) {
-      auto r{proofs::Proofs::verifySeal(arg.get<SealVerifyInfo>())};
-      ret << (r && r.value());
+      infos.push_back(arg.get<SealVerifyInfo>());
+    }
+    ret << kOk;
+    for (bool valid : proofs::SealVerifier::instance().verifySeals(infos)) {
+      ret << valid;
     }
   }
 
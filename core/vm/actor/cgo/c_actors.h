@@ -13,6 +13,7 @@ extern "C" {
 
 Raw gocRtIpldGet(Raw);
 Raw gocRtIpldPut(Raw);
+Raw gocRtIpldPutMany(Raw);
 Raw gocRtCharge(Raw);
 Raw gocRtRandomnessFromTickets(Raw);
 Raw gocRtRandomnessFromBeacon(Raw);
@@ -28,13 +28,14 @@ void free(void *);
   }                                         \
   Buffer goc_##name(BytesIn arg)
 
+/// Decodes argument and encodes result without intermediate buffer copies
 #define CBOR_METHOD(name)                                   \
   void cbor_##name(CborDecodeStream &, CborEncodeStream &); \
-  GOC_METHOD(name) {                                        \
+  extern "C" Raw name(Raw raw) {                            \
     CborEncodeStream ret;                                   \
-    CborDecodeStream _arg{arg};                             \
-    cbor_##name(_arg, ret);                                 \
-    return Buffer{ret.data()};                              \
+    CborDecodeStream arg{gocArg(raw)};                      \
+    cbor_##name(arg, ret);                                  \
+    return gocRet(ret.data());                              \
   }                                                         \
   void cbor_##name(CborDecodeStream &arg, CborEncodeStream &ret)
 
@@ -69,7 +70,11 @@ namespace fc {
 
   template <auto f>
   inline auto cgoCall(const CborEncodeStream &arg) {
-    return CborDecodeStream{cgoCall<f>(arg.data())};
+    auto raw{f(cgoArg(arg.data()))};
+    // decode stream keeps own copy, so go memory is freed right away
+    CborDecodeStream ret{gsl::make_span(raw.data, raw.size)};
+    free(raw.data);
+    return ret;
   }
 }  // namespace fc
 
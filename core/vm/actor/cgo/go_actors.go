@@ -77,8 +77,12 @@ type rt struct {
 	tx       bool
 	cv       bool
 	ctx      context.Context
+	puts     [][]byte
 }
 
+// Max blocks buffered by StorePut before sending them to runtime
+const maxPuts = 64
+
 var _ rt1.Runtime = &rt{}
 var _ rt2.Runtime = &rt{}
 
@@ -246,13 +250,40 @@ func (rt *rt) StoreGet(c cid.Cid, o cbor.Unmarshaler) bool {
 	return true
 }
 
+// Buffers block and returns its cid, buffered blocks are sent with one call
+// before any other runtime call, so gas is charged in same order.
 func (rt *rt) StorePut(o cbor.Marshaler) cid.Cid {
 	w := new(bytes.Buffer)
 	if e := o.MarshalCBOR(w); e != nil {
 		rt.Abort(exitcode.ErrSerialization)
 	}
-	ret := rt.gocRet(C.gocRtIpldPut(rt.gocArg().bytes(w.Bytes()).arg()))
-	return ret.cid()
+	c, e := abi.CidBuilder.Sum(w.Bytes())
+	cgoAsserte(e)
+	rt.puts = append(rt.puts, w.Bytes())
+	if len(rt.puts) >= maxPuts {
+		rt.storeFlush()
+	}
+	return c
+}
+
+// Sends buffered blocks to runtime, returns exit code instead of abort
+func (rt *rt) storeFlushed() exitcode.ExitCode {
+	if len(rt.puts) == 0 {
+		return exitcode.Ok
+	}
+	arg := CborOut().uint(rt.id).uint(uint64(len(rt.puts)))
+	for _, put := range rt.puts {
+		arg.bytes(put)
+	}
+	rt.puts = nil
+	ret := CborIn(gocRet(C.gocRtIpldPutMany(arg.arg())))
+	return exitcode.ExitCode(ret.int())
+}
+
+func (rt *rt) storeFlush() {
+	if exit := rt.storeFlushed(); exit != exitcode.Ok {
+		rt.Abort(exit)
+	}
 }
 
 var _ rt1.Message = &rt{}
@@ -389,6 +420,7 @@ func (rt *rt) validateCallerOnce() {
 }
 
 func (rt *rt) gocArg() *cborOut {
+	rt.storeFlush()
 	return CborOut().uint(rt.id)
 }
 
@@ -482,20 +514,26 @@ func invoke(rt *rt, code cid.Cid, method uint64, params []byte) (exit exitcode.E
 			} else if exit, ok = e.(exitcode.ExitCode); !ok {
 				exit = exitcode.ExitCode(1)
 			}
+			// blocks put before abort are charged as with unbuffered puts
+			if put := rt.storeFlushed(); put != exitcode.Ok && exit != ExitFatal {
+				exit = put
+			}
 			if exit == ExitFatal {
 				fmt.Println("[go_actors] invoke fatal", e)
 				debug.PrintStack()
 			}
 		}
 	}()
-	return exitcode.Ok, f(rt, params)
+	ret = f(rt, params)
+	rt.storeFlush()
+	return exitcode.Ok, ret
 }
 
 //export cgoActorsInvoke
 func cgoActorsInvoke(raw C.Raw) C.Raw {
 	arg := cgoArgCbor(raw)
 	id, version, from, to, now, value, code, method, params := arg.uint(), arg.uint(), arg.addr(), arg.addr(), arg.int(), arg.big(), arg.cid(), arg.uint(), arg.bytes()
-	exit, ret := invoke(&rt{id, version, from, to, now, value, false, false, context.Background()}, code, method, params)
+	exit, ret := invoke(&rt{id, version, from, to, now, value, false, false, context.Background(), nil}, code, method, params)
 	return CborOut().int(int64(exit)).bytes(ret).ret()
 }
 
@@ -20,7 +20,7 @@ namespace fc::vm::actor {
 
   using runtime::InvocationOutput;
 
-  InvokerImpl::InvokerImpl() {
+  InvokerImpl::InvokerImpl(NativeMode mode) : mode_{mode} {
     builtin_[builtin::v0::kInitCodeCid] = builtin::v0::init::exports;
     builtin_[builtin::v0::kRewardActorCodeID] = builtin::v0::reward::exports;
     builtin_[builtin::v0::kCronCodeCid] = builtin::v0::cron::exports;
@@ -32,6 +32,14 @@ namespace fc::vm::actor {
     builtin_[builtin::v0::kPaymentChannelCodeCid] =
         builtin::v0::payment_channel::exports;
     builtin_[builtin::v0::kAccountCodeCid] = builtin::v0::account::exports;
+
+    native_[builtin::v0::kAccountCodeCid] = {
+        builtin::v0::account::PubkeyAddress::Number};
+    native_[builtin::v0::kRewardActorCodeID] = {
+        builtin::v0::reward::AwardBlockReward::Number};
+    native_[builtin::v0::kCronCodeCid] = {builtin::v0::cron::EpochTick::Number};
+    native_[builtin::v0::kStorageMinerCodeCid] = {
+        builtin::v0::miner::SubmitWindowedPoSt::Number};
   }
 
   outcome::result<InvocationOutput> InvokerImpl::invoke(
@@ -50,4 +58,15 @@ namespace fc::vm::actor {
     }
     return maybe_builtin_method->second(runtime, params);
   }
+
+  NativeMode InvokerImpl::nativeMode(const CID &code,
+                                     MethodNumber method) const {
+    if (mode_ != NativeMode::kOff) {
+      auto it{native_.find(code)};
+      if (it != native_.end() && it->second.count(method) != 0) {
+        return mode_;
+      }
+    }
+    return NativeMode::kOff;
+  }
 }  // namespace fc::vm::actor
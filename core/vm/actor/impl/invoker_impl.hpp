@@ -8,6 +8,8 @@
 
 #include "vm/actor/invoker.hpp"
 
+#include <set>
+
 #include "vm/actor/actor_method.hpp"
 
 namespace fc::vm::actor {
@@ -17,7 +19,8 @@ namespace fc::vm::actor {
   /// Finds and loads actor code, invokes actor methods
   class InvokerImpl : public Invoker {
    public:
-    InvokerImpl();
+    /// @param mode - how hot methods with native implementation are executed
+    explicit InvokerImpl(NativeMode mode = NativeMode::kOff);
     ~InvokerImpl() override = default;
     outcome::result<InvocationOutput> invoke(
         const Actor &actor,
@@ -25,8 +28,14 @@ namespace fc::vm::actor {
         MethodNumber method,
         const MethodParams &params) override;
 
+    NativeMode nativeMode(const CID &code,
+                          MethodNumber method) const override;
+
    private:
     std::map<CID, ActorExports> builtin_;
+    NativeMode mode_;
+    /// Hot methods where go actors call overhead exceeds actual work
+    std::map<CID, std::set<MethodNumber>> native_;
   };
 }  // namespace fc::vm::actor
 
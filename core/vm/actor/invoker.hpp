@@ -12,6 +12,16 @@ namespace fc::vm::actor {
 
   using runtime::InvocationOutput;
 
+  /// How methods with native implementation are executed
+  enum class NativeMode {
+    /// Use go actors
+    kOff,
+    /// Use native implementation
+    kOn,
+    /// Run both, report difference and use go actors result
+    kDifferential,
+  };
+
   /// Finds and loads actor code, invokes actor methods
   class Invoker {
    public:
@@ -21,6 +31,11 @@ namespace fc::vm::actor {
         Runtime &runtime,
         MethodNumber method,
         const MethodParams &params) = 0;
+
+    /// How method should be executed, go actors are used by default
+    virtual NativeMode nativeMode(const CID &code, MethodNumber method) const {
+      return NativeMode::kOff;
+    }
   };
 }  // namespace fc::vm::actor
 
@@ -49,10 +49,22 @@ namespace fc::dvm {
   void onCharge(GasAmount gas) {
     if (gas) {
       DVM_LOG("CHARGE {}", gas);
+      if (profiling.load(std::memory_order_relaxed)) {
+        profileCharge(gas);
+      }
+    }
+  }
+
+  void onIpldGet(const CID &cid, const Buffer &data) {
+    if (profiling.load(std::memory_order_relaxed)) {
+      profileIpldGet(data.size());
     }
   }
 
   void onIpldSet(const CID &cid, const Buffer &data) {
+    if (profiling.load(std::memory_order_relaxed)) {
+      profileIpldPut(data.size());
+    }
     DVM_LOG("IPLD PUT: {} {}", dumpCid(cid), dumpCbor(data));
   }
 
@@ -9,6 +9,7 @@
 #include "common/logger.hpp"
 #include "node/fwd.hpp"
 #include "primitives/types.hpp"
+#include "vm/dvm/profiler.hpp"
 
 #define _CAT1(a, b) _CAT2(a, b)
 #define _CAT2(a, b) _CAT3(~, a##b)
@@ -42,6 +43,7 @@ namespace fc::dvm {
     }
   };
 
+  void onIpldGet(const CID &cid, const Buffer &data);
   void onIpldSet(const CID &cid, const Buffer &data);
   void onCharge(GasAmount gas);
   void onSend(const UnsignedMessage &msg);
@@ -0,0 +1,166 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/dvm/profiler.hpp"
+
+#include <mutex>
+#include <vector>
+
+#include "common/span.hpp"
+
+namespace fc::dvm {
+  using Clock = std::chrono::steady_clock;
+
+  std::atomic_bool profiling{false};
+
+  struct Frame {
+    ProfileKey key;
+    std::string stack;
+    Clock::time_point start;
+    std::chrono::nanoseconds children{};
+    ProfileStats stats;
+  };
+
+  static thread_local std::vector<Frame> frames;
+
+  static std::mutex mutex;
+  static std::map<ProfileKey, ProfileStats> stats;
+  static std::map<std::string, std::chrono::nanoseconds> stacks;
+
+  inline Frame *top() {
+    return frames.empty() ? nullptr : &frames.back();
+  }
+
+  Profile::Profile(const CID &code, uint64_t method)
+      : active{profiling.load(std::memory_order_relaxed)} {
+    if (active) {
+      auto &frame{frames.emplace_back()};
+      auto hash{code.content_address.getHash()};
+      frame.key = {std::string{common::span::bytestr(hash)}, method};
+      if (frames.size() > 1) {
+        frame.stack = frames[frames.size() - 2].stack + ";";
+      }
+      frame.stack += frame.key.code + ":" + std::to_string(method);
+      frame.start = Clock::now();
+    }
+  }
+
+  Profile::~Profile() {
+    if (!active) {
+      return;
+    }
+    auto &frame{frames.back()};
+    auto total{Clock::now() - frame.start};
+    auto self{total - frame.children};
+    auto &s{frame.stats};
+    s.calls = 1;
+    s.total = total;
+    s.self = self;
+    size_t bucket{0};
+    while (bucket < kProfileBuckets.size() && total > kProfileBuckets[bucket]) {
+      ++bucket;
+    }
+    ++s.histogram[bucket];
+    {
+      std::lock_guard lock{mutex};
+      auto &to{stats[frame.key]};
+      to.calls += s.calls;
+      to.total += s.total;
+      to.self += s.self;
+      to.gas += s.gas;
+      to.ipld_gets += s.ipld_gets;
+      to.ipld_puts += s.ipld_puts;
+      to.bytes_read += s.bytes_read;
+      to.bytes_written += s.bytes_written;
+      ++to.histogram[bucket];
+      stacks[frame.stack] += self;
+    }
+    frames.pop_back();
+    if (auto parent{top()}) {
+      parent->children += total;
+    }
+  }
+
+  void profileCharge(GasAmount gas) {
+    if (auto frame{top()}) {
+      frame->stats.gas += gas;
+    }
+  }
+
+  void profileIpldGet(size_t bytes) {
+    if (auto frame{top()}) {
+      ++frame->stats.ipld_gets;
+      frame->stats.bytes_read += bytes;
+    }
+  }
+
+  void profileIpldPut(size_t bytes) {
+    if (auto frame{top()}) {
+      ++frame->stats.ipld_puts;
+      frame->stats.bytes_written += bytes;
+    }
+  }
+
+  std::map<ProfileKey, ProfileStats> profileStats() {
+    std::lock_guard lock{mutex};
+    return stats;
+  }
+
+  void profileReset() {
+    std::lock_guard lock{mutex};
+    stats.clear();
+    stacks.clear();
+  }
+
+  void dumpFlamegraph(std::ostream &os) {
+    std::lock_guard lock{mutex};
+    for (auto &[stack, self] : stacks) {
+      os << stack << " "
+         << std::chrono::duration_cast<std::chrono::microseconds>(self).count()
+         << "\n";
+    }
+  }
+
+  void dumpPrometheus(std::ostream &os) {
+    using Seconds = std::chrono::duration<double>;
+    std::lock_guard lock{mutex};
+    auto labels{[&](const ProfileKey &key) {
+      return "code=\"" + key.code + "\",method=\"" + std::to_string(key.method)
+             + "\"";
+    }};
+    os << "# TYPE vm_invocation_seconds histogram\n";
+    for (auto &[key, s] : stats) {
+      size_t count{0};
+      for (size_t i{0}; i < kProfileBuckets.size(); ++i) {
+        count += s.histogram[i];
+        os << "vm_invocation_seconds_bucket{" << labels(key) << ",le=\""
+           << Seconds{kProfileBuckets[i]}.count() << "\"} " << count << "\n";
+      }
+      os << "vm_invocation_seconds_bucket{" << labels(key) << ",le=\"+Inf\"} "
+         << s.calls << "\n";
+      os << "vm_invocation_seconds_sum{" << labels(key) << "} "
+         << Seconds{s.total}.count() << "\n";
+      os << "vm_invocation_seconds_count{" << labels(key) << "} " << s.calls
+         << "\n";
+    }
+    auto counter{[&](const char *name, auto field) {
+      os << "# TYPE " << name << " counter\n";
+      for (auto &[key, s] : stats) {
+        os << name << "{" << labels(key) << "} " << field(s) << "\n";
+      }
+    }};
+    counter("vm_invocation_self_seconds_total",
+            [](auto &s) { return Seconds{s.self}.count(); });
+    counter("vm_invocation_gas_total", [](auto &s) { return s.gas; });
+    counter("vm_invocation_ipld_gets_total",
+            [](auto &s) { return s.ipld_gets; });
+    counter("vm_invocation_ipld_puts_total",
+            [](auto &s) { return s.ipld_puts; });
+    counter("vm_invocation_ipld_read_bytes_total",
+            [](auto &s) { return s.bytes_read; });
+    counter("vm_invocation_ipld_written_bytes_total",
+            [](auto &s) { return s.bytes_written; });
+  }
+}  // namespace fc::dvm
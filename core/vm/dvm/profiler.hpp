@@ -0,0 +1,86 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <ostream>
+
+#include "primitives/cid/cid.hpp"
+#include "primitives/types.hpp"
+
+namespace fc::dvm {
+  using primitives::GasAmount;
+
+  /**
+   * Invocation profiler, aggregates wall time, gas and ipld usage by actor
+   * code and method. Disabled profiler costs one atomic load per hook.
+   */
+  extern std::atomic_bool profiling;
+
+  /// Upper bounds of wall time histogram buckets, last bucket is +Inf
+  constexpr std::array<std::chrono::microseconds, 7> kProfileBuckets{
+      std::chrono::microseconds{10},
+      std::chrono::microseconds{100},
+      std::chrono::milliseconds{1},
+      std::chrono::milliseconds{10},
+      std::chrono::milliseconds{100},
+      std::chrono::seconds{1},
+      std::chrono::seconds{10},
+  };
+
+  struct ProfileKey {
+    /// Actor code name, e.g. "fil/1/storageminer"
+    std::string code;
+    uint64_t method{};
+
+    inline bool operator<(const ProfileKey &other) const {
+      return std::tie(code, method) < std::tie(other.code, other.method);
+    }
+  };
+
+  /// Totals of method invocations, "self" excludes nested sends
+  struct ProfileStats {
+    size_t calls{};
+    std::chrono::nanoseconds total{};
+    std::chrono::nanoseconds self{};
+    GasAmount gas{};
+    size_t ipld_gets{};
+    size_t ipld_puts{};
+    size_t bytes_read{};
+    size_t bytes_written{};
+    /// Invocation count by total wall time
+    std::array<size_t, kProfileBuckets.size() + 1> histogram{};
+  };
+
+  /// Profiles invocation in scope, nested scopes form call stack
+  struct Profile {
+    Profile(const CID &code, uint64_t method);
+    ~Profile();
+
+    Profile(const Profile &) = delete;
+    Profile &operator=(const Profile &) = delete;
+
+   private:
+    bool active;
+  };
+
+  void profileCharge(GasAmount gas);
+  void profileIpldGet(size_t bytes);
+  void profileIpldPut(size_t bytes);
+
+  std::map<ProfileKey, ProfileStats> profileStats();
+
+  void profileReset();
+
+  /// Write collapsed stacks of self time in microseconds for flamegraph.pl
+  void dumpFlamegraph(std::ostream &os);
+
+  /// Write stats in Prometheus text exposition format
+  void dumpPrometheus(std::ostream &os);
+}  // namespace fc::dvm
@@ -5,6 +5,7 @@
 
 #include "vm/interpreter/impl/interpreter_impl.hpp"
 
+#include "common/metrics.hpp"
 #include "const.hpp"
 #include "vm/actor/builtin/v0/cron/cron_actor.hpp"
 #include "vm/actor/builtin/v0/reward/reward_actor.hpp"
@@ -49,8 +50,10 @@ namespace fc::vm::interpreter {
   using runtime::MessageReceipt;
 
   InterpreterImpl::InterpreterImpl(
-      std::shared_ptr<RuntimeRandomness> randomness)
-      : randomness_{std::move(randomness)} {}
+      std::shared_ptr<RuntimeRandomness> randomness,
+      std::shared_ptr<NodeCache> hamt_cache)
+      : randomness_{std::move(randomness)},
+        hamt_cache_{std::move(hamt_cache)} {}
 
   outcome::result<Result> InterpreterImpl::interpret(
       const IpldPtr &ipld, const TipsetCPtr &tipset) const {
@@ -67,6 +70,10 @@ namespace fc::vm::interpreter {
       const IpldPtr &ipld,
       const TipsetCPtr &tipset,
       std::vector<MessageReceipt> *all_receipts) const {
+    static auto &latency{common::metrics::histogram(
+        "fc_interpreter_apply_blocks_seconds",
+        "Time to apply messages of tipset")};
+    common::metrics::Timer timer{latency};
     auto on_receipt{[&](auto &receipt) {
       if (all_receipts) {
         all_receipts->push_back(receipt);
@@ -78,7 +85,7 @@ namespace fc::vm::interpreter {
     }
 
     auto env = std::make_shared<Env>(
-        std::make_shared<InvokerImpl>(), randomness_, ipld, tipset);
+        std::make_shared<InvokerImpl>(), randomness_, ipld, tipset, hamt_cache_);
 
     auto cron{[&]() -> outcome::result<void> {
       OUTCOME_TRY(receipt,
@@ -109,7 +116,7 @@ namespace fc::vm::interpreter {
       env->epoch = tipset->height();
     }
 
-    adt::Array<MessageReceipt> receipts{ipld};
+    std::vector<MessageReceipt> receipts;
     MessageVisitor message_visitor{ipld};
     for (auto &block : tipset->blks) {
       AwardBlockReward::Params reward{
@@ -129,7 +136,7 @@ namespace fc::vm::interpreter {
             reward.penalty += apply.penalty;
             reward.gas_reward += apply.reward;
             on_receipt(apply.receipt);
-            OUTCOME_TRY(receipts.append(std::move(apply.receipt)));
+            receipts.push_back(std::move(apply.receipt));
             return outcome::success();
           }));
 
@@ -155,11 +162,12 @@ namespace fc::vm::interpreter {
 
     OUTCOME_TRY(new_state_root, env->state_tree->flush());
 
-    OUTCOME_TRY(Ipld::flush(receipts));
+    OUTCOME_TRY(receipts_array,
+                adt::Array<MessageReceipt>::fromValues(ipld, receipts));
 
     return Result{
         new_state_root,
-        receipts.amt.cid(),
+        receipts_array.amt.cid(),
     };
   }
 
@@ -199,19 +207,43 @@ namespace fc::vm::interpreter {
 
   outcome::result<Result> CachedInterpreter::interpret(
       const IpldPtr &ipld, const TipsetCPtr &tipset) const {
+    {
+      std::lock_guard lock{mutex};
+      if (auto indexed{index.get(tipset->key)}) {
+        if (!*indexed) {
+          return InterpreterError::kTipsetMarkedBad;
+        }
+        return indexed->value();
+      }
+    }
     common::Buffer key(tipset->key.hash());
-    OUTCOME_TRY(saved_result, getSavedResult(*store, key));
-    if (saved_result) {
-      return saved_result.value();
+    auto saved_result{getSavedResult(*store, key)};
+    if (!saved_result) {
+      if (saved_result.error() == InterpreterError::kTipsetMarkedBad) {
+        remember(tipset->key, boost::none);
+      }
+      return saved_result.error();
+    }
+    if (saved_result.value()) {
+      remember(tipset->key, saved_result.value());
+      return saved_result.value().value();
     }
     auto result = interpreter->interpret(ipld, tipset);
     if (!result) {
       OUTCOME_TRY(raw, codec::cbor::encode(boost::optional<Result>{}));
       OUTCOME_TRY(store->put(key, raw));
+      remember(tipset->key, boost::none);
     } else {
       OUTCOME_TRY(raw, codec::cbor::encode(result.value()));
       OUTCOME_TRY(store->put(key, raw));
+      remember(tipset->key, result.value());
     }
     return result;
   }
+
+  void CachedInterpreter::remember(
+      const TipsetKey &key, const boost::optional<Result> &result) const {
+    std::lock_guard lock{mutex};
+    index.put(key, result, 1);
+  }
 }  // namespace fc::vm::interpreter
@@ -6,7 +6,11 @@
 #ifndef CPP_FILECOIN_CORE_VM_INTERPRETER_INTERPRETER_IMPL_HPP
 #define CPP_FILECOIN_CORE_VM_INTERPRETER_INTERPRETER_IMPL_HPP
 
+#include <mutex>
+
+#include "common/lru_cache.hpp"
 #include "storage/buffer_map.hpp"
+#include "storage/hamt/node_cache.hpp"
 #include "vm/interpreter/interpreter.hpp"
 #include "vm/runtime/runtime_randomness.hpp"
 #include "vm/runtime/runtime_types.hpp"
@@ -15,10 +19,13 @@ namespace fc::vm::interpreter {
   using runtime::MessageReceipt;
   using runtime::RuntimeRandomness;
   using storage::PersistentBufferMap;
+  using storage::hamt::NodeCache;
 
   class InterpreterImpl : public Interpreter {
    public:
-    explicit InterpreterImpl(std::shared_ptr<RuntimeRandomness> randomness);
+    explicit InterpreterImpl(std::shared_ptr<RuntimeRandomness> randomness,
+                             std::shared_ptr<NodeCache> hamt_cache =
+                                 std::make_shared<NodeCache>());
 
     outcome::result<Result> interpret(const IpldPtr &store,
                                       const TipsetCPtr &tipset) const override;
@@ -34,19 +41,40 @@ namespace fc::vm::interpreter {
     bool hasDuplicateMiners(const std::vector<BlockHeader> &blocks) const;
 
     std::shared_ptr<RuntimeRandomness> randomness_;
+    /// Shared by state trees of consecutive interpreted tipsets
+    std::shared_ptr<NodeCache> hamt_cache_;
   };
 
+  /**
+   * Persists results of interpreter by tipset key, bad tipsets are persisted
+   * as none. Recently used results are kept in memory, so repeated requests
+   * neither execute nor read store.
+   */
   class CachedInterpreter : public Interpreter {
    public:
+    /// Results kept in memory by default
+    static constexpr size_t kDefaultIndexSize{1 << 12};
+
     CachedInterpreter(std::shared_ptr<Interpreter> interpreter,
-                      std::shared_ptr<PersistentBufferMap> store)
-        : interpreter{std::move(interpreter)}, store{std::move(store)} {}
+                      std::shared_ptr<PersistentBufferMap> store,
+                      size_t index_size = kDefaultIndexSize)
+        : interpreter{std::move(interpreter)},
+          store{std::move(store)},
+          index{index_size} {}
     outcome::result<Result> interpret(const IpldPtr &store,
                                       const TipsetCPtr &tipset) const override;
 
    private:
+    using TipsetKey = primitives::tipset::TipsetKey;
+
+    void remember(const TipsetKey &key,
+                  const boost::optional<Result> &result) const;
+
     std::shared_ptr<Interpreter> interpreter;
     std::shared_ptr<PersistentBufferMap> store;
+    mutable std::mutex mutex;
+    /// Recently used results, none for bad tipset
+    mutable common::LruCache<TipsetKey, boost::optional<Result>> index;
   };
 }  // namespace fc::vm::interpreter
 
@@ -0,0 +1,36 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/message/encoded_message.hpp"
+
+#include "codec/cbor/cbor_view.hpp"
+
+namespace fc::vm::message {
+  outcome::result<EncodedMessage> EncodedMessage::make(SignedMessage message) {
+    EncodedMessage encoded;
+    OUTCOME_TRYA(encoded.unsigned_bytes, codec::cbor::encode(message.message));
+    OUTCOME_TRYA(encoded.unsigned_cid, getCidOf(encoded.unsigned_bytes));
+    if (!message.signature.isBls()) {
+      OUTCOME_TRYA(encoded.signed_bytes, codec::cbor::encode(message));
+      OUTCOME_TRYA(encoded.signed_cid, getCidOf(encoded.signed_bytes));
+    }
+    encoded.message = std::move(message);
+    return encoded;
+  }
+
+  outcome::result<EncodedMessage> EncodedMessage::decode(BytesIn input) {
+    EncodedMessage encoded;
+    OUTCOME_TRYA(encoded.message, codec::cbor::decode<SignedMessage>(input));
+    OUTCOME_TRY(root, codec::cbor::CborView::make(input));
+    OUTCOME_TRY(unsigned_view, root.at(0));
+    encoded.unsigned_bytes = Buffer{unsigned_view.raw()};
+    OUTCOME_TRYA(encoded.unsigned_cid, getCidOf(encoded.unsigned_bytes));
+    if (!encoded.message.signature.isBls()) {
+      encoded.signed_bytes = Buffer{input};
+      OUTCOME_TRYA(encoded.signed_cid, getCidOf(encoded.signed_bytes));
+    }
+    return encoded;
+  }
+}  // namespace fc::vm::message
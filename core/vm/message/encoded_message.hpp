@@ -0,0 +1,45 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "vm/message/message.hpp"
+
+namespace fc::vm::message {
+  /**
+   * Signed message with encodings and cids computed once, on decode or first
+   * encode, so pool and sync paths don't encode and hash it again.
+   * Bls messages are included in blocks unsigned, so their signed encoding is
+   * not kept.
+   */
+  struct EncodedMessage {
+    static outcome::result<EncodedMessage> make(SignedMessage message);
+
+    /// Keeps input bytes of encoded signed message
+    static outcome::result<EncodedMessage> decode(BytesIn input);
+
+    /// Cid of message in block, of unsigned one for bls
+    const CID &cid() const {
+      return signed_cid ? *signed_cid : unsigned_cid;
+    }
+
+    /// Encoding stored under cid
+    BytesIn bytes() const {
+      return signed_cid ? signed_bytes : unsigned_bytes;
+    }
+
+    size_t chainSize() const {
+      return bytes().size();
+    }
+
+    SignedMessage message;
+    /// Signed by sender, also stored for secp messages
+    Buffer unsigned_bytes;
+    CID unsigned_cid;
+    /// Empty for bls
+    Buffer signed_bytes;
+    boost::optional<CID> signed_cid;
+  };
+}  // namespace fc::vm::message
@@ -0,0 +1,79 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "codec/cbor/cbor_view.hpp"
+#include "vm/message/message.hpp"
+
+namespace fc::vm::message {
+  using codec::cbor::CborView;
+
+  /**
+   * Lazy view of encoded unsigned or signed message, decodes only requested
+   * fields. Addresses are borrowed encoded bytes, compare them with
+   * `address::encode` result.
+   */
+  class MessageView {
+   public:
+    using BytesIn = CborView::BytesIn;
+
+    static outcome::result<MessageView> make(BytesIn input) {
+      OUTCOME_TRY(root, CborView::make(input));
+      auto is_signed{root.size() == kSignedFields};
+      if (is_signed) {
+        OUTCOME_TRYA(root, root.at(0));
+      }
+      if (root.size() != kFields) {
+        return codec::cbor::CborDecodeError::kWrongSize;
+      }
+      return MessageView{std::move(root), is_signed};
+    }
+
+    bool isSigned() const {
+      return is_signed_;
+    }
+
+    outcome::result<BytesIn> to() const {
+      OUTCOME_TRY(item, message_.at(1));
+      return item.asBytes();
+    }
+
+    outcome::result<BytesIn> from() const {
+      OUTCOME_TRY(item, message_.at(2));
+      return item.asBytes();
+    }
+
+    outcome::result<uint64_t> nonce() const {
+      OUTCOME_TRY(item, message_.at(3));
+      return item.asUint();
+    }
+
+    outcome::result<GasAmount> gasLimit() const {
+      OUTCOME_TRY(item, message_.at(5));
+      return item.asInt();
+    }
+
+    outcome::result<MethodNumber> method() const {
+      OUTCOME_TRY(item, message_.at(8));
+      return item.asUint();
+    }
+
+    /// Decodes whole unsigned message
+    outcome::result<UnsignedMessage> decode() const {
+      return message_.decode<UnsignedMessage>();
+    }
+
+   private:
+    static constexpr size_t kFields{10};
+    static constexpr size_t kSignedFields{2};
+
+    MessageView(CborView message, bool is_signed)
+        : message_{std::move(message)}, is_signed_{is_signed} {}
+
+    CborView message_;
+    bool is_signed_;
+  };
+}  // namespace fc::vm::message
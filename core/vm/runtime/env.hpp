@@ -29,14 +29,17 @@ namespace fc::vm::runtime {
     Env(std::shared_ptr<Invoker> invoker,
         std::shared_ptr<RuntimeRandomness> randomness,
         IpldPtr ipld,
-        TipsetCPtr tipset)
+        TipsetCPtr tipset,
+        std::shared_ptr<state::NodeCache> hamt_cache = nullptr)
         : state_tree{std::make_shared<StateTreeImpl>(
-            ipld, tipset->getParentStateRoot())},
+            ipld, tipset->getParentStateRoot(), std::move(hamt_cache))},
           invoker{std::move(invoker)},
           randomness{std::move(randomness)},
           ipld{std::move(ipld)},
           epoch{tipset->height()},
-          tipset{std::move(tipset)} {}
+          tipset{std::move(tipset)},
+          pricelist{version::getNetworkVersion(
+              static_cast<ChainEpoch>(epoch))} {}
 
     struct Apply {
       MessageReceipt receipt;
@@ -5,6 +5,7 @@
 
 #include "vm/runtime/env.hpp"
 
+#include "common/logger.hpp"
 #include "vm/actor/builtin/v0/account/account_actor.hpp"
 #include "vm/actor/builtin/v0/codes.hpp"
 #include "vm/actor/builtin/v2/account/account_actor.hpp"
@@ -13,6 +14,7 @@
 #include "vm/exit_code/exit_code.hpp"
 #include "vm/runtime/impl/runtime_impl.hpp"
 #include "vm/runtime/runtime_error.hpp"
+#include "vm/state/impl/address_cache.hpp"
 
 #include "vm/dvm/dvm.hpp"
 
@@ -24,23 +26,77 @@ namespace fc::vm::runtime {
   using actor::kRewardAddress;
   using actor::kSendMethodNumber;
   using actor::kSystemActorAddress;
+  using actor::NativeMode;
   using storage::hamt::HamtError;
   using version::getNetworkVersion;
 
+  /**
+   * Invokes method both natively and with go actors from same state, logs
+   * difference of results, state roots or gas used, keeps go actors result
+   */
+  outcome::result<InvocationOutput> invokeDifferential(
+      const std::shared_ptr<Execution> &execution,
+      const Actor &actor,
+      Runtime &runtime,
+      const UnsignedMessage &message) {
+    auto &state_tree{*execution->state_tree};
+    auto gas_used{execution->gas_used};
+    auto actors_created{execution->actors_created};
+    OUTCOME_TRY(snapshot, state_tree.flush());
+    auto native{execution->env->invoker->invoke(
+        actor, runtime, message.method, message.params)};
+    auto native_gas{execution->gas_used};
+    OUTCOME_TRY(native_root, state_tree.flush());
+
+    OUTCOME_TRY(state_tree.revert(snapshot));
+    execution->gas_used = gas_used;
+    execution->actors_created = actors_created;
+    auto cgo{actor::cgo::invoke(
+        execution, message, actor.code, message.method, message.params)};
+    OUTCOME_TRY(cgo_root, state_tree.flush());
+
+    auto same_result{native ? cgo && native.value() == cgo.value()
+                            : !cgo && native.error() == cgo.error()};
+    if (!same_result || native_root != cgo_root
+        || native_gas != execution->gas_used) {
+      static auto log{common::createLogger("native actors")};
+      log->warn("mismatch {} method {}: {} ({}, gas {}) vs go {} ({}, gas {})",
+                actor.code,
+                message.method,
+                native ? "ok" : native.error().message(),
+                native_root,
+                native_gas,
+                cgo ? "ok" : cgo.error().message(),
+                cgo_root,
+                execution->gas_used);
+    }
+    return cgo;
+  }
+
   outcome::result<Address> resolveKey(StateTree &state_tree,
                                       const Address &address,
                                       bool no_actor) {
     if (address.isKeyType()) {
       return address;
     }
+    auto &cache{state::AddressCache::shared()};
     if (auto _actor{state_tree.get(address)}) {
       auto &actor{_actor.value()};
+      if (isAccountActor(actor.code)) {
+        if (auto key{cache.key(actor.head)}) {
+          if (!no_actor || key->isKeyType()) {
+            return *key;
+          }
+          return VMExitCode::kSysErrInvalidParameters;
+        }
+      }
       if (actor.code == actor::builtin::v0::kAccountCodeCid) {
         if (auto _state{
                 state_tree.getStore()
                     ->getCbor<actor::builtin::v0::account::AccountActorState>(
                         actor.head)}) {
           auto &key{_state.value().address};
+          cache.putKey(actor.head, key);
           if (!no_actor || key.isKeyType()) {
             return key;
           }
@@ -52,6 +108,7 @@ namespace fc::vm::runtime {
                     ->getCbor<actor::builtin::v2::account::AccountActorState>(
                         actor.head)}) {
           auto &key{_state.value().address};
+          cache.putKey(actor.head, key);
           if (!no_actor || key.isKeyType()) {
             return key;
           }
@@ -113,15 +170,15 @@ namespace fc::vm::runtime {
     ++from.nonce;
     OUTCOME_TRY(state_tree->set(message.from, from));
 
-    OUTCOME_TRY(snapshot, state_tree->flush());
+    state_tree->checkpoint();
     auto result{execution->send(message, msg_gas_cost)};
     auto exit_code = VMExitCode::kOk;
     if (!result) {
-      if (!isVMExitCode(result.error())) {
-        return result.error();
-      }
-      exit_code = VMExitCode{result.error().value()};
+      exit_code = isVMExitCode(result.error())
+                      ? VMExitCode{result.error().value()}
+                      : VMExitCode::kFatal;
       if (exit_code == VMExitCode::kFatal) {
+        state_tree->rollback();
         return result.error();
       }
     } else {
@@ -138,7 +195,9 @@ namespace fc::vm::runtime {
       }
     }
     if (exit_code != VMExitCode::kOk) {
-      OUTCOME_TRY(state_tree->revert(snapshot));
+      state_tree->rollback();
+    } else {
+      state_tree->commit();
     }
     auto limit{message.gas_limit}, &used{execution->gas_used};
     if (used < 0) {
@@ -259,12 +318,13 @@ namespace fc::vm::runtime {
 
   outcome::result<InvocationOutput> Execution::sendWithRevert(
       const UnsignedMessage &message) {
-    OUTCOME_TRY(snapshot, state_tree->flush());
+    state_tree->checkpoint();
     auto result = send(message);
     if (!result) {
-      OUTCOME_TRY(state_tree->revert(snapshot));
+      state_tree->rollback();
       return result.error();
     }
+    state_tree->commit();
     return result;
   }
 
@@ -285,6 +345,7 @@ namespace fc::vm::runtime {
     } else {
       to_actor = maybe_to_actor.value();
     }
+    dvm::Profile profile{to_actor.code, message.method};
     OUTCOME_TRY(chargeGas(
         env->pricelist.onMethodInvocation(message.value, message.method)));
     OUTCOME_TRY(caller_id, state_tree->lookupId(message.from));
@@ -316,7 +377,17 @@ namespace fc::vm::runtime {
     if (message.method != kSendMethodNumber) {
       RuntimeImpl runtime{
           shared_from_this(), env->randomness, _message, caller_id};
-      // TODO: check cpp actor
+      auto mode{env->invoker
+                    ? env->invoker->nativeMode(to_actor.code, _message.method)
+                    : NativeMode::kOff};
+      if (mode == NativeMode::kOn) {
+        return env->invoker->invoke(
+            to_actor, runtime, _message.method, _message.params);
+      }
+      if (mode == NativeMode::kDifferential) {
+        return invokeDifferential(
+            shared_from_this(), to_actor, runtime, _message);
+      }
       return actor::cgo::invoke(shared_from_this(),
                                 _message,
                                 to_actor.code,
@@ -339,6 +410,7 @@ namespace fc::vm::runtime {
     auto execution{execution_.lock()};
     OUTCOME_TRY(execution->chargeGas(execution->env->pricelist.onIpldGet()));
     OUTCOME_TRY(value, execution->env->ipld->get(key));
+    dvm::onIpldGet(key, value);
     return std::move(value);
   }
 }  // namespace fc::vm::runtime
@@ -9,6 +9,7 @@
 #include "crypto/secp256k1/impl/secp256k1_provider_impl.hpp"
 #include "primitives/cid/comm_cid.hpp"
 #include "proofs/proofs.hpp"
+#include "proofs/verify_cache.hpp"
 #include "storage/keystore/impl/in_memory/in_memory_keystore.hpp"
 #include "vm/actor/builtin/v0/account/account_actor.hpp"
 #include "vm/runtime/env.hpp"
@@ -179,7 +180,10 @@ namespace fc::vm::runtime {
       const WindowPoStVerifyInfo &info) {
     WindowPoStVerifyInfo preprocess_info = info;
     preprocess_info.randomness[31] = 0;
-    return proofs::Proofs::verifyWindowPoSt(preprocess_info);
+    return proofs::VerifyCache::instance().verify(
+        proofs::VerifyKind::kWindowPoSt,
+        preprocess_info,
+        proofs::Proofs::verifyWindowPoSt);
   }
 
   fc::outcome::result<fc::CID> RuntimeImpl::computeUnsealedSectorCid(
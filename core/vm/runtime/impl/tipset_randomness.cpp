@@ -8,21 +8,29 @@
 namespace fc::vm::runtime {
 
   TipsetRandomness::TipsetRandomness(std::shared_ptr<Ipld> ipld,
-                                     TipsetCPtr tipset)
-      : ipld_{std::move(ipld)}, tipset_{std::move(tipset)} {}
+                                     TipsetCPtr tipset,
+                                     std::shared_ptr<RandomnessCache> cache)
+      : ipld_{std::move(ipld)},
+        tipset_{std::move(tipset)},
+        cache_{std::move(cache)} {
+    if (!cache_) {
+      // repeated lookups of same rounds during one interpretation
+      cache_ = std::make_shared<RandomnessCache>();
+    }
+  }
 
   outcome::result<Randomness> TipsetRandomness::getRandomnessFromTickets(
       DomainSeparationTag tag,
       ChainEpoch epoch,
       gsl::span<const uint8_t> seed) const {
-    return tipset_->ticketRandomness(*ipld_, tag, epoch, seed);
+    return tipset_->ticketRandomness(*ipld_, tag, epoch, seed, cache_.get());
   }
 
   outcome::result<Randomness> TipsetRandomness::getRandomnessFromBeacon(
       DomainSeparationTag tag,
       ChainEpoch epoch,
       gsl::span<const uint8_t> seed) const {
-    return tipset_->beaconRandomness(*ipld_, tag, epoch, seed);
+    return tipset_->beaconRandomness(*ipld_, tag, epoch, seed, cache_.get());
   }
 
 }  // namespace fc::vm::runtime
@@ -6,15 +6,19 @@
 #ifndef CPP_FILECOIN_CORE_VM_RUNTIME_IMPL_TIPSET_RANDOMNESS_HPP
 #define CPP_FILECOIN_CORE_VM_RUNTIME_IMPL_TIPSET_RANDOMNESS_HPP
 
-#include "primitives/tipset/tipset.hpp"
+#include "primitives/tipset/randomness_cache.hpp"
 #include "vm/runtime/runtime_randomness.hpp"
 
 namespace fc::vm::runtime {
+  using primitives::tipset::RandomnessCache;
   using primitives::tipset::TipsetCPtr;
 
   class TipsetRandomness : public RuntimeRandomness {
    public:
-    TipsetRandomness(std::shared_ptr<Ipld> ipld, TipsetCPtr tipset);
+    /// Cache may be shared by randomness of tipsets of same chain
+    TipsetRandomness(std::shared_ptr<Ipld> ipld,
+                     TipsetCPtr tipset,
+                     std::shared_ptr<RandomnessCache> cache = nullptr);
 
     outcome::result<Randomness> getRandomnessFromTickets(
         DomainSeparationTag tag,
@@ -29,6 +33,7 @@ namespace fc::vm::runtime {
    private:
     std::shared_ptr<Ipld> ipld_;
     TipsetCPtr tipset_;
+    std::shared_ptr<RandomnessCache> cache_;
   };
 
 }  // namespace fc::vm::runtime
@@ -8,74 +8,146 @@
 
 #include "primitives/sector/sector.hpp"
 #include "primitives/types.hpp"
+#include "vm/version.hpp"
 
 namespace fc::vm::runtime {
   using primitives::GasAmount;
   using primitives::TokenAmount;
   using primitives::sector::WindowPoStVerifyInfo;
+  using version::NetworkVersion;
 
+  /// Gas price schedule constants
+  struct PriceTable {
+    GasAmount storage_multiplier;
+    GasAmount on_chain_message_compute;
+    GasAmount on_chain_message_storage_base;
+    GasAmount send_base;
+    GasAmount send_transfer_funds;
+    GasAmount send_transfer_only_premium;
+    GasAmount send_invoke_method;
+    GasAmount ipld_get_base;
+    GasAmount ipld_put_base;
+    GasAmount create_actor_compute;
+    GasAmount create_actor_storage;
+    GasAmount delete_actor;
+    GasAmount verify_signature_bls;
+    GasAmount verify_signature_secp256k1;
+    GasAmount hashing_base;
+    GasAmount compute_unsealed_sector_cid_base;
+    GasAmount verify_seal_base;
+    GasAmount verify_post_flat;
+    GasAmount verify_post_scale;
+    GasAmount verify_post_flat_32g_64g;
+    GasAmount verify_post_scale_32g_64g;
+    GasAmount verify_consensus_fault;
+  };
+
+  constexpr PriceTable kPricesV0{
+      .storage_multiplier = 1000,
+      .on_chain_message_compute = 38863,
+      .on_chain_message_storage_base = 36,
+      .send_base = 29233,
+      .send_transfer_funds = 27500,
+      .send_transfer_only_premium = 159672,
+      .send_invoke_method = -5377,
+      .ipld_get_base = 75242,
+      .ipld_put_base = 84070,
+      .create_actor_compute = 1108454,
+      .create_actor_storage = 36 + 40,
+      .delete_actor = -(36 + 40),
+      .verify_signature_bls = 16598605,
+      .verify_signature_secp256k1 = 1637292,
+      .hashing_base = 31355,
+      .compute_unsealed_sector_cid_base = 98647,
+      .verify_seal_base = 2000,
+      .verify_post_flat = 123861062,
+      .verify_post_scale = 9226981,
+      .verify_post_flat_32g_64g = 748593537,
+      .verify_post_scale_32g_64g = 85639,
+      .verify_consensus_fault = 495422,
+  };
+
+  /// Price table of network version, all supported versions share v0 prices
+  constexpr const PriceTable &priceTable(NetworkVersion version) {
+    return kPricesV0;
+  }
+
+  /// Gas charges, price table is selected once (e.g. per Env)
   struct Pricelist {
+    constexpr Pricelist() = default;
+    constexpr explicit Pricelist(NetworkVersion version)
+        : prices{&priceTable(version)} {}
+
     GasAmount make(GasAmount compute, GasAmount storage) const {
-      return compute + storage * 1000;
+      return compute + storage * prices->storage_multiplier;
     }
     GasAmount onChainMessage(size_t size) const {
-      return make(38863, 36 + size);
+      return make(prices->on_chain_message_compute,
+                  prices->on_chain_message_storage_base + size);
     }
     GasAmount onChainReturnValue(size_t size) const {
       return make(0, size);
     }
     GasAmount onMethodInvocation(TokenAmount value, uint64_t method) const {
-      GasAmount gas{29233};
+      auto gas{prices->send_base};
       if (value != 0) {
-        gas += 27500;
+        gas += prices->send_transfer_funds;
         if (method == 0) {
-          gas += 159672;
+          gas += prices->send_transfer_only_premium;
         }
       }
       if (method != 0) {
-        gas += -5377;
+        gas += prices->send_invoke_method;
       }
       return make(gas, 0);
     }
     GasAmount onIpldGet() const {
-      return make(75242, 0);
+      return make(prices->ipld_get_base, 0);
     }
     GasAmount onIpldPut(size_t size) const {
-      return make(84070, size);
+      return make(prices->ipld_put_base, size);
     }
     GasAmount onCreateActor() const {
-      return make(1108454, 36 + 40);
+      return make(prices->create_actor_compute, prices->create_actor_storage);
     }
     GasAmount onDeleteActor() const {
-      return make(0, -(36 + 40));
+      return make(0, prices->delete_actor);
     }
     GasAmount onVerifySignature(bool bls) const {
-      return make(bls ? 16598605 : 1637292, 0);
+      return make(bls ? prices->verify_signature_bls
+                      : prices->verify_signature_secp256k1,
+                  0);
     }
     GasAmount onHashing() const {
-      return make(31355, 0);
+      return make(prices->hashing_base, 0);
     }
     GasAmount onComputeUnsealedSectorCid() const {
-      return make(98647, 0);
+      return make(prices->compute_unsealed_sector_cid_base, 0);
     }
     GasAmount onVerifySeal() const {
-      return make(2000, 0);
+      return make(prices->verify_seal_base, 0);
     }
     GasAmount onVerifyPost(const WindowPoStVerifyInfo &info) const {
-      int64_t flat{123861062}, scale{9226981};
+      auto flat{prices->verify_post_flat}, scale{prices->verify_post_scale};
       if (!info.proofs.empty()) {
         auto type{info.proofs[0].registered_proof};
         if (type == RegisteredProof::StackedDRG32GiBWindowPoSt
             || type == RegisteredProof::StackedDRG64GiBWindowPoSt) {
-          flat = 748593537;
-          scale = 85639;
+          flat = prices->verify_post_flat_32g_64g;
+          scale = prices->verify_post_scale_32g_64g;
         }
       }
-      return make((flat + scale * info.challenged_sectors.size()) / 2, 0);
+      return make(
+          (flat + scale * static_cast<GasAmount>(info.challenged_sectors.size()))
+              / 2,
+          0);
     }
     GasAmount onVerifyConsensusFault() const {
-      return make(495422, 0);
+      return make(prices->verify_consensus_fault, 0);
     }
+
+   private:
+    const PriceTable *prices{&kPricesV0};
   };
 }  // namespace fc::vm::runtime
 
@@ -0,0 +1,41 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/state/impl/address_cache.hpp"
+
+#include "primitives/address/address_codec.hpp"
+
+namespace fc::vm::state {
+  using primitives::address::encode;
+
+  AddressCache::AddressCache(size_t max_entries)
+      : keys_{max_entries}, accounts_{max_entries} {}
+
+  AddressCache &AddressCache::shared() {
+    static AddressCache cache;
+    return cache;
+  }
+
+  boost::optional<Address> AddressCache::key(const CID &head) {
+    std::lock_guard lock{mutex_};
+    return keys_.get(head);
+  }
+
+  void AddressCache::putKey(const CID &head, const Address &key) {
+    std::lock_guard lock{mutex_};
+    keys_.put(head, key, 1);
+  }
+
+  boost::optional<AddressCache::Account> AddressCache::account(
+      const Address &key) {
+    std::lock_guard lock{mutex_};
+    return accounts_.get(Buffer{encode(key)});
+  }
+
+  void AddressCache::putAccount(const Address &key, const Account &account) {
+    std::lock_guard lock{mutex_};
+    accounts_.put(Buffer{encode(key)}, account, 1);
+  }
+}  // namespace fc::vm::state
@@ -0,0 +1,54 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "common/buffer.hpp"
+#include "common/lru_cache.hpp"
+#include "primitives/address/address.hpp"
+#include "primitives/cid/cid.hpp"
+
+namespace fc::vm::state {
+  using primitives::address::Address;
+
+  /**
+   * Bounded cache of account addresses.
+   * Account actor state is immutable and content addressed, so key address
+   * by account head is valid for any state tree.
+   * Id by key address depends on state, so it is remembered with account head
+   * and callers must check that actor with that id still has that head.
+   */
+  class AddressCache {
+   public:
+    struct Account {
+      Address id;
+      CID head;
+    };
+
+    static constexpr size_t kDefaultMaxEntries{1 << 16};
+
+    explicit AddressCache(size_t max_entries = kDefaultMaxEntries);
+
+    /// Cache shared by all state trees of process
+    static AddressCache &shared();
+
+    /// Key address of account actor with head
+    boost::optional<Address> key(const CID &head);
+
+    void putKey(const CID &head, const Address &key);
+
+    /// Last seen account actor with key address
+    boost::optional<Account> account(const Address &key);
+
+    void putAccount(const Address &key, const Account &account);
+
+   private:
+    std::mutex mutex_;
+    common::LruCache<CID, Address> keys_;
+    common::LruCache<Buffer, Account> accounts_;
+  };
+}  // namespace fc::vm::state
@@ -0,0 +1,32 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/state/impl/overlay_state_tree.hpp"
+
+namespace fc::vm::state {
+  OverlayStateTree::OverlayStateTree(IpldPtr base,
+                                     const CID &root,
+                                     std::shared_ptr<NodeCache> hamt_cache)
+      : OverlayStateTree{std::make_shared<BatchDatastore>(std::move(base)),
+                         root,
+                         std::move(hamt_cache)} {}
+
+  OverlayStateTree::OverlayStateTree(std::shared_ptr<BatchDatastore> overlay,
+                                     const CID &root,
+                                     std::shared_ptr<NodeCache> hamt_cache)
+      : StateTreeImpl{overlay, root, std::move(hamt_cache)},
+        overlay_{std::move(overlay)},
+        base_root_{root} {}
+
+  void OverlayStateTree::discard() {
+    overlay_->discard();
+    // base root is readable from base datastore, revert can't fail
+    std::ignore = revert(base_root_);
+  }
+
+  const CID &OverlayStateTree::baseRoot() const {
+    return base_root_;
+  }
+}  // namespace fc::vm::state
@@ -0,0 +1,41 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "storage/ipfs/impl/batch_datastore.hpp"
+#include "vm/state/impl/state_tree_impl.hpp"
+
+namespace fc::vm::state {
+  using storage::ipfs::BatchDatastore;
+
+  /**
+   * Copy-on-write state tree over read-only base state.
+   * All writes (hamt nodes and actor states) are kept in memory and never
+   * reach base datastore, so overlay may be dropped without cleanup.
+   * Decoded base nodes are shared through hamt cache, so repeated overlays
+   * over same state root (e.g. StateCall, gas estimation) skip cold loads.
+   */
+  class OverlayStateTree : public StateTreeImpl {
+   public:
+    OverlayStateTree(IpldPtr base,
+                     const CID &root,
+                     std::shared_ptr<NodeCache> hamt_cache);
+
+    /// Drop all in-memory changes and return to base root
+    void discard();
+
+    /// Base state root
+    const CID &baseRoot() const;
+
+   private:
+    OverlayStateTree(std::shared_ptr<BatchDatastore> overlay,
+                     const CID &root,
+                     std::shared_ptr<NodeCache> hamt_cache);
+
+    std::shared_ptr<BatchDatastore> overlay_;
+    CID base_root_;
+  };
+}  // namespace fc::vm::state
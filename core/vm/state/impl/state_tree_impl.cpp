@@ -6,10 +6,12 @@
 #include "vm/state/impl/state_tree_impl.hpp"
 
 #include "vm/actor/builtin/v0/init/init_actor.hpp"
+#include "vm/state/impl/address_cache.hpp"
 #include "vm/dvm/dvm.hpp"
 
 namespace fc::vm::state {
   using actor::builtin::v0::init::InitActorState;
+  using storage::hamt::HamtError;
 
   StateTreeImpl::StateTreeImpl(const std::shared_ptr<IpfsDatastore> &store)
       : version_{StateTreeVersion::kVersion0}, store_{store}, by_id{store} {}
@@ -20,25 +22,52 @@ namespace fc::vm::state {
     setRoot(root);
   }
 
+  StateTreeImpl::StateTreeImpl(const std::shared_ptr<IpfsDatastore> &store,
+                               const CID &root,
+                               std::shared_ptr<NodeCache> hamt_cache)
+      : version_{StateTreeVersion::kVersion0},
+        store_{store},
+        hamt_cache_{std::move(hamt_cache)} {
+    setRoot(root);
+  }
+
   outcome::result<void> StateTreeImpl::set(const Address &address,
                                            const Actor &actor) {
     OUTCOME_TRY(address_id, lookupId(address));
     dvm::onActor(*this, address, actor);
-    return by_id.set(address_id, actor);
+    return setId(address_id, actor);
   }
 
   outcome::result<Actor> StateTreeImpl::get(const Address &address) {
     OUTCOME_TRY(address_id, lookupId(address));
-    return by_id.get(address_id);
+    OUTCOME_TRY(actor, tryGetId(address_id));
+    if (!actor) {
+      return HamtError::kNotFound;
+    }
+    return std::move(*actor);
   }
 
   outcome::result<Address> StateTreeImpl::lookupId(const Address &address) {
     if (address.isId()) {
       return address;
     }
+    auto &cache{AddressCache::shared()};
+    if (auto account{cache.account(address)}) {
+      OUTCOME_TRY(actor, tryGetId(account->id));
+      if (actor && actor->head == account->head
+          && actor::isAccountActor(actor->code)) {
+        return account->id;
+      }
+    }
     OUTCOME_TRY(init_actor_state, state<InitActorState>(actor::kInitAddress));
+    init_actor_state.address_map.hamt.cache = hamt_cache_;
     OUTCOME_TRY(id, init_actor_state.address_map.get(address));
-    return Address::makeFromId(id);
+    auto id_address{Address::makeFromId(id)};
+    OUTCOME_TRY(actor, tryGetId(id_address));
+    if (actor && actor::isAccountActor(actor->code)) {
+      cache.putAccount(address, {id_address, actor->head});
+    }
+    return id_address;
   }
 
   outcome::result<Address> StateTreeImpl::registerNewAddress(
@@ -46,6 +75,7 @@ namespace fc::vm::state {
     OUTCOME_TRY(init_actor, get(actor::kInitAddress));
     OUTCOME_TRY(init_actor_state,
                 store_->getCbor<InitActorState>(init_actor.head));
+    init_actor_state.address_map.hamt.cache = hamt_cache_;
     OUTCOME_TRY(address_id, init_actor_state.addActor(address));
     OUTCOME_TRYA(init_actor.head, store_->setCbor(init_actor_state));
     OUTCOME_TRY(set(actor::kInitAddress, init_actor));
@@ -53,6 +83,17 @@ namespace fc::vm::state {
   }
 
   outcome::result<CID> StateTreeImpl::flush() {
+    for (auto &[id, actor] : dirty_) {
+      if (actor) {
+        OUTCOME_TRY(by_id.set(id, *actor));
+      } else {
+        auto removed{by_id.remove(id)};
+        if (!removed && removed.error() != HamtError::kNotFound) {
+          return removed.error();
+        }
+      }
+    }
+    dirty_.clear();
     OUTCOME_TRY(Ipld::flush(by_id));
     auto new_root = by_id.hamt.cid();
     if (version_ == StateTreeVersion::kVersion0) {
@@ -64,6 +105,7 @@ namespace fc::vm::state {
   }
 
   outcome::result<void> StateTreeImpl::revert(const CID &root) {
+    dirty_.clear();
     setRoot(root);
     return outcome::success();
   }
@@ -74,7 +116,54 @@ namespace fc::vm::state {
 
   outcome::result<void> StateTreeImpl::remove(const Address &address) {
     OUTCOME_TRY(address_id, lookupId(address));
-    return by_id.remove(address_id);
+    OUTCOME_TRY(actor, tryGetId(address_id));
+    if (!actor) {
+      return HamtError::kNotFound;
+    }
+    return setId(address_id, boost::none);
+  }
+
+  void StateTreeImpl::checkpoint() {
+    checkpoints_.push_back(journal_.size());
+  }
+
+  void StateTreeImpl::commit() {
+    assert(!checkpoints_.empty());
+    checkpoints_.pop_back();
+    if (checkpoints_.empty()) {
+      journal_.clear();
+    }
+  }
+
+  void StateTreeImpl::rollback() {
+    assert(!checkpoints_.empty());
+    auto size{checkpoints_.back()};
+    checkpoints_.pop_back();
+    // journal keeps actors as they were, so undo survives flush in between
+    while (journal_.size() > size) {
+      auto &[id, actor]{journal_.back()};
+      dirty_[id] = std::move(actor);
+      journal_.pop_back();
+    }
+  }
+
+  outcome::result<boost::optional<Actor>> StateTreeImpl::tryGetId(
+      const Address &id) {
+    auto it{dirty_.find(id)};
+    if (it != dirty_.end()) {
+      return it->second;
+    }
+    return by_id.tryGet(id);
+  }
+
+  outcome::result<void> StateTreeImpl::setId(const Address &id,
+                                             boost::optional<Actor> actor) {
+    if (!checkpoints_.empty()) {
+      OUTCOME_TRY(old, tryGetId(id));
+      journal_.emplace_back(id, std::move(old));
+    }
+    dirty_[id] = std::move(actor);
+    return outcome::success();
   }
 
   void StateTreeImpl::setRoot(const CID &root) {
@@ -89,6 +178,7 @@ namespace fc::vm::state {
       version_ = StateTreeVersion::kVersion0;
       by_id = {root, store_};
     }
+    by_id.hamt.cache = hamt_cache_;
   }
 
 }  // namespace fc::vm::state
@@ -10,13 +10,20 @@
 
 #include "adt/address_key.hpp"
 #include "adt/map.hpp"
+#include "storage/hamt/node_cache.hpp"
 
 namespace fc::vm::state {
+  using storage::hamt::NodeCache;
+
   /// State tree
   class StateTreeImpl : public StateTree {
    public:
     explicit StateTreeImpl(const std::shared_ptr<IpfsDatastore> &store);
     StateTreeImpl(const std::shared_ptr<IpfsDatastore> &store, const CID &root);
+    /// Uses hamt node cache shared with other state trees
+    StateTreeImpl(const std::shared_ptr<IpfsDatastore> &store,
+                  const CID &root,
+                  std::shared_ptr<NodeCache> hamt_cache);
     /// Set actor state, does not write to storage
     outcome::result<void> set(const Address &address,
                               const Actor &actor) override;
@@ -35,7 +42,23 @@ namespace fc::vm::state {
     std::shared_ptr<IpfsDatastore> getStore() override;
     outcome::result<void> remove(const Address &address);
 
+    /**
+     * Start nested checkpoint, changes after it are journaled in memory and
+     * may be undone by rollback without flush or reload
+     */
+    void checkpoint();
+    /// Keep changes since last checkpoint, they belong to outer checkpoint
+    void commit();
+    /// Undo changes since last checkpoint
+    void rollback();
+
    private:
+    /// Actor by id address, with unflushed changes
+    outcome::result<boost::optional<Actor>> tryGetId(const Address &id);
+    /// Write actor by id address, journaled when checkpoint is open
+    outcome::result<void> setId(const Address &id,
+                                boost::optional<Actor> actor);
+
     /**
      * Sets root of StateTree
      * @param root - cid of hamt for StateTree v0 or cid of struct StateRoot for
@@ -45,7 +68,14 @@ namespace fc::vm::state {
 
     StateTreeVersion version_;
     std::shared_ptr<IpfsDatastore> store_;
+    std::shared_ptr<NodeCache> hamt_cache_;
     adt::Map<actor::Actor, adt::AddressKeyer> by_id;
+    /// Changes not yet written to hamt, none for removed actor
+    std::map<Address, boost::optional<Actor>> dirty_;
+    /// Previous actors of changed ids, in change order
+    std::vector<std::pair<Address, boost::optional<Actor>>> journal_;
+    /// Journal size at each open checkpoint
+    std::vector<size_t> checkpoints_;
   };
 }  // namespace fc::vm::state
 
@@ -0,0 +1,61 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "api/rpc/chan_queue.hpp"
+
+#include <gtest/gtest.h>
+
+namespace fc::api::rpc {
+  using crypto::signature::Secp256k1Signature;
+  using primitives::address::Address;
+  using vm::message::UnsignedMessage;
+
+  MpoolUpdate update(MpoolUpdate::Type type, uint64_t nonce) {
+    UnsignedMessage msg;
+    msg.from = Address::makeFromId(1);
+    msg.to = Address::makeFromId(2);
+    msg.nonce = nonce;
+    return {type, {msg, Secp256k1Signature{}}};
+  }
+
+  /// Vectors written while waiting are merged in order
+  TEST(ChanQueueTest, MergeVectors) {
+    ChanQueue<std::vector<int>> queue;
+    queue.push({1});
+    queue.push({2, 3});
+    queue.push({4});
+    EXPECT_EQ(queue.queue.size(), 1);
+    EXPECT_EQ(*queue.pop(), (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_FALSE(queue.pop());
+  }
+
+  /// Oldest values are dropped when queue is full
+  TEST(ChanQueueTest, DropOldest) {
+    ChanQueue<int> queue;
+    queue.max = 2;
+    EXPECT_EQ(queue.push(1), 0);
+    EXPECT_EQ(queue.push(2), 0);
+    EXPECT_EQ(queue.push(3), 1);
+    EXPECT_EQ(*queue.pop(), 2);
+    EXPECT_EQ(*queue.pop(), 3);
+  }
+
+  /// Removal cancels queued addition of same message only
+  TEST(ChanQueueTest, MpoolRemoveCancelsAdd) {
+    using Type = MpoolUpdate::Type;
+    ChanQueue<MpoolUpdate> queue;
+    queue.push(update(Type::ADD, 1));
+    queue.push(update(Type::ADD, 2));
+    queue.push(update(Type::REMOVE, 1));
+    queue.push(update(Type::REMOVE, 3));
+    ASSERT_EQ(queue.queue.size(), 2);
+    auto first{*queue.pop()};
+    EXPECT_EQ(first.type, Type::ADD);
+    EXPECT_EQ(first.message.message.nonce, 2);
+    auto second{*queue.pop()};
+    EXPECT_EQ(second.type, Type::REMOVE);
+    EXPECT_EQ(second.message.message.nonce, 3);
+  }
+}  // namespace fc::api::rpc
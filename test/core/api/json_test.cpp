@@ -102,3 +102,24 @@ TEST(ApiJsonTest, BigInt) {
   expectJson(BigInt{-1}, "\"-1\"");
   expectJson(BigInt{1}, "\"1\"");
 }
+
+/**
+ * @given json with all value types and api value
+ * @when encoded to cbor for binary rpc frames and decoded back
+ * @then same json is restored
+ */
+TEST(ApiJsonTest, CborFrames) {
+  std::string_view json{"{\"a\":[1,-2,true,null,\"x\"],\"bb\":{\"c\":[]}}"};
+  // rpc parser keeps numbers as strings, parse integers here
+  rapidjson::Document expected;
+  expected.Parse(json.data(), json.size());
+  EXPECT_OUTCOME_TRUE(cbor, fc::codec::json::toCbor(&expected));
+  EXPECT_OUTCOME_TRUE(decoded, fc::codec::json::fromCbor(cbor));
+  EXPECT_EQ(jsonEncode(decoded), fc::common::span::cbytes(json));
+
+  Signature signature{BlsSignature{b96}};
+  auto encoded{fc::api::encode(signature)};
+  EXPECT_OUTCOME_TRUE(cbor2, fc::codec::json::toCbor(&encoded));
+  EXPECT_OUTCOME_TRUE(decoded2, fc::codec::json::fromCbor(cbor2));
+  EXPECT_OUTCOME_EQ(fc::api::decode<Signature>(decoded2), signature);
+}
@@ -0,0 +1,57 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "api/result_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/outcome.hpp"
+
+namespace fc::api {
+  /**
+   * @given result cache
+   * @when same key is requested twice
+   * @then result is computed once
+   */
+  TEST(ResultCacheTest, Cached) {
+    ResultCache cache;
+    auto calls{0};
+    auto f{[&]() -> outcome::result<int> { return ++calls; }};
+    EXPECT_OUTCOME_EQ(cache.get<int>(Buffer{1}, f), 1);
+    EXPECT_OUTCOME_EQ(cache.get<int>(Buffer{1}, f), 1);
+    EXPECT_OUTCOME_EQ(cache.get<int>(Buffer{2}, f), 2);
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(cache.stats().hits, 1);
+    EXPECT_EQ(cache.stats().misses, 2);
+  }
+
+  /**
+   * @given result cache
+   * @when computation fails
+   * @then error is not cached
+   */
+  TEST(ResultCacheTest, ErrorNotCached) {
+    ResultCache cache;
+    auto calls{0};
+    auto f{[&]() -> outcome::result<int> {
+      if (++calls == 1) {
+        return std::errc::io_error;
+      }
+      return calls;
+    }};
+    EXPECT_OUTCOME_ERROR(std::errc::io_error, cache.get<int>(Buffer{1}, f));
+    EXPECT_OUTCOME_EQ(cache.get<int>(Buffer{1}, f), 2);
+  }
+
+  /**
+   * @given result cache config
+   * @then only listed methods are enabled
+   */
+  TEST(ResultCacheTest, Enabled) {
+    ResultCache cache{{16, {"StateMinerPower"}}};
+    EXPECT_TRUE(cache.enabled("StateMinerPower"));
+    EXPECT_FALSE(cache.enabled("StateGetActor"));
+  }
+}  // namespace fc::api
@@ -5,9 +5,12 @@
 
 #include <memory>
 
+#include <boost/asio/thread_pool.hpp>
 #include <gtest/gtest.h>
 #include "blockchain/block_validator/impl/block_validator_impl.hpp"
+#include "blockchain/block_validator/impl/syntax_rules.hpp"
 #include "clock/impl/chain_epoch_clock_impl.hpp"
+#include "common/thread_pool.hpp"
 #include "power/impl/power_table_impl.hpp"
 #include "testutil/literals.hpp"
 #include "testutil/mocks/blockchain/weight_calculator_mock.hpp"
@@ -46,7 +49,8 @@ class BlockValidatorTest : public testing::Test {
 
   std::shared_ptr<BlockValidator> validator_;
 
-  std::shared_ptr<BlockValidator> createValidator() {
+  std::shared_ptr<BlockValidator> createValidator(
+      std::shared_ptr<boost::asio::thread_pool> pool = nullptr) {
     auto datastore = std::make_shared<DataStore>();
     auto utc_clock = std::make_shared<UTCClockMock>();
     auto epoch_clock = std::make_shared<EpochClock>(Time{config::kGenesisTime});
@@ -65,7 +69,8 @@ class BlockValidatorTest : public testing::Test {
                                             power_table,
                                             bls_provider,
                                             secp_provider,
-                                            vm_interpreter);
+                                            vm_interpreter,
+                                            std::move(pool));
   }
 
   BlockHeader getCorrectBlockHeader() const {
@@ -104,3 +109,47 @@ TEST_F(BlockValidatorTest, ValidateCorrectBlock) {
       getCorrectBlockHeader(),
       {fc::blockchain::block_validator::scenarios::Stage::SYNTAX_BV0}));
 }
+
+/**
+ * @given Validator with pool and block without election proof, then also
+ * without parents
+ * @when Validating stages depending on syntax
+ * @then Dependent stage error is returned after syntax passed, syntax error
+ * is returned and dependent stages don't run when syntax failed
+ */
+TEST_F(BlockValidatorTest, ParallelStagesFail) {
+  using fc::blockchain::block_validator::SyntaxError;
+  using fc::blockchain::block_validator::ValidatorError;
+  using fc::blockchain::block_validator::scenarios::Scenario;
+  using fc::blockchain::block_validator::scenarios::Stage;
+  auto validator{
+      createValidator(std::make_shared<boost::asio::thread_pool>(2))};
+  auto block{getCorrectBlockHeader()};
+  Scenario stages{Stage::ELECTION_POST_BV3, Stage::SYNTAX_BV0};
+  EXPECT_OUTCOME_ERROR(ValidatorError::kInvalidElectionProof,
+                       validator->validateBlock(block, stages));
+  block.parents.clear();
+  EXPECT_OUTCOME_ERROR(SyntaxError::kInvalidParentsCount,
+                       validator->validateBlock(block, stages));
+}
+
+/**
+ * @given Validator with single thread pool
+ * @when Validating independent stages from pool thread
+ * @then Stages run inline and validation doesn't wait for blocked pool
+ */
+TEST_F(BlockValidatorTest, ValidateOnPoolThread) {
+  using fc::blockchain::block_validator::ValidatorError;
+  using fc::blockchain::block_validator::scenarios::Stage;
+  auto pool{std::make_shared<boost::asio::thread_pool>(1)};
+  auto validator{createValidator(pool)};
+  auto block{getCorrectBlockHeader()};
+  auto future{fc::postFuture(*pool, [&] {
+    return validator->validateBlock(
+        block,
+        {Stage::SYNTAX_BV0, Stage::ELECTION_POST_BV3, Stage::STATE_TREE_BV5});
+  })};
+  ASSERT_EQ(future.wait_for(std::chrono::seconds{10}),
+            std::future_status::ready);
+  EXPECT_OUTCOME_ERROR(ValidatorError::kInvalidElectionProof, future.get());
+}
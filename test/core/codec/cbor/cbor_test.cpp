@@ -4,6 +4,7 @@
  */
 
 #include "codec/cbor/cbor.hpp"
+#include "codec/cbor/cbor_view.hpp"
 #include "primitives/big_int.hpp"
 
 #include <gtest/gtest.h>
@@ -17,6 +18,7 @@ using fc::codec::cbor::CborDecodeStream;
 using fc::codec::cbor::CborEncodeError;
 using fc::codec::cbor::CborEncodeStream;
 using fc::codec::cbor::CborResolveError;
+using fc::codec::cbor::CborView;
 using fc::codec::cbor::decode;
 using fc::codec::cbor::encode;
 
@@ -210,6 +212,69 @@ TEST(CborEncoder, Map) {
   EXPECT_EQ(s.data(), "A361620261630362616101"_unhex);
 }
 
+struct CborTupleSample {
+  int a;
+  std::vector<int> b;
+  std::map<std::string, int> c;
+};
+CBOR_ENCODE_TUPLE(CborTupleSample, a, b, c)
+
+/**
+ * @given Tuple with nested list and map
+ * @when Encode in place of list
+ * @then Same bytes as list substream
+ */
+TEST(CborEncoder, Tuple) {
+  CborTupleSample tuple{1, {2, 300}, {{"aa", 1}, {"b", 2}}};
+  EXPECT_OUTCOME_EQ(encode(tuple), "8301820219012CA261620262616101"_unhex);
+  auto l = CborEncodeStream::list();
+  l << tuple << 4;
+  EXPECT_EQ(l.data(),
+            (CborEncodeStream::list()
+             << (CborEncodeStream::list() << 1 << tuple.b << tuple.c) << 4)
+                .data());
+}
+
+struct CborTupleInner {
+  int a;
+  std::string b;
+};
+CBOR_TUPLE(CborTupleInner, a, b)
+inline bool operator==(const CborTupleInner &l, const CborTupleInner &r) {
+  return l.a == r.a && l.b == r.b;
+}
+
+struct CborTupleOuter {
+  CborTupleInner inner;
+  std::vector<CborTupleInner> list;
+  int c;
+};
+CBOR_TUPLE(CborTupleOuter, inner, list, c)
+
+/**
+ * @given Nested tuples followed by next element
+ * @when Decode
+ * @then Decoded in place, size mismatch is error
+ */
+TEST(CborDecoder, Tuple) {
+  CborTupleOuter outer{{1, "a"}, {{2, "b"}, {3, "c"}}, 4};
+  EXPECT_OUTCOME_EQ(encode(outer), "838201616182820261628203616304"_unhex);
+  CborDecodeStream s{(CborEncodeStream{} << outer << 5).data()};
+  CborTupleOuter decoded;
+  int next;
+  s >> decoded >> next;
+  EXPECT_TRUE(s.isEOF());
+  EXPECT_EQ(decoded.inner, outer.inner);
+  EXPECT_EQ(decoded.list, outer.list);
+  EXPECT_EQ(decoded.c, 4);
+  EXPECT_EQ(next, 5);
+
+  EXPECT_OUTCOME_ERROR(CborDecodeError::kWrongSize,
+                       decode<CborTupleInner>("8101"_unhex));
+  EXPECT_OUTCOME_ERROR(CborDecodeError::kWrongSize,
+                       decode<CborTupleInner>("83016161F6"_unhex));
+}
+
 /**
  * @given Empty CID
  * @when Encode
@@ -492,6 +557,26 @@ TEST_F(CborResolve, StringKey) {
   EXPECT_OUTCOME_ERROR(CborResolveError::kKeyNotFound, resolve(a, "1"));
 }
 
+/**
+ * @given Map CBOR with container and bytes values
+ * @when Resolve key after them
+ * @then Other values are skipped, stream advances past map
+ */
+TEST_F(CborResolve, SkipValues) {
+  auto a = "A3616182010261624568656C6C6F616305"_unhex;
+
+  EXPECT_OUTCOME_EQ(resolve(a, "a"), "820102"_unhex);
+  EXPECT_OUTCOME_EQ(resolve(a, "c"), "05"_unhex);
+
+  CborDecodeStream s{"82A161610107"_unhex};
+  auto l = s.list();
+  auto value = l.mapValue("a");
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(value->raw(), "01"_unhex);
+  EXPECT_EQ(l.get<int>(), 7);
+  EXPECT_FALSE(CborDecodeStream{"A1616101"_unhex}.mapValue("b").has_value());
+}
+
 /**
  * @given Invalid CBOR or wrong type
  * @when Resolve
@@ -503,3 +588,51 @@ TEST_F(CborResolve, Errors) {
   EXPECT_OUTCOME_ERROR(CborDecodeError::kInvalidCbor,
                        resolve("8281"_unhex, "1"));
 }
+
+/**
+ * @given List of integers, bytes, string and CID
+ * @when Make view
+ * @then Fields are decoded on demand, bytes point into input
+ */
+TEST(CborView, List) {
+  auto encoded{(CborEncodeStream::list()
+                << -25 << 300 << "CAFE"_unhex << std::string{"foo"} << kCidRaw
+                << nullptr)
+                   .data()};
+  EXPECT_OUTCOME_TRUE(view, CborView::make(encoded));
+  EXPECT_TRUE(view.isList());
+  EXPECT_EQ(view.size(), 6);
+  EXPECT_OUTCOME_TRUE(item0, view.at(0));
+  EXPECT_OUTCOME_EQ(item0.asInt(), -25);
+  EXPECT_OUTCOME_ERROR(CborDecodeError::kIntOverflow, item0.asUint());
+  EXPECT_OUTCOME_TRUE(item1, view.at(1));
+  EXPECT_OUTCOME_EQ(item1.asUint(), 300);
+  EXPECT_OUTCOME_TRUE(item2, view.at(2));
+  EXPECT_OUTCOME_TRUE(bytes, item2.asBytes());
+  EXPECT_EQ(bytes, gsl::make_span("CAFE"_unhex));
+  EXPECT_EQ(bytes.data(), encoded.data() + 7);
+  EXPECT_OUTCOME_TRUE(item3, view.at(3));
+  EXPECT_OUTCOME_EQ(item3.asStr(), "foo");
+  EXPECT_OUTCOME_TRUE(item4, view.at(4));
+  EXPECT_OUTCOME_EQ(item4.asCid(), kCidRaw);
+  EXPECT_OUTCOME_EQ(item4.decode<CID>(), kCidRaw);
+  EXPECT_OUTCOME_TRUE(item5, view.at(5));
+  EXPECT_TRUE(item5.isNull());
+  EXPECT_OUTCOME_ERROR(CborDecodeError::kWrongSize, view.at(6));
+}
+
+/**
+ * @given Truncated or trailing bytes
+ * @when Make view
+ * @then Error
+ */
+TEST(CborView, Invalid) {
+  EXPECT_OUTCOME_ERROR(CborDecodeError::kInvalidCbor,
+                       CborView::make("8201"_unhex));
+  EXPECT_OUTCOME_ERROR(CborDecodeError::kInvalidCbor,
+                       CborView::make("43CAFE"_unhex));
+  EXPECT_OUTCOME_ERROR(CborDecodeError::kInvalidCbor,
+                       CborView::make("0101"_unhex));
+  EXPECT_OUTCOME_ERROR(CborDecodeError::kInvalidCbor,
+                       CborView::make("9F01FF"_unhex));
+}
@@ -130,3 +130,29 @@ TEST(RLEPlusDecode, MaxSizeExceedFailure) {
   ASSERT_TRUE(result.has_error());
   ASSERT_EQ(result.error().value(), static_cast<int>(expected));
 }
+
+/**
+ * @given Reference RLE+ encoded data
+ * @when Decode and encode run lengths
+ * @then Runs match decoded set and encode back to same bytes
+ */
+TYPED_TEST(RLEPlusCodecTester, RunsReferenceSuccess) {
+  using fc::codec::rle::toRuns;
+  std::set<uint64_t> set{this->reference_decoded_sample_.begin(),
+                         this->reference_decoded_sample_.end()};
+  auto encoded = encode(set);
+  EXPECT_OUTCOME_EQ(fc::codec::rle::decodeRuns(encoded), toRuns(set));
+  EXPECT_EQ(fc::codec::rle::encodeRuns(toRuns(set)), encoded);
+}
+
+/**
+ * @given RLE+ data with more runs than allowed
+ * @when Decode run lengths
+ * @then Error
+ */
+TEST(RLEPlusDecode, RunsMaxSizeExceedFailure) {
+  fc::codec::rle::Runs64 runs(fc::codec::rle::OBJECT_MAX_SIZE / 8 + 1, 1);
+  EXPECT_OUTCOME_ERROR(
+      RLEPlusDecodeError::kMaxSizeExceed,
+      fc::codec::rle::decodeRuns(fc::codec::rle::encodeRuns(runs)));
+}
@@ -0,0 +1,47 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/async.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+
+using fc::CbT;
+using fc::withTimeout;
+
+/**
+ * @given operation which completes before timeout
+ * @when io runs
+ * @then callback gets result once
+ */
+TEST(AsyncTest, CompletesBeforeTimeout) {
+  boost::asio::io_context io;
+  std::vector<fc::outcome::result<int>> results;
+  auto cb{withTimeout<int>(io, std::chrono::seconds{10}, [&](auto result) {
+    results.push_back(std::move(result));
+  })};
+  boost::asio::post(io, [cb] { cb(1); });
+  io.run();
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].value(), 1);
+}
+
+/**
+ * @given operation which doesn't complete in timeout
+ * @when timer expires and operation completes later
+ * @then callback gets timed_out once, late result is dropped
+ */
+TEST(AsyncTest, TimesOut) {
+  boost::asio::io_context io;
+  std::vector<fc::outcome::result<int>> results;
+  auto cb{withTimeout<int>(io, std::chrono::milliseconds{1}, [&](auto result) {
+    results.push_back(std::move(result));
+  })};
+  io.run();
+  cb(1);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].error(), std::errc::timed_out);
+}
@@ -0,0 +1,58 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/buffer_pool.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::common::BufferPool;
+
+/**
+ * @given buffer released to pool
+ * @when acquire buffer of same size class
+ * @then released memory is reused
+ */
+TEST(BufferPoolTest, Reuse) {
+  BufferPool pool;
+  auto bytes{pool.acquire(1000)};
+  EXPECT_EQ(bytes.size(), 1000);
+  EXPECT_GE(bytes.capacity(), 1024);
+  auto data{bytes.data()};
+  pool.release(std::move(bytes));
+  auto reused{pool.acquire(600)};
+  EXPECT_EQ(reused.size(), 600);
+  EXPECT_EQ(reused.data(), data);
+  EXPECT_NE(pool.acquire(600).data(), data);
+}
+
+/**
+ * @given shared buffer
+ * @when last reference is gone
+ * @then memory is returned to pool
+ */
+TEST(BufferPoolTest, Share) {
+  BufferPool pool;
+  auto bytes{pool.acquire(3000)};
+  auto data{bytes.data()};
+  auto shared{pool.share(std::move(bytes))};
+  EXPECT_EQ(shared->data(), data);
+  EXPECT_EQ(shared->size(), 3000);
+  shared.reset();
+  EXPECT_EQ(pool.acquire(4096).data(), data);
+}
+
+/**
+ * @given buffers larger than largest class
+ * @when acquire and release them
+ * @then they are not pooled
+ */
+TEST(BufferPoolTest, Large) {
+  BufferPool pool;
+  auto size{(size_t{1} << BufferPool::kMaxClass) + 1};
+  auto bytes{pool.acquire(size)};
+  EXPECT_EQ(bytes.size(), size);
+  pool.release(std::move(bytes));
+  EXPECT_TRUE(pool.acquire(0).empty());
+}
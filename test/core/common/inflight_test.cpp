@@ -0,0 +1,69 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/inflight.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::common::Inflight;
+using fc::common::NegativeCache;
+using Clock = NegativeCache<int>::Clock;
+
+/**
+ * @given operation in flight
+ * @when same key is requested again and operation completes
+ * @then only first caller starts operation, all waiters get result
+ */
+TEST(InflightTest, Coalesce) {
+  Inflight<int, int> inflight;
+  std::vector<int> results;
+  auto cb{[&](auto result) { results.push_back(result.value()); }};
+  EXPECT_TRUE(inflight.wait(1, cb));
+  EXPECT_FALSE(inflight.wait(1, cb));
+  EXPECT_TRUE(inflight.wait(2, cb));
+  EXPECT_EQ(inflight.size(), 2);
+
+  inflight.done(1, 10);
+  EXPECT_EQ(results, (std::vector<int>{10, 10}));
+  EXPECT_FALSE(inflight.has(1));
+  EXPECT_TRUE(inflight.has(2));
+
+  // completed key starts new operation
+  EXPECT_TRUE(inflight.wait(1, cb));
+}
+
+/**
+ * @given failure inserted into negative cache
+ * @when key is looked up before and after ttl
+ * @then error is returned before ttl only
+ */
+TEST(InflightTest, NegativeCacheExpires) {
+  NegativeCache<int> cache{std::chrono::seconds{5}};
+  auto now{Clock::now()};
+  auto error{make_error_code(std::errc::timed_out)};
+  cache.insert(1, error, now);
+  EXPECT_EQ(cache.find(1, now + std::chrono::seconds{1}).value(), error);
+  EXPECT_FALSE(cache.find(2, now));
+  EXPECT_FALSE(cache.find(1, now + std::chrono::seconds{5}));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+/**
+ * @given negative cache with limit
+ * @when more keys than limit are inserted
+ * @then expired entries are pruned and size stays bounded
+ */
+TEST(InflightTest, NegativeCacheBounded) {
+  NegativeCache<int> cache{std::chrono::seconds{5}, 2};
+  auto now{Clock::now()};
+  auto error{make_error_code(std::errc::timed_out)};
+  cache.insert(1, error, now);
+  cache.insert(2, error, now + std::chrono::seconds{4});
+  cache.insert(3, error, now + std::chrono::seconds{6});
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_FALSE(cache.find(1, now + std::chrono::seconds{6}));
+  cache.insert(4, error, now + std::chrono::seconds{6});
+  EXPECT_EQ(cache.size(), 2);
+}
@@ -0,0 +1,78 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/memory_budget.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::common::MemoryBudget;
+
+struct MemoryBudgetTest : testing::Test {
+  struct Cache {
+    size_t used{};
+    size_t limit{};
+  };
+
+  auto add(Cache &cache, std::string name, size_t weight, size_t max) {
+    return budget.add({std::move(name),
+                       weight,
+                       max,
+                       [&cache] { return cache.used; },
+                       [&cache](size_t limit) { cache.limit = limit; }});
+  }
+
+  MemoryBudget budget;
+};
+
+/**
+ * @given caches with weights and max sizes
+ * @when budget limit changes
+ * @then caches use own max without limit, limit is split by weight without
+ * exceeding max of cache
+ */
+TEST_F(MemoryBudgetTest, Split) {
+  Cache a, b, c;
+  auto ra{add(a, "a", 1, 100)};
+  auto rb{add(b, "b", 1, 1000)};
+  auto rc{add(c, "c", 2, 1000)};
+  EXPECT_EQ(a.limit, 100);
+  EXPECT_EQ(b.limit, 1000);
+  EXPECT_EQ(c.limit, 1000);
+
+  budget.setLimit(700);
+  EXPECT_EQ(a.limit, 100);
+  EXPECT_EQ(b.limit, 200);
+  EXPECT_EQ(c.limit, 400);
+
+  rc.reset();
+  EXPECT_EQ(a.limit, 100);
+  EXPECT_EQ(b.limit, 600);
+
+  a.used = 10;
+  b.used = 20;
+  auto usage{budget.usage()};
+  EXPECT_EQ(usage["a"].bytes, 10);
+  EXPECT_EQ(usage["b"].limit, 600);
+}
+
+/**
+ * @given cache with budget
+ * @when memory usage is high, then low
+ * @then budget shrinks by quarter, then grows back
+ */
+TEST_F(MemoryBudgetTest, Pressure) {
+  Cache a;
+  auto ra{add(a, "a", 1, 1000)};
+  budget.onPressure(95, 100);
+  EXPECT_EQ(a.limit, 750);
+  budget.onPressure(80, 100);
+  EXPECT_EQ(a.limit, 750);
+  budget.onPressure(50, 100);
+  EXPECT_EQ(a.limit, 850);
+  for (auto i{0}; i < 10; ++i) {
+    budget.onPressure(50, 100);
+  }
+  EXPECT_EQ(a.limit, 1000);
+}
@@ -0,0 +1,61 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/metrics.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::common::metrics::Histogram;
+using fc::common::metrics::Registry;
+using std::chrono::microseconds;
+
+/**
+ * @given histogram
+ * @when observe durations
+ * @then they are counted in power of two buckets
+ */
+TEST(MetricsTest, Histogram) {
+  Histogram histogram;
+  histogram.observe(microseconds{0});
+  histogram.observe(microseconds{3});
+  histogram.observe(microseconds{4});
+  histogram.observe(microseconds{int64_t{1} << 40});
+  EXPECT_EQ(histogram.bucket(0), 1);
+  EXPECT_EQ(histogram.bucket(2), 1);
+  EXPECT_EQ(histogram.bucket(3), 1);
+  EXPECT_EQ(histogram.bucket(Histogram::kBuckets), 1);
+  EXPECT_EQ(histogram.count(), 4);
+  EXPECT_EQ(histogram.sum(), microseconds{7} + (microseconds{int64_t{1} << 40}));
+}
+
+/**
+ * @given registry with counter, gauge and histogram
+ * @when export them
+ * @then prometheus text format is returned
+ */
+TEST(MetricsTest, Prometheus) {
+  Registry registry;
+  registry.counter("a_total", "A.").inc(2);
+  EXPECT_EQ(&registry.counter("a_total", "A."),
+            &registry.counter("a_total", "A."));
+  registry.gauge("c_bytes", "C.").set(-3);
+  registry.histogram("b_seconds", "B.", "x=\"1\"")
+      .observe(microseconds{1500000});
+  auto text{registry.prometheus()};
+  EXPECT_NE(text.find("# HELP a_total A.\n# TYPE a_total counter\n"
+                      "a_total 2\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE c_bytes gauge\nc_bytes -3\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE b_seconds histogram\n"), std::string::npos);
+  EXPECT_NE(text.find("b_seconds_bucket{x=\"1\",le=\"1.048576\"} 0\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("b_seconds_bucket{x=\"1\",le=\"2.097152\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("b_seconds_bucket{x=\"1\",le=\"+Inf\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("b_seconds_sum{x=\"1\"} 1.500000\n"), std::string::npos);
+  EXPECT_NE(text.find("b_seconds_count{x=\"1\"} 1\n"), std::string::npos);
+}
@@ -0,0 +1,45 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/profiler.hpp"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include "testutil/outcome.hpp"
+
+using fc::common::profiler::profileCpu;
+using fc::common::profiler::setThreadName;
+using std::chrono::milliseconds;
+
+/**
+ * @given named thread consuming cpu
+ * @when profile cpu
+ * @then collapsed stacks of thread are returned, concurrent and invalid
+ * profiles fail
+ */
+TEST(ProfilerTest, Cpu) {
+  std::atomic_bool stop{false};
+  std::thread busy{[&] {
+    setThreadName("profiler-busy");
+    volatile double x{0};
+    while (!stop) {
+      x = std::sqrt(x + 1);
+    }
+  }};
+  std::thread concurrent{[] {
+    std::this_thread::sleep_for(milliseconds{100});
+    EXPECT_OUTCOME_FALSE_1(profileCpu(milliseconds{100}));
+  }};
+  EXPECT_OUTCOME_TRUE(profile, profileCpu(milliseconds{500}));
+  stop = true;
+  busy.join();
+  concurrent.join();
+  EXPECT_NE(profile.find("profiler-busy;"), std::string::npos);
+  EXPECT_EQ(profile.back(), '\n');
+  EXPECT_OUTCOME_FALSE_1(profileCpu(milliseconds{0}));
+}
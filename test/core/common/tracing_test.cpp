@@ -0,0 +1,101 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/tracing.hpp"
+
+#include <gtest/gtest.h>
+
+namespace tracing = fc::common::tracing;
+
+struct TracingTest : testing::Test {
+  void SetUp() override {
+    tracing::setExporter(
+        [this](const tracing::SpanData &span) { spans.push_back(span); });
+  }
+
+  void TearDown() override {
+    tracing::setExporter(nullptr);
+  }
+
+  std::vector<tracing::SpanData> spans;
+};
+
+/**
+ * @given traceparent header value
+ * @when parse and format it
+ * @then same value is returned, malformed values are invalid
+ */
+TEST(TracingContextTest, Traceparent) {
+  std::string str{"00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01"};
+  auto context{tracing::SpanContext::fromTraceparent(str)};
+  EXPECT_TRUE(context.valid());
+  EXPECT_EQ(context.traceparent(), str);
+  EXPECT_FALSE(tracing::SpanContext::fromTraceparent("00-00").valid());
+  EXPECT_FALSE(
+      tracing::SpanContext::fromTraceparent(
+          "00-0af7651916cd43dd8448eb211c80319c-0000000000000000-01")
+          .valid());
+  EXPECT_EQ(tracing::SpanContext{}.traceparent(), "");
+}
+
+/**
+ * @given tracing disabled
+ * @when span is created
+ * @then it has no context and nothing is exported
+ */
+TEST(TracingContextTest, Disabled) {
+  tracing::Span span{"a"};
+  EXPECT_FALSE(span.context().valid());
+  EXPECT_FALSE(tracing::current().valid());
+}
+
+/**
+ * @given nested spans
+ * @when they end
+ * @then inner span is child of outer one in same trace, current context is
+ * restored
+ */
+TEST_F(TracingTest, Nested) {
+  {
+    tracing::Span outer{"outer"};
+    EXPECT_EQ(tracing::current().span_id, outer.context().span_id);
+    {
+      tracing::Span inner{"inner"};
+      inner.attribute("k", "v");
+      inner.error();
+    }
+    EXPECT_EQ(tracing::current().span_id, outer.context().span_id);
+  }
+  EXPECT_FALSE(tracing::current().valid());
+  ASSERT_EQ(spans.size(), 2);
+  EXPECT_EQ(spans[0].name, "inner");
+  EXPECT_EQ(spans[0].context.trace_id, spans[1].context.trace_id);
+  EXPECT_EQ(spans[0].parent_span_id, spans[1].context.span_id);
+  EXPECT_TRUE(spans[0].error);
+  EXPECT_EQ(spans[0].attributes, (tracing::Attributes{{"k", "v"}}));
+  EXPECT_EQ(spans[1].parent_span_id, (std::array<uint8_t, 8>{}));
+}
+
+/**
+ * @given remote parent context
+ * @when span is created in scope of it
+ * @then span continues remote trace
+ */
+TEST_F(TracingTest, RemoteParent) {
+  auto remote{tracing::SpanContext::fromTraceparent(
+      "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01")};
+  {
+    tracing::Scope scope{remote};
+    tracing::Span span{"a"};
+  }
+  ASSERT_EQ(spans.size(), 1);
+  EXPECT_EQ(spans[0].context.trace_id, remote.trace_id);
+  EXPECT_EQ(spans[0].parent_span_id, remote.span_id);
+  auto json{tracing::otlpJson(spans[0], "test")};
+  EXPECT_NE(json.find("\"traceId\":\"0af7651916cd43dd8448eb211c80319c\""),
+            std::string::npos);
+  EXPECT_NE(json.find("\"parentSpanId\":\"b7ad6b7169203331\""),
+            std::string::npos);
+}
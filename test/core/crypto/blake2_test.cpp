@@ -58,3 +58,22 @@ TEST(Blake2b, Correctness) {
 
   EXPECT_EQ(memcmp(md, blake2b_res.data(), 32), 0) << "hashes are different";
 }
+
+/**
+ * @given inputs of different sizes
+ * @when hash them at once
+ * @then hashes are the same as hashed one by one
+ */
+TEST(Blake2b, Many) {
+  std::vector<std::vector<uint8_t>> inputs;
+  for (size_t size : {0, 3, 127, 128, 129, 255, 256, 1024, 1025, 4096}) {
+    auto &input{inputs.emplace_back(size)};
+    selftest_seq(input.data(), input.size(), size);
+  }
+  std::vector<fc::BytesIn> spans{inputs.begin(), inputs.end()};
+  auto hashes{fc::crypto::blake2b::blake2b_256_many(spans)};
+  ASSERT_EQ(hashes.size(), inputs.size());
+  for (size_t i{0}; i < inputs.size(); ++i) {
+    EXPECT_EQ(hashes[i], fc::crypto::blake2b::blake2b_256(inputs[i]));
+  }
+}
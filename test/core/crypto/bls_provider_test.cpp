@@ -82,3 +82,62 @@ TEST_F(BlsProviderTest, DifferentMessageVerificationFailure) {
                           different_message, signature, key_pair.public_key));
   ASSERT_FALSE(signature_status);
 }
+
+/**
+ * @given Messages signed with different keys
+ * @when Verifying aggregated signature
+ * @then Aggregated signature is valid only for same messages and keys
+ */
+TEST_F(BlsProviderTest, VerifyAggregateSignature) {
+  std::vector<std::vector<uint8_t>> messages{message_, {1, 2, 3}};
+  std::vector<PublicKey> keys;
+  std::vector<Signature> signatures;
+  for (auto &message : messages) {
+    EXPECT_OUTCOME_TRUE(key_pair, provider_.generateKeyPair());
+    EXPECT_OUTCOME_TRUE(signature,
+                        provider_.sign(message, key_pair.private_key));
+    keys.push_back(key_pair.public_key);
+    signatures.push_back(signature);
+  }
+  EXPECT_OUTCOME_TRUE(aggregate, provider_.aggregateSignatures(signatures));
+  EXPECT_OUTCOME_EQ(
+      provider_.verifyAggregateSignature(messages, keys, aggregate), true);
+  std::swap(keys[0], keys[1]);
+  EXPECT_OUTCOME_EQ(
+      provider_.verifyAggregateSignature(messages, keys, aggregate), false);
+  EXPECT_OUTCOME_TRUE(empty, provider_.aggregateSignatures({}));
+  EXPECT_OUTCOME_EQ(provider_.verifyAggregateSignature({}, {}, empty), true);
+}
+
+/**
+ * @given Messages signed with different keys, one signature is invalid or
+ * two signatures are swapped, so their aggregate is still valid
+ * @when Verifying signatures in batch
+ * @then Only invalid signatures are reported
+ */
+TEST_F(BlsProviderTest, VerifySignatures) {
+  std::vector<std::vector<uint8_t>> messages;
+  std::vector<PublicKey> keys;
+  std::vector<Signature> signatures;
+  for (uint8_t i{0}; i < 5; ++i) {
+    auto &message{messages.emplace_back(message_)};
+    message.push_back(i);
+    EXPECT_OUTCOME_TRUE(key_pair, provider_.generateKeyPair());
+    EXPECT_OUTCOME_TRUE(signature,
+                        provider_.sign(message, key_pair.private_key));
+    keys.push_back(key_pair.public_key);
+    signatures.push_back(signature);
+  }
+  EXPECT_OUTCOME_EQ(provider_.verifySignatures(messages, signatures, keys),
+                    std::vector<bool>(5, true));
+  auto swapped{signatures};
+  signatures[3] = signatures[1];
+  EXPECT_OUTCOME_EQ(provider_.verifySignatures(messages, signatures, keys),
+                    (std::vector<bool>{true, true, true, false, true}));
+  // sum of signatures is unchanged, but both swapped ones are invalid
+  std::swap(swapped[0], swapped[4]);
+  EXPECT_OUTCOME_EQ(provider_.verifySignatures(messages, swapped, keys),
+                    (std::vector<bool>{false, true, true, true, false}));
+  EXPECT_OUTCOME_EQ(provider_.verifySignatures({}, {}, {}),
+                    std::vector<bool>{});
+}
@@ -178,4 +178,22 @@ namespace fc::crypto::secp256k1 {
     EXPECT_EQ(sig1, sig2);
   }
 
+  /**
+   * @given provider which recovered public key of signature
+   * @when recover again and recover with other signature of the same digest
+   * @then cached key is returned for the same signature only
+   */
+  TEST_F(Secp256k1ProviderTest, RecoverCached) {
+    Secp256k1ProviderImpl provider{1};
+    EXPECT_OUTCOME_EQ(provider.recoverPublicKey(go_message_hash, go_signature),
+                      go_public_key);
+    EXPECT_OUTCOME_EQ(provider.recoverPublicKey(go_message_hash, go_signature),
+                      go_public_key);
+    EXPECT_OUTCOME_TRUE(keypair, provider.generate());
+    EXPECT_OUTCOME_TRUE(sig,
+                        provider.sign(go_message_hash, keypair.private_key));
+    EXPECT_OUTCOME_EQ(provider.recoverPublicKey(go_message_hash, sig),
+                      keypair.public_key);
+  }
+
 }  // namespace fc::crypto::secp256k1
@@ -107,3 +107,31 @@ TEST_F(VRFProviderTest, VRFVerifyWrongMessageFail) {
       vrf_provider->verifyVRF(vrf_public_key, wrong_vrf_params, signature))
   ASSERT_FALSE(signature_status);
 }
+
+/**
+ * @given proofs of different keys and messages, one with wrong message, or
+ * two swapped so aggregate of proofs is still valid
+ * @when verifyVRFs is called
+ * @then status of each proof is returned
+ */
+TEST_F(VRFProviderTest, VRFVerifyBatch) {
+  using fc::crypto::vrf::VRFVerifyRequest;
+  std::vector<VRFVerifyRequest> requests;
+  for (uint8_t i{0}; i < 4; ++i) {
+    EXPECT_OUTCOME_TRUE(key_pair, bls_provider->generateKeyPair());
+    Buffer message{vrf_params.message};
+    message.putUint8(i);
+    EXPECT_OUTCOME_TRUE(proof,
+                        bls_provider->sign(message, key_pair.private_key));
+    requests.push_back({key_pair.public_key, message, proof});
+  }
+  EXPECT_OUTCOME_EQ(vrf_provider->verifyVRFs(requests),
+                    std::vector<bool>(4, true));
+  auto swapped{requests};
+  requests[1].message = wrong_vrf_params.message;
+  EXPECT_OUTCOME_EQ(vrf_provider->verifyVRFs(requests),
+                    (std::vector<bool>{true, false, true, true}));
+  std::swap(swapped[0].proof, swapped[3].proof);
+  EXPECT_OUTCOME_EQ(vrf_provider->verifyVRFs(swapped),
+                    (std::vector<bool>{false, true, true, false}));
+}
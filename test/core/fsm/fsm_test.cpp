@@ -7,6 +7,7 @@
 
 #include <string>
 
+#include <boost/asio/thread_pool.hpp>
 #include <gtest/gtest.h>
 
 #include "host/context/impl/host_context_impl.hpp"
@@ -67,3 +68,46 @@ TEST(Dev, Main) {
   EXPECT_OUTCOME_TRUE_1(fsm.force(entity, States::WORKING));
   EXPECT_OUTCOME_EQ(fsm.get(entity), States::WORKING);
 }
+
+/**
+ * @given state machine with worker pool and many entities
+ * @when two events are sent for each entity
+ * @then events of each entity are processed in order
+ */
+TEST(Dev, Pool) {
+  auto context = std::make_shared<HostContext>();
+  auto pool{std::make_shared<boost::asio::thread_pool>(4)};
+  std::atomic_size_t stopped{0};
+  Fsm fsm{{Transition(Events::START)
+               .from(States::READY)
+               .to(States::WORKING)
+               .action([](auto data, auto, auto ctx, auto, auto) {
+                 data->x = ctx->multiplier;
+               }),
+           Transition(Events::STOP)
+               .from(States::WORKING)
+               .to(States::STOPPED)
+               .action([&](auto data, auto, auto ctx, auto, auto) {
+                 data->x *= ctx->multiplier;
+                 ++stopped;
+               })},
+          context,
+          50,
+          pool};
+  std::vector<std::shared_ptr<Data>> entities;
+  for (auto i{0}; i < 100; ++i) {
+    auto entity{entities.emplace_back(std::make_shared<Data>())};
+    EXPECT_OUTCOME_TRUE_1(fsm.begin(entity, States::READY));
+    EXPECT_OUTCOME_TRUE_1(fsm.send(
+        entity, Events::START, std::make_shared<EventContext>(3, "")));
+    EXPECT_OUTCOME_TRUE_1(fsm.send(
+        entity, Events::STOP, std::make_shared<EventContext>(2, "")));
+  }
+  context->runIoContext(0);
+  pool->join();
+  EXPECT_EQ(stopped, entities.size());
+  for (auto &entity : entities) {
+    EXPECT_EQ(entity->x, 6);
+    EXPECT_OUTCOME_EQ(fsm.get(entity), States::STOPPED);
+  }
+}
@@ -110,4 +110,49 @@ namespace fc::markets::discovery {
     EXPECT_TRUE(vectorHas(peers_3, retrieval_peer_3));
   }
 
+  /**
+   * @given discovery with retrieval_peer_1
+   * @when discovery is created again on the same datastore
+   * @then peer is found by loaded index
+   */
+  TEST_F(DiscoveryTest, reloadIndex) {
+    EXPECT_OUTCOME_TRUE_1(discovery.addPeer(proposal_cid_1, retrieval_peer_1));
+
+    Discovery reloaded{datastore};
+    EXPECT_OUTCOME_TRUE(peers, reloaded.getPeers(proposal_cid_1));
+    EXPECT_EQ(peers.size(), 1);
+    EXPECT_OUTCOME_TRUE(empty_peers, reloaded.getPeers(proposal_cid_2));
+    EXPECT_TRUE(empty_peers.empty());
+  }
+
+  /**
+   * @given discovery with never queried retrieval_peer_1
+   * @when offers are refreshed
+   * @then stale offer gets price and last seen time, fresh offer isn't queried
+   */
+  TEST_F(DiscoveryTest, refresh) {
+    EXPECT_OUTCOME_TRUE_1(discovery.addPeer(proposal_cid_1, retrieval_peer_1));
+    EXPECT_OUTCOME_TRUE(initial_offers, discovery.getOffers(proposal_cid_1));
+    EXPECT_EQ(initial_offers.size(), 1);
+    EXPECT_EQ(initial_offers[0].last_seen, 0);
+
+    int queried{0};
+    Discovery::QueryProvider query{
+        [&](auto &cid, auto &peer, auto cb) {
+          EXPECT_EQ(cid, proposal_cid_1);
+          EXPECT_EQ(peer, retrieval_peer_1);
+          ++queried;
+          cb(TokenAmount{7});
+        }};
+    EXPECT_OUTCOME_TRUE_1(discovery.refresh(100, 50, query));
+    EXPECT_EQ(queried, 1);
+    EXPECT_OUTCOME_TRUE(offers, discovery.getOffers(proposal_cid_1));
+    EXPECT_EQ(offers.size(), 1);
+    EXPECT_EQ(offers[0].price_per_byte, 7);
+    EXPECT_EQ(offers[0].last_seen, 100);
+
+    EXPECT_OUTCOME_TRUE_1(discovery.refresh(120, 50, query));
+    EXPECT_EQ(queried, 1);
+  }
+
 }  // namespace fc::markets::discovery
@@ -8,6 +8,8 @@
 #include <gmock/gmock.h>
 
 #include <boost/filesystem.hpp>
+#include <future>
+#include "markets/pieceio/piece_commitment_stream.hpp"
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "storage/unixfs/unixfs.hpp"
 #include "testutil/outcome.hpp"
@@ -51,3 +53,40 @@ TEST(PieceIO, DISABLED_generatePieceCommitment) {
   EXPECT_OUTCOME_TRUE(commitment_cid, res.first.toString());
   EXPECT_EQ(commitment_cid_expected, commitment_cid);
 }
+
+/**
+ * @given data written to stream in chunks
+ * @when stream is finished
+ * @then commitment equals commitment of whole data and file has the data
+ */
+TEST(PieceIO, PieceCommitmentStream) {
+  using fc::common::Buffer;
+  using fc::markets::pieceio::PieceCommitmentStream;
+  using fc::primitives::piece::paddedSize;
+  auto proof{fc::primitives::sector::RegisteredProof::StackedDRG2KiBSeal};
+  Buffer data(1000, 0);
+  for (size_t i{0}; i < data.size(); ++i) {
+    data[i] = i * 7;
+  }
+  auto path{(boost::filesystem::temp_directory_path()
+             / boost::filesystem::unique_path())
+                .string()};
+  std::shared_ptr<IpfsDatastore> ipld = std::make_shared<InMemoryDatastore>();
+  PieceIOImpl piece_io{ipld, boost::filesystem::temp_directory_path().string()};
+  EXPECT_OUTCOME_TRUE(expected, piece_io.generatePieceCommitment(proof, data));
+
+  std::promise<fc::outcome::result<PieceCommitmentStream::Commitment>> result;
+  {
+    PieceCommitmentStream stream{proof, paddedSize(data.size()), path};
+    for (size_t i{0}; i < data.size(); i += 300) {
+      auto chunk{std::min<size_t>(300, data.size() - i)};
+      stream.write(Buffer{gsl::make_span(data).subspan(i, chunk)});
+    }
+    EXPECT_EQ(stream.size(), data.size());
+    stream.finish([&](auto commitment) { result.set_value(commitment); });
+  }
+  EXPECT_OUTCOME_TRUE(commitment, result.get_future().get());
+  EXPECT_EQ(commitment, expected);
+  EXPECT_EQ(readFile(path), data);
+  boost::filesystem::remove(path);
+}
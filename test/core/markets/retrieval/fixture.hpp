@@ -17,6 +17,7 @@
 #include "primitives/tipset/tipset.hpp"
 #include "storage/car/car.hpp"
 #include "storage/in_memory/in_memory_storage.hpp"
+#include "storage/ipfs/graphsync/block_sink.hpp"
 #include "storage/ipfs/graphsync/impl/graphsync_impl.hpp"
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "storage/piece/impl/piece_storage_impl.hpp"
@@ -86,6 +87,9 @@ namespace fc::markets::retrieval::test {
     std::shared_ptr<IpfsDatastore> provider_ipfs{
         std::make_shared<InMemoryDatastore>()};
 
+    /** Stores blocks received by client */
+    fc::storage::ipfs::graphsync::BlockSink client_sink{client_ipfs};
+
     /** filecoin addresses */
     Address miner_worker_address = Address::makeFromId(100);
     Address miner_wallet = Address::makeFromId(101);
@@ -126,9 +130,7 @@ namespace fc::markets::retrieval::test {
               host,
               std::make_shared<libp2p::protocol::AsioScheduler>(
                   *context, libp2p::protocol::SchedulerConfig{}))};
-      graphsync->subscribe([this](auto &from, auto &data) {
-        OUTCOME_EXCEPT(client_ipfs->set(data.cid, data.content));
-      });
+      client_sink.attach(*graphsync);
       graphsync->start();
       datatransfer = DataTransfer::make(host, graphsync);
 
@@ -34,9 +34,62 @@ namespace fc::markets::storage::chain_events {
     Address provider = Address::makeFromId(1);
     DealId deal_id{1};
     SectorNumber sector_number{13};
+    /// Deals in precommitted sector
+    std::vector<DealId> sector_deals{deal_id};
     std::shared_ptr<Api> api{std::make_shared<Api>()};
     std::shared_ptr<ChainEventsImpl> events{
         std::make_shared<ChainEventsImpl>(api)};
+
+    /// Block with PreCommit and ProveCommit of sector is applied
+    void expectCommit() {
+      CID block_cid{"010001020002"_cid};
+
+      api->ChainGetBlockMessages = {[block_cid, this](const CID &cid)
+                                        -> outcome::result<BlockMessages> {
+        // PreCommitSector message call
+        SectorPreCommitInfo pre_commit_info;
+        pre_commit_info.sealed_cid = "010001020001"_cid;
+        pre_commit_info.deal_ids = sector_deals;
+        pre_commit_info.sector = sector_number;
+        EXPECT_OUTCOME_TRUE(pre_commit_params,
+                            codec::cbor::encode(pre_commit_info));
+        UnsignedMessage pre_commit_message;
+        pre_commit_message.to = provider;
+        pre_commit_message.method = PreCommitSector::Number;
+        pre_commit_message.params = MethodParams{pre_commit_params};
+
+        // ProveCommitSector message call
+        ProveCommitSector::Params prove_commit_param;
+        prove_commit_param.sector = sector_number;
+        EXPECT_OUTCOME_TRUE(encoded_prove_commit_params,
+                            codec::cbor::encode(prove_commit_param));
+        UnsignedMessage prove_commit_message;
+        prove_commit_message.to = provider;
+        prove_commit_message.method = ProveCommitSector::Number;
+        prove_commit_message.params = MethodParams{encoded_prove_commit_params};
+
+        if (cid != block_cid) throw "wrong block requested";
+        return BlockMessages{.bls = {pre_commit_message, prove_commit_message}};
+      }};
+
+      api->ChainNotify = {
+          [block_cid]() -> outcome::result<Chan<std::vector<HeadChange>>> {
+            auto channel{std::make_shared<Channel<std::vector<HeadChange>>>()};
+
+            auto tipset = std::make_shared<Tipset>();
+            tipset->key = TipsetKey{{block_cid}};
+            HeadChange change{.type = HeadChangeType::APPLY, .value = tipset};
+            channel->write({change});
+
+            return Chan{std::move(channel)};
+          }};
+
+      api->StateWaitMsg = [](auto &, auto) {
+        auto wait{api::Wait<api::MsgWait>::make()};
+        wait.channel->write(outcome::success());
+        return wait;
+      };
+    }
   };
 
   /**
@@ -45,61 +98,35 @@ namespace fc::markets::storage::chain_events {
    * @then event is triggered
    */
   TEST_F(ChainEventsTest, CommitSector) {
-    CID block_cid{"010001020002"_cid};
-
-    api->ChainGetBlockMessages = {[block_cid, this](const CID &cid)
-                                      -> outcome::result<BlockMessages> {
-      // PreCommitSector message call
-      SectorPreCommitInfo pre_commit_info;
-      pre_commit_info.sealed_cid = "010001020001"_cid;
-      pre_commit_info.deal_ids.emplace_back(deal_id);
-      pre_commit_info.sector = sector_number;
-      EXPECT_OUTCOME_TRUE(pre_commit_params,
-                          codec::cbor::encode(pre_commit_info));
-      UnsignedMessage pre_commit_message;
-      pre_commit_message.to = provider;
-      pre_commit_message.method = PreCommitSector::Number;
-      pre_commit_message.params = MethodParams{pre_commit_params};
-
-      // ProveCommitSector message call
-      ProveCommitSector::Params prove_commit_param;
-      prove_commit_param.sector = sector_number;
-      EXPECT_OUTCOME_TRUE(encoded_prove_commit_params,
-                          codec::cbor::encode(prove_commit_param));
-      UnsignedMessage prove_commit_message;
-      prove_commit_message.to = provider;
-      prove_commit_message.method = ProveCommitSector::Number;
-      prove_commit_message.params = MethodParams{encoded_prove_commit_params};
-
-      if (cid != block_cid) throw "wrong block requested";
-      return BlockMessages{.bls = {pre_commit_message, prove_commit_message}};
-    }};
+    expectCommit();
 
-    api->ChainNotify = {
-        [block_cid]() -> outcome::result<Chan<std::vector<HeadChange>>> {
-          auto channel{std::make_shared<Channel<std::vector<HeadChange>>>()};
+    bool is_called = false;
+    events->onDealSectorCommitted(
+        provider, deal_id, [&]() { is_called = true; });
 
-          auto tipset = std::make_shared<Tipset>();
-          tipset->key = TipsetKey{{block_cid}};
-          HeadChange change{.type = HeadChangeType::APPLY, .value = tipset};
-          channel->write({change});
+    EXPECT_OUTCOME_TRUE_1(events->init());
 
-          return Chan{std::move(channel)};
-        }};
+    EXPECT_TRUE(is_called);
+  }
 
-    api->StateWaitMsg = [](auto &, auto) {
-      auto wait{api::Wait<api::MsgWait>::make()};
-      wait.channel->write(outcome::success());
-      return wait;
-    };
+  /**
+   * @given subscriptions to several deals of one sector
+   * @when PreCommit and then ProveCommit called
+   * @then all events are triggered
+   */
+  TEST_F(ChainEventsTest, CommitSectorDeals) {
+    DealId other_deal_id{2};
+    sector_deals.push_back(other_deal_id);
+    expectCommit();
 
-    bool is_called = false;
+    int called{0};
+    events->onDealSectorCommitted(provider, deal_id, [&]() { ++called; });
     events->onDealSectorCommitted(
-        provider, deal_id, [&]() { is_called = true; });
+        provider, other_deal_id, [&]() { ++called; });
 
     EXPECT_OUTCOME_TRUE_1(events->init());
 
-    EXPECT_TRUE(is_called);
+    EXPECT_EQ(called, 2);
   }
 
   /**
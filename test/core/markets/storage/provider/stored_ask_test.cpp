@@ -219,4 +219,24 @@ namespace fc::markets::storage::provider {
         true);
   }
 
+  /**
+   * @given stored ask
+   * @when ask response requested twice and ask changed
+   * @then same encoded bytes returned until ask change
+   */
+  TEST_F(StoredAskTest, CachedAskResponse) {
+    EXPECT_OUTCOME_TRUE(first, stored_ask.getAskResponse(actor_address));
+    EXPECT_OUTCOME_TRUE(second, stored_ask.getAskResponse(actor_address));
+    EXPECT_EQ(first, second);
+    EXPECT_OUTCOME_TRUE(ask, stored_ask.getAsk(actor_address));
+    EXPECT_OUTCOME_EQ(codec::cbor::encode(AskResponse{ask}), *first);
+
+    TokenAmount price = 1334;
+    EXPECT_OUTCOME_TRUE_1(stored_ask.addAsk(price, 2445));
+    EXPECT_OUTCOME_TRUE(changed, stored_ask.getAskResponse(actor_address));
+    EXPECT_NE(changed, first);
+    EXPECT_OUTCOME_TRUE(response, codec::cbor::decode<AskResponse>(*changed));
+    EXPECT_EQ(response.ask.ask.price, price);
+  }
+
 }  // namespace fc::markets::storage::provider
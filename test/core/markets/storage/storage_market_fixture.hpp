@@ -150,7 +150,12 @@ namespace fc::markets::storage::test {
                              private_keys);
       sector_blocks = std::make_shared<SectorBlocksMock>();
 
-      EXPECT_CALL(*sector_blocks, addPiece(_, _, _))
+      EXPECT_CALL(*sector_blocks,
+                  addPiece(_, testing::A<const std::string &>(), _))
+          .WillRepeatedly(testing::Return(outcome::success(PieceAttributes{})));
+      using fc::primitives::piece::PieceData;
+      EXPECT_CALL(*sector_blocks,
+                  addPiece(_, testing::A<const PieceData &>(), _))
           .WillRepeatedly(testing::Return(outcome::success(PieceAttributes{})));
 
       EXPECT_CALL(*sector_blocks, getRefs(_))
@@ -0,0 +1,48 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "power/power_snapshot.hpp"
+
+#include <gtest/gtest.h>
+
+#include "power/power_table_error.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::power::Claim;
+using fc::power::PowerSnapshot;
+using fc::power::PowerTableError;
+using fc::power::StoragePowerActorState;
+using fc::primitives::address::Address;
+using fc::storage::ipfs::InMemoryDatastore;
+
+/**
+ * @given power state with claims
+ * @when make snapshot
+ * @then claims are sorted by miner and found, totals are copied
+ */
+TEST(PowerSnapshotTest, Claims) {
+  auto ipld{std::make_shared<InMemoryDatastore>()};
+  auto state{StoragePowerActorState::empty(ipld)};
+  state.total_raw_power = 600;
+  state.total_qa_power = 700;
+  state.num_miners_meeting_min_power = 2;
+  for (uint64_t id{100}; id != 0; id -= 10) {
+    EXPECT_OUTCOME_TRUE_1(
+        state.claims.set(Address::makeFromId(id), Claim{id, id * 2}));
+  }
+
+  EXPECT_OUTCOME_TRUE(snapshot, PowerSnapshot::make(state));
+  EXPECT_EQ(snapshot->total(), (Claim{600, 700}));
+  EXPECT_EQ(snapshot->minersMeetingMinPower(), 2);
+  auto &entries{snapshot->entries()};
+  EXPECT_EQ(entries.size(), 10);
+  for (size_t i{1}; i < entries.size(); ++i) {
+    EXPECT_LT(entries[i - 1].miner, entries[i].miner);
+  }
+  EXPECT_OUTCOME_EQ(snapshot->claim(Address::makeFromId(30)), (Claim{30, 60}));
+  EXPECT_OUTCOME_ERROR(PowerTableError::kNoSuchMiner,
+                       snapshot->claim(Address::makeFromId(35)));
+}
@@ -5,6 +5,8 @@
 
 #include "primitives/cid/cid.hpp"
 
+#include "primitives/cid/compact_cid.hpp"
+
 #include <gtest/gtest.h>
 #include "testutil/literals.hpp"
 #include "testutil/outcome.hpp"
@@ -35,4 +37,24 @@ namespace fc::primitives::cid {
     EXPECT_OUTCOME_EQ(cid.getPrefix(), "01711220"_unhex);
   }
 
+  /**
+   * @given cids v0 and v1
+   * @when convert them to compact cids
+   * @then bytes are same as CID::toBytes and cids are restored
+   */
+  TEST(CidTest, Compact) {
+    for (auto &cid : {
+             "12202d5bb7c3afbe68c05bcd109d890dca28ceb0105bf529ea1111f9ef8b44b217b9"_cid,
+             "017112202d5bb7c3afbe68c05bcd109d890dca28ceb0105bf529ea1111f9ef8b44b217b9"_cid,
+         }) {
+      CompactCid compact{cid};
+      EXPECT_OUTCOME_EQ(cid.toBytes(),
+                        std::vector<uint8_t>(compact.bytes().begin(),
+                                             compact.bytes().end()));
+      EXPECT_OUTCOME_EQ(compact.toCid(), cid);
+      EXPECT_EQ(compact, CompactCid::fromBytes(compact.bytes()));
+      EXPECT_EQ(std::hash<CompactCid>{}(compact), compact.hash());
+    }
+  }
+
 }  // namespace fc::primitives::cid
@@ -0,0 +1,64 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/resources/active_resources.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::primitives::ActiveResources;
+using fc::primitives::canHandleRequest;
+using fc::primitives::Resources;
+using fc::primitives::WorkerResources;
+
+Resources gpuTask() {
+  return Resources{.min_memory = 1,
+                   .max_memory = 1,
+                   .threads = 1,
+                   .can_gpu = true,
+                   .base_min_memory = 0};
+}
+
+WorkerResources worker(size_t gpus) {
+  return WorkerResources{.physical_memory = 100,
+                         .swap_memory = 0,
+                         .reserved_memory = 0,
+                         .cpus = 16,
+                         .gpus = std::vector<std::string>(gpus, "gpu")};
+}
+
+/**
+ * @given worker with 4 gpus
+ * @when gpu tasks are added
+ * @then each task takes own device, one device is left for PoSt
+ */
+TEST(ActiveResources, MultiGpu) {
+  auto resources{worker(4)};
+  ActiveResources active;
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_TRUE(canHandleRequest(gpuTask(), resources, active));
+    EXPECT_EQ(active.add(resources, gpuTask()), i);
+  }
+  EXPECT_EQ(active.gpusUsed(), 3);
+  EXPECT_FALSE(canHandleRequest(gpuTask(), resources, active));
+
+  active.free(resources, gpuTask(), 1);
+  EXPECT_TRUE(canHandleRequest(gpuTask(), resources, active));
+  EXPECT_EQ(active.add(resources, gpuTask()), 1);
+}
+
+/**
+ * @given worker with 1 gpu
+ * @when gpu task is added
+ * @then next gpu task waits until device is freed
+ */
+TEST(ActiveResources, SingleGpu) {
+  auto resources{worker(1)};
+  ActiveResources active;
+  EXPECT_EQ(active.add(resources, gpuTask()), 0);
+  EXPECT_FALSE(canHandleRequest(gpuTask(), resources, active));
+  active.free(resources, gpuTask());
+  EXPECT_EQ(active.gpusUsed(), 0);
+  EXPECT_TRUE(canHandleRequest(gpuTask(), resources, active));
+}
@@ -32,3 +32,35 @@ TEST(RleBitsetTest, Runs) {
   expect({1}, {1, 1});
   expect({1, 2}, {1, 2});
 }
+
+/// Set operations on runs
+TEST(RleBitsetTest, Operations) {
+  using fc::primitives::RleBitset;
+  RleBitset a{1, 2, 3, 7, 8, 10};
+  RleBitset b{3, 4, 8, 9};
+  EXPECT_EQ(a.runs().size(), 3);
+  EXPECT_EQ(a.size(), 6);
+  EXPECT_TRUE(a.has(7));
+  EXPECT_FALSE(a.has(9));
+  EXPECT_EQ(a + b, (RleBitset{1, 2, 3, 4, 7, 8, 9, 10}));
+  EXPECT_EQ((a + b).runs().size(), 2);
+  EXPECT_EQ(a - b, (RleBitset{1, 2, 7, 10}));
+  EXPECT_EQ(a.intersect(b), (RleBitset{3, 8}));
+  EXPECT_EQ(a.slice(2, 3), (RleBitset{3, 7, 8}));
+  a.erase(2);
+  EXPECT_EQ(a, (RleBitset{1, 3, 7, 8, 10}));
+  a.insert(2);
+  a.insert(9);
+  EXPECT_EQ(a.runs().size(), 2);
+  EXPECT_EQ((std::vector<uint64_t>{a.begin(), a.end()}),
+            (std::vector<uint64_t>{1, 2, 3, 7, 8, 9, 10}));
+}
+
+/// Large bitfield is encoded and decoded without expanding runs
+TEST(RleBitsetTest, LargeRuns) {
+  using fc::primitives::RleBitset;
+  auto set{RleBitset::fromRuns({5, 10000000, 1, 3})};
+  EXPECT_EQ(set.size(), 10000003);
+  EXPECT_OUTCOME_TRUE(encoded, fc::codec::cbor::encode(set));
+  EXPECT_OUTCOME_EQ(fc::codec::cbor::decode<RleBitset>(encoded), set);
+}
@@ -0,0 +1,72 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/stored_counter/stored_counter.hpp"
+
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+
+#include "storage/in_memory/in_memory_storage.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::primitives::StoredCounter;
+using fc::storage::InMemoryStorage;
+
+/**
+ * @given counter reserving blocks of numbers
+ * @when numbers are taken, and counter is reopened
+ * @then numbers are consecutive, reopened counter continues after block
+ */
+TEST(StoredCounterTest, ReserveBlocks) {
+  auto datastore{std::make_shared<InMemoryStorage>()};
+  StoredCounter counter{datastore, "counter", 10};
+  for (uint64_t i{0}; i < 25; ++i) {
+    EXPECT_OUTCOME_EQ(counter.next(), i);
+  }
+  StoredCounter reopened{datastore, "counter", 10};
+  EXPECT_OUTCOME_EQ(reopened.next(), 30);
+}
+
+/**
+ * @given counter reserving one number
+ * @when counter is reopened
+ * @then no number is skipped
+ */
+TEST(StoredCounterTest, ReserveOne) {
+  auto datastore{std::make_shared<InMemoryStorage>()};
+  StoredCounter counter{datastore, "counter"};
+  EXPECT_OUTCOME_EQ(counter.next(), 0);
+  EXPECT_OUTCOME_EQ(counter.next(), 1);
+  StoredCounter reopened{datastore, "counter"};
+  EXPECT_OUTCOME_EQ(reopened.next(), 2);
+}
+
+/**
+ * @given counter used by several threads
+ * @when numbers are taken concurrently
+ * @then all numbers are distinct
+ */
+TEST(StoredCounterTest, Concurrent) {
+  StoredCounter counter{std::make_shared<InMemoryStorage>(), "counter", 8};
+  std::vector<std::vector<uint64_t>> taken(4);
+  std::vector<std::thread> threads;
+  for (auto &numbers : taken) {
+    threads.emplace_back([&] {
+      for (auto i{0}; i < 100; ++i) {
+        numbers.push_back(counter.next().value());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::set<uint64_t> all;
+  for (auto &numbers : taken) {
+    all.insert(numbers.begin(), numbers.end());
+  }
+  EXPECT_EQ(all.size(), 400);
+  EXPECT_EQ(*all.rbegin(), 399);
+}
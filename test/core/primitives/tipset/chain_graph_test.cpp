@@ -0,0 +1,104 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/tipset/chain_graph.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::primitives::block::BlockHeader;
+using fc::primitives::tipset::ChainGraph;
+using fc::primitives::tipset::HeadChange;
+using fc::primitives::tipset::HeadChangeType;
+using fc::primitives::tipset::Tipset;
+using fc::primitives::tipset::TipsetCPtr;
+using fc::primitives::tipset::TipsetError;
+using fc::storage::ipfs::InMemoryDatastore;
+
+struct ChainGraphTest : ::testing::Test {
+  TipsetCPtr make(const TipsetCPtr &parent, uint64_t height) {
+    BlockHeader block;
+    block.ticket.emplace();
+    block.height = height;
+    // distinct fork tipsets at same height
+    block.timestamp = ++unique;
+    if (parent) {
+      block.parents = parent->key.cids();
+    }
+    EXPECT_OUTCOME_TRUE_1(ipld->setCbor(block));
+    EXPECT_OUTCOME_TRUE(ts, Tipset::create({block}));
+    return ts;
+  }
+
+  /// Chain of tipsets above parent, inserted into graph
+  std::vector<TipsetCPtr> chain(ChainGraph &graph,
+                                TipsetCPtr parent,
+                                size_t n) {
+    std::vector<TipsetCPtr> tipsets;
+    for (size_t i{0}; i < n; ++i) {
+      parent = make(parent, parent ? parent->height() + 1 : 0);
+      EXPECT_OUTCOME_TRUE_1(graph.insert(parent));
+      tipsets.push_back(parent);
+    }
+    return tipsets;
+  }
+
+  std::shared_ptr<InMemoryDatastore> ipld{
+      std::make_shared<InMemoryDatastore>()};
+  ChainGraph graph{ipld};
+  uint64_t unique{};
+};
+
+/**
+ * @given long chain in graph and fork with null round not inserted
+ * @when common ancestor and head changes are computed
+ * @then fork point is found, reverts go down to it, applies go up from it
+ */
+TEST_F(ChainGraphTest, Fork) {
+  auto main{chain(graph, nullptr, 100)};
+  auto &fork_point{main[60]};
+  auto fork1{make(fork_point, 61)};
+  auto fork3{make(fork1, 63)};
+
+  EXPECT_OUTCOME_EQ(graph.commonAncestor(main[99], fork3), fork_point);
+  EXPECT_OUTCOME_EQ(graph.commonAncestor(main[99], main[10]), main[10]);
+
+  EXPECT_OUTCOME_TRUE(changes, graph.headChanges(main[62], fork3));
+  ASSERT_EQ(changes.size(), 4);
+  EXPECT_EQ(changes[0].type, HeadChangeType::REVERT);
+  EXPECT_EQ(changes[0].value, main[62]);
+  EXPECT_EQ(changes[1].type, HeadChangeType::REVERT);
+  EXPECT_EQ(changes[1].value, main[61]);
+  EXPECT_EQ(changes[2].type, HeadChangeType::APPLY);
+  EXPECT_EQ(changes[2].value->key, fork1->key);
+  EXPECT_EQ(changes[3].type, HeadChangeType::APPLY);
+  EXPECT_EQ(changes[3].value, fork3);
+
+  EXPECT_OUTCOME_TRUE(forward, graph.headChanges(main[50], main[52]));
+  ASSERT_EQ(forward.size(), 2);
+  EXPECT_EQ(forward[0].value, main[51]);
+  EXPECT_EQ(forward[1].value, main[52]);
+}
+
+/**
+ * @given graph with small window and chains with different genesis
+ * @when chain grows above window and ancestors are requested
+ * @then old tipsets are pruned and loaded again when needed, different
+ * genesis has no common ancestor
+ */
+TEST_F(ChainGraphTest, PruneAndUnrelated) {
+  ChainGraph small{ipld, nullptr, 16};
+  auto main{chain(small, nullptr, 100)};
+  EXPECT_LT(small.size(), 40);
+  EXPECT_OUTCOME_TRUE(changes, small.headChanges(main[99], main[5]));
+  EXPECT_EQ(changes.size(), 94);
+  EXPECT_EQ(changes.back().value->key, main[6]->key);
+
+  auto other{chain(small, nullptr, 3)};
+  EXPECT_OUTCOME_ERROR(TipsetError::kNoCommonAncestor,
+                       small.commonAncestor(main[2], other[2]));
+}
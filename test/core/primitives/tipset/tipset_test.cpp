@@ -9,6 +9,9 @@
 #include "common/hexutil.hpp"
 #include "crypto/blake2/blake2b160.hpp"
 #include "primitives/cid/cid_of_cbor.hpp"
+#include "primitives/tipset/randomness_cache.hpp"
+#include "primitives/tipset/tipset_cache.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "testutil/cbor.hpp"
 #include "testutil/crypto/sample_signatures.hpp"
 #include "testutil/literals.hpp"
@@ -163,3 +166,75 @@ TEST_F(TipsetTest, CreateSuccess) {
   ASSERT_EQ(ts.key.cids(), ts2.key.cids());
   ASSERT_EQ(ts.blks, ts2.blks);
 }
+
+/**
+ * @given tipset cache and blocks in ipld
+ * @when tipset is loaded twice
+ * @then second load returns same decoded tipset from cache
+ */
+TEST_F(TipsetTest, Cache) {
+  fc::storage::ipfs::InMemoryDatastore ipld;
+  EXPECT_OUTCOME_TRUE_1(ipld.setCbor(bh1));
+  fc::primitives::tipset::TipsetCache cache{1};
+  fc::TipsetKey key{{cid1}};
+  EXPECT_FALSE(cache.get(key));
+  EXPECT_OUTCOME_TRUE(ts1, cache.load(ipld, key));
+  EXPECT_OUTCOME_TRUE(ts2, cache.load(ipld, key));
+  EXPECT_EQ(ts1, ts2);
+  EXPECT_EQ(ts1->key, key);
+  auto stats{cache.stats()};
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.size, 1);
+}
+
+/**
+ * @given chain of tipsets and randomness cache
+ * @when ticket randomness of genesis round is drawn from head, then from
+ * child of head after middle block is removed from ipld
+ * @then randomness matches uncached one, second lookup ends at cached head
+ */
+TEST_F(TipsetTest, RandomnessCache) {
+  using fc::crypto::randomness::DomainSeparationTag;
+  fc::storage::ipfs::InMemoryDatastore ipld;
+  auto tag{DomainSeparationTag::TicketProduction};
+  std::vector<BlockHeader> blocks;
+  for (auto height{0}; height < 4; ++height) {
+    auto block{makeBlock()};
+    block.height = height;
+    block.ticket = height == 0 ? ticket1 : ticket2;
+    block.parents.clear();
+    if (!blocks.empty()) {
+      EXPECT_OUTCOME_TRUE(parent, getCidOfCbor(blocks.back()));
+      block.parents.push_back(parent);
+    }
+    EXPECT_OUTCOME_TRUE_1(ipld.setCbor(block));
+    blocks.push_back(block);
+  }
+  EXPECT_OUTCOME_TRUE(head, Tipset::create({blocks[2]}));
+  EXPECT_OUTCOME_TRUE(child, Tipset::create({blocks[3]}));
+  EXPECT_OUTCOME_TRUE(expected, head->ticketRandomness(ipld, tag, 0, {}));
+
+  fc::primitives::tipset::RandomnessCache cache;
+  EXPECT_OUTCOME_EQ(head->ticketRandomness(ipld, tag, 0, {}, &cache),
+                    expected);
+  EXPECT_OUTCOME_TRUE(middle, getCidOfCbor(blocks[1]));
+  EXPECT_OUTCOME_TRUE_1(ipld.remove(middle));
+  EXPECT_OUTCOME_EQ(child->ticketRandomness(ipld, tag, 0, {}, &cache),
+                    expected);
+}
+
+/**
+ * @given tipset keys with same cids in different order
+ * @when compare and hash them
+ * @then keys are equal and have same hash
+ */
+TEST_F(TipsetTest, KeyHash) {
+  fc::TipsetKey key1{{cid1, cid2}}, key2{{cid2, cid1}}, key3{{cid1}};
+  EXPECT_EQ(key1, key2);
+  EXPECT_NE(key1, key3);
+  EXPECT_EQ(std::hash<fc::TipsetKey>{}(key1),
+            std::hash<fc::TipsetKey>{}(key2));
+  EXPECT_EQ(key1.hash(), fc::TipsetKey::hash({cid2, cid1}));
+  EXPECT_NE(fc::TipsetKey{}, key3);
+}
@@ -0,0 +1,58 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "proofs/fr32.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::proofs::fr32::kPaddedBlock;
+using fc::proofs::fr32::kUnpaddedBlock;
+
+/**
+ * @given block of ones
+ * @when pad it
+ * @then each field element has two high bits zero
+ */
+TEST(Fr32Test, PadOnes) {
+  std::vector<uint8_t> in(kUnpaddedBlock, 0xff), out(kPaddedBlock);
+  fc::proofs::fr32::pad(in, out);
+  for (size_t i{0}; i < kPaddedBlock; ++i) {
+    EXPECT_EQ(out[i], i % 32 == 31 ? 0x3f : 0xff) << i;
+  }
+}
+
+/**
+ * @given single bits at field element boundaries
+ * @when pad them
+ * @then bits are moved to low bits of next field elements
+ */
+TEST(Fr32Test, PadBoundaryBits) {
+  std::vector<uint8_t> in(kUnpaddedBlock), out(kPaddedBlock);
+  // bits 254, 508 and 762 start elements 1, 2 and 3
+  in[31] = 0x40;
+  in[63] = 0x10;
+  in[95] = 0x04;
+  fc::proofs::fr32::pad(in, out);
+  std::vector<uint8_t> expected(kPaddedBlock);
+  expected[32] = expected[64] = expected[96] = 1;
+  EXPECT_EQ(out, expected);
+}
+
+/**
+ * @given several blocks of data
+ * @when pad and unpad them
+ * @then original data is returned
+ */
+TEST(Fr32Test, RoundTrip) {
+  constexpr size_t kBlocks{5};
+  std::vector<uint8_t> in(kBlocks * kUnpaddedBlock);
+  for (size_t i{0}; i < in.size(); ++i) {
+    in[i] = static_cast<uint8_t>(i * 131 + 7);
+  }
+  std::vector<uint8_t> padded(kBlocks * kPaddedBlock), out(in.size());
+  fc::proofs::fr32::pad(in, padded);
+  fc::proofs::fr32::unpad(padded, out);
+  EXPECT_EQ(out, in);
+}
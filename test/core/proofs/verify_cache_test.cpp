@@ -0,0 +1,56 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "proofs/verify_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include "primitives/sector/sector.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::primitives::sector::WindowPoStVerifyInfo;
+using fc::proofs::VerifyCache;
+using fc::proofs::VerifyKind;
+
+/**
+ * @given verify info verified once
+ * @when verify same info again
+ * @then cached result is returned without verification
+ */
+TEST(VerifyCacheTest, Memoized) {
+  VerifyCache cache{16};
+  WindowPoStVerifyInfo info;
+  info.prover = 1;
+  size_t calls{0};
+  auto verify{[&](auto &) -> fc::outcome::result<bool> {
+    ++calls;
+    return true;
+  }};
+  EXPECT_OUTCOME_EQ(cache.verify(VerifyKind::kWindowPoSt, info, verify), true);
+  EXPECT_OUTCOME_EQ(cache.verify(VerifyKind::kWindowPoSt, info, verify), true);
+  EXPECT_EQ(calls, 1);
+
+  info.prover = 2;
+  EXPECT_OUTCOME_EQ(cache.verify(VerifyKind::kWindowPoSt, info, verify), true);
+  EXPECT_EQ(calls, 2);
+}
+
+/**
+ * @given verification which fails
+ * @when verify again
+ * @then error is not cached
+ */
+TEST(VerifyCacheTest, ErrorNotCached) {
+  VerifyCache cache{16};
+  WindowPoStVerifyInfo info;
+  size_t calls{0};
+  auto verify{[&](auto &) -> fc::outcome::result<bool> {
+    ++calls;
+    return fc::outcome::failure(std::errc::io_error);
+  }};
+  EXPECT_FALSE(cache.verify(VerifyKind::kWindowPoSt, info, verify));
+  EXPECT_FALSE(cache.verify(VerifyKind::kWindowPoSt, info, verify));
+  EXPECT_EQ(calls, 2);
+}
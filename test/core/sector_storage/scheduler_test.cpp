@@ -8,6 +8,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <thread>
+#include "storage/in_memory/in_memory_storage.hpp"
 #include "testutil/mocks/sector_storage/selector_mock.hpp"
 #include "testutil/outcome.hpp"
 
@@ -177,3 +178,67 @@ TEST_F(SchedulerTest, DISABLED_RequestQueue) {
   ASSERT_FALSE(thread_error);
   EXPECT_EQ(counter, 4);
 }
+
+/**
+ * @given worker which doesn't satisfy task
+ * @when schedule task without blocking
+ * @then callback is called with not found worker error and task is not queued
+ */
+TEST_F(SchedulerTest, ScheduleAsyncNotFoundWorker) {
+  WorkerAction action = [](const std::shared_ptr<Worker> &worker) {
+    return fc::outcome::success();
+  };
+
+  SectorId sector{
+      .miner = 42,
+      .sector = 1,
+  };
+
+  auto task = fc::primitives::kTTFinalize;
+  EXPECT_CALL(
+      *selector_,
+      is_satisfying(task, seal_proof_type_, workerNameMatcher(worker_name_)))
+      .WillOnce(testing::Return(fc::outcome::success(false)));
+
+  boost::optional<fc::outcome::result<void>> result;
+  scheduler_->scheduleAsync(
+      sector, task, selector_, action, action, [&](auto res) {
+        result = std::move(res);
+      });
+
+  ASSERT_TRUE(result);
+  EXPECT_OUTCOME_ERROR(fc::sector_storage::SchedulerErrors::kNotFoundWorker,
+                       *result);
+  EXPECT_EQ(scheduler_->queuedTasks(task), 0);
+}
+
+/**
+ * @given calibration persisted in storage
+ * @when task runs enough times with measured memory
+ * @then measured memory with margin replaces static resources, also after
+ * reload from storage
+ */
+TEST(TaskCalibrationTest, CalibratedResources) {
+  using fc::sector_storage::TaskCalibration;
+  auto kv{std::make_shared<fc::storage::InMemoryStorage>()};
+  auto proof{RegisteredProof::StackedDRG2KiBSeal};
+  auto task{fc::primitives::kTTPreCommit1};
+  fc::primitives::Resources fallback{
+      .min_memory = 100, .max_memory = 200, .threads = 1};
+  auto calibration{std::make_shared<TaskCalibration>(kv)};
+
+  for (uint64_t i{0}; i < TaskCalibration::kMinMemoryRuns; ++i) {
+    EXPECT_EQ(calibration->resources("host", task, proof, fallback),
+              fallback);
+    calibration->record(
+        "host", task, proof, 20 * (i + 1), std::chrono::milliseconds{10});
+  }
+  auto expected{fallback};
+  expected.min_memory = expected.max_memory = 69;
+  EXPECT_EQ(calibration->resources("host", task, proof, fallback), expected);
+  EXPECT_EQ(calibration->resources("other", task, proof, fallback), fallback);
+
+  calibration = std::make_shared<TaskCalibration>(kv);
+  EXPECT_EQ(calibration->resources("host", task, proof, fallback), expected);
+  EXPECT_EQ(calibration->measure("host", task, proof)->total_ms, 30);
+}
@@ -0,0 +1,122 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/stores/impl/fetch_handler.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/asio/io_context.hpp>
+
+#include "common/file.hpp"
+#include "common/tarutil.hpp"
+#include "testutil/mocks/sector_storage/stores/local_store_mock.hpp"
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+namespace fc::sector_storage::stores {
+  namespace net = boost::asio;
+  namespace http = boost::beast::http;
+  using common::readFile;
+  using common::writeFile;
+  using net::ip::tcp;
+  using primitives::sector_file::sectorName;
+  using testing::_;
+  using testing::Return;
+
+  class FetchHandlerTest : public test::BaseFS_Test {
+   public:
+    FetchHandlerTest() : test::BaseFS_Test("fc_fetch_handler_test") {}
+
+    /// Passes request to handler, returns response read until close
+    std::pair<std::string, std::string> fetch(const std::string &target,
+                                              const std::string &range = {}) {
+      FetchHandler::Request req{http::verb::get, target, 11};
+      if (!range.empty()) {
+        req.set(http::field::range, range);
+      }
+      tcp::acceptor acceptor{io, {net::ip::make_address("127.0.0.1"), 0}};
+      tcp::socket client{io}, server{io};
+      client.connect(acceptor.local_endpoint());
+      acceptor.accept(server);
+      handler(std::move(req), std::move(server));
+      std::string response;
+      boost::system::error_code ec;
+      char chunk[4096];
+      while (!ec) {
+        auto n{client.read_some(net::buffer(chunk), ec)};
+        response.append(chunk, n);
+      }
+      auto split{response.find("\r\n\r\n")};
+      EXPECT_NE(split, std::string::npos);
+      return {response.substr(0, split), response.substr(split + 4)};
+    }
+
+    void expectAcquire(SectorFileType type, const fs::path &path) {
+      AcquireSectorResponse response;
+      response.paths.setPathByType(type, path.string());
+      EXPECT_CALL(*local, acquireSector(_, _, type, _, _, _))
+          .WillOnce(Return(response));
+    }
+
+    SectorId sector{1, 2};
+    net::io_context io;
+    std::shared_ptr<LocalStoreMock> local{std::make_shared<LocalStoreMock>()};
+    FetchHandler handler{local};
+  };
+
+  /**
+   * @given sealed sector file
+   * @when fetch it with range and without
+   * @then range is sent with content range, whole file is sent without
+   */
+  TEST_F(FetchHandlerTest, SealedRange) {
+    Buffer data(100, 0);
+    for (size_t i{0}; i < data.size(); ++i) {
+      data[i] = i;
+    }
+    auto path{base_path / "sealed"};
+    EXPECT_OUTCOME_TRUE_1(writeFile(path.string(), data));
+    auto target{"/remote/sealed/" + sectorName(sector)};
+
+    expectAcquire(SectorFileType::FTSealed, path);
+    auto [head, body]{fetch(target, "bytes=10-19")};
+    EXPECT_NE(head.find("206"), std::string::npos);
+    EXPECT_NE(head.find("Content-Range: bytes 10-19/100"), std::string::npos);
+    EXPECT_EQ(Buffer{common::span::cbytes(body)}, data.subbuffer(10, 10));
+
+    expectAcquire(SectorFileType::FTSealed, path);
+    auto [head2, body2]{fetch(target)};
+    EXPECT_NE(head2.find("200"), std::string::npos);
+    EXPECT_NE(head2.find("application/octet-stream"), std::string::npos);
+    EXPECT_EQ(Buffer{common::span::cbytes(body2)}, data);
+
+    expectAcquire(SectorFileType::FTSealed, path);
+    EXPECT_NE(fetch(target, "bytes=100-").first.find("416"),
+              std::string::npos);
+  }
+
+  /**
+   * @given cache directory with nested file
+   * @when fetch it
+   * @then tar is streamed, and extracts to same files
+   */
+  TEST_F(FetchHandlerTest, CacheTar) {
+    auto dir{createDir("cache")};
+    fs::create_directories(dir / "sub");
+    EXPECT_OUTCOME_TRUE_1(writeFile((dir / "p_aux").string(), Buffer{1, 2}));
+    Buffer big(3000, 7);
+    EXPECT_OUTCOME_TRUE_1(writeFile((dir / "sub" / "tree").string(), big));
+
+    expectAcquire(SectorFileType::FTCache, dir);
+    auto [head, body]{fetch("/remote/cache/" + sectorName(sector))};
+    EXPECT_NE(head.find("application/x-tar"), std::string::npos);
+    auto tar{base_path / "cache.tar"};
+    EXPECT_OUTCOME_TRUE_1(
+        writeFile(tar.string(), common::span::cbytes(body)));
+    auto out{base_path / "out"};
+    EXPECT_OUTCOME_TRUE_1(common::extractTar(tar.string(), out.string()));
+    EXPECT_OUTCOME_EQ(readFile((out / "p_aux").string()), (Buffer{1, 2}));
+    EXPECT_OUTCOME_EQ(readFile((out / "sub" / "tree").string()), big);
+  }
+}  // namespace fc::sector_storage::stores
@@ -312,6 +312,48 @@ TEST_F(SectorIndexTest, StorageDropSector) {
   ASSERT_TRUE(storages.empty());
 }
 
+/**
+ * @given storage with sectors of several types
+ * @when drop one type
+ * @then reverse index of storage keeps only declared types
+ */
+TEST_F(SectorIndexTest, StorageSectors) {
+  std::string id = "test_id";
+  StorageInfo storage_info{
+      .id = id,
+      .urls = {"http://url1.com/"},
+      .weight = 0,
+      .can_seal = false,
+      .can_store = false,
+  };
+  FsStat file_system_stat{
+      .capacity = 100,
+      .available = 100,
+      .reserved = 0,
+  };
+  SectorId sector{
+      .miner = 42,
+      .sector = 123,
+  };
+
+  EXPECT_OUTCOME_TRUE_1(
+      sector_index_->storageAttach(storage_info, file_system_stat));
+  EXPECT_OUTCOME_TRUE_1(sector_index_->storageDeclareSector(
+      id,
+      sector,
+      static_cast<SectorFileType>(SectorFileType::FTCache
+                                  | SectorFileType::FTSealed),
+      false));
+  auto index = std::static_pointer_cast<SectorIndexImpl>(sector_index_);
+  EXPECT_EQ(index->storageSectors(id).size(), 2);
+  EXPECT_OUTCOME_TRUE_1(
+      sector_index_->storageDropSector(id, sector, SectorFileType::FTCache));
+  auto sectors = index->storageSectors(id);
+  ASSERT_EQ(sectors.size(), 1);
+  EXPECT_EQ(sectors[0].type, SectorFileType::FTSealed);
+  EXPECT_EQ(sectors[0].sector_id, sector);
+}
+
 /**
  * @given storage info and sector id
  * @when try to find sector wihout fetch flag
@@ -429,3 +471,46 @@ TEST_F(SectorIndexTest, LockSectorReading) {
   EXPECT_OUTCOME_TRUE_1(sector_index_->storageLock(sector, read, write))
   EXPECT_OUTCOME_TRUE_1(sector_index_->storageLock(sector, read, write))
 }
+
+/**
+ * @given sector locked for reading and queued writer
+ * @when reader and priority reader wait for lock
+ * @then priority reader is granted before writer, reader after writer
+ */
+TEST_F(SectorIndexTest, LockAsyncFair) {
+  SectorId sector{
+      .miner = 42,
+      .sector = 123,
+  };
+  using LockPtr = std::unique_ptr<fc::sector_storage::stores::Lock>;
+  auto read{SectorFileType::FTSealed};
+  auto none{SectorFileType::FTNone};
+  std::vector<std::string> order;
+  LockPtr writer, reader, priority;
+  auto save{[&](LockPtr &lock, std::string name) {
+    return [&, name](fc::outcome::result<LockPtr> locked) {
+      lock = std::move(locked.value());
+      order.push_back(name);
+    };
+  }};
+
+  EXPECT_OUTCOME_TRUE(held, sector_index_->storageLock(sector, read, none));
+  sector_index_->storageLockAsync(
+      sector, none, read, false, save(writer, "writer"));
+  sector_index_->storageLockAsync(
+      sector, read, none, false, save(reader, "reader"));
+  sector_index_->storageLockAsync(
+      sector, read, none, true, save(priority, "priority"));
+  EXPECT_EQ(order, std::vector<std::string>{"priority"});
+
+  // not waiting reader isn't queued behind writer
+  EXPECT_TRUE(sector_index_->storageTryLock(sector, read, none));
+
+  held.reset();
+  priority.reset();
+  EXPECT_EQ(order, (std::vector<std::string>{"priority", "writer"}));
+
+  writer.reset();
+  EXPECT_EQ(order,
+            (std::vector<std::string>{"priority", "writer", "reader"}));
+}
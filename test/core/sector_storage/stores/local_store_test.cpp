@@ -7,6 +7,7 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <future>
 #include <libp2p/protocol/common/asio/asio_scheduler.hpp>
 
 #include "api/rpc/json.hpp"
@@ -304,6 +305,71 @@ TEST_F(LocalStoreTest, AcqireSectorExistSuccess) {
   EXPECT_OUTCOME_EQ(sectors.storages.getPathByType(file_type), storage_id);
 }
 
+/**
+ * @given storage with sealed file and cache directory of sector
+ * @when prewarm sealed and cache files
+ * @then all files are requested to be read
+ */
+TEST_F(LocalStoreTest, PrewarmSector) {
+  SectorId sector{
+      .miner = 42,
+      .sector = 1,
+  };
+  auto storage_path = boost::filesystem::unique_path(
+                          fs::canonical(base_path).append("%%%%%-storage"))
+                          .string();
+  StorageID storage_id = "storage_id";
+  createStorage(storage_path,
+                {
+                    .id = storage_id,
+                    .weight = 0,
+                    .can_seal = true,
+                    .can_store = true,
+                },
+                {
+                    .capacity = 200,
+                    .available = 200,
+                    .reserved = 0,
+                });
+  std::vector res = {StorageInfo{
+      .id = storage_id,
+      .urls = urls_,
+      .weight = 0,
+      .can_seal = true,
+      .can_store = true,
+  }};
+  auto name{fc::primitives::sector_file::sectorName(sector)};
+  fs::path root{storage_path};
+  fs::create_directories(root / toString(SectorFileType::FTSealed));
+  fs::create_directories(root / toString(SectorFileType::FTCache) / name);
+  OUTCOME_EXCEPT(fc::common::writeFile(
+      (root / toString(SectorFileType::FTSealed) / name).string(),
+      fc::Buffer(100, 1)));
+  OUTCOME_EXCEPT(fc::common::writeFile(
+      (root / toString(SectorFileType::FTCache) / name / "p_aux").string(),
+      fc::Buffer(10, 2)));
+  OUTCOME_EXCEPT(
+      fc::common::writeFile((root / toString(SectorFileType::FTCache) / name
+                             / "sc-02-data-tree-r-last.dat")
+                                .string(),
+                            fc::Buffer(20, 3)));
+
+  EXPECT_CALL(
+      *index_,
+      storageFindSector(sector, SectorFileType::FTSealed, Eq(boost::none)))
+      .WillOnce(testing::Return(fc::outcome::success(res)));
+  EXPECT_CALL(
+      *index_,
+      storageFindSector(sector, SectorFileType::FTCache, Eq(boost::none)))
+      .WillOnce(testing::Return(fc::outcome::success(res)));
+
+  auto types{static_cast<SectorFileType>(SectorFileType::FTSealed
+                                         | SectorFileType::FTCache)};
+  EXPECT_OUTCOME_EQ(
+      local_store_->prewarm(sector, RegisteredProof::StackedDRG2KiBSeal, types),
+      130);
+}
+
 /**
  * @given nothing
  * @when try to get stat for some not existing storage
@@ -317,7 +383,7 @@ TEST_F(LocalStoreTest, getFSStatNotFound) {
 /**
  * @given storage
  * @when try to get stat for the storage
- * @then get stat of the storage from index
+ * @then stat sampled on open is returned without reading filesystem
  */
 TEST_F(LocalStoreTest, getFSStatSuccess) {
   auto storage_path = boost::filesystem::unique_path(
@@ -341,9 +407,6 @@ TEST_F(LocalStoreTest, getFSStatSuccess) {
 
   createStorage(storage_path, storage_meta, res_stat);
 
-  EXPECT_CALL(*storage_, getStat(storage_path))
-      .WillOnce(testing::Return(fc::outcome::success(res_stat)));
-
   StorageInfo storage_info{
       .id = storage_id,
       .urls = urls_,
@@ -812,7 +875,13 @@ TEST_F(LocalStoreTest, storageHealthSuccess) {
           testing::Return(current_time_ + toTicks(std::chrono::seconds(24))));
   EXPECT_CALL(*index_, storageReportHealth(storage_id, _))
       .WillOnce(testing::Return(fc::outcome::success()));
+  std::promise<void> sampled;
   EXPECT_CALL(*storage_, getStat(storage_path))
-      .WillOnce(testing::Return(fc::outcome::success(stat)));
+      .WillOnce(testing::DoAll(
+          testing::InvokeWithoutArgs([&] { sampled.set_value(); }),
+          testing::Return(fc::outcome::success(stat))));
   scheduler_->next_clock();
+  // stat is sampled in background
+  EXPECT_EQ(sampled.get_future().wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
 }
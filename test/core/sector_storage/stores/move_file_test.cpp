@@ -0,0 +1,70 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/stores/impl/move_file.hpp"
+
+#include <gtest/gtest.h>
+
+#include "common/file.hpp"
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+using fc::Buffer;
+using fc::common::readFile;
+using fc::common::writeFile;
+using fc::sector_storage::stores::copySectorFile;
+using fc::sector_storage::stores::MoveMethod;
+using fc::sector_storage::stores::moveSectorFile;
+
+class MoveFileTest : public test::BaseFS_Test {
+ public:
+  MoveFileTest() : test::BaseFS_Test("fc_move_file_test") {}
+
+  /// Cache-like directory with nested file
+  fs::path createTree(const std::string &name) {
+    auto dir = createDir(name);
+    fs::create_directories(dir / "sub");
+    EXPECT_OUTCOME_TRUE_1(writeFile((dir / "a").string(), data_a));
+    EXPECT_OUTCOME_TRUE_1(writeFile((dir / "sub" / "b").string(), data_b));
+    return dir;
+  }
+
+  void expectTree(const fs::path &dir) {
+    EXPECT_OUTCOME_EQ(readFile((dir / "a").string()), data_a);
+    EXPECT_OUTCOME_EQ(readFile((dir / "sub" / "b").string()), data_b);
+  }
+
+  Buffer data_a{1, 2, 3, 4};
+  Buffer data_b{5, 6};
+};
+
+/**
+ * @given directory on same filesystem
+ * @when move it
+ * @then it is renamed without copying
+ */
+TEST_F(MoveFileTest, MoveRenames) {
+  auto from = createTree("from");
+  auto to = base_path / "to";
+  EXPECT_OUTCOME_TRUE(moved, moveSectorFile(from.string(), to.string()));
+  EXPECT_EQ(moved.method, MoveMethod::kRename);
+  EXPECT_FALSE(exists(from));
+  expectTree(to);
+}
+
+/**
+ * @given directory tree
+ * @when copy it
+ * @then all files are copied, bytes of all files are counted
+ */
+TEST_F(MoveFileTest, CopyTree) {
+  auto from = createTree("from");
+  auto to = base_path / "to";
+  EXPECT_OUTCOME_TRUE(copied, copySectorFile(from.string(), to.string()));
+  EXPECT_NE(copied.method, MoveMethod::kRename);
+  EXPECT_EQ(copied.bytes, data_a.size() + data_b.size());
+  expectTree(from);
+  expectTree(to);
+}
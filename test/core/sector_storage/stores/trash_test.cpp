@@ -0,0 +1,55 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/stores/impl/trash.hpp"
+
+#include <gtest/gtest.h>
+
+#include "common/file.hpp"
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+using fc::Buffer;
+using fc::common::writeFile;
+using fc::sector_storage::stores::kTrashDir;
+using fc::sector_storage::stores::Trash;
+
+class TrashTest : public test::BaseFS_Test {
+ public:
+  TrashTest() : test::BaseFS_Test("fc_trash_test") {}
+};
+
+/**
+ * @given directory with nested files in storage root
+ * @when put it to trash
+ * @then it disappears at once, and is removed from trash after flush
+ */
+TEST_F(TrashTest, PutRemoves) {
+  auto dir = createDir("cache");
+  fs::create_directories(dir / "sub");
+  EXPECT_OUTCOME_TRUE_1(writeFile((dir / "a").string(), Buffer{1, 2}));
+  EXPECT_OUTCOME_TRUE_1(writeFile((dir / "sub" / "b").string(), Buffer{3}));
+
+  Trash trash;
+  EXPECT_OUTCOME_TRUE_1(trash.put(base_path.string(), dir.string()));
+  EXPECT_FALSE(fs::exists(dir));
+  trash.flush();
+  EXPECT_TRUE(fs::is_empty(base_path / kTrashDir));
+}
+
+/**
+ * @given leftovers in trash of storage root
+ * @when sweep root
+ * @then leftovers are removed
+ */
+TEST_F(TrashTest, SweepLeftovers) {
+  auto dir = createDir(kTrashDir);
+  EXPECT_OUTCOME_TRUE_1(writeFile((dir / "old").string(), Buffer{1}));
+
+  Trash trash;
+  trash.sweep(base_path.string());
+  trash.flush();
+  EXPECT_TRUE(fs::is_empty(dir));
+}
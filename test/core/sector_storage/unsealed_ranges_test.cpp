@@ -0,0 +1,47 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/impl/unsealed_ranges.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::sector_storage::SectorId;
+using fc::sector_storage::UnsealedRanges;
+
+const SectorId kSector1{.miner = 1, .sector = 1};
+const SectorId kSector2{.miner = 1, .sector = 2};
+
+/**
+ * @given unsealed adjacent ranges
+ * @when check range spanning both
+ * @then ranges are merged and range is unsealed
+ */
+TEST(UnsealedRangesTest, MergeRanges) {
+  UnsealedRanges ranges{0};
+  EXPECT_FALSE(ranges.has(kSector1, 0, 10));
+  ranges.add(kSector1, 0, 10, true);
+  ranges.add(kSector1, 10, 10, true);
+  EXPECT_TRUE(ranges.has(kSector1, 5, 10));
+  EXPECT_FALSE(ranges.has(kSector1, 15, 10));
+  EXPECT_EQ(ranges.bytes(), 20);
+  ranges.add(kSector1, 5, 10, true);
+  EXPECT_EQ(ranges.bytes(), 20);
+}
+
+/**
+ * @given budget for one sector
+ * @when unseal second sector
+ * @then least recently used sector is evicted
+ */
+TEST(UnsealedRangesTest, EvictLeastRecentlyUsed) {
+  UnsealedRanges ranges{10};
+  EXPECT_TRUE(ranges.add(kSector1, 0, 10, true).empty());
+  auto evicted = ranges.add(kSector2, 0, 10, true);
+  ASSERT_EQ(evicted.size(), 1);
+  EXPECT_EQ(evicted[0], kSector1);
+  EXPECT_FALSE(ranges.has(kSector1, 0, 10));
+  EXPECT_TRUE(ranges.has(kSector2, 0, 10));
+  EXPECT_EQ(ranges.bytes(), 10);
+}
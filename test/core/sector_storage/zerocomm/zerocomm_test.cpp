@@ -45,4 +45,29 @@ namespace fc::sector_storage::zerocomm {
                                "baga6ea4seaqlfzd37mi7vtmud5rk6xdvb47kltcn6ul5lr"
                                "hrnwzljv33v3a2gly"}));
 
+  /**
+   * @given size which is not power of two
+   * @when get zero commitment
+   * @then error returned
+   */
+  TEST(ZerocommTableTest, InvalidSize) {
+    EXPECT_OUTCOME_ERROR(ZerocommError::kInvalidSize,
+                         getZeroPieceCommitment(UnpaddedPieceSize{1000}));
+    EXPECT_OUTCOME_ERROR(
+        ZerocommError::kInvalidSize,
+        getZeroCommitment(PaddedPieceSize{uint64_t{1} << 42}));
+  }
+
+  /**
+   * @given zero piece commitment
+   * @when check piece
+   * @then piece is zero only with matching size
+   */
+  TEST(ZerocommTableTest, IsZeroPiece) {
+    UnpaddedPieceSize size{1016};
+    EXPECT_OUTCOME_TRUE(cid, getZeroPieceCommitment(size));
+    EXPECT_TRUE(isZeroPiece({size.padded(), cid}));
+    EXPECT_FALSE(isZeroPiece({PaddedPieceSize{2048}, cid}));
+  }
+
 }  // namespace fc::sector_storage::zerocomm
@@ -6,6 +6,7 @@
 #include "storage/amt/amt.hpp"
 
 #include <gtest/gtest.h>
+#include <boost/asio/thread_pool.hpp>
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "testutil/cbor.hpp"
 
@@ -147,3 +148,165 @@ TEST_F(AmtVisitTest, VisitError) {
                          return AmtError::kIndexTooBig;
                        }));
 }
+
+/**
+ * @given amt values set in one batch
+ * @when get them in one batch
+ * @then values and count match single element operations
+ */
+TEST_F(AmtTest, GetSetMany) {
+  std::vector<std::pair<uint64_t, Value>> pairs{
+      {1000, Value{"01"_unhex}}, {3, Value{"02"_unhex}}, {70, Value{"03"_unhex}}};
+  EXPECT_OUTCOME_TRUE_1(amt.setMany(pairs));
+  EXPECT_OUTCOME_EQ(amt.count(), 3);
+  EXPECT_OUTCOME_EQ(amt.get(70), Value{"03"_unhex});
+
+  EXPECT_OUTCOME_TRUE(root, amt.flush());
+  Amt amt2{store, root};
+  EXPECT_OUTCOME_TRUE(values, amt2.getMany({3, 4, 1000, 70, 1 << 30}));
+  ASSERT_EQ(values.size(), 5);
+  EXPECT_EQ(*values[0], Value{"02"_unhex});
+  EXPECT_FALSE(values[1]);
+  EXPECT_EQ(*values[2], Value{"01"_unhex});
+  EXPECT_EQ(*values[3], Value{"03"_unhex});
+  EXPECT_FALSE(values[4]);
+}
+
+/**
+ * @given flushed amt of several levels
+ * @when visit with prefetch and in parallel
+ * @then prefetch visits in same order as visit, parallel visits same keys
+ */
+TEST_F(AmtTest, VisitPrefetchParallel) {
+  for (uint64_t i = 0; i < 1000; i += 3) {
+    EXPECT_OUTCOME_TRUE_1(amt.set(i, Value{"01"_unhex}));
+  }
+  EXPECT_OUTCOME_TRUE(root, amt.flush());
+  auto collect{[&](auto &keys) {
+    return [&](auto key, auto &) {
+      keys.push_back(key);
+      return fc::outcome::success();
+    };
+  }};
+  std::vector<uint64_t> expected, prefetched, parallel;
+  EXPECT_OUTCOME_TRUE_1(Amt(store, root).visit(collect(expected)));
+
+  boost::asio::thread_pool pool{4};
+  EXPECT_OUTCOME_TRUE_1(
+      Amt(store, root).visitPrefetch(collect(prefetched), pool, 4));
+  EXPECT_EQ(prefetched, expected);
+
+  std::mutex mutex;
+  EXPECT_OUTCOME_TRUE_1(Amt(store, root).visitParallel(
+      [&](auto key, auto &) {
+        std::lock_guard lock{mutex};
+        parallel.push_back(key);
+        return fc::outcome::success();
+      },
+      pool));
+  std::sort(parallel.begin(), parallel.end());
+  EXPECT_EQ(parallel, expected);
+}
+
+/// Counts writes to check which nodes are flushed
+struct CountingDatastore : InMemoryDatastore {
+  fc::outcome::result<void> set(const fc::CID &key, Value value) override {
+    ++writes;
+    return InMemoryDatastore::set(key, std::move(value));
+  }
+
+  size_t writes{};
+};
+
+/**
+ * @given flushed amt of several levels
+ * @when flush again unchanged, then flush after one change
+ * @then unchanged flush writes nothing, changed flush writes only modified
+ * path and root equals root of amt built from scratch
+ */
+TEST_F(AmtTest, IncrementalFlush) {
+  auto store{std::make_shared<CountingDatastore>()};
+  Amt amt{store};
+  Amt expected{std::make_shared<InMemoryDatastore>()};
+  for (uint64_t i = 0; i < 1000; i += 3) {
+    EXPECT_OUTCOME_TRUE_1(amt.set(i, Value{"01"_unhex}));
+    EXPECT_OUTCOME_TRUE_1(expected.set(i, Value{"01"_unhex}));
+  }
+  EXPECT_OUTCOME_TRUE(root1, amt.flush());
+  auto writes{store->writes};
+  EXPECT_GT(writes, 1);
+  EXPECT_OUTCOME_EQ(amt.flush(), root1);
+  EXPECT_EQ(store->writes, writes);
+
+  EXPECT_OUTCOME_TRUE_1(amt.set(3, Value{"02"_unhex}));
+  EXPECT_OUTCOME_TRUE_1(expected.set(3, Value{"02"_unhex}));
+  EXPECT_OUTCOME_TRUE(root2, amt.flush());
+  EXPECT_NE(root2, root1);
+  // root and one node for each of 3 levels below
+  EXPECT_EQ(store->writes - writes, 4);
+  EXPECT_OUTCOME_EQ(expected.flush(), root2);
+  EXPECT_OUTCOME_EQ(Amt(store, root2).get(3), Value{"02"_unhex});
+}
+
+/**
+ * @given values for keys from 0
+ * @when amt is built from values at once
+ * @then root equals root of amt built by set, values are readable
+ */
+TEST_F(AmtTest, FromValues) {
+  for (uint64_t n : {0, 1, 8, 9, 64, 65, 1000}) {
+    std::vector<Value> values;
+    Amt expected{store};
+    for (uint64_t i = 0; i < n; ++i) {
+      values.push_back(encode(i).value());
+      EXPECT_OUTCOME_TRUE_1(expected.set(i, values.back()));
+    }
+    EXPECT_OUTCOME_TRUE(built, Amt::fromValues(store, values));
+    EXPECT_OUTCOME_TRUE(root, expected.flush());
+    EXPECT_EQ(built.cid(), root);
+    EXPECT_OUTCOME_EQ(Amt(store, root).count(), n);
+    if (n != 0) {
+      EXPECT_OUTCOME_EQ(built.get(n - 1), values.back());
+    }
+  }
+}
+
+/**
+ * @given amt and its copy with modified, removed and added keys, added key
+ * grows height
+ * @when diff is applied
+ * @then only changed keys are visited in key order
+ */
+TEST_F(AmtTest, Diff) {
+  Amt from{store};
+  for (uint64_t i = 0; i < 1000; ++i) {
+    EXPECT_OUTCOME_TRUE_1(from.set(i, encode(i).value()));
+  }
+  EXPECT_OUTCOME_TRUE(root, from.flush());
+  Amt to{store, root};
+  EXPECT_OUTCOME_TRUE_1(to.set(3, encode(-3).value()));
+  EXPECT_OUTCOME_TRUE_1(to.remove(500));
+  EXPECT_OUTCOME_TRUE_1(to.set(5000, encode(5000).value()));
+  EXPECT_OUTCOME_TRUE_1(to.flush());
+
+  using Change = std::tuple<uint64_t, bool, bool>;
+  std::vector<Change> changes;
+  auto visitor{[&](auto key, auto from, auto to) {
+    changes.emplace_back(key, from != nullptr, to != nullptr);
+    return fc::outcome::success();
+  }};
+  EXPECT_OUTCOME_TRUE_1(Amt(store, root).diff(to, visitor));
+  EXPECT_EQ(changes,
+            (std::vector<Change>{
+                {3, true, true}, {500, true, false}, {5000, false, true}}));
+
+  changes.clear();
+  EXPECT_OUTCOME_TRUE_1(to.diff(Amt{store, root}, visitor));
+  EXPECT_EQ(changes,
+            (std::vector<Change>{
+                {3, true, true}, {500, false, true}, {5000, true, false}}));
+
+  changes.clear();
+  EXPECT_OUTCOME_TRUE_1(to.diff(to, visitor));
+  EXPECT_TRUE(changes.empty());
+}
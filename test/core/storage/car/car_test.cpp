@@ -4,11 +4,15 @@
  */
 
 #include "storage/car/car.hpp"
+#include "storage/car/indexed_car.hpp"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <sstream>
 
+#include "common/span.hpp"
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "storage/unixfs/unixfs.hpp"
 #include "testutil/literals.hpp"
@@ -18,6 +22,8 @@
 
 using fc::CID;
 using fc::storage::car::CarError;
+using fc::storage::car::IndexedCar;
+using fc::storage::car::indexPath;
 using fc::storage::car::loadCar;
 using fc::storage::car::makeCar;
 using fc::storage::car::makeSelectiveCar;
@@ -148,3 +154,97 @@ TEST(SelectiveCar, MakeSelectiveCarToFile) {
                                          << "expected" << std::endl
                                          << expected_car << std::endl;
 }
+
+/**
+ * @given dag sharing blocks with another dag
+ * @when make selective car to stream for both dags
+ * @then stream has same bytes as in-memory car, shared blocks written once
+ */
+TEST(SelectiveCar, MakeSelectiveCarToStream) {
+  InMemoryDatastore ipld;
+  Sample2 obj2{2};
+  EXPECT_OUTCOME_TRUE(cid2, ipld.setCbor(obj2));
+  Sample1 obj1{{cid2}, {}};
+  EXPECT_OUTCOME_TRUE(root, ipld.setCbor(obj1));
+  EXPECT_OUTCOME_TRUE(expected,
+                      makeSelectiveCar(ipld, {{root, {}}, {cid2, {}}}));
+
+  std::stringstream output;
+  EXPECT_OUTCOME_TRUE_1(
+      makeSelectiveCar(ipld, {{root, {}}, {cid2, {}}}, output));
+  EXPECT_EQ(output.str(), fc::common::span::bytestr(expected));
+}
+
+/**
+ * @given correct car file
+ * @when loadCar with verification on pool
+ * @then same blocks as sequential load
+ */
+TEST(CarTest, LoadParallel) {
+  InMemoryDatastore ipld1, ipld2;
+  auto input = readFile(resourcePath("genesis.car"));
+  boost::asio::thread_pool pool{4};
+  EXPECT_OUTCOME_TRUE(roots1, loadCar(ipld1, input));
+  EXPECT_OUTCOME_TRUE(roots2, loadCar(ipld2, input, pool));
+  EXPECT_EQ(roots1, roots2);
+  EXPECT_OUTCOME_TRUE(raw, ipld1.get(roots1[0]));
+  EXPECT_OUTCOME_EQ(ipld2.get(roots1[0]), raw);
+}
+
+/**
+ * @given car with block bytes not matching its CID
+ * @when loadCar
+ * @then hash mismatch error
+ */
+TEST(CarTest, LoadHashMismatch) {
+  InMemoryDatastore ipld1;
+  Sample2 obj{2};
+  EXPECT_OUTCOME_TRUE(cid, ipld1.setCbor(obj));
+  EXPECT_OUTCOME_TRUE(car, makeCar(ipld1, {cid}));
+  car[car.size() - 1] ^= 1;
+
+  InMemoryDatastore ipld2;
+  boost::asio::thread_pool pool{2};
+  EXPECT_OUTCOME_ERROR(CarError::kHashMismatch, loadCar(ipld2, car));
+  EXPECT_OUTCOME_ERROR(CarError::kHashMismatch, loadCar(ipld2, car, pool));
+}
+
+/**
+ * @given car file with shared block and padding, without index
+ * @when open it as indexed car, then again with stale index
+ * @then index is written, blocks are found, missing block and writes fail
+ */
+TEST(CarTest, IndexedCar) {
+  InMemoryDatastore ipld;
+  Sample2 obj2{2}, obj3{3};
+  EXPECT_OUTCOME_TRUE(cid2, ipld.setCbor(obj2));
+  EXPECT_OUTCOME_TRUE(cid3, ipld.setCbor(obj3));
+  Sample1 obj1{{cid2}, {{"a", cid3}}};
+  EXPECT_OUTCOME_TRUE(root, ipld.setCbor(obj1));
+  auto car_path{(fs::temp_directory_path() / fs::unique_path()).string()};
+  EXPECT_OUTCOME_TRUE_1(
+      makeSelectiveCar(ipld, {{root, {}}, {cid2, {}}}, car_path));
+  fs::resize_file(car_path, fs::file_size(car_path) + 127);
+
+  for (auto reopen : {false, true}) {
+    EXPECT_OUTCOME_TRUE(car, IndexedCar::open(car_path));
+    EXPECT_TRUE(fs::exists(indexPath(car_path)));
+    EXPECT_THAT(car->roots(), testing::ElementsAre(root, cid2));
+    EXPECT_EQ(car->size(), 3);
+    for (auto &cid : {root, cid2, cid3}) {
+      EXPECT_OUTCOME_TRUE(raw, ipld.get(cid));
+      EXPECT_OUTCOME_EQ(car->get(cid), raw);
+    }
+    EXPECT_OUTCOME_TRUE(other, ipld.setCbor(Sample2{4}));
+    EXPECT_OUTCOME_EQ(car->contains(other), false);
+    EXPECT_OUTCOME_ERROR(fc::storage::ipfs::IpfsDatastoreError::kNotFound,
+                         car->get(other));
+    EXPECT_OUTCOME_ERROR(CarError::kReadOnly, car->remove(root));
+    if (!reopen) {
+      // index of other car size is rewritten
+      fs::resize_file(car_path, fs::file_size(car_path) + 1);
+    }
+  }
+  fs::remove(car_path);
+  fs::remove(indexPath(car_path));
+}
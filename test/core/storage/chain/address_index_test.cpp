@@ -0,0 +1,97 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/chain/address_index.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+#include "vm/message/message.hpp"
+
+using fc::primitives::block::BlockHeader;
+using fc::primitives::block::MsgMeta;
+using fc::storage::blockchain::AddressIndex;
+using fc::storage::blockchain::HeadChangeType;
+using fc::storage::blockchain::TipsetCPtr;
+using fc::storage::ipfs::InMemoryDatastore;
+using fc::vm::message::UnsignedMessage;
+using Address = fc::primitives::address::Address;
+using Tipset = fc::primitives::tipset::Tipset;
+
+struct AddressIndexTest : ::testing::Test {
+  /// Make tipset with bls messages from `from` to every of `to`
+  TipsetCPtr make(const TipsetCPtr &parent,
+                  uint64_t height,
+                  const std::vector<Address> &to) {
+    MsgMeta meta;
+    ipld->load(meta);
+    for (auto &address : to) {
+      UnsignedMessage message;
+      message.from = from;
+      message.to = address;
+      message.nonce = nonce++;
+      EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(message));
+      cids.push_back(cid);
+      EXPECT_OUTCOME_TRUE_1(meta.bls_messages.append(cid));
+    }
+    EXPECT_OUTCOME_TRUE(meta_cid, ipld->setCbor(meta));
+    BlockHeader block;
+    block.ticket.emplace();
+    block.height = height;
+    block.messages = meta_cid;
+    if (parent) {
+      block.parents = parent->key.cids();
+    }
+    EXPECT_OUTCOME_TRUE_1(ipld->setCbor(block));
+    EXPECT_OUTCOME_TRUE(ts, Tipset::create({block}));
+    return ts;
+  }
+
+  std::vector<fc::CID> list(const Address &address,
+                            fc::primitives::ChainEpoch min,
+                            fc::primitives::ChainEpoch max) {
+    EXPECT_OUTCOME_TRUE(messages, index.list(address, min, max));
+    std::vector<fc::CID> result;
+    for (auto &message : messages) {
+      result.push_back(message.cid);
+    }
+    return result;
+  }
+
+  std::shared_ptr<InMemoryDatastore> ipld{
+      std::make_shared<InMemoryDatastore>()};
+  AddressIndex index{ipld};
+  Address from{Address::makeFromId(100)};
+  Address a{Address::makeFromId(1)};
+  Address b{Address::makeFromId(2)};
+  uint64_t nonce{};
+  std::vector<fc::CID> cids;
+};
+
+/**
+ * @given chain with messages from one address to others
+ * @when chain is indexed, then top tipset is reverted
+ * @then messages are listed by sender and receiver in epoch range, reverted
+ * messages are removed
+ */
+TEST_F(AddressIndexTest, ListRevert) {
+  auto ts0{make(nullptr, 0, {})};
+  auto ts1{make(ts0, 1, {a, b})};
+  auto ts2{make(ts1, 2, {a})};
+  EXPECT_OUTCOME_TRUE_1(index.onHeadChange({HeadChangeType::CURRENT, ts2}));
+  EXPECT_TRUE(index.indexed(ts0->key));
+  EXPECT_TRUE(index.indexed(ts2->key));
+
+  EXPECT_EQ(list(from, 0, 2), cids);
+  EXPECT_EQ(list(from, 2, 2), std::vector<fc::CID>{cids[2]});
+  EXPECT_EQ(list(a, 0, 2), (std::vector<fc::CID>{cids[0], cids[2]}));
+  EXPECT_EQ(list(b, 2, 5), std::vector<fc::CID>{});
+
+  EXPECT_OUTCOME_TRUE_1(index.onHeadChange({HeadChangeType::REVERT, ts2}));
+  EXPECT_FALSE(index.indexed(ts2->key));
+  EXPECT_EQ(list(a, 0, 2), std::vector<fc::CID>{cids[0]});
+  EXPECT_EQ(list(from, 0, 2), (std::vector<fc::CID>{cids[0], cids[1]}));
+}
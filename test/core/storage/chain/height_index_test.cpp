@@ -0,0 +1,90 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/chain/height_index.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/in_memory/in_memory_storage.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::primitives::block::BlockHeader;
+using fc::storage::InMemoryStorage;
+using fc::storage::blockchain::HeadChange;
+using fc::storage::blockchain::HeadChangeType;
+using fc::storage::blockchain::HeightIndex;
+using fc::storage::blockchain::Tipset;
+using fc::storage::blockchain::TipsetCPtr;
+using fc::storage::ipfs::InMemoryDatastore;
+
+struct HeightIndexTest : ::testing::Test {
+  TipsetCPtr make(const TipsetCPtr &parent, uint64_t height) {
+    BlockHeader block;
+    block.ticket.emplace();
+    block.height = height;
+    // distinct fork tipsets at same height
+    block.timestamp = ++unique;
+    if (parent) {
+      block.parents = parent->key.cids();
+    }
+    EXPECT_OUTCOME_TRUE_1(ipld->setCbor(block));
+    EXPECT_OUTCOME_TRUE(ts, Tipset::create({block}));
+    return ts;
+  }
+
+  fc::TipsetKey get(const TipsetCPtr &head, uint64_t height) {
+    EXPECT_OUTCOME_TRUE(ts, index.get(head, height));
+    return ts->key;
+  }
+
+  void apply(HeadChangeType type, const TipsetCPtr &ts) {
+    EXPECT_OUTCOME_TRUE_1(index.onHeadChange({type, ts}));
+  }
+
+  std::shared_ptr<InMemoryDatastore> ipld{
+      std::make_shared<InMemoryDatastore>()};
+  HeightIndex index{ipld, std::make_shared<InMemoryStorage>()};
+  uint64_t unique{};
+};
+
+/**
+ * @given canonical chain with null round and fork reverted from it
+ * @when tipsets are looked up by height from canonical and fork heads
+ * @then tipsets of corresponding chain are returned, null round resolves to
+ * next tipset
+ */
+TEST_F(HeightIndexTest, CanonicalAndFork) {
+  auto ts0{make(nullptr, 0)};
+  auto ts1{make(ts0, 1)};
+  auto ts2{make(ts1, 2)};
+  auto ts4{make(ts2, 4)};
+  apply(HeadChangeType::CURRENT, ts4);
+
+  EXPECT_EQ(get(ts4, 1), ts1->key);
+  EXPECT_EQ(get(ts4, 3), ts4->key);
+  EXPECT_EQ(get(ts4, 0), ts0->key);
+  EXPECT_OUTCOME_ERROR(
+      fc::storage::blockchain::ChainStoreError::kNoTipsetAtHeight,
+      index.get(ts4, 5));
+
+  // reorg to heavier chain from ts1
+  auto fork2{make(ts1, 2)};
+  auto fork3{make(fork2, 3)};
+  apply(HeadChangeType::REVERT, ts4);
+  apply(HeadChangeType::REVERT, ts2);
+  apply(HeadChangeType::APPLY, fork2);
+  apply(HeadChangeType::APPLY, fork3);
+
+  EXPECT_EQ(get(fork3, 2), fork2->key);
+  EXPECT_EQ(get(fork3, 1), ts1->key);
+  EXPECT_OUTCOME_TRUE(fork, index.forkPoint(ts4->key));
+  ASSERT_TRUE(fork);
+  EXPECT_EQ(*fork, ts1->key);
+
+  // old head is not canonical, lookup jumps over fork point
+  EXPECT_EQ(get(ts4, 2), ts2->key);
+  EXPECT_EQ(get(ts4, 0), ts0->key);
+}
@@ -0,0 +1,81 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/chain/msg_waiter.hpp"
+
+#include <gtest/gtest.h>
+
+#include "adt/array.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+#include "vm/message/message.hpp"
+
+using fc::adt::Array;
+using fc::primitives::block::BlockHeader;
+using fc::primitives::block::MsgMeta;
+using fc::storage::InMemoryStorage;
+using fc::storage::blockchain::HeadChangeType;
+using fc::storage::blockchain::MessageReceipt;
+using fc::storage::blockchain::MsgWaiter;
+using fc::storage::ipfs::InMemoryDatastore;
+using fc::vm::message::UnsignedMessage;
+using Tipset = fc::primitives::tipset::Tipset;
+
+/**
+ * @given tipset with message and child tipset with its receipt
+ * @when child is applied and reverted
+ * @then message is found in persistent index after apply, waiter is called,
+ * index survives waiter restart, message is removed after revert
+ */
+TEST(MsgWaiterTest, ApplyRevert) {
+  auto ipld{std::make_shared<InMemoryDatastore>()};
+  auto store{std::make_shared<InMemoryStorage>()};
+
+  UnsignedMessage message;
+  message.nonce = 1;
+  EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(message));
+  MsgMeta meta;
+  ipld->load(meta);
+  EXPECT_OUTCOME_TRUE_1(meta.bls_messages.append(cid));
+  EXPECT_OUTCOME_TRUE(meta_cid, ipld->setCbor(meta));
+  BlockHeader parent;
+  parent.ticket.emplace();
+  parent.height = 1;
+  parent.messages = meta_cid;
+  EXPECT_OUTCOME_TRUE_1(ipld->setCbor(parent));
+  EXPECT_OUTCOME_TRUE(parent_ts, Tipset::create({parent}));
+
+  MessageReceipt receipt{{}, {}, 7};
+  Array<MessageReceipt> receipts{ipld};
+  EXPECT_OUTCOME_TRUE_1(receipts.append(receipt));
+  BlockHeader child;
+  child.ticket.emplace();
+  child.height = 2;
+  child.parents = parent_ts->key.cids();
+  EXPECT_OUTCOME_TRUE(receipts_cid, receipts.amt.flush());
+  child.parent_message_receipts = receipts_cid;
+  EXPECT_OUTCOME_TRUE_1(ipld->setCbor(child));
+  EXPECT_OUTCOME_TRUE(child_ts, Tipset::create({child}));
+
+  MsgWaiter waiter{ipld, store};
+  auto called{false};
+  waiter.wait(cid, [&](auto &result) {
+    called = true;
+    EXPECT_EQ(result.first.gas_used, 7);
+    EXPECT_EQ(result.second, child_ts->key);
+  });
+  EXPECT_OUTCOME_TRUE_1(waiter.onHeadChange({HeadChangeType::APPLY, child_ts}));
+  EXPECT_TRUE(called);
+
+  MsgWaiter restarted{ipld, store};
+  EXPECT_OUTCOME_TRUE(found, restarted.search(cid));
+  ASSERT_TRUE(found);
+  EXPECT_EQ(found->second, child_ts->key);
+
+  EXPECT_OUTCOME_TRUE_1(
+      restarted.onHeadChange({HeadChangeType::REVERT, child_ts}));
+  EXPECT_OUTCOME_TRUE(reverted, restarted.search(cid));
+  EXPECT_FALSE(reverted);
+}
@@ -0,0 +1,80 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/chain/snapshot.hpp"
+
+#include <gtest/gtest.h>
+#include <fstream>
+
+#include "storage/in_memory/in_memory_storage.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+using fc::CID;
+using fc::primitives::block::BlockHeader;
+using fc::storage::InMemoryStorage;
+using fc::storage::blockchain::exportSnapshot;
+using fc::storage::blockchain::HeightIndex;
+using fc::storage::blockchain::importSnapshot;
+using fc::storage::blockchain::Tipset;
+using fc::storage::blockchain::TipsetCPtr;
+using fc::storage::ipfs::InMemoryDatastore;
+
+struct SnapshotTest : public test::BaseFS_Test {
+  SnapshotTest() : test::BaseFS_Test{"fc_snapshot_test"} {}
+
+  TipsetCPtr make(const TipsetCPtr &parent, uint64_t height) {
+    BlockHeader block;
+    block.ticket.emplace();
+    block.height = height;
+    if (parent) {
+      block.parents = parent->key.cids();
+    }
+    EXPECT_OUTCOME_TRUE(leaf, ipld->setCbor(height));
+    EXPECT_OUTCOME_TRUE(state, ipld->setCbor(std::vector<CID>{leaf}));
+    // shared by all states
+    EXPECT_OUTCOME_TRUE(empty, ipld->setCbor(std::vector<CID>{}));
+    block.parent_state_root = state;
+    block.messages = empty;
+    block.parent_message_receipts = empty;
+    EXPECT_OUTCOME_TRUE_1(ipld->setCbor(block));
+    EXPECT_OUTCOME_TRUE(ts, Tipset::create({block}));
+    return ts;
+  }
+
+  std::shared_ptr<InMemoryDatastore> ipld{
+      std::make_shared<InMemoryDatastore>()};
+};
+
+/**
+ * @given chain of three tipsets
+ * @when snapshot with state of head only is exported and imported to empty
+ * store
+ * @then all headers and head state are imported, older states are not,
+ * heights are indexed
+ */
+TEST_F(SnapshotTest, ExportImport) {
+  auto ts0{make(nullptr, 0)};
+  auto ts1{make(ts0, 1)};
+  auto ts2{make(ts1, 2)};
+  auto path{(base_path / "snapshot.car").string()};
+  {
+    std::ofstream output{path, std::ios::binary};
+    EXPECT_OUTCOME_TRUE_1(exportSnapshot(*ipld, ts2, 1, output));
+  }
+
+  auto imported{std::make_shared<InMemoryDatastore>()};
+  HeightIndex index{imported, std::make_shared<InMemoryStorage>()};
+  EXPECT_OUTCOME_TRUE(head, importSnapshot(*imported, path, index));
+  EXPECT_EQ(head->key, ts2->key);
+  EXPECT_OUTCOME_EQ(imported->contains(ts0->key.cids()[0]), true);
+  EXPECT_OUTCOME_EQ(imported->contains(ts2->getParentStateRoot()), true);
+  EXPECT_OUTCOME_EQ(imported->contains(ts1->getParentStateRoot()), false);
+  EXPECT_OUTCOME_TRUE(key0, index.canonical(0));
+  EXPECT_OUTCOME_TRUE(key1, index.canonical(1));
+  EXPECT_TRUE(key0 == ts0->key);
+  EXPECT_TRUE(key1 == ts1->key);
+}
@@ -270,3 +270,32 @@ TEST_F(FileSystemFileTest, ReadFileFrom) {
   ASSERT_EQ(read_size, read_res);
   ASSERT_TRUE(memcmp(expected, data_read.data(), read_size) == 0);
 }
+
+/**
+ * @given file opened with direct io and cache dropping
+ * @when unaligned data spanning several blocks is written
+ * @then same data is read back and file size matches
+ */
+TEST_F(FileSystemFileTest, WriteDirect) {
+  FileSystemFile::Options options;
+  options.direct_io = true;
+  options.drop_cache = true;
+  options.buffer_size = 8192;
+  FileSystemFile file{empty_file_path, options};
+  EXPECT_OUTCOME_TRUE_1(file.open());
+  EXPECT_OUTCOME_TRUE_1(file.preallocate(1 << 16));
+  EXPECT_OUTCOME_EQ(file.size(), 0);
+
+  std::vector<uint8_t> data(5 * 4096 + 123);
+  for (size_t i{0}; i < data.size(); ++i) {
+    data[i] = i * 7;
+  }
+  size_t start{100};
+  EXPECT_OUTCOME_EQ(file.write(start, data), data.size());
+  EXPECT_OUTCOME_EQ(file.size(), start + data.size());
+
+  std::vector<uint8_t> read(data.size());
+  EXPECT_OUTCOME_EQ(file.read(start, read), data.size());
+  EXPECT_EQ(read, data);
+  EXPECT_OUTCOME_TRUE_1(file.close());
+}
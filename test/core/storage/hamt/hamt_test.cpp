@@ -6,8 +6,10 @@
 #include "storage/hamt/hamt.hpp"
 
 #include <gtest/gtest.h>
+#include <boost/asio/thread_pool.hpp>
 #include "codec/cbor/cbor.hpp"
 #include "common/which.hpp"
+#include "storage/hamt/node_cache.hpp"
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "testutil/cbor.hpp"
 
@@ -16,11 +18,12 @@ using fc::common::which;
 using fc::storage::hamt::Hamt;
 using fc::storage::hamt::HamtError;
 using fc::storage::hamt::Node;
+using fc::storage::hamt::NodeCache;
 
 class HamtTest : public ::testing::Test {
  public:
   decltype(auto) minItem(const Node &node) {
-    return node.items.begin()->second;
+    return node.items.front();
   }
 
   template <typename T>
@@ -39,21 +42,43 @@ TEST_F(HamtTest, NodeCbor) {
   Node n;
   expectEncodeAndReencode(n, "824080"_unhex);
 
-  n.items[17] = "010000020000"_cid;
+  n.set(17, "010000020000"_cid);
   expectEncodeAndReencode(n, "824302000081a16130d82a4700010000020000"_unhex);
 
-  n.items[17] =
-      Node::Leaf{{"a", fc::storage::hamt::Value(encode("b").value())}};
+  n.set(17, Node::Leaf{{"a", fc::storage::hamt::Value(encode("b").value())}});
   expectEncodeAndReencode(n, "824302000081a16131818241616162"_unhex);
 
-  n.items[2] = Node::Leaf{{"b", fc::storage::hamt::Value(encode("a").value())}};
+  n.set(2, Node::Leaf{{"b", fc::storage::hamt::Value(encode("a").value())}});
   expectEncodeAndReencode(
       n, "824302000482a16131818241626161a16131818241616162"_unhex);
 
-  n.items[17] = Node::Ptr{};
+  n.set(17, Node::Ptr{});
   EXPECT_OUTCOME_ERROR(HamtError::kExpectedCID, encode(n));
 }
 
+/** Bitfield of slots beyond 64 is encoded as big-endian bytes */
+TEST_F(HamtTest, NodeCborHighIndex) {
+  Node n;
+  n.set(255, "010000020000"_cid);
+  n.set(1, "010000020000"_cid);
+  EXPECT_EQ(n.bits.rank(255), 1);
+  expectEncodeAndReencode(
+      n,
+      "825820800000000000000000000000000000000000000000000000000000000000000282a16130d82a4700010000020000a16130d82a4700010000020000"_unhex);
+}
+
+/** Leaf keeps keys sorted */
+TEST_F(HamtTest, LeafSorted) {
+  Node::Leaf leaf{{"b", "01"_unhex}, {"a", "02"_unhex}};
+  leaf.set("c", "03"_unhex);
+  EXPECT_EQ(leaf.size(), 3);
+  EXPECT_EQ(leaf.begin()->first, "a");
+  EXPECT_EQ(*leaf.find("b"), "01"_unhex);
+  EXPECT_TRUE(leaf.erase("a"));
+  EXPECT_FALSE(leaf.erase("a"));
+  EXPECT_EQ(leaf.find("a"), nullptr);
+}
+
 /** Set-remove single element */
 TEST_F(HamtTest, SetRemoveOne) {
   EXPECT_OUTCOME_ERROR(HamtError::kNotFound, hamt_.get("aai"));
@@ -151,3 +176,182 @@ TEST_F(HamtTest, Contains) {
   EXPECT_OUTCOME_TRUE_1(hamt_.set("element", "01"_unhex));
   EXPECT_OUTCOME_EQ(hamt_.contains("element"), true);
 }
+
+/**
+ * @given flushed hamt with node cache
+ * @when load same root from another hamt sharing cache
+ * @then nodes are served from cache without datastore reads
+ */
+TEST_F(HamtTest, NodeCache) {
+  auto cache{std::make_shared<NodeCache>()};
+  hamt_.cache = cache;
+  for (auto i = 0; i < 100; ++i) {
+    EXPECT_OUTCOME_TRUE_1(hamt_.set(std::to_string(i), "01"_unhex));
+  }
+  EXPECT_OUTCOME_TRUE(root, hamt_.flush());
+  EXPECT_GT(cache->stats().size, 0);
+  EXPECT_EQ(cache->stats().hits, 0);
+
+  Hamt hamt2{std::make_shared<fc::storage::ipfs::InMemoryDatastore>(), root, 8};
+  hamt2.cache = cache;
+  for (auto i = 0; i < 100; ++i) {
+    EXPECT_OUTCOME_EQ(hamt2.get(std::to_string(i)), "01"_unhex);
+  }
+  EXPECT_GT(cache->stats().hits, 0);
+  EXPECT_EQ(cache->stats().misses, 0);
+}
+
+/**
+ * @given hamt values set in one batch, enough to create shards
+ * @when get them in one batch
+ * @then values match single element operations, missing keys are none
+ */
+TEST_F(HamtTest, GetSetMany) {
+  std::vector<std::pair<std::string, fc::storage::hamt::Value>> pairs;
+  for (auto i = 0; i < 100; ++i) {
+    pairs.emplace_back(std::to_string(i), encode(i).value());
+  }
+  EXPECT_OUTCOME_TRUE_1(hamt_.setMany(pairs));
+  for (auto &pair : pairs) {
+    EXPECT_OUTCOME_EQ(hamt_.get(pair.first), pair.second);
+  }
+
+  EXPECT_OUTCOME_TRUE(root, hamt_.flush());
+  Hamt hamt2{store_, root, 8};
+  std::vector<std::string> keys{"5", "missing", "99"};
+  EXPECT_OUTCOME_TRUE(values, hamt2.getMany(keys));
+  ASSERT_EQ(values.size(), 3);
+  EXPECT_EQ(*values[0], pairs[5].second);
+  EXPECT_FALSE(values[1]);
+  EXPECT_EQ(*values[2], pairs[99].second);
+}
+
+/**
+ * @given flushed hamt with shards
+ * @when visit with prefetch and in parallel
+ * @then prefetch visits in same order as visit, parallel visits same pairs
+ */
+TEST_F(HamtTest, VisitPrefetchParallel) {
+  for (auto i = 0; i < 300; ++i) {
+    EXPECT_OUTCOME_TRUE_1(hamt_.set(std::to_string(i), encode(i).value()));
+  }
+  EXPECT_OUTCOME_TRUE(root, hamt_.flush());
+  auto collect{[&](auto &keys) {
+    return [&](auto &key, auto &) {
+      keys.push_back(key);
+      return fc::outcome::success();
+    };
+  }};
+  std::vector<std::string> expected, prefetched, parallel;
+  EXPECT_OUTCOME_TRUE_1(Hamt(store_, root, 8).visit(collect(expected)));
+  EXPECT_EQ(expected.size(), 300);
+
+  boost::asio::thread_pool pool{4};
+  EXPECT_OUTCOME_TRUE_1(
+      Hamt(store_, root, 8).visitPrefetch(collect(prefetched), pool, 4));
+  EXPECT_EQ(prefetched, expected);
+
+  std::mutex mutex;
+  EXPECT_OUTCOME_TRUE_1(Hamt(store_, root, 8).visitParallel(
+      [&](auto &key, auto &) {
+        std::lock_guard lock{mutex};
+        parallel.push_back(key);
+        return fc::outcome::success();
+      },
+      pool));
+  std::sort(parallel.begin(), parallel.end());
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(parallel, expected);
+}
+
+/// Counts writes to check which nodes are flushed
+struct CountingDatastore : fc::storage::ipfs::InMemoryDatastore {
+  fc::outcome::result<void> set(const fc::CID &key, Value value) override {
+    ++writes;
+    return InMemoryDatastore::set(key, std::move(value));
+  }
+
+  size_t writes{};
+};
+
+/**
+ * @given flushed hamt with shards
+ * @when flush again unchanged, then flush after one change
+ * @then unchanged flush writes nothing, changed flush writes only modified
+ * path and root equals root of hamt built from scratch
+ */
+TEST_F(HamtTest, IncrementalFlush) {
+  auto store{std::make_shared<CountingDatastore>()};
+  Hamt hamt{store, 8};
+  Hamt expected{std::make_shared<fc::storage::ipfs::InMemoryDatastore>(), 8};
+  for (auto i = 0; i < 300; ++i) {
+    EXPECT_OUTCOME_TRUE_1(hamt.set(std::to_string(i), encode(i).value()));
+    EXPECT_OUTCOME_TRUE_1(expected.set(std::to_string(i), encode(i).value()));
+  }
+  EXPECT_OUTCOME_TRUE(root1, hamt.flush());
+  auto writes{store->writes};
+  EXPECT_GT(writes, 1);
+  EXPECT_OUTCOME_EQ(hamt.flush(), root1);
+  EXPECT_EQ(store->writes, writes);
+
+  EXPECT_OUTCOME_TRUE_1(hamt.set("1", encode(-1).value()));
+  EXPECT_OUTCOME_TRUE_1(expected.set("1", encode(-1).value()));
+  EXPECT_OUTCOME_TRUE(root2, hamt.flush());
+  EXPECT_NE(root2, root1);
+  EXPECT_LT(store->writes - writes, writes);
+  EXPECT_OUTCOME_EQ(expected.flush(), root2);
+  EXPECT_OUTCOME_EQ(Hamt(store, root2, 8).get("1"), encode(-1).value());
+}
+
+/**
+ * @given pairs with unique keys
+ * @when hamt is built from pairs at once
+ * @then root equals root of hamt built by set
+ */
+TEST_F(HamtTest, FromPairs) {
+  for (auto n : {0, 1, 3, 4, 300}) {
+    std::vector<std::pair<std::string, fc::storage::hamt::Value>> pairs;
+    Hamt expected{store_, 5};
+    for (auto i = 0; i < n; ++i) {
+      pairs.emplace_back(std::to_string(i), encode(i).value());
+      EXPECT_OUTCOME_TRUE_1(expected.set(pairs.back().first,
+                                         pairs.back().second));
+    }
+    EXPECT_OUTCOME_TRUE(built, Hamt::fromPairs(store_, pairs, 5));
+    EXPECT_OUTCOME_EQ(expected.flush(), built.cid());
+    if (n != 0) {
+      EXPECT_OUTCOME_EQ(built.get("0"), encode(0).value());
+    }
+  }
+}
+
+/**
+ * @given hamt and its copy with modified, removed and added keys
+ * @when diff is applied
+ * @then only changed keys are visited
+ */
+TEST_F(HamtTest, Diff) {
+  Hamt from{store_, 5};
+  for (auto i = 0; i < 300; ++i) {
+    EXPECT_OUTCOME_TRUE_1(from.set(std::to_string(i), encode(i).value()));
+  }
+  EXPECT_OUTCOME_TRUE(root, from.flush());
+  Hamt to{store_, root, 5};
+  EXPECT_OUTCOME_TRUE_1(to.set("3", encode(-3).value()));
+  EXPECT_OUTCOME_TRUE_1(to.remove("200"));
+  EXPECT_OUTCOME_TRUE_1(to.set("new", encode(0).value()));
+  EXPECT_OUTCOME_TRUE_1(to.flush());
+
+  std::map<std::string, std::pair<bool, bool>> changes;
+  EXPECT_OUTCOME_TRUE_1(Hamt(store_, root, 5).diff(
+      to, [&](auto &key, auto from, auto to) {
+        changes.emplace(key, std::make_pair(from != nullptr, to != nullptr));
+        return fc::outcome::success();
+      }));
+  EXPECT_EQ(changes,
+            (std::map<std::string, std::pair<bool, bool>>{
+                {"3", {true, true}},
+                {"200", {true, false}},
+                {"new", {false, true}},
+            }));
+}
@@ -0,0 +1,67 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/batch_datastore.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/cbor.hpp"
+
+using fc::common::Buffer;
+using fc::storage::ipfs::BatchDatastore;
+using fc::storage::ipfs::InMemoryDatastore;
+
+/// Counts setMany calls to check that batch is written at once
+struct CountingDatastore : InMemoryDatastore {
+  fc::outcome::result<void> setMany(Batch batch) override {
+    ++writes;
+    return InMemoryDatastore::setMany(std::move(batch));
+  }
+
+  size_t writes{};
+};
+
+class BatchDatastoreTest : public ::testing::Test {
+ public:
+  fc::CID cid1{"010000020000"_cid};
+  fc::CID cid2{"010000020001"_cid};
+  Buffer value{"0123"_unhex};
+
+  std::shared_ptr<CountingDatastore> store{
+      std::make_shared<CountingDatastore>()};
+  std::shared_ptr<BatchDatastore> batch{
+      std::make_shared<BatchDatastore>(store)};
+};
+
+/**
+ * @given batch over datastore
+ * @when set values
+ * @then values are visible through batch, but not in datastore
+ */
+TEST_F(BatchDatastoreTest, PendingVisible) {
+  EXPECT_OUTCOME_TRUE_1(batch->set(cid1, value));
+  EXPECT_OUTCOME_EQ(batch->contains(cid1), true);
+  EXPECT_OUTCOME_EQ(batch->get(cid1), value);
+  EXPECT_OUTCOME_EQ(store->contains(cid1), false);
+  EXPECT_OUTCOME_EQ(batch->contains(cid2), false);
+}
+
+/**
+ * @given batch with pending values
+ * @when commit
+ * @then values are written to datastore with one setMany
+ */
+TEST_F(BatchDatastoreTest, Commit) {
+  EXPECT_OUTCOME_TRUE_1(batch->set(cid1, value));
+  EXPECT_OUTCOME_TRUE_1(batch->set(cid2, value));
+  EXPECT_OUTCOME_TRUE_1(batch->commit());
+  EXPECT_EQ(store->writes, 1);
+  EXPECT_OUTCOME_EQ(store->get(cid1), value);
+  EXPECT_OUTCOME_EQ(store->get(cid2), value);
+
+  EXPECT_OUTCOME_TRUE_1(batch->commit());
+  EXPECT_EQ(store->writes, 1);
+}
@@ -0,0 +1,96 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/cached_datastore.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/cbor.hpp"
+
+using fc::common::Buffer;
+using fc::storage::ipfs::CachedDatastore;
+using fc::storage::ipfs::InMemoryDatastore;
+
+class CachedDatastoreTest : public ::testing::Test {
+ public:
+  fc::CID cid1{"010000020000"_cid};
+  fc::CID cid2{"010000020001"_cid};
+  Buffer value{"0123"_unhex};
+
+  std::shared_ptr<InMemoryDatastore> store{
+      std::make_shared<InMemoryDatastore>()};
+  // probation fits one value, protected fits three
+  std::shared_ptr<CachedDatastore> cached{
+      std::make_shared<CachedDatastore>(store, 8)};
+};
+
+/**
+ * @given cached datastore
+ * @when set value
+ * @then value is written through, next get is hit
+ */
+TEST_F(CachedDatastoreTest, WriteThrough) {
+  EXPECT_OUTCOME_TRUE_1(cached->set(cid1, value));
+  EXPECT_OUTCOME_EQ(store->get(cid1), value);
+  EXPECT_OUTCOME_EQ(cached->get(cid1), value);
+  EXPECT_EQ(cached->stats().hits, 1);
+  EXPECT_EQ(cached->stats().misses, 0);
+}
+
+/**
+ * @given value only in underlying datastore
+ * @when get twice
+ * @then first get is miss, second is hit
+ */
+TEST_F(CachedDatastoreTest, ReadThrough) {
+  EXPECT_OUTCOME_TRUE_1(store->set(cid1, value));
+  EXPECT_OUTCOME_EQ(cached->get(cid1), value);
+  EXPECT_OUTCOME_EQ(cached->get(cid1), value);
+  EXPECT_EQ(cached->stats().hits, 1);
+  EXPECT_EQ(cached->stats().misses, 1);
+}
+
+/**
+ * @given value read again, so promoted out of probation
+ * @when more values than memory tier fits are written once
+ * @then promoted value stays in memory
+ */
+TEST_F(CachedDatastoreTest, ScanResistant) {
+  EXPECT_OUTCOME_TRUE_1(cached->set(cid1, value));
+  EXPECT_OUTCOME_TRUE_1(cached->get(cid1));
+  for (uint8_t i = 0; i < 10; ++i) {
+    Buffer scanned{i, i};
+    EXPECT_OUTCOME_TRUE(cid, fc::common::getCidOf(scanned));
+    EXPECT_OUTCOME_TRUE_1(cached->set(cid, scanned));
+  }
+  EXPECT_OUTCOME_TRUE_1(store->remove(cid1));
+  EXPECT_OUTCOME_EQ(cached->get(cid1), value);
+}
+
+/**
+ * @given cached value
+ * @when remove
+ * @then value is removed from both tiers
+ */
+TEST_F(CachedDatastoreTest, Remove) {
+  EXPECT_OUTCOME_TRUE_1(cached->set(cid1, value));
+  EXPECT_OUTCOME_TRUE_1(cached->remove(cid1));
+  EXPECT_OUTCOME_EQ(cached->contains(cid1), false);
+  EXPECT_OUTCOME_EQ(store->contains(cid1), false);
+}
+
+/**
+ * @given cached value
+ * @when get shared value twice
+ * @then same buffer is returned without copy
+ */
+TEST_F(CachedDatastoreTest, GetShared) {
+  EXPECT_OUTCOME_TRUE_1(cached->set(cid1, value));
+  EXPECT_OUTCOME_TRUE(shared1, cached->getShared(cid1));
+  EXPECT_OUTCOME_TRUE(shared2, cached->getShared(cid1));
+  EXPECT_EQ(shared1.get(), shared2.get());
+  EXPECT_EQ(*shared1, value);
+}
@@ -136,6 +136,13 @@ TEST_F(DatastoreIntegrationTest, SetTwice) {
   EXPECT_OUTCOME_TRUE_1(datastore->set(cid1, value));
 }
 
+/** Values set in one batch are all stored */
+TEST_F(DatastoreIntegrationTest, SetMany) {
+  EXPECT_OUTCOME_TRUE_1(datastore->setMany({{cid1, value}, {cid2, value}}));
+  EXPECT_OUTCOME_EQ(datastore->get(cid1), value);
+  EXPECT_OUTCOME_EQ(datastore->get(cid2), value);
+}
+
 /**
  * @given opened datastore with some values stored
  * @when close datastore and open again
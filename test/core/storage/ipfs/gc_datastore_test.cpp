@@ -0,0 +1,76 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/gc_datastore.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+using fc::CID;
+using fc::storage::ipfs::GcDatastore;
+using fc::storage::ipfs::LeveldbDatastore;
+
+struct GcDatastoreTest : public test::BaseFS_Test {
+  GcDatastoreTest() : test::BaseFS_Test{"fc_gc_datastore_test"} {}
+
+  void SetUp() override {
+    BaseFS_Test::SetUp();
+    leveldb::Options options;
+    options.create_if_missing = true;
+    EXPECT_OUTCOME_TRUE(
+        _leveldb, LeveldbDatastore::create(getPathString(), options));
+    leveldb = _leveldb;
+    gc = std::make_shared<GcDatastore>(leveldb);
+  }
+
+  void TearDown() override {
+    gc.reset();
+    leveldb.reset();
+    BaseFS_Test::TearDown();
+  }
+
+  bool stored(const CID &cid) {
+    return leveldb->contains(cid).value();
+  }
+
+  std::shared_ptr<LeveldbDatastore> leveldb;
+  std::shared_ptr<GcDatastore> gc;
+};
+
+/**
+ * @given blocks reachable from deep root, shallow root with link, garbage
+ * @when cycle runs with write in the middle
+ * @then reachable, shallow root and written blocks are kept, others removed
+ */
+TEST_F(GcDatastoreTest, Cycle) {
+  EXPECT_OUTCOME_TRUE(leaf, gc->setCbor(1));
+  EXPECT_OUTCOME_TRUE(root, gc->setCbor(std::vector<CID>{leaf}));
+  EXPECT_OUTCOME_TRUE(garbage, gc->setCbor(2));
+  EXPECT_OUTCOME_TRUE(shallow_leaf, gc->setCbor(3));
+  EXPECT_OUTCOME_TRUE(shallow, gc->setCbor(std::vector<CID>{shallow_leaf}));
+
+  gc->startCycle({{root}, {shallow}});
+  EXPECT_OUTCOME_EQ(gc->step(1), false);
+  EXPECT_OUTCOME_TRUE(written, gc->setCbor(4));
+  while (!gc->step(1).value()) {
+  }
+
+  EXPECT_TRUE(stored(leaf));
+  EXPECT_TRUE(stored(root));
+  EXPECT_TRUE(stored(shallow));
+  EXPECT_TRUE(stored(written));
+  EXPECT_FALSE(stored(garbage));
+  EXPECT_FALSE(stored(shallow_leaf));
+  EXPECT_EQ(gc->stats().cycles, 1);
+  EXPECT_EQ(gc->stats().removed, 2);
+
+  // next cycle doesn't keep block written during previous one
+  gc->startCycle({{root}, {shallow}});
+  while (!gc->step().value()) {
+  }
+  EXPECT_FALSE(stored(written));
+}
@@ -38,11 +38,13 @@ struct CommonFeaturesTest : public testing::TestWithParam<DataSample> {
   // Sample data for current test case
   DataSample data;
 
+  std::shared_ptr<InMemoryDatastore> blockservice;
+
   /**
    * @brief Prepare test suite
    */
   void SetUp() override {
-    auto blockservice{std::make_shared<InMemoryDatastore>()};
+    blockservice = std::make_shared<InMemoryDatastore>();
     merkledag_service_ = std::make_shared<MerkleDagServiceImpl>(blockservice);
     data = GetParam();
     EXPECT_OUTCOME_TRUE_1(this->saveToBlockService(data.nodes));
@@ -213,6 +215,30 @@ TEST_P(CommonFeaturesTest, GraphSyncSelect) {
   ASSERT_EQ(nodes_count, selected_count);
 }
 
+/**
+ * @given Pre-generated nodes structure
+ * @when Walking graph with nodes prefetched on pool
+ * @then Fetched structure and selected nodes are same as sequential
+ */
+TEST_P(CommonFeaturesTest, ParallelFetchGraph) {
+  MerkleDagServiceImpl service{blockservice, 4, 2};
+  const auto &root_cid = data.nodes.front()->getCID();
+  EXPECT_OUTCOME_TRUE(root_leaf, service.fetchGraph(root_cid));
+  ASSERT_EQ(getGraphStructure(*root_leaf), data.graph_structure);
+
+  EXPECT_OUTCOME_TRUE(root_bytes, root_cid.toBytes());
+  EXPECT_OUTCOME_EQ(
+      service.select(root_bytes, {}, [](auto) { return true; }),
+      data.nodes.front()->getLinks().size() + 1);
+
+  size_t visited{};
+  EXPECT_OUTCOME_TRUE_1(
+      service.walkGraph(root_cid, boost::none, [&](auto &, auto, auto) {
+        return ++visited < 2;
+      }));
+  EXPECT_EQ(visited, data.nodes.front()->getLinks().empty() ? 1 : 2);
+}
+
 /**
  * Pre-generated nodes, CIDs and serialized graph structures
  * Reference CIDs was generated by https://github.com/ipfs/go-merkledag
@@ -0,0 +1,89 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/split_datastore.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+using fc::CID;
+using fc::storage::ipfs::InMemoryDatastore;
+using fc::storage::ipfs::PackStore;
+using fc::storage::ipfs::SplitDatastore;
+
+struct SplitDatastoreTest : public test::BaseFS_Test {
+  SplitDatastoreTest() : test::BaseFS_Test{"fc_split_datastore_test"} {}
+
+  void SetUp() override {
+    BaseFS_Test::SetUp();
+    EXPECT_OUTCOME_TRUE(_cold, PackStore::open(getPathString()));
+    cold = _cold;
+    hot = std::make_shared<InMemoryDatastore>();
+    split = std::make_shared<SplitDatastore>(hot, cold);
+  }
+
+  void TearDown() override {
+    split.reset();
+    cold.reset();
+    BaseFS_Test::TearDown();
+  }
+
+  std::shared_ptr<InMemoryDatastore> hot;
+  std::shared_ptr<PackStore> cold;
+  std::shared_ptr<SplitDatastore> split;
+};
+
+/**
+ * @given blocks reachable from deep root, shallow root with link
+ * @when migrating roots
+ * @then migrated blocks are removed from hot and read from cold, also after
+ * reopen, shallow link stays hot
+ */
+TEST_F(SplitDatastoreTest, Migrate) {
+  EXPECT_OUTCOME_TRUE(leaf, split->setCbor(1));
+  EXPECT_OUTCOME_TRUE(root, split->setCbor(std::vector<CID>{leaf}));
+  EXPECT_OUTCOME_TRUE(shallow_leaf, split->setCbor(2));
+  EXPECT_OUTCOME_TRUE(shallow,
+                      split->setCbor(std::vector<CID>{shallow_leaf}));
+
+  EXPECT_OUTCOME_EQ(split->migrate({{root}, {shallow}}), 3);
+  EXPECT_OUTCOME_EQ(hot->contains(leaf), false);
+  EXPECT_OUTCOME_EQ(hot->contains(root), false);
+  EXPECT_OUTCOME_EQ(hot->contains(shallow), false);
+  EXPECT_OUTCOME_EQ(hot->contains(shallow_leaf), true);
+  EXPECT_OUTCOME_EQ(split->getCbor<int>(leaf), 1);
+  EXPECT_OUTCOME_EQ(split->getCbor<std::vector<CID>>(root),
+                    std::vector<CID>{leaf});
+  EXPECT_OUTCOME_EQ(split->contains(shallow), true);
+
+  // cold blocks are not migrated again
+  EXPECT_OUTCOME_EQ(split->migrate({{root}, {}}), 0);
+
+  EXPECT_OUTCOME_TRUE(reopened, PackStore::open(getPathString()));
+  EXPECT_OUTCOME_TRUE(value, reopened->get(leaf));
+  EXPECT_TRUE(value);
+  EXPECT_OUTCOME_TRUE(missing, reopened->get(shallow_leaf));
+  EXPECT_FALSE(missing);
+}
+
+/**
+ * @given writer which wasn't committed
+ * @when it's destroyed
+ * @then its blocks are not visible
+ */
+TEST_F(SplitDatastoreTest, Uncommitted) {
+  EXPECT_OUTCOME_TRUE(cid, split->setCbor(1));
+  {
+    EXPECT_OUTCOME_TRUE(writer, cold->writer());
+    EXPECT_OUTCOME_TRUE(bytes, hot->get(cid));
+    EXPECT_OUTCOME_TRUE_1(writer->add(cid, bytes));
+  }
+  EXPECT_OUTCOME_EQ(cold->contains(cid), false);
+  EXPECT_OUTCOME_TRUE(reopened, PackStore::open(getPathString()));
+  EXPECT_OUTCOME_EQ(reopened->contains(cid), false);
+}
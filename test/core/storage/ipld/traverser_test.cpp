@@ -0,0 +1,65 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipld/traverser.hpp"
+
+#include <gtest/gtest.h>
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::storage::ipld::traverser {
+  using ipfs::InMemoryDatastore;
+
+  struct Node {
+    int i;
+    std::vector<CID> links;
+  };
+  CBOR_TUPLE(Node, i, links)
+
+  class TraverserTest : public ::testing::Test {
+   public:
+    void SetUp() override {
+      // two levels of children, shared leaf visited once
+      CID leaf = setNode({100, {}});
+      std::vector<CID> children;
+      for (auto i = 0; i < 10; ++i) {
+        children.push_back(setNode({i, {leaf}}));
+      }
+      root = setNode({-1, children});
+    }
+
+    CID setNode(const Node &node) {
+      return store.setCbor(node).value();
+    }
+
+    InMemoryDatastore store;
+    CID root;
+  };
+
+  /**
+   * @given dag with shared block
+   * @when traversed with prefetch
+   * @then blocks are returned in same order as without prefetch, with their
+   * bytes
+   */
+  TEST_F(TraverserTest, PrefetchKeepsOrder) {
+    Traverser expected{store, root, {}};
+    EXPECT_OUTCOME_TRUE(cids, expected.traverseAll());
+
+    Traverser prefetching{store, root, {}, 4};
+    std::vector<CID> visited;
+    while (!prefetching.isCompleted()) {
+      EXPECT_OUTCOME_TRUE(block, prefetching.advanceBlock());
+      EXPECT_OUTCOME_EQ(store.get(block.cid), block.bytes);
+      if (std::find(visited.begin(), visited.end(), block.cid)
+          == visited.end()) {
+        visited.push_back(block.cid);
+      }
+    }
+    EXPECT_EQ(visited, cids);
+    EXPECT_OUTCOME_ERROR(TraverserError::kTraverseCompleted,
+                         prefetching.advanceBlock());
+  }
+}  // namespace fc::storage::ipld::traverser
@@ -71,6 +71,14 @@ namespace fc::storage::keystore {
     }
 
    protected:
+    /** Remove key files bypassing keystore */
+    void removeKeyFiles() {
+      std::vector<fs::path> files{fs::directory_iterator{base_path}, {}};
+      for (auto &file : files) {
+        fs::remove(file);
+      }
+    }
+
     static bool VectorContains(const std::vector<Address> &vector,
                                Address value) {
       return std::find(vector.begin(), vector.end(), value) != vector.end();
@@ -284,4 +292,43 @@ namespace fc::storage::keystore {
     ASSERT_TRUE(res);
   }
 
+  /**
+   * @given Keystore with bls key used for signing
+   * @when key file is removed outside of keystore
+   * @then cached key still signs, keystore without cache fails
+   */
+  TEST_F(FileSystemKeyStoreTest, SignCached) {
+    EXPECT_OUTCOME_TRUE_1(ks->put(bls_address_, bls_keypair_.private_key));
+    EXPECT_OUTCOME_TRUE_1(ks->sign(bls_address_, data_));
+    removeKeyFiles();
+    EXPECT_OUTCOME_TRUE(signature, ks->sign(bls_address_, data_));
+    EXPECT_OUTCOME_EQ(ks->verify(bls_address_, data_, signature), true);
+
+    FileSystemKeyStore uncached{base_path.string(),
+                                bls_provider_,
+                                secp256k1_provider_,
+                                std::chrono::seconds{0}};
+    EXPECT_OUTCOME_TRUE_1(
+        uncached.put(bls_address_, bls_keypair_.private_key));
+    EXPECT_OUTCOME_TRUE_1(uncached.sign(bls_address_, data_));
+    removeKeyFiles();
+    EXPECT_OUTCOME_ERROR(KeyStoreError::kNotFound,
+                         uncached.sign(bls_address_, data_));
+  }
+
+  /**
+   * @given Keystore with bls private key
+   * @when signMany() called with several messages
+   * @then signature for each message returned
+   */
+  TEST_F(FileSystemKeyStoreTest, SignManyBls) {
+    EXPECT_OUTCOME_TRUE_1(ks->put(bls_address_, bls_keypair_.private_key));
+    std::vector<uint8_t> other{4, 2};
+    EXPECT_OUTCOME_TRUE(signatures, ks->signMany(bls_address_, {data_, other}));
+    ASSERT_EQ(signatures.size(), 2);
+    EXPECT_OUTCOME_EQ(ks->verify(bls_address_, data_, signatures[0]), true);
+    EXPECT_OUTCOME_EQ(ks->verify(bls_address_, other, signatures[1]), true);
+    EXPECT_OUTCOME_EQ(ks->verify(bls_address_, other, signatures[0]), false);
+  }
+
 }  // namespace fc::storage::keystore
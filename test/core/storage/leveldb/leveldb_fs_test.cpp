@@ -48,3 +48,23 @@ TEST_F(LevelDB_Open, OpenExistingDB) {
   boost::filesystem::path p(getPathString());
   EXPECT_TRUE(fs::exists(p));
 }
+
+/**
+ * @given tuning with block cache and bloom filter
+ * @when open database and use it
+ * @then values are stored, stats property is available
+ */
+TEST_F(LevelDB_Open, OpenTuned) {
+  leveldb::Options options;
+  options.create_if_missing = true;
+  LevelDB::Tuning tuning;
+  tuning.block_cache_bytes = 1 << 20;
+
+  EXPECT_OUTCOME_TRUE_2(db, LevelDB::create(getPathString(), options, tuning));
+  fc::common::Buffer key{1, 2}, value{3};
+  EXPECT_OUTCOME_TRUE_1(db->put(key, value));
+  EXPECT_OUTCOME_EQ(db->get(key), value);
+  EXPECT_FALSE(db->contains(fc::common::Buffer{4}));
+  EXPECT_TRUE(db->getProperty("leveldb.stats"));
+  EXPECT_FALSE(db->getProperty("leveldb.unknown"));
+}
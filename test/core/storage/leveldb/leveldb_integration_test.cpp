@@ -136,3 +136,49 @@ TEST_F(LevelDB_Integration_Test, Iterator) {
   EXPECT_FALSE(it->isValid());
   EXPECT_EQ(c, index + 1);
 }
+
+/**
+ * @given snapshot of database with {key}
+ * @when key is overwritten and removed
+ * @then snapshot reads still see old value
+ */
+TEST_F(LevelDB_Integration_Test, Snapshot) {
+  EXPECT_OUTCOME_TRUE_1(db_->put(key_, value_));
+  auto snapshot{db_->snapshot()};
+  EXPECT_OUTCOME_TRUE_1(db_->put(key_, Buffer{4}));
+  EXPECT_OUTCOME_EQ(db_->get(key_, snapshot), value_);
+  EXPECT_OUTCOME_TRUE_1(db_->remove(key_));
+  EXPECT_FALSE(db_->contains(key_));
+  EXPECT_TRUE(db_->contains(key_, snapshot));
+
+  auto cursor{db_->cursor(snapshot, false)};
+  cursor->seekToFirst();
+  ASSERT_TRUE(cursor->isValid());
+  EXPECT_EQ(cursor->key(), key_);
+  EXPECT_EQ(cursor->value(), value_);
+}
+
+/**
+ * @given keys with different prefixes
+ * @when scan prefix from key with limit
+ * @then only keys of prefix from key are returned without prefix
+ */
+TEST_F(LevelDB_Integration_Test, Scan) {
+  for (uint8_t i{0}; i < 5; ++i) {
+    EXPECT_OUTCOME_TRUE_1(db_->put(Buffer{1, i}, Buffer{i}));
+    EXPECT_OUTCOME_TRUE_1(db_->put(Buffer{2, i}, Buffer{i}));
+  }
+  Buffer prefix{1};
+  EXPECT_OUTCOME_TRUE(all, db_->scan(prefix));
+  EXPECT_EQ(all.size(), 5);
+  EXPECT_OUTCOME_TRUE(part, db_->scan(prefix, Buffer{2}, 2));
+  ASSERT_EQ(part.size(), 2);
+  EXPECT_EQ(part[0].first, Buffer{2});
+  EXPECT_EQ(part[1].first, Buffer{3});
+  EXPECT_EQ(part[1].second, Buffer{3});
+
+  auto snapshot{db_->snapshot()};
+  EXPECT_OUTCOME_TRUE_1(db_->put(Buffer{1, 9}, Buffer{9}));
+  EXPECT_OUTCOME_TRUE(old, db_->scan(prefix, {}, 0, snapshot));
+  EXPECT_EQ(old.size(), 5);
+}
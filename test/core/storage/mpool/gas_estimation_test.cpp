@@ -0,0 +1,61 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/mpool/gas_estimation.hpp"
+
+#include <gtest/gtest.h>
+
+namespace fc::storage::mpool {
+  /**
+   * @given premiums of messages in recent blocks
+   * @when estimating premium
+   * @then premium at half of target gas is returned, not below minimum
+   */
+  TEST(GasEstimation, MedianPremium) {
+    EXPECT_EQ(medianPremium({}, 0), kMinGasPremium);
+    std::vector<PremiumSample> samples{
+        {200000, kBlockGasTarget / 4},
+        {400000, kBlockGasTarget / 4},
+        {300000, kBlockGasTarget / 4},
+        {500000, kBlockGasTarget / 4},
+    };
+    EXPECT_EQ(medianPremium(samples, 1), 300000);
+    EXPECT_EQ(medianPremium(samples, 4), 200000);
+    EXPECT_EQ(medianPremium({{10, kBlockGasTarget}}, 1), kMinGasPremium);
+  }
+
+  /**
+   * @given base fee and premium
+   * @when estimating fee cap
+   * @then fee cap covers base fee growth of full blocks and premium
+   */
+  TEST(GasEstimation, FeeCap) {
+    TokenAmount base_fee{1000000};
+    auto fee_cap{estimateFeeCap(base_fee, 5)};
+    auto grown{base_fee};
+    for (auto i{0}; i < kFeeCapBlocks; ++i) {
+      grown = grown * 9 / 8;
+    }
+    EXPECT_EQ(fee_cap, grown + 5);
+    EXPECT_GT(fee_cap, base_fee * 10);
+  }
+
+  /**
+   * @given message with fee above max fee
+   * @when capping fee
+   * @then fee cap and premium are lowered to max fee per gas
+   */
+  TEST(GasEstimation, CapGasFee) {
+    UnsignedMessage message;
+    message.gas_limit = 1000;
+    message.gas_fee_cap = 100;
+    message.gas_premium = 50;
+    capGasFee(message, 200000);
+    EXPECT_EQ(message.gas_fee_cap, 100);
+    capGasFee(message, 20000);
+    EXPECT_EQ(message.gas_fee_cap, 20);
+    EXPECT_EQ(message.gas_premium, 20);
+  }
+}  // namespace fc::storage::mpool
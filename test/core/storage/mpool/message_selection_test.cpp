@@ -0,0 +1,139 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/mpool/message_selection.hpp"
+
+#include <gtest/gtest.h>
+
+#include <deque>
+
+namespace fc::storage::mpool {
+  using crypto::signature::Secp256k1Signature;
+  using primitives::address::Address;
+  using vm::message::UnsignedMessage;
+
+  using Selected = std::vector<std::pair<uint64_t, uint64_t>>;
+
+  struct MessageSelectionTest : ::testing::Test {
+    SignedMessage message(uint64_t from,
+                          uint64_t nonce,
+                          GasAmount gas,
+                          BigInt premium,
+                          BigInt fee_cap = 1000) {
+      UnsignedMessage msg;
+      msg.from = Address::makeFromId(from);
+      msg.nonce = nonce;
+      msg.gas_limit = gas;
+      msg.gas_fee_cap = std::move(fee_cap);
+      msg.gas_premium = std::move(premium);
+      return {msg, Secp256k1Signature{}};
+    }
+
+    /// Add message to sender with given index
+    void add(size_t sender,
+             GasAmount gas,
+             BigInt premium,
+             BigInt fee_cap = 1000) {
+      if (storage.size() <= sender) {
+        storage.resize(sender + 1);
+      }
+      auto &messages{storage[sender]};
+      messages.push_back(
+          message(sender, messages.size(), gas, premium, fee_cap));
+    }
+
+    std::vector<SenderMessages> senders() {
+      std::vector<SenderMessages> senders;
+      for (auto &messages : storage) {
+        senders.emplace_back();
+        for (auto &msg : messages) {
+          senders.back().push_back(&msg);
+        }
+      }
+      return senders;
+    }
+
+    /// Selected messages as (sender, nonce)
+    Selected select(GasAmount gas_limit, size_t message_limit = 100) {
+      Selected result;
+      for (auto &msg :
+           selectMessages(senders(), base_fee, gas_limit, message_limit)) {
+        result.emplace_back(msg.message.from.getId(), msg.message.nonce);
+      }
+      return result;
+    }
+
+    // std::deque keeps pointers valid while adding
+    std::vector<std::deque<SignedMessage>> storage;
+    BigInt base_fee{100};
+  };
+
+  /**
+   * @given message with premium above fee cap minus base fee
+   * @when reward is computed
+   * @then premium is limited by fee cap
+   */
+  TEST_F(MessageSelectionTest, GasReward) {
+    EXPECT_EQ(gasReward(message(0, 0, 10, 5), base_fee), 50);
+    EXPECT_EQ(gasReward(message(0, 0, 10, 5, 103), base_fee), 30);
+    EXPECT_EQ(gasReward(message(0, 0, 10, 5, 90), base_fee), -100);
+  }
+
+  /**
+   * @given senders with different premiums
+   * @when messages are selected
+   * @then higher premium comes first, unprofitable messages are skipped
+   */
+  TEST_F(MessageSelectionTest, ByPremium) {
+    add(0, 10, 1);
+    add(1, 10, 3);
+    add(2, 10, 2);
+    add(3, 10, 5, 50);
+    EXPECT_EQ(select(1000), (Selected{{1, 0}, {2, 0}, {0, 0}}));
+  }
+
+  /**
+   * @given sender with cheap message followed by expensive one
+   * @when chains are built
+   * @then messages are merged into single chain with average perf
+   */
+  TEST_F(MessageSelectionTest, MergeDependent) {
+    add(0, 10, 1);
+    add(0, 10, 9);
+    add(1, 10, 4);
+    auto chains{messageChains(senders(), base_fee)};
+    ASSERT_EQ(chains.size(), 2);
+    EXPECT_EQ(chains[0].begin, 0);
+    EXPECT_EQ(chains[0].end, 2);
+    EXPECT_EQ(chains[0].perf, 5);
+    EXPECT_EQ(select(1000), (Selected{{0, 0}, {0, 1}, {1, 0}}));
+  }
+
+  /**
+   * @given messages exceeding block gas limit
+   * @when messages are selected
+   * @then chain is trimmed, remaining gas is filled by other senders
+   */
+  TEST_F(MessageSelectionTest, TrimToGasLimit) {
+    add(0, 60, 10);
+    add(0, 60, 10);
+    add(1, 50, 8);
+    add(2, 40, 5);
+    EXPECT_EQ(select(100), (Selected{{0, 0}, {2, 0}}));
+  }
+
+  /**
+   * @given merged chain exceeding message limit
+   * @when messages are selected
+   * @then chain is trimmed and nonces stay consecutive
+   */
+  TEST_F(MessageSelectionTest, TrimToMessageLimit) {
+    add(0, 10, 1);
+    add(0, 10, 2);
+    add(0, 10, 9);
+    add(1, 10, 3);
+    EXPECT_EQ(select(1000, 2), (Selected{{1, 0}, {0, 0}}));
+  }
+}  // namespace fc::storage::mpool
@@ -81,3 +81,38 @@ TEST_F(PieceStorageTest, AddBlockLocationSuccess) {
   EXPECT_EQ(payload_info_B.piece_block_locations.front().block_location,
             location_B);
 }
+
+/**
+ * @given Example Piece CID, deals and blocks locations
+ * @when Writing deals with addPieceDeal and retrieving piece by payload
+ * @then Piece info of payload contains all deals, locations are written too
+ */
+TEST_F(PieceStorageTest, AddPieceDealIndexed) {
+  std::map<CID, PayloadLocation> locations{{payload_cid_A, location_A},
+                                           {payload_cid_B, location_B}};
+  EXPECT_OUTCOME_TRUE_1(
+      piece_storage->addPieceDeal(piece_cid, locations, deal_info));
+  EXPECT_OUTCOME_TRUE(received_info, piece_storage->getPieceInfo(piece_cid));
+  EXPECT_EQ(received_info, piece_info);
+  EXPECT_OUTCOME_TRUE(payload_info_A,
+                      piece_storage->getPayloadInfo(payload_cid_A));
+  EXPECT_EQ(payload_info_A.piece_block_locations.size(), 1);
+  EXPECT_OUTCOME_TRUE(info_B,
+                      piece_storage->getPieceInfoFromCid(payload_cid_B, {}));
+  EXPECT_EQ(info_B, piece_info);
+
+  DealInfo deal_info_2{.deal_id = 5,
+                       .sector_id = 6,
+                       .offset = PaddedPieceSize(0),
+                       .length = PaddedPieceSize(4)};
+  EXPECT_OUTCOME_TRUE_1(
+      piece_storage->addPieceDeal(piece_cid, locations, deal_info_2));
+  EXPECT_OUTCOME_TRUE(
+      info_A, piece_storage->getPieceInfoFromCid(payload_cid_A, piece_cid));
+  EXPECT_EQ(info_A.deals.size(), 2);
+  EXPECT_OUTCOME_TRUE(payload_info,
+                      piece_storage->getPayloadInfo(payload_cid_A));
+  EXPECT_EQ(payload_info.piece_block_locations.size(), 1);
+  EXPECT_OUTCOME_TRUE(has, piece_storage->hasPieceInfo(piece_cid, {}));
+  EXPECT_FALSE(has);
+}
@@ -6,6 +6,8 @@
 #include "storage/unixfs/unixfs.hpp"
 
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <random>
 
 #include "common/span.hpp"
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
@@ -24,6 +26,54 @@ TEST_P(UnixfsTest, MatchGo) {
       cid);
 }
 
+/// Imports data through temporary file
+auto import(gsl::span<const uint8_t> data,
+            const fc::storage::unixfs::ImportOptions &options) {
+  fc::storage::ipfs::InMemoryDatastore ipld;
+  auto file{std::tmpfile()};
+  std::fwrite(data.data(), 1, data.size(), file);
+  std::fflush(file);
+  std::rewind(file);
+  auto cid{fc::storage::unixfs::importFile(ipld, fileno(file), options)};
+  std::fclose(file);
+  return cid;
+}
+
+TEST_P(UnixfsTest, ImportMatchGo) {
+  auto &[data, chunk_size, max_links, cid_str] = GetParam();
+  EXPECT_OUTCOME_TRUE(cid, fc::CID::fromString(cid_str));
+  fc::storage::unixfs::ImportOptions options;
+  options.chunk_size = chunk_size;
+  options.max_links = max_links;
+  options.batch_bytes = 16;
+  EXPECT_OUTCOME_EQ(import(fc::common::span::cbytes(data), options), cid);
+}
+
+/// Importing large file builds same dag as wrapFile
+TEST(UnixfsImportTest, Large) {
+  std::mt19937 random;
+  std::vector<uint8_t> data((3 << 20) + 123);
+  for (auto &byte : data) {
+    byte = static_cast<uint8_t>(random());
+  }
+  fc::storage::ipfs::InMemoryDatastore ipld;
+  EXPECT_OUTCOME_TRUE(expected,
+                      fc::storage::unixfs::wrapFile(ipld, data, 64 << 10, 4));
+  fc::storage::unixfs::ImportOptions options;
+  options.chunk_size = 64 << 10;
+  options.max_links = 4;
+  for (auto threads : {0, 1, 4}) {
+    options.threads = threads;
+    EXPECT_OUTCOME_EQ(import(data, options), expected);
+  }
+
+  options.chunker = fc::storage::unixfs::Chunker::kBuzhash;
+  EXPECT_OUTCOME_TRUE(buzhash, import(data, options));
+  EXPECT_NE(buzhash, expected);
+  options.threads = 0;
+  EXPECT_OUTCOME_EQ(import(data, options), buzhash);
+}
+
 INSTANTIATE_TEST_CASE_P(
     UnixfsTestCases,
     UnixfsTest,
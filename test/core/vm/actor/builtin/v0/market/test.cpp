@@ -523,3 +523,46 @@ TEST_F(MarketActorTest, GCC_DISABLE(ComputeDataCommitment)) {
                         runtime, {deal_ids, sector_type}),
                     comm_d);
 }
+
+/**
+ * @given deals of same client and provider ending before current epoch
+ * @when cron tick processes them
+ * @then storage fees are paid, collaterals are unlocked, deals are removed
+ */
+TEST_F(MarketActorTest, CronTickEndedDeals) {
+  State::DealSet due{fc::IpldPtr{ipld}};
+  for (auto deal_id : {deal_1_id, deal_2_id}) {
+    DealProposal deal;
+    deal.piece_cid = some_cid;
+    deal.client = client_address;
+    deal.provider = miner_address;
+    deal.start_epoch = 2000;
+    deal.end_epoch = 2050;
+    deal.storage_price_per_epoch = 2;
+    deal.provider_collateral = 10;
+    deal.client_collateral = 5;
+    EXPECT_OUTCOME_TRUE_1(state.proposals.set(deal_id, deal));
+    EXPECT_OUTCOME_TRUE_1(state.states.set(
+        deal_id, {1990, kChainEpochUndefined, kChainEpochUndefined}));
+    EXPECT_OUTCOME_TRUE_1(due.set(deal_id, {}));
+  }
+  EXPECT_OUTCOME_TRUE_1(state.deals_by_epoch.set(epoch, due));
+  state.last_cron = epoch - 1;
+  EXPECT_OUTCOME_TRUE_1(state.escrow_table.set(client_address, 300));
+  EXPECT_OUTCOME_TRUE_1(state.locked_table.set(client_address, 210));
+  EXPECT_OUTCOME_TRUE_1(state.escrow_table.set(miner_address, 50));
+  EXPECT_OUTCOME_TRUE_1(state.locked_table.set(miner_address, 20));
+
+  callerIs(fc::vm::actor::kCronAddress);
+  expectSendFunds(kBurntFundsActorAddress, 0);
+  EXPECT_OUTCOME_TRUE_1(MarketActor::CronTick::call(runtime, {}));
+
+  EXPECT_OUTCOME_EQ(state.escrow_table.get(client_address), 100);
+  EXPECT_OUTCOME_EQ(state.locked_table.get(client_address), 0);
+  EXPECT_OUTCOME_EQ(state.escrow_table.get(miner_address), 250);
+  EXPECT_OUTCOME_EQ(state.locked_table.get(miner_address), 0);
+  EXPECT_OUTCOME_EQ(state.proposals.has(deal_1_id), false);
+  EXPECT_OUTCOME_EQ(state.proposals.has(deal_2_id), false);
+  EXPECT_OUTCOME_EQ(state.deals_by_epoch.has(epoch), false);
+  EXPECT_EQ(state.last_cron, epoch);
+}
@@ -40,6 +40,19 @@ namespace fc::vm::actor {
             {kCronCodeCid}, runtime, builtin::v0::cron::EpochTick::Number, {}));
   }
 
+  /// native mode is reported only for hot methods and when enabled
+  TEST(InvokerTest, NativeMode) {
+    auto tick{builtin::v0::cron::EpochTick::Number};
+    EXPECT_EQ(InvokerImpl{}.nativeMode(kCronCodeCid, tick), NativeMode::kOff);
+    InvokerImpl native{NativeMode::kOn};
+    EXPECT_EQ(native.nativeMode(kCronCodeCid, tick), NativeMode::kOn);
+    EXPECT_EQ(native.nativeMode(kCronCodeCid, MethodNumber{1}),
+              NativeMode::kOff);
+    EXPECT_EQ(InvokerImpl{NativeMode::kDifferential}.nativeMode(kCronCodeCid,
+                                                                tick),
+              NativeMode::kDifferential);
+  }
+
   /// decodeActorParams returns error or decoded params
   TEST(InvokerTest, DecodeActorParams) {
     using fc::vm::actor::decodeActorParams;
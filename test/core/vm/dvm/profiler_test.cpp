@@ -0,0 +1,84 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/dvm/profiler.hpp"
+
+#include <gtest/gtest.h>
+#include <sstream>
+
+#include "vm/actor/builtin/v0/codes.hpp"
+
+using fc::vm::actor::builtin::v0::kCronCodeCid;
+using fc::vm::actor::builtin::v0::kStoragePowerCodeCid;
+namespace dvm = fc::dvm;
+
+struct ProfilerTest : testing::Test {
+  void SetUp() override {
+    dvm::profileReset();
+    dvm::profiling = true;
+  }
+
+  void TearDown() override {
+    dvm::profiling = false;
+    dvm::profileReset();
+  }
+};
+
+/**
+ * @given profiler disabled
+ * @when invocation is profiled
+ * @then nothing is recorded
+ */
+TEST_F(ProfilerTest, Disabled) {
+  dvm::profiling = false;
+  {
+    dvm::Profile profile{kCronCodeCid, 2};
+    dvm::profileCharge(10);
+  }
+  EXPECT_TRUE(dvm::profileStats().empty());
+}
+
+/**
+ * @given nested invocations
+ * @when they charge gas and use ipld
+ * @then stats are aggregated by code and method, stacks are nested
+ */
+TEST_F(ProfilerTest, Nested) {
+  for (auto i{0}; i < 2; ++i) {
+    dvm::Profile cron{kCronCodeCid, 2};
+    dvm::profileCharge(10);
+    {
+      dvm::Profile power{kStoragePowerCodeCid, 9};
+      dvm::profileCharge(5);
+      dvm::profileIpldGet(100);
+      dvm::profileIpldPut(30);
+    }
+  }
+  auto stats{dvm::profileStats()};
+  ASSERT_EQ(stats.size(), 2);
+  auto &cron{stats.at({"fil/1/cron", 2})};
+  auto &power{stats.at({"fil/1/storagepower", 9})};
+  EXPECT_EQ(cron.calls, 2);
+  EXPECT_EQ(cron.gas, 20);
+  EXPECT_EQ(cron.ipld_gets, 0);
+  EXPECT_GE(cron.total, power.total);
+  EXPECT_EQ(power.calls, 2);
+  EXPECT_EQ(power.gas, 10);
+  EXPECT_EQ(power.ipld_gets, 2);
+  EXPECT_EQ(power.bytes_read, 200);
+  EXPECT_EQ(power.ipld_puts, 2);
+  EXPECT_EQ(power.bytes_written, 60);
+
+  std::stringstream flamegraph;
+  dvm::dumpFlamegraph(flamegraph);
+  EXPECT_NE(flamegraph.str().find("fil/1/cron:2;fil/1/storagepower:9 "),
+            std::string::npos);
+
+  std::stringstream prometheus;
+  dvm::dumpPrometheus(prometheus);
+  EXPECT_NE(prometheus.str().find("vm_invocation_seconds_count{code=\"fil/1/"
+                                  "cron\",method=\"2\"} 2"),
+            std::string::npos);
+}
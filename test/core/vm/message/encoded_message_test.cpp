@@ -0,0 +1,61 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/message/encoded_message.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/outcome.hpp"
+
+namespace fc::vm::message {
+  using crypto::signature::BlsSignature;
+  using crypto::signature::Secp256k1Signature;
+
+  SignedMessage makeSigned(Signature signature) {
+    return {UnsignedMessage{Address::makeFromId(1),
+                            Address::makeFromId(2),
+                            3,
+                            4,
+                            5,
+                            6,
+                            7,
+                            {}},
+            std::move(signature)};
+  }
+
+  void expectSame(const SignedMessage &message,
+                  const EncodedMessage &encoded) {
+    EXPECT_EQ(encoded.cid(), message.getCid());
+    EXPECT_EQ(encoded.chainSize(), message.chainSize());
+    EXPECT_EQ(encoded.unsigned_cid, message.message.getCid());
+  }
+
+  /// @given secp message
+  /// @when make and decode encoded message
+  /// @then cid and size are of signed message
+  TEST(EncodedMessageTest, Secp) {
+    auto message{makeSigned(Secp256k1Signature{})};
+    EXPECT_OUTCOME_TRUE(made, EncodedMessage::make(message));
+    expectSame(message, made);
+    EXPECT_TRUE(made.signed_cid);
+    EXPECT_OUTCOME_TRUE(decoded, EncodedMessage::decode(made.signed_bytes));
+    expectSame(message, decoded);
+    EXPECT_EQ(decoded.unsigned_bytes, made.unsigned_bytes);
+  }
+
+  /// @given bls message
+  /// @when make and decode encoded message
+  /// @then cid and size are of unsigned message
+  TEST(EncodedMessageTest, Bls) {
+    auto message{makeSigned(BlsSignature{})};
+    EXPECT_OUTCOME_TRUE(made, EncodedMessage::make(message));
+    expectSame(message, made);
+    EXPECT_FALSE(made.signed_cid);
+    EXPECT_TRUE(made.signed_bytes.empty());
+    EXPECT_OUTCOME_TRUE(bytes, codec::cbor::encode(message));
+    EXPECT_OUTCOME_TRUE(decoded, EncodedMessage::decode(bytes));
+    expectSame(message, decoded);
+  }
+}  // namespace fc::vm::message
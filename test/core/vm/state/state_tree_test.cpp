@@ -4,10 +4,12 @@
  */
 
 #include "vm/state/impl/state_tree_impl.hpp"
+#include "vm/state/impl/overlay_state_tree.hpp"
 
 #include <gtest/gtest.h>
 #include "primitives/address/address_codec.hpp"
 #include "testutil/init_actor.hpp"
+#include "vm/actor/builtin/v0/account/account_actor.hpp"
 
 using fc::primitives::BigInt;
 using fc::primitives::address::Address;
@@ -15,6 +17,8 @@ using fc::storage::hamt::Hamt;
 using fc::storage::hamt::HamtError;
 using fc::vm::actor::Actor;
 using fc::vm::actor::CodeId;
+using fc::vm::state::NodeCache;
+using fc::vm::state::OverlayStateTree;
 using fc::vm::state::StateTreeImpl;
 
 auto kAddressId = Address::makeFromId(13);
@@ -74,3 +78,85 @@ TEST_F(StateTreeTest, RegisterNewAddressLookupId) {
   EXPECT_OUTCOME_EQ(tree->registerNewAddress(address), kAddressId);
   EXPECT_OUTCOME_EQ(tree->lookupId(address), kAddressId);
 }
+
+/**
+ * @given Flushed state tree and overlay over its root
+ * @when Set and flush actor state in overlay, then discard overlay
+ * @then Overlay sees its changes, base store doesn't, discard drops them
+ */
+TEST_F(StateTreeTest, Overlay) {
+  EXPECT_OUTCOME_TRUE(root, tree_.flush());
+  OverlayStateTree overlay{store_, root, std::make_shared<NodeCache>()};
+  EXPECT_OUTCOME_TRUE_1(overlay.set(kAddressId, kActor));
+  EXPECT_OUTCOME_TRUE(overlay_root, overlay.flush());
+  EXPECT_OUTCOME_EQ(overlay.get(kAddressId), kActor);
+  EXPECT_OUTCOME_EQ(store_->contains(overlay_root), false);
+  EXPECT_OUTCOME_ERROR(HamtError::kNotFound,
+                       StateTreeImpl(store_, root).get(kAddressId));
+
+  overlay.discard();
+  EXPECT_EQ(overlay.baseRoot(), root);
+  EXPECT_OUTCOME_ERROR(HamtError::kNotFound, overlay.get(kAddressId));
+}
+
+/**
+ * @given Key address resolved to account actor, then state reverted
+ * @when Same key address is registered with other id and looked up
+ * @then Cached id of reverted state is not used
+ */
+TEST_F(StateTreeTest, LookupIdCachedAccountReverted) {
+  using fc::vm::actor::builtin::v0::kAccountCodeCid;
+  using fc::vm::actor::builtin::v0::account::AccountActorState;
+  auto tree = setupInitActor(nullptr, 13);
+  Address key{fc::primitives::address::Secp256k1PublicKeyHash{}};
+  Address other{fc::primitives::address::ActorExecHash{}};
+  EXPECT_OUTCOME_TRUE(head,
+                      tree->getStore()->setCbor(AccountActorState{key}));
+  EXPECT_OUTCOME_TRUE(root, tree->flush());
+
+  EXPECT_OUTCOME_EQ(tree->registerNewAddress(key), kAddressId);
+  EXPECT_OUTCOME_TRUE_1(tree->set(kAddressId, {kAccountCodeCid, head, 0, 0}));
+  EXPECT_OUTCOME_EQ(tree->lookupId(key), kAddressId);
+  EXPECT_OUTCOME_EQ(tree->lookupId(key), kAddressId);
+
+  EXPECT_OUTCOME_TRUE_1(tree->revert(root));
+  EXPECT_OUTCOME_EQ(tree->registerNewAddress(other), kAddressId);
+  auto id{Address::makeFromId(14)};
+  EXPECT_OUTCOME_EQ(tree->registerNewAddress(key), id);
+  EXPECT_OUTCOME_TRUE_1(tree->set(id, {kAccountCodeCid, head, 0, 0}));
+  EXPECT_OUTCOME_EQ(tree->lookupId(key), id);
+}
+
+/**
+ * @given State tree with actor and nested checkpoints
+ * @when Inner checkpoint is rolled back and outer committed, with flush
+ * between change and rollback
+ * @then Only changes of inner checkpoint are undone, nothing is flushed
+ */
+TEST_F(StateTreeTest, CheckpointRollback) {
+  auto other{Address::makeFromId(14)};
+  auto changed{kActor};
+  changed.nonce = 4;
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, kActor));
+  EXPECT_OUTCOME_TRUE(root, tree_.flush());
+
+  tree_.checkpoint();
+  EXPECT_OUTCOME_TRUE_1(tree_.set(other, kActor));
+  tree_.checkpoint();
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, changed));
+  EXPECT_OUTCOME_TRUE_1(tree_.remove(other));
+  EXPECT_OUTCOME_ERROR(HamtError::kNotFound, tree_.get(other));
+  EXPECT_OUTCOME_TRUE_1(tree_.flush());
+  tree_.rollback();
+  EXPECT_OUTCOME_EQ(tree_.get(kAddressId), kActor);
+  EXPECT_OUTCOME_EQ(tree_.get(other), kActor);
+  tree_.commit();
+
+  tree_.checkpoint();
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, changed));
+  tree_.rollback();
+  EXPECT_OUTCOME_EQ(tree_.get(kAddressId), kActor);
+  EXPECT_OUTCOME_TRUE(root2, tree_.flush());
+  EXPECT_NE(root2, root);
+  EXPECT_OUTCOME_EQ(StateTreeImpl(store_, root2).get(other), kActor);
+}
@@ -28,6 +28,17 @@ namespace fc::crypto::bls {
     MOCK_CONST_METHOD1(
         aggregateSignatures,
         outcome::result<Signature>(gsl::span<const Signature>));
+    MOCK_CONST_METHOD3(
+        verifyAggregateSignature,
+        outcome::result<bool>(gsl::span<const std::vector<uint8_t>>,
+                              gsl::span<const PublicKey>,
+                              const Signature &));
+    MOCK_CONST_METHOD3(
+        verifySignatures,
+        outcome::result<std::vector<bool>>(
+            gsl::span<const std::vector<uint8_t>>,
+            gsl::span<const Signature>,
+            gsl::span<const PublicKey>));
   };
 }  // namespace fc::crypto::bls
 
@@ -19,6 +19,8 @@ namespace fc::sector_storage {
 
     MOCK_METHOD0(getSectorSize, SectorSize());
 
+    MOCK_METHOD1(queuedTasks, uint64_t(const primitives::TaskType &));
+
     outcome::result<void> readPiece(PieceData output,
                                     const SectorId &sector,
                                     UnpaddedByteIndex offset,
@@ -96,6 +98,10 @@ namespace fc::sector_storage {
                      gsl::span<const SectorInfo> sector_info,
                      PoStRandomness randomness));
 
+    MOCK_METHOD2(prewarmWinningPoSt,
+                 outcome::result<void>(ActorId miner_id,
+                                       gsl::span<const SectorInfo>));
+
     MOCK_METHOD3(generateWindowPoSt,
                  outcome::result<WindowPoStResponse>(
                      ActorId miner_id,
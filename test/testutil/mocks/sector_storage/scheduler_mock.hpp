@@ -22,12 +22,23 @@ namespace fc::sector_storage {
                                        const WorkerAction &,
                                        uint64_t));
 
+    MOCK_METHOD7(scheduleAsync,
+                 void(const SectorId &,
+                      const TaskType &,
+                      const std::shared_ptr<WorkerSelector> &,
+                      const WorkerAction &,
+                      const WorkerAction &,
+                      ReturnCb,
+                      uint64_t));
+
     MOCK_METHOD1(doNewWorker, void(WorkerHandle *));
     void newWorker(std::unique_ptr<WorkerHandle> worker) {
       doNewWorker(worker.get());
     }
 
     MOCK_CONST_METHOD0(getSealProofType, RegisteredProof());
+
+    MOCK_METHOD1(queuedTasks, uint64_t(const TaskType &));
   };
 
 }  // namespace fc::sector_storage
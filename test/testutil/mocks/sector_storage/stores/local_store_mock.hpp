@@ -47,6 +47,13 @@ namespace fc::sector_storage::stores {
                                                SectorFileType file_type,
                                                const SectorPaths &storages,
                                                PathType path_type));
+
+    MOCK_METHOD1(trash, outcome::result<void>(const std::string &));
+
+    MOCK_METHOD3(prewarm,
+                 outcome::result<uint64_t>(SectorId,
+                                           RegisteredProof,
+                                           SectorFileType));
   };
 }  // namespace fc::sector_storage::stores
 
@@ -54,6 +54,14 @@ namespace fc::sector_storage::stores {
                  std::unique_ptr<Lock>(const SectorId &,
                                        SectorFileType,
                                        SectorFileType));
+
+    MOCK_METHOD5(
+        storageLockAsync,
+        void(const SectorId &,
+             SectorFileType,
+             SectorFileType,
+             bool,
+             std::function<void(outcome::result<std::unique_ptr<Lock>>)>));
   };
 }  // namespace fc::sector_storage::stores
 
@@ -18,6 +18,10 @@ namespace fc::sectorblocks {
                  outcome::result<PieceAttributes>(UnpaddedPieceSize,
                                                   const std::string &,
                                                   DealInfo));
+    MOCK_METHOD3(addPiece,
+                 outcome::result<PieceAttributes>(UnpaddedPieceSize,
+                                                  const PieceData &,
+                                                  DealInfo));
     MOCK_CONST_METHOD1(getRefs, outcome::result<std::vector<PieceLocation>>(DealId));
 
     MOCK_CONST_METHOD0(getMiner, std::shared_ptr<Miner>());
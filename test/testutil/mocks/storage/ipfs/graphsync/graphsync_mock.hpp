@@ -17,6 +17,8 @@ namespace fc::storage::ipfs::graphsync {
     MOCK_METHOD1(subscribe,
                  DataConnection(std::function<OnDataReceived>));
 
+    MOCK_METHOD1(setBlocksHandler, void(std::function<OnBlocksReceived>));
+
     MOCK_METHOD0(start,
                  void());
 